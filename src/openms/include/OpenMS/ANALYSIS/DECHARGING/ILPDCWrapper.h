@@ -62,21 +62,23 @@ public:
 
     /// Compute optimal solution and return value of objective function
     /// If the input feature map is empty, a warning is issued and -1 is returned.
+    /// The connected components of the edge graph are solved as independent slices, in parallel and largest first
+    /// (the models are built in parallel, the calls into the LP solver are serialized).
     /// @return value of objective function
     /// and @p pairs will have all realized edges set to "active"
-    double compute(const FeatureMap fm, PairsType& pairs, Size verbose_level) const;
+    double compute(const FeatureMap& fm, PairsType& pairs, Size verbose_level) const;
 
 private:
 
     /// slicing the problem into subproblems
-    double computeSlice_(const FeatureMap fm,
+    double computeSlice_(const FeatureMap& fm,
                          PairsType& pairs,
                          const PairsIndex margin_left,
                          const PairsIndex margin_right,
                          const Size verbose_level) const;
 
     /// slicing the problem into subproblems
-    double computeSliceOld_(const FeatureMap fm,
+    double computeSliceOld_(const FeatureMap& fm,
                             PairsType& pairs,
                             const PairsIndex margin_left,
                             const PairsIndex margin_right,
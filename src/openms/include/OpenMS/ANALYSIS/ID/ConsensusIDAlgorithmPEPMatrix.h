@@ -151,6 +151,8 @@ namespace OpenMS
 
     @note The similarity scoring is based on an amino acid substitution matrix. Therefore only the raw amino acid sequences, without post-translational modifications (PTMs), can be considered for similarity scoring - PTMs are ignored during this step. However, PTMs on peptides are retained and separate results are produced for differently-modified peptides.
 
+    The substitution matrices cover the 20 standard amino acids and B, Z, X. Selenocysteine (U), pyrrolysine (O) and J (I or L) are scored as C, K and L, respectively; any other character is scored as X.
+
     @htmlinclude OpenMS_ConsensusIDAlgorithmPEPMatrix.parameters
     
     @ingroup Analysis_ID
@@ -163,17 +165,29 @@ namespace OpenMS
     ConsensusIDAlgorithmPEPMatrix();
 
   private:
-    /// SeqAn similarity scoring
-    typedef ::seqan::Score<int, ::seqan::ScoreMatrix< ::seqan::AminoAcid, ::seqan::Default> > SeqAnScore;
+    /// Substitution matrix (SeqAn amino acid order, "ARNDCQEGHILKMFPSTWYVBZX*")
+    const int* substitution_matrix_;
+
+    /// Alignment gap penalty (same for opening and extension)
+    int penalty_;
+
+    /// Mapping: character -> row/column index in the substitution matrix
+    std::vector<Size> char_to_index_;
+
+    /// Cache for self-alignment scores of unmodified sequences
+    std::map<String, int> self_scores_;
+
+    /// Scratch space for alignments (query profile and DP rows)
+    std::vector<int> profile_, row_, next_row_;
 
-    /// SeqAn amino acid sequence
-    typedef ::seqan::String< ::seqan::AminoAcid> SeqAnSequence;
+    /// Scratch space for alignments (matrix indexes of the query sequence)
+    std::vector<Size> query_;
 
-    /// Similarity scoring method
-    SeqAnScore scoring_method_;
+    /// Score of an optimal global alignment with linear gap costs (Needleman-Wunsch, score only)
+    int alignmentScore_(const String& seq1, const String& seq2);
 
-    /// Alignment data structure
-    ::seqan::Align<SeqAnSequence, ::seqan::ArrayGaps> alignment_;
+    /// Score of the alignment of a sequence against itself (cached)
+    int selfScore_(const String& seq);
 
     /// Not implemented
     ConsensusIDAlgorithmPEPMatrix(const ConsensusIDAlgorithmPEPMatrix&);
@@ -181,7 +195,7 @@ namespace OpenMS
     /// Not implemented
     ConsensusIDAlgorithmPEPMatrix& operator=(const ConsensusIDAlgorithmPEPMatrix&);
 
-    /// Docu in base class
+    /// Docu in base class (also clears the cached self-alignment scores)
     virtual void updateMembers_();
 
     /// Sequence similarity based on substitution matrix (ignores PTMs)
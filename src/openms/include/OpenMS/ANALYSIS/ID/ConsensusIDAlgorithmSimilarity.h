@@ -59,16 +59,31 @@ namespace OpenMS
     /// Default constructor
     ConsensusIDAlgorithmSimilarity();
 
-    /// Mapping: pair of peptide sequences -> sequence similarity
-    typedef std::map<std::pair<AASequence, AASequence>, double> SimilarityCache;
+    /// Mapping: pair of interned sequence IDs (smaller ID first) -> sequence similarity
+    typedef std::map<std::pair<Size, Size>, double> SimilarityCache;
 
     /// Cache for already computed sequence similarities
     SimilarityCache similarities_;
 
+    /// Interned peptide sequences (sequence -> ID)
+    std::map<AASequence, Size> sequence_ids_;
+
+    /// Both caches are cleared before a call to apply() if one of them has more entries than this
+    static const Size MAX_CACHE_SIZE_;
+
+    /// Docu in base class (clears the similarity cache; the interned sequence IDs don't depend on parameters and are kept)
+    virtual void updateMembers_();
+
+    /// Returns the ID of a peptide sequence (assigning a new one if necessary)
+    Size internSequence_(const AASequence& seq);
+
+    /// Returns the similarity of two interned sequences, calling getSimilarity_() only if it is not cached yet
+    double getCachedSimilarity_(Size id1, const AASequence& seq1, Size id2, const AASequence& seq2);
+
     /**
        @brief Sequence similarity calculation (to be implemented by subclasses).
 
-       Implementations should use/update the cache of previously computed similarities.
+       Results are cached by getCachedSimilarity_(), so this is called at most once for every pair of sequences (until the parameters change).
 
        @return Similarity between two sequences in the range [0, 1]
     */
@@ -100,6 +100,48 @@ public:
     */
     void apply(std::vector<ProteinIdentification> & ids);
 
+    /**
+        @brief Flat record of a single hit, as consumed by calculateFDRs()
+    */
+    struct ScoreEntry
+    {
+      /// Default constructor
+      ScoreEntry() :
+        score(0.0), group(0), is_decoy(false)
+      {
+      }
+
+      /// Detailed constructor
+      ScoreEntry(double score_, Size group_, bool is_decoy_) :
+        score(score_), group(group_), is_decoy(is_decoy_)
+      {
+      }
+
+      /// the (original) score of the hit
+      double score;
+      /// FDRs are computed independently for each group (e.g. per run and/or charge state)
+      Size group;
+      /// decoy or target hit
+      bool is_decoy;
+    };
+
+    /**
+        @brief Calculates FDRs (or q-values) for a flat list of scores
+
+        Entries are bucketed by group and every group is sorted exactly once. Different groups are processed in parallel if OpenMP is enabled,
+        a single group (e.g. all proteins) is processed sequentially.
+        FDRs are obtained from a single forward sweep over the sorted scores, q-values from an additional linear reverse sweep.
+        Decoy entries receive the value of the target with the closest score. If two targets are equally close, FDRs are taken from
+        the better-scoring and q-values from the worse-scoring target (as in earlier versions).
+        Decoys of a group without any targets receive 1.
+
+        @param entries scores, decoy flags and groups of all hits
+        @param fdrs output: FDR (or q-value) of each entry, in the order of @p entries
+        @param q_value calculate q-values instead of FDRs?
+        @param higher_score_better is a higher score better?
+    */
+    static void calculateFDRs(const std::vector<ScoreEntry> & entries, std::vector<double> & fdrs, bool q_value, bool higher_score_better);
+
 private:
     ///Not implemented
     FalseDiscoveryRate(const FalseDiscoveryRate &);
@@ -107,8 +149,8 @@ private:
     ///Not implemented
     FalseDiscoveryRate & operator=(const FalseDiscoveryRate &);
 
-    /// calculates the fdr stored into fdrs, given two vectors of scores
-    void calculateFDRs_(Map<double, double> & score_to_fdr, std::vector<double> & target_scores, std::vector<double> & decoy_scores, bool q_value, bool higher_score_better);
+    /// calculates the FDRs of a single group, given the (unsorted) indices of its entries
+    static void calculateGroupFDRs_(const std::vector<ScoreEntry> & entries, std::vector<Size>::iterator begin, std::vector<Size>::iterator end, std::vector<double> & fdrs, bool q_value, bool higher_score_better);
 
   };
 
@@ -55,6 +55,12 @@ namespace OpenMS
       The second way is more memory efficient because at all times, only the
       reference map and the current map need to be in memory
 
+      With "group", the maps can alternatively be merged in a balanced binary
+      tree (parameter @p merge_order): neighbouring maps are merged pairwise,
+      then the results pairwise, and so on. The merges of one level of the
+      tree are independent and run in parallel, and the result does not depend
+      on the choice of a reference map. "addToGroup" always merges sequentially.
+
       @htmlinclude OpenMS_FeatureGroupingAlgorithmUnlabeled.parameters
 
       @ingroup FeatureGrouping
@@ -123,6 +129,15 @@ public:
 
 private:
 
+    /// Returns the parameters for the StablePairFinder (without our own ones)
+    Param getPairFinderParameters_() const;
+
+    /// Adds all maps one after the other to the map with the most features
+    void groupSequential_(const std::vector<FeatureMap> & maps, ConsensusMap & out) const;
+
+    /// Merges the maps pairwise in a balanced binary tree, in parallel per level
+    void groupTree_(const std::vector<FeatureMap> & maps, ConsensusMap & out) const;
+
     // This vector should always have 2 elements
     // - the first element is the currently computed consensus map.
     //   After initialization of the algorithm, it will consist of the reference
@@ -84,14 +84,31 @@ public:
 
 private:
 
+    /**
+      @brief Collects RT values, transforms them all at once and hands them out again
+
+      A map is traversed twice in the same order: first to collect its RT
+      values, then (after the transformation) to assign the transformed values.
+    */
+    class RTBatch;
+
     /// apply a transformation to a feature
-    static void applyToFeature_(Feature & feature, const TransformationDescription & trafo);
+    static void applyToFeature_(Feature & feature, RTBatch & batch);
 
     /// apply a transformation to a basic feature
-    static void applyToBaseFeature_(BaseFeature & feature, const TransformationDescription & trafo);
+    static void applyToBaseFeature_(BaseFeature & feature, RTBatch & batch);
 
     /// apply a transformation to a consensus feature
-    static void applyToConsensusFeature_(ConsensusFeature & feature, const TransformationDescription & trafo);
+    static void applyToConsensusFeature_(ConsensusFeature & feature, RTBatch & batch);
+
+    /// apply a transformation to peptide identifications
+    static void applyToPeptideIdentifications_(std::vector<PeptideIdentification> & pepids, RTBatch & batch);
+
+    /// apply a transformation to all features and unassigned peptide identifications of a feature map
+    static void applyToFeatureMap_(FeatureMap & fmap, RTBatch & batch);
+
+    /// apply a transformation to all consensus features and unassigned peptide identifications of a consensus map
+    static void applyToConsensusMap_(ConsensusMap & cmap, RTBatch & batch);
 
   };
 } // namespace OpenMS
@@ -89,6 +89,15 @@ public:
     */
     double apply(double value) const;
 
+    /**
+      @brief Applies the transformation to all @p values (in place).
+
+      Same as calling apply(double) for each value, but evaluates the model
+      for all values at once, which is faster - especially if the values are
+      sorted in ascending order.
+    */
+    void apply(std::vector<double>& values) const;
+
     /// Gets the type of the fitted model
     const String& getModelType() const;
 
@@ -69,6 +69,16 @@ namespace OpenMS
     /// Evaluates the model at the given value
     virtual double evaluate(double value) const;
 
+    /**
+      @brief Evaluates the model at @p n values
+
+      Gives the same results as calling evaluate(double) for each value, but
+      is faster for many values: the values are processed in parallel (if
+      OpenMP is enabled) and derived models take advantage of sorted input.
+      @p in and @p out may point to the same array.
+    */
+    virtual void evaluate(const double* in, double* out, size_t n) const;
+
     /// Gets the (actual) parameters
     const Param& getParameters() const;
 
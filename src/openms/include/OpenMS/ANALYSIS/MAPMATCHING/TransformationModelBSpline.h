@@ -66,6 +66,9 @@ public:
     /// Evaluates the model at the given value
     virtual double evaluate(double value) const;
 
+    /// The B-spline locates the interval of a value in constant time, so the generic batch evaluation is used
+    using TransformationModel::evaluate;
+
     using TransformationModel::getParameters;
 
     /// Gets the default parameters
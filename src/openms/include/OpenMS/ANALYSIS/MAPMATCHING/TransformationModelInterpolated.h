@@ -71,6 +71,16 @@ public:
     /// Evaluates the model at the given value
     double evaluate(double value) const;
 
+    /**
+      @brief Evaluates the model at @p n values
+
+      For values sorted in ascending order, the interpolation walks through
+      the data points along with the values instead of searching the interval
+      of each value. The values are processed in chunks in parallel (if OpenMP
+      is enabled). Unsorted values are evaluated one by one.
+    */
+    void evaluate(const double* in, double* out, size_t n) const;
+
     /// Gets the default parameters
     static void getDefaultParameters(Param& params);
 
@@ -99,6 +109,23 @@ public:
        */
       virtual double eval(const double& x) const = 0;
 
+      /**
+       * @brief Evaluate the underlying interpolation at @p n positions.
+       *
+       * The default implementation calls eval(const double&) for each position.
+       *
+       * @param x The positions, sorted in ascending order and within the range of the data.
+       * @param y The interpolated values (may be the same array as @p x).
+       * @param n The number of positions.
+       */
+      virtual void eval(const double* x, double* y, size_t n) const
+      {
+        for (size_t i = 0; i < n; ++i)
+        {
+          y[i] = eval(x[i]);
+        }
+      }
+
       /**
        * @brief d'tor.
        */
@@ -68,6 +68,9 @@ public:
     /// Evaluates the model at the given value
     virtual double evaluate(double value) const;
 
+    /// Evaluates the model at @p n values (see TransformationModel::evaluate(const double*, double*, size_t) const)
+    virtual void evaluate(const double* in, double* out, size_t n) const;
+
     using TransformationModel::getParameters;
 
     /// Gets the "real" parameters
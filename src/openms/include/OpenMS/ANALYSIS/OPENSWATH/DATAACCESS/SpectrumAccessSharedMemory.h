@@ -0,0 +1,165 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_ANALYSIS_OPENSWATH_DATAACCESS_SPECTRUMACCESSSHAREDMEMORY_H
+#define OPENMS_ANALYSIS_OPENSWATH_DATAACCESS_SPECTRUMACCESSSHAREDMEMORY_H
+
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+
+#include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/ISpectrumAccess.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/SwathMap.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <vector>
+
+class QSharedMemory;
+
+namespace OpenMS
+{
+
+  /**
+    @brief An implementation of the Spectrum Access interface using shared memory
+
+    This class implements the OpenSWATH Spectrum Access interface
+    (ISpectrumAccess) on SWATH maps which one process has published in named
+    shared memory segments (see publishSwathMaps). Other processes attach to
+    these segments read-only (see attachSwathMaps), thus several concurrent
+    analyses of the same SWATH file share a single copy of the raw data.
+
+    For a published set of maps with the name @p key, the segment @p key
+    contains a table with the SWATH windows and the number of spectra of each
+    map. The spectra of map @em i are stored in the segment @p key_i using the
+    same binary layout as the cached mzML files (see CachedmzML and
+    SpectrumAccessOpenMSCached): the number of peaks, the MS level, the
+    retention time followed by the m/z and the intensity array.
+
+    The segments exist as long as at least one process is attached to them,
+    i.e. until the last SpectrumAccessSharedMemory object referring to them is
+    destroyed. Chromatograms are not supported.
+
+    @note Since the data is only read, this implementation is thread-safe and
+    lightClone is cheap (only the index of the spectra is copied).
+
+  */
+  class OPENMS_DLLAPI SpectrumAccessSharedMemory :
+    public OpenSwath::ISpectrumAccess
+  {
+
+public:
+    typedef boost::shared_ptr<QSharedMemory> SegmentPtr;
+
+    /**
+      @brief Constructor
+
+      @param table The (attached) segment containing the table of the SWATH maps
+      @param segment The (attached) segment containing the spectra
+      @param nr_spectra The number of spectra in the segment
+
+      @throws Exception::ParseError is thrown if the segment does not contain @p nr_spectra spectra
+    */
+    SpectrumAccessSharedMemory(SegmentPtr table, SegmentPtr segment, Size nr_spectra);
+
+    /**
+      @brief Destructor
+    */
+    ~SpectrumAccessSharedMemory();
+
+    /// Copy constructor
+    SpectrumAccessSharedMemory(const SpectrumAccessSharedMemory & rhs);
+
+    /// Light clone operator (actual data will not get copied)
+    boost::shared_ptr<OpenSwath::ISpectrumAccess> lightClone() const;
+
+    OpenSwath::SpectrumPtr getSpectrumById(int id);
+
+    OpenSwath::SpectrumMeta getSpectrumMetaById(int id) const;
+
+    std::vector<std::size_t> getSpectraByRT(double RT, double deltaRT) const;
+
+    size_t getNrSpectra() const;
+
+    /// Not supported, throws Exception::IndexOverflow
+    OpenSwath::ChromatogramPtr getChromatogramById(int id);
+
+    size_t getNrChromatograms() const;
+
+    /// Not supported, throws Exception::IndexOverflow
+    std::string getChromatogramNativeID(int id) const;
+
+    /**
+      @brief Publishes SWATH maps in shared memory
+
+      Copies the spectra of all @p swath_maps into shared memory segments
+      named after @p key and returns the maps backed by these segments in
+      @p shared_maps. The input maps are not needed any more afterwards.
+
+      @return false if SWATH maps with the name @p key are already published (or being published)
+
+      @throws Exception::FailedAPICall is thrown if a segment cannot be created
+    */
+    static bool publishSwathMaps(const std::vector<OpenSwath::SwathMap> & swath_maps, const String & key,
+                                 std::vector<OpenSwath::SwathMap> & shared_maps);
+
+    /**
+      @brief Attaches to SWATH maps published by another process
+
+      @return false if no SWATH maps with the name @p key are published (or they are still being published)
+
+      @throws Exception::FailedAPICall is thrown if a segment exists but cannot be attached
+      @throws Exception::ParseError is thrown if a segment has an invalid content
+    */
+    static bool attachSwathMaps(const String & key, std::vector<OpenSwath::SwathMap> & swath_maps);
+
+private:
+
+    /// Segment with the table of the SWATH maps (kept attached, the segments are freed after the last detach)
+    SegmentPtr table_;
+
+    /// Segment with the spectra
+    SegmentPtr segment_;
+
+    /// Start of the spectrum data
+    const char* data_;
+
+    /// Index: offset, retention time and MS level of each spectrum
+    std::vector<Size> spectra_index_;
+    std::vector<double> rt_;
+    std::vector<int> ms_level_;
+  };
+
+} //end namespace
+
+#endif
@@ -7,6 +7,7 @@ DataAccessHelper.h
 MRMFeatureAccessOpenMS.h
 SpectrumAccessOpenMS.h
 SpectrumAccessOpenMSCached.h
+SpectrumAccessSharedMemory.h
 SimpleOpenMSSpectraAccessFactory.h
 )
 
@@ -145,6 +145,25 @@ public:
     void dia_by_ion_score(SpectrumPtrType spectrum, AASequence& sequence,
                           int charge, double& bseries_score, double& yseries_score);
 
+    /**
+      @brief Isotope, massdiff and b/y ion scores computed together on one spectrum
+
+      Produces the same scores as calling dia_isotope_scores,
+      dia_massdiff_score and dia_by_ion_score on the same spectrum. All
+      extraction windows (isotopes and preceding peaks of every transition as
+      well as the b and y ions) are collected first and integrated in one
+      sweep over the spectrum, the theoretical isotope patterns are taken
+      from the averagine cache and the b/y series of the last peptide is
+      reused. This is the preferred entry point when scoring many peak groups
+      of the same transition group.
+    */
+    void dia_ms2_scores(const std::vector<TransitionType>& transitions, SpectrumPtrType spectrum,
+                        OpenSwath::IMRMFeature* mrmfeature, const std::vector<double>& normalized_library_intensity,
+                        AASequence& sequence, int by_charge,
+                        double& isotope_corr, double& isotope_overlap,
+                        double& ppm_score, double& ppm_score_weighted,
+                        double& bseries_score, double& yseries_score);
+
     /// Dotproduct / Manhatten score with theoretical spectrum
     void score_with_isotopes(SpectrumPtrType spectrum, const std::vector<TransitionType>& transitions,
                              double& dotprod, double& manhattan);
@@ -192,6 +211,17 @@ private:
     */
     void largePeaksBeforeFirstIsotope_(SpectrumPtrType spectrum, double mono_mz, double mono_int, int& nr_occurences, double& max_ratio);
 
+    /**
+      @brief Evaluation part of largePeaksBeforeFirstIsotope_
+
+      Expects the integrated windows at mono_mz - C13/ch for ch = 1 ..
+      dia_nr_charges_ at positions offset, offset + 1, ... of @p mz and @p
+      intensity (an intensity of zero denoting that no signal was found).
+    */
+    void largePeaksBeforeFirstIsotopeSub_(double mono_mz, double mono_int,
+                                          const std::vector<double>& mz, const std::vector<double>& intensity, Size offset,
+                                          int& nr_occurences, double& max_ratio);
+
     /**
       @brief Compare an experimental isotope pattern to a theoretical one
 
@@ -202,6 +232,24 @@ private:
     */
     double scoreIsotopePattern_(double product_mz, const std::vector<double>& isotopes_int, int putative_fragment_charge);
 
+    /**
+      @brief Theoretical averagine isotope pattern for a mass, scaled to a maximum of 1
+
+      The averagine estimate only depends on the rounded element composition
+      of the mass, thus masses are binned by composition and each pattern is
+      only computed once per bin (see averagine_cache_).
+    */
+    const std::vector<double>& getAveragineIsotopePattern_(double mass);
+
+    /// Averagine isotope patterns (scaled to a maximum of 1) keyed by packed averagine composition
+    std::map<UInt64, std::vector<double> > averagine_cache_;
+
+    /// Sequence, charge and b/y series of the last peptide scored with dia_ms2_scores
+    AASequence by_series_sequence_;
+    int by_series_charge_;
+    std::vector<double> bseries_cache_;
+    std::vector<double> yseries_cache_;
+
     // Parameters
     double dia_extract_window_;
     double dia_centroided_;
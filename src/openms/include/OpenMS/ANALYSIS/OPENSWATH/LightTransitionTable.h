@@ -0,0 +1,265 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_ANALYSIS_OPENSWATH_LIGHTTRANSITIONTABLE_H
+#define OPENMS_ANALYSIS_OPENSWATH_LIGHTTRANSITIONTABLE_H
+
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/TransitionExperiment.h>
+
+#include <map>
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+    @brief Compact, column-oriented storage of an assay library
+
+    Stores the transitions, peptides and proteins of a
+    OpenSwath::LightTargetedExperiment in one vector per field. All
+    identifiers and sequences are interned into a single string pool and
+    referenced by index, so each distinct string is stored only once. The
+    transitions (rows) are sorted by precursor m/z (and peptide), so that the
+    transitions of a SWATH window form a contiguous range of rows that can be
+    found by binary search and split into batches of whole peptides without
+    copying anything (see View). A LightTargetedExperiment is only created
+    for the rows of a single batch when it is needed (toLightTargetedExperiment).
+
+    The table can be stored to and loaded from a binary cache file. Loading
+    maps the file into memory and copies each column with a single memcpy,
+    which is much faster than parsing a TraML or TSV assay library again.
+
+    @note Transitions of one peptide are only guaranteed to be adjacent if
+    they share the same precursor m/z (as is the case for assay libraries).
+  */
+  class OPENMS_DLLAPI LightTransitionTable
+  {
+public:
+
+    /// A contiguous range of rows [begin, end) of the table
+    struct OPENMS_DLLAPI View
+    {
+      View();
+      View(Size begin, Size end);
+
+      /// Number of rows in the view
+      Size size() const;
+      /// Whether the view contains no rows
+      bool empty() const;
+
+      Size begin;
+      Size end;
+    };
+
+    /// Default constructor (empty table)
+    LightTransitionTable();
+
+    /// Construct from an assay library, see build()
+    explicit LightTransitionTable(const OpenSwath::LightTargetedExperiment& targeted_exp);
+
+    /// Destructor
+    virtual ~LightTransitionTable();
+
+    /**
+      @brief Fill the table from an assay library (replacing the current content)
+
+      @exception Exception::IllegalArgument is thrown if a transition references an unknown peptide
+    */
+    void build(const OpenSwath::LightTargetedExperiment& targeted_exp);
+
+    /// Remove all content
+    void clear();
+
+    /// @name Access
+    //@{
+    /// Number of transitions (rows)
+    Size size() const;
+
+    /// Number of peptides
+    Size getNrPeptides() const;
+
+    /// Number of proteins
+    Size getNrProteins() const;
+
+    /// View of all rows
+    View getAllRows() const;
+
+    double getPrecursorMZ(Size row) const;
+    double getProductMZ(Size row) const;
+    double getLibraryIntensity(Size row) const;
+    int getCharge(Size row) const;
+    bool isDecoy(Size row) const;
+    std::string getTransitionName(Size row) const;
+    std::string getPeptideRef(Size row) const;
+
+    /// Index of the peptide of a row (into the peptide columns)
+    Size getPeptideIndex(Size row) const;
+
+    /// Number of distinct peptides in a view
+    Size getNrPeptides(const View& view) const;
+
+    /// Recreate the transition of a row
+    void getTransition(Size row, OpenSwath::LightTransition& transition) const;
+
+    /// Recreate a peptide
+    void getPeptide(Size index, OpenSwath::LightPeptide& peptide) const;
+
+    /// Recreate a protein
+    void getProtein(Size index, OpenSwath::LightProtein& protein) const;
+    //@}
+
+    /**
+      @brief Rows whose precursor is within a SWATH window
+
+      Selects the same transitions as OpenSwathHelper::selectSwathTransitions,
+      i.e. lower < precursor m/z < upper and |upper - precursor m/z| >=
+      min_upper_edge_dist.
+    */
+    View selectSwath(double lower, double upper, double min_upper_edge_dist) const;
+
+    /**
+      @brief Split a view into consecutive batches of at most @p batch_size peptides
+
+      A peptide is never split across batches. With a @p batch_size of 0,
+      the whole view forms a single batch. Empty views yield no batches.
+    */
+    void splitIntoBatches(const View& view, Size batch_size, std::vector<View>& batches) const;
+
+    /**
+      @brief Create a LightTargetedExperiment for the rows of a view
+
+      Contains the transitions of the view (in table order), their peptides
+      and the proteins referenced by these peptides. The content of @p
+      targeted_exp is replaced.
+    */
+    void toLightTargetedExperiment(const View& view, OpenSwath::LightTargetedExperiment& targeted_exp) const;
+
+    /**
+      @brief Store the table in a binary cache file
+
+      The @p signature (e.g. name, size and modification time of the
+      library file) is stored with the table; load() only accepts the file
+      if the same signature is given.
+
+      The table is written to a temporary file first, which then replaces
+      @p filename, so readers never see a partially written cache.
+
+      @exception Exception::UnableToCreateFile is thrown if the file could not be written
+    */
+    void store(const String& filename, const String& signature) const;
+
+    /**
+      @brief Load the table from a binary cache file created by store()
+
+      The table is cleared first.
+
+      The columns are validated (lengths, offsets, string and peptide
+      indices, order of the rows), so a damaged file is rejected instead of
+      causing out-of-range accesses later.
+
+      @return False if the file does not exist, is not a (complete and
+      consistent) cache file or was stored with a different signature
+
+      @exception Exception::FileNotReadable is thrown if the file exists but could not be opened
+    */
+    bool load(const String& filename, const String& signature);
+
+protected:
+
+    /// Add a string to the pool (or find it) and return its index
+    UInt intern_(const std::string& s, std::map<std::string, UInt>& pool_index);
+
+    /// Get a string from the pool
+    std::string getString_(UInt index) const;
+
+    /// Create the protein lookup (protein id string -> protein index)
+    void updateProteinIndex_();
+
+    /// Check that all columns fit together (lengths, offsets, indices and row order), e.g. after loading
+    bool isConsistent_() const;
+
+    /// Apply @p visitor to every column of @p table (in the order of the cache file)
+    template <typename Table, typename ColumnVisitor>
+    static void visitColumns_(Table& table, ColumnVisitor& visitor);
+
+    /// @name String pool
+    //@{
+    std::vector<char> string_data_;
+    std::vector<UInt> string_offsets_;
+    //@}
+
+    /// @name Transition columns (one entry per row)
+    //@{
+    std::vector<double> precursor_mz_;
+    std::vector<double> product_mz_;
+    std::vector<double> library_intensity_;
+    std::vector<Int> charge_;
+    std::vector<UInt> transition_name_;
+    std::vector<UInt> peptide_;
+    /// decoy, detecting, quantifying and identifying flags (bits 0 - 3)
+    std::vector<Byte> flags_;
+    /// site identifying transitions and classes of row i are at [offsets[i], offsets[i + 1])
+    std::vector<UInt> site_transition_offsets_;
+    std::vector<Int> site_identifying_transition_;
+    std::vector<UInt> site_class_offsets_;
+    std::vector<UInt> site_identifying_class_;
+    //@}
+
+    /// @name Peptide columns
+    //@{
+    std::vector<UInt> peptide_id_;
+    std::vector<double> peptide_rt_;
+    std::vector<Int> peptide_charge_;
+    std::vector<UInt> peptide_sequence_;
+    std::vector<UInt> peptide_group_label_;
+    std::vector<UInt> protein_ref_offsets_;
+    std::vector<UInt> protein_refs_;
+    std::vector<UInt> modification_offsets_;
+    std::vector<Int> modification_location_;
+    std::vector<UInt> modification_unimod_id_;
+    //@}
+
+    /// @name Protein columns
+    //@{
+    std::vector<UInt> protein_id_;
+    std::vector<UInt> protein_sequence_;
+    //@}
+
+    /// Protein id (string index) to protein index, not stored
+    std::map<UInt, Size> protein_index_;
+  };
+}
+
+#endif // OPENMS_ANALYSIS_OPENSWATH_LIGHTTRANSITIONTABLE_H
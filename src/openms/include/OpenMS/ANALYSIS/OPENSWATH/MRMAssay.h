@@ -154,10 +154,10 @@ protected:
       @brief Check whether fragment ion are unique ion signatures in vector within threshold
 
       @param fragment_ion the queried fragment ion
-      @param ions a vector of fragment ions which could interfere with fragment_ion
+      @param ions a sorted vector of fragment ions which could interfere with fragment_ion
       @param mz_threshold the threshold within which to search for interferences
     */
-    bool isUIS_(const double fragment_ion, std::vector<double> ions, const double mz_threshold);
+    bool isUIS_(const double fragment_ion, const std::vector<double>& ions, const double mz_threshold);
 
     /**
       @brief Annotate fragment ions with site-specific attributes
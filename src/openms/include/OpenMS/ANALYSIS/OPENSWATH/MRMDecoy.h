@@ -83,6 +83,10 @@ namespace OpenMS
   Optionally, the m/z values are corrected to reflect the theoretical value rather
   than the experimental value in the library.
 
+  Peptides are processed in parallel (if OpenMP is enabled). The output does
+  not depend on the number of threads: shuffling uses a seed computed from
+  the peptide id, so the same input always produces the same decoys.
+
  */
 
   class OPENMS_DLLAPI MRMDecoy :
@@ -131,6 +135,23 @@ public:
 
     typedef std::map<String, std::vector<const ReactionMonitoringTransition*> > PeptideTransitionMapType;
 
+    /// A fragment ion of an ion series (see getFragmentIndex)
+    struct OPENMS_DLLAPI FragmentIon
+    {
+      /// m/z of the ion
+      double mz;
+      /// position of the ion type in the order b, y, b_loss, y_loss
+      Size series;
+      /// annotation of the ion (e.g. "b7^2")
+      String annotation;
+
+      /// Comparison by m/z
+      bool operator<(const FragmentIon& rhs) const;
+    };
+
+    /// Fragment ions sorted by m/z
+    typedef std::vector<FragmentIon> FragmentIndex;
+
     /**
       @brief Selects a decoy ion from a set of ions.
     */
@@ -141,8 +162,26 @@ public:
       @brief Selects a target ion from a set of ions.
     */
     std::pair<String, double> getTargetIon(double ProductMZ, double mz_threshold,
-                                           boost::unordered_map<String, boost::unordered_map<String, double> > target_ionseries,
+                                           const boost::unordered_map<String, boost::unordered_map<String, double> >& target_ionseries,
                                            bool enable_losses);
+
+    /**
+      @brief Selects a target ion from a fragment index (see getFragmentIndex)
+
+      Gives the same result as getTargetIon() on the ion series the index was
+      created from, but finds the candidate ions by binary search. Use this to
+      annotate several transitions of the same peptide.
+    */
+    std::pair<String, double> getTargetIon(double ProductMZ, double mz_threshold,
+                                           const FragmentIndex& target_index);
+
+    /**
+      @brief Create a fragment index (sorted by m/z) from an ion series
+
+      Contains the b and y ions and, if @p enable_losses is set, the b and y
+      ions with neutral losses.
+    */
+    void getFragmentIndex(const IonSeries& ionseries, bool enable_losses, FragmentIndex& index);
     /**
       @brief Generate all ion series for an input AASequence
 
@@ -106,6 +106,32 @@ private:
     static int residualOutlierCandidate(std::vector<double>& x, std::vector<double>& y);
 
 public:
+
+    /**
+      @brief Result of an iterative outlier removal (see removeOutliersIterative()).
+
+      Holds the remaining data points, the final linear fit y = intercept +
+      slope * x and the removal trace, i.e. the positions of the removed points
+      in the input (in the order of removal) together with the R^2 of the fit
+      right before each removal.
+    */
+    struct OPENMS_DLLAPI OutlierRemovalResult
+    {
+      /// The remaining data points (in input order)
+      std::vector<std::pair<double, double> > pairs;
+      /// Intercept of the final fit
+      double intercept;
+      /// Slope of the final fit
+      double slope;
+      /// R^2 of the final fit
+      double rsq;
+      /// Whether the R^2 of the final fit (@p rsq) reaches the limit
+      bool rsq_limit_reached;
+      /// Positions of the removed points in the input, in order of removal
+      std::vector<size_t> removed;
+      /// R^2 of the fit before each removal (same length as @p removed)
+      std::vector<double> removed_rsq;
+    };
  
     /**
       @brief This function removes potential outliers in a linear regression dataset.
@@ -153,7 +179,15 @@ public:
       @param d the number of close data values required to assert that a model fits well to data
       @param test disables the random component of the algorithm
 
+      The iterations are evaluated in parallel (if OpenMP is enabled). Each
+      iteration draws its sample from a random number generator seeded with
+      the iteration number, and of two equally good models the one of the
+      earlier iteration is kept, so the result does not depend on the number
+      of threads and is the same in every run.
+
       @return A vector of pairs
+
+      @exception Exception::IllegalArgument is thrown if @p n exceeds the number of data points
     */
     static std::vector<std::pair<double, double> > ransac(std::vector<std::pair<double, double> >& pairs, size_t n, size_t k, double t, size_t d, bool test = false); 
 
@@ -182,6 +216,7 @@ public:
 
       @exception Exception::UnableToFit is thrown if fitting cannot be
       performed (rsq_limit and coverage_limit cannot be fulfilled)
+      @exception Exception::IllegalArgument is thrown for less than 2 points or an invalid @p method
     */
     static std::vector<std::pair<double, double> > removeOutliersIterative(std::vector<std::pair<double, double> >& pairs,
                                                                double rsq_limit, 
@@ -189,6 +224,36 @@ public:
                                                                bool use_chauvenet,
                                                                std::string method);
 
+    /**
+      @brief Batch version of removeOutliersIterative() that also returns the fit and the removal trace.
+
+      The fit is maintained from running sums of the data points which are
+      updated on each removal, and the jackknife candidate is found from
+      closed-form leave-one-out statistics, so each iteration takes linear time
+      in the number of points.
+
+      In contrast to the version above, no exception is thrown if the R^2
+      limit is not reached; this is reported in @p result instead.
+
+      @param pairs Input data (paired data of type <experimental_rt, theoretical_rt>)
+      @param rsq_limit Minimal R^2 required
+      @param coverage_limit Minimal coverage required (the number of points
+      falls below this fraction, the algorithm aborts)
+      @param use_chauvenet Whether to only remove outliers that fulfill
+      Chauvenet's criterion for outliers
+      @param method Outlier detection method ("iter_jackknife" or "iter_residual")
+      @param result The remaining points, the final fit and the removal trace
+
+      @exception Exception::UnableToFit is thrown if no linear model can be fitted to the data
+      @exception Exception::IllegalArgument is thrown for less than 2 points or an invalid @p method
+    */
+    static void removeOutliersIterative(const std::vector<std::pair<double, double> >& pairs,
+                                        double rsq_limit,
+                                        double coverage_limit,
+                                        bool use_chauvenet,
+                                        const std::string& method,
+                                        OutlierRemovalResult& result);
+
     /**
       @brief This function computes Chauvenet's criterion probability for a vector
        and a value whose position is submitted.
@@ -50,6 +50,7 @@
 #include <OpenMS/DATASTRUCTURES/DefaultParamHandler.h>
 
 #include <numeric>
+#include <queue>
 
 // Cross-correlation
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/ALGO/Scoring.h>
@@ -138,12 +139,42 @@ public:
       // While there are still peaks left, one will be picked and used to create
       // a feature. Whenever we run out of peaks, we will get -1 back as index
       // and terminate.
+      //
+      // All picked peaks are put into a single max-heap once (instead of
+      // re-scanning all chromatograms with findLargestPeak for every feature).
+      // Peaks are only ever removed by setting their intensity to zero, so
+      // stale heap entries are simply skipped when they surface. Ties are
+      // broken by the lowest chromatogram and peak index (stored negated),
+      // which gives the same order as findLargestPeak.
+      std::priority_queue<std::pair<double, std::pair<int, int> > > candidates;
+      for (Size k = 0; k < picked_chroms_.size(); k++)
+      {
+        for (Size i = 0; i < picked_chroms_[k].size(); i++)
+        {
+          if (picked_chroms_[k][i].getIntensity() > 0.0)
+          {
+            candidates.push(std::make_pair(picked_chroms_[k][i].getIntensity(), std::make_pair(-(int)k, -(int)i)));
+          }
+        }
+      }
+
       int chr_idx, peak_idx, cnt = 0;
       std::vector<MRMFeature> features;
       while (true)
       {
         chr_idx = -1; peak_idx = -1;
-        findLargestPeak(picked_chroms_, chr_idx, peak_idx);
+        while (!candidates.empty())
+        {
+          int k = -candidates.top().second.first;
+          int i = -candidates.top().second.second;
+          candidates.pop();
+          if (picked_chroms_[k][i].getIntensity() > 0.0)
+          {
+            chr_idx = k;
+            peak_idx = i;
+            break;
+          }
+        }
         if (chr_idx == -1 && peak_idx == -1) break;
 
         // Compute a feature from the individual chromatograms and add non-zero features
@@ -489,33 +520,49 @@ protected:
         all_ints.push_back(int_here);
       }
 
-      // Compute the cross-correlation for the collected intensities
-      std::vector<double> mean_shapes;
-      std::vector<double> mean_coel;
+      // Compute the cross-correlation for the collected intensities. Each
+      // trace is standardized once and every pair is correlated only once
+      // using the dense cross-correlation; the lags of the reverse pair are
+      // read from the same array backwards.
+      const int n = boost::numeric_cast<int>(master_peak_container.size());
+      const int nr_traces = boost::numeric_cast<int>(all_ints.size());
       for (Size k = 0; k < all_ints.size(); k++)
       {
-        std::vector<double> shapes;
-        std::vector<double> coel;
-        for (Size i = 0; i < all_ints.size(); i++)
+        OpenSwath::Scoring::standardize_data(all_ints[k]);
+      }
+      std::vector<std::vector<double> > shapes(nr_traces), coel(nr_traces);
+      std::vector<double> xcorr(2 * n + 1), xcorr_reverse(2 * n + 1);
+      for (int k = 0; k < nr_traces && n > 0; k++)
+      {
+        for (int i = k + 1; i < nr_traces; i++)
         {
-          if (i == k) {continue;}
-          std::map<int, double> res = OpenSwath::Scoring::normalizedCrossCorrelation(
-              all_ints[k], all_ints[i], boost::numeric_cast<int>(all_ints[i].size()), 1);
+          OpenSwath::Scoring::calculateCrossCorrelationDense(&all_ints[k][0], &all_ints[i][0], n, n, &xcorr[0]);
+          for (int d = 0; d <= 2 * n; d++)
+          {
+            xcorr[d] /= n;
+            xcorr_reverse[2 * n - d] = xcorr[d];
+          }
 
           // the first value is the x-axis (retention time) and should be an int -> it show the lag between the two
-          double res_coelution = std::abs(OpenSwath::Scoring::xcorrArrayGetMaxPeak(res)->first);
-          double res_shape = std::abs(OpenSwath::Scoring::xcorrArrayGetMaxPeak(res)->second);
-
-          shapes.push_back(res_shape);
-          coel.push_back(res_coelution);
+          std::pair<int, double> max_peak = OpenSwath::Scoring::xcorrArrayGetMaxPeak(&xcorr[0], n);
+          shapes[k].push_back(std::abs(max_peak.second));
+          coel[k].push_back(std::abs(max_peak.first));
+          max_peak = OpenSwath::Scoring::xcorrArrayGetMaxPeak(&xcorr_reverse[0], n);
+          shapes[i].push_back(std::abs(max_peak.second));
+          coel[i].push_back(std::abs(max_peak.first));
         }
+      }
 
+      std::vector<double> mean_shapes;
+      std::vector<double> mean_coel;
+      for (int k = 0; k < nr_traces; k++)
+      {
         // We have computed the cross-correlation of chromatogram k against
         // all others. Use the mean of these computations as the value for k.
         OpenSwath::mean_and_stddev msc;
-        msc = std::for_each(shapes.begin(), shapes.end(), msc);
+        msc = std::for_each(shapes[k].begin(), shapes[k].end(), msc);
         double shapes_mean = msc.mean();
-        msc = std::for_each(coel.begin(), coel.end(), msc);
+        msc = std::for_each(coel[k].begin(), coel[k].end(), msc);
         double coel_mean = msc.mean();
 
         // mean shape scores below 0.5-0.6 should be a real sign of trouble ... !
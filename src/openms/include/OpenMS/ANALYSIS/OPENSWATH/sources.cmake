@@ -9,6 +9,7 @@ set(sources_list_h
   DIAHelper.h
   DIAPrescoring.h
   DIAScoring.h
+  LightTransitionTable.h
   MRMIonSeries.h
   MRMAssay.h
   MRMDecoy.h
@@ -39,6 +39,8 @@
 #include <OpenMS/KERNEL/Peak2D.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 
+#include <vector>
+
 namespace OpenMS
 {
   class IsobaricQuantitationMethod;
@@ -88,6 +90,11 @@ public:
 
       @param ms_exp_data Raw data to search for isobaric quantitation channels.
       @param consensus_map Output map containing the identified channels and the corresponding intensities.
+
+      The MS1 scans surrounding each tandem spectrum are determined in a single pass over the experiment.
+      Precursor purity and reporter intensities are then computed in parallel for all tandem spectra.
+
+      @exception Exception::MissingInformation if the experiment is empty or a selected tandem spectrum has no precursor
     */
     void extractChannels(const MSExperiment<Peak1D>& ms_exp_data, ConsensusMap& consensus_map);
 
@@ -133,6 +140,26 @@ private:
       bool followUpValid(const double rt);
     };
 
+    /**
+      @brief The MS1 scans surrounding a tandem spectrum that is quantified.
+
+      These are collected for all tandem spectra in a single pass over the experiment (using PuritySate_),
+      afterwards the spectra can be processed independently of each other.
+    */
+    struct ScanNeighbours_
+    {
+      /// Iterator pointing to the tandem spectrum
+      MSExperiment<Peak1D>::ConstIterator spectrum;
+      /// Iterator pointing to the potential MS1 precursor scan (only valid if hasPrecursorScan is true)
+      MSExperiment<Peak1D>::ConstIterator precursorScan;
+      /// Iterator pointing to the follow up MS1 scan (only valid if hasFollowUpScan is true)
+      MSExperiment<Peak1D>::ConstIterator followUpScan;
+      /// Indicates if a precursor scan was found
+      bool hasPrecursorScan;
+      /// Indicates if a follow up scan was found
+      bool hasFollowUpScan;
+    };
+
     /// The used quantitation method (itraq4plex, tmt6plex,..).
     const IsobaricQuantitationMethod* quant_method_;
 
@@ -183,13 +210,22 @@ private:
     bool hasLowIntensityReporter_(const ConsensusFeature& cf) const;
 
     /**
-      @brief Computes the purity of the precursor given an iterator pointing to the MS/MS spectrum and one to the precursor spectrum.
+      @brief Computes the purity of the precursor of a MS/MS spectrum given its surrounding MS1 scans.
 
-      @param ms2_spec Iterator pointing to the MS2 spectrum.
-      @param precursor Iterator pointing to the precursor spectrum of ms2_spec.
+      @param neighbours The MS/MS spectrum together with its precursor spectrum (which has to be available) and the following MS1 spectrum.
       @return Fraction of the total intensity in the isolation window of the precursor spectrum that was assigned to the precursor.
     */
-    double computePrecursorPurity_(const MSExperiment<Peak1D>::ConstIterator& ms2_spec, const PuritySate_& pState) const;
+    double computePrecursorPurity_(const ScanNeighbours_& neighbours) const;
+
+    /**
+      @brief Sums up the reporter ion intensities of all channels in the given MS/MS spectrum.
+
+      Channels below the minimum reporter intensity are set to zero.
+
+      @param spec The MS/MS spectrum.
+      @param channel_intensities Output range receiving one intensity per channel.
+    */
+    void extractReporterIntensities_(const MSExperiment<Peak1D>::SpectrumType& spec, std::vector<Peak2D::IntensityType>::iterator channel_intensities) const;
 
     /**
       @brief Computes the purity of the precursor given an iterator pointing to the MS/MS spectrum and a reference to the potential precursor spectrum.
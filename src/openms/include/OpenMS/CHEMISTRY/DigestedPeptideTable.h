@@ -0,0 +1,188 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_CHEMISTRY_DIGESTEDPEPTIDETABLE_H
+#define OPENMS_CHEMISTRY_DIGESTEDPEPTIDETABLE_H
+
+#include <OpenMS/CHEMISTRY/EnzymaticDigestion.h>
+
+#include <boost/unordered_set.hpp>
+
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+    @brief Table of unique (unmodified) peptides from the digestion of a protein database
+
+    Proteins are digested in parallel (see EnzymaticDigestion::digestUnmodifiedString()), and the resulting peptides are stored in a compact form:
+    All unique peptide sequences are kept in one contiguous buffer, and each peptide is represented by a small record (PeptideRecord) containing its offset and length in that buffer, the first protein it was found in, and its monoisotopic mass.
+    No AASequence objects are created, which makes this considerably faster and less memory-hungry than digesting every protein into AASequence objects and deduplicating them in a set of strings.
+
+    Proteins can be added in batches, e.g. directly from a FASTA file (see addFASTAFile()), which is streamed (see MappedFASTAFile) so the database does not need to fit into memory.
+
+    Peptides containing characters which are not known amino acids (according to ResidueDB) are skipped.
+
+    @ingroup Chemistry
+  */
+  class OPENMS_DLLAPI DigestedPeptideTable
+  {
+public:
+    /// Compact representation of a unique peptide
+    struct PeptideRecord
+    {
+      /// Offset of the sequence in the sequence buffer
+      Size offset;
+      /// Length of the sequence
+      UInt length;
+      /// Index of the (first) protein containing the peptide
+      UInt protein;
+      /// Position of the peptide in that protein
+      UInt position;
+      /// Monoisotopic mass of the (unmodified) peptide
+      double mass;
+    };
+
+    /**
+      @brief Constructor
+
+      @param digestion Digestion settings (enzyme, missed cleavages etc.)
+      @param min_length Minimal peptide length
+      @param max_length Maximal peptide length (0 = no limit)
+    */
+    DigestedPeptideTable(const EnzymaticDigestion& digestion, Size min_length = 1, Size max_length = 0);
+
+    /// Destructor
+    ~DigestedPeptideTable();
+
+    /**
+      @brief Digests the given proteins (one-letter codes) and adds all new peptides to the table
+
+      Proteins are numbered consecutively over all calls to addProteins()/addFASTAFile().
+
+      @return Number of new unique peptides
+    */
+    Size addProteins(const std::vector<String>& proteins);
+
+    /**
+      @brief Digests all proteins of a FASTA file and adds all new peptides to the table
+
+      The file is streamed and processed in batches of @p batch_size proteins.
+
+      @return Number of proteins read
+
+      @exception Exception::FileNotFound is thrown if the file does not exist.
+      @exception Exception::ParseError is thrown if the file is not a valid FASTA file.
+    */
+    Size addFASTAFile(const String& filename, Size batch_size = 10000);
+
+    /// Number of unique peptides
+    Size size() const;
+
+    /// Number of proteins that were digested
+    Size getProteinCount() const;
+
+    /**
+      @brief Returns the record of the peptide with index @p index
+
+      @exception Exception::IndexOverflow is thrown if the index is out of range
+    */
+    const PeptideRecord& getRecord(Size index) const;
+
+    /**
+      @brief Returns the sequence of the peptide with index @p index
+
+      @exception Exception::IndexOverflow is thrown if the index is out of range
+    */
+    String getSequence(Size index) const;
+
+    /// Removes all peptides and proteins
+    void clear();
+
+protected:
+    /// Hash function over the sequence of a record
+    struct RecordHash
+    {
+      const DigestedPeptideTable* table;
+
+      explicit RecordHash(const DigestedPeptideTable* t) : table(t) {}
+
+      std::size_t operator()(Size index) const;
+    };
+
+    /// Sequence equality of two records
+    struct RecordEqual
+    {
+      const DigestedPeptideTable* table;
+
+      explicit RecordEqual(const DigestedPeptideTable* t) : table(t) {}
+
+      bool operator()(Size left, Size right) const;
+    };
+
+    /// Digestion settings
+    EnzymaticDigestion digestion_;
+
+    /// Minimal peptide length
+    Size min_length_;
+
+    /// Maximal peptide length
+    Size max_length_;
+
+    /// Number of proteins digested so far
+    Size protein_count_;
+
+    /// Buffer with all unique peptide sequences
+    std::string sequences_;
+
+    /// Peptide records
+    std::vector<PeptideRecord> records_;
+
+    /// Index of unique peptides (indexes into records_)
+    boost::unordered_set<Size, RecordHash, RecordEqual> unique_;
+
+    /// Internal monoisotopic masses of the residues by one-letter code (negative for unknown residues)
+    std::vector<double> residue_masses_;
+
+private:
+    /// Not implemented
+    DigestedPeptideTable(const DigestedPeptideTable&);
+
+    /// Not implemented
+    DigestedPeptideTable& operator=(const DigestedPeptideTable&);
+  };
+
+} // namespace OpenMS
+
+#endif // OPENMS_CHEMISTRY_DIGESTEDPEPTIDETABLE_H
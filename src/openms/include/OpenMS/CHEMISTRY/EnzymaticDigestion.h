@@ -125,6 +125,18 @@ public:
     /// Performs the enzymatic digestion of a protein.
     void digest(const AASequence & protein, std::vector<AASequence> & output) const;
 
+    /**
+      @brief Performs the enzymatic digestion of an unmodified protein given as a string of one-letter codes.
+
+      Instead of constructing AASequence objects, only the peptide positions are reported (as pairs of start position and length in @p output), in the same order as digest() would report them.
+      This is considerably faster and allows to digest large databases without converting every protein.
+
+      Only peptides with a length between @p min_length and @p max_length (0 = no limit) are reported.
+
+      @return The number of peptides that were discarded because of their length
+    */
+    Size digestUnmodifiedString(const String & sequence, std::vector<std::pair<Size, Size> > & output, Size min_length = 1, Size max_length = 0) const;
+
     /// Returns the number of peptides a digestion of @p protein would yield under the current enzyme and missed cleavage settings.
     Size peptideCount(const AASequence & protein);
 
@@ -187,6 +199,9 @@ protected:
     /// tests if position pointed to by @p p (N-term side) is a valid cleavage site
     bool isCleavageSite_(const AASequence & sequence, const AASequence::ConstIterator & p) const;
 
+    /// tests if position @p pos (N-term side) of the one-letter code @p sequence is a valid cleavage site
+    bool isCleavageSite_(const String & sequence, Size pos) const;
+
     /// Number of missed cleavages
     SignedSize missed_cleavages_;
     /// Used enzyme
@@ -4,6 +4,7 @@ set(directory include/OpenMS/CHEMISTRY)
 ### list all header files of the directory here
 set(sources_list_h
 AASequence.h
+DigestedPeptideTable.h
 EdwardsLippertIterator.h
 EdwardsLippertIteratorTryptic.h
 Element.h
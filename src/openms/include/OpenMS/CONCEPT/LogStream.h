@@ -455,8 +455,24 @@ private:
 #define LOG_INFO \
   Log_info
 
-  /// Macro for general debugging information
+  /// @cond INTERNAL
+  // Debug output is also written from OpenMP parallel regions (e.g. by the
+  // peak pickers). Each LOG_DEBUG statement is a critical section there, the
+  // buffer of the global stream is not thread-safe.
+#ifdef _OPENMP
+#ifdef _MSC_VER
+#define OPENMS_LOG_DEBUG_CRITICAL_ __pragma(omp critical (OpenMS_Log_debug))
+#else
+#define OPENMS_LOG_DEBUG_CRITICAL_ _Pragma("omp critical (OpenMS_Log_debug)")
+#endif
+#else
+#define OPENMS_LOG_DEBUG_CRITICAL_
+#endif
+  /// @endcond
+
+  /// Macro for general debugging information (may be used in OpenMP parallel regions)
 #define LOG_DEBUG \
+  OPENMS_LOG_DEBUG_CRITICAL_ \
   Log_debug << __FILE__ << "(" << __LINE__ << "): "
 
   OPENMS_DLLAPI extern Logger::LogStream Log_fatal; ///< Global static instance of a LogStream to capture messages classified as fatal errors. By default it is bound to @b cerr.
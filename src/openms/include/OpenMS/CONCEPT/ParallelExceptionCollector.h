@@ -0,0 +1,158 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_CONCEPT_PARALLELEXCEPTIONCOLLECTOR_H
+#define OPENMS_CONCEPT_PARALLELEXCEPTIONCOLLECTOR_H
+
+#include <OpenMS/CONCEPT/Types.h>
+
+namespace OpenMS
+{
+  /**
+    @brief Keeps the first exception thrown inside a parallel loop and rethrows it after the loop
+
+    Exceptions must not leave an OpenMP region. Loops therefore catch everything per item and hand it to capture(),
+    which keeps the exception of the item with the lowest index. The reported error thus does not depend on the
+    number of threads or the scheduling. After the loop, rethrow() throws a copy of the exception with its original
+    type (all exceptions of Exception.h and the standard exceptions are recognized; other exceptions derived from
+    Exception::BaseException or std::exception are rethrown as their closest recognized base).
+
+    @code
+    ParallelExceptionCollector errors;
+    #pragma omp parallel for
+    for (SignedSize i = 0; i < (SignedSize)items.size(); ++i)
+    {
+      if (errors.hasErrorBefore(i)) continue; // the result is discarded anyway
+      try
+      {
+        process(items[i]);
+      }
+      catch (...)
+      {
+        errors.capture(i);
+      }
+    }
+    errors.rethrow();
+    @endcode
+
+    All methods are thread-safe.
+
+    @ingroup Concept
+  */
+  class OPENMS_DLLAPI ParallelExceptionCollector
+  {
+public:
+    /// Default constructor
+    ParallelExceptionCollector();
+
+    /// Destructor
+    ~ParallelExceptionCollector();
+
+    /**
+      @brief Records the exception that is currently handled for the item @p index
+
+      Must be called from within a catch block. The exception is kept if no item with a lower index failed before.
+      This method never throws.
+    */
+    void capture(Size index);
+
+    /// Returns if an exception was captured
+    bool hasError() const;
+
+    /// Returns if an exception was captured for an item with an index lower than @p index (i.e. the item can be skipped)
+    bool hasErrorBefore(Size index) const;
+
+    /// Returns the index of the first failing item (only meaningful if hasError() is true)
+    Size getErrorIndex() const;
+
+    /// Rethrows the captured exception with its original type and forgets it. Does nothing if no exception was captured.
+    void rethrow();
+
+    /// Forgets the captured exception
+    void clear();
+
+protected:
+    /// Type-erased copy of a captured exception
+    class Holder
+    {
+public:
+      virtual ~Holder() {}
+      virtual void rethrow() const = 0;
+    };
+
+    /// Typed copy of a captured exception
+    template <typename ExceptionType>
+    class TypedHolder :
+      public Holder
+    {
+public:
+      explicit TypedHolder(const ExceptionType& e) :
+        exception_(e)
+      {}
+
+      virtual void rethrow() const
+      {
+        throw exception_;
+      }
+
+protected:
+      ExceptionType exception_;
+    };
+
+    /// Stores @p holder for item @p index if it is the first error (takes ownership)
+    void store_(Size index, Holder* holder);
+
+    /// Creates a holder for the exception that is currently handled
+    static Holder* currentException_();
+
+    /// The first exception (may be null if there is an error, but its copy could not be allocated)
+    Holder* holder_;
+
+    /// Index of the first failing item
+    Size index_;
+
+    /// Whether an exception was captured
+    bool has_error_;
+
+private:
+    /// Not implemented
+    ParallelExceptionCollector(const ParallelExceptionCollector&);
+
+    /// Not implemented
+    ParallelExceptionCollector& operator=(const ParallelExceptionCollector&);
+  };
+
+} // namespace OpenMS
+
+#endif // OPENMS_CONCEPT_PARALLELEXCEPTIONCOLLECTOR_H
@@ -38,6 +38,7 @@
 #include <OpenMS/CONCEPT/Types.h>
 
 #include <map>
+#include <vector>
 
 namespace OpenMS
 {
@@ -50,6 +51,8 @@ namespace OpenMS
 
     Use startProgress, setProgress and endProgress for the actual logging.
 
+    Each startProgress / endProgress pair is recorded as a stage by the Profiler (if enabled), independent of the log type.
+
     @note All methods are const, so it can be used through a const reference or in const methods as well!
   */
   class OPENMS_DLLAPI ProgressLogger
@@ -127,6 +130,9 @@ protected:
 
     mutable ProgressLoggerImpl* current_logger_;
 
+    /// Handles of the Profiler stages opened by startProgress() of this logger (closed by endProgress())
+    mutable std::vector<Size> profiler_scopes_;
+
   };
 
 } // namespace OpenMS
@@ -13,6 +13,7 @@ FuzzyStringComparator.h
 GlobalExceptionHandler.h
 LogConfigHandler.h
 LogStream.h
+ParallelExceptionCollector.h
 Macros.h
 PrecisionWrapper.h
 ProgressLogger.h
@@ -0,0 +1,223 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_DATASTRUCTURES_PROTEINSUFFIXARRAY_H
+#define OPENMS_DATASTRUCTURES_PROTEINSUFFIXARRAY_H
+
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+
+#include <vector>
+
+class QFile;
+
+namespace OpenMS
+{
+  /**
+    @brief Suffix array over a set of protein sequences, for fast peptide look-up
+
+    All protein sequences are concatenated (separated by null characters) into one text, for which a suffix array is built. Peptides can then be found by binary search, either exactly or allowing up to a given number of ambiguous amino acids ('B', 'Z', 'X') in the proteins (see findTolerant()).
+
+    Optionally, a name (e.g. the accession) can be stored for every protein, so that the original protein database need not be read again when the index is reused.
+
+    The index can be stored in a binary file and loaded again later. Loading is cheap, because the file is memory-mapped, not parsed; sequences, names and suffixes are only read from disk as far as they are actually accessed. A user-defined signature (e.g. derived from the original FASTA file) is stored with the index, so outdated index files can be detected.
+
+    @note Sequences are normalized (see normalizeSequence()), so the same normalization should be applied to query peptides.
+
+    @note Index files use the native byte order and are not portable between platforms of different endianness. The total length of all protein sequences is limited to 2^32 - 1 characters.
+
+    @ingroup Datastructures
+  */
+  class OPENMS_DLLAPI ProteinSuffixArray
+  {
+public:
+    /// Occurrence of a peptide: protein index and (0-based) position in the protein
+    typedef std::pair<Size, Size> Occurrence;
+
+    /// Default constructor
+    ProteinSuffixArray();
+
+    /// Destructor
+    ~ProteinSuffixArray();
+
+    /**
+      @brief Builds the index for a set of protein sequences
+
+      Protein indexes in the results of queries correspond to positions in @p proteins.
+
+      @param proteins Protein sequences
+      @param names Protein names (same order as @p proteins), or empty
+
+      @exception Exception::InvalidSize is thrown if the sequences or names are too long in total
+      @exception Exception::InvalidParameter is thrown if @p names is not empty, but of a different size than @p proteins
+    */
+    void build(const std::vector<String>& proteins, const std::vector<String>& names = std::vector<String>());
+
+    /**
+      @brief Stores the index in a file
+
+      The index is written to a temporary file first, which then replaces @p filename. Processes that have loaded (memory-mapped) an older version of the file are not affected.
+
+      @param filename Output file
+      @param signature Identifies the data the index was built from (checked when loading)
+
+      @exception Exception::UnableToCreateFile is thrown if the file cannot be written
+    */
+    void store(const String& filename, const String& signature) const;
+
+    /**
+      @brief Loads an index from a file (by memory-mapping it)
+
+      @return False (and leaves the index unchanged) if the file does not exist, is not a valid index file, or has a different signature
+
+      @exception Exception::FileNotReadable is thrown if the file exists, but cannot be read
+    */
+    bool load(const String& filename, const String& signature);
+
+    /// Number of proteins in the index
+    Size size() const;
+
+    /**
+      @brief Returns the (normalized) sequence of a protein
+
+      The sequence is not copied: the result points into the index and is null-terminated. It stays valid until the index is rebuilt, loaded again or destroyed.
+
+      @exception Exception::IndexOverflow is thrown for an invalid index
+    */
+    const char* getProtein(Size index) const;
+
+    /**
+      @brief Returns the length of the sequence of a protein
+
+      @exception Exception::IndexOverflow is thrown for an invalid index
+    */
+    Size getProteinLength(Size index) const;
+
+    /**
+      @brief Returns the name of a protein (empty if no names were given)
+
+      Like the sequence, the name is null-terminated and points into the index.
+
+      @exception Exception::IndexOverflow is thrown for an invalid index
+    */
+    const char* getName(Size index) const;
+
+    /// Finds all exact occurrences of a (normalized) peptide sequence
+    void findExact(const String& peptide, std::vector<Occurrence>& hits) const;
+
+    /**
+      @brief Finds all occurrences of a (normalized) peptide sequence, allowing ambiguous amino acids in the proteins
+
+      An ambiguous amino acid in a protein matches any residue that it represents ('B': 'D'/'N', 'Z': 'E'/'Q', 'X': all). Every such match counts towards the limit @p max_aaa. Ambiguous amino acids in the peptide only match the same character in a protein (this is how X! Tandem reports results).
+
+      Exact occurrences are included in the results.
+    */
+    void findTolerant(const String& peptide, Size max_aaa, std::vector<Occurrence>& hits) const;
+
+    /**
+      @brief Converts a sequence to the alphabet used by the index
+
+      Converts lower-case letters to upper-case and replaces all characters that are not standard or ambiguous amino acid codes by 'X'.
+    */
+    static void normalizeSequence(String& seq);
+
+protected:
+    /// Concatenated protein sequences (owned, if the index was built in memory)
+    String text_data_;
+
+    /// Suffix array (owned, if the index was built in memory)
+    std::vector<UInt> suffixes_data_;
+
+    /// Start positions of the proteins in the text, plus end of text (owned, if the index was built in memory)
+    std::vector<UInt> starts_data_;
+
+    /// Concatenated protein names (owned, if the index was built in memory)
+    String names_data_;
+
+    /// Start positions of the protein names, plus end (owned, if the index was built in memory)
+    std::vector<UInt> name_starts_data_;
+
+    /// Memory-mapped index file (if the index was loaded)
+    QFile* file_;
+
+    /// Concatenated protein sequences
+    const char* text_;
+
+    /// Length of the concatenated protein sequences
+    Size text_length_;
+
+    /// Suffix array
+    const UInt* suffixes_;
+
+    /// Number of suffixes (excluding those starting with separators)
+    Size suffixes_length_;
+
+    /// Start positions of the proteins
+    const UInt* starts_;
+
+    /// Number of proteins
+    Size n_proteins_;
+
+    /// Concatenated protein names
+    const char* names_;
+
+    /// Start positions of the protein names
+    const UInt* name_starts_;
+
+    /// Returns the character at position @p pos of the text (or '\0' at the end)
+    char charAt_(Size pos) const;
+
+    /// Narrows a range of suffixes (sharing a prefix of length @p depth) to those with character @p c at position @p depth
+    void narrow_(Size& first, Size& last, Size depth, char c) const;
+
+    /// Recursive part of findTolerant()
+    void findTolerant_(const String& peptide, Size depth, Size aaa_left, Size first, Size last, std::vector<Size>& ranges) const;
+
+    /// Converts a range of suffixes to occurrences
+    void addOccurrences_(Size first, Size last, std::vector<Occurrence>& hits) const;
+
+    /// Releases memory-mapped data
+    void unmap_();
+
+private:
+    /// Not implemented
+    ProteinSuffixArray(const ProteinSuffixArray&);
+
+    /// Not implemented
+    ProteinSuffixArray& operator=(const ProteinSuffixArray&);
+  };
+
+} // namespace OpenMS
+
+#endif // OPENMS_DATASTRUCTURES_PROTEINSUFFIXARRAY_H
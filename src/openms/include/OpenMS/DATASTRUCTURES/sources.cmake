@@ -31,6 +31,7 @@ Map.h
 MassExplainer.h
 Matrix.h
 Param.h
+ProteinSuffixArray.h
 QTCluster.h
 SeqanIncludeWrapper.h
 SparseVector.h
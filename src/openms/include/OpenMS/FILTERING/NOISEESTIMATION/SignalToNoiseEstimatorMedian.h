@@ -389,6 +389,9 @@ protected:
       // warn if percentage of sparse windows is above 20%
       if (sparse_window_percent_ > 20 && write_log_messages_)
       {
+#ifdef _OPENMP
+#pragma omp critical (OpenMS_Log_warn) // estimators also run in parallel regions
+#endif
         LOG_WARN << "WARNING in SignalToNoiseEstimatorMedian: "
                  << sparse_window_percent_
                  << "% of all windows were sparse. You should consider increasing 'win_len' or decreasing 'min_required_elements'"
@@ -398,6 +401,9 @@ protected:
       // warn if percentage of possibly wrong median estimates is above 1%
       if (histogram_oob_percent_ > 1 && write_log_messages_)
       {
+#ifdef _OPENMP
+#pragma omp critical (OpenMS_Log_warn) // estimators also run in parallel regions
+#endif
         LOG_WARN << "WARNING in SignalToNoiseEstimatorMedian: "
                  << histogram_oob_percent_
                  << "% of all Signal-to-Noise estimates are too high, because the median was found in the rightmost histogram-bin. "
@@ -0,0 +1,171 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_FORMAT_DATAACCESS_MSDATAPARALLELTRANSFORMINGCONSUMER_H
+#define OPENMS_FORMAT_DATAACCESS_MSDATAPARALLELTRANSFORMINGCONSUMER_H
+
+#include <OpenMS/INTERFACES/IMSDataConsumer.h>
+
+#include <vector>
+
+namespace OpenMS
+{
+
+  /**
+    @brief Transforming consumer of MS data which processes several spectra in parallel
+
+    Incoming spectra are collected until a window of @p window_size spectra
+    is full. The window is then transformed by all available threads, after
+    which the spectra are passed on to the next consumer in the order in which
+    they were consumed. Chromatograms are treated the same way. Thus, memory
+    usage is bounded by the window size, independent of the size of the data.
+
+    The transformation is given as an object derived from
+    MSDataParallelTransformingConsumer::Transformation. Its functions are
+    called from several threads at once and thus must not modify any shared
+    state.
+
+    Since spectra are passed on with a delay, this consumer owns the rest of
+    the processing chain (use an MSDataChainingConsumer as next consumer if
+    there is more than one step). It can itself be part of a chain, as long
+    as the consumers after it in that chain do not rely on the transformation.
+
+    @note Call flush() after the last spectrum/chromatogram (e.g. after
+    MzMLFile::transform), before the next consumer is destroyed. The
+    destructor calls it as well, but the next consumer must still exist then.
+  */
+  class OPENMS_DLLAPI MSDataParallelTransformingConsumer :
+    public Interfaces::IMSDataConsumer<>
+  {
+
+  public:
+    typedef MSExperiment<> MapType;
+    typedef MapType::SpectrumType SpectrumType;
+    typedef MapType::ChromatogramType ChromatogramType;
+
+    /**
+      @brief The transformation applied to each spectrum and chromatogram
+
+      The functions are called concurrently and must be thread-safe.
+    */
+    class OPENMS_DLLAPI Transformation
+    {
+    public:
+      /// Destructor
+      virtual ~Transformation();
+
+      /// Transforms the spectrum @p s in place
+      virtual void transformSpectrum(SpectrumType & s) const = 0;
+
+      /// Transforms the chromatogram @p c in place (default: nothing happens)
+      virtual void transformChromatogram(ChromatogramType & c) const;
+    };
+
+    /**
+      @brief Constructor
+
+      @param transformation The transformation to apply (not copied, must outlive the consumer)
+      @param next The consumer which receives the transformed data (no ownership is taken)
+      @param window_size The number of spectra (or chromatograms) which are transformed in parallel
+    */
+    MSDataParallelTransformingConsumer(const Transformation & transformation,
+                                       Interfaces::IMSDataConsumer<> * next, Size window_size = 100);
+
+    /// Destructor (flushes remaining data)
+    virtual ~MSDataParallelTransformingConsumer();
+
+    /// Passes the expected sizes on to the next consumer
+    virtual void setExpectedSize(Size expectedSpectra, Size expectedChromatograms);
+
+    /// Passes the experimental settings on to the next consumer
+    virtual void setExperimentalSettings(const ExperimentalSettings & exp);
+
+    /**
+      @brief Consumes a spectrum
+
+      A copy of @p s is transformed and passed on later, @p s itself is not modified.
+    */
+    virtual void consumeSpectrum(SpectrumType & s);
+
+    /**
+      @brief Consumes a chromatogram
+
+      A copy of @p c is transformed and passed on later, @p c itself is not modified.
+    */
+    virtual void consumeChromatogram(ChromatogramType & c);
+
+    /**
+      @brief Transforms all pending data and passes it on to the next consumer
+
+      @exception Exception::BaseException The error of the first pending spectrum (or chromatogram) for which the
+      transformation failed is rethrown with its original type. The pending data is dropped then, as it is if the
+      next consumer throws.
+    */
+    void flush();
+
+    /// Returns the window size
+    Size getWindowSize() const;
+
+  protected:
+    /// Transforms the pending spectra and passes them on
+    void flushSpectra_();
+
+    /// Transforms the pending chromatograms and passes them on
+    void flushChromatograms_();
+
+    /// Applies @p transform to all elements of @p pending in parallel (rethrows the error of the first failing element)
+    template <typename DataType>
+    void transformPending_(std::vector<DataType> & pending, void (Transformation::* transform)(DataType &) const);
+
+    /// The transformation
+    const Transformation & transformation_;
+    /// The consumer which receives the transformed data
+    Interfaces::IMSDataConsumer<> * next_;
+    /// Number of spectra/chromatograms transformed in parallel
+    Size window_size_;
+    /// Spectra waiting to be transformed
+    std::vector<SpectrumType> pending_spectra_;
+    /// Chromatograms waiting to be transformed
+    std::vector<ChromatogramType> pending_chromatograms_;
+
+  private:
+    /// Not implemented
+    MSDataParallelTransformingConsumer(const MSDataParallelTransformingConsumer &);
+    /// Not implemented
+    MSDataParallelTransformingConsumer & operator=(const MSDataParallelTransformingConsumer &);
+  };
+
+} //end namespace OpenMS
+
+#endif // OPENMS_FORMAT_DATAACCESS_MSDATAPARALLELTRANSFORMINGCONSUMER_H
@@ -38,12 +38,16 @@
 #include <OpenMS/INTERFACES/IMSDataConsumer.h>
 
 #include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/FORMAT/SpectrumMetaIndex.h>
 #include <OpenMS/FORMAT/HANDLERS/MzMLHandler.h>
+#include <OpenMS/CONCEPT/ParallelExceptionCollector.h>
 #include <OpenMS/CONCEPT/ProgressLogger.h>
 
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <fstream>
+#include <sstream>
 #include <boost/shared_ptr.hpp>
 
 namespace OpenMS
@@ -71,6 +75,7 @@ namespace OpenMS
       consumer->consumeSpectrum(spec);
       consumer->consumeChromatogram(chrom);
       [...]
+      consumer->flush(); // optional, reports errors of spectra still pending in the writing window
       delete consumer;
       @endcode
 
@@ -85,6 +90,10 @@ namespace OpenMS
       inconsistent mzML if the count attribute of spectrumList or
       chromatogramList is incorrect.
 
+      @note If PeakFileOptions::setWriteSpectrumMetaIndex is set (see
+      setOptions), a SpectrumMetaIndex of the written spectra is stored next
+      to the mzML file when the consumer is destroyed.
+
     */
     class OPENMS_DLLAPI MSDataWritingConsumer : 
       public Internal::MzMLHandler< MSExperiment<> >,
@@ -110,7 +119,9 @@ namespace OpenMS
         chromatograms_written_(0),
         spectra_expected_(0),
         chromatograms_expected_(0),
-        add_dataprocessing_(false)
+        add_dataprocessing_(false),
+        writing_window_(1),
+        write_failed_(false)
       {
         validator_ = new Internal::MzMLValidator(this->mapping_, this->cv_);
 
@@ -165,6 +176,7 @@ namespace OpenMS
       */
       virtual void consumeSpectrum(SpectrumType & s)
       {
+        checkNotFailed_();
         if (writing_chromatograms_)
         {
           throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__,
@@ -181,6 +193,11 @@ namespace OpenMS
           scpy.getDataProcessing().push_back(additional_dataprocessing_);
         }
 
+        if (options_.getWriteSpectrumMetaIndex())
+        {
+          meta_index_.addSpectrum(scpy);
+        }
+
         if (!started_writing_)
         {
           // This is the first data to be written -> start writing the header
@@ -202,11 +219,31 @@ namespace OpenMS
           ofs_ << "\t\t<spectrumList count=\"" << spectra_expected_ << "\" defaultDataProcessingRef=\"dp_sp_0\">\n";
           writing_spectra_ = true;
         }
+        if (writing_window_ > 1)
+        {
+          // encoding is deferred until the window is full
+          pending_spectra_.push_back(scpy);
+          ++spectra_written_;
+          if (pending_spectra_.size() >= writing_window_)
+          {
+            writePendingSpectra_();
+          }
+          return;
+        }
+
         bool renew_native_ids = false;
         // TODO writeSpectrum assumes that dps_ has at least one value -> assert
         // this here ...
-        Internal::MzMLHandler<MapType>::writeSpectrum_(ofs_, scpy,
-                spectra_written_++, *validator_, renew_native_ids, dps_);
+        try
+        {
+          Internal::MzMLHandler<MapType>::writeSpectrum_(ofs_, scpy,
+                  spectra_written_++, *validator_, renew_native_ids, dps_);
+        }
+        catch (...)
+        {
+          write_failed_ = true;
+          throw;
+        }
       }
 
       /**
@@ -219,6 +256,9 @@ namespace OpenMS
       */
       virtual void consumeChromatogram(ChromatogramType & c)
       {
+        checkNotFailed_();
+        writePendingSpectra_();
+
         // make sure to close an open List tag
         if (writing_spectra_)
         {
@@ -255,8 +295,16 @@ namespace OpenMS
           writing_chromatograms_ = true;
           writing_spectra_ = false;
         }
-        Internal::MzMLHandler<MapType>::writeChromatogram_(ofs_, ccpy,
-                chromatograms_written_++, *validator_);
+        try
+        {
+          Internal::MzMLHandler<MapType>::writeChromatogram_(ofs_, ccpy,
+                  chromatograms_written_++, *validator_);
+        }
+        catch (...)
+        {
+          write_failed_ = true;
+          throw;
+        }
       }
       //@}
 
@@ -276,6 +324,8 @@ namespace OpenMS
 
       /**
         @brief Return the number of spectra written.
+
+        Spectra still pending in the writing window (see setWritingWindow) are included.
       */
       virtual Size getNrSpectraWritten() {return spectra_written_;}
       /**
@@ -283,6 +333,44 @@ namespace OpenMS
       */
       virtual Size getNrChromatogramsWritten() {return chromatograms_written_;}
 
+      /**
+        @brief Sets the number of spectra which are encoded in parallel.
+
+        With a window larger than one, spectra are collected until @p window_size
+        of them are pending. These are then encoded (Base64, compression,
+        numpress) by all available threads, while the encoded spectra are
+        written to disk in the order in which they were consumed. Thus the
+        output is identical to the one of sequential writing, but at most
+        @p window_size spectra are held in memory additionally.
+
+        A window of one (the default) writes each spectrum immediately.
+
+        @note Spectra still pending are written when a chromatogram is consumed,
+        when flush() is called and when the consumer is destroyed. Errors can
+        only be reported by flush(), the destructor just logs them.
+      */
+      void setWritingWindow(Size window_size)
+      {
+        writePendingSpectra_();
+        writing_window_ = std::max(window_size, Size(1));
+      }
+
+      /// Returns the number of spectra which are encoded in parallel (see setWritingWindow)
+      Size getWritingWindow() const {return writing_window_;}
+
+      /**
+        @brief Writes the spectra still pending in the writing window (see setWritingWindow).
+
+        Call this after the last spectrum was consumed to get errors reported.
+        After an error, nothing more is written and the file is incomplete.
+
+        @exception Exception::BaseException (or std::bad_alloc) The error of the first spectrum which could not be written
+      */
+      void flush()
+      {
+        writePendingSpectra_();
+      }
+
     private:
 
       /// @name Data Processing using the template method pattern
@@ -305,13 +393,36 @@ namespace OpenMS
       /**
         @brief Cleanup function called by the destructor.
 
-        Will write the last tags to the file and close the file stream.
+        Will write the last tags to the file and close the file stream. Never
+        throws: errors are logged, and after a failed write the file is closed
+        without the remaining tags and the index.
       */
       virtual void doCleanup_()
       {
         //--------------------------------------------------------------------------------------------
         //cleanup
         //--------------------------------------------------------------------------------------------
+        try
+        {
+          writePendingSpectra_();
+        }
+        catch (std::exception& e)
+        {
+          LOG_ERROR << "Error while writing '" << file_ << "': " << e.what() << std::endl;
+        }
+        catch (...)
+        {
+          LOG_ERROR << "Unknown error while writing '" << file_ << "'." << std::endl;
+        }
+
+        if (write_failed_)
+        {
+          LOG_ERROR << "The file '" << file_ << "' is incomplete." << std::endl;
+          delete validator_;
+          ofs_.close();
+          return;
+        }
+
         // make sure to close an open List tag
         if (writing_spectra_)
         {
@@ -328,6 +439,91 @@ namespace OpenMS
 
         delete validator_;
         ofs_.close();
+
+        if (started_writing_ && options_.getWriteSpectrumMetaIndex())
+        {
+          meta_index_.setOffsets(spectra_offsets);
+          meta_index_.setChromatogramCount(chromatograms_written_);
+          try
+          {
+            meta_index_.storeSidecar(file_);
+          }
+          catch (...) // called from the destructor, must not throw (e.g. std::bad_alloc while writing)
+          {
+            LOG_WARN << "Could not write the spectrum index '" << SpectrumMetaIndex::getIndexFilename(file_) << "'." << std::endl;
+          }
+        }
+      }
+
+      /**
+        @brief Encodes the pending spectra in parallel and writes them in order.
+
+        Each thread encodes one spectrum at a time into a buffer; the buffers
+        are appended to the file strictly in the order of consumption, which
+        is also where the offsets for the index are recorded.
+      */
+      void writePendingSpectra_()
+      {
+        if (pending_spectra_.empty()) return;
+        if (write_failed_)
+        {
+          pending_spectra_.clear();
+          return;
+        }
+
+        Size first_index = spectra_written_ - pending_spectra_.size();
+        ParallelExceptionCollector errors;
+#ifdef _OPENMP
+#pragma omp parallel for ordered schedule(dynamic, 1)
+#endif
+        for (SignedSize i = 0; i < (SignedSize)pending_spectra_.size(); ++i)
+        {
+          const SpectrumType& spec = pending_spectra_[i];
+          std::ostringstream buffer;
+          buffer.precision(ofs_.precision());
+          if (!errors.hasErrorBefore(i)) // nothing after the first failing spectrum is written
+          {
+            try
+            {
+              Internal::MzMLHandler<MapType>::writeSpectrumElement_(buffer, spec,
+                      first_index + i, spec.getNativeID(), *validator_, dps_);
+            }
+            catch (...) // exceptions must not leave the parallel region
+            {
+              errors.capture(i);
+            }
+          }
+
+#ifdef _OPENMP
+#pragma omp ordered
+#endif
+          {
+            if (!errors.hasErrorBefore(i + 1))
+            {
+              // same offset as recorded by writeSpectrum_ (start of the <spectrum tag)
+              long offset = ofs_.tellp();
+              spectra_offsets.push_back(std::make_pair(spec.getNativeID(), offset + 3));
+              ofs_ << buffer.str();
+            }
+          }
+        }
+        pending_spectra_.clear();
+
+        if (errors.hasError())
+        {
+          write_failed_ = true;
+          errors.rethrow();
+        }
+      }
+
+      /// Throws if an earlier write failed (the file is incomplete, nothing more is written)
+      void checkNotFailed_() const
+      {
+        if (write_failed_)
+        {
+          throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+              "Cannot write to '" + file_ + "' after a failed write.");
+        }
       }
 
     protected:
@@ -361,6 +557,14 @@ namespace OpenMS
       std::vector<std::vector<DataProcessing> > dps_;
       /// The dataprocessing to be added to each spectrum/chromatogram
       DataProcessing additional_dataprocessing_;
+      /// Number of spectra which are encoded in parallel (1 = no buffering)
+      Size writing_window_;
+      /// Spectra consumed but not yet written (at most writing_window_)
+      std::vector<SpectrumType> pending_spectra_;
+      /// Summary of the consumed spectra (only if the spectrum index is to be written)
+      SpectrumMetaIndex meta_index_;
+      /// Whether writing a spectrum or chromatogram failed (nothing more is written then)
+      bool write_failed_;
     };
 
     /**
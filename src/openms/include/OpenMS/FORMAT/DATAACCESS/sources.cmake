@@ -7,6 +7,7 @@ MSDataWritingConsumer.h
 MSDataTransformingConsumer.h
 MSDataCachedConsumer.h
 MSDataChainingConsumer.h
+MSDataParallelTransformingConsumer.h
 NoopMSDataConsumer.h
 SwathFileConsumer.h
 )
@@ -38,6 +38,7 @@
 #include <OpenMS/CONCEPT/Exception.h>
 #include <OpenMS/DATASTRUCTURES/String.h>
 
+#include <iosfwd>
 #include <vector>
 
 namespace OpenMS
@@ -108,6 +109,13 @@ public:
     */
     void store(const String& filename, const std::vector<FASTAEntry>& data) const;
 
+    /**
+      @brief writes a single entry to the stream 'os' (in the same format as store())
+
+      Useful for writing large databases entry by entry, without keeping them in memory.
+    */
+    static void writeEntry(std::ostream& os, const FASTAEntry& entry);
+
   };
 
 } // namespace OpenMS
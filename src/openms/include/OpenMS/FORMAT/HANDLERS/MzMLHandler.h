@@ -36,6 +36,7 @@
 #define OPENMS_FORMAT_HANDLERS_MZMLHANDLER_H
 
 #include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/CONCEPT/ParallelExceptionCollector.h>
 #include <OpenMS/CONCEPT/ProgressLogger.h>
 #include <OpenMS/CONCEPT/VersionInfo.h>
 
@@ -241,6 +242,12 @@ public:
         chromatogram_counts = chromatogram_count;
       }
 
+      /// Get the byte offsets of the spectra written by writeTo (native ID and position of the spectrum element)
+      const std::vector<std::pair<std::string, long> >& getSpectraOffsets() const
+      {
+        return spectra_offsets;
+      }
+
       /// Set the IMSDataConsumer consumer which will consume the read data
       void setMSDataConsumer(Interfaces::IMSDataConsumer<MapType>* consumer)
       {
@@ -264,6 +271,15 @@ protected:
                           Internal::MzMLValidator& validator, bool renew_native_ids,
                           std::vector<std::vector<DataProcessing> >& dps);
 
+      /**
+        @brief Writes the spectrum element of @p spec with the id @p native_id
+
+        In contrast to writeSpectrum_, the offset of the element is not recorded for the index.
+        The handler is not modified, so several spectra can be written to different streams concurrently.
+      */
+      void writeSpectrumElement_(std::ostream& os, const SpectrumType& spec, Size s, const String& native_id,
+                                 Internal::MzMLValidator& validator, const std::vector<std::vector<DataProcessing> >& dps);
+
       void writeChromatogram_(std::ostream& os, const ChromatogramType& chromatogram, Size c, Internal::MzMLValidator& validator);
 
       template <typename ContainerT>
@@ -1125,6 +1141,12 @@ protected:
 
       if (tag == "spectrum")
       {
+        //skip spectra that were not selected (scan_count is the position of this spectrum)
+        if (options_.hasSpectrumIndices() && !options_.containsSpectrumIndex(scan_count))
+        {
+          skip_spectrum_ = true;
+          return;
+        }
         //number of peaks
         spec_ = SpectrumType();
         default_array_length_ = attributeAsInt_(attributes, s_default_array_length);
@@ -3966,13 +3988,46 @@ protected:
           warning(STORE, String("Invalid native IDs detected. Using spectrum identifier nativeID format (spectrum=xsd:nonNegativeInteger) for all spectra."));
         }
 
-        //write actual data
-        for (Size s = 0; s < exp.size(); ++s)
+        //write actual data: the spectra are encoded (Base64, compression, numpress) in parallel and
+        //appended to the stream in their order, which is also where the offsets for the index are recorded
+        ParallelExceptionCollector errors;
+#ifdef _OPENMP
+#pragma omp parallel for ordered schedule(dynamic, 1)
+#endif
+        for (SignedSize s = 0; s < (SignedSize)exp.size(); ++s)
         {
-          logger_.setProgress(progress++);
           const SpectrumType& spec = exp[s];
-          writeSpectrum_(os, spec, s, validator, renew_native_ids, dps);
+          const String native_id = renew_native_ids ? String("spectrum=") + (Size)s : spec.getNativeID();
+          std::ostringstream buffer;
+          buffer.precision(os.precision());
+          if (!errors.hasErrorBefore(s)) // nothing after the first failing spectrum is written
+          {
+            try
+            {
+              writeSpectrumElement_(buffer, spec, s, native_id, validator, dps);
+            }
+            catch (...) // exceptions must not leave the parallel region
+            {
+              errors.capture(s);
+            }
+          }
+
+#ifdef _OPENMP
+#pragma omp ordered
+#endif
+          {
+            if (!errors.hasErrorBefore(s + 1))
+            {
+              logger_.setProgress(progress++);
+              // same offset as recorded by writeSpectrum_ (start of the <spectrum tag)
+              long offset = os.tellp();
+              spectra_offsets.push_back(std::make_pair(native_id, offset + 3));
+              os << buffer.str();
+            }
+          }
         }
+        // the error of the first failing spectrum, with its original type
+        errors.rethrow();
         os << "\t\t</spectrumList>\n";
       }
 
@@ -4925,7 +4980,16 @@ protected:
       long offset = os.tellp();
       spectra_offsets.push_back(make_pair(native_id, offset + 3));
 
-      // IMPORTANT make sure the offset (above) corresponds to the start of the <spectrum tag
+      writeSpectrumElement_(os, spec, s, native_id, validator, dps);
+    }
+
+    template <typename MapType>
+    void MzMLHandler<MapType>::writeSpectrumElement_(std::ostream& os,
+                                                     const SpectrumType& spec, Size s, const String& native_id,
+                                                     Internal::MzMLValidator& validator,
+                                                     const std::vector<std::vector<DataProcessing> >& dps)
+    {
+      // IMPORTANT make sure the offset (see writeSpectrum_) corresponds to the start of the <spectrum tag
       os << "\t\t\t<spectrum id=\"" << writeXMLEscape(native_id) << "\" index=\"" << s << "\" defaultArrayLength=\"" << spec.size() << "\"";
       if (spec.getSourceFile() != SourceFile())
       {
@@ -0,0 +1,150 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_FORMAT_MAPPEDFASTAFILE_H
+#define OPENMS_FORMAT_MAPPEDFASTAFILE_H
+
+#include <OpenMS/FORMAT/FASTAFile.h>
+
+class QFile;
+
+namespace OpenMS
+{
+  /**
+    @brief Streaming, memory-mapped reader for FASTA files
+
+    In contrast to FASTAFile::load(), the file is not read into memory as a whole. Instead, it is memory-mapped and the entries are returned one by one by readNext(). Entries are lightweight views (pointers and lengths) into the mapped file, so nothing is copied until the identifier, description or sequence is actually requested. This makes it possible to stream through very large databases (several GB), letting the operating system page the data in and out as needed.
+
+    Parsing follows FASTAFile::load(): The header line (after '>') is split into identifier and description at the first whitespace, and all lines up to the next header make up the sequence (whitespace removed).
+
+    @note Entry views are only valid as long as the file is open.
+
+    @ingroup FileIO
+  */
+  class OPENMS_DLLAPI MappedFASTAFile
+  {
+public:
+    /// View of a FASTA entry in the mapped file
+    struct OPENMS_DLLAPI Entry
+    {
+      /// Header line (without '>' and line break)
+      const char* header;
+      /// Length of the header line
+      Size header_length;
+      /// Sequence lines (possibly including line breaks)
+      const char* sequence;
+      /// Length of the sequence lines
+      Size sequence_length;
+
+      /// Default constructor
+      Entry();
+
+      /// Returns the identifier (first word of the header)
+      String getIdentifier() const;
+
+      /// Returns the description (rest of the header)
+      String getDescription() const;
+
+      /// Returns the sequence (whitespace removed) in @p seq
+      void getSequence(String& seq) const;
+
+      /// Converts to a FASTAFile entry (copying the data)
+      FASTAFile::FASTAEntry toFASTAEntry() const;
+    };
+
+    /// Default constructor
+    MappedFASTAFile();
+
+    /// Destructor
+    ~MappedFASTAFile();
+
+    /**
+      @brief Opens (and memory-maps) a FASTA file
+
+      @exception Exception::FileNotFound is thrown if the file does not exist.
+      @exception Exception::FileNotReadable is thrown if the file cannot be read or mapped.
+    */
+    void open(const String& filename);
+
+    /// Closes the file (invalidating all entry views)
+    void close();
+
+    /// Is a file open?
+    bool isOpen() const;
+
+    /**
+      @brief Reads the next entry
+
+      @return False if the end of the file was reached
+
+      @exception Exception::ParseError is thrown if there is unexpected content before the first entry.
+    */
+    bool readNext(Entry& entry);
+
+    /// Goes back to the first entry
+    void reset();
+
+    /// Current position in the file (in bytes, e.g. for progress reporting)
+    Size getPosition() const;
+
+    /// Size of the file (in bytes)
+    Size getFileSize() const;
+
+protected:
+    /// Memory-mapped file
+    QFile* file_;
+
+    /// Name of the open file
+    String filename_;
+
+    /// Mapped file content
+    const char* data_;
+
+    /// Size of the mapped file
+    Size size_;
+
+    /// Current position in the file
+    Size position_;
+
+private:
+    /// Not implemented
+    MappedFASTAFile(const MappedFASTAFile&);
+
+    /// Not implemented
+    MappedFASTAFile& operator=(const MappedFASTAFile&);
+  };
+
+} // namespace OpenMS
+
+#endif // OPENMS_FORMAT_MAPPEDFASTAFILE_H
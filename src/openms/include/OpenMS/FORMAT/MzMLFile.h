@@ -38,6 +38,7 @@
 #include <OpenMS/FORMAT/XMLFile.h>
 #include <OpenMS/FORMAT/HANDLERS/MzMLHandler.h>
 #include <OpenMS/FORMAT/OPTIONS/PeakFileOptions.h>
+#include <OpenMS/FORMAT/SpectrumMetaIndex.h>
 #include <OpenMS/CONCEPT/ProgressLogger.h>
 #include <OpenMS/CONCEPT/Exception.h>
 #include <OpenMS/METADATA/DocumentIdentifier.h>
@@ -103,6 +104,8 @@ public:
 
       @p map has to be a MSExperiment or have the same interface.
 
+      If PeakFileOptions::getWriteSpectrumMetaIndex() is set, a SpectrumMetaIndex of the spectra is stored next to the file (see SpectrumMetaIndex::getIndexFilename()).
+
       @exception Exception::UnableToCreateFile is thrown if the file could not be created
     */
     template <typename MapType>
@@ -111,6 +114,14 @@ public:
       Internal::MzMLHandler<MapType> handler(map, filename, getVersion(), *this);
       handler.setOptions(options_);
       save_(filename, &handler);
+
+      if (options_.getWriteSpectrumMetaIndex())
+      {
+        SpectrumMetaIndex index;
+        index.build(map);
+        index.setOffsets(handler.getSpectraOffsets());
+        index.storeSidecar(filename);
+      }
     }
 
     /**
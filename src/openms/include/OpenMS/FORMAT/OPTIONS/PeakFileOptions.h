@@ -123,6 +123,25 @@ public:
     const std::vector<Int> & getMSLevels() const;
     //@}
 
+    /**
+        @name Spectrum selection option
+
+        Restricts loading to the spectra with the given (0-based) positions in the file, e.g. as determined from a SpectrumMetaIndex.
+        All other spectra are skipped before any of their data is decoded.
+    */
+    //@{
+    ///sets the positions of the spectra to load
+    void setSpectrumIndices(const std::vector<Size> & indices);
+    ///clears the spectrum selection (all spectra are loaded)
+    void clearSpectrumIndices();
+    ///returns @c true, if a spectrum selection has been set
+    bool hasSpectrumIndices() const;
+    ///returns @c true, if the spectrum at position @p index has been selected
+    bool containsSpectrumIndex(Size index) const;
+    ///returns the selected spectrum positions (sorted)
+    const std::vector<Size> & getSpectrumIndices() const;
+    //@}
+
     /**
         @name Compression options
 
@@ -184,6 +203,11 @@ public:
     /// Whether to write an index at the end of the file (e.g. indexedmzML file format)
     void setWriteIndex(bool write_index);
 
+    /// Whether to write a SpectrumMetaIndex next to the file (mzML only)
+    bool getWriteSpectrumMetaIndex() const;
+    /// Whether to write a SpectrumMetaIndex next to the file (mzML only)
+    void setWriteSpectrumMetaIndex(bool write_index);
+
     /// Set numpress configuration options for m/z or rt dimension
     MSNumpressCoder::NumpressConfig getNumpressConfigurationMassTime() const;
     /// Get numpress configuration options for m/z or rt dimension
@@ -221,6 +245,8 @@ private:
     DRange<1> mz_range_;
     DRange<1> intensity_range_;
     std::vector<Int> ms_levels_;
+    bool has_spectrum_indices_;
+    std::vector<Size> spectrum_indices_;
     bool zlib_compression_;
     bool size_only_;
     bool always_append_data_;
@@ -229,6 +255,7 @@ private:
     bool sort_chromatograms_by_rt_;
     bool fill_data_;
     bool write_index_;
+    bool write_spectrum_meta_index_;
     MSNumpressCoder::NumpressConfig np_config_mz_;
     MSNumpressCoder::NumpressConfig np_config_int_;
     Size maximal_data_pool_size_;
@@ -0,0 +1,243 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_FORMAT_SPECTRUMMETAINDEX_H
+#define OPENMS_FORMAT_SPECTRUMMETAINDEX_H
+
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+    @brief Compact per-spectrum summary of an mzML file, stored next to the file
+
+    For every spectrum of a file (in file order), the index keeps the retention time, MS level, first precursor (m/z, charge), total ion current, base peak, number of peaks, m/z and intensity range and the byte offset of the @a spectrum element (if known).
+    This is enough to answer the questions asked by FileInfo or to decide which spectra a FileFilter run will keep, without parsing (let alone decoding) the mzML file again.
+
+    The index is stored as a small binary "sidecar" file (see getIndexFilename()).
+    It is written by MzMLFile::store() and by MSDataWritingConsumer if PeakFileOptions::setWriteSpectrumMetaIndex() is set, or built in a single pass over an existing file (build()).
+    The size and modification time of the mzML file are stored with the index, so an outdated sidecar is detected and ignored by loadSidecar().
+
+    @note Index files use the native byte order and are not portable between platforms of different endianness.
+
+    @ingroup FileIO
+  */
+  class OPENMS_DLLAPI SpectrumMetaIndex
+  {
+public:
+    /// Summary of one spectrum
+    struct Entry
+    {
+      /// Retention time
+      double rt;
+      /// m/z of the first precursor (0 if there is none)
+      double precursor_mz;
+      /// Sum of all peak intensities
+      double tic;
+      /// Position of the most intense peak (0 for empty spectra)
+      double base_peak_mz;
+      /// Intensity of the most intense peak (0 for empty spectra)
+      double base_peak_intensity;
+      /// Smallest m/z (0 for empty spectra)
+      double min_mz;
+      /// Largest m/z (0 for empty spectra)
+      double max_mz;
+      /// Smallest intensity (0 for empty spectra)
+      double min_intensity;
+      /// Largest intensity (0 for empty spectra)
+      double max_intensity;
+      /// Byte offset of the spectrum element in the mzML file (-1 if unknown)
+      Int64 offset;
+      /// Number of peaks
+      UInt64 peak_count;
+      /// Number of precursors
+      UInt64 precursor_count;
+      /// MS level
+      Int32 ms_level;
+      /// Charge of the first precursor (0 if there is none or it is unknown)
+      Int32 precursor_charge;
+
+      /// Default constructor
+      Entry();
+    };
+
+    /// Default constructor
+    SpectrumMetaIndex();
+
+    /// Destructor
+    ~SpectrumMetaIndex();
+
+    /// Removes all entries
+    void clear();
+
+    /// Number of spectra in the index
+    Size size() const;
+
+    /// Returns the entries (in the order of the spectra in the file)
+    const std::vector<Entry>& getEntries() const;
+
+    /// Number of chromatograms in the file
+    Size getChromatogramCount() const;
+
+    /// Sets the number of chromatograms in the file
+    void setChromatogramCount(Size count);
+
+    /// Appends the summary of a spectrum (the next one in the file)
+    template <typename SpectrumType>
+    void addSpectrum(const SpectrumType& spectrum, Int64 offset = -1)
+    {
+      Entry entry;
+      entry.rt = spectrum.getRT();
+      entry.ms_level = spectrum.getMSLevel();
+      entry.precursor_count = spectrum.getPrecursors().size();
+      if (!spectrum.getPrecursors().empty())
+      {
+        entry.precursor_mz = spectrum.getPrecursors()[0].getMZ();
+        entry.precursor_charge = spectrum.getPrecursors()[0].getCharge();
+      }
+      entry.peak_count = spectrum.size();
+      entry.offset = offset;
+      for (typename SpectrumType::ConstIterator it = spectrum.begin(); it != spectrum.end(); ++it)
+      {
+        double mz = it->getMZ(), intensity = it->getIntensity();
+        entry.tic += intensity;
+        if (it == spectrum.begin())
+        {
+          entry.min_mz = entry.max_mz = entry.base_peak_mz = mz;
+          entry.min_intensity = entry.max_intensity = entry.base_peak_intensity = intensity;
+          continue;
+        }
+        if (mz < entry.min_mz) entry.min_mz = mz;
+        if (mz > entry.max_mz) entry.max_mz = mz;
+        if (intensity < entry.min_intensity) entry.min_intensity = intensity;
+        if (intensity > entry.max_intensity)
+        {
+          entry.max_intensity = entry.base_peak_intensity = intensity;
+          entry.base_peak_mz = mz;
+        }
+      }
+      entries_.push_back(entry);
+    }
+
+    /// Builds the index for all spectra (and the chromatogram count) of a map, e.g. before or after storing it
+    template <typename MapType>
+    void build(const MapType& map)
+    {
+      clear();
+      entries_.reserve(map.size());
+      for (typename MapType::ConstIterator it = map.begin(); it != map.end(); ++it)
+      {
+        addSpectrum(*it);
+      }
+      chromatogram_count_ = map.getChromatograms().size();
+    }
+
+    /**
+      @brief Builds the index of an mzML file in a single pass
+
+      All spectra are read (one at a time, not kept in memory).
+      Byte offsets are taken from the index of an indexedmzML file; for other files they remain unknown.
+
+      @exception Exception::FileNotFound is thrown if the file could not be opened
+      @exception Exception::ParseError is thrown if an error occurs during parsing
+    */
+    void build(const String& mzml_file);
+
+    /**
+      @brief Sets the byte offsets of the spectra, as recorded while writing an mzML file
+
+      The offsets are ignored if their number differs from the number of entries.
+    */
+    void setOffsets(const std::vector<std::pair<std::string, long> >& offsets);
+
+    /// Returns @c true if the retention times are non-decreasing
+    bool isSortedByRT() const;
+
+    /**
+      @brief Stores the index in a file
+
+      @param filename Output file
+      @param signature Identifies the data the index was built from (checked when loading)
+
+      @exception Exception::UnableToCreateFile is thrown if the file cannot be written
+    */
+    void store(const String& filename, const String& signature) const;
+
+    /**
+      @brief Loads an index from a file
+
+      @return False (and leaves the index unchanged) if the file does not exist, is not a valid index file, or has a different signature
+
+      @exception Exception::FileNotReadable is thrown if the file exists, but cannot be read
+    */
+    bool load(const String& filename, const String& signature);
+
+    /**
+      @brief Stores the index as the sidecar of an mzML file (see getIndexFilename())
+
+      @exception Exception::UnableToCreateFile is thrown if the file cannot be written
+    */
+    void storeSidecar(const String& mzml_file) const;
+
+    /**
+      @brief Loads the sidecar index of an mzML file
+
+      @return False if there is no sidecar, or if it is outdated (the mzML file was changed after the index was written)
+
+      @exception Exception::FileNotReadable is thrown if the sidecar exists, but cannot be read
+    */
+    bool loadSidecar(const String& mzml_file);
+
+    /// Name of the sidecar index file of an mzML file (<tt>@p mzml_file + ".smi"</tt>)
+    static String getIndexFilename(const String& mzml_file);
+
+    /// Signature of an mzML file (from its size and modification time), stored with its sidecar index
+    static String getSignature(const String& mzml_file);
+
+protected:
+    /// Entries, in the order of the spectra in the file
+    std::vector<Entry> entries_;
+
+    /// Number of chromatograms in the file
+    Size chromatogram_count_;
+  };
+
+} // namespace OpenMS
+
+#endif // OPENMS_FORMAT_SPECTRUMMETAINDEX_H
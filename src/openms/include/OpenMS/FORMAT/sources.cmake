@@ -56,6 +56,7 @@ MascotInfile.h
 MascotGenericFile.h
 MascotRemoteQuery.h
 MascotXMLFile.h
+MappedFASTAFile.h
 MsInspectFile.h
 MzDataFile.h
 MzMLFile.h
@@ -75,6 +76,7 @@ ProtXMLFile.h
 SequestInfile.h
 SequestOutfile.h
 SpecArrayFile.h
+SpectrumMetaIndex.h
 SVOutStream.h
 SwathFile.h
 TextFile.h
@@ -43,6 +43,7 @@
 #include <OpenMS/METADATA/ExperimentalSettings.h>
 #include <OpenMS/FORMAT/IndexedMzMLFile.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/FORMAT/SpectrumMetaIndex.h>
 
 #include <vector>
 #include <algorithm>
@@ -62,6 +63,10 @@ namespace OpenMS
     data item. The caller is responsible to ensure that access is performed
     atomically.
 
+    If an up-to-date SpectrumMetaIndex is stored next to the file, it is
+    loaded as well (see getSpectrumMetaIndex). It allows to select spectra
+    (e.g. by RT, MS level or precursor) without reading their meta data.
+
   */
   template <typename PeakT = Peak1D, typename ChromatogramPeakT = ChromatogramPeak>
   class OnDiscMSExperiment
@@ -69,7 +74,10 @@ namespace OpenMS
 
 public:
 
-    OnDiscMSExperiment() {}
+    OnDiscMSExperiment() :
+      has_spectrum_meta_index_(false)
+    {
+    }
 
     /**
       @brief Constructor
@@ -77,7 +85,8 @@ public:
       This initializes the object and attempts to read the indexed mzML by
       parsing the index and then reading the meta information into memory.
     */
-    OnDiscMSExperiment(const String& filename)
+    OnDiscMSExperiment(const String& filename) :
+      has_spectrum_meta_index_(false)
     {
       openFile(filename);
     }
@@ -90,6 +99,7 @@ public:
       {
         loadMetaData_(filename);
       }
+      loadSpectrumMetaIndex_(filename);
       return indexed_mzml_file_.getParsingSuccess();
     }
 
@@ -97,7 +107,9 @@ public:
     OnDiscMSExperiment(const OnDiscMSExperiment& source) :
       filename_(source.filename_),
       indexed_mzml_file_(source.indexed_mzml_file_),
-      meta_ms_experiment_(source.meta_ms_experiment_)
+      meta_ms_experiment_(source.meta_ms_experiment_),
+      spectrum_meta_index_(source.spectrum_meta_index_),
+      has_spectrum_meta_index_(source.has_spectrum_meta_index_)
     {
     }
 
@@ -130,6 +142,8 @@ public:
     */
     bool isSortedByRT() const
     {
+      if (has_spectrum_meta_index_) return spectrum_meta_index_.isSortedByRT();
+
       return meta_ms_experiment_->isSorted(false);
     }
 
@@ -240,6 +254,18 @@ public:
       indexed_mzml_file_.setSkipXMLChecks(skip);
     }
 
+    /// returns whether an up-to-date SpectrumMetaIndex was found next to the file
+    bool hasSpectrumMetaIndex() const
+    {
+      return has_spectrum_meta_index_;
+    }
+
+    /// returns the SpectrumMetaIndex of the file (empty, if hasSpectrumMetaIndex() is @c false)
+    const SpectrumMetaIndex& getSpectrumMetaIndex() const
+    {
+      return spectrum_meta_index_;
+    }
+
 private:
     /// Private Assignment operator -> we cannot copy file streams in IndexedMzMLFile
     OnDiscMSExperiment& operator=(const OnDiscMSExperiment& /* source */) {}
@@ -255,6 +281,28 @@ private:
       f.load(filename, *meta_ms_experiment_.get());
     }
 
+    void loadSpectrumMetaIndex_(const String& filename)
+    {
+      spectrum_meta_index_.clear();
+      has_spectrum_meta_index_ = false;
+      if (filename == "") return;
+
+      try
+      {
+        has_spectrum_meta_index_ = spectrum_meta_index_.loadSidecar(filename);
+      }
+      catch (Exception::FileNotReadable& /* e */)
+      {
+        // the index is optional
+      }
+      // an index not matching the file index is of no use
+      if (has_spectrum_meta_index_ && (spectrum_meta_index_.size() != indexed_mzml_file_.getNrSpectra()))
+      {
+        spectrum_meta_index_.clear();
+        has_spectrum_meta_index_ = false;
+      }
+    }
+
 
 protected:
 
@@ -264,6 +312,10 @@ protected:
     IndexedMzMLFile indexed_mzml_file_;
     /// The meta-data
     boost::shared_ptr<MSExperiment<> > meta_ms_experiment_;
+    /// Summary of the spectra (from the sidecar index file, if present)
+    SpectrumMetaIndex spectrum_meta_index_;
+    /// Whether an up-to-date spectrum index was loaded
+    bool has_spectrum_meta_index_;
   };
 
 } // namespace OpenMS
@@ -88,6 +88,20 @@ public:
      */
     double eval(double x) const;
 
+    /**
+     * @brief evaluates the spline at n positions sorted in ascending order
+     *
+     * Instead of searching the knot interval for each position, the knots
+     * are traversed once along with the positions.
+     *
+     * @param x x-positions (sorted in ascending order)
+     * @param y output array for the spline values (may be the same as @p x)
+     * @param n number of positions
+     *
+     * @exception Exception::IllegalArgument is thrown if a position is outside of the knots
+     */
+    void eval(const double* x, double* y, size_t n) const;
+
     /**
      * @brief evaluates derivative of spline at position x
      *
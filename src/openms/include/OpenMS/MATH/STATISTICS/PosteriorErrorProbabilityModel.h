@@ -54,6 +54,9 @@ namespace OpenMS
 
       This class fits either a Gumbel distribution and a Gauss distribution to a set of data points or two Gaussian distributions using the EM algorithm.
       One can output the fit as a gnuplot formula using getGumbelGnuplotFormula() and getGaussGnuplotFormula() after fitting.
+
+      The EM iterations use fused density, posterior and log-likelihood kernels over contiguous arrays, which are parallelized using OpenMP (if enabled). Sums are accumulated per fixed-size chunk and combined in order, so the results do not depend on the number of threads.
+      For very large inputs, the parameter @p fit_bins allows to run the EM algorithm on a fine histogram of the scores instead, using the bin counts as weights.
       @note All parameters are stored in GaussFitResult. In the case of the Gumbel distribution x0 and sigma represent the local parameter alpha and the scale parameter beta, respectively.
 
       @htmlinclude OpenMS_Math::PosteriorErrorProbabilityModel.parameters
@@ -172,6 +175,16 @@ private:
       PosteriorErrorProbabilityModel & operator=(const PosteriorErrorProbabilityModel & rhs);
       ///Copy constructor (not implemented)
       PosteriorErrorProbabilityModel(const PosteriorErrorProbabilityModel & rhs);
+      /// fills the (Gauss) densities of both distributions for all scores and returns the weighted sum of negative posteriors using the current prior
+      double fillDensitiesFast_(const std::vector<double> & x_scores, const std::vector<double> & weights, std::vector<double> & incorrect_density, std::vector<double> & correct_density) const;
+      /// computes the weighted log-likelihood of the mixture
+      double computeLogLikelihoodFast_(const std::vector<double> & weights, const std::vector<double> & incorrect_density, const std::vector<double> & correct_density) const;
+      /// computes the weighted sums of the posteriors and of the posterior-weighted scores (E-step)
+      void sumPosteriorsFast_(const std::vector<double> & x_scores, const std::vector<double> & weights, const std::vector<double> & incorrect_density, const std::vector<double> & correct_density, double & sum_posterior, double & one_minus_sum_posterior, double & sum_negative_x0, double & sum_positive_x0) const;
+      /// computes the weighted, posterior-weighted sums of squared deviations from the new means (M-step)
+      void sumSigmasFast_(const std::vector<double> & x_scores, const std::vector<double> & weights, const std::vector<double> & incorrect_density, const std::vector<double> & correct_density, double positive_mean, double negative_mean, double & sum_positive_sigma, double & sum_negative_sigma) const;
+      /// bins the sorted scores into @p number_of_bins equidistant bins, storing the mean score and the number of scores of each non-empty bin
+      void binScores_(const std::vector<double> & x_scores, Size number_of_bins, std::vector<double> & bin_scores, std::vector<double> & bin_counts) const;
       ///stores parameters for incorrectly assigned sequences. If gumbel fit was used, A can be ignored. Furthermore, in this case, x0 and sigma are the local parameter alpha and scale parameter beta, respectively.
       GaussFitter::GaussFitResult incorrectly_assigned_fit_param_;
       ///stores gauss parameters
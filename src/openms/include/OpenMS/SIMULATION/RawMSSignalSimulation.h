@@ -196,6 +196,26 @@ protected:
     /// Compress signals in a single RT scan (to merge signals which were sampled overlapping)
     void compressSignals_(SimTypes::MSSimExperiment& experiment);
 
+    /**
+      @brief Compress the signals of a single spectrum onto the m/z grid @p grid (see compressSignals_())
+
+      Points are summed up at their closest grid point, points beyond the end of the grid are dropped.
+      The spectrum is sorted if necessary. @p grid needs at least three points.
+    */
+    void compressSpectrum_(SimTypes::MSSimExperiment::SpectrumType& spectrum, const std::vector<SimTypes::SimCoordinateType>& grid) const;
+
+    /**
+      @brief Append the signals sampled for one feature to scan @p scan
+
+      While features are sampled in parallel (see generateRawSignals()), this locks the scan and
+      compresses it onto the m/z grid once it grew too large. Otherwise the points are just appended.
+    */
+    void addToScan_(const Size scan,
+                    const std::vector<SimTypes::SimPointType>& points,
+                    const std::vector<SimTypes::SimPointType>& points_ct,
+                    SimTypes::MSSimExperiment::SpectrumType& spectrum,
+                    SimTypes::MSSimExperiment::SpectrumType& spectrum_ct);
+
     /// number of points sampled per peak's FWHM
     Int sampling_points_per_FWHM_;
 
@@ -275,6 +295,12 @@ protected:
 
     static const Size THREADED_RANDOM_NUMBER_POOL_SIZE_ = 500;
 
+    /// Per-scan locks and compression state, only set while features are sampled (defined in the .cpp)
+    class ScanShards;
+
+    /// Scan shards of the experiment currently filled by generateRawSignals() (0 otherwise)
+    ScanShards* scan_shards_;
+
     bool contaminants_loaded_;
   };
 
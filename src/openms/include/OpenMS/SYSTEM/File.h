@@ -75,6 +75,15 @@ public:
     */
     static bool remove(const String& file);
 
+    /**
+      @brief Renames a file, replacing @p new_filename if it exists.
+
+      On POSIX systems the replacement is atomic: other processes see either the old or the new file, and those that have the old file open (or memory-mapped) keep using it. This makes it safe to write a file under a temporary name and then rename it to its final name.
+
+      @return Returns true if the file was successfully renamed.
+    */
+    static bool rename(const String& old_filename, const String& new_filename);
+
     /// Removes the specified directory (absolute path). Returns true if successful.
     static bool removeDirRecursively(const String& dir_name);
 
@@ -0,0 +1,194 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_SYSTEM_PROFILER_H
+#define OPENMS_SYSTEM_PROFILER_H
+
+#include <OpenMS/config.h>
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+
+#include <iosfwd>
+#include <map>
+
+namespace OpenMS
+{
+  /**
+    @brief Records the wall time, CPU time and peak memory of nested processing stages
+
+    Stages are delimited by startScope() / endScope() (or a Scope object) and aggregated
+    in a call tree: all calls of a stage with the same enclosing stages form one node.
+    Every ProgressLogger::startProgress() / endProgress() pair is such a stage, so the
+    progress-logged steps of all algorithms are profiled without further changes.
+    Arbitrary counters can be attached to the current stage using addToCounter().
+
+    Profiling is disabled by default, in which case all methods return immediately.
+    Each thread records into its own call tree (stages opened in parallel regions are
+    thus reported at the top level), the trees are merged when the profile is requested
+    or the thread ends. Stages are closed through the handle returned by startScope(), so
+    stages that are closed out of order (e.g. by independent ProgressLogger objects)
+    cannot close an unrelated stage.
+
+    TOPP tools write a profile of their run when called with the @p -profile option.
+
+    @note CPU time is the time of the whole process while the stage was open. Memory is the
+    value reported by SysInfo::getProcessMemoryConsumption(), sampled when stages are opened
+    and closed and by sampleMemory() (called by ProgressLogger::setProgress()).
+
+    @ingroup System
+  */
+  class OPENMS_DLLAPI Profiler
+  {
+public:
+    /// A node of the call tree (a stage, aggregated over all its calls)
+    struct OPENMS_DLLAPI Node
+    {
+      /// Default constructor
+      Node();
+      /// Copy constructor
+      Node(const Node& rhs);
+      /// Destructor
+      ~Node();
+      /// Assignment operator
+      Node& operator=(const Node& rhs);
+
+      /// Adds the calls, times and counters of @p rhs (and its children) to this node
+      void merge(const Node& rhs);
+      /// Removes all children and resets the values
+      void clear();
+
+      /// Number of calls
+      Size calls;
+      /// Accumulated wall time in seconds
+      double wall_time;
+      /// Accumulated CPU time in seconds
+      double cpu_time;
+      /// Peak memory consumption in KB
+      size_t peak_memory;
+      /// Counters (see addToCounter())
+      std::map<String, double> counters;
+      /// Nested stages by name
+      std::map<String, Node*> children;
+    };
+
+    /// Opens a stage on construction and closes it (and all stages opened inside and not closed) on destruction
+    class OPENMS_DLLAPI Scope
+    {
+public:
+      /// Opens the stage @p name
+      explicit Scope(const String& name);
+      /// Closes the stage
+      ~Scope();
+private:
+      Scope(const Scope&);
+      Scope& operator=(const Scope&);
+
+      /// Handle of the stage
+      Size handle_;
+    };
+
+    /**
+      @brief Profiles a complete run
+
+      If @p filename is not empty, profiling is enabled and the stage @p name is opened.
+      On destruction the stage is closed and the profile is written to @p filename (see store()).
+    */
+    class OPENMS_DLLAPI Session
+    {
+public:
+      /// Starts profiling the run @p name, if @p filename is not empty
+      Session(const String& name, const String& filename);
+      /// Stops profiling and writes the profile (errors are reported, but not thrown)
+      ~Session();
+private:
+      Session(const Session&);
+      Session& operator=(const Session&);
+
+      /// The file the profile is written to
+      String filename_;
+      /// The stage of the run (0 if profiling is not done)
+      Scope* scope_;
+    };
+
+    /// Enables or disables profiling
+    static void setEnabled(bool enabled);
+    /// Returns whether profiling is enabled
+    static bool isEnabled();
+
+    /**
+      @brief Opens the stage @p name (nested in the currently open stage of this thread)
+
+      @return Handle of the stage for endScope(Size) (0 if profiling is disabled)
+    */
+    static Size startScope(const String& name);
+    /**
+      @brief Closes the stage @p handle of this thread and all stages opened inside it
+
+      Does nothing if the stage is already closed (or was removed by clear()), or if @p handle is 0.
+    */
+    static void endScope(Size handle);
+    /// Closes the currently open stage of this thread (does nothing if there is none)
+    static void endScope();
+    /// Adds @p value to the counter @p name of the currently open stage of this thread
+    static void addToCounter(const String& name, double value = 1.0);
+    /// Samples the memory consumption for the peak memory of the open stages of this thread
+    static void sampleMemory();
+
+    /// Removes all recorded stages, including the open stages of all threads
+    static void clear();
+    /// Returns the call trees of all threads merged into the children of @p root (stages that are still open are not included)
+    static void getProfile(Node& root);
+
+    /**
+      @brief Writes the profile as JSON
+
+      Each stage is an object with the members "name", "calls", "wall_time" and "cpu_time" (seconds),
+      "peak_memory" (KB), "counters" and "children".
+    */
+    static void writeJSON(std::ostream& os);
+    /// Writes the profile as folded stacks (one line "stage;nested stage <wall time in us>" per stage) as read by flamegraph.pl
+    static void writeFoldedStacks(std::ostream& os);
+    /**
+      @brief Writes the profile to @p filename
+
+      Files with the extension '.json' are written as JSON, all others as folded stacks.
+
+      @exception Exception::UnableToCreateFile is thrown if the file cannot be written
+    */
+    static void store(const String& filename);
+  };
+
+} // namespace OpenMS
+
+#endif // OPENMS_SYSTEM_PROFILER_H
@@ -25,6 +25,7 @@ set(sources_list_h
 File.h
 FileWatcher.h
 JavaInfo.h
+Profiler.h
 StopWatch.h
 SysInfo.h
 )
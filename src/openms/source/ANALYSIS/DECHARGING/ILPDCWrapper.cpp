@@ -33,7 +33,9 @@
 // --------------------------------------------------------------------------
 #include <OpenMS/ANALYSIS/DECHARGING/ILPDCWrapper.h>
 
+#include <OpenMS/CHEMISTRY/ElementDB.h>
 #include <OpenMS/CONCEPT/Constants.h>
+#include <OpenMS/CONCEPT/ParallelExceptionCollector.h>
 #include <OpenMS/DATASTRUCTURES/LPWrapper.h>
 #include <OpenMS/DATASTRUCTURES/MassExplainer.h>
 #include <OpenMS/DATASTRUCTURES/Map.h>
@@ -61,7 +63,16 @@ namespace OpenMS
   {
   }
 
-  double ILPDCWrapper::compute(const FeatureMap fm, PairsType& pairs, Size verbose_level) const
+  namespace
+  {
+    /// orders bins (pair index ranges) by decreasing size
+    bool largerBin(const std::pair<Size, Size>& a, const std::pair<Size, Size>& b)
+    {
+      return (a.second - a.first) > (b.second - b.first);
+    }
+  }
+
+  double ILPDCWrapper::compute(const FeatureMap& fm, PairsType& pairs, Size verbose_level) const
   {
     if (fm.empty())
     {
@@ -175,8 +186,8 @@ namespace OpenMS
               pairs_clique_ordered.push_back(pairs[*i_p]);
             }
             if (verbose_level > 2)
-              LOG_INFO << "Extra bin for big clique (" << clique_size << ") prepended to schedule\n";
-            bins.insert(bins.begin(), std::make_pair(start, pairs_clique_ordered.size()));
+              LOG_INFO << "Extra bin for big clique (" << clique_size << ")\n";
+            bins.push_back(std::make_pair(start, pairs_clique_ordered.size()));
             start = pairs_clique_ordered.size();
             continue; // next clique (this one is already processed)
           }
@@ -189,6 +200,9 @@ namespace OpenMS
       }
       if (count > 0)
         bins.push_back(std::make_pair(start, pairs_clique_ordered.size()));
+
+      // largest slices first, so that no big slice is left running alone at the end
+      std::stable_sort(bins.begin(), bins.end(), largerBin);
     }
 
     if (pairs_clique_ordered.size() != pairs.size())
@@ -203,14 +217,31 @@ namespace OpenMS
     time1.start();
 
     // split problem into slices and have each one solved by the ILPS
-    double score = 0;
-// OMP currently causes spurious segfaults in Release mode; OMP fix applied, however: disable if problem persists
-//#ifdef _OPENMP
-//#pragma omp parallel for schedule(dynamic, 1), reduction(+: score)
-//#endif
+    // (slices cover disjoint ranges of 'pairs'; see computeSlice_() for how the solver itself is protected)
+    ElementDB::getInstance(); // initialize before it is used in parallel (Compomer::getAdductsAsString())
+    std::vector<double> slice_scores(bins.size(), 0);
+    ParallelExceptionCollector errors;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
     for (SignedSize i = 0; i < static_cast<SignedSize>(bins.size()); ++i)
     {
-      score = computeSlice_(fm, pairs, bins[i].first, bins[i].second, verbose_level);
+      if (errors.hasErrorBefore(i)) continue;
+      try
+      {
+        slice_scores[i] = computeSlice_(fm, pairs, bins[i].first, bins[i].second, verbose_level);
+      }
+      catch (...) // exceptions must not leave the parallel region
+      {
+        errors.capture(i);
+      }
+    }
+    errors.rethrow();
+    // sum in a fixed order, independent of the number of threads
+    double score = 0;
+    for (Size i = 0; i < slice_scores.size(); ++i)
+    {
+      score += slice_scores[i];
     }
     time1.stop();
     LOG_INFO << " Branch and cut took " << time1.getClockTime() << " seconds, "
@@ -225,20 +256,21 @@ namespace OpenMS
     f_set[rota_l].insert(v);
   }
 
-  double ILPDCWrapper::computeSlice_(const FeatureMap fm,
+  double ILPDCWrapper::computeSlice_(const FeatureMap& fm,
                                      PairsType& pairs,
                                      const PairsIndex margin_left,
                                      const PairsIndex margin_right,
                                      const Size /* verbose_level */) const
   {
+    // the model is set up without touching the solver (slices may do this in parallel),
+    // columns are numbered in the order in which they are added to the LPWrapper below
+
     // feature --> variants set  (with scores)
     typedef std::map<Size, FeatureType_> r_type;
     r_type features;
 
-
-    LPWrapper build;
-    //build.setSolver(LPWrapper::SOLVER_GLPK);
-    build.setObjectiveSense(LPWrapper::MAX); // maximize
+    // objective of each column
+    std::vector<double> objectives;
 
     // add ALL edges first. Their result is what is interesting to us later
     for (PairsIndex i = margin_left; i < margin_right; ++i)
@@ -248,11 +280,9 @@ namespace OpenMS
       double score = exp(getLogScore_(pairs[i], fm));
       pairs[i].setEdgeScore(score * pairs[i].getEdgeScore()); // multiply with preset score
 
-      // create the column representing the edge
-      Int index = build.addColumn();
-      build.setColumnBounds(index, 0, 1, LPWrapper::DOUBLE_BOUNDED);
-      build.setColumnType(index, LPWrapper::INTEGER); // integer variable
-      build.setObjective(index, pairs[i].getEdgeScore());
+      // the column representing the edge
+      Int index = (Int)objectives.size();
+      objectives.push_back(pairs[i].getEdgeScore());
 
       // create feature variants set
       String rota_l = String(pairs[i].getElementIndex(0)) + pairs[i].getCompomer().getAdductsAsString(0) + "_" + pairs[i].getCharge(0);
@@ -261,6 +291,13 @@ namespace OpenMS
       updateFeatureVariant_(features[pairs[i].getElementIndex(1)], rota_r, index);
     }
 
+    // rows (constraints)
+    std::vector<std::vector<Int> > row_columns;
+    std::vector<std::vector<double> > row_elements;
+    std::vector<String> row_names;
+    std::vector<double> row_lower_bounds, row_upper_bounds;
+    std::vector<LPWrapper::Type> row_types;
+
     // ADD Features (multiple variants of one feature are constrained to size=1)
     Size count(0); // each entry is a feature idx --->    Map["AdductCgf"]->adjacentEdges
     for (r_type::iterator it = features.begin(); it != features.end(); ++it)
@@ -270,10 +307,8 @@ namespace OpenMS
       std::vector<double> elements;
       for (FeatureType_::const_iterator iti = it->second.begin(); iti != it->second.end(); ++iti)
       {
-        Int index = build.addColumn();
-        build.setColumnBounds(index, 0, 1, LPWrapper::DOUBLE_BOUNDED);
-        build.setColumnType(index, LPWrapper::INTEGER); // integer variable
-        build.setObjective(index, 0); // obj value of feature must be a constant, as it must be neutral
+        Int index = (Int)objectives.size();
+        objectives.push_back(0); // obj value of feature must be a constant, as it must be neutral
         columns.push_back(index);
         elements.push_back(1.0);
 
@@ -288,12 +323,20 @@ namespace OpenMS
         }
         columns_e.push_back((Int) index);
         elements_e.push_back(iti->second.size()); // factor of variant is number of adjacent edges
-        String se = String("cv") + index;
-        build.addRow(columns_e, elements_e, se, 0, 10000, LPWrapper::LOWER_BOUND_ONLY);
+        row_columns.push_back(columns_e);
+        row_elements.push_back(elements_e);
+        row_names.push_back(String("cv") + index);
+        row_lower_bounds.push_back(0);
+        row_upper_bounds.push_back(10000);
+        row_types.push_back(LPWrapper::LOWER_BOUND_ONLY);
       }
-      String s = String("c") + count;
       // only allow exactly one charge variant
-      build.addRow(columns, elements, s, 1, 1, LPWrapper::FIXED);
+      row_columns.push_back(columns);
+      row_elements.push_back(elements);
+      row_names.push_back(String("c") + count);
+      row_lower_bounds.push_back(1);
+      row_upper_bounds.push_back(1);
+      row_types.push_back(LPWrapper::FIXED);
     }
 
     LPWrapper::SolverParam param;
@@ -305,29 +348,62 @@ namespace OpenMS
     param.enable_gmi_cuts = true;
     param.enable_presolve = true;
 
-    build.solve(param);
-
-    for (UInt iColumn = 0; iColumn < margin_right - margin_left; ++iColumn)
+    // GLPK is not reentrant (unless built with thread-local storage), so each slice has its own LPWrapper,
+    // but all calls into the solver are serialized; exceptions must not leave the critical section
+    double objective_value(0);
+    ParallelExceptionCollector errors;
+#ifdef _OPENMP
+#pragma omp critical (ILPDCWrapper_solver)
+#endif
     {
-      double value = build.getColumnValue(iColumn);
-      if (fabs(value) > 0.5)
+      try
       {
-        pairs[margin_left + iColumn].setActive(true);
+        LPWrapper build;
+        //build.setSolver(LPWrapper::SOLVER_GLPK);
+        build.setObjectiveSense(LPWrapper::MAX); // maximize
+        for (Size c = 0; c < objectives.size(); ++c)
+        {
+          Int index = build.addColumn();
+          build.setColumnBounds(index, 0, 1, LPWrapper::DOUBLE_BOUNDED);
+          build.setColumnType(index, LPWrapper::INTEGER); // integer variable
+          build.setObjective(index, objectives[c]);
+        }
+        for (Size r = 0; r < row_columns.size(); ++r)
+        {
+          build.addRow(row_columns[r], row_elements[r], row_names[r], row_lower_bounds[r], row_upper_bounds[r], row_types[r]);
+        }
+
+        build.solve(param);
+
+        for (UInt iColumn = 0; iColumn < margin_right - margin_left; ++iColumn)
+        {
+          double value = build.getColumnValue(iColumn);
+          if (fabs(value) > 0.5)
+          {
+            pairs[margin_left + iColumn].setActive(true);
+          }
+          else
+          {
+            // DEBUG
+            //std::cerr << " edge " << iColumn << " with " << value << "\n";
+          }
+        }
+
+        objective_value = build.getObjectiveValue();
       }
-      else
+      catch (...)
       {
-        // DEBUG
-        //std::cerr << " edge " << iColumn << " with " << value << "\n";
+        errors.capture(0);
       }
     }
+    errors.rethrow();
 
-    return build.getObjectiveValue();
-
+    return objective_value;
   }
 
   // old version, slower, as ILP has different layout (i.e, the same as described in paper)
 
-  double ILPDCWrapper::computeSliceOld_(const FeatureMap fm,
+  double ILPDCWrapper::computeSliceOld_(const FeatureMap& fm,
                                         PairsType& pairs,
                                         const PairsIndex margin_left,
                                         const PairsIndex margin_right,
@@ -35,13 +35,28 @@
 #include <OpenMS/ANALYSIS/ID/ConsensusIDAlgorithmPEPMatrix.h>
 #include <OpenMS/CONCEPT/LogStream.h>
 
+#include <cctype>
 #include <cmath>
+#include <cstring>
 
 using namespace std;
 
 namespace OpenMS
 {
-  ConsensusIDAlgorithmPEPMatrix::ConsensusIDAlgorithmPEPMatrix()
+  namespace
+  {
+    /// Amino acids of the SeqAn substitution matrices (in matrix order)
+    const char matrix_residues[] = "ARNDCQEGHILKMFPSTWYVBZX*";
+
+    /// Size of the alphabet of the substitution matrices
+    const Size n_matrix_residues = sizeof(matrix_residues) - 1;
+
+    /// Index of the unknown amino acid ('X') in the substitution matrices
+    const Size matrix_index_x = 22;
+  }
+
+  ConsensusIDAlgorithmPEPMatrix::ConsensusIDAlgorithmPEPMatrix() :
+    substitution_matrix_(0), penalty_(0), char_to_index_(256, matrix_index_x)
   {
     setName("ConsensusIDAlgorithmPEPMatrix"); // DefaultParamHandler
 
@@ -52,7 +67,21 @@ namespace OpenMS
 
     defaultsToParam_();
 
-    ::seqan::resize(rows(alignment_), 2);
+    // same order of amino acids as in SeqAn - unknown characters map to 'X':
+    for (Size i = 0; i < n_matrix_residues; ++i)
+    {
+      char_to_index_[(unsigned char)matrix_residues[i]] = i;
+      char_to_index_[(unsigned char)tolower(matrix_residues[i])] = i;
+    }
+    // residues without a row in the matrices are scored as their closest
+    // standard amino acid (instead of 'X', which matches nothing):
+    const String others = "UOJ", replacements = "CKL";
+    for (Size i = 0; i < others.size(); ++i)
+    {
+      Size index = strchr(matrix_residues, replacements[i]) - matrix_residues;
+      char_to_index_[(unsigned char)others[i]] = index;
+      char_to_index_[(unsigned char)tolower(others[i])] = index;
+    }
   }
 
 
@@ -60,18 +89,18 @@ namespace OpenMS
   {
     ConsensusIDAlgorithmSimilarity::updateMembers_();
 
-    // alignment scoring using SeqAn/similarity matrices:
+    // alignment scoring using SeqAn similarity matrices:
     String matrix = param_.getValue("matrix");
-    int penalty = param_.getValue("penalty");
-    scoring_method_ = SeqAnScore(-penalty, -penalty);
+    penalty_ = param_.getValue("penalty");
     if (matrix == "identity")
     {
-      ::seqan::setDefaultScoreMatrix(scoring_method_, 
-                                     ::seqan::AdaptedIdentity());
+      substitution_matrix_ = ::seqan::ScoringMatrixData_<
+        int, ::seqan::AminoAcid, ::seqan::AdaptedIdentity>::getData();
     }
     else if (matrix == "PAM30MS")
     {
-      ::seqan::setDefaultScoreMatrix(scoring_method_, ::seqan::PAM30MS());
+      substitution_matrix_ = ::seqan::ScoringMatrixData_<
+        int, ::seqan::AminoAcid, ::seqan::PAM30MS>::getData();
     }
     else
     {
@@ -81,8 +110,70 @@ namespace OpenMS
                                        msg);
     }
 
-    // new parameters may affect the similarity calculation, so clear cache:
-    similarities_.clear();
+    self_scores_.clear();
+  }
+
+
+  int ConsensusIDAlgorithmPEPMatrix::alignmentScore_(const String& seq1,
+                                                     const String& seq2)
+  {
+    const Size n_residues = n_matrix_residues;
+    const Size m = seq1.size(), n = seq2.size();
+    if ((m == 0) || (n == 0)) return -int(m + n) * penalty_;
+
+    // "query profile": substitution scores of every residue type against every
+    // position of seq. 2, so the inner loop only reads contiguous memory:
+    profile_.resize(n_residues * n);
+    for (Size j = 0; j < n; ++j)
+    {
+      const int* column = substitution_matrix_ + 
+        char_to_index_[(unsigned char)seq2[j]];
+      for (Size a = 0; a < n_residues; ++a)
+      {
+        profile_[a * n + j] = column[a * n_residues];
+      }
+    }
+
+    row_.resize(n + 1);
+    next_row_.resize(n + 1);
+    for (Size j = 0; j <= n; ++j) row_[j] = -int(j) * penalty_;
+
+    for (Size i = 1; i <= m; ++i)
+    {
+      const int* scores = &(profile_[0]) + 
+        char_to_index_[(unsigned char)seq1[i - 1]] * n;
+      const int* prev = &(row_[0]);
+      int* next = &(next_row_[0]);
+      next[0] = -int(i) * penalty_;
+      // diagonal and vertical moves only depend on the previous row (no loop-
+      // carried dependency, so the compiler can vectorize this):
+      for (Size j = 1; j <= n; ++j)
+      {
+        next[j] = max(prev[j - 1] + scores[j - 1], prev[j] - penalty_);
+      }
+      // horizontal moves (gaps in seq. 1) are a running maximum:
+      for (Size j = 1; j <= n; ++j)
+      {
+        next[j] = max(next[j], next[j - 1] - penalty_);
+      }
+      row_.swap(next_row_);
+    }
+    return row_[n];
+  }
+
+
+  int ConsensusIDAlgorithmPEPMatrix::selfScore_(const String& seq)
+  {
+    map<String, int>::iterator pos = self_scores_.find(seq);
+    if (pos != self_scores_.end()) return pos->second;
+    if (self_scores_.size() > MAX_CACHE_SIZE_) // keep the cache bounded
+    {
+      self_scores_.clear();
+      pos = self_scores_.end();
+    }
+    int score = alignmentScore_(seq, seq);
+    self_scores_.insert(pos, make_pair(seq, score));
+    return score;
   }
 
 
@@ -93,40 +184,17 @@ namespace OpenMS
     String unmod_seq1 = seq1.toUnmodifiedString();
     String unmod_seq2 = seq2.toUnmodifiedString();
     if (unmod_seq1 == unmod_seq2) return 1.0;
-    // order of sequences matters for cache look-up:
-    if (unmod_seq1 > unmod_seq2) swap(unmod_seq1, unmod_seq2);
-    seq1 = AASequence::fromString(unmod_seq1);
-    seq2 = AASequence::fromString(unmod_seq2);
-    pair<AASequence, AASequence> seq_pair = make_pair(seq1, seq2);
-    SimilarityCache::iterator pos = similarities_.find(seq_pair);
-    if (pos != similarities_.end()) return pos->second; // score found in cache
-    
-    // use SeqAn similarity scoring:
-    SeqAnSequence seqan_seq1 = unmod_seq1.c_str();
-    SeqAnSequence seqan_seq2 = unmod_seq2.c_str();
-    // seq. 1 against itself:
-    ::seqan::assignSource(row(alignment_, 0), seqan_seq1);
-    ::seqan::assignSource(row(alignment_, 1), seqan_seq1);
-    double score_self1 = globalAlignment(alignment_, scoring_method_,
-                                         ::seqan::NeedlemanWunsch());
-    // seq. 1 against seq. 2:
-    ::seqan::assignSource(row(alignment_, 1), seqan_seq2);
-    double score_sim = globalAlignment(alignment_, scoring_method_, 
-                                       ::seqan::NeedlemanWunsch());
-    // seq. 2 against itself:
-    ::seqan::assignSource(row(alignment_, 0), seqan_seq2);
-    double score_self2 = globalAlignment(alignment_, scoring_method_,
-                                         ::seqan::NeedlemanWunsch());
+
+    double score_sim = alignmentScore_(unmod_seq1, unmod_seq2);
     if (score_sim < 0)
     {
       score_sim = 0;
     }
     else
     {
-      score_sim /= min(score_self1, score_self2); // normalize
+      // normalize:
+      score_sim /= min(selfScore_(unmod_seq1), selfScore_(unmod_seq2));
     }
-    similarities_[seq_pair] = score_sim; // cache the similarity score
-
     return score_sim;
   }
 
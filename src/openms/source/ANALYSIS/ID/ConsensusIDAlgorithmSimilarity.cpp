@@ -42,12 +42,49 @@ using namespace std;
 
 namespace OpenMS
 {
+  const Size ConsensusIDAlgorithmSimilarity::MAX_CACHE_SIZE_ = 100000;
+
+
   ConsensusIDAlgorithmSimilarity::ConsensusIDAlgorithmSimilarity()
   {
     setName("ConsensusIDAlgorithmSimilarity"); // DefaultParamHandler
   }
 
 
+  void ConsensusIDAlgorithmSimilarity::updateMembers_()
+  {
+    ConsensusIDAlgorithm::updateMembers_();
+
+    // new parameters may affect the similarity calculation, so clear the
+    // similarity cache (interned sequence IDs stay valid):
+    similarities_.clear();
+  }
+
+
+  Size ConsensusIDAlgorithmSimilarity::internSequence_(const AASequence& seq)
+  {
+    return sequence_ids_.insert(make_pair(seq, sequence_ids_.size())).first->second;
+  }
+
+
+  double ConsensusIDAlgorithmSimilarity::getCachedSimilarity_(
+    Size id1, const AASequence& seq1, Size id2, const AASequence& seq2)
+  {
+    if (id1 == id2) return 1.0;
+    // order of IDs matters for cache look-up:
+    pair<Size, Size> id_pair = (id1 < id2) ? make_pair(id1, id2) : 
+      make_pair(id2, id1);
+    SimilarityCache::iterator pos = similarities_.lower_bound(id_pair);
+    if ((pos != similarities_.end()) && (pos->first == id_pair))
+    {
+      return pos->second; // score found in cache
+    }
+    double score_sim = getSimilarity_(seq1, seq2);
+    similarities_.insert(pos, make_pair(id_pair, score_sim));
+    return score_sim;
+  }
+
+
   void ConsensusIDAlgorithmSimilarity::apply_(
     vector<PeptideIdentification>& ids, SequenceGrouping& results)
   {
@@ -62,17 +99,38 @@ namespace OpenMS
       }
     }
 
-    for (vector<PeptideIdentification>::iterator id1 = ids.begin();
-         id1 != ids.end(); ++id1)
+    // the caches persist between calls, keep them bounded:
+    if ((sequence_ids_.size() > MAX_CACHE_SIZE_) ||
+        (similarities_.size() > MAX_CACHE_SIZE_))
+    {
+      similarities_.clear();
+      sequence_ids_.clear();
+    }
+
+    // look up the interned IDs of all sequences only once:
+    vector<vector<Size> > seq_ids(ids.size());
+    for (Size i = 0; i < ids.size(); ++i)
+    {
+      const vector<PeptideHit>& hits = ids[i].getHits();
+      seq_ids[i].reserve(hits.size());
+      for (vector<PeptideHit>::const_iterator hit = hits.begin();
+           hit != hits.end(); ++hit)
+      {
+        seq_ids[i].push_back(internSequence_(hit->getSequence()));
+      }
+    }
+
+    for (Size i1 = 0; i1 < ids.size(); ++i1)
     {
-      for (vector<PeptideHit>::iterator hit1 = id1->getHits().begin();
-           hit1 != id1->getHits().end(); ++hit1)
+      vector<PeptideHit>& hits1 = ids[i1].getHits();
+      for (Size h1 = 0; h1 < hits1.size(); ++h1)
       {
+        const PeptideHit& hit1 = hits1[h1];
         // have we scored this sequence already? if yes, skip:
-        SequenceGrouping::iterator pos = results.find(hit1->getSequence());
+        SequenceGrouping::iterator pos = results.find(hit1.getSequence());
         if (pos != results.end())
         { 
-          compareChargeStates_(pos->second.first, hit1->getCharge(),
+          compareChargeStates_(pos->second.first, hit1.getCharge(),
                                pos->first);
           continue;
         }
@@ -80,30 +138,29 @@ namespace OpenMS
         // similarity scores and PEPs of best matches for all ID runs:
         vector<pair<double, double> > best_matches;
         best_matches.reserve(ids.size() - 1);
-        for (vector<PeptideIdentification>::iterator id2 = ids.begin();
-             id2 != ids.end(); ++id2)
+        for (Size i2 = 0; i2 < ids.size(); ++i2)
         {
-          if (id1 == id2) continue;
+          if (i1 == i2) continue;
           
           // similarity scores and PEPs of all matches in current ID run
           // (to get the best match, we look for highest similarity, breaking
           // ties by better PEP - so we need to transform PEP so higher scores
           // are better, same as similarity):
-          vector<pair<double, double> > current_matches;
-          current_matches.reserve(id2->getHits().size());
-          for (vector<PeptideHit>::iterator hit2 = id2->getHits().begin();
-               hit2 != id2->getHits().end(); ++hit2)
+          const vector<PeptideHit>& hits2 = ids[i2].getHits();
+          if (hits2.empty()) continue;
+          pair<double, double> best_match(-1.0, 0.0);
+          for (Size h2 = 0; h2 < hits2.size(); ++h2)
           {
-            double sim_score = getSimilarity_(hit1->getSequence(),
-                                              hit2->getSequence());
-            // use "1 - PEP" so higher scores are better (for "max_element"):
-            current_matches.push_back(make_pair(sim_score,
-                                                1.0 - hit2->getScore()));
+            double sim_score = getCachedSimilarity_(
+              seq_ids[i1][h1], hit1.getSequence(), 
+              seq_ids[i2][h2], hits2[h2].getSequence());
+            // use "1 - PEP" so higher scores are better:
+            best_match = max(best_match, 
+                             make_pair(sim_score, 1.0 - hits2[h2].getScore()));
           }
-          best_matches.push_back(*max_element(current_matches.begin(),
-                                              current_matches.end()));
+          best_matches.push_back(best_match);
         }
-        double score = hit1->getScore();
+        double score = hit1.getScore();
         double sum_sim = 1.0; // sum of similarity scores
         for (vector<pair<double, double> >::iterator it = best_matches.begin();
              it != best_matches.end(); ++it)
@@ -128,7 +185,7 @@ namespace OpenMS
         
         // don't filter based on "min_score_" yet, so we don't recompute results
         // for the same peptide sequence:
-        results[hit1->getSequence()] = make_pair(hit1->getCharge(), scores);
+        results[hit1.getSequence()] = make_pair(hit1.getCharge(), scores);
       }
     }
   }
@@ -37,6 +37,8 @@
 #include <OpenMS/CONCEPT/LogStream.h>
 
 #include <algorithm>
+#include <cmath>
+#include <map>
 
 // #define FALSE_DISCOVERY_RATE_DEBUG
 // #undef  FALSE_DISCOVERY_RATE_DEBUG
@@ -62,6 +64,87 @@ namespace OpenMS
     defaultsToParam_();
   }
 
+
+  namespace
+  {
+    /// classification of a peptide hit by its 'target_decoy' meta value
+    enum HitClass {TARGET, DECOY, UNKNOWN};
+
+    /// orders entry indices by decreasing score
+    struct HigherScoreFirst
+    {
+      explicit HigherScoreFirst(const vector<FalseDiscoveryRate::ScoreEntry>& entries) :
+        entries_(entries)
+      {
+      }
+
+      bool operator()(Size a, Size b) const
+      {
+        return entries_[a].score > entries_[b].score;
+      }
+
+      const vector<FalseDiscoveryRate::ScoreEntry>& entries_;
+    };
+
+    /// orders entry indices by increasing score
+    struct LowerScoreFirst
+    {
+      explicit LowerScoreFirst(const vector<FalseDiscoveryRate::ScoreEntry>& entries) :
+        entries_(entries)
+      {
+      }
+
+      bool operator()(Size a, Size b) const
+      {
+        return entries_[a].score < entries_[b].score;
+      }
+
+      const vector<FalseDiscoveryRate::ScoreEntry>& entries_;
+    };
+
+    /// appends one entry per hit (in order) of a forward or reverse run
+    template <typename IdentificationType, typename HitType>
+    void collectEntries(const vector<IdentificationType>& ids, bool is_decoy, vector<FalseDiscoveryRate::ScoreEntry>& entries)
+    {
+      for (typename vector<IdentificationType>::const_iterator it = ids.begin(); it != ids.end(); ++it)
+      {
+        for (typename vector<HitType>::const_iterator pit = it->getHits().begin(); pit != it->getHits().end(); ++pit)
+        {
+          entries.push_back(FalseDiscoveryRate::ScoreEntry(pit->getScore(), 0, is_decoy));
+        }
+      }
+    }
+
+    /// replaces the scores of all hits by the FDRs starting at @p offset (in the order the entries were collected)
+    template <typename IdentificationType, typename HitType>
+    void annotateFDRs(vector<IdentificationType>& ids, const vector<double>& fdrs, Size offset, bool q_value)
+    {
+      String score_type = ids.begin()->getScoreType() + "_score";
+
+      // position of the first hit of each identification, so they can be annotated in parallel
+      vector<Size> hit_offsets(ids.size() + 1, offset);
+      for (Size i = 0; i < ids.size(); ++i)
+      {
+        hit_offsets[i + 1] = hit_offsets[i] + ids[i].getHits().size();
+      }
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+      for (SignedSize i = 0; i < (SignedSize)ids.size(); ++i)
+      {
+        ids[i].setScoreType(q_value ? "q-value" : "FDR");
+        ids[i].setHigherScoreBetter(false);
+        vector<HitType>& hits = ids[i].getHits();
+        for (Size j = 0; j < hits.size(); ++j)
+        {
+          hits[j].setMetaValue(score_type, hits[j].getScore());
+          hits[j].setScore(fdrs[hit_offsets[i] + j]);
+        }
+      }
+    }
+  }
+
   void FalseDiscoveryRate::apply(vector<PeptideIdentification>& ids)
   {
     bool q_value = param_.getValue("q_value").toBool();
@@ -83,6 +166,7 @@ namespace OpenMS
     // first search for all identifiers and charge variants
     set<String> identifiers;
     set<SignedSize> charge_variants;
+    Size hit_count(0);
     for (vector<PeptideIdentification>::iterator it = ids.begin(); it != ids.end(); ++it)
     {
       identifiers.insert(it->getIdentifier());
@@ -99,6 +183,7 @@ namespace OpenMS
       {
         charge_variants.insert(pit->getCharge());
       }
+      hit_count += it->getHits().size();
     }
 
 #ifdef FALSE_DISCOVERY_RATE_DEBUG
@@ -118,204 +203,180 @@ namespace OpenMS
     cerr << endl;
 #endif
 
+    // group index of a hit: (run index) * (#charge variants) + (charge index)
+    Map<String, Size> run_index;
+    vector<String> run_names;
+    for (set<String>::const_iterator iit = identifiers.begin(); iit != identifiers.end(); ++iit)
+    {
+      run_index[*iit] = treat_runs_separately ? run_names.size() : 0;
+      run_names.push_back(*iit);
+    }
+    Map<SignedSize, Size> charge_index;
+    vector<SignedSize> charges;
     for (set<SignedSize>::const_iterator zit = charge_variants.begin(); zit != charge_variants.end(); ++zit)
     {
-#ifdef FALSE_DISCOVERY_RATE_DEBUG
-      cerr << "Charge variant=" << *zit << endl;
-#endif
-
-      // for all identifiers
-      for (set<String>::const_iterator iit = identifiers.begin(); iit != identifiers.end(); ++iit)
+      charge_index[*zit] = split_charge_variants ? charges.size() : 0;
+      charges.push_back(*zit);
+    }
+    Size run_count = treat_runs_separately ? run_names.size() : 1;
+    Size charge_count = split_charge_variants ? charges.size() : 1;
+    Size group_count = run_count * charge_count;
+
+    // extract score, decoy flag and group of all hits into one flat array
+    vector<ScoreEntry> entries;
+    entries.reserve(hit_count);
+    vector<Size> hit_offsets(ids.size() + 1, 0); // position of the first hit of each identification
+    vector<Size> hit_groups(hit_count), hit_entries(hit_count);
+    vector<HitClass> hit_classes(hit_count);
+    vector<Size> group_targets(group_count, 0), group_decoys(group_count, 0);
+    for (Size i = 0; i < ids.size(); ++i)
+    {
+      const vector<PeptideHit>& hits = ids[i].getHits();
+      Size run = run_index[ids[i].getIdentifier()];
+      hit_offsets[i + 1] = hit_offsets[i] + hits.size();
+      for (Size j = 0; j < hits.size(); ++j)
       {
-        if (!treat_runs_separately && iit != identifiers.begin())
+        Size flat = hit_offsets[i] + j;
+        if (!hits[j].metaValueExists("target_decoy"))
         {
-          continue;
+          LOG_FATAL_ERROR << "Meta value 'target_decoy' does not exists, reindex the idXML file with 'PeptideIndexer' first (run-id='" << ids[i].getIdentifier() << ", rank=" << j + 1 << " of " << hits.size() << ")!" << endl;
+          throw Exception::MissingInformation(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Meta value 'target_decoy' does not exist!");
         }
+        Size group = run * charge_count + charge_index[hits[j].getCharge()];
+        hit_groups[flat] = group;
 
-#ifdef FALSE_DISCOVERY_RATE_DEBUG
-        cerr << "Id-run: " << *iit << endl;
-#endif
-        // get the scores of all peptide hits
-        vector<double> target_scores, decoy_scores;
-        for (vector<PeptideIdentification>::iterator it = ids.begin(); it != ids.end(); ++it)
+        String target_decoy(hits[j].getMetaValue("target_decoy"));
+        if (target_decoy == "target" || target_decoy == "target+decoy")
+        {
+          hit_classes[flat] = TARGET;
+          ++group_targets[group];
+        }
+        else if (target_decoy == "decoy")
+        {
+          hit_classes[flat] = DECOY;
+          ++group_decoys[group];
+        }
+        else
         {
-          // if runs should be treated separately, the identifiers must be the same
-          if (treat_runs_separately && it->getIdentifier() != *iit)
+          if (target_decoy != "")
           {
-            continue;
+            LOG_FATAL_ERROR << "Unknown value of meta value 'target_decoy': '" << target_decoy << "'!" << endl;
           }
+          hit_classes[flat] = UNKNOWN;
+          hit_entries[flat] = 0;
+          continue;
+        }
+        hit_entries[flat] = entries.size();
+        entries.push_back(ScoreEntry(hits[j].getScore(), group, hit_classes[flat] == DECOY));
+      }
+    }
 
-          for (Size i = 0; i < it->getHits().size(); ++i)
-          {
-            if (split_charge_variants && it->getHits()[i].getCharge() != *zit)
-            {
-              continue;
-            }
-
-            if (!it->getHits()[i].metaValueExists("target_decoy"))
-            {
-              LOG_FATAL_ERROR << "Meta value 'target_decoy' does not exists, reindex the idXML file with 'PeptideIndexer' first (run-id='" << it->getIdentifier() << ", rank=" << i + 1 << " of " << it->getHits().size() << ")!" << endl;
-              throw Exception::MissingInformation(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Meta value 'target_decoy' does not exist!");
-            }
-
-            String target_decoy(it->getHits()[i].getMetaValue("target_decoy"));
-            if (target_decoy == "target" || target_decoy == "target+decoy")
-            {
-              target_scores.push_back(it->getHits()[i].getScore());
-            }
-            else
-            {
-              if (target_decoy == "decoy")
-              {
-                decoy_scores.push_back(it->getHits()[i].getScore());
-              }
-              else
-              {
-                if (target_decoy != "")
-                {
-                  LOG_FATAL_ERROR << "Unknown value of meta value 'target_decoy': '" << target_decoy << "'!" << endl;
-                }
-              }
-            }
-          }
+    // report groups without targets or decoys; their hits are handled separately below
+    vector<bool> group_valid(group_count, true);
+    for (Size group = 0; group < group_count; ++group)
+    {
+      if (group_targets[group] != 0 && group_decoys[group] != 0)
+      {
+        continue;
+      }
+      group_valid[group] = false;
+
+      String group_string;
+      if (split_charge_variants || treat_runs_separately)
+      {
+        group_string += "(";
+        if (split_charge_variants)
+        {
+          group_string += "charge_variant=" + String(charges[group % charge_count]) + " ";
         }
+        if (treat_runs_separately)
+        {
+          group_string += "run-id=" + run_names[group / charge_count];
+        }
+        group_string += ")";
+      }
+      if (group_decoys[group] == 0)
+      {
+        LOG_ERROR << "FalseDiscoveryRate: #decoy sequences is zero! Setting all target sequences to q-value/FDR 0! " << group_string << std::endl;
+      }
+      if (group_targets[group] == 0)
+      {
+        LOG_ERROR << "FalseDiscoveryRate: #target sequences is zero! Ignoring. " << group_string << std::endl;
+      }
+    }
 
 #ifdef FALSE_DISCOVERY_RATE_DEBUG
-        cerr << "#target-scores=" << target_scores.size() << ", #decoy-scores=" << decoy_scores.size() << endl;
+    cerr << "#entries=" << entries.size() << ", #groups=" << group_count << endl;
 #endif
 
-        // check decoy scores
-        if (decoy_scores.empty())
+    // calculate fdr for all groups at once
+    bool higher_score_better(ids.begin()->isHigherScoreBetter());
+    vector<double> fdrs;
+    calculateFDRs(entries, fdrs, q_value, higher_score_better);
+
+    // hits with an unknown 'target_decoy' value get the value of a target or decoy with the same score in their group (0 if there is none)
+    vector<double> unknown_fdrs(hit_count, 0.0);
+    if (entries.size() != hit_count)
+    {
+      map<pair<Size, double>, double> score_to_fdr;
+      for (Size e = 0; e < entries.size(); ++e)
+      {
+        score_to_fdr[make_pair(entries[e].group, entries[e].score)] = fdrs[e];
+      }
+      for (Size i = 0; i < ids.size(); ++i)
+      {
+        const vector<PeptideHit>& hits = ids[i].getHits();
+        for (Size j = 0; j < hits.size(); ++j)
         {
-          String error_string = "FalseDiscoveryRate: #decoy sequences is zero! Setting all target sequences to q-value/FDR 0! ";
-          if (split_charge_variants || treat_runs_separately)
+          Size flat = hit_offsets[i] + j;
+          if (hit_classes[flat] != UNKNOWN)
           {
-            error_string += "(";
-            if (split_charge_variants)
-            {
-              error_string += "charge_variant=" + String(*zit) + " ";
-            }
-            if (treat_runs_separately)
-            {
-              error_string += "run-id=" + *iit;
-            }
-            error_string += ")";
+            continue;
           }
-          LOG_ERROR << error_string << std::endl;
-        }
-
-        // check target scores
-        if (target_scores.empty())
-        {
-          String error_string = "FalseDiscoveryRate: #target sequences is zero! Ignoring. ";
-          if (split_charge_variants || treat_runs_separately)
+          map<pair<Size, double>, double>::const_iterator pos = score_to_fdr.find(make_pair(hit_groups[flat], hits[j].getScore()));
+          if (pos != score_to_fdr.end())
           {
-            error_string += "(";
-            if (split_charge_variants)
-            {
-              error_string += "charge_variant=" + String(*zit) + " ";
-            }
-            if (treat_runs_separately)
-            {
-              error_string += "run-id=" + *iit;
-            }
-            error_string += ")";
+            unknown_fdrs[flat] = pos->second;
           }
-          LOG_ERROR << error_string << std::endl;
         }
+      }
+    }
 
-        if (target_scores.empty() || decoy_scores.empty())
+    // annotate fdr (scatter back by index)
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (SignedSize i = 0; i < (SignedSize)ids.size(); ++i)
+    {
+      String score_type = ids[i].getScoreType() + "_score";
+      const vector<PeptideHit>& old_hits = ids[i].getHits();
+      vector<PeptideHit> hits;
+      hits.reserve(old_hits.size());
+      for (Size j = 0; j < old_hits.size(); ++j)
+      {
+        Size flat = hit_offsets[i] + j;
+        HitClass hit_class = hit_classes[flat];
+        if (!group_valid[hit_groups[flat]])
         {
-          // no remove the the relevant entries, or put 'pseudo-scores' in
-          for (vector<PeptideIdentification>::iterator it = ids.begin(); it != ids.end(); ++it)
+          // if it is a target hit and there are no decoys, fdr/q-value should be zero; everything else is removed
+          if (hit_class == TARGET)
           {
-            // if runs should be treated separately, the identifiers must be the same
-            if (treat_runs_separately && it->getIdentifier() != *iit)
-            {
-              continue;
-            }
-
-            vector<PeptideHit> hits(it->getHits()), new_hits;
-            for (Size i = 0; i < hits.size(); ++i)
-            {
-              if (split_charge_variants && hits[i].getCharge() != *zit)
-              {
-                new_hits.push_back(hits[i]);
-                continue;
-              }
-
-              if (!hits[i].metaValueExists("target_decoy"))
-              {
-                LOG_FATAL_ERROR << "Meta value 'target_decoy' does not exists, reindex the idXML file with 'PeptideIndexer' first (run-id='" << it->getIdentifier() << ", rank=" << i + 1 << " of " << hits.size() << ")!" << endl;
-                throw Exception::MissingInformation(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Meta value 'target_decoy' does not exist!");
-              }
-
-              String target_decoy(hits[i].getMetaValue("target_decoy"));
-              if (target_decoy == "target" || target_decoy == "target+decoy")
-              {
-                // if it is a target hit, there are now decoys, fdr/q-value should be zero then
-                new_hits.push_back(hits[i]);
-                String score_type = it->getScoreType() + "_score";
-                new_hits.back().setMetaValue(score_type, new_hits.back().getScore());
-                new_hits.back().setScore(0);
-              }
-              else
-              {
-                if (target_decoy != "decoy")
-                {
-                  LOG_FATAL_ERROR << "Unknown value of meta value 'target_decoy': '" << target_decoy << "'!" << endl;
-                }
-              }
-            }
-            it->setHits(new_hits);
+            hits.push_back(old_hits[j]);
+            hits.back().setMetaValue(score_type, old_hits[j].getScore());
+            hits.back().setScore(0);
           }
           continue;
         }
 
-        // calculate fdr for the forward scores
-        bool higher_score_better(ids.begin()->isHigherScoreBetter());
-        Map<double, double> score_to_fdr;
-        calculateFDRs_(score_to_fdr, target_scores, decoy_scores, q_value, higher_score_better);
-
-        // annotate fdr
-        for (vector<PeptideIdentification>::iterator it = ids.begin(); it != ids.end(); ++it)
+        if (hit_class == DECOY && !add_decoy_peptides)
         {
-          // if runs should be treated separately, the identifiers must be the same
-          if (treat_runs_separately && it->getIdentifier() != *iit)
-          {
-            continue;
-          }
-
-          String score_type = it->getScoreType() + "_score";
-          vector<PeptideHit> hits;
-          for (vector<PeptideHit>::const_iterator pit = it->getHits().begin(); pit != it->getHits().end(); ++pit)
-          {
-            PeptideHit hit = *pit;
-
-            if (split_charge_variants && pit->getCharge() != *zit)
-            {
-              hits.push_back(*pit);
-              continue;
-            }
-            if (hit.metaValueExists("target_decoy"))
-            {
-              String meta_value = (String)hit.getMetaValue("target_decoy");
-              if (meta_value == "decoy" && !add_decoy_peptides)
-              {
-                continue;
-              }
-            }
-            hit.setMetaValue(score_type, pit->getScore());
-            hit.setScore(score_to_fdr[pit->getScore()]);
-            hits.push_back(hit);
-          }
-          it->setHits(hits);
+          continue;
         }
+        hits.push_back(old_hits[j]);
+        hits.back().setMetaValue(score_type, old_hits[j].getScore());
+        hits.back().setScore(hit_class == UNKNOWN ? unknown_fdrs[flat] : fdrs[hit_entries[flat]]);
       }
-      if (!split_charge_variants)
-      {
-        break;
-      }
+      ids[i].getHits().swap(hits);
     }
 
     // higher-score-better can be set now, calculations are finished
@@ -348,83 +409,25 @@ namespace OpenMS
     {
       return;
     }
-    vector<double> target_scores, decoy_scores;
-    // get the scores of all peptide hits
-    for (vector<PeptideIdentification>::const_iterator it = fwd_ids.begin(); it != fwd_ids.end(); ++it)
-    {
-      for (vector<PeptideHit>::const_iterator pit = it->getHits().begin(); pit != it->getHits().end(); ++pit)
-      {
-        target_scores.push_back(pit->getScore());
-      }
-    }
-
-    for (vector<PeptideIdentification>::const_iterator it = rev_ids.begin(); it != rev_ids.end(); ++it)
-    {
-      for (vector<PeptideHit>::const_iterator pit = it->getHits().begin(); pit != it->getHits().end(); ++pit)
-      {
-        decoy_scores.push_back(pit->getScore());
-      }
-    }
+    // get the scores of all peptide hits (forward hits first)
+    vector<ScoreEntry> entries;
+    collectEntries<PeptideIdentification, PeptideHit>(fwd_ids, false, entries);
+    Size decoy_offset = entries.size();
+    collectEntries<PeptideIdentification, PeptideHit>(rev_ids, true, entries);
 
     bool q_value(param_.getValue("q_value").toBool());
     bool higher_score_better(fwd_ids.begin()->isHigherScoreBetter());
     bool add_decoy_peptides = param_.getValue("add_decoy_peptides").toBool();
     // calculate fdr for the forward scores
-    Map<double, double> score_to_fdr;
-    calculateFDRs_(score_to_fdr, target_scores, decoy_scores, q_value, higher_score_better);
+    vector<double> fdrs;
+    calculateFDRs(entries, fdrs, q_value, higher_score_better);
 
     // annotate fdr
-    String score_type = fwd_ids.begin()->getScoreType() + "_score";
-    for (vector<PeptideIdentification>::iterator it = fwd_ids.begin(); it != fwd_ids.end(); ++it)
-    {
-      if (q_value)
-      {
-        it->setScoreType("q-value");
-      }
-      else
-      {
-        it->setScoreType("FDR");
-      }
-
-      it->setHigherScoreBetter(false);
-      vector<PeptideHit> hits = it->getHits();
-      for (vector<PeptideHit>::iterator pit = hits.begin(); pit != hits.end(); ++pit)
-      {
-#ifdef FALSE_DISCOVERY_RATE_DEBUG
-        cerr << pit->getScore() << " " << score_to_fdr[pit->getScore()] << endl;
-#endif
-        pit->setMetaValue(score_type, pit->getScore());
-        pit->setScore(score_to_fdr[pit->getScore()]);
-      }
-      it->setHits(hits);
-    }
+    annotateFDRs<PeptideIdentification, PeptideHit>(fwd_ids, fdrs, 0, q_value);
     //write as well decoy peptides
     if (add_decoy_peptides)
     {
-      score_type = rev_ids.begin()->getScoreType() + "_score";
-      for (vector<PeptideIdentification>::iterator it = rev_ids.begin(); it != rev_ids.end(); ++it)
-      {
-        if (q_value)
-        {
-          it->setScoreType("q-value");
-        }
-        else
-        {
-          it->setScoreType("FDR");
-        }
-
-        it->setHigherScoreBetter(false);
-        vector<PeptideHit> hits = it->getHits();
-        for (vector<PeptideHit>::iterator pit = hits.begin(); pit != hits.end(); ++pit)
-        {
-#ifdef FALSE_DISCOVERY_RATE_DEBUG
-          cerr << pit->getScore() << " " << score_to_fdr[pit->getScore()] << endl;
-#endif
-          pit->setMetaValue(score_type, pit->getScore());
-          pit->setScore(score_to_fdr[pit->getScore()]);
-        }
-        it->setHits(hits);
-      }
+      annotateFDRs<PeptideIdentification, PeptideHit>(rev_ids, fdrs, decoy_offset, q_value);
     }
 
     return;
@@ -438,20 +441,13 @@ namespace OpenMS
       return;
     }
 
-    vector<double> target_scores, decoy_scores;
+    vector<ScoreEntry> entries;
     String decoy_string = (String)param_.getValue("decoy_string");
     for (vector<ProteinIdentification>::const_iterator it = ids.begin(); it != ids.end(); ++it)
     {
       for (vector<ProteinHit>::const_iterator pit = it->getHits().begin(); pit != it->getHits().end(); ++pit)
       {
-        if (pit->getAccession().hasSubstring(decoy_string))
-        {
-          decoy_scores.push_back(pit->getScore());
-        }
-        else
-        {
-          target_scores.push_back(pit->getScore());
-        }
+        entries.push_back(ScoreEntry(pit->getScore(), 0, pit->getAccession().hasSubstring(decoy_string)));
       }
     }
 
@@ -459,30 +455,11 @@ namespace OpenMS
     bool higher_score_better(ids.begin()->isHigherScoreBetter());
 
     // calculate fdr for the forward scores
-    Map<double, double> score_to_fdr;
-    calculateFDRs_(score_to_fdr, target_scores, decoy_scores, q_value, higher_score_better);
+    vector<double> fdrs;
+    calculateFDRs(entries, fdrs, q_value, higher_score_better);
 
     // annotate fdr
-    String score_type = ids.begin()->getScoreType() + "_score";
-    for (vector<ProteinIdentification>::iterator it = ids.begin(); it != ids.end(); ++it)
-    {
-      if (q_value)
-      {
-        it->setScoreType("q-value");
-      }
-      else
-      {
-        it->setScoreType("FDR");
-      }
-      it->setHigherScoreBetter(false);
-      vector<ProteinHit> hits = it->getHits();
-      for (vector<ProteinHit>::iterator pit = hits.begin(); pit != hits.end(); ++pit)
-      {
-        pit->setMetaValue(score_type, pit->getScore());
-        pit->setScore(score_to_fdr[pit->getScore()]);
-      }
-      it->setHits(hits);
-    }
+    annotateFDRs<ProteinIdentification, ProteinHit>(ids, fdrs, 0, q_value);
 
     return;
   }
@@ -493,178 +470,176 @@ namespace OpenMS
     {
       return;
     }
-    vector<double> target_scores, decoy_scores;
-    // get the scores of all peptide hits
-    for (vector<ProteinIdentification>::const_iterator it = fwd_ids.begin(); it != fwd_ids.end(); ++it)
-    {
-      for (vector<ProteinHit>::const_iterator pit = it->getHits().begin(); pit != it->getHits().end(); ++pit)
-      {
-        target_scores.push_back(pit->getScore());
-      }
-    }
-    for (vector<ProteinIdentification>::const_iterator it = rev_ids.begin(); it != rev_ids.end(); ++it)
-    {
-      for (vector<ProteinHit>::const_iterator pit = it->getHits().begin(); pit != it->getHits().end(); ++pit)
-      {
-        decoy_scores.push_back(pit->getScore());
-      }
-    }
+    // get the scores of all protein hits (forward hits first)
+    vector<ScoreEntry> entries;
+    collectEntries<ProteinIdentification, ProteinHit>(fwd_ids, false, entries);
+    collectEntries<ProteinIdentification, ProteinHit>(rev_ids, true, entries);
 
     bool q_value(param_.getValue("q_value").toBool());
     bool higher_score_better(fwd_ids.begin()->isHigherScoreBetter());
     // calculate fdr for the forward scores
-    Map<double, double> score_to_fdr;
-    calculateFDRs_(score_to_fdr, target_scores, decoy_scores, q_value, higher_score_better);
+    vector<double> fdrs;
+    calculateFDRs(entries, fdrs, q_value, higher_score_better);
 
     // annotate fdr
-    String score_type = fwd_ids.begin()->getScoreType() + "_score";
-    for (vector<ProteinIdentification>::iterator it = fwd_ids.begin(); it != fwd_ids.end(); ++it)
-    {
-      if (q_value)
-      {
-        it->setScoreType("q-value");
-      }
-      else
-      {
-        it->setScoreType("FDR");
-      }
-      it->setHigherScoreBetter(false);
-      vector<ProteinHit> hits = it->getHits();
-      for (vector<ProteinHit>::iterator pit = hits.begin(); pit != hits.end(); ++pit)
-      {
-        pit->setMetaValue(score_type, pit->getScore());
-        pit->setScore(score_to_fdr[pit->getScore()]);
-      }
-      it->setHits(hits);
-    }
+    annotateFDRs<ProteinIdentification, ProteinHit>(fwd_ids, fdrs, 0, q_value);
 
     return;
   }
 
-  void FalseDiscoveryRate::calculateFDRs_(Map<double, double>& score_to_fdr, vector<double>& target_scores, vector<double>& decoy_scores, bool q_value, bool higher_score_better)
+  void FalseDiscoveryRate::calculateFDRs(const vector<ScoreEntry>& entries, vector<double>& fdrs, bool q_value, bool higher_score_better)
   {
-    Size number_of_target_scores = target_scores.size();
-    // sort the scores
-    if (higher_score_better && !q_value)
+    fdrs.assign(entries.size(), 0.0);
+    if (entries.empty())
     {
-      sort(target_scores.rbegin(), target_scores.rend());
-      sort(decoy_scores.rbegin(), decoy_scores.rend());
+      return;
     }
-    else if (!higher_score_better && !q_value)
+
+    // bucket the entry indices by group (counting sort), so every group is sorted exactly once
+    Size group_count(0);
+    for (vector<ScoreEntry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
     {
-      sort(target_scores.begin(), target_scores.end());
-      sort(decoy_scores.begin(), decoy_scores.end());
+      group_count = std::max(group_count, it->group + 1);
     }
-    else if (higher_score_better)
+    vector<Size> group_begin(group_count + 1, 0);
+    for (vector<ScoreEntry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
     {
-      sort(target_scores.begin(), target_scores.end());
-      sort(decoy_scores.rbegin(), decoy_scores.rend());
+      ++group_begin[it->group + 1];
     }
-    else
+    for (Size g = 0; g < group_count; ++g)
+    {
+      group_begin[g + 1] += group_begin[g];
+    }
+    vector<Size> order(entries.size());
+    vector<Size> group_fill(group_begin.begin(), group_begin.end() - 1);
+    for (Size i = 0; i < entries.size(); ++i)
+    {
+      order[group_fill[entries[i].group]++] = i;
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (SignedSize g = 0; g < (SignedSize)group_count; ++g)
     {
-      sort(target_scores.rbegin(), target_scores.rend());
-      sort(decoy_scores.begin(), decoy_scores.end());
+      calculateGroupFDRs_(entries, order.begin() + group_begin[g], order.begin() + group_begin[g + 1], fdrs, q_value, higher_score_better);
     }
+  }
 
-    Size j = 0;
+  void FalseDiscoveryRate::calculateGroupFDRs_(const vector<ScoreEntry>& entries, vector<Size>::iterator begin, vector<Size>::iterator end, vector<double>& fdrs, bool q_value, bool higher_score_better)
+  {
+    Size n = end - begin;
+    if (n == 0)
+    {
+      return;
+    }
 
-    if (q_value)
+    // best scores first
+    if (higher_score_better)
     {
-      double minimal_fdr = 1.;
-      for (Size i = 0; i != target_scores.size(); ++i)
+      sort(begin, end, HigherScoreFirst(entries));
+    }
+    else
+    {
+      sort(begin, end, LowerScoreFirst(entries));
+    }
+
+    // forward sweep: FDR at a target score is the number of decoys divided by the number of targets with an equal or better score
+    vector<double> values(n, 0.0);
+    vector<bool> is_target_score(n, false);
+    Size target_count(0), decoy_count(0);
+    for (Size block_begin = 0; block_begin < n; )
+    {
+      Size block_end = block_begin;
+      bool block_has_target = false;
+      while (block_end < n && entries[begin[block_end]].score == entries[begin[block_begin]].score)
       {
-        if (decoy_scores.empty())
+        if (entries[begin[block_end]].is_decoy)
         {
-          // set FDR to 0 (done below automatically)
-        }
-        else if (i == 0 && j == 0)
-        {
-          while (j != decoy_scores.size()
-                && ((target_scores[i] <= decoy_scores[j] && higher_score_better) ||
-                    (target_scores[i] >= decoy_scores[j] && !higher_score_better)))
-          {
-            ++j;
-          }
+          ++decoy_count;
         }
         else
         {
-          if (j == decoy_scores.size())
-          {
-            j--;
-          }
-          while (j != 0
-                && ((target_scores[i] > decoy_scores[j] && higher_score_better) ||
-                    (target_scores[i] < decoy_scores[j] && !higher_score_better)))
-          {
-            --j;
-          }
-          // Since j has to be equal to the number of fps above the threshold we add one
-          if ((target_scores[i] <= decoy_scores[j] && higher_score_better)
-             || (target_scores[i] >= decoy_scores[j] && !higher_score_better))
-          {
-            ++j;
-          }
+          ++target_count;
+          block_has_target = true;
         }
+        ++block_end;
+      }
+      if (block_has_target)
+      {
+        double fdr = (double)decoy_count / (double)target_count;
+        std::fill(values.begin() + block_begin, values.begin() + block_end, fdr);
+        std::fill(is_target_score.begin() + block_begin, is_target_score.begin() + block_end, true);
+      }
+      block_begin = block_end;
+    }
 
-#ifdef FALSE_DISCOVERY_RATE_DEBUG
-        cerr << target_scores[i] << " " << decoy_scores[j] << " " << i << " " << j << " ";
-#endif
-
-        double fdr = 0.;
-
-        if (minimal_fdr >= (double)j / (number_of_target_scores - i))
+    // reverse sweep: the q-value is the minimal FDR of all thresholds including the hit
+    if (q_value)
+    {
+      double minimal_fdr = 1.;
+      for (Size i = n; i > 0; --i)
+      {
+        if (is_target_score[i - 1])
         {
-          minimal_fdr = (double)j / (number_of_target_scores - i);
+          minimal_fdr = std::min(minimal_fdr, values[i - 1]);
+          values[i - 1] = minimal_fdr;
         }
-        fdr = minimal_fdr;
-
-#ifdef FALSE_DISCOVERY_RATE_DEBUG
-        cerr << fdr << endl;
-#endif
-        score_to_fdr[target_scores[i]] = fdr;
-
       }
     }
+
+    // assign the value of the closest target score to decoys (without an equal target score)
+    if (target_count == 0)
+    {
+      std::fill(values.begin(), values.end(), 1.0);
+    }
     else
     {
-      for (Size i = 0; i != target_scores.size(); ++i)
+      // closest better-scoring target of each position (or n, if there is none)
+      vector<Size> better_target(n, n);
+      Size last_target = n;
+      for (Size i = 0; i < n; ++i)
       {
-        while (j != decoy_scores.size() &&
-               ((target_scores[i] <= decoy_scores[j] && higher_score_better) ||
-                (target_scores[i] >= decoy_scores[j] && !higher_score_better)))
+        if (is_target_score[i])
         {
-          ++j;
+          last_target = i;
         }
-
-#ifdef FALSE_DISCOVERY_RATE_DEBUG
-        cerr << target_scores[i] << " " << decoy_scores[j] << " " << i << " " << j << " ";
-#endif
-        double fdr(0);
-
-        fdr = (double)j / (double)(i + 1);
-
-#ifdef FALSE_DISCOVERY_RATE_DEBUG
-        cerr << fdr << endl;
-#endif
-        score_to_fdr[target_scores[i]] = fdr;
+        better_target[i] = last_target;
       }
-    }
-
-
-    // assign q-value of decoy_score to closest target_score
-    for (Size i = 0; i != decoy_scores.size(); ++i)
-    {
-      Size closest_idx = 0;
-      for (Size j = 0; j != target_scores.size(); ++j)
+      Size next_target = n;
+      for (Size i = n; i > 0; --i)
       {
-        if (fabs(decoy_scores[i] - target_scores[j]) < fabs(decoy_scores[i] - target_scores[closest_idx]))
+        if (is_target_score[i - 1])
         {
-          closest_idx = j;
+          next_target = i - 1;
+          continue;
         }
+        // on ties, FDRs use the better and q-values the worse target
+        Size closest = next_target;
+        Size better = better_target[i - 1];
+        if (closest == n)
+        {
+          closest = better;
+        }
+        else if (better != n)
+        {
+          double score = entries[begin[i - 1]].score;
+          double better_distance = fabs(entries[begin[better]].score - score);
+          double worse_distance = fabs(entries[begin[closest]].score - score);
+          if (better_distance < worse_distance || (!q_value && better_distance == worse_distance))
+          {
+            closest = better;
+          }
+        }
+        values[i - 1] = values[closest];
       }
-      score_to_fdr[decoy_scores[i]] = score_to_fdr[target_scores[closest_idx]];
     }
 
+    // scatter back by index
+    for (Size i = 0; i < n; ++i)
+    {
+      fdrs[begin[i]] = values[i];
+    }
   }
 
 } // namespace OpenMS
@@ -36,6 +36,8 @@
 #include <OpenMS/ANALYSIS/MAPMATCHING/StablePairFinder.h>
 
 #include <OpenMS/KERNEL/ConversionHelper.h>
+#include <OpenMS/CONCEPT/ParallelExceptionCollector.h>
+#include <OpenMS/DATASTRUCTURES/ListUtils.h>
 
 namespace OpenMS
 {
@@ -45,6 +47,8 @@ namespace OpenMS
   {
     setName("FeatureGroupingAlgorithmUnlabeled");
     defaults_.insert("", StablePairFinder().getParameters());
+    defaults_.setValue("merge_order", "sequential", "Order in which the maps are merged. 'sequential': all maps are added one after the other to the map with the most features. 'tree': maps are merged pairwise in a balanced binary tree, independent merges are run in parallel. The result of 'tree' does not depend on a reference map, but on the order of the input maps.");
+    defaults_.setValidStrings("merge_order", ListUtils::create<String>("sequential,tree"));
     defaultsToParam_();
     // The input for the pairfinder is a vector of FeatureMaps of size 2
     pairfinder_input_.resize(2);
@@ -62,6 +66,60 @@ namespace OpenMS
       throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__, "At least two maps must be given!");
     }
 
+    ConsensusMap result;
+    if (param_.getValue("merge_order") == "tree")
+    {
+      groupTree_(maps, result);
+    }
+    else
+    {
+      groupSequential_(maps, result);
+    }
+
+    // replace result with temporary map
+    out.swap(result);
+    // copy back the input maps (they have been deleted while swapping)
+    out.getFileDescriptions() = result.getFileDescriptions();
+
+    // add protein IDs and unassigned peptide IDs to the result map here,
+    // to keep the same order as the input maps (useful for output later)
+    for (std::vector<FeatureMap>::const_iterator map_it = maps.begin();
+         map_it != maps.end(); ++map_it)
+    {
+      // add protein identifications to result map
+      out.getProteinIdentifications().insert(
+        out.getProteinIdentifications().end(),
+        map_it->getProteinIdentifications().begin(),
+        map_it->getProteinIdentifications().end());
+
+      // add unassigned peptide identifications to result map
+      out.getUnassignedPeptideIdentifications().insert(
+        out.getUnassignedPeptideIdentifications().end(),
+        map_it->getUnassignedPeptideIdentifications().begin(),
+        map_it->getUnassignedPeptideIdentifications().end());
+    }
+
+    // canonical ordering for checking the results, and the ids have no real meaning anyway
+#if 1 // the way this was done in DelaunayPairFinder and StablePairFinder
+    out.sortByMZ();
+#else
+    out.sortByQuality();
+    out.sortByMaps();
+    out.sortBySize();
+#endif
+
+    return;
+  }
+
+  Param FeatureGroupingAlgorithmUnlabeled::getPairFinderParameters_() const
+  {
+    Param pair_finder_param = param_.copy("", true);
+    pair_finder_param.remove("merge_order");
+    return pair_finder_param;
+  }
+
+  void FeatureGroupingAlgorithmUnlabeled::groupSequential_(const std::vector<FeatureMap> & maps, ConsensusMap & out) const
+  {
     // define reference map (the one with most peaks)
     Size reference_map_index = 0;
     Size max_count = 0;
@@ -82,7 +140,7 @@ namespace OpenMS
 
     // loop over all other maps, extend the groups
     StablePairFinder pair_finder;
-    pair_finder.setParameters(param_.copy("", true));
+    pair_finder.setParameters(getPairFinderParameters_());
 
     for (Size i = 0; i < maps.size(); ++i)
     {
@@ -96,46 +154,65 @@ namespace OpenMS
       }
     }
 
-    // replace result with temporary map
     out.swap(input[0]);
-    // copy back the input maps (they have been deleted while swapping)
-    out.getFileDescriptions() = input[0].getFileDescriptions();
+  }
 
-    // add protein IDs and unassigned peptide IDs to the result map here,
-    // to keep the same order as the input maps (useful for output later)
-    for (std::vector<FeatureMap>::const_iterator map_it = maps.begin();
-         map_it != maps.end(); ++map_it)
-    {
-      // add protein identifications to result map
-      out.getProteinIdentifications().insert(
-        out.getProteinIdentifications().end(),
-        map_it->getProteinIdentifications().begin(),
-        map_it->getProteinIdentifications().end());
+  void FeatureGroupingAlgorithmUnlabeled::groupTree_(const std::vector<FeatureMap> & maps, ConsensusMap & out) const
+  {
+    Param pair_finder_param = getPairFinderParameters_();
 
-      // add unassigned peptide identifications to result map
-      out.getUnassignedPeptideIdentifications().insert(
-        out.getUnassignedPeptideIdentifications().end(),
-        map_it->getUnassignedPeptideIdentifications().begin(),
-        map_it->getUnassignedPeptideIdentifications().end());
+    // the leaves: consensus maps of the input maps (contain only singleton consensus elements)
+    std::vector<ConsensusMap> level(maps.size());
+    for (Size i = 0; i < maps.size(); ++i)
+    {
+      MapConversion::convert(i, maps[i], level[i]);
     }
 
-    // canonical ordering for checking the results, and the ids have no real meaning anyway
-#if 1 // the way this was done in DelaunayPairFinder and StablePairFinder
-    out.sortByMZ();
-#else
-    out.sortByQuality();
-    out.sortByMaps();
-    out.sortBySize();
+    // merge neighbouring maps level by level, until one map is left
+    while (level.size() > 1)
+    {
+      Size pairs = level.size() / 2;
+      std::vector<ConsensusMap> next_level(pairs + level.size() % 2);
+
+      ParallelExceptionCollector errors;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
 #endif
+      for (SignedSize p = 0; p < (SignedSize)pairs; ++p)
+      {
+        if (errors.hasErrorBefore(p)) continue;
+        try
+        {
+          std::vector<ConsensusMap> input(2);
+          input[0].swap(level[2 * p]);
+          input[1].swap(level[2 * p + 1]);
+          StablePairFinder pair_finder;
+          pair_finder.setParameters(pair_finder_param);
+          pair_finder.run(input, next_level[p]);
+        }
+        catch (...) // exceptions must not leave the parallel region
+        {
+          errors.capture(p);
+        }
+      }
+      errors.rethrow();
 
-    return;
+      // an odd map moves up unchanged
+      if (level.size() % 2 == 1)
+      {
+        next_level.back().swap(level.back());
+      }
+      level.swap(next_level);
+    }
+
+    out.swap(level[0]);
   }
 
   void FeatureGroupingAlgorithmUnlabeled::addToGroup(int map_id, const FeatureMap& feature_map)
   {
     // create new PairFinder
     StablePairFinder pair_finder;
-    pair_finder.setParameters(param_.copy("", true));
+    pair_finder.setParameters(getPairFinderParameters_());
 
     // Convert the input map to a consensus map (using the given map_id) and
     // replace the second element in the pairfinder_input_ vector.
@@ -45,6 +45,45 @@ using std::vector;
 
 namespace OpenMS
 {
+  class MapAlignmentTransformer::RTBatch
+  {
+public:
+    RTBatch() :
+      collecting_(true), pos_(0)
+    {
+    }
+
+    /// While collecting, stores @p rt and returns it unchanged; afterwards returns the next transformed value
+    double operator()(double rt)
+    {
+      if (collecting_)
+      {
+        values_.push_back(rt);
+        return rt;
+      }
+      return values_[pos_++];
+    }
+
+    /// Still collecting values?
+    bool collecting() const
+    {
+      return collecting_;
+    }
+
+    /// Transforms all collected values at once
+    void transform(const TransformationDescription& trafo)
+    {
+      trafo.apply(values_);
+      collecting_ = false;
+      pos_ = 0;
+    }
+
+private:
+    bool collecting_;
+    Size pos_;
+    std::vector<double> values_;
+  };
+
   void MapAlignmentTransformer::transformPeakMaps(vector<MSExperiment<> >& maps,
                                                   const vector<TransformationDescription>& given_trafos)
   {
@@ -79,23 +118,32 @@ namespace OpenMS
   {
     msexp.clearRanges();
 
-    // Transform spectra
-    for (MSExperiment<>::iterator mse_iter = msexp.begin(); mse_iter != msexp.end(); ++mse_iter)
+    // Transform spectra (all at once, the RTs are usually sorted)
+    std::vector<double> rts(msexp.size());
+    for (Size i = 0; i < msexp.size(); i++)
+    {
+      rts[i] = msexp[i].getRT();
+    }
+    trafo.apply(rts);
+    for (Size i = 0; i < msexp.size(); i++)
     {
-      double rt = mse_iter->getRT();
-      mse_iter->setRT(trafo.apply(rt));
+      msexp[i].setRT(rts[i]);
     }
 
-    // Also transform chromatograms
-    double rt;
+    // Also transform chromatograms (one at a time, each one is sorted)
     std::vector<MSChromatogram<ChromatogramPeak> > chromatograms;
     for (Size i = 0; i < msexp.getChromatograms().size(); i++)
     {
       MSChromatogram<ChromatogramPeak> chromatogram = msexp.getChromatograms()[i];
+      rts.resize(chromatogram.size());
       for (Size j = 0; j < chromatogram.size(); j++)
       {
-        rt = chromatogram[j].getRT();
-        chromatogram[j].setRT(trafo.apply(rt));
+        rts[j] = chromatogram[j].getRT();
+      }
+      trafo.apply(rts);
+      for (Size j = 0; j < chromatogram.size(); j++)
+      {
+        chromatogram[j].setRT(rts[j]);
       }
       chromatograms.push_back(chromatogram);
     }
@@ -135,39 +183,37 @@ namespace OpenMS
 
   void MapAlignmentTransformer::transformSingleFeatureMap(FeatureMap& fmap,
                                                           const TransformationDescription& trafo)
+  {
+    // collect all RT values, transform them at once, then assign them
+    RTBatch batch;
+    applyToFeatureMap_(fmap, batch);
+    batch.transform(trafo);
+    applyToFeatureMap_(fmap, batch);
+  }
+
+  void MapAlignmentTransformer::applyToFeatureMap_(FeatureMap& fmap, RTBatch& batch)
   {
     for (vector<Feature>::iterator fmit = fmap.begin(); fmit != fmap.end(); ++fmit)
     {
-      applyToFeature_(*fmit, trafo);
+      applyToFeature_(*fmit, batch);
     }
 
     // adapt RT values of unassigned peptides:
-    if (!fmap.getUnassignedPeptideIdentifications().empty())
-    {
-      transformSinglePeptideIdentification(
-        fmap.getUnassignedPeptideIdentifications(), trafo);
-    }
+    applyToPeptideIdentifications_(fmap.getUnassignedPeptideIdentifications(), batch);
   }
 
-  void MapAlignmentTransformer::applyToBaseFeature_(BaseFeature& feature,
-                                                    const TransformationDescription& trafo)
+  void MapAlignmentTransformer::applyToBaseFeature_(BaseFeature& feature, RTBatch& batch)
   {
     // transform feature position:
-    double rt = feature.getRT();
-    feature.setRT(trafo.apply(rt));
+    feature.setRT(batch(feature.getRT()));
 
     // adapt RT values of annotated peptides:
-    if (!feature.getPeptideIdentifications().empty())
-    {
-      transformSinglePeptideIdentification(feature.getPeptideIdentifications(),
-                                           trafo);
-    }
+    applyToPeptideIdentifications_(feature.getPeptideIdentifications(), batch);
   }
 
-  void MapAlignmentTransformer::applyToFeature_(Feature& feature,
-                                                const TransformationDescription& trafo)
+  void MapAlignmentTransformer::applyToFeature_(Feature& feature, RTBatch& batch)
   {
-    applyToBaseFeature_(feature, trafo);
+    applyToBaseFeature_(feature, batch);
 
     // loop over all convex hulls
     vector<ConvexHull2D>& convex_hulls = feature.getConvexHulls();
@@ -176,16 +222,18 @@ namespace OpenMS
     {
       // transform all hull point positions within convex hull
       ConvexHull2D::PointArrayType points = chiter->getHullPoints();
-      chiter->clear();
       for (ConvexHull2D::PointArrayType::iterator points_iter = points.begin();
            points_iter != points.end();
            ++points_iter
            )
       {
-        double rt = (*points_iter)[Feature::RT];
-        (*points_iter)[Feature::RT] = trafo.apply(rt);
+        (*points_iter)[Feature::RT] = batch((*points_iter)[Feature::RT]);
+      }
+      if (!batch.collecting())
+      {
+        chiter->clear();
+        chiter->setHullPoints(points);
       }
-      chiter->setHullPoints(points);
     }
 
     // recurse into subordinates
@@ -193,7 +241,7 @@ namespace OpenMS
          subiter != feature.getSubordinates().end();
          ++subiter)
     {
-      applyToFeature_(*subiter, trafo);
+      applyToFeature_(*subiter, batch);
     }
   }
 
@@ -228,19 +276,24 @@ namespace OpenMS
 
   void MapAlignmentTransformer::transformSingleConsensusMap(ConsensusMap& cmap,
                                                             const TransformationDescription& trafo)
+  {
+    // collect all RT values, transform them at once, then assign them
+    RTBatch batch;
+    applyToConsensusMap_(cmap, batch);
+    batch.transform(trafo);
+    applyToConsensusMap_(cmap, batch);
+  }
+
+  void MapAlignmentTransformer::applyToConsensusMap_(ConsensusMap& cmap, RTBatch& batch)
   {
     for (ConsensusMap::Iterator cmit = cmap.begin(); cmit != cmap.end();
          ++cmit)
     {
-      applyToConsensusFeature_(*cmit, trafo);
+      applyToConsensusFeature_(*cmit, batch);
     }
 
     // adapt RT values of unassigned peptides:
-    if (!cmap.getUnassignedPeptideIdentifications().empty())
-    {
-      transformSinglePeptideIdentification(
-        cmap.getUnassignedPeptideIdentifications(), trafo);
-    }
+    applyToPeptideIdentifications_(cmap.getUnassignedPeptideIdentifications(), batch);
   }
 
   void MapAlignmentTransformer::transformPeptideIdentifications(vector<vector<PeptideIdentification> >& maps,
@@ -274,32 +327,37 @@ namespace OpenMS
 
   void MapAlignmentTransformer::transformSinglePeptideIdentification(vector<PeptideIdentification>& pepids,
                                                                      const TransformationDescription& trafo)
+  {
+    RTBatch batch;
+    applyToPeptideIdentifications_(pepids, batch);
+    batch.transform(trafo);
+    applyToPeptideIdentifications_(pepids, batch);
+  }
+
+  void MapAlignmentTransformer::applyToPeptideIdentifications_(vector<PeptideIdentification>& pepids, RTBatch& batch)
   {
     for (UInt pepid_index = 0; pepid_index < pepids.size(); ++pepid_index)
     {
       PeptideIdentification& pepid = pepids[pepid_index];
       if (pepid.hasRT())
       {
-        pepid.setRT(trafo.apply(pepid.getRT()));
+        pepid.setRT(batch(pepid.getRT()));
       }
     }
-
   }
 
-  void MapAlignmentTransformer::applyToConsensusFeature_(ConsensusFeature& feature,
-                                                         const TransformationDescription& trafo)
+  void MapAlignmentTransformer::applyToConsensusFeature_(ConsensusFeature& feature, RTBatch& batch)
   {
     typedef ConsensusFeature::HandleSetType::const_iterator TConstHandleSetIterator;
 
-    applyToBaseFeature_(feature, trafo);
+    applyToBaseFeature_(feature, batch);
 
     // apply to grouped features (feature handles):
     for (TConstHandleSetIterator it = feature.getFeatures().begin();
          it != feature.getFeatures().end();
          ++it)
     {
-      double rt = it->getRT();
-      it->asMutable().setRT(trafo.apply(rt));
+      it->asMutable().setRT(batch(it->getRT()));
     }
   }
 
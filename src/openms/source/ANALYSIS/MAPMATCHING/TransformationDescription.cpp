@@ -126,6 +126,14 @@ namespace OpenMS
     return model_->evaluate(value);
   }
 
+  void TransformationDescription::apply(std::vector<double>& values) const
+  {
+    if (!values.empty())
+    {
+      model_->evaluate(&values[0], &values[0], values.size());
+    }
+  }
+
   const String& TransformationDescription::getModelType() const
   {
     return model_type_;
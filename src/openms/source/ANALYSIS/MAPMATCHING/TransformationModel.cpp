@@ -51,6 +51,17 @@ namespace OpenMS
     return value;
   }
 
+  void TransformationModel::evaluate(const double* in, double* out, size_t n) const
+  {
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (SignedSize i = 0; i < (SignedSize)n; ++i)
+    {
+      out[i] = evaluate(in[i]);
+    }
+  }
+
   const Param& TransformationModel::getParameters() const
   {
     return params_;
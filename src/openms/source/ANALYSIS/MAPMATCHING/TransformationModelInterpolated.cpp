@@ -74,6 +74,11 @@ public:
       return spline_->eval(x);
     }
 
+    void eval(const double* x, double* y, size_t n) const
+    {
+      spline_->eval(x, y, n);
+    }
+
     ~Spline2dInterpolator()
     {
       delete spline_;
@@ -166,6 +171,37 @@ public:
       }
     }
 
+    void eval(const double* x, double* y, size_t n) const
+    {
+      if (n == 0)
+      {
+        return;
+      }
+
+      // same as above, but the index of the first point > x only moves forward
+      size_t idx = std::upper_bound(x_.begin(), x_.end(), x[0]) - x_.begin();
+      for (size_t k = 0; k < n; ++k)
+      {
+        const double xk = x[k];
+        while (idx < x_.size() && x_[idx] <= xk)
+        {
+          ++idx;
+        }
+        if (idx == x_.size())
+        {
+          y[k] = y_.back();
+        }
+        else
+        {
+          const double x_0 = x_[idx - 1];
+          const double x_1 = x_[idx];
+          const double y_0 = y_[idx - 1];
+          const double y_1 = y_[idx];
+          y[k] = y_0 + (y_1 - y_0) * (xk - x_0) / (x_1 - x_0);
+        }
+      }
+    }
+
     ~LinearInterpolator()
     {
     }
@@ -261,6 +297,37 @@ private:
     return interp_->eval(value);
   }
 
+  void TransformationModelInterpolated::evaluate(const double* in, double* out, size_t n) const
+  {
+    for (size_t i = 1; i < n; ++i)
+    {
+      if (in[i] < in[i - 1]) // not sorted
+      {
+        TransformationModel::evaluate(in, out, n);
+        return;
+      }
+    }
+
+    // values before/after the data range are extrapolated
+    const size_t first = std::lower_bound(in, in + n, x_.front()) - in;
+    const size_t last = std::upper_bound(in + first, in + n, x_.back()) - in;
+    lm_->evaluate(in, out, first);
+    lm_->evaluate(in + last, out + last, n - last);
+
+    // interpolate in chunks, each chunk is a sorted sequence by itself
+    const size_t chunk_size = 4096;
+    const SignedSize nr_chunks = (SignedSize)((last - first + chunk_size - 1) / chunk_size);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (SignedSize chunk = 0; chunk < nr_chunks; ++chunk)
+    {
+      const size_t begin = first + chunk * chunk_size;
+      const size_t end = std::min(begin + chunk_size, last);
+      interp_->eval(in + begin, out + begin, end - begin);
+    }
+  }
+
   void TransformationModelInterpolated::getDefaultParameters(Param& params)
   {
     params.clear();
@@ -92,6 +92,19 @@ namespace OpenMS
     return slope_ * value + intercept_;
   }
 
+  void TransformationModelLinear::evaluate(const double* in, double* out, size_t n) const
+  {
+    // local copies, so the compiler can vectorize the loop
+    const double slope = slope_, intercept = intercept_;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (SignedSize i = 0; i < (SignedSize)n; ++i)
+    {
+      out[i] = slope * in[i] + intercept;
+    }
+  }
+
   void TransformationModelLinear::invert()
   {
     if (slope_ == 0)
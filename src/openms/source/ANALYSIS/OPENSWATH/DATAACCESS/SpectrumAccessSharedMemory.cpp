@@ -0,0 +1,400 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessSharedMemory.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/CONCEPT/Macros.h>
+#include <OpenMS/CONCEPT/ParallelExceptionCollector.h>
+
+#include <QtCore/QSharedMemory>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace OpenMS
+{
+
+  namespace
+  {
+    /// Identifier at the start of the table segment (written last, it marks a complete set of maps)
+    const char SHARED_SWATH_MAPS_IDENTIFIER[8] = {'O', 'M', 'S', '_', 'S', 'W', 'M', '1'};
+
+    /// Entry of the table segment for one SWATH map
+    struct SharedSwathMapEntry
+    {
+      double lower;
+      double upper;
+      double center;
+      UInt64 ms1;
+      UInt64 nr_spectra;
+      UInt64 size;
+    };
+
+    /// Size of the table segment header (identifier and number of maps)
+    const Size TABLE_HEADER_SIZE = sizeof(SHARED_SWATH_MAPS_IDENTIFIER) + sizeof(UInt64);
+
+    /// Size of a spectrum record without the data (number of peaks, MS level, retention time), see CachedmzML
+    const Size SPECTRUM_HEADER_SIZE = sizeof(Size) + sizeof(int) + sizeof(double);
+
+    String getSegmentKey(const String& key, Size map_index)
+    {
+      return key + "_" + String(map_index);
+    }
+
+    /// Creates a segment of the given size, returns an empty pointer if the segment exists already
+    SpectrumAccessSharedMemory::SegmentPtr createSegment(const String& key, Size size)
+    {
+      if (size > (Size)std::numeric_limits<int>::max())
+      {
+        throw Exception::FailedAPICall(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+          "Cannot create shared memory segment " + key + " of " + String(size) + " bytes (segments are limited to 2 GB).");
+      }
+      SpectrumAccessSharedMemory::SegmentPtr segment(new QSharedMemory(key.toQString()));
+      // segments cannot be empty
+      if (!segment->create(std::max((int)size, 1)))
+      {
+        if (segment->error() == QSharedMemory::AlreadyExists)
+        {
+          return SpectrumAccessSharedMemory::SegmentPtr();
+        }
+        throw Exception::FailedAPICall(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+          "Cannot create shared memory segment " + key + ": " + String(segment->errorString()));
+      }
+      return segment;
+    }
+
+    /// Attaches a segment read-only, returns an empty pointer if the segment does not exist
+    SpectrumAccessSharedMemory::SegmentPtr attachSegment(const String& key)
+    {
+      SpectrumAccessSharedMemory::SegmentPtr segment(new QSharedMemory(key.toQString()));
+      if (!segment->attach(QSharedMemory::ReadOnly))
+      {
+        if (segment->error() == QSharedMemory::NotFound)
+        {
+          return SpectrumAccessSharedMemory::SegmentPtr();
+        }
+        throw Exception::FailedAPICall(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+          "Cannot attach to shared memory segment " + key + ": " + String(segment->errorString()));
+      }
+      return segment;
+    }
+  }
+
+  SpectrumAccessSharedMemory::SpectrumAccessSharedMemory(SegmentPtr table, SegmentPtr segment, Size nr_spectra) :
+    table_(table),
+    segment_(segment),
+    data_(static_cast<const char*>(segment->constData()))
+  {
+    // Create the index by going through the records of the segment
+    Size segment_size = segment_->size();
+    Size offset = 0;
+    spectra_index_.reserve(nr_spectra);
+    rt_.reserve(nr_spectra);
+    ms_level_.reserve(nr_spectra);
+    for (Size i = 0; i < nr_spectra; ++i)
+    {
+      if (offset + SPECTRUM_HEADER_SIZE > segment_size)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+          "Shared memory segment ends before spectrum " + String(i), String(segment_->key()));
+      }
+      Size spec_size;
+      int ms_level;
+      double rt;
+      std::memcpy(&spec_size, data_ + offset, sizeof(spec_size));
+      std::memcpy(&ms_level, data_ + offset + sizeof(spec_size), sizeof(ms_level));
+      std::memcpy(&rt, data_ + offset + sizeof(spec_size) + sizeof(ms_level), sizeof(rt));
+      if (spec_size > (segment_size - offset - SPECTRUM_HEADER_SIZE) / (2 * sizeof(double)))
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+          "Shared memory segment ends within spectrum " + String(i), String(segment_->key()));
+      }
+
+      spectra_index_.push_back(offset);
+      rt_.push_back(rt);
+      ms_level_.push_back(ms_level);
+      offset += SPECTRUM_HEADER_SIZE + 2 * spec_size * sizeof(double);
+    }
+  }
+
+  SpectrumAccessSharedMemory::~SpectrumAccessSharedMemory()
+  {
+  }
+
+  SpectrumAccessSharedMemory::SpectrumAccessSharedMemory(const SpectrumAccessSharedMemory & rhs) :
+    OpenSwath::ISpectrumAccess(rhs),
+    table_(rhs.table_),
+    segment_(rhs.segment_),
+    data_(rhs.data_),
+    spectra_index_(rhs.spectra_index_),
+    rt_(rhs.rt_),
+    ms_level_(rhs.ms_level_)
+  {
+  }
+
+  boost::shared_ptr<OpenSwath::ISpectrumAccess> SpectrumAccessSharedMemory::lightClone() const
+  {
+    return boost::shared_ptr<SpectrumAccessSharedMemory>(new SpectrumAccessSharedMemory(*this));
+  }
+
+  OpenSwath::SpectrumPtr SpectrumAccessSharedMemory::getSpectrumById(int id)
+  {
+    OpenSwath::BinaryDataArrayPtr mz_array(new OpenSwath::BinaryDataArray);
+    OpenSwath::BinaryDataArrayPtr intensity_array(new OpenSwath::BinaryDataArray);
+
+    const char* record = data_ + spectra_index_[id];
+    Size spec_size;
+    std::memcpy(&spec_size, record, sizeof(spec_size));
+    mz_array->data.resize(spec_size);
+    intensity_array->data.resize(spec_size);
+    if (spec_size > 0)
+    {
+      std::memcpy(&(mz_array->data)[0], record + SPECTRUM_HEADER_SIZE, spec_size * sizeof(double));
+      std::memcpy(&(intensity_array->data)[0], record + SPECTRUM_HEADER_SIZE + spec_size * sizeof(double), spec_size * sizeof(double));
+    }
+
+    OpenSwath::SpectrumPtr sptr(new OpenSwath::Spectrum);
+    sptr->setMZArray(mz_array);
+    sptr->setIntensityArray(intensity_array);
+    return sptr;
+  }
+
+  OpenSwath::SpectrumMeta SpectrumAccessSharedMemory::getSpectrumMetaById(int id) const
+  {
+    OpenSwath::SpectrumMeta meta;
+    meta.RT = rt_[id];
+    meta.ms_level = ms_level_[id];
+    return meta;
+  }
+
+  std::vector<std::size_t> SpectrumAccessSharedMemory::getSpectraByRT(double RT, double deltaRT) const
+  {
+    OPENMS_PRECONDITION(deltaRT >= 0, "Delta RT needs to be a positive number");
+
+    // we first perform a search for the spectrum that is past the
+    // beginning of the RT domain. Then we add this spectrum and try to add
+    // further spectra as long as they are below RT + deltaRT.
+    std::vector<std::size_t> result;
+    std::vector<double>::const_iterator spectrum = std::lower_bound(rt_.begin(), rt_.end(), RT - deltaRT);
+    result.push_back(spectrum - rt_.begin());
+    if (spectrum == rt_.end()) return result;
+    spectrum++;
+    while (spectrum != rt_.end() && *spectrum <= RT + deltaRT)
+    {
+      result.push_back(spectrum - rt_.begin());
+      spectrum++;
+    }
+    return result;
+  }
+
+  size_t SpectrumAccessSharedMemory::getNrSpectra() const
+  {
+    return spectra_index_.size();
+  }
+
+  OpenSwath::ChromatogramPtr SpectrumAccessSharedMemory::getChromatogramById(int id)
+  {
+    throw Exception::IndexOverflow(__FILE__, __LINE__, __PRETTY_FUNCTION__, id, 0);
+  }
+
+  size_t SpectrumAccessSharedMemory::getNrChromatograms() const
+  {
+    return 0;
+  }
+
+  std::string SpectrumAccessSharedMemory::getChromatogramNativeID(int id) const
+  {
+    throw Exception::IndexOverflow(__FILE__, __LINE__, __PRETTY_FUNCTION__, id, 0);
+  }
+
+  bool SpectrumAccessSharedMemory::publishSwathMaps(const std::vector<OpenSwath::SwathMap> & swath_maps, const String & key,
+                                                    std::vector<OpenSwath::SwathMap> & shared_maps)
+  {
+    // First pass: determine the size of each map
+    std::vector<SharedSwathMapEntry> table(swath_maps.size());
+    ParallelExceptionCollector errors;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (SignedSize i = 0; i < (SignedSize)swath_maps.size(); ++i)
+    {
+      if (errors.hasErrorBefore(i)) continue;
+      try
+      {
+        const OpenSwath::SpectrumAccessPtr& sptr = swath_maps[i].sptr;
+        table[i].lower = swath_maps[i].lower;
+        table[i].upper = swath_maps[i].upper;
+        table[i].center = swath_maps[i].center;
+        table[i].ms1 = swath_maps[i].ms1;
+        table[i].nr_spectra = sptr->getNrSpectra();
+        table[i].size = 0;
+        for (Size k = 0; k < sptr->getNrSpectra(); ++k)
+        {
+          table[i].size += SPECTRUM_HEADER_SIZE + 2 * sptr->getSpectrumById(k)->getMZArray()->data.size() * sizeof(double);
+        }
+      }
+      catch (...) // exceptions must not leave the parallel region
+      {
+        errors.capture(i);
+      }
+    }
+    errors.rethrow();
+
+    // Create the segments of the maps (the table segment is created last,
+    // other processes will only find the maps once they are complete)
+    std::vector<SegmentPtr> segments;
+    for (Size i = 0; i < swath_maps.size(); ++i)
+    {
+      segments.push_back(createSegment(getSegmentKey(key, i), table[i].size));
+      if (!segments.back()) return false;
+    }
+
+    // Second pass: copy the spectra into the segments
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (SignedSize i = 0; i < (SignedSize)swath_maps.size(); ++i)
+    {
+      if (errors.hasErrorBefore(i)) continue;
+      try
+      {
+        const OpenSwath::SpectrumAccessPtr& sptr = swath_maps[i].sptr;
+        char* record = static_cast<char*>(segments[i]->data());
+        for (Size k = 0; k < table[i].nr_spectra; ++k)
+        {
+          OpenSwath::SpectrumPtr spectrum = sptr->getSpectrumById(k);
+          OpenSwath::SpectrumMeta meta = sptr->getSpectrumMetaById(k);
+          const std::vector<double>& mz = spectrum->getMZArray()->data;
+          const std::vector<double>& intensity = spectrum->getIntensityArray()->data;
+          Size spec_size = mz.size();
+          std::memcpy(record, &spec_size, sizeof(spec_size));
+          std::memcpy(record + sizeof(spec_size), &meta.ms_level, sizeof(meta.ms_level));
+          std::memcpy(record + sizeof(spec_size) + sizeof(meta.ms_level), &meta.RT, sizeof(meta.RT));
+          record += SPECTRUM_HEADER_SIZE;
+          if (spec_size > 0)
+          {
+            std::memcpy(record, &mz[0], spec_size * sizeof(double));
+            std::memcpy(record + spec_size * sizeof(double), &intensity[0], spec_size * sizeof(double));
+            record += 2 * spec_size * sizeof(double);
+          }
+        }
+      }
+      catch (...) // exceptions must not leave the parallel region
+      {
+        errors.capture(i);
+      }
+    }
+    errors.rethrow();
+
+    SegmentPtr table_segment = createSegment(key, TABLE_HEADER_SIZE + table.size() * sizeof(SharedSwathMapEntry));
+    if (!table_segment) return false;
+    // readers lock the table segment as well, so they see either no or the complete table
+    table_segment->lock();
+    char* data = static_cast<char*>(table_segment->data());
+    UInt64 nr_maps = table.size();
+    std::memcpy(data + sizeof(SHARED_SWATH_MAPS_IDENTIFIER), &nr_maps, sizeof(nr_maps));
+    if (!table.empty())
+    {
+      std::memcpy(data + TABLE_HEADER_SIZE, &table[0], table.size() * sizeof(SharedSwathMapEntry));
+    }
+    std::memcpy(data, SHARED_SWATH_MAPS_IDENTIFIER, sizeof(SHARED_SWATH_MAPS_IDENTIFIER));
+    table_segment->unlock();
+
+    // swath_maps and shared_maps may be the same vector
+    std::vector<OpenSwath::SwathMap> maps;
+    for (Size i = 0; i < swath_maps.size(); ++i)
+    {
+      OpenSwath::SwathMap map = swath_maps[i];
+      map.sptr = OpenSwath::SpectrumAccessPtr(new SpectrumAccessSharedMemory(table_segment, segments[i], table[i].nr_spectra));
+      maps.push_back(map);
+    }
+    shared_maps.swap(maps);
+    return true;
+  }
+
+  bool SpectrumAccessSharedMemory::attachSwathMaps(const String & key, std::vector<OpenSwath::SwathMap> & swath_maps)
+  {
+    SegmentPtr table_segment = attachSegment(key);
+    if (!table_segment) return false;
+
+    // copy the header under the lock of the publisher (see publishSwathMaps)
+    const char* data = static_cast<const char*>(table_segment->constData());
+    Size table_size = table_segment->size();
+    if (table_size < TABLE_HEADER_SIZE)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+        "Shared memory segment is too small for a table of SWATH maps", key);
+    }
+    table_segment->lock();
+    bool published = (std::memcmp(data, SHARED_SWATH_MAPS_IDENTIFIER, sizeof(SHARED_SWATH_MAPS_IDENTIFIER)) == 0);
+    UInt64 nr_maps;
+    std::memcpy(&nr_maps, data + sizeof(SHARED_SWATH_MAPS_IDENTIFIER), sizeof(nr_maps));
+    table_segment->unlock();
+    if (!published)
+    {
+      return false; // the maps are still being published
+    }
+    if (nr_maps > (table_size - TABLE_HEADER_SIZE) / sizeof(SharedSwathMapEntry))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+        "Shared memory segment ends within the table of SWATH maps", key);
+    }
+
+    std::vector<OpenSwath::SwathMap> maps;
+    for (Size i = 0; i < nr_maps; ++i)
+    {
+      SharedSwathMapEntry entry;
+      std::memcpy(&entry, data + TABLE_HEADER_SIZE + i * sizeof(SharedSwathMapEntry), sizeof(entry));
+      SegmentPtr segment = attachSegment(getSegmentKey(key, i));
+      if (!segment)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+          "Shared memory segment of SWATH map " + String(i) + " not found", key);
+      }
+
+      OpenSwath::SwathMap map;
+      map.sptr = OpenSwath::SpectrumAccessPtr(new SpectrumAccessSharedMemory(table_segment, segment, entry.nr_spectra));
+      map.lower = entry.lower;
+      map.upper = entry.upper;
+      map.center = entry.center;
+      map.ms1 = (entry.ms1 != 0);
+      maps.push_back(map);
+    }
+    swath_maps.swap(maps);
+    return true;
+  }
+
+} //end namespace OpenMS
@@ -36,6 +36,7 @@
 #include <OpenMS/CONCEPT/Constants.h>
 #include <OpenMS/DATASTRUCTURES/ListUtils.h>
 #include <OpenMS/CHEMISTRY/IsotopeDistribution.h>
+#include <OpenMS/MATH/MISC/MathFunctions.h>
 
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/FeatureFinderAlgorithmPickedHelperStructs.h>
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/FeatureFinderAlgorithm.h>
@@ -53,10 +54,24 @@
 
 const double C13C12_MASSDIFF_U = 1.0033548;
 
+namespace
+{
+  // Averagine element counts divided by averagine weight (C, H, N, O, S), as
+  // used by IsotopeDistribution::estimateFromPeptideWeight which only depends
+  // on the rounded element counts of the given weight.
+  const double AVERAGINE_FACTORS[5] =
+  {
+    4.9384 / 111.1254, 7.7583 / 111.1254, 1.3577 / 111.1254, 1.4773 / 111.1254, 0.0417 / 111.1254
+  };
+  // bits per element count in the packed averagine cache key
+  const unsigned AVERAGINE_KEY_BITS = 12;
+}
+
 namespace OpenMS
 {
   DIAScoring::DIAScoring() :
-    DefaultParamHandler("DIAScoring")
+    DefaultParamHandler("DIAScoring"),
+    by_series_charge_(0)
   {
 
     defaults_.setValue("dia_extraction_window", 0.05, "DIA extraction window in Th.");
@@ -90,6 +105,9 @@ namespace OpenMS
     dia_nr_isotopes_ = (int)param_.getValue("dia_nr_isotopes");
     dia_nr_charges_ = (int)param_.getValue("dia_nr_charges");
     peak_before_mono_max_ppm_diff_ = (double)param_.getValue("peak_before_mono_max_ppm_diff");
+
+    // the number of isotopes determines the cached patterns
+    averagine_cache_.clear();
   }
 
   void DIAScoring::set_dia_parameters(double dia_extract_window, double dia_centroided,
@@ -102,6 +120,8 @@ namespace OpenMS
 
     dia_nr_isotopes_ = dia_nr_isotopes;
     dia_nr_charges_ = dia_nr_charges;
+
+    averagine_cache_.clear();
   }
 
   ///////////////////////////////////////////////////////////////////////////
@@ -234,6 +254,130 @@ namespace OpenMS
     }
   }
 
+  void DIAScoring::dia_ms2_scores(const std::vector<TransitionType>& transitions, SpectrumPtrType spectrum,
+                                  OpenSwath::IMRMFeature* mrmfeature, const std::vector<double>& normalized_library_intensity,
+                                  AASequence& sequence, int by_charge,
+                                  double& isotope_corr, double& isotope_overlap,
+                                  double& ppm_score, double& ppm_score_weighted,
+                                  double& bseries_score, double& yseries_score)
+  {
+    if (dia_centroided_)
+    {
+      // batch integration is only available for profile data
+      dia_isotope_scores(transitions, spectrum, mrmfeature, isotope_corr, isotope_overlap);
+      dia_massdiff_score(transitions, spectrum, normalized_library_intensity, ppm_score, ppm_score_weighted);
+      dia_by_ion_score(spectrum, sequence, by_charge, bseries_score, yseries_score);
+      return;
+    }
+    OPENMS_PRECONDITION(by_charge > 0, "Charge is a positive integer");
+
+    isotope_corr = 0;
+    isotope_overlap = 0;
+    ppm_score = 0;
+    ppm_score_weighted = 0;
+    bseries_score = 0;
+    yseries_score = 0;
+
+    // the same peptide is usually scored for many peak groups in a row
+    if (by_charge != by_series_charge_ || !(sequence == by_series_sequence_))
+    {
+      bseries_cache_.clear();
+      yseries_cache_.clear();
+      OpenMS::DIAHelpers::getBYSeries(sequence, bseries_cache_, yseries_cache_, by_charge);
+      by_series_sequence_ = sequence;
+      by_series_charge_ = by_charge;
+    }
+
+    // collect all windows: per transition the isotopes (the first of which is
+    // also the mass difference window) and the peaks before the
+    // monoisotopic peak, followed by the b and y ions
+    std::vector<double> left, right;
+    std::vector<Size> iso_offset(transitions.size()), pre_offset(transitions.size());
+    std::vector<int> fragment_charge(transitions.size(), 1);
+    for (Size k = 0; k < transitions.size(); k++)
+    {
+      // If no charge is given, we assume it to be 1
+      if (transitions[k].charge > 0)
+      {
+        fragment_charge[k] = transitions[k].charge;
+      }
+      const double product_mz = transitions[k].getProductMZ();
+
+      iso_offset[k] = left.size();
+      for (int iso = 0; iso <= dia_nr_isotopes_; ++iso)
+      {
+        left.push_back(product_mz - dia_extract_window_ / 2.0 + iso * C13C12_MASSDIFF_U / static_cast<double>(fragment_charge[k]));
+        right.push_back(product_mz + dia_extract_window_ / 2.0 + iso * C13C12_MASSDIFF_U / static_cast<double>(fragment_charge[k]));
+      }
+      pre_offset[k] = left.size();
+      for (int ch = 1; ch <= dia_nr_charges_; ++ch)
+      {
+        left.push_back(product_mz - dia_extract_window_ / 2.0 - C13C12_MASSDIFF_U / (double) ch);
+        right.push_back(product_mz + dia_extract_window_ / 2.0 - C13C12_MASSDIFF_U / (double) ch);
+      }
+    }
+    const Size b_offset = left.size();
+    for (Size it = 0; it < bseries_cache_.size(); it++)
+    {
+      left.push_back(bseries_cache_[it] - dia_extract_window_ / 2.0);
+      right.push_back(bseries_cache_[it] + dia_extract_window_ / 2.0);
+    }
+    const Size y_offset = left.size();
+    for (Size it = 0; it < yseries_cache_.size(); it++)
+    {
+      left.push_back(yseries_cache_[it] - dia_extract_window_ / 2.0);
+      right.push_back(yseries_cache_[it] + dia_extract_window_ / 2.0);
+    }
+
+    std::vector<double> mz, intensity;
+    OpenSwath::integrateWindowBatch(spectrum, left, right, mz, intensity);
+
+    // isotope scores
+    std::vector<double> isotopes_int;
+    double max_ratio;
+    int nr_occurences;
+    for (Size k = 0; k < transitions.size(); k++)
+    {
+      double rel_intensity = mrmfeature->getFeature(transitions[k].getNativeID())->getIntensity() / mrmfeature->getIntensity();
+      isotopes_int.assign(intensity.begin() + iso_offset[k], intensity.begin() + pre_offset[k]);
+
+      double score = scoreIsotopePattern_(transitions[k].getProductMZ(), isotopes_int, fragment_charge[k]);
+      isotope_corr += score * rel_intensity;
+      largePeaksBeforeFirstIsotopeSub_(transitions[k].getProductMZ(), isotopes_int[0], mz, intensity, pre_offset[k], nr_occurences, max_ratio);
+      isotope_overlap += nr_occurences * rel_intensity;
+    }
+
+    // mass difference scores (no statement if no signal is present)
+    for (Size k = 0; k < transitions.size(); k++)
+    {
+      if (!(intensity[iso_offset[k]] > 0.))
+      {
+        continue;
+      }
+      double diff_ppm = std::fabs(mz[iso_offset[k]] - transitions[k].getProductMZ()) * 1000000 / transitions[k].getProductMZ();
+      ppm_score += diff_ppm;
+      ppm_score_weighted += diff_ppm * normalized_library_intensity[k];
+    }
+
+    // b/y ion scores
+    for (Size it = 0; it < bseries_cache_.size(); it++)
+    {
+      double ppmdiff = std::fabs(bseries_cache_[it] - mz[b_offset + it]) * 1000000 / bseries_cache_[it];
+      if (intensity[b_offset + it] > 0. && ppmdiff < dia_byseries_ppm_diff_ && intensity[b_offset + it] > dia_byseries_intensity_min_)
+      {
+        bseries_score++;
+      }
+    }
+    for (Size it = 0; it < yseries_cache_.size(); it++)
+    {
+      double ppmdiff = std::fabs(yseries_cache_[it] - mz[y_offset + it]) * 1000000 / yseries_cache_[it];
+      if (intensity[y_offset + it] > 0. && ppmdiff < dia_byseries_ppm_diff_ && intensity[y_offset + it] > dia_byseries_intensity_min_)
+      {
+        yseries_score++;
+      }
+    }
+  }
+
   void DIAScoring::score_with_isotopes(SpectrumPtrType spectrum, const std::vector<TransitionType>& transitions,
                                        double& dotprod, double& manhattan)
   {
@@ -298,19 +442,34 @@ namespace OpenMS
 
   void DIAScoring::largePeaksBeforeFirstIsotope_(SpectrumPtrType spectrum, double mono_mz, double mono_int, int& nr_occurences, double& max_ratio)
   {
-    double mz, intensity;
+    std::vector<double> mz_found, intensity_found;
+    for (int ch = 1; ch <= dia_nr_charges_; ++ch)
+    {
+      double mz, intensity;
+      double left = mono_mz - dia_extract_window_ / 2.0 - C13C12_MASSDIFF_U / (double) ch;
+      double right = mono_mz + dia_extract_window_ / 2.0 - C13C12_MASSDIFF_U / (double) ch;
+      integrateWindow(spectrum, left, right, mz, intensity, dia_centroided_);
+      mz_found.push_back(mz);
+      intensity_found.push_back(intensity);
+    }
+    largePeaksBeforeFirstIsotopeSub_(mono_mz, mono_int, mz_found, intensity_found, 0, nr_occurences, max_ratio);
+  }
+
+  void DIAScoring::largePeaksBeforeFirstIsotopeSub_(double mono_mz, double mono_int,
+                                                    const std::vector<double>& mz_found, const std::vector<double>& intensity_found, Size offset,
+                                                    int& nr_occurences, double& max_ratio)
+  {
     nr_occurences = 0;
     max_ratio = 0.0;
 
     for (int ch = 1; ch <= dia_nr_charges_; ++ch)
     {
-      double left = mono_mz - dia_extract_window_ / 2.0 - C13C12_MASSDIFF_U / (double) ch;
-      double right = mono_mz + dia_extract_window_ / 2.0 - C13C12_MASSDIFF_U / (double) ch;
-      bool signalFound = integrateWindow(spectrum, left, right, mz, intensity, dia_centroided_);
+      double mz = mz_found[offset + ch - 1];
+      double intensity = intensity_found[offset + ch - 1];
 
       // Continue if no signal was found - we therefore don't make a statement
       // about the mass difference if no signal is present.
-      if (!signalFound)
+      if (!(intensity > 0.))
       {
         continue;
       }
@@ -342,47 +501,67 @@ namespace OpenMS
   {
     OPENMS_PRECONDITION(putative_fragment_charge > 0, "Charge is a positive integer");
 
-    typedef OpenMS::FeatureFinderAlgorithmPickedHelperStructs::TheoreticalIsotopePattern TheoreticalIsotopePattern;
+    //FEATURE ISO pattern for peptide sequence..
+    const std::vector<double>& isotopes = getAveragineIsotopePattern_(product_mz * putative_fragment_charge);
+
+    // score the pattern against a theoretical one
+    double int_score = OpenSwath::cor_pearson(isotopes_int.begin(), isotopes_int.end(), isotopes.begin());
+    if (boost::math::isnan(int_score))
+    {
+      int_score = 0;
+    }
+    return int_score;
+
+  } //end of dia_isotope_corr_sub
+
+  const std::vector<double>& DIAScoring::getAveragineIsotopePattern_(double mass)
+  {
+    // pack the averagine composition of this mass into the cache key
+    UInt64 key = 0;
+    bool cacheable = true;
+    for (Size i = 0; i < 5; ++i)
+    {
+      UInt64 count = (UInt64) Math::round(mass * AVERAGINE_FACTORS[i]);
+      cacheable = cacheable && count < (UInt64(1) << AVERAGINE_KEY_BITS);
+      key = (key << AVERAGINE_KEY_BITS) | count;
+    }
+    if (!cacheable)
+    {
+      // do not let very large masses collide with others, use a single slot
+      key = ~UInt64(0);
+      averagine_cache_.erase(key);
+    }
+
+    std::map<UInt64, std::vector<double> >::iterator it = averagine_cache_.find(key);
+    if (it != averagine_cache_.end())
+    {
+      return it->second;
+    }
 
     // create the theoretical distribution
     IsotopeDistribution d;
-    TheoreticalIsotopePattern isotopes;
     d.setMaxIsotope(dia_nr_isotopes_ + 1);
-    d.estimateFromPeptideWeight(product_mz * putative_fragment_charge);
-    for (IsotopeDistribution::Iterator it = d.begin(); it != d.end(); ++it)
+    d.estimateFromPeptideWeight(mass);
+    std::vector<double>& isotopes = averagine_cache_[key];
+    for (IsotopeDistribution::Iterator d_it = d.begin(); d_it != d.end(); ++d_it)
     {
-      isotopes.intensity.push_back(it->second);
+      isotopes.push_back(d_it->second);
     }
 
-    //FEATURE ISO pattern for peptide sequence..
-
-    isotopes.optional_begin = 0;
-    isotopes.optional_end = dia_nr_isotopes_;
-
     //scale the distribution to a maximum of 1
     double max = 0.0;
-    for (Size i = 0; i < isotopes.intensity.size(); ++i)
+    for (Size i = 0; i < isotopes.size(); ++i)
     {
-      if (isotopes.intensity[i] > max)
+      if (isotopes[i] > max)
       {
-        max = isotopes.intensity[i];
+        max = isotopes[i];
       }
     }
-    isotopes.max = max;
-    for (Size i = 0; i < isotopes.intensity.size(); ++i)
-    {
-      isotopes.intensity[i] /= max;
-    }
-    isotopes.trimmed_left = 0;
-
-    // score the pattern against a theoretical one
-    double int_score = OpenSwath::cor_pearson(isotopes_int.begin(), isotopes_int.end(), isotopes.intensity.begin());
-    if (boost::math::isnan(int_score))
+    for (Size i = 0; i < isotopes.size(); ++i)
     {
-      int_score = 0;
+      isotopes[i] /= max;
     }
-    return int_score;
-
-  } //end of dia_isotope_corr_sub
+    return isotopes;
+  }
 
 }
@@ -0,0 +1,732 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/OPENSWATH/LightTransitionTable.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <QtCore/QFile>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <set>
+
+using namespace std;
+
+namespace OpenMS
+{
+  namespace
+  {
+    /// Magic bytes at the beginning of cache files (includes format version)
+    const char CACHE_MAGIC[8] = {'O', 'M', 'S', '_', 'L', 'T', 'T', '1'};
+
+    /// Flag bits
+    enum
+    {
+      FLAG_DECOY = 1,
+      FLAG_DETECTING = 2,
+      FLAG_QUANTIFYING = 4,
+      FLAG_IDENTIFYING = 8
+    };
+
+    /// Rounds up to a multiple of 8 (for alignment of the columns)
+    UInt64 align8(UInt64 offset)
+    {
+      return (offset + 7) & ~UInt64(7);
+    }
+
+    /// Orders transitions by precursor m/z, then by peptide, then by input order
+    struct RowLess
+    {
+      const vector<double>* precursor_mz;
+      const vector<UInt>* peptide;
+
+      RowLess(const vector<double>* precursor_mz_, const vector<UInt>* peptide_) :
+        precursor_mz(precursor_mz_), peptide(peptide_)
+      {
+      }
+
+      bool operator()(UInt a, UInt b) const
+      {
+        if ((*precursor_mz)[a] != (*precursor_mz)[b]) return (*precursor_mz)[a] < (*precursor_mz)[b];
+        if ((*peptide)[a] != (*peptide)[b]) return (*peptide)[a] < (*peptide)[b];
+        return a < b;
+      }
+    };
+
+    /// Rearranges @p column according to @p order
+    template <typename T>
+    void permute(vector<T>& column, const vector<UInt>& order)
+    {
+      vector<T> result;
+      result.reserve(column.size());
+      for (Size i = 0; i < order.size(); ++i)
+      {
+        result.push_back(column[order[i]]);
+      }
+      column.swap(result);
+    }
+
+    /// Rearranges a ragged column (given by offsets and values) according to @p order
+    template <typename T>
+    void permuteRagged(vector<UInt>& offsets, vector<T>& values, const vector<UInt>& order)
+    {
+      vector<UInt> new_offsets(1, 0);
+      new_offsets.reserve(offsets.size());
+      vector<T> new_values;
+      new_values.reserve(values.size());
+      for (Size i = 0; i < order.size(); ++i)
+      {
+        new_values.insert(new_values.end(), values.begin() + offsets[order[i]],
+                          values.begin() + offsets[order[i] + 1]);
+        new_offsets.push_back(new_values.size());
+      }
+      offsets.swap(new_offsets);
+      values.swap(new_values);
+    }
+
+    /// Writes each column as its length followed by the (8-byte aligned) data
+    struct ColumnWriter
+    {
+      ofstream& out;
+
+      explicit ColumnWriter(ofstream& out_) :
+        out(out_)
+      {
+      }
+
+      template <typename T>
+      void operator()(const vector<T>& column)
+      {
+        const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+        UInt64 n = column.size(), bytes = n * sizeof(T);
+        out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+        if (bytes > 0) out.write(reinterpret_cast<const char*>(&column[0]), bytes);
+        out.write(padding, align8(bytes) - bytes);
+      }
+    };
+
+    /// Checks that @p offsets start at 0, do not decrease and end at @p values_size
+    bool validOffsets(const vector<UInt>& offsets, Size expected_size, Size values_size)
+    {
+      if ((offsets.size() != expected_size) || offsets.empty() || (offsets.front() != 0) || (offsets.back() != values_size))
+      {
+        return false;
+      }
+      for (Size i = 1; i < offsets.size(); ++i)
+      {
+        if (offsets[i] < offsets[i - 1]) return false;
+      }
+      return true;
+    }
+
+    /// Checks that all @p indices are smaller than @p limit
+    bool validIndices(const vector<UInt>& indices, Size limit)
+    {
+      for (Size i = 0; i < indices.size(); ++i)
+      {
+        if (indices[i] >= limit) return false;
+      }
+      return true;
+    }
+
+    /// Reads the columns written by ColumnWriter from mapped memory
+    struct ColumnReader
+    {
+      const uchar* data;
+      UInt64 size;
+      UInt64 offset;
+      bool ok;
+
+      ColumnReader(const uchar* data_, UInt64 size_, UInt64 offset_) :
+        data(data_), size(size_), offset(offset_), ok(true)
+      {
+      }
+
+      template <typename T>
+      void operator()(vector<T>& column)
+      {
+        UInt64 n;
+        if (!ok || (offset + sizeof(n) > size))
+        {
+          ok = false;
+          return;
+        }
+        memcpy(&n, data + offset, sizeof(n));
+        offset += sizeof(n);
+        if (n > (size - offset) / sizeof(T))
+        {
+          ok = false;
+          return;
+        }
+        column.resize(n);
+        if (n > 0) memcpy(&column[0], data + offset, n * sizeof(T));
+        offset += align8(n * sizeof(T));
+      }
+    };
+  }
+
+  LightTransitionTable::View::View() :
+    begin(0), end(0)
+  {
+  }
+
+  LightTransitionTable::View::View(Size begin, Size end) :
+    begin(begin), end(end)
+  {
+  }
+
+  Size LightTransitionTable::View::size() const
+  {
+    return end - begin;
+  }
+
+  bool LightTransitionTable::View::empty() const
+  {
+    return end == begin;
+  }
+
+  LightTransitionTable::LightTransitionTable()
+  {
+    clear();
+  }
+
+  LightTransitionTable::LightTransitionTable(const OpenSwath::LightTargetedExperiment& targeted_exp)
+  {
+    build(targeted_exp);
+  }
+
+  LightTransitionTable::~LightTransitionTable()
+  {
+  }
+
+  template <typename Table, typename ColumnVisitor>
+  void LightTransitionTable::visitColumns_(Table& table, ColumnVisitor& visitor)
+  {
+    visitor(table.string_data_);
+    visitor(table.string_offsets_);
+    visitor(table.precursor_mz_);
+    visitor(table.product_mz_);
+    visitor(table.library_intensity_);
+    visitor(table.charge_);
+    visitor(table.transition_name_);
+    visitor(table.peptide_);
+    visitor(table.flags_);
+    visitor(table.site_transition_offsets_);
+    visitor(table.site_identifying_transition_);
+    visitor(table.site_class_offsets_);
+    visitor(table.site_identifying_class_);
+    visitor(table.peptide_id_);
+    visitor(table.peptide_rt_);
+    visitor(table.peptide_charge_);
+    visitor(table.peptide_sequence_);
+    visitor(table.peptide_group_label_);
+    visitor(table.protein_ref_offsets_);
+    visitor(table.protein_refs_);
+    visitor(table.modification_offsets_);
+    visitor(table.modification_location_);
+    visitor(table.modification_unimod_id_);
+    visitor(table.protein_id_);
+    visitor(table.protein_sequence_);
+  }
+
+  void LightTransitionTable::clear()
+  {
+    string_data_.clear();
+    string_offsets_.assign(1, 0);
+    precursor_mz_.clear();
+    product_mz_.clear();
+    library_intensity_.clear();
+    charge_.clear();
+    transition_name_.clear();
+    peptide_.clear();
+    flags_.clear();
+    site_transition_offsets_.assign(1, 0);
+    site_identifying_transition_.clear();
+    site_class_offsets_.assign(1, 0);
+    site_identifying_class_.clear();
+    peptide_id_.clear();
+    peptide_rt_.clear();
+    peptide_charge_.clear();
+    peptide_sequence_.clear();
+    peptide_group_label_.clear();
+    protein_ref_offsets_.assign(1, 0);
+    protein_refs_.clear();
+    modification_offsets_.assign(1, 0);
+    modification_location_.clear();
+    modification_unimod_id_.clear();
+    protein_id_.clear();
+    protein_sequence_.clear();
+    protein_index_.clear();
+  }
+
+  UInt LightTransitionTable::intern_(const std::string& s, std::map<std::string, UInt>& pool_index)
+  {
+    std::map<std::string, UInt>::iterator it = pool_index.find(s);
+    if (it != pool_index.end()) return it->second;
+
+    UInt index = string_offsets_.size() - 1;
+    string_data_.insert(string_data_.end(), s.begin(), s.end());
+    string_offsets_.push_back(string_data_.size());
+    pool_index.insert(make_pair(s, index));
+    return index;
+  }
+
+  std::string LightTransitionTable::getString_(UInt index) const
+  {
+    if (string_offsets_[index] == string_offsets_[index + 1]) return std::string();
+    return std::string(&string_data_[string_offsets_[index]], string_offsets_[index + 1] - string_offsets_[index]);
+  }
+
+  void LightTransitionTable::updateProteinIndex_()
+  {
+    protein_index_.clear();
+    for (Size i = 0; i < protein_id_.size(); ++i)
+    {
+      protein_index_.insert(make_pair(protein_id_[i], i));
+    }
+  }
+
+  void LightTransitionTable::build(const OpenSwath::LightTargetedExperiment& targeted_exp)
+  {
+    clear();
+    std::map<std::string, UInt> pool_index;
+
+    // proteins
+    protein_id_.reserve(targeted_exp.proteins.size());
+    protein_sequence_.reserve(targeted_exp.proteins.size());
+    for (Size i = 0; i < targeted_exp.proteins.size(); ++i)
+    {
+      protein_id_.push_back(intern_(targeted_exp.proteins[i].id, pool_index));
+      protein_sequence_.push_back(intern_(targeted_exp.proteins[i].sequence, pool_index));
+    }
+
+    // peptides
+    std::map<std::string, UInt> peptide_index;
+    for (Size i = 0; i < targeted_exp.peptides.size(); ++i)
+    {
+      const OpenSwath::LightPeptide& pep = targeted_exp.peptides[i];
+      peptide_index.insert(make_pair(pep.id, (UInt)i));
+      peptide_id_.push_back(intern_(pep.id, pool_index));
+      peptide_rt_.push_back(pep.rt);
+      peptide_charge_.push_back(pep.charge);
+      peptide_sequence_.push_back(intern_(pep.sequence, pool_index));
+      peptide_group_label_.push_back(intern_(pep.peptide_group_label, pool_index));
+      for (Size k = 0; k < pep.protein_refs.size(); ++k)
+      {
+        protein_refs_.push_back(intern_(pep.protein_refs[k], pool_index));
+      }
+      protein_ref_offsets_.push_back(protein_refs_.size());
+      for (Size k = 0; k < pep.modifications.size(); ++k)
+      {
+        modification_location_.push_back(pep.modifications[k].location);
+        modification_unimod_id_.push_back(intern_(pep.modifications[k].unimod_id, pool_index));
+      }
+      modification_offsets_.push_back(modification_location_.size());
+    }
+
+    // transitions (in input order first)
+    const Size n = targeted_exp.transitions.size();
+    precursor_mz_.reserve(n);
+    product_mz_.reserve(n);
+    library_intensity_.reserve(n);
+    charge_.reserve(n);
+    transition_name_.reserve(n);
+    peptide_.reserve(n);
+    flags_.reserve(n);
+    for (Size i = 0; i < n; ++i)
+    {
+      const OpenSwath::LightTransition& tr = targeted_exp.transitions[i];
+      std::map<std::string, UInt>::const_iterator pep_it = peptide_index.find(tr.peptide_ref);
+      if (pep_it == peptide_index.end())
+      {
+        clear();
+        throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+                                         "Transition " + tr.transition_name + " references unknown peptide " + tr.peptide_ref);
+      }
+      precursor_mz_.push_back(tr.precursor_mz);
+      product_mz_.push_back(tr.product_mz);
+      library_intensity_.push_back(tr.library_intensity);
+      charge_.push_back(tr.charge);
+      transition_name_.push_back(intern_(tr.transition_name, pool_index));
+      peptide_.push_back(pep_it->second);
+      flags_.push_back((tr.decoy ? FLAG_DECOY : 0) |
+                       (tr.detecting_transition ? FLAG_DETECTING : 0) |
+                       (tr.quantifying_transition ? FLAG_QUANTIFYING : 0) |
+                       (tr.identifying_transition ? FLAG_IDENTIFYING : 0));
+      site_identifying_transition_.insert(site_identifying_transition_.end(),
+                                          tr.site_identifying_transition.begin(),
+                                          tr.site_identifying_transition.end());
+      site_transition_offsets_.push_back(site_identifying_transition_.size());
+      for (Size k = 0; k < tr.site_identifying_class.size(); ++k)
+      {
+        site_identifying_class_.push_back(intern_(tr.site_identifying_class[k], pool_index));
+      }
+      site_class_offsets_.push_back(site_identifying_class_.size());
+    }
+
+    // sort rows by precursor m/z (stable, transitions of a peptide stay together)
+    vector<UInt> order(n);
+    for (Size i = 0; i < n; ++i)
+    {
+      order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), RowLess(&precursor_mz_, &peptide_));
+    permute(precursor_mz_, order);
+    permute(product_mz_, order);
+    permute(library_intensity_, order);
+    permute(charge_, order);
+    permute(transition_name_, order);
+    permute(peptide_, order);
+    permute(flags_, order);
+    permuteRagged(site_transition_offsets_, site_identifying_transition_, order);
+    permuteRagged(site_class_offsets_, site_identifying_class_, order);
+
+    updateProteinIndex_();
+  }
+
+  Size LightTransitionTable::size() const
+  {
+    return precursor_mz_.size();
+  }
+
+  Size LightTransitionTable::getNrPeptides() const
+  {
+    return peptide_id_.size();
+  }
+
+  Size LightTransitionTable::getNrProteins() const
+  {
+    return protein_id_.size();
+  }
+
+  LightTransitionTable::View LightTransitionTable::getAllRows() const
+  {
+    return View(0, size());
+  }
+
+  double LightTransitionTable::getPrecursorMZ(Size row) const
+  {
+    return precursor_mz_[row];
+  }
+
+  double LightTransitionTable::getProductMZ(Size row) const
+  {
+    return product_mz_[row];
+  }
+
+  double LightTransitionTable::getLibraryIntensity(Size row) const
+  {
+    return library_intensity_[row];
+  }
+
+  int LightTransitionTable::getCharge(Size row) const
+  {
+    return charge_[row];
+  }
+
+  bool LightTransitionTable::isDecoy(Size row) const
+  {
+    return (flags_[row] & FLAG_DECOY) != 0;
+  }
+
+  std::string LightTransitionTable::getTransitionName(Size row) const
+  {
+    return getString_(transition_name_[row]);
+  }
+
+  std::string LightTransitionTable::getPeptideRef(Size row) const
+  {
+    return getString_(peptide_id_[peptide_[row]]);
+  }
+
+  Size LightTransitionTable::getPeptideIndex(Size row) const
+  {
+    return peptide_[row];
+  }
+
+  Size LightTransitionTable::getNrPeptides(const View& view) const
+  {
+    std::set<UInt> peptides(peptide_.begin() + view.begin, peptide_.begin() + view.end);
+    return peptides.size();
+  }
+
+  void LightTransitionTable::getTransition(Size row, OpenSwath::LightTransition& transition) const
+  {
+    transition.transition_name = getString_(transition_name_[row]);
+    transition.peptide_ref = getString_(peptide_id_[peptide_[row]]);
+    transition.library_intensity = library_intensity_[row];
+    transition.product_mz = product_mz_[row];
+    transition.precursor_mz = precursor_mz_[row];
+    transition.charge = charge_[row];
+    transition.decoy = (flags_[row] & FLAG_DECOY) != 0;
+    transition.detecting_transition = (flags_[row] & FLAG_DETECTING) != 0;
+    transition.quantifying_transition = (flags_[row] & FLAG_QUANTIFYING) != 0;
+    transition.identifying_transition = (flags_[row] & FLAG_IDENTIFYING) != 0;
+    transition.site_identifying_transition.assign(site_identifying_transition_.begin() + site_transition_offsets_[row],
+                                                  site_identifying_transition_.begin() + site_transition_offsets_[row + 1]);
+    transition.site_identifying_class.clear();
+    for (UInt k = site_class_offsets_[row]; k < site_class_offsets_[row + 1]; ++k)
+    {
+      transition.site_identifying_class.push_back(getString_(site_identifying_class_[k]));
+    }
+  }
+
+  void LightTransitionTable::getPeptide(Size index, OpenSwath::LightPeptide& peptide) const
+  {
+    peptide.rt = peptide_rt_[index];
+    peptide.charge = peptide_charge_[index];
+    peptide.sequence = getString_(peptide_sequence_[index]);
+    peptide.peptide_group_label = getString_(peptide_group_label_[index]);
+    peptide.id = getString_(peptide_id_[index]);
+    peptide.protein_refs.clear();
+    for (UInt k = protein_ref_offsets_[index]; k < protein_ref_offsets_[index + 1]; ++k)
+    {
+      peptide.protein_refs.push_back(getString_(protein_refs_[k]));
+    }
+    peptide.modifications.clear();
+    for (UInt k = modification_offsets_[index]; k < modification_offsets_[index + 1]; ++k)
+    {
+      OpenSwath::LightModification m;
+      m.location = modification_location_[k];
+      m.unimod_id = getString_(modification_unimod_id_[k]);
+      peptide.modifications.push_back(m);
+    }
+  }
+
+  void LightTransitionTable::getProtein(Size index, OpenSwath::LightProtein& protein) const
+  {
+    protein.id = getString_(protein_id_[index]);
+    protein.sequence = getString_(protein_sequence_[index]);
+  }
+
+  LightTransitionTable::View LightTransitionTable::selectSwath(double lower, double upper, double min_upper_edge_dist) const
+  {
+    // rows with lower < precursor m/z < upper
+    Size begin = std::upper_bound(precursor_mz_.begin(), precursor_mz_.end(), lower) - precursor_mz_.begin();
+    Size end = std::lower_bound(precursor_mz_.begin() + begin, precursor_mz_.end(), upper) - precursor_mz_.begin();
+
+    // |upper - precursor m/z| >= min_upper_edge_dist holds for a prefix of these rows
+    Size lo = begin, hi = end;
+    while (lo < hi)
+    {
+      Size mid = lo + (hi - lo) / 2;
+      if (std::fabs(upper - precursor_mz_[mid]) >= min_upper_edge_dist)
+      {
+        lo = mid + 1;
+      }
+      else
+      {
+        hi = mid;
+      }
+    }
+    return View(begin, lo);
+  }
+
+  void LightTransitionTable::splitIntoBatches(const View& view, Size batch_size, std::vector<View>& batches) const
+  {
+    batches.clear();
+    if (view.empty()) return;
+    if (batch_size == 0)
+    {
+      batches.push_back(view);
+      return;
+    }
+
+    // count peptides by changes of the peptide between consecutive rows
+    Size batch_begin = view.begin, nr_peptides = 1;
+    for (Size row = view.begin + 1; row < view.end; ++row)
+    {
+      if (peptide_[row] == peptide_[row - 1]) continue;
+      if (nr_peptides == batch_size)
+      {
+        batches.push_back(View(batch_begin, row));
+        batch_begin = row;
+        nr_peptides = 0;
+      }
+      ++nr_peptides;
+    }
+    batches.push_back(View(batch_begin, view.end));
+  }
+
+  void LightTransitionTable::toLightTargetedExperiment(const View& view, OpenSwath::LightTargetedExperiment& targeted_exp) const
+  {
+    targeted_exp = OpenSwath::LightTargetedExperiment();
+    targeted_exp.transitions.resize(view.size());
+    std::vector<UInt> peptides;
+    std::set<UInt> seen_peptides;
+    for (Size row = view.begin; row < view.end; ++row)
+    {
+      getTransition(row, targeted_exp.transitions[row - view.begin]);
+      if (seen_peptides.insert(peptide_[row]).second) peptides.push_back(peptide_[row]);
+    }
+
+    std::set<Size> proteins;
+    targeted_exp.peptides.resize(peptides.size());
+    for (Size i = 0; i < peptides.size(); ++i)
+    {
+      getPeptide(peptides[i], targeted_exp.peptides[i]);
+      for (UInt k = protein_ref_offsets_[peptides[i]]; k < protein_ref_offsets_[peptides[i] + 1]; ++k)
+      {
+        std::map<UInt, Size>::const_iterator prot_it = protein_index_.find(protein_refs_[k]);
+        if (prot_it != protein_index_.end()) proteins.insert(prot_it->second);
+      }
+    }
+
+    targeted_exp.proteins.resize(proteins.size());
+    Size i = 0;
+    for (std::set<Size>::const_iterator prot_it = proteins.begin(); prot_it != proteins.end(); ++prot_it, ++i)
+    {
+      getProtein(*prot_it, targeted_exp.proteins[i]);
+    }
+  }
+
+  void LightTransitionTable::store(const String& filename, const String& signature) const
+  {
+    // the cache may be memory-mapped (or read) by other processes, so don't
+    // overwrite it in place - write a temporary file and rename it:
+    const String tmp_filename = filename + ".tmp." + File::getUniqueName();
+    ofstream out(tmp_filename.c_str(), ios::out | ios::binary | ios::trunc);
+    if (!out)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename);
+    }
+    out.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    ColumnWriter writer(out);
+    std::vector<char> signature_column(signature.begin(), signature.end());
+    writer(signature_column);
+    visitColumns_(*this, writer);
+    out.close();
+    if (!out || !File::rename(tmp_filename, filename))
+    {
+      File::remove(tmp_filename);
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename);
+    }
+  }
+
+  bool LightTransitionTable::load(const String& filename, const String& signature)
+  {
+    clear();
+    QFile file(filename.toQString());
+    if (!file.exists())
+    {
+      return false;
+    }
+    if (!file.open(QIODevice::ReadOnly))
+    {
+      throw Exception::FileNotReadable(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename);
+    }
+    const UInt64 file_size = file.size();
+    const uchar* data = 0;
+    if (file_size >= sizeof(CACHE_MAGIC)) data = file.map(0, file_size);
+    if ((data == 0) || memcmp(data, CACHE_MAGIC, sizeof(CACHE_MAGIC)))
+    {
+      return false;
+    }
+
+    ColumnReader reader(data, file_size, sizeof(CACHE_MAGIC));
+    std::vector<char> signature_column;
+    reader(signature_column);
+    if (!reader.ok || (signature.compare(0, string::npos, signature_column.empty() ? "" : &signature_column[0], signature_column.size()) != 0))
+    {
+      return false; // incomplete file or different signature
+    }
+
+    visitColumns_(*this, reader);
+    if (!reader.ok || !isConsistent_())
+    {
+      clear();
+      return false;
+    }
+    updateProteinIndex_();
+    return true;
+  }
+
+  bool LightTransitionTable::isConsistent_() const
+  {
+    // string pool
+    if (string_offsets_.empty() || !validOffsets(string_offsets_, string_offsets_.size(), string_data_.size()))
+    {
+      return false;
+    }
+    const Size nr_strings = string_offsets_.size() - 1;
+
+    // transition columns
+    const Size n = size();
+    if ((product_mz_.size() != n) || (library_intensity_.size() != n) || (charge_.size() != n) ||
+        (transition_name_.size() != n) || (peptide_.size() != n) || (flags_.size() != n) ||
+        !validOffsets(site_transition_offsets_, n + 1, site_identifying_transition_.size()) ||
+        !validOffsets(site_class_offsets_, n + 1, site_identifying_class_.size()))
+    {
+      return false;
+    }
+
+    // peptide columns
+    const Size nr_peptides = getNrPeptides();
+    if ((peptide_rt_.size() != nr_peptides) || (peptide_charge_.size() != nr_peptides) ||
+        (peptide_sequence_.size() != nr_peptides) || (peptide_group_label_.size() != nr_peptides) ||
+        !validOffsets(protein_ref_offsets_, nr_peptides + 1, protein_refs_.size()) ||
+        !validOffsets(modification_offsets_, nr_peptides + 1, modification_location_.size()) ||
+        (modification_unimod_id_.size() != modification_location_.size()))
+    {
+      return false;
+    }
+
+    // protein columns
+    if (protein_sequence_.size() != protein_id_.size())
+    {
+      return false;
+    }
+
+    // indices into the string pool and the peptides
+    if (!validIndices(transition_name_, nr_strings) || !validIndices(site_identifying_class_, nr_strings) ||
+        !validIndices(peptide_id_, nr_strings) || !validIndices(peptide_sequence_, nr_strings) ||
+        !validIndices(peptide_group_label_, nr_strings) || !validIndices(protein_refs_, nr_strings) ||
+        !validIndices(modification_unimod_id_, nr_strings) || !validIndices(protein_id_, nr_strings) ||
+        !validIndices(protein_sequence_, nr_strings) || !validIndices(peptide_, nr_peptides))
+    {
+      return false;
+    }
+
+    // rows sorted by precursor m/z (required by selectSwath)
+    for (Size i = 1; i < n; ++i)
+    {
+      if (!(precursor_mz_[i - 1] <= precursor_mz_[i])) return false;
+    }
+    return true;
+  }
+}
@@ -34,6 +34,8 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/MRMAssay.h>
 
+#include <OpenMS/CONCEPT/ParallelExceptionCollector.h>
+
 namespace OpenMS
 {
   MRMAssay::MRMAssay()
@@ -44,17 +46,31 @@ namespace OpenMS
   {
   }
 
-  bool MRMAssay::isUIS_(const double fragment_ion, std::vector<double> ions, double mz_threshold)
+  namespace
   {
-    size_t number_uis = 0;
+    /// Orders ions by whether their upper tolerance bound lies below the queried fragment ion
+    struct UpperBoundBelow
+    {
+      explicit UpperBoundBelow(double mz_threshold) : mz_threshold_(mz_threshold) {}
+      bool operator()(double ion, double fragment_ion) const {return ion + mz_threshold_ < fragment_ion;}
+      double mz_threshold_;
+    };
 
-    for (std::vector<double>::iterator i_it = ions.begin(); i_it != ions.end(); ++i_it)
+    /// Orders ions by whether their lower tolerance bound lies above the queried fragment ion
+    struct LowerBoundAbove
     {
-      if (*i_it - mz_threshold <= fragment_ion && *i_it + mz_threshold >= fragment_ion)
-      {
-        number_uis++;
-      }
-    }
+      explicit LowerBoundAbove(double mz_threshold) : mz_threshold_(mz_threshold) {}
+      bool operator()(double fragment_ion, double ion) const {return ion - mz_threshold_ > fragment_ion;}
+      double mz_threshold_;
+    };
+  }
+
+  bool MRMAssay::isUIS_(const double fragment_ion, const std::vector<double>& ions, double mz_threshold)
+  {
+    // the ions are sorted, all interfering ions form a contiguous range
+    std::vector<double>::const_iterator first = std::lower_bound(ions.begin(), ions.end(), fragment_ion, UpperBoundBelow(mz_threshold));
+    std::vector<double>::const_iterator last = std::upper_bound(first, ions.end(), fragment_ion, LowerBoundAbove(mz_threshold));
+    size_t number_uis = last - first;
 
     if (number_uis <= 1)
     {
@@ -184,12 +200,25 @@ namespace OpenMS
     ModificationsDB* mod_db = ModificationsDB::getInstance();
     OpenMS::MRMIonSeries mrmis;
 
-    size_t j = 0;
+    // Generate the (alternatively localized) peptides once per peptide reference. This is done
+    // sequentially, as parsing the sequences may register new modified residues in the ResidueDB.
+    std::map<String, Size> peptide_index;
+    std::vector<Size> transition_peptide(exp.getTransitions().size());
+    std::vector<PeptideVectorType> alternative_peptides;
+    std::vector<double> precursor_mz;
     for (size_t i = 0; i < exp.getTransitions().size(); ++i)
     {
-      ReactionMonitoringTransition tr = exp.getTransitions()[i];
+      const String& peptide_ref = exp.getTransitions()[i].getPeptideRef();
+      std::map<String, Size>::const_iterator pep_it = peptide_index.find(peptide_ref);
+      if (pep_it != peptide_index.end())
+      {
+        transition_peptide[i] = pep_it->second;
+        continue;
+      }
+      transition_peptide[i] = alternative_peptides.size();
+      peptide_index[peptide_ref] = alternative_peptides.size();
 
-      TargetedExperiment::Peptide target_peptide = exp.getPeptideByRef(tr.getPeptideRef());
+      TargetedExperiment::Peptide target_peptide = exp.getPeptideByRef(peptide_ref);
       OpenMS::AASequence target_peptide_sequence = TargetedExperimentHelper::getAASequence(target_peptide);
 
       std::vector<OpenMS::AASequence> alternative_peptide_sequences;
@@ -203,6 +232,7 @@ namespace OpenMS
         alternative_peptide_sequences.push_back(target_peptide_sequence);
       }
 
+      alternative_peptides.push_back(PeptideVectorType());
       for (std::vector<OpenMS::AASequence>::iterator aa_it = alternative_peptide_sequences.begin(); aa_it != alternative_peptide_sequences.end(); ++aa_it)
       {
         std::vector<TargetedExperiment::Peptide::Modification> mods;
@@ -232,27 +262,76 @@ namespace OpenMS
         target_peptide.mods = mods;
         target_peptide.setMetaValue("full_peptide_name", aa_it->toString());
         target_peptide.id = String(target_peptide.protein_refs[0]) + String("_") + TargetedExperimentHelper::getAASequence(target_peptide).toString() + String("_") + String(target_peptide.getChargeState()) + "_" + target_peptide.rts[0].getCVTerms()["MS:1000896"][0].getValue().toString();
+        alternative_peptides.back().push_back(target_peptide);
+      }
+      precursor_mz.push_back(Math::roundDecimal(target_peptide_sequence.getMonoWeight(Residue::Full, target_peptide.getChargeState()) / target_peptide.getChargeState(), round_decPow));
+    }
 
-        mrmis.annotateTransition(tr, target_peptide, mz_threshold, enable_reannotation, fragment_types, fragment_charges, enable_losses);
+    // Annotate the transitions in parallel, for every transition the annotated
+    // candidates are stored together with the index of their alternative peptide
+    std::vector<std::vector<std::pair<Size, ReactionMonitoringTransition> > > annotated(exp.getTransitions().size());
+    ParallelExceptionCollector errors;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)exp.getTransitions().size(); ++i)
+    {
+      if (errors.hasErrorBefore(i)) continue;
+      try // exceptions must not leave the parallel region
+      {
+        ReactionMonitoringTransition tr = exp.getTransitions()[i];
+        const PeptideVectorType& candidates = alternative_peptides[transition_peptide[i]];
 
-        if (tr.getProduct().getInterpretationList()[0].hasCVTerm("MS:1001240"))
+        for (Size k = 0; k < candidates.size(); ++k)
         {
-          LOG_DEBUG << "[unannotated] Skipping " << aa_it->toString() << " PrecursorMZ: " << tr.getPrecursorMZ() << " ProductMZ: " << tr.getProductMZ() << " " << tr.getMetaValue("annotation") << std::endl;
-          continue;
+          const TargetedExperiment::Peptide& target_peptide = candidates[k];
+          mrmis.annotateTransition(tr, target_peptide, mz_threshold, enable_reannotation, fragment_types, fragment_charges, enable_losses);
+
+          if (tr.getProduct().getInterpretationList()[0].hasCVTerm("MS:1001240"))
+          {
+            LOG_DEBUG << "[unannotated] Skipping " << target_peptide.getMetaValue("full_peptide_name") << " PrecursorMZ: " << tr.getPrecursorMZ() << " ProductMZ: " << tr.getProductMZ() << " " << tr.getMetaValue("annotation") << std::endl;
+            continue;
+          }
+          else
+          {
+            LOG_DEBUG << "[selected] " << target_peptide.getMetaValue("full_peptide_name") << " PrecursorMZ: " << tr.getPrecursorMZ() << " ProductMZ: " << tr.getProductMZ() << " " << tr.getMetaValue("annotation") << std::endl;
+          }
+
+          tr.setPeptideRef(target_peptide.id);
+          tr.setPrecursorMZ(precursor_mz[transition_peptide[i]]);
+          annotated[i].push_back(std::make_pair(k, tr));
         }
-        else
+      }
+      catch (...)
+      {
+        errors.capture(i);
+      }
+    }
+    errors.rethrow();
+
+    // Collect the annotated transitions and their peptides in input order
+    std::map<String, std::vector<Size> > peptides_by_id;
+    size_t j = 0;
+    for (size_t i = 0; i < annotated.size(); ++i)
+    {
+      for (Size l = 0; l < annotated[i].size(); ++l)
+      {
+        ReactionMonitoringTransition& tr = annotated[i][l].second;
+        const TargetedExperiment::Peptide& target_peptide = alternative_peptides[transition_peptide[i]][annotated[i][l].first];
+
+        std::vector<Size>& same_id = peptides_by_id[target_peptide.id];
+        bool found = false;
+        for (Size m = 0; m < same_id.size() && !found; ++m)
         {
-          LOG_DEBUG << "[selected] " << aa_it->toString() << " PrecursorMZ: " << tr.getPrecursorMZ() << " ProductMZ: " << tr.getProductMZ() << " " << tr.getMetaValue("annotation") << std::endl;
+          found = (peptides[same_id[m]] == target_peptide);
         }
-
-        if (std::find(peptides.begin(), peptides.end(), target_peptide) == peptides.end())
+        if (!found)
         {
+          same_id.push_back(peptides.size());
           peptides.push_back(target_peptide);
-          LOG_DEBUG << "[selected] " <<  aa_it->toString() << std::endl;
+          LOG_DEBUG << "[selected] " <<  target_peptide.getMetaValue("full_peptide_name") << std::endl;
         }
 
-        tr.setPeptideRef(target_peptide.id);
-        tr.setPrecursorMZ(Math::roundDecimal(target_peptide_sequence.getMonoWeight(Residue::Full, target_peptide.getChargeState()) / target_peptide.getChargeState(), round_decPow));
         tr.setNativeID(String(j) + String("_") +  String(target_peptide.protein_refs[0]) + String("_") + target_peptide.sequence + String("_") + String(tr.getPrecursorMZ()) + "_" + String(tr.getProductMZ()));
 
         j += 1;
@@ -414,83 +493,139 @@ namespace OpenMS
     Map<size_t, std::vector<double> > IonMap;
     Map<String, MRMIonSeries::IonSeries> DecoyIonSeriesMap;
 
-    for (size_t i = 0; i < exp.getPeptides().size(); ++i)
+    // Parse the peptide sequences sequentially (this may register modified residues),
+    // then compute the ion series of all peptides and their reversed decoys in parallel
+    const PeptideVectorType& exp_peptides = exp.getPeptides();
+    std::vector<OpenMS::AASequence> peptide_sequences, decoy_sequences;
+    for (size_t i = 0; i < exp_peptides.size(); ++i)
     {
-      TargetedExperiment::Peptide peptide = exp.getPeptides()[i];
-      OpenMS::AASequence peptide_sequence = TargetedExperimentHelper::getAASequence(peptide);
-      int precursor_swath = getSwath_(swathes, peptide_sequence.getMonoWeight(Residue::Full, peptide.getChargeState()) / peptide.getChargeState());
+      peptide_sequences.push_back(TargetedExperimentHelper::getAASequence(exp_peptides[i]));
+      decoy_sequences.push_back(TargetedExperimentHelper::getAASequence(mrmdg.reversePeptide(exp_peptides[i])));
+    }
 
-      if (IonMap.find(precursor_swath) == IonMap.end())
+    std::vector<std::vector<double> > peptide_ions(exp_peptides.size());
+    std::vector<MRMIonSeries::IonSeries> decoy_ionseries(exp_peptides.size());
+    ParallelExceptionCollector ion_errors;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)exp_peptides.size(); ++i)
+    {
+      if (ion_errors.hasErrorBefore(i)) continue;
+      try // exceptions must not leave the parallel region
+      {
+        MRMIonSeries::IonSeries ionseries = mrmis.getIonSeries(peptide_sequences[i], exp_peptides[i].getChargeState(), fragment_types, fragment_charges, enable_losses);
+        std::transform(ionseries.begin(), ionseries.end(), std::back_inserter(peptide_ions[i]), boost::bind(&MRMIonSeries::IonSeries::value_type::second, _1));
+        decoy_ionseries[i] = mrmis.getIonSeries(decoy_sequences[i], exp_peptides[i].getChargeState(), fragment_types, fragment_charges, enable_losses);
+      }
+      catch (...)
       {
-        IonMap[precursor_swath];
+        ion_errors.capture(i);
       }
+    }
+    ion_errors.rethrow();
 
-      MRMIonSeries::IonSeries ionseries = mrmis.getIonSeries(peptide_sequence, peptide.getChargeState(), fragment_types, fragment_charges, enable_losses);
-      std::vector<double> ions;
-      std::transform(ionseries.begin(), ionseries.end(), std::back_inserter(ions), boost::bind(&MRMIonSeries::IonSeries::value_type::second, _1));
+    for (size_t i = 0; i < exp_peptides.size(); ++i)
+    {
+      const TargetedExperiment::Peptide& peptide = exp_peptides[i];
+      int precursor_swath = getSwath_(swathes, peptide_sequences[i].getMonoWeight(Residue::Full, peptide.getChargeState()) / peptide.getChargeState());
 
-      IonMap[precursor_swath].insert(IonMap[precursor_swath].end(), ions.begin(), ions.end());
+      std::vector<double>& swath_ions = IonMap[precursor_swath];
+      swath_ions.insert(swath_ions.end(), peptide_ions[i].begin(), peptide_ions[i].end());
 
-      DecoyIonSeriesMap[peptide_sequence.toString() + peptide.getChargeState()] = mrmis.getIonSeries(TargetedExperimentHelper::getAASequence(mrmdg.reversePeptide(peptide)), peptide.getChargeState(), fragment_types, fragment_charges, enable_losses);
+      DecoyIonSeriesMap[peptide_sequences[i].toString() + peptide.getChargeState()].swap(decoy_ionseries[i]);
     }
+    peptide_ions.clear();
+    decoy_ionseries.clear();
 
-    for (Size i = 0; i < exp.getTransitions().size(); ++i)
+    // isUIS_ searches the ions of a swath by binary search
+    for (Map<size_t, std::vector<double> >::iterator swath_it = IonMap.begin(); swath_it != IonMap.end(); ++swath_it)
     {
-      ReactionMonitoringTransition tr = exp.getTransitions()[i];
+      std::sort(swath_it->second.begin(), swath_it->second.end());
+    }
 
-      const TargetedExperiment::Peptide target_peptide = exp.getPeptideByRef(tr.getPeptideRef());
-      OpenMS::AASequence target_peptide_sequence = TargetedExperimentHelper::getAASequence(target_peptide);
-      int target_precursor_swath = getSwath_(swathes, target_peptide_sequence.getMonoWeight(Residue::Full, target_peptide.getChargeState()) / target_peptide.getChargeState());
+    // Look up the peptides of the transitions (getPeptideByRef is not thread-safe)
+    std::vector<const TargetedExperiment::Peptide*> transition_peptides;
+    for (Size i = 0; i < exp.getTransitions().size(); ++i)
+    {
+      transition_peptides.push_back(&exp.getPeptideByRef(exp.getTransitions()[i].getPeptideRef()));
+    }
 
-      if (tr.getProduct().getInterpretationList()[0].hasCVTerm("MS:1001240"))
+    // Score the transitions in parallel, the results are collected in input order
+    std::vector<MRMDecoy::TransitionVectorType> scored_transitions(exp.getTransitions().size());
+    ParallelExceptionCollector errors;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)exp.getTransitions().size(); ++i)
+    {
+      if (errors.hasErrorBefore(i)) continue;
+      try // exceptions must not leave the parallel region
       {
-        LOG_DEBUG << "[unannotated] Skipping " << target_peptide_sequence << " PrecursorMZ: " << tr.getPrecursorMZ() << " ProductMZ: " << tr.getProductMZ() << " " << tr.getMetaValue("annotation") << std::endl;
-        continue;
-      }
-      OpenMS::AASequence target_peptide_sequence_unmod = AASequence::fromString(TargetedExperimentHelper::getAASequence(target_peptide).toUnmodifiedString());
+        ReactionMonitoringTransition tr = exp.getTransitions()[i];
 
-      if (!enable_uis_scoring)
-      {
-        tr.setMetaValue("identifying_transition", "false");
-      }
-      else if (isUIS_(tr.getProductMZ(), IonMap[target_precursor_swath], mz_threshold))
-      {
-        tr.setMetaValue("identifying_transition", "true");
-      }
-      else if (!isUIS_(tr.getProductMZ(), IonMap[target_precursor_swath], mz_threshold))
-      {
-        tr.setMetaValue("identifying_transition", "false");
-      }
+        const TargetedExperiment::Peptide& target_peptide = *transition_peptides[i];
+        OpenMS::AASequence target_peptide_sequence = TargetedExperimentHelper::getAASequence(target_peptide);
+        int target_precursor_swath = getSwath_(swathes, target_peptide_sequence.getMonoWeight(Residue::Full, target_peptide.getChargeState()) / target_peptide.getChargeState());
 
-      if (enable_site_scoring)
-      {
-        isSiteUIS_(target_peptide_sequence, tr);
-      }
-      else
-      {
-        tr.setMetaValue("site_identifying_transition", "");
-        tr.setMetaValue("site_identifying_class", "");
-      }
+        if (tr.getProduct().getInterpretationList()[0].hasCVTerm("MS:1001240"))
+        {
+          LOG_DEBUG << "[unannotated] Skipping " << target_peptide_sequence << " PrecursorMZ: " << tr.getPrecursorMZ() << " ProductMZ: " << tr.getProductMZ() << " " << tr.getMetaValue("annotation") << std::endl;
+          continue;
+        }
 
-      if (tr.getMetaValue("detecting_transition").toBool() || tr.getMetaValue("identifying_transition").toBool() || tr.getMetaValue("site_identifying_transition").toString() != "")
-      {
-        transitions.push_back(tr);
-      }
+        if (!enable_uis_scoring)
+        {
+          tr.setMetaValue("identifying_transition", "false");
+        }
+        else
+        {
+          Map<size_t, std::vector<double> >::const_iterator swath_ions = IonMap.find(target_precursor_swath);
+          bool is_uis = (swath_ions == IonMap.end()) || isUIS_(tr.getProductMZ(), swath_ions->second, mz_threshold);
+          tr.setMetaValue("identifying_transition", is_uis ? "true" : "false");
+        }
 
-      if (tr.getMetaValue("identifying_transition").toBool() || tr.getMetaValue("site_identifying_transition").toString() != "")
-      {
-        ReactionMonitoringTransition uisdecoy_tr = tr;
-        uisdecoy_tr.setMetaValue("detecting_transition", "false");
-        uisdecoy_tr.setName("UISDECOY_" + uisdecoy_tr.getName());
+        if (enable_site_scoring)
+        {
+          isSiteUIS_(target_peptide_sequence, tr);
+        }
+        else
+        {
+          tr.setMetaValue("site_identifying_transition", "");
+          tr.setMetaValue("site_identifying_class", "");
+        }
+
+        if (tr.getMetaValue("detecting_transition").toBool() || tr.getMetaValue("identifying_transition").toBool() || tr.getMetaValue("site_identifying_transition").toString() != "")
+        {
+          scored_transitions[i].push_back(tr);
+        }
+
+        if (tr.getMetaValue("identifying_transition").toBool() || tr.getMetaValue("site_identifying_transition").toString() != "")
+        {
+          ReactionMonitoringTransition uisdecoy_tr = tr;
+          uisdecoy_tr.setMetaValue("detecting_transition", "false");
+          uisdecoy_tr.setName("UISDECOY_" + uisdecoy_tr.getName());
 
-        std::pair<String, double> uisdecoy_ion = mrmis.getIon(DecoyIonSeriesMap[target_peptide_sequence.toString() + target_peptide.getChargeState()], tr.getMetaValue("annotation"));
+          Map<String, MRMIonSeries::IonSeries>::const_iterator decoy_it = DecoyIonSeriesMap.find(target_peptide_sequence.toString() + target_peptide.getChargeState());
+          std::pair<String, double> uisdecoy_ion = mrmis.getIon(decoy_it != DecoyIonSeriesMap.end() ? decoy_it->second : MRMIonSeries::IonSeries(), tr.getMetaValue("annotation"));
 
-        uisdecoy_tr.setProductMZ(uisdecoy_ion.second);
-        uisdecoy_tr.setDecoyTransitionType(ReactionMonitoringTransition::DECOY);
+          uisdecoy_tr.setProductMZ(uisdecoy_ion.second);
+          uisdecoy_tr.setDecoyTransitionType(ReactionMonitoringTransition::DECOY);
 
-        transitions.push_back(uisdecoy_tr);
+          scored_transitions[i].push_back(uisdecoy_tr);
+        }
+      }
+      catch (...)
+      {
+        errors.capture(i);
       }
     }
+    errors.rethrow();
+
+    for (Size i = 0; i < scored_transitions.size(); ++i)
+    {
+      transitions.insert(transitions.end(), scored_transitions[i].begin(), scored_transitions[i].end());
+    }
 
     exp.setTransitions(transitions);
   }
@@ -34,6 +34,7 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/MRMDecoy.h>
 #include <OpenMS/CHEMISTRY/ModificationsDB.h>
+#include <OpenMS/CONCEPT/ParallelExceptionCollector.h>
 
 #include <map>
 #include <utility> //for pair
@@ -43,6 +44,26 @@
 
 namespace OpenMS
 {
+  namespace
+  {
+    /// Seed for shuffling a peptide, computed from its id (FNV-1a hash) so decoys are reproducible
+    int getShuffleSeed(const String& peptide_id)
+    {
+      UInt hash = 2166136261u;
+      for (String::const_iterator it = peptide_id.begin(); it != peptide_id.end(); ++it)
+      {
+        hash ^= (unsigned char)*it;
+        hash *= 16777619u;
+      }
+      return (int)(hash & 0x7fffffff);
+    }
+  }
+
+  bool MRMDecoy::FragmentIon::operator<(const FragmentIon& rhs) const
+  {
+    return mz < rhs.mz;
+  }
+
   std::pair<String, double> MRMDecoy::getDecoyIon(String ionid, boost::unordered_map<String, boost::unordered_map<String, double> >& decoy_ionseries)
   {
     using namespace boost::assign;
@@ -50,24 +71,25 @@ namespace OpenMS
     std::vector<String> SpectraST_order;
     SpectraST_order += "b", "y", "b_loss", "y_loss";
 
-    // Iterate over ion type and then ordinal
+    // Iterate over ion type and look up the ordinal
     std::pair<String, double> ion;
     String unannotated = "unannotated";
     ion = make_pair(unannotated, -1);
     for (std::vector<String>::iterator iontype = SpectraST_order.begin(); iontype != SpectraST_order.end(); ++iontype)
     {
-      for (boost::unordered_map<String, double>::iterator ordinal = decoy_ionseries[*iontype].begin(); ordinal != decoy_ionseries[*iontype].end(); ++ordinal)
+      IonSeries::const_iterator series = decoy_ionseries.find(*iontype);
+      if (series == decoy_ionseries.end()) continue;
+
+      boost::unordered_map<String, double>::const_iterator ordinal = series->second.find(ionid);
+      if (ordinal != series->second.end())
       {
-        if (ordinal->first == ionid)
-        {
-          ion = make_pair(ordinal->first, ordinal->second);
-        }
+        ion = make_pair(ordinal->first, ordinal->second);
       }
     }
     return ion;
   }
 
-  std::pair<String, double> MRMDecoy::getTargetIon(double ProductMZ, double mz_threshold, boost::unordered_map<String, boost::unordered_map<String, double> > target_ionseries, bool enable_losses)
+  std::pair<String, double> MRMDecoy::getTargetIon(double ProductMZ, double mz_threshold, const boost::unordered_map<String, boost::unordered_map<String, double> >& target_ionseries, bool enable_losses)
   {
     // make sure to only use annotated transitions and to use the theoretical MZ
     using namespace boost::assign;
@@ -87,7 +109,10 @@ namespace OpenMS
     double closest_delta = std::numeric_limits<double>::max();
     for (std::vector<String>::iterator iontype = SpectraST_order.begin(); iontype != SpectraST_order.end(); ++iontype)
     {
-      for (boost::unordered_map<String, double>::iterator ordinal = target_ionseries[*iontype].begin(); ordinal != target_ionseries[*iontype].end(); ++ordinal)
+      IonSeries::const_iterator series = target_ionseries.find(*iontype);
+      if (series == target_ionseries.end()) continue;
+
+      for (boost::unordered_map<String, double>::const_iterator ordinal = series->second.begin(); ordinal != series->second.end(); ++ordinal)
       {
         if (std::fabs(ordinal->second - ProductMZ) <= mz_threshold && std::fabs(ordinal->second - ProductMZ) <= closest_delta)
         {
@@ -99,6 +124,64 @@ namespace OpenMS
     return ion;
   }
 
+  std::pair<String, double> MRMDecoy::getTargetIon(double ProductMZ, double mz_threshold, const FragmentIndex& target_index)
+  {
+    std::pair<String, double> ion = make_pair(String("unannotated"), -1);
+    double closest_delta = std::numeric_limits<double>::max();
+    Size closest_series = 0;
+
+    // first candidate: the lower bound of ProductMZ - mz_threshold (moved back
+    // over ions that are still within the threshold due to rounding)
+    FragmentIon query;
+    query.mz = ProductMZ - mz_threshold;
+    FragmentIndex::const_iterator it = std::lower_bound(target_index.begin(), target_index.end(), query);
+    while (it != target_index.begin() && std::fabs((it - 1)->mz - ProductMZ) <= mz_threshold)
+    {
+      --it;
+    }
+
+    for (; it != target_index.end(); ++it)
+    {
+      double delta = std::fabs(it->mz - ProductMZ);
+      if (delta > mz_threshold)
+      {
+        if (it->mz > ProductMZ) break;
+        continue;
+      }
+      // same preference as the sequential search: on ties, the later ion type wins
+      if (delta < closest_delta || (delta == closest_delta && it->series >= closest_series))
+      {
+        closest_delta = delta;
+        closest_series = it->series;
+        ion = make_pair(it->annotation, it->mz);
+      }
+    }
+    return ion;
+  }
+
+  void MRMDecoy::getFragmentIndex(const IonSeries& ionseries, bool enable_losses, FragmentIndex& index)
+  {
+    const char* SpectraST_order[] = {"b", "y", "b_loss", "y_loss"};
+    Size nr_series = enable_losses ? 4 : 2;
+
+    index.clear();
+    for (Size i = 0; i < nr_series; ++i)
+    {
+      IonSeries::const_iterator series = ionseries.find(SpectraST_order[i]);
+      if (series == ionseries.end()) continue;
+
+      for (boost::unordered_map<String, double>::const_iterator ordinal = series->second.begin(); ordinal != series->second.end(); ++ordinal)
+      {
+        FragmentIon fragment;
+        fragment.mz = ordinal->second;
+        fragment.series = i;
+        fragment.annotation = ordinal->first;
+        index.push_back(fragment);
+      }
+    }
+    std::sort(index.begin(), index.end());
+  }
+
   boost::unordered_map<String, boost::unordered_map<String, double> > MRMDecoy::getIonSeries(AASequence sequence, int precursor_charge)
   {
     boost::unordered_map<String, boost::unordered_map<String, double> > ionseries;
@@ -127,6 +210,12 @@ namespace OpenMS
     static const EmpiricalFormula neutralloss_co2("CO2"); // -44 CO2 loss
     static const EmpiricalFormula neutralloss_hccoh("HCOOH"); // -46 HCOOH loss
 
+    // residue specific losses depend on the full sequence only (see below)
+    const String sequence_string = sequence.toString();
+    const bool has_nq = sequence_string.find("N") != std::string::npos || sequence_string.find("Q") != std::string::npos;
+    const bool has_ox = sequence_string.find("M(Oxidation)") != std::string::npos;
+    const bool has_phospho = sequence_string.find("S(Phospho)") != std::string::npos || sequence_string.find("T(Phospho)") != std::string::npos;
+
     for (int charge = 1; charge <= precursor_charge; ++charge)
     {
       for (Size i = 1; i < sequence.size(); ++i)
@@ -142,19 +231,19 @@ namespace OpenMS
         bionseries_loss["b" + String(i) + "-36" + "^" + String(charge)] = pos - neutralloss_h2oh2o.getMonoWeight()/charge;
         bionseries_loss["b" + String(i) + "-44" + "^" + String(charge)] = pos - neutralloss_co2.getMonoWeight()/charge;
         bionseries_loss["b" + String(i) + "-46" + "^" + String(charge)] = pos - neutralloss_hccoh.getMonoWeight()/charge;
-        if (sequence.toString().find("N")!=std::string::npos || sequence.toString().find("Q")!=std::string::npos)
+        if (has_nq)
         // This hack is implemented to enable the annotation of residue specific modifications in the decoy fragments.
         // If the function is used for generic annotation, use ion.toString() instead of sequence.toString().
         {
           bionseries_loss["b" + String(i) + "-45" + "^" + String(charge)] = pos - neutralloss_ch3no.getMonoWeight()/charge;
         }
-        if (sequence.toString().find("M(Oxidation)")!=std::string::npos)
+        if (has_ox)
         // This hack is implemented to enable the annotation of residue specific modifications in the decoy fragments.
         // If the function is used for generic annotation, use ion.toString() instead of sequence.toString().
         {
           bionseries_loss["b" + String(i) + "-64" + "^" + String(charge)] = pos - neutralloss_ch4so.getMonoWeight()/charge;
         }
-        if (sequence.toString().find("S(Phospho)")!=std::string::npos || sequence.toString().find("T(Phospho)")!=std::string::npos)
+        if (has_phospho)
         // This hack is implemented to enable the annotation of residue specific modifications in the decoy fragments.
         // If the function is used for generic annotation, use ion.toString() instead of sequence.toString().
         {
@@ -181,19 +270,19 @@ namespace OpenMS
         yionseries_loss["y" + String(i) + "-36" + "^" + String(charge)] = pos - neutralloss_h2oh2o.getMonoWeight()/charge;
         yionseries_loss["y" + String(i) + "-44" + "^" + String(charge)] = pos - neutralloss_co2.getMonoWeight()/charge;
         yionseries_loss["y" + String(i) + "-46" + "^" + String(charge)] = pos - neutralloss_hccoh.getMonoWeight()/charge;
-        if (sequence.toString().find("N")!=std::string::npos || sequence.toString().find("Q")!=std::string::npos)
+        if (has_nq)
         // This hack is implemented to enable the annotation of residue specific modifications in the decoy fragments.
         // If the function is used for generic annotation, use ion.toString() instead of sequence.toString().
         {
           yionseries_loss["y" + String(i) + "-45" + "^" + String(charge)] = pos - neutralloss_ch3no.getMonoWeight()/charge;
         }
-        if (sequence.toString().find("M(Oxidation)")!=std::string::npos)
+        if (has_ox)
         // This hack is implemented to enable the annotation of residue specific modifications in the decoy fragments.
         // If the function is used for generic annotation, use ion.toString() instead of sequence.toString().
         {
           yionseries_loss["y" + String(i) + "-64" + "^" + String(charge)] = pos - neutralloss_ch4so.getMonoWeight()/charge;
         }
-        if (sequence.toString().find("S(Phospho)")!=std::string::npos || sequence.toString().find("T(Phospho)")!=std::string::npos)
+        if (has_phospho)
         // This hack is implemented to enable the annotation of residue specific modifications in the decoy fragments.
         // If the function is used for generic annotation, use ion.toString() instead of sequence.toString().
         {
@@ -536,51 +625,82 @@ namespace OpenMS
     std::vector<String> exclusion_peptides;
     // Go through all peptides and apply the decoy method to the sequence
     // (pseudo-reverse, reverse or shuffle). Then set the peptides and proteins of the decoy
-    // experiment.
-    for (Size i = 0; i < exp.getPeptides().size(); i++)
+    // experiment. Peptides are processed in parallel, the results are collected in input order.
+    const std::vector<OpenMS::TargetedExperiment::Peptide>& target_peptides = exp.getPeptides();
+    std::vector<OpenMS::TargetedExperiment::Peptide> decoy_peptides(target_peptides.size());
+    std::vector<char> skip_peptide(target_peptides.size(), 0), similar_peptide(target_peptides.size(), 0);
+    ParallelExceptionCollector errors;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)target_peptides.size(); i++)
     {
-      OpenMS::TargetedExperiment::Peptide peptide = exp.getPeptides()[i];
-      // continue if the peptide has C/N terminal modifications and we should exclude them
-      if (remove_CNterminal_mods && MRMDecoy::has_CNterminal_mods(peptide)) {continue;}
-      peptide.id = decoy_tag + peptide.id;
-      OpenMS::String original_sequence = peptide.sequence;
-      if (!peptide.getPeptideGroupLabel().empty()) 
+      if (errors.hasErrorBefore(i)) continue;
+      try // exceptions must not leave the parallel region
       {
-          peptide.setPeptideGroupLabel(decoy_tag + peptide.getPeptideGroupLabel());
-      }
+        OpenMS::TargetedExperiment::Peptide peptide = target_peptides[i];
+        // continue if the peptide has C/N terminal modifications and we should exclude them
+        if (remove_CNterminal_mods && MRMDecoy::has_CNterminal_mods(peptide))
+        {
+          skip_peptide[i] = 1;
+          continue;
+        }
+        peptide.id = decoy_tag + peptide.id;
+        if (!peptide.getPeptideGroupLabel().empty()) 
+        {
+            peptide.setPeptideGroupLabel(decoy_tag + peptide.getPeptideGroupLabel());
+        }
 
-      if (method == "pseudo-reverse")
-      {
-        peptide = MRMDecoy::pseudoreversePeptide(peptide);
-      }
-      else if (method == "reverse")
-      {
-        peptide = MRMDecoy::reversePeptide(peptide);
-      }
-      else if (method == "shuffle")
-      {
-        peptide = MRMDecoy::shufflePeptide(peptide, identity_threshold, -1, max_attempts);
+        if (method == "pseudo-reverse")
+        {
+          peptide = MRMDecoy::pseudoreversePeptide(peptide);
+        }
+        else if (method == "reverse")
+        {
+          peptide = MRMDecoy::reversePeptide(peptide);
+        }
+        else if (method == "shuffle")
+        {
+          peptide = MRMDecoy::shufflePeptide(peptide, identity_threshold, getShuffleSeed(target_peptides[i].id), max_attempts);
+        }
+        for (Size j = 0; j < peptide.protein_refs.size(); j++)
+        {
+          peptide.protein_refs[j] = decoy_tag + peptide.protein_refs[j];
+        }
+
+        if (MRMDecoy::AASequenceIdentity(target_peptides[i].sequence, peptide.sequence) > identity_threshold)
+        {
+          similar_peptide[i] = 1;
+        }
+        decoy_peptides[i] = peptide;
       }
-      for (Size i = 0; i < peptide.protein_refs.size(); i++)
+      catch (...)
       {
-        peptide.protein_refs[i] = decoy_tag + peptide.protein_refs[i];
+        errors.capture(i);
       }
+    }
+    errors.rethrow();
+
+    for (Size i = 0; i < target_peptides.size(); i++)
+    {
+      if (skip_peptide[i]) continue;
 
-      if (MRMDecoy::AASequenceIdentity(original_sequence, peptide.sequence) > identity_threshold)
+      if (similar_peptide[i])
       {
         if (!exclude_similar)
         {
-          std::cout << "Target sequence: " << original_sequence << " Decoy sequence: " << peptide.sequence  << " Sequence identity: " << MRMDecoy::AASequenceIdentity(original_sequence, peptide.sequence) << " Identity threshold: " << identity_threshold << std::endl;
+          std::cout << "Target sequence: " << target_peptides[i].sequence << " Decoy sequence: " << decoy_peptides[i].sequence  << " Sequence identity: " << MRMDecoy::AASequenceIdentity(target_peptides[i].sequence, decoy_peptides[i].sequence) << " Identity threshold: " << identity_threshold << std::endl;
           throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__, "AA Sequences are too similar. Either decrease identity_threshold and increase max_attempts for the shuffle method or set flag exclude_similar.");
         }
         else
         {
-          exclusion_peptides.push_back(peptide.id);
+          exclusion_peptides.push_back(decoy_peptides[i].id);
         }
       }
 
-      peptides.push_back(peptide);
+      peptides.push_back(decoy_peptides[i]);
     }
+    decoy_peptides.clear();
     dec.setPeptides(peptides);
     dec.setProteins(proteins);
 
@@ -591,79 +711,124 @@ namespace OpenMS
       peptide_trans_map[exp.getTransitions()[i].getPeptideRef()].push_back(&exp.getTransitions()[i]);
     }
 
-    Size progress = 0;
-    startProgress(0, exp.getTransitions().size(), "Creating decoys");
-    for (MRMDecoy::PeptideTransitionMapType::iterator pep_it = peptide_trans_map.begin();
+    // Look up the peptides and parse their sequences before going parallel
+    // (getPeptideByRef and the first use of a modified residue are not thread-safe)
+    std::vector<MRMDecoy::PeptideTransitionMapType::const_iterator> peptide_entries;
+    std::vector<const TargetedExperiment::Peptide*> target_peptide_ptrs, decoy_peptide_ptrs;
+    std::vector<OpenMS::AASequence> target_sequences, decoy_sequences;
+    for (MRMDecoy::PeptideTransitionMapType::const_iterator pep_it = peptide_trans_map.begin();
          pep_it != peptide_trans_map.end(); ++pep_it)
     {
-      String peptide_ref = pep_it->first;
-      String decoy_peptide_ref = decoy_tag + pep_it->first; // see above, the decoy peptide id is computed deterministically from the target id
-      const TargetedExperiment::Peptide target_peptide = exp.getPeptideByRef(peptide_ref);
+      const TargetedExperiment::Peptide& target_peptide = exp.getPeptideByRef(pep_it->first);
       // continue if the peptide has C/N terminal modifications and we should exclude them
       if (remove_CNterminal_mods && MRMDecoy::has_CNterminal_mods(target_peptide)) {continue;}
 
-      const TargetedExperiment::Peptide decoy_peptide = dec.getPeptideByRef(decoy_peptide_ref);
-      OpenMS::AASequence target_peptide_sequence = TargetedExperimentHelper::getAASequence(target_peptide);
-      OpenMS::AASequence decoy_peptide_sequence = TargetedExperimentHelper::getAASequence(decoy_peptide);
-      MRMDecoy::IonSeries decoy_ionseries = getIonSeries(decoy_peptide_sequence, decoy_peptide.getChargeState());
-      MRMDecoy::IonSeries target_ionseries = getIonSeries(target_peptide_sequence, target_peptide.getChargeState());
+      // see above, the decoy peptide id is computed deterministically from the target id
+      const TargetedExperiment::Peptide& decoy_peptide = dec.getPeptideByRef(decoy_tag + pep_it->first);
+      peptide_entries.push_back(pep_it);
+      target_peptide_ptrs.push_back(&target_peptide);
+      decoy_peptide_ptrs.push_back(&decoy_peptide);
+      target_sequences.push_back(TargetedExperimentHelper::getAASequence(target_peptide));
+      decoy_sequences.push_back(TargetedExperimentHelper::getAASequence(decoy_peptide));
+    }
 
-      for (Size i = 0; i < pep_it->second.size(); i++)
+    std::vector<MRMDecoy::TransitionVectorType> peptide_decoy_transitions(peptide_entries.size());
+    std::vector<std::vector<String> > peptide_exclusions(peptide_entries.size());
+    Size progress = 0;
+    startProgress(0, exp.getTransitions().size(), "Creating decoys");
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+    for (SignedSize k = 0; k < (SignedSize)peptide_entries.size(); ++k)
+    {
+      if (errors.hasErrorBefore(k)) continue;
+      const std::vector<const ReactionMonitoringTransition*>& peptide_transitions = peptide_entries[k]->second;
+      const TargetedExperiment::Peptide& target_peptide = *target_peptide_ptrs[k];
+      const TargetedExperiment::Peptide& decoy_peptide = *decoy_peptide_ptrs[k];
+      try // exceptions must not leave the parallel region
       {
-        setProgress(++progress);
-        const ReactionMonitoringTransition tr = *(pep_it->second[i]);
+        MRMDecoy::IonSeries decoy_ionseries = getIonSeries(decoy_sequences[k], decoy_peptide.getChargeState());
+        MRMDecoy::IonSeries target_ionseries = getIonSeries(target_sequences[k], target_peptide.getChargeState());
+        MRMDecoy::FragmentIndex target_index;
+        getFragmentIndex(target_ionseries, enable_losses, target_index);
 
-        if (tr.getDecoyTransitionType() == ReactionMonitoringTransition::DECOY)
+        for (Size i = 0; i < peptide_transitions.size(); i++)
         {
-          continue;
-        }
+          const ReactionMonitoringTransition& tr = *(peptide_transitions[i]);
 
-        ReactionMonitoringTransition decoy_tr = tr; // copy the target transition
+          if (tr.getDecoyTransitionType() == ReactionMonitoringTransition::DECOY)
+          {
+            continue;
+          }
 
-        decoy_tr.setNativeID(decoy_tag + tr.getNativeID());
-        decoy_tr.setDecoyTransitionType(ReactionMonitoringTransition::DECOY);
-        decoy_tr.setPrecursorMZ(tr.getPrecursorMZ() + precursor_mass_shift); // fix for TOPPView: Duplicate precursor MZ is not displayed.
+          ReactionMonitoringTransition decoy_tr = tr; // copy the target transition
 
-        // determine the current annotation for the target ion and then select
-        // the appropriate decoy ion for this target transition
-        std::pair<String, double> targetion = getTargetIon(tr.getProductMZ(), mz_threshold, target_ionseries, enable_losses);
-        std::pair<String, double> decoyion = getDecoyIon(targetion.first, decoy_ionseries);
+          decoy_tr.setNativeID(decoy_tag + tr.getNativeID());
+          decoy_tr.setDecoyTransitionType(ReactionMonitoringTransition::DECOY);
+          decoy_tr.setPrecursorMZ(tr.getPrecursorMZ() + precursor_mass_shift); // fix for TOPPView: Duplicate precursor MZ is not displayed.
 
-        if (method == "shift")
-        {
-          decoy_tr.setProductMZ(decoyion.second + mz_shift);
-        }
-        else
-        {
-          decoy_tr.setProductMZ(decoyion.second);
-        }
-        decoy_tr.setPeptideRef(decoy_tag + tr.getPeptideRef());
+          // determine the current annotation for the target ion and then select
+          // the appropriate decoy ion for this target transition
+          std::pair<String, double> targetion = getTargetIon(tr.getProductMZ(), mz_threshold, target_index);
+          std::pair<String, double> decoyion = getDecoyIon(targetion.first, decoy_ionseries);
 
-        if (decoyion.second > 0)
-        {
-          if (similarity_threshold >=0)
+          if (method == "shift")
           {
-            if (std::fabs(tr.getProductMZ() - decoy_tr.getProductMZ()) < similarity_threshold)
-            {
-              exclusion_peptides.push_back(decoy_tr.getPeptideRef());
-            }
+            decoy_tr.setProductMZ(decoyion.second + mz_shift);
           }
-         decoy_transitions.push_back(decoy_tr);
-        }
-        else
-        {
-          if (remove_unannotated)
+          else
           {
-            exclusion_peptides.push_back(decoy_tr.getPeptideRef());
+            decoy_tr.setProductMZ(decoyion.second);
+          }
+          decoy_tr.setPeptideRef(decoy_tag + tr.getPeptideRef());
+
+          if (decoyion.second > 0)
+          {
+            if (similarity_threshold >=0)
+            {
+              if (std::fabs(tr.getProductMZ() - decoy_tr.getProductMZ()) < similarity_threshold)
+              {
+                peptide_exclusions[k].push_back(decoy_tr.getPeptideRef());
+              }
+            }
+           peptide_decoy_transitions[k].push_back(decoy_tr);
           }
           else
           {
-            throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Decoy fragment ion for target fragment ion " + String(targetion.first) + " of peptide " + target_peptide_sequence.toString() + " with precursor charge " + String(target_peptide.getChargeState()) + " could not be mapped. Please check whether it is a valid ion and enable losses or removal of terminal modifications if necessary. Skipping of unannotated target assays is available as last resort.");
+            if (remove_unannotated)
+            {
+              peptide_exclusions[k].push_back(decoy_tr.getPeptideRef());
+            }
+            else
+            {
+              throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Decoy fragment ion for target fragment ion " + String(targetion.first) + " of peptide " + target_sequences[k].toString() + " with precursor charge " + String(target_peptide.getChargeState()) + " could not be mapped. Please check whether it is a valid ion and enable losses or removal of terminal modifications if necessary. Skipping of unannotated target assays is available as last resort.");
+            }
           }
-        }
-      } // end loop over transitions
+        } // end loop over transitions
+      }
+      catch (...)
+      {
+        errors.capture(k);
+      }
+
+#ifdef _OPENMP
+#pragma omp critical (MRMDecoy_progress)
+#endif
+      {
+        progress += peptide_transitions.size();
+        setProgress(progress);
+      }
     } // end loop over peptides
     endProgress();
+    // report the error of the first failing peptide, as a sequential run would
+    errors.rethrow();
+
+    // collect the results in peptide order
+    for (Size k = 0; k < peptide_entries.size(); ++k)
+    {
+      decoy_transitions.insert(decoy_transitions.end(), peptide_decoy_transitions[k].begin(), peptide_decoy_transitions[k].end());
+      exclusion_peptides.insert(exclusion_peptides.end(), peptide_exclusions[k].begin(), peptide_exclusions[k].end());
+    }
 
     if (exclude_similar)
     {
@@ -703,38 +868,80 @@ namespace OpenMS
     }
 
     {
-      Size progress = 0;
-      startProgress(0, exp.getTransitions().size(), "Correcting masses (theoretical)");
-      for (MRMDecoy::PeptideTransitionMapType::iterator pep_it = peptide_trans_map.begin();
+      // look up the peptides and parse their sequences before going parallel
+      std::vector<MRMDecoy::PeptideTransitionMapType::const_iterator> peptide_entries;
+      std::vector<const TargetedExperiment::Peptide*> target_peptide_ptrs;
+      std::vector<OpenMS::AASequence> target_sequences;
+      for (MRMDecoy::PeptideTransitionMapType::const_iterator pep_it = peptide_trans_map.begin();
            pep_it != peptide_trans_map.end(); ++pep_it)
       {
-        const TargetedExperiment::Peptide target_peptide = exp.getPeptideByRef(pep_it->first);
-        OpenMS::AASequence target_peptide_sequence = TargetedExperimentHelper::getAASequence(target_peptide);
-        MRMDecoy::IonSeries target_ionseries = getIonSeries(target_peptide_sequence, target_peptide.getChargeState());
+        const TargetedExperiment::Peptide& target_peptide = exp.getPeptideByRef(pep_it->first);
+        peptide_entries.push_back(pep_it);
+        target_peptide_ptrs.push_back(&target_peptide);
+        target_sequences.push_back(TargetedExperimentHelper::getAASequence(target_peptide));
+      }
 
-        for (Size i = 0; i < pep_it->second.size(); i++)
+      std::vector<MRMDecoy::TransitionVectorType> peptide_transitions(peptide_entries.size());
+      ParallelExceptionCollector errors;
+      Size progress = 0;
+      startProgress(0, exp.getTransitions().size(), "Correcting masses (theoretical)");
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+      for (SignedSize k = 0; k < (SignedSize)peptide_entries.size(); ++k)
+      {
+        if (errors.hasErrorBefore(k)) continue;
+        const std::vector<const ReactionMonitoringTransition*>& transitions = peptide_entries[k]->second;
+        const TargetedExperiment::Peptide& target_peptide = *target_peptide_ptrs[k];
+        try // exceptions must not leave the parallel region
         {
-          setProgress(++progress);
-          const ReactionMonitoringTransition tr = *(pep_it->second[i]);
+          MRMDecoy::IonSeries target_ionseries = getIonSeries(target_sequences[k], target_peptide.getChargeState());
+          MRMDecoy::FragmentIndex target_index;
+          getFragmentIndex(target_ionseries, enable_losses, target_index);
 
-          // determine the current annotation for the target ion
-          std::pair<String, double> targetion = getTargetIon(tr.getProductMZ(), mz_threshold, target_ionseries, enable_losses);
-          if (targetion.second == -1)
+          for (Size i = 0; i < transitions.size(); i++)
           {
-            throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Target fragment ion with m/z " + String(tr.getProductMZ()) + " of peptide " + target_peptide_sequence.toString() + " with precursor charge " + String(target_peptide.getChargeState()) + " could not be mapped. Please check whether it is a valid ion and an appropriate mz_threshold was chosen and enable losses if necessary.");
-          }
-          // correct the masses of the input experiment
-          {
-            ReactionMonitoringTransition transition = *(pep_it->second[i]); // copy the transition
-            if (targetion.second > 0)
+            const ReactionMonitoringTransition& tr = *(transitions[i]);
+
+            // determine the current annotation for the target ion
+            std::pair<String, double> targetion = getTargetIon(tr.getProductMZ(), mz_threshold, target_index);
+            if (targetion.second == -1)
             {
-              transition.setProductMZ(targetion.second);
-              target_transitions.push_back(transition);
+              throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Target fragment ion with m/z " + String(tr.getProductMZ()) + " of peptide " + target_sequences[k].toString() + " with precursor charge " + String(target_peptide.getChargeState()) + " could not be mapped. Please check whether it is a valid ion and an appropriate mz_threshold was chosen and enable losses if necessary.");
             }
-          }
-        } // end loop over transitions
+            // correct the masses of the input experiment
+            {
+              ReactionMonitoringTransition transition = tr; // copy the transition
+              if (targetion.second > 0)
+              {
+                transition.setProductMZ(targetion.second);
+                peptide_transitions[k].push_back(transition);
+              }
+            }
+          } // end loop over transitions
+        }
+        catch (...)
+        {
+          errors.capture(k);
+        }
+
+#ifdef _OPENMP
+#pragma omp critical (MRMDecoy_progress)
+#endif
+        {
+          progress += transitions.size();
+          setProgress(progress);
+        }
       } // end loop over peptides
       endProgress();
+      // report the error of the first failing peptide, as a sequential run would
+      errors.rethrow();
+
+      // collect the results in peptide order
+      for (Size k = 0; k < peptide_entries.size(); ++k)
+      {
+        target_transitions.insert(target_transitions.end(), peptide_transitions[k].begin(), peptide_transitions[k].end());
+      }
       exp.setTransitions(target_transitions);
     }
   }
@@ -43,6 +43,7 @@
 // peak picking & noise estimation
 #include <OpenMS/FILTERING/NOISEESTIMATION/SignalToNoiseEstimatorMedian.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/MRMTransitionGroupPicker.h>
+#include <OpenMS/CONCEPT/ParallelExceptionCollector.h>
 
 #define run_identifier "unique_run_identifier"
 
@@ -198,23 +199,56 @@ namespace OpenMS
     // Step 3
     //
     // Go through all transition groups: first create consensus features, then score them
-    Size progress = 0;
-    startProgress(0, transition_group_map.size(), "picking peaks");
+    //
+    // Picking only touches the transition group itself, so all groups are
+    // picked in parallel first. Scoring shares the scoring members and the
+    // output, it is done afterwards in the original order.
+    std::vector<MRMTransitionGroupType*> transition_groups;
     for (TransitionGroupMapType::iterator trgroup_it = transition_group_map.begin(); trgroup_it != transition_group_map.end(); ++trgroup_it)
     {
-
-      setProgress(++progress);
       MRMTransitionGroupType& transition_group = trgroup_it->second;
       if (transition_group.getChromatograms().size() == 0 || transition_group.getTransitions().size() == 0)
       {
         continue;
       }
+      transition_groups.push_back(&transition_group);
+    }
 
-      MRMTransitionGroupPicker trgroup_picker;
-      trgroup_picker.setParameters(param_.copy("TransitionGroupPicker:", true));
-      trgroup_picker.pickTransitionGroup(transition_group);
-      scorePeakgroups(trgroup_it->second, trafo, swath_map, output);
+    Size progress = 0;
+    startProgress(0, transition_groups.size(), "picking peaks");
+    const Param picker_param = param_.copy("TransitionGroupPicker:", true);
+    ParallelExceptionCollector errors;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 10)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)transition_groups.size(); ++i)
+    {
+      if (errors.hasErrorBefore(i)) continue;
+      try
+      {
+        MRMTransitionGroupPicker trgroup_picker;
+        trgroup_picker.setParameters(picker_param);
+        trgroup_picker.pickTransitionGroup(*transition_groups[i]);
+      }
+      catch (...) // exceptions must not leave the parallel region
+      {
+        errors.capture(i);
+      }
+#ifdef _OPENMP
+#pragma omp critical (MRMFeatureFinderScoring_progress)
+#endif
+      {
+        setProgress(++progress);
+      }
+    }
+    endProgress();
+    errors.rethrow();
 
+    startProgress(0, transition_groups.size(), "scoring peak groups");
+    for (Size i = 0; i < transition_groups.size(); ++i)
+    {
+      setProgress(i + 1);
+      scorePeakgroups(*transition_groups[i], trafo, swath_map, output);
     }
     endProgress();
 
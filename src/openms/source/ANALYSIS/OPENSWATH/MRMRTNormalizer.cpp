@@ -35,13 +35,147 @@
 #include <OpenMS/ANALYSIS/OPENSWATH/MRMRTNormalizer.h>
 #include <OpenMS/MATH/STATISTICS/LinearRegression.h>
 #include <OpenMS/CONCEPT/LogStream.h> // LOG_DEBUG
+#include <OpenMS/CONCEPT/ParallelExceptionCollector.h>
 
 #include <numeric>
 #include <boost/math/special_functions/erf.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int.hpp>
+#include <boost/random/variate_generator.hpp>
 #include <algorithm>
+#include <limits>
 
 namespace OpenMS
 {
+  namespace
+  {
+    /**
+      @brief Running sums of a set of points for a least-squares line fit
+
+      Points can be added and removed in constant time, and the fit as well as
+      the R^2 after leaving out a single point are computed from the sums in
+      constant time. All points are shifted by a fixed offset (usually the
+      mean of the data) to avoid cancellation in the sums of squares; neither
+      the slope nor R^2 depend on the shift.
+    */
+    struct RegressionSums
+    {
+      RegressionSums(const std::vector<double>& x, const std::vector<double>& y) :
+        n(0), sx(0), sy(0), sxx(0), syy(0), sxy(0), x0(0), y0(0)
+      {
+        if (!x.empty())
+        {
+          x0 = std::accumulate(x.begin(), x.end(), 0.0) / x.size();
+          y0 = std::accumulate(y.begin(), y.end(), 0.0) / y.size();
+        }
+        for (Size i = 0; i < x.size(); ++i)
+        {
+          add(x[i], y[i]);
+        }
+      }
+
+      void add(double x, double y)
+      {
+        update_(x - x0, y - y0, 1.0);
+      }
+
+      void remove(double x, double y)
+      {
+        update_(x - x0, y - y0, -1.0);
+      }
+
+      /// R^2 of the current points
+      double rsq() const
+      {
+        return rsq_(n, sx, sy, sxx, syy, sxy);
+      }
+
+      /// R^2 of the current points without point (x, y)
+      double rsqWithout(double x, double y) const
+      {
+        double dx = x - x0, dy = y - y0;
+        return rsq_(n - 1, sx - dx, sy - dy, sxx - dx * dx, syy - dy * dy, sxy - dx * dy);
+      }
+
+      /// slope and intercept of the current points
+      void fit(double& intercept, double& slope) const
+      {
+        double cxx = sxx - sx * sx / n;
+        checkFit_(n, cxx, sxx);
+        slope = (sxy - sx * sy / n) / cxx;
+        intercept = (y0 + sy / n) - slope * (x0 + sx / n);
+      }
+
+      double n, sx, sy, sxx, syy, sxy;
+      double x0, y0;
+
+private:
+      void update_(double dx, double dy, double sign)
+      {
+        n += sign;
+        sx += sign * dx;
+        sy += sign * dy;
+        sxx += sign * dx * dx;
+        syy += sign * dy * dy;
+        sxy += sign * dx * dy;
+      }
+
+      static void checkFit_(double n, double cxx, double sxx)
+      {
+        // same condition as in LinearRegression: a line cannot be fitted to
+        // less than two points or to points with identical x-coordinates
+        if (n < 2 || cxx <= std::numeric_limits<double>::epsilon() * sxx)
+        {
+          throw Exception::UnableToFit(__FILE__, __LINE__, __PRETTY_FUNCTION__, "UnableToFit-LinearRegression", "Could not fit a linear model to the data");
+        }
+      }
+
+      static double rsq_(double n, double sx, double sy, double sxx, double syy, double sxy)
+      {
+        // squared Pearson coefficient (as in LinearRegression)
+        double cxx = sxx - sx * sx / n;
+        checkFit_(n, cxx, sxx);
+        double cyy = syy - sy * sy / n;
+        double cxy = sxy - sx * sy / n;
+        return (cxy * cxy) / (cxx * cyy);
+      }
+    };
+
+    /// position of the point whose removal results in the highest R^2
+    int jackknifeCandidate(const RegressionSums& sums, const std::vector<double>& x, const std::vector<double>& y)
+    {
+      int best_pos = 0;
+      double best_rsq = -std::numeric_limits<double>::max();
+      for (Size i = 0; i < x.size(); ++i)
+      {
+        double rsq = sums.rsqWithout(x[i], y[i]);
+        if (rsq > best_rsq)
+        {
+          best_rsq = rsq;
+          best_pos = (int)i;
+        }
+      }
+      return best_pos;
+    }
+
+    /// position of the point with the largest residual to the given fit
+    int residualCandidate(double intercept, double slope, const std::vector<double>& x, const std::vector<double>& y)
+    {
+      int best_pos = 0;
+      double best_residual = -1;
+      for (Size i = 0; i < x.size(); ++i)
+      {
+        double residual = fabs(y[i] - (intercept + (slope * x[i])));
+        if (residual > best_residual)
+        {
+          best_residual = residual;
+          best_pos = (int)i;
+        }
+      }
+      return best_pos;
+    }
+  }
+
   std::pair<double, double > MRMRTNormalizer::llsm_fit(std::vector<std::pair<double, double> >& pairs)
   {
     std::vector<double> x, y;
@@ -161,60 +295,100 @@ namespace OpenMS
   {
     // implementation of the RANSAC algorithm according to http://wiki.scipy.org/Cookbook/RANSAC.
 
-    std::vector<std::pair<double, double> > maybeinliers, test_points, alsoinliers, betterdata, bestdata;
+    if (n > pairs.size())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+        "RANSAC: cannot sample " + boost::lexical_cast<std::string>(n) + " out of " + boost::lexical_cast<std::string>(pairs.size()) + " data points.");
+    }
 
+    std::vector<std::pair<double, double> > bestdata;
     double besterror = std::numeric_limits<double>::max();
-    double bettererror;
-#ifdef DEBUG_MRMRTNORMALIZER
-    std::pair<double, double > bestcoeff;
-    double betterrsq = 0;
-    double bestrsq = 0;
-#endif
+    SignedSize bestiteration = -1;
 
-    for (size_t ransac_int=0; ransac_int<k; ransac_int++)
-    {
-      std::vector<std::pair<double, double> > pairs_shuffled = pairs;
+    ParallelExceptionCollector errors;
 
-      if (!test)
-      { // disables random selection in test mode
-        std::random_shuffle(pairs_shuffled.begin(), pairs_shuffled.end());
-      }
+    // The iterations are independent: each one draws its sample with its own
+    // random number generator (seeded with the iteration number) and the best
+    // model is chosen by error, then by iteration, which makes the result
+    // independent of the number of threads.
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (SignedSize ransac_int = 0; ransac_int < (SignedSize)k; ransac_int++)
+    {
+      if (errors.hasErrorBefore(ransac_int)) continue; // the sequential loop would have stopped already
+      try
+      {
+        std::vector<Size> index(pairs.size());
+        for (Size i = 0; i < index.size(); ++i)
+        {
+          index[i] = i;
+        }
 
-      maybeinliers.clear();
-      test_points.clear();
-      std::copy( pairs_shuffled.begin(), pairs_shuffled.begin()+n, std::back_inserter(maybeinliers) );
-      std::copy( pairs_shuffled.begin()+n, pairs_shuffled.end(), std::back_inserter(test_points) );
+        if (!test)
+        { // disables random selection in test mode
+          boost::mt19937 generator((boost::uint32_t)ransac_int);
+          boost::uniform_int<> uni_dist;
+          boost::variate_generator<boost::mt19937&, boost::uniform_int<> > pseudoRNG(generator, uni_dist);
+
+          // partial Fisher-Yates shuffle: only the first n positions are drawn
+          for (Size i = 0; i < n; ++i)
+          {
+            std::swap(index[i], index[i + pseudoRNG((int)(index.size() - i))]);
+          }
+          // keep the remaining points in input order
+          std::sort(index.begin() + n, index.end());
+        }
 
-      std::pair<double, double > coeff = llsm_fit(maybeinliers);
+        std::vector<std::pair<double, double> > maybeinliers, test_points;
+        maybeinliers.reserve(n);
+        test_points.reserve(pairs.size() - n);
+        for (Size i = 0; i < n; ++i)
+        {
+          maybeinliers.push_back(pairs[index[i]]);
+        }
+        for (Size i = n; i < index.size(); ++i)
+        {
+          test_points.push_back(pairs[index[i]]);
+        }
 
-      alsoinliers = llsm_rss_inliers(test_points,coeff,t);
+        std::pair<double, double > coeff = llsm_fit(maybeinliers);
 
-      if (alsoinliers.size() > d)
-      {
-        betterdata = maybeinliers;
-        betterdata.insert( betterdata.end(), alsoinliers.begin(), alsoinliers.end() );
-        std::pair<double, double > bettercoeff = llsm_fit(betterdata);
-        bettererror = llsm_rss(betterdata,bettercoeff);
-#ifdef DEBUG_MRMRTNORMALIZER
-        betterrsq = llsm_rsq(betterdata);
-#endif
+        std::vector<std::pair<double, double> > alsoinliers = llsm_rss_inliers(test_points, coeff, t);
 
-        if (bettererror < besterror)
+        if (alsoinliers.size() > d)
         {
-          besterror = bettererror;
-#ifdef DEBUG_MRMRTNORMALIZER
-          bestcoeff = bettercoeff;
+          std::vector<std::pair<double, double> > betterdata = maybeinliers;
+          betterdata.insert( betterdata.end(), alsoinliers.begin(), alsoinliers.end() );
+          std::pair<double, double > bettercoeff = llsm_fit(betterdata);
+          double bettererror = llsm_rss(betterdata,bettercoeff);
+
+#ifdef _OPENMP
+#pragma omp critical (MRMRTNormalizer_ransac)
 #endif
-          bestdata = betterdata;
+          {
+            if (bettererror < besterror || (bettererror == besterror && ransac_int < bestiteration))
+            {
+              besterror = bettererror;
+              bestiteration = ransac_int;
+              bestdata.swap(betterdata);
 
 #ifdef DEBUG_MRMRTNORMALIZER
-          bestrsq = betterrsq;
-          std::cout << "RANSAC " << ransac_int << ": Points: " << betterdata.size() << " RSQ: " << bestrsq << " Error: " << besterror << " c0: " << bestcoeff.first << " c1: " << bestcoeff.second << std::endl;
+              std::cout << "RANSAC " << ransac_int << ": Points: " << bestdata.size() << " RSQ: " << llsm_rsq(bestdata) << " Error: " << besterror << " c0: " << bettercoeff.first << " c1: " << bettercoeff.second << std::endl;
 #endif
+            }
+          }
         }
       }
+      catch (...) // exceptions must not leave the parallel region
+      {
+        errors.capture(ransac_int);
+      }
     }
 
+    // the error of the first failing iteration (e.g. Exception::UnableToFit), as in a sequential run
+    errors.rethrow();
+
 #ifdef DEBUG_MRMRTNORMALIZER
     std::cout << "=======STARTPOINTS=======" << std::endl;
     for (std::vector<std::pair<double, double> >::iterator it = bestdata.begin(); it != bestdata.end(); ++it)
@@ -233,21 +407,10 @@ namespace OpenMS
     // the data points with one removed pair. The combination resulting in
     // highest rsq is considered corresponding to the outlier candidate. The
     // corresponding iterator position is then returned.
-    std::vector<double> x_tmp, y_tmp, rsq_tmp;
-
-    for (Size i = 0; i < x.size(); i++)
-    {
-      x_tmp = x;
-      y_tmp = y;
-      x_tmp.erase(x_tmp.begin() + i);
-      y_tmp.erase(y_tmp.begin() + i);
-
-      Math::LinearRegression lin_reg;
-      lin_reg.computeRegression(0.95, x_tmp.begin(), x_tmp.end(), y_tmp.begin());
-
-      rsq_tmp.push_back(lin_reg.getRSquared());
-    }
-    return max_element(rsq_tmp.begin(), rsq_tmp.end()) - rsq_tmp.begin();
+    // The leave-one-out rsq is computed from the sums over all points minus
+    // the contribution of the left-out point, i.e. without refitting.
+    RegressionSums sums(x, y);
+    return jackknifeCandidate(sums, x, y);
   }
 
   int MRMRTNormalizer::residualOutlierCandidate(std::vector<double>& x, std::vector<double>& y)
@@ -258,20 +421,29 @@ namespace OpenMS
     Math::LinearRegression lin_reg;
     lin_reg.computeRegression(0.95, x.begin(), x.end(), y.begin());
 
-    std::vector<double> residuals;
+    return residualCandidate(lin_reg.getIntercept(), lin_reg.getSlope(), x, y);
+  }
 
-    for (Size i = 0; i < x.size(); i++)
+  std::vector<std::pair<double, double> > MRMRTNormalizer::removeOutliersIterative(
+      std::vector<std::pair<double, double> >& pairs, double rsq_limit,
+      double coverage_limit, bool use_chauvenet, std::string method)
+  {
+    OutlierRemovalResult result;
+    removeOutliersIterative(pairs, rsq_limit, coverage_limit, use_chauvenet, method, result);
+
+    if (!result.rsq_limit_reached)
     {
-      double residual = fabs(y[i] - (lin_reg.getIntercept() + (lin_reg.getSlope() * x[i])));
-      residuals.push_back(residual);
+      // If the rsq is below the limit, this is an indication that something went wrong!
+      throw Exception::UnableToFit(__FILE__, __LINE__, __PRETTY_FUNCTION__, "UnableToFit-LinearRegression-RTNormalizer", "WARNING: rsq: " + boost::lexical_cast<std::string>(result.rsq) + " is below limit of " + boost::lexical_cast<std::string>(rsq_limit) + ". Validate assays for RT-peptides and adjust the limit for rsq or coverage.");
     }
 
-    return max_element(residuals.begin(), residuals.end()) - residuals.begin();
+    return result.pairs;
   }
 
-  std::vector<std::pair<double, double> > MRMRTNormalizer::removeOutliersIterative(
-      std::vector<std::pair<double, double> >& pairs, double rsq_limit,
-      double coverage_limit, bool use_chauvenet, std::string method)
+  void MRMRTNormalizer::removeOutliersIterative(
+      const std::vector<std::pair<double, double> >& pairs, double rsq_limit,
+      double coverage_limit, bool use_chauvenet, const std::string& method,
+      OutlierRemovalResult& result)
   {
     if (pairs.size() < 2)
     {
@@ -279,28 +451,36 @@ namespace OpenMS
         "Need at least 2 points for the regression.");
     }
 
+    if (method != "iter_jackknife" && method != "iter_residual")
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+        String("Method ") + method + " is not a valid method for removeOutliersIterative");
+    }
+
     // Removes outliers from vector of pairs until upper rsq and lower coverage limits are reached.
     std::vector<double> x, y;
-    double confidence_interval = 0.95;
+    std::vector<Size> positions; // position of the points in the input
 
-    std::vector<std::pair<double, double> > pairs_corrected;
-
-    for (std::vector<std::pair<double, double> >::iterator it = pairs.begin(); it != pairs.end(); ++it)
+    for (std::vector<std::pair<double, double> >::const_iterator it = pairs.begin(); it != pairs.end(); ++it)
     {
       x.push_back(it->first);
       y.push_back(it->second);
+      positions.push_back(it - pairs.begin());
       LOG_DEBUG << "RT Normalization pairs: " << it->first << " : " << it->second << std::endl;
     }
 
-    double rsq;
-    rsq = 0;
+    // the fit is computed from running sums, which are updated when a point is removed
+    RegressionSums sums(x, y);
+
+    result.removed.clear();
+    result.removed_rsq.clear();
+
+    double rsq = 0, intercept = 0, slope = 0;
 
     while (x.size() >= coverage_limit * pairs.size() && rsq < rsq_limit)
     {
-      Math::LinearRegression lin_reg;
-      lin_reg.computeRegression(confidence_interval, x.begin(), x.end(), y.begin());
-
-      rsq = lin_reg.getRSquared();
+      sums.fit(intercept, slope);
+      rsq = sums.rsq();
 
       std::cout << "rsq: " << rsq << " points: " << x.size() << std::endl;
 
@@ -309,11 +489,9 @@ namespace OpenMS
         std::vector<double> residuals;
 
         // calculate residuals
-        for (std::vector<std::pair<double, double> >::iterator it = pairs.begin(); it != pairs.end(); ++it)
+        for (std::vector<std::pair<double, double> >::const_iterator it = pairs.begin(); it != pairs.end(); ++it)
         {
-          double intercept = lin_reg.getIntercept();
-          double slope = (double)lin_reg.getSlope();
-          residuals.push_back(abs(it->second - (intercept + it->first * slope)));
+          residuals.push_back(fabs(it->second - (intercept + it->first * slope)));
           LOG_DEBUG << " RT Normalization residual is " << residuals.back() << std::endl;
         }
 
@@ -322,17 +500,12 @@ namespace OpenMS
         if (method == "iter_jackknife")
         {
           // get candidate outlier: removal of which datapoint results in best rsq?
-          pos = jackknifeOutlierCandidate(x, y);
-        }
-        else if (method == "iter_residual")
-        {
-          // get candidate outlier: removal of datapoint with largest residual?
-          pos = residualOutlierCandidate(x, y);
+          pos = jackknifeCandidate(sums, x, y);
         }
         else
         {
-          throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__,
-            String("Method ") + method + " is not a valid method for removeOutliersIterative");
+          // get candidate outlier: removal of datapoint with largest residual?
+          pos = residualCandidate(intercept, slope, x, y);
         }
 
         // remove if residual is an outlier according to Chauvenet's criterion
@@ -340,8 +513,13 @@ namespace OpenMS
         LOG_DEBUG << " Got outlier candidate " << pos << "(" << x[pos] << " / " << y[pos] << std::endl;
         if (!use_chauvenet || chauvenet(residuals, pos))
         {
+          result.removed.push_back(positions[pos]);
+          result.removed_rsq.push_back(rsq);
+
+          sums.remove(x[pos], y[pos]);
           x.erase(x.begin() + pos);
           y.erase(y.begin() + pos);
+          positions.erase(positions.begin() + pos);
         }
         else
         {
@@ -354,27 +532,38 @@ namespace OpenMS
       }
     }
 
-    if (rsq < rsq_limit)
+    result.pairs.clear();
+    for (Size i = 0; i < x.size(); i++)
     {
-      // If the rsq is below the limit, this is an indication that something went wrong!
-      throw Exception::UnableToFit(__FILE__, __LINE__, __PRETTY_FUNCTION__, "UnableToFit-LinearRegression-RTNormalizer", "WARNING: rsq: " + boost::lexical_cast<std::string>(rsq) + " is below limit of " + boost::lexical_cast<std::string>(rsq_limit) + ". Validate assays for RT-peptides and adjust the limit for rsq or coverage.");
+      result.pairs.push_back(std::make_pair(x[i], y[i]));
     }
-
-    for (Size i = 0; i < x.size(); i++)
+    // if the loop stopped due to the coverage limit, the last fit still
+    // includes the point removed last
+    if (!result.removed.empty() && rsq < rsq_limit && x.size() >= 2)
     {
-      pairs_corrected.push_back(std::make_pair(x[i], y[i]));
+      try
+      {
+        sums.fit(intercept, slope);
+        rsq = sums.rsq();
+      }
+      catch (Exception::UnableToFit&)
+      {
+        // keep the last fit
+      }
     }
+    result.intercept = intercept;
+    result.slope = slope;
+    result.rsq = rsq;
+    result.rsq_limit_reached = !(rsq < rsq_limit);
 
 #ifdef DEBUG_MRMRTNORMALIZER
     std::cout << "=======STARTPOINTS=======" << std::endl;
-    for (std::vector<std::pair<double, double> >::iterator it = pairs_corrected.begin(); it != pairs_corrected.end(); ++it)
+    for (std::vector<std::pair<double, double> >::iterator it = result.pairs.begin(); it != result.pairs.end(); ++it)
     {
       std::cout << it->first << "\t" << it->second << std::endl;
     }
     std::cout << "=======ENDPOINTS=======" << std::endl;
 #endif
-
-    return pairs_corrected;
   }
 
   bool MRMRTNormalizer::chauvenet(std::vector<double>& residuals, int pos)
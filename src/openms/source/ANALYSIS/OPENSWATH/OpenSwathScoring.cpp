@@ -88,15 +88,15 @@ namespace OpenMS
     // Isotope correlation / overlap score: Is this peak part of an
     // isotopic pattern or is it the monoisotopic peak in an isotopic
     // pattern?
-    diascoring.dia_isotope_scores(transitions, (*spectrum), imrmfeature, scores.isotope_correlation, scores.isotope_overlap);
     // Mass deviation score
-    diascoring.dia_massdiff_score(transitions, (*spectrum), normalized_library_intensity,
-        scores.massdev_score, scores.weighted_massdev_score);
-
     // Presence of b/y series score
+    // (all computed from a single pass over the spectrum)
     OpenMS::AASequence aas;
     OpenSwathDataAccessHelper::convertPeptideToAASequence(pep, aas);
-    diascoring.dia_by_ion_score((*spectrum), aas, by_charge_state, scores.bseries_score, scores.yseries_score);
+    diascoring.dia_ms2_scores(transitions, (*spectrum), imrmfeature, normalized_library_intensity, aas, by_charge_state,
+        scores.isotope_correlation, scores.isotope_overlap,
+        scores.massdev_score, scores.weighted_massdev_score,
+        scores.bseries_score, scores.yseries_score);
 
     // FEATURE we should not punish so much when one transition is missing!
     scores.massdev_score = scores.massdev_score / transitions.size();
@@ -9,6 +9,7 @@ MRMDecoy.cpp
 MRMRTNormalizer.cpp
 TransitionTSVReader.cpp
 OpenSwathHelper.cpp
+LightTransitionTable.cpp
 OpenSwathScoring.cpp
 ChromatogramExtractor.cpp
 ChromatogramExtractorAlgorithm.cpp
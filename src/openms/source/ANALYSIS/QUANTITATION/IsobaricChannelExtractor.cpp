@@ -40,6 +40,7 @@
 #include <OpenMS/KERNEL/ConsensusMap.h>
 
 #include <OpenMS/CONCEPT/LogStream.h>
+#include <OpenMS/CONCEPT/ParallelExceptionCollector.h>
 
 #include <cmath>
 
@@ -388,8 +389,10 @@ namespace OpenMS
     return precursor_intensity / total_intensity;
   }
 
-  double IsobaricChannelExtractor::computePrecursorPurity_(const MSExperiment<Peak1D>::ConstIterator& ms2_spec, const PuritySate_& pState) const
+  double IsobaricChannelExtractor::computePrecursorPurity_(const ScanNeighbours_& neighbours) const
   {
+    const MSExperiment<Peak1D>::ConstIterator& ms2_spec = neighbours.spectrum;
+
     // we cannot analyze precursors without a charge
     if (ms2_spec->getPrecursors()[0].getCharge() == 0)
     {
@@ -402,18 +405,18 @@ namespace OpenMS
 #endif
 
       // compute purity of preceding ms1 scan
-      double early_scan_purity = computeSingleScanPrecursorPurity_(ms2_spec, *(pState.precursorScan));
+      double early_scan_purity = computeSingleScanPrecursorPurity_(ms2_spec, *(neighbours.precursorScan));
 
-      if (pState.hasFollowUpScan && interpolate_precursor_purity_)
+      if (neighbours.hasFollowUpScan && interpolate_precursor_purity_)
       {
-        double late_scan_purity = computeSingleScanPrecursorPurity_(ms2_spec, *(pState.followUpScan));
+        double late_scan_purity = computeSingleScanPrecursorPurity_(ms2_spec, *(neighbours.followUpScan));
 
         // calculating the extrapolated, S2I value as a time weighted linear combination of the two scans
         // see: Savitski MM, Sweetman G, Askenazi M, Marto JA, Lang M, Zinn N, et al. (2011).
         // Analytical chemistry 83: 8959–67. http://www.ncbi.nlm.nih.gov/pubmed/22017476
         // std::fabs is applied to compensate for potentially negative RTs
-        return std::fabs(ms2_spec->getRT() - pState.precursorScan->getRT()) *
-               ((late_scan_purity - early_scan_purity) / std::fabs(pState.followUpScan->getRT() - pState.precursorScan->getRT()))
+        return std::fabs(ms2_spec->getRT() - neighbours.precursorScan->getRT()) *
+               ((late_scan_purity - early_scan_purity) / std::fabs(neighbours.followUpScan->getRT() - neighbours.precursorScan->getRT()))
                + early_scan_purity;
       }
       else
@@ -423,6 +426,35 @@ namespace OpenMS
     }
   }
 
+  void IsobaricChannelExtractor::extractReporterIntensities_(const MSExperiment<Peak1D>::SpectrumType& spec, std::vector<Peak2D::IntensityType>::iterator channel_intensities) const
+  {
+    for (IsobaricQuantitationMethod::IsobaricChannelList::const_iterator cl_it = quant_method_->getChannelInformation().begin();
+         cl_it != quant_method_->getChannelInformation().end();
+         ++cl_it, ++channel_intensities)
+    {
+      Peak2D::IntensityType intensity = 0;
+
+      // as every evaluation requires time, we cache the MZEnd iterator
+      const MSExperiment<Peak1D>::SpectrumType::ConstIterator mz_end = spec.MZEnd(cl_it->center + reporter_mass_shift_);
+
+      // add up all signals
+      for (MSExperiment<Peak1D>::SpectrumType::ConstIterator mz_it = spec.MZBegin(cl_it->center - reporter_mass_shift_);
+           mz_it != mz_end;
+           ++mz_it)
+      {
+        intensity += mz_it->getIntensity();
+      }
+
+      // discard contribution of this channel as it is below the required intensity threshold
+      if (intensity < min_reporter_intensity_)
+      {
+        intensity = 0;
+      }
+
+      *channel_intensities = intensity;
+    }
+  }
+
   void IsobaricChannelExtractor::extractChannels(const MSExperiment<Peak1D>& ms_exp_data, ConsensusMap& consensus_map)
   {
     if (ms_exp_data.empty())
@@ -440,9 +472,11 @@ namespace OpenMS
     LOG_INFO << "Selecting scans with activation mode: " << (selected_activation_ == "" ? "any" : selected_activation_) << "\n";
     HasActivationMethod<MSExperiment<Peak1D>::SpectrumType> isValidActivation(ListUtils::create<String>(selected_activation_));
 
-    // now we have picked data
-    // --> assign peaks to channels
-    UInt64 element_index(0);
+    // ------------------------------------------------------------------------------
+    // single pass over the experiment: collect the tandem spectra to quantify together
+    // with their surrounding MS1 scans
+
+    std::vector<ScanNeighbours_> tandem_spectra;
 
     // remember the current precursor spectrum
     PuritySate_ pState(ms_exp_data);
@@ -479,95 +513,129 @@ namespace OpenMS
           continue;
         }
 
+        ScanNeighbours_ neighbours;
+        neighbours.spectrum = it;
+        neighbours.precursorScan = pState.precursorScan;
+        neighbours.followUpScan = pState.followUpScan;
+        neighbours.hasPrecursorScan = pState.precursorScan != ms_exp_data.end();
+        neighbours.hasFollowUpScan = pState.hasFollowUpScan;
+        tandem_spectra.push_back(neighbours);
+      }
+    } // ! Experiment iterator
+
+    // ------------------------------------------------------------------------------
+    // compute precursor purity and reporter intensities (independently for each tandem spectrum)
+
+    const Size channel_count = quant_method_->getChannelInformation().size();
+    std::vector<double> precursor_purities(tandem_spectra.size(), -1.0);
+    std::vector<Peak2D::IntensityType> channel_intensities(tandem_spectra.size() * channel_count, 0);
+
+    ParallelExceptionCollector errors;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)tandem_spectra.size(); ++i)
+    {
+      if (errors.hasErrorBefore(i)) continue;
+      try
+      {
         // check precursor purity if we have a valid precursor ..
-        double precursor_purity = -1.0;
-        if (pState.precursorScan != ms_exp_data.end())
+        if (tandem_spectra[i].hasPrecursorScan)
         {
-          precursor_purity = computePrecursorPurity_(it, pState);
-          // check if purity is high enough
-          if (precursor_purity < min_precursor_purity_)
-          {
-            LOG_DEBUG << "Skip spectrum " << it->getNativeID() << ": Precursor purity is below the threshold. [purity = " << precursor_purity << "]" << std::endl;
-            continue;
-          }
-        }
-        else
-        {
-          LOG_INFO << "No precursor available for spectrum: " << it->getNativeID() << std::endl;
+          precursor_purities[i] = computePrecursorPurity_(tandem_spectra[i]);
+          // the spectrum will be skipped, no need to look at its reporters
+          if (precursor_purities[i] < min_precursor_purity_) continue;
         }
 
-        // store RT&MZ of parent ion as centroid of ConsensusFeature
-        ConsensusFeature cf;
-        cf.setUniqueId();
-        cf.setRT(it->getRT());
-        cf.setMZ(it->getPrecursors()[0].getMZ());
-
-        Peak2D channel_value;
-        channel_value.setRT(it->getRT());
-        // for each each channel
-        UInt64 map_index = 0;
-        Peak2D::IntensityType overall_intensity = 0;
-        for (IsobaricQuantitationMethod::IsobaricChannelList::const_iterator cl_it = quant_method_->getChannelInformation().begin();
-             cl_it != quant_method_->getChannelInformation().end();
-             ++cl_it)
-        {
-          // set mz-position of channel
-          channel_value.setMZ(cl_it->center);
-          // reset intensity
-          channel_value.setIntensity(0);
-
-          // as every evaluation requires time, we cache the MZEnd iterator
-          const MSExperiment<Peak1D>::SpectrumType::ConstIterator mz_end = it->MZEnd(cl_it->center + reporter_mass_shift_);
-
-          // add up all signals
-          for (MSExperiment<Peak1D>::SpectrumType::ConstIterator mz_it = it->MZBegin(cl_it->center - reporter_mass_shift_);
-               mz_it != mz_end;
-               ++mz_it)
-          {
-            channel_value.setIntensity(channel_value.getIntensity() + mz_it->getIntensity());
-          }
-
-          // discard contribution of this channel as it is below the required intensity threshold
-          if (channel_value.getIntensity() < min_reporter_intensity_)
-          {
-            channel_value.setIntensity(0);
-          }
-
-          overall_intensity += channel_value.getIntensity();
-          // add channel to ConsensusFeature
-          cf.insert(map_index++, channel_value, element_index);
-        } // ! channel_iterator
-
-        // check if we keep this feature or if it contains low-intensity quantifications
-        if (remove_low_intensity_quantifications_ && hasLowIntensityReporter_(cf))
+        extractReporterIntensities_(*tandem_spectra[i].spectrum, channel_intensities.begin() + i * channel_count);
+      }
+      catch (...) // exceptions must not leave the parallel region
+      {
+        errors.capture(i);
+      }
+    }
+    errors.rethrow();
+
+    // ------------------------------------------------------------------------------
+    // assemble the consensus features in the order of the tandem spectra in the experiment
+
+    // now we have picked data
+    // --> assign peaks to channels
+    UInt64 element_index(0);
+
+    for (Size i = 0; i < tandem_spectra.size(); ++i)
+    {
+      const MSExperiment<Peak1D>::ConstIterator& it = tandem_spectra[i].spectrum;
+      const double precursor_purity = precursor_purities[i];
+
+      if (tandem_spectra[i].hasPrecursorScan)
+      {
+        // check if purity is high enough
+        if (precursor_purity < min_precursor_purity_)
         {
+          LOG_DEBUG << "Skip spectrum " << it->getNativeID() << ": Precursor purity is below the threshold. [purity = " << precursor_purity << "]" << std::endl;
           continue;
         }
+      }
+      else
+      {
+        LOG_INFO << "No precursor available for spectrum: " << it->getNativeID() << std::endl;
+      }
 
-        // check featureHandles are not empty
-        if (overall_intensity <= 0)
-        {
-          cf.setMetaValue("all_empty", String("true"));
-        }
-        // add purity information if we could compute it
-        if (precursor_purity > 0.0)
-        {
-          cf.setMetaValue("precursor_purity", precursor_purity);
-        }
+      // store RT&MZ of parent ion as centroid of ConsensusFeature
+      ConsensusFeature cf;
+      cf.setUniqueId();
+      cf.setRT(it->getRT());
+      cf.setMZ(it->getPrecursors()[0].getMZ());
+
+      Peak2D channel_value;
+      channel_value.setRT(it->getRT());
+      // for each each channel
+      UInt64 map_index = 0;
+      Peak2D::IntensityType overall_intensity = 0;
+      std::vector<Peak2D::IntensityType>::const_iterator intensity_it = channel_intensities.begin() + i * channel_count;
+      for (IsobaricQuantitationMethod::IsobaricChannelList::const_iterator cl_it = quant_method_->getChannelInformation().begin();
+           cl_it != quant_method_->getChannelInformation().end();
+           ++cl_it, ++intensity_it)
+      {
+        // set mz-position and intensity of channel
+        channel_value.setMZ(cl_it->center);
+        channel_value.setIntensity(*intensity_it);
 
-        // embed the id of the scan from which the quantitative information was extracted
-        cf.setMetaValue("scan_id", it->getNativeID());
-        // ...as well as additional meta information
-        cf.setMetaValue("precursor_intensity", it->getPrecursors()[0].getIntensity());
+        overall_intensity += channel_value.getIntensity();
+        // add channel to ConsensusFeature
+        cf.insert(map_index++, channel_value, element_index);
+      } // ! channel_iterator
 
-        cf.setCharge(it->getPrecursors()[0].getCharge());
-        cf.setIntensity(overall_intensity);
-        consensus_map.push_back(cf);
+      // check if we keep this feature or if it contains low-intensity quantifications
+      if (remove_low_intensity_quantifications_ && hasLowIntensityReporter_(cf))
+      {
+        continue;
+      }
 
-        // the tandem-scan in the order they appear in the experiment
-        ++element_index;
+      // check featureHandles are not empty
+      if (overall_intensity <= 0)
+      {
+        cf.setMetaValue("all_empty", String("true"));
       }
-    } // ! Experiment iterator
+      // add purity information if we could compute it
+      if (precursor_purity > 0.0)
+      {
+        cf.setMetaValue("precursor_purity", precursor_purity);
+      }
+
+      // embed the id of the scan from which the quantitative information was extracted
+      cf.setMetaValue("scan_id", it->getNativeID());
+      // ...as well as additional meta information
+      cf.setMetaValue("precursor_intensity", it->getPrecursors()[0].getIntensity());
+
+      cf.setCharge(it->getPrecursors()[0].getCharge());
+      cf.setIntensity(overall_intensity);
+      consensus_map.push_back(cf);
+
+      // the tandem-scan in the order they appear in the experiment
+      ++element_index;
+    } // ! tandem spectra
 
     /// add meta information to the map
     registerChannelsInOutputMap_(consensus_map);
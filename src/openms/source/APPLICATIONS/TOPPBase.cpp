@@ -35,6 +35,7 @@
 #include <OpenMS/APPLICATIONS/TOPPBase.h>
 
 #include <OpenMS/SYSTEM/File.h>
+#include <OpenMS/SYSTEM/Profiler.h>
 #include <OpenMS/SYSTEM/StopWatch.h>
 
 #include <OpenMS/DATASTRUCTURES/Date.h>
@@ -165,6 +166,7 @@ namespace OpenMS
     registerIntOption_("instance", "<n>", 1, "Instance number for the TOPP INI file", false, true);
     registerIntOption_("debug", "<n>", 0, "Sets the debug level", false, true);
     registerIntOption_("threads", "<n>", 1, "Sets the number of threads allowed to be used by the TOPP tool", false);
+    registerStringOption_("profile", "<file>", "", "Writes the wall time, CPU time and peak memory of the processing stages to the given file (JSON for '.json', otherwise folded stacks for flame graphs)", false, true);
     registerStringOption_("write_ini", "<file>", "", "Writes the default configuration file", false);
     registerStringOption_("write_ctd", "<out_dir>", "", "Writes the common tool description file(s) (Toolname(s).ctd) to <out_dir>", false, true);
     registerStringOption_("write_wsdl", "<file>", "", "Writes the default WSDL file", false, true);
@@ -455,7 +457,11 @@ namespace OpenMS
     //----------------------------------------------------------
     StopWatch sw;
     sw.start();
-    result = main_(argc, argv);
+    {
+      // the profile is written when leaving this block, i.e. also if the tool fails
+      Profiler::Session profile(tool_name_, getParamAsString_("profile", ""));
+      result = main_(argc, argv);
+    }
     sw.stop();
     LOG_INFO << this->tool_name_ << " took "
              << StopWatch::toString(sw.getClockTime()) << " (wall), "
@@ -0,0 +1,223 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CHEMISTRY/DigestedPeptideTable.h>
+#include <OpenMS/CHEMISTRY/ResidueDB.h>
+#include <OpenMS/CHEMISTRY/Residue.h>
+#include <OpenMS/CONCEPT/ParallelExceptionCollector.h>
+#include <OpenMS/FORMAT/MappedFASTAFile.h>
+
+#include <algorithm>
+
+using namespace std;
+
+namespace OpenMS
+{
+  std::size_t DigestedPeptideTable::RecordHash::operator()(Size index) const
+  {
+    const PeptideRecord& record = table->records_[index];
+    const char* seq = table->sequences_.data() + record.offset;
+    // FNV-1a:
+    std::size_t hash = 2166136261u;
+    for (UInt i = 0; i < record.length; ++i)
+    {
+      hash ^= (unsigned char)seq[i];
+      hash *= 16777619u;
+    }
+    return hash;
+  }
+
+  bool DigestedPeptideTable::RecordEqual::operator()(Size left, Size right) const
+  {
+    const PeptideRecord& left_record = table->records_[left];
+    const PeptideRecord& right_record = table->records_[right];
+    return (left_record.length == right_record.length) &&
+           (table->sequences_.compare(left_record.offset, left_record.length,
+                                      table->sequences_, right_record.offset,
+                                      right_record.length) == 0);
+  }
+
+
+  DigestedPeptideTable::DigestedPeptideTable(const EnzymaticDigestion& digestion, Size min_length, Size max_length) :
+    digestion_(digestion),
+    min_length_(min_length),
+    max_length_(max_length),
+    protein_count_(0),
+    sequences_(),
+    records_(),
+    unique_(0, RecordHash(this), RecordEqual(this)),
+    residue_masses_(256, -1.0)
+  {
+    // ResidueDB is not thread-safe - look up all residues now:
+    const ResidueDB* residue_db = ResidueDB::getInstance();
+    for (Size c = 0; c < residue_masses_.size(); ++c)
+    {
+      const Residue* residue = residue_db->getResidue((unsigned char)c);
+      if (residue != 0)
+      {
+        residue_masses_[c] = residue->getMonoWeight(Residue::Internal);
+      }
+    }
+  }
+
+  DigestedPeptideTable::~DigestedPeptideTable()
+  {
+  }
+
+  Size DigestedPeptideTable::addProteins(const vector<String>& proteins)
+  {
+    // digest in parallel:
+    vector<vector<pair<Size, Size> > > digests(proteins.size());
+    vector<vector<double> > masses(proteins.size());
+    ParallelExceptionCollector errors;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)proteins.size(); ++i)
+    {
+      if (errors.hasErrorBefore(i)) continue;
+      try
+      {
+        const String& protein = proteins[i];
+        vector<pair<Size, Size> > peptides;
+        digestion_.digestUnmodifiedString(protein, peptides, min_length_, max_length_);
+
+        // masses via prefix sums; skip peptides with unknown residues (prefix counts of unknown residues):
+        vector<double> prefix(protein.size() + 1, 0.0);
+        vector<Size> unknown(protein.size() + 1, 0);
+        for (Size pos = 0; pos < protein.size(); ++pos)
+        {
+          double mass = residue_masses_[(unsigned char)protein[pos]];
+          prefix[pos + 1] = prefix[pos] + max(mass, 0.0);
+          unknown[pos + 1] = unknown[pos] + (mass < 0.0 ? 1 : 0);
+        }
+        for (Size p = 0; p < peptides.size(); ++p)
+        {
+          Size begin = peptides[p].first, end = begin + peptides[p].second;
+          if (unknown[end] != unknown[begin]) continue;
+          digests[i].push_back(peptides[p]);
+          masses[i].push_back(prefix[end] - prefix[begin] + Residue::getInternalToFullMonoWeight());
+        }
+      }
+      catch (...) // exceptions must not leave the parallel region
+      {
+        errors.capture(i);
+      }
+    }
+    errors.rethrow();
+
+    // merge (sequentially, to keep the table independent of the thread count):
+    Size old_size = records_.size();
+    for (Size i = 0; i < proteins.size(); ++i, ++protein_count_)
+    {
+      const String& protein = proteins[i];
+      for (Size p = 0; p < digests[i].size(); ++p)
+      {
+        // append tentatively, remove again if the peptide is known already:
+        PeptideRecord record;
+        record.offset = sequences_.size();
+        record.length = digests[i][p].second;
+        record.protein = protein_count_;
+        record.position = digests[i][p].first;
+        record.mass = masses[i][p];
+        sequences_.append(protein, record.position, record.length);
+        records_.push_back(record);
+        if (!unique_.insert(records_.size() - 1).second)
+        {
+          records_.pop_back();
+          sequences_.resize(record.offset);
+        }
+      }
+    }
+    return records_.size() - old_size;
+  }
+
+  Size DigestedPeptideTable::addFASTAFile(const String& filename, Size batch_size)
+  {
+    MappedFASTAFile file;
+    file.open(filename);
+    MappedFASTAFile::Entry entry;
+    vector<String> batch;
+    batch.reserve(batch_size);
+    Size count = 0;
+    while (file.readNext(entry))
+    {
+      batch.push_back(String());
+      entry.getSequence(batch.back());
+      if (batch.size() >= batch_size)
+      {
+        count += batch.size();
+        addProteins(batch);
+        batch.clear();
+      }
+    }
+    count += batch.size();
+    addProteins(batch);
+    return count;
+  }
+
+  Size DigestedPeptideTable::size() const
+  {
+    return records_.size();
+  }
+
+  Size DigestedPeptideTable::getProteinCount() const
+  {
+    return protein_count_;
+  }
+
+  const DigestedPeptideTable::PeptideRecord& DigestedPeptideTable::getRecord(Size index) const
+  {
+    if (index >= records_.size())
+    {
+      throw Exception::IndexOverflow(__FILE__, __LINE__, __PRETTY_FUNCTION__, index, records_.size());
+    }
+    return records_[index];
+  }
+
+  String DigestedPeptideTable::getSequence(Size index) const
+  {
+    const PeptideRecord& record = getRecord(index);
+    return String(sequences_.substr(record.offset, record.length));
+  }
+
+  void DigestedPeptideTable::clear()
+  {
+    unique_.clear();
+    records_.clear();
+    sequences_.clear();
+    protein_count_ = 0;
+  }
+
+} // namespace OpenMS
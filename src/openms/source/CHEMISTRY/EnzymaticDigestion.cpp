@@ -225,6 +225,51 @@ namespace OpenMS
     }
   }
 
+  bool EnzymaticDigestion::isCleavageSite_(const String& sequence, Size pos) const
+  {
+    const char aa = sequence[pos];
+
+    switch (enzyme_)
+    {
+    case ENZYME_TRYPSIN:
+      if (aa != 'R' && aa != 'K') // wait for R or K
+      {
+        return false;
+      }
+      if (use_log_model_)
+      {
+        double score_cleave = 0, score_missed = 0;
+        for (SignedSize i = 0; i < 9; ++i)
+        {
+          SignedSize current = (SignedSize)pos - 4 + i;
+          if ((current >= 0) && (current < (SignedSize)sequence.size()))
+          {
+            BindingSite bs(i, String(sequence[current]));
+            Map<BindingSite, CleavageModel>::const_iterator pos_it =
+              model_data_.find(bs);
+            if (pos_it != model_data_.end()) // no data for non-std. amino acids
+            {
+              score_cleave += pos_it->second.p_cleave;
+              score_missed += pos_it->second.p_miss;
+            }
+          }
+        }
+        return score_missed - score_cleave > log_model_threshold_;
+      }
+      // R or K at the end and not P afterwards
+      return (pos + 1 == sequence.size()) || (sequence[pos + 1] != 'P');
+    case ENZYME_TRYPSIN_P:
+      if (use_log_model_)
+      {
+        throw Exception::InvalidParameter(__FILE__, __LINE__, __PRETTY_FUNCTION__, String("EnzymaticDigestion: enzyme '") + NamesOfEnzymes[ENZYME_TRYPSIN_P] + " does not support logModel!");
+      }
+      // R or K at the end,  presence of P does not matter
+      return (aa == 'R' || aa == 'K');
+    default:
+      return false;
+    }
+  }
+
   void EnzymaticDigestion::nextCleavageSite_(const AASequence& protein, AASequence::ConstIterator& iterator) const
   {
     while (iterator != protein.end())
@@ -381,4 +426,38 @@ namespace OpenMS
     }
   }
 
+  Size EnzymaticDigestion::digestUnmodifiedString(const String& sequence, vector<pair<Size, Size> >& output, Size min_length, Size max_length) const
+  {
+    output.clear();
+
+    SignedSize missed_cleavages = missed_cleavages_;
+    if (use_log_model_)
+      missed_cleavages = 0; // log model has missed cleavages build-in
+
+    // peptide boundaries (a cleavage after the last residue does not count):
+    vector<Size> boundaries(1, 0);
+    for (Size pos = 0; pos + 1 < sequence.size(); ++pos)
+    {
+      if (isCleavageSite_(sequence, pos)) boundaries.push_back(pos + 1);
+    }
+    boundaries.push_back(sequence.size());
+
+    // fragments with 0, 1, ... missed cleavages (same order as in digest()):
+    Size discarded = 0;
+    for (SignedSize i = 0; (i <= missed_cleavages) && (i + 1 < (SignedSize)boundaries.size()); ++i)
+    {
+      for (Size b = 0; b + i + 1 < boundaries.size(); ++b)
+      {
+        Size length = boundaries[b + i + 1] - boundaries[b];
+        if ((length < min_length) || ((max_length > 0) && (length > max_length)))
+        {
+          ++discarded;
+          continue;
+        }
+        output.push_back(make_pair(boundaries[b], length));
+      }
+    }
+    return discarded;
+  }
+
 } //namespace
@@ -0,0 +1,238 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ParallelExceptionCollector.h>
+#include <OpenMS/CONCEPT/Exception.h>
+
+#include <new>
+#include <stdexcept>
+#include <typeinfo>
+
+namespace OpenMS
+{
+
+  ParallelExceptionCollector::ParallelExceptionCollector() :
+    holder_(0),
+    index_(0),
+    has_error_(false)
+  {
+  }
+
+  ParallelExceptionCollector::~ParallelExceptionCollector()
+  {
+    delete holder_;
+  }
+
+  void ParallelExceptionCollector::capture(Size index)
+  {
+    if (hasErrorBefore(index + 1)) return; // an earlier item failed already, avoid copying the exception
+
+    Holder* holder = 0;
+    try
+    {
+      holder = currentException_();
+    }
+    catch (...)
+    {
+      // copying the exception failed (out of memory), rethrow() then throws std::bad_alloc
+      holder = 0;
+    }
+    store_(index, holder);
+  }
+
+  void ParallelExceptionCollector::store_(Size index, Holder* holder)
+  {
+    bool stored = false;
+#ifdef _OPENMP
+#pragma omp critical (ParallelExceptionCollector)
+#endif
+    {
+      if (!has_error_ || index < index_)
+      {
+        delete holder_;
+        holder_ = holder;
+        index_ = index;
+        has_error_ = true;
+        stored = true;
+      }
+    }
+    if (!stored) delete holder;
+  }
+
+  bool ParallelExceptionCollector::hasError() const
+  {
+    bool has_error;
+#ifdef _OPENMP
+#pragma omp critical (ParallelExceptionCollector)
+#endif
+    has_error = has_error_;
+    return has_error;
+  }
+
+  bool ParallelExceptionCollector::hasErrorBefore(Size index) const
+  {
+    bool has_error;
+#ifdef _OPENMP
+#pragma omp critical (ParallelExceptionCollector)
+#endif
+    has_error = has_error_ && index_ < index;
+    return has_error;
+  }
+
+  Size ParallelExceptionCollector::getErrorIndex() const
+  {
+    Size index;
+#ifdef _OPENMP
+#pragma omp critical (ParallelExceptionCollector)
+#endif
+    index = index_;
+    return index;
+  }
+
+  void ParallelExceptionCollector::rethrow()
+  {
+    Holder* holder = 0;
+    bool has_error = false;
+#ifdef _OPENMP
+#pragma omp critical (ParallelExceptionCollector)
+#endif
+    {
+      holder = holder_;
+      has_error = has_error_;
+      holder_ = 0;
+      index_ = 0;
+      has_error_ = false;
+    }
+    if (!has_error) return;
+    if (holder == 0) throw std::bad_alloc();
+
+    try
+    {
+      holder->rethrow();
+    }
+    catch (...)
+    {
+      delete holder;
+      throw;
+    }
+  }
+
+  void ParallelExceptionCollector::clear()
+  {
+#ifdef _OPENMP
+#pragma omp critical (ParallelExceptionCollector)
+#endif
+    {
+      delete holder_;
+      holder_ = 0;
+      index_ = 0;
+      has_error_ = false;
+    }
+  }
+
+// derived classes have to be listed before their base classes
+#define OPENMS_COPY_EXCEPTION(ExceptionType) \
+  catch (const ExceptionType& e) \
+  { \
+    return new TypedHolder<ExceptionType>(e); \
+  }
+
+  ParallelExceptionCollector::Holder* ParallelExceptionCollector::currentException_()
+  {
+    try
+    {
+      throw;
+    }
+    OPENMS_COPY_EXCEPTION(Exception::Precondition)
+    OPENMS_COPY_EXCEPTION(Exception::Postcondition)
+    OPENMS_COPY_EXCEPTION(Exception::MissingInformation)
+    OPENMS_COPY_EXCEPTION(Exception::IndexUnderflow)
+    OPENMS_COPY_EXCEPTION(Exception::SizeUnderflow)
+    OPENMS_COPY_EXCEPTION(Exception::IndexOverflow)
+    OPENMS_COPY_EXCEPTION(Exception::FailedAPICall)
+    OPENMS_COPY_EXCEPTION(Exception::InvalidRange)
+    OPENMS_COPY_EXCEPTION(Exception::InvalidSize)
+    OPENMS_COPY_EXCEPTION(Exception::OutOfRange)
+    OPENMS_COPY_EXCEPTION(Exception::InvalidValue)
+    OPENMS_COPY_EXCEPTION(Exception::InvalidParameter)
+    OPENMS_COPY_EXCEPTION(Exception::ConversionError)
+    OPENMS_COPY_EXCEPTION(Exception::IllegalSelfOperation)
+    OPENMS_COPY_EXCEPTION(Exception::NullPointer)
+    OPENMS_COPY_EXCEPTION(Exception::InvalidIterator)
+    OPENMS_COPY_EXCEPTION(Exception::IncompatibleIterators)
+    OPENMS_COPY_EXCEPTION(Exception::NotImplemented)
+    OPENMS_COPY_EXCEPTION(Exception::IllegalTreeOperation)
+    OPENMS_COPY_EXCEPTION(Exception::OutOfMemory)
+    OPENMS_COPY_EXCEPTION(Exception::BufferOverflow)
+    OPENMS_COPY_EXCEPTION(Exception::DivisionByZero)
+    OPENMS_COPY_EXCEPTION(Exception::OutOfGrid)
+    OPENMS_COPY_EXCEPTION(Exception::FileNotFound)
+    OPENMS_COPY_EXCEPTION(Exception::FileNotReadable)
+    OPENMS_COPY_EXCEPTION(Exception::FileNotWritable)
+    OPENMS_COPY_EXCEPTION(Exception::IOException)
+    OPENMS_COPY_EXCEPTION(Exception::FileEmpty)
+    OPENMS_COPY_EXCEPTION(Exception::IllegalPosition)
+    OPENMS_COPY_EXCEPTION(Exception::ParseError)
+    OPENMS_COPY_EXCEPTION(Exception::UnableToCreateFile)
+    OPENMS_COPY_EXCEPTION(Exception::IllegalArgument)
+    OPENMS_COPY_EXCEPTION(Exception::ElementNotFound)
+    OPENMS_COPY_EXCEPTION(Exception::UnableToFit)
+    OPENMS_COPY_EXCEPTION(Exception::UnableToCalibrate)
+    OPENMS_COPY_EXCEPTION(Exception::DepletedIDPool)
+    OPENMS_COPY_EXCEPTION(Exception::BaseException)
+    OPENMS_COPY_EXCEPTION(std::bad_alloc)
+    OPENMS_COPY_EXCEPTION(std::bad_cast)
+    OPENMS_COPY_EXCEPTION(std::out_of_range)
+    OPENMS_COPY_EXCEPTION(std::invalid_argument)
+    OPENMS_COPY_EXCEPTION(std::length_error)
+    OPENMS_COPY_EXCEPTION(std::domain_error)
+    OPENMS_COPY_EXCEPTION(std::logic_error)
+    OPENMS_COPY_EXCEPTION(std::range_error)
+    OPENMS_COPY_EXCEPTION(std::overflow_error)
+    OPENMS_COPY_EXCEPTION(std::underflow_error)
+    OPENMS_COPY_EXCEPTION(std::runtime_error)
+    catch (const std::exception& e)
+    {
+      return new TypedHolder<std::runtime_error>(std::runtime_error(e.what()));
+    }
+    catch (...)
+    {
+      return new TypedHolder<std::runtime_error>(std::runtime_error("unknown exception"));
+    }
+    return 0; // not reached
+  }
+
+#undef OPENMS_COPY_EXCEPTION
+
+} // namespace OpenMS
@@ -38,6 +38,7 @@
 
 #include <OpenMS/DATASTRUCTURES/String.h>
 
+#include <OpenMS/SYSTEM/Profiler.h>
 #include <OpenMS/SYSTEM/StopWatch.h>
 
 #include <QtCore/QString>
@@ -185,14 +186,16 @@ public:
 
   ProgressLogger::ProgressLogger() :
     type_(NONE),
-    last_invoke_()
+    last_invoke_(),
+    profiler_scopes_()
   {
     current_logger_ = Factory<ProgressLogger::ProgressLoggerImpl>::create(logTypeToFactoryName_(type_));
   }
 
   ProgressLogger::ProgressLogger(const ProgressLogger& other) :
     type_(other.type_),
-    last_invoke_(other.last_invoke_)
+    last_invoke_(other.last_invoke_),
+    profiler_scopes_() // the stages belong to the progress of other
   {
     // recreate our logger
     current_logger_ = Factory<ProgressLogger::ProgressLoggerImpl>::create(logTypeToFactoryName_(type_));
@@ -239,6 +242,7 @@ public:
     last_invoke_ = time(NULL);
     current_logger_->startProgress(begin, end, label, recursion_depth_);
     ++recursion_depth_;
+    profiler_scopes_.push_back(Profiler::startScope(label));
   }
 
   void ProgressLogger::setProgress(SignedSize value) const
@@ -248,6 +252,7 @@ public:
 
     last_invoke_ = time(NULL);
     current_logger_->setProgress(value, recursion_depth_);
+    Profiler::sampleMemory();
   }
 
   void ProgressLogger::endProgress() const
@@ -256,6 +261,12 @@ public:
     {
       --recursion_depth_;
     }
+    // close the stage of this logger, even if other loggers ended theirs in a different order
+    if (!profiler_scopes_.empty())
+    {
+      Profiler::endScope(profiler_scopes_.back());
+      profiler_scopes_.pop_back();
+    }
     current_logger_->endProgress(recursion_depth_);
   }
 
@@ -10,6 +10,7 @@ FuzzyStringComparator.cpp
 GlobalExceptionHandler.cpp
 LogConfigHandler.cpp
 LogStream.cpp
+ParallelExceptionCollector.cpp
 PrecisionWrapper.cpp
 ProgressLogger.cpp
 SingletonRegistry.cpp
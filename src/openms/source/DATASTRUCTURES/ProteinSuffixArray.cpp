@@ -0,0 +1,546 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/DATASTRUCTURES/ProteinSuffixArray.h>
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <QtCore/QFile>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+namespace OpenMS
+{
+  namespace
+  {
+    /// Magic bytes at the beginning of index files (includes format version)
+    const char INDEX_MAGIC[8] = {'O', 'M', 'S', '_', 'P', 'S', 'A', '2'};
+
+    /// Separator between protein sequences in the text (terminates each sequence like a C string)
+    const char SEPARATOR = '\0';
+
+    /// Rounds up to a multiple of 8 (for alignment of the data blocks)
+    UInt64 align8(UInt64 offset)
+    {
+      return (offset + 7) & ~UInt64(7);
+    }
+
+    /// Compares suffixes by the rank of the suffix @p h positions further
+    struct SuffixRankLess
+    {
+      const UInt* rank;
+      Size h, n;
+
+      SuffixRankLess(const UInt* rank_, Size h_, Size n_) :
+        rank(rank_), h(h_), n(n_)
+      {
+      }
+
+      UInt key(UInt pos) const
+      {
+        // the end of the text sorts before everything else:
+        return (pos + h < n) ? rank[pos + h] + 1 : 0;
+      }
+
+      bool operator()(UInt left, UInt right) const
+      {
+        return key(left) < key(right);
+      }
+    };
+  }
+
+
+  ProteinSuffixArray::ProteinSuffixArray() :
+    text_data_(), suffixes_data_(), starts_data_(1, 0), names_data_(),
+    name_starts_data_(1, 0), file_(0), text_(0), text_length_(0), 
+    suffixes_(0), suffixes_length_(0), starts_(&(starts_data_[0])), 
+    n_proteins_(0), names_(names_data_.c_str()),
+    name_starts_(&(name_starts_data_[0]))
+  {
+  }
+
+
+  ProteinSuffixArray::~ProteinSuffixArray()
+  {
+    unmap_();
+  }
+
+
+  void ProteinSuffixArray::unmap_()
+  {
+    if (file_ != 0)
+    {
+      file_->close(); // also unmaps the memory
+      delete file_;
+      file_ = 0;
+    }
+  }
+
+
+  void ProteinSuffixArray::normalizeSequence(String& seq)
+  {
+    static const char* residues = "ACDEFGHIKLMNPQRSTVWYBZX";
+    for (String::iterator it = seq.begin(); it != seq.end(); ++it)
+    {
+      char c = toupper(*it);
+      *it = ((c != '\0') && strchr(residues, c)) ? c : 'X';
+    }
+  }
+
+
+  void ProteinSuffixArray::build(const vector<String>& proteins,
+                                 const vector<String>& names)
+  {
+    if (!names.empty() && (names.size() != proteins.size()))
+    {
+      throw Exception::InvalidParameter(__FILE__, __LINE__, 
+                                        __PRETTY_FUNCTION__, "Number of "
+                                        "names doesn't match number of "
+                                        "proteins");
+    }
+    // concatenate sequences:
+    UInt64 total_length = 0, names_length = 0;
+    for (vector<String>::const_iterator it = proteins.begin();
+         it != proteins.end(); ++it)
+    {
+      total_length += it->size() + 1;
+    }
+    for (vector<String>::const_iterator it = names.begin(); it != names.end();
+         ++it)
+    {
+      names_length += it->size() + 1;
+    }
+    if (total_length >= UInt64(UInt(-1)))
+    {
+      throw Exception::InvalidSize(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+                                   total_length);
+    }
+    if (names_length >= UInt64(UInt(-1)))
+    {
+      throw Exception::InvalidSize(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+                                   names_length);
+    }
+    unmap_();
+
+    // concatenate names (each null-terminated):
+    names_data_.clear();
+    names_data_.reserve(names_length);
+    name_starts_data_.clear();
+    name_starts_data_.reserve(proteins.size() + 1);
+    for (Size i = 0; i < proteins.size(); ++i)
+    {
+      name_starts_data_.push_back(names_data_.size());
+      if (!names.empty()) names_data_ += names[i];
+      names_data_ += '\0';
+    }
+    name_starts_data_.push_back(names_data_.size());
+    text_data_.clear();
+    text_data_.reserve(total_length);
+    starts_data_.clear();
+    starts_data_.reserve(proteins.size() + 1);
+    for (vector<String>::const_iterator it = proteins.begin();
+         it != proteins.end(); ++it)
+    {
+      starts_data_.push_back(text_data_.size());
+      String seq = *it;
+      normalizeSequence(seq);
+      text_data_ += seq;
+      text_data_ += SEPARATOR;
+    }
+    starts_data_.push_back(text_data_.size());
+    const Size n = text_data_.size();
+
+    // suffix sorting by prefix doubling: first bucket suffixes by their
+    // initial "k" characters, then repeatedly sort the groups of suffixes that
+    // are still tied by the rank of the suffix "h" positions further on
+    // (doubling "h" each time); the rank of a suffix is the last index of its
+    // group in the suffix array.
+    // initial bucketing - map characters to consecutive codes (0 is reserved
+    // for the end of the text) and combine as many as reasonable into a key:
+    vector<UInt> codes(256, 0);
+    for (Size i = 0; i < n; ++i) codes[(unsigned char)text_data_[i]] = 1;
+    UInt sigma = 1;
+    for (Size c = 0; c < codes.size(); ++c)
+    {
+      if (codes[c]) codes[c] = sigma++;
+    }
+    Size k = 1;
+    UInt n_buckets = sigma;
+    while ((k < 8) && (n_buckets * sigma <= (1u << 22)))
+    {
+      n_buckets *= sigma;
+      ++k;
+    }
+    vector<UInt> sa(n), rank(n); // rank holds the bucket key for now
+    for (Size i = 0; i < n; ++i)
+    {
+      UInt key = 0;
+      for (Size j = i; j < i + k; ++j)
+      {
+        key = key * sigma + ((j < n) ? codes[(unsigned char)text_data_[j]] : 0);
+      }
+      rank[i] = key;
+    }
+    vector<UInt> counts(n_buckets + 1, 0);
+    for (Size i = 0; i < n; ++i) ++counts[rank[i] + 1];
+    for (Size b = 1; b < counts.size(); ++b) counts[b] += counts[b - 1];
+    // now "counts[b]" is the start of bucket "b":
+    for (Size i = 0; i < n; ++i) sa[counts[rank[i]]++] = i;
+    // ... and now it's the end of the bucket:
+    vector<pair<UInt, UInt> > groups; // ranges in the suffix array
+    for (Size i = 0; i < n; )
+    {
+      Size end = counts[rank[sa[i]]];
+      if (end - i > 1) groups.push_back(make_pair(i, end));
+      i = end;
+    }
+    for (Size i = 0; i < n; ++i) rank[i] = counts[rank[i]] - 1;
+    counts.clear();
+
+    vector<UInt> keys(n);
+    for (Size h = k; !groups.empty(); h *= 2)
+    {
+      SuffixRankLess less(&(rank[0]), h, n);
+      // ranks don't change while groups are sorted, so this is independent:
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+      for (SignedSize g = 0; g < (SignedSize)groups.size(); ++g)
+      {
+        sort(sa.begin() + groups[g].first, sa.begin() + groups[g].second,
+             less);
+        for (Size i = groups[g].first; i < groups[g].second; ++i)
+        {
+          keys[i] = less.key(sa[i]);
+        }
+      }
+      // split groups according to the new keys and update ranks:
+      vector<pair<UInt, UInt> > next_groups;
+      for (vector<pair<UInt, UInt> >::iterator g_it = groups.begin();
+           g_it != groups.end(); ++g_it)
+      {
+        for (Size i = g_it->first; i < g_it->second; )
+        {
+          Size end = i + 1;
+          while ((end < g_it->second) && (keys[end] == keys[i])) ++end;
+          for (Size j = i; j < end; ++j) rank[sa[j]] = end - 1;
+          if (end - i > 1) next_groups.push_back(make_pair(i, end));
+          i = end;
+        }
+      }
+      groups.swap(next_groups);
+    }
+
+    // suffixes starting with a separator can't match peptides - leave out:
+    suffixes_data_.clear();
+    suffixes_data_.reserve(n - proteins.size());
+    for (Size i = 0; i < n; ++i)
+    {
+      if (text_data_[sa[i]] != SEPARATOR) suffixes_data_.push_back(sa[i]);
+    }
+
+    text_ = text_data_.c_str();
+    text_length_ = n;
+    suffixes_ = suffixes_data_.empty() ? 0 : &(suffixes_data_[0]);
+    suffixes_length_ = suffixes_data_.size();
+    starts_ = &(starts_data_[0]);
+    n_proteins_ = proteins.size();
+    names_ = names_data_.c_str();
+    name_starts_ = &(name_starts_data_[0]);
+  }
+
+
+  void ProteinSuffixArray::store(const String& filename,
+                                 const String& signature) const
+  {
+    // other processes may have memory-mapped the file, so don't overwrite it
+    // in place - write a temporary file and rename it:
+    const String tmp_filename = filename + ".tmp." + File::getUniqueName();
+    ofstream out(tmp_filename.c_str(), ios::out | ios::binary | ios::trunc);
+    if (!out)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__,
+                                          __PRETTY_FUNCTION__, filename);
+    }
+    const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    UInt64 header[5] = {signature.size(), n_proteins_, text_length_,
+                        suffixes_length_, name_starts_[n_proteins_]};
+    out.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    UInt64 offset = sizeof(INDEX_MAGIC) + sizeof(header);
+    // data blocks, each aligned to 8 bytes:
+    const char* blocks[6] = {signature.c_str(), 
+                             reinterpret_cast<const char*>(starts_), text_,
+                             reinterpret_cast<const char*>(suffixes_),
+                             reinterpret_cast<const char*>(name_starts_),
+                             names_};
+    UInt64 sizes[6] = {signature.size(), (n_proteins_ + 1) * sizeof(UInt),
+                       text_length_, suffixes_length_ * sizeof(UInt),
+                       (n_proteins_ + 1) * sizeof(UInt), header[4]};
+    for (Size i = 0; i < 6; ++i)
+    {
+      if (sizes[i] > 0) out.write(blocks[i], sizes[i]);
+      offset += sizes[i];
+      out.write(padding, align8(offset) - offset);
+      offset = align8(offset);
+    }
+    out.close();
+    if (!out || !File::rename(tmp_filename, filename))
+    {
+      File::remove(tmp_filename);
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__,
+                                          __PRETTY_FUNCTION__, filename);
+    }
+  }
+
+
+  bool ProteinSuffixArray::load(const String& filename, 
+                                const String& signature)
+  {
+    QFile* file = new QFile(filename.toQString());
+    if (!file->exists())
+    {
+      delete file;
+      return false;
+    }
+    if (!file->open(QIODevice::ReadOnly))
+    {
+      delete file;
+      throw Exception::FileNotReadable(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+                                       filename);
+    }
+    const UInt64 file_size = file->size();
+    UInt64 header[5];
+    UInt64 offset = sizeof(INDEX_MAGIC) + sizeof(header);
+    const uchar* data = 0;
+    if (file_size >= offset) data = file->map(0, file_size);
+    if ((data == 0) || memcmp(data, INDEX_MAGIC, sizeof(INDEX_MAGIC)))
+    {
+      delete file; // closes and unmaps
+      return false;
+    }
+    memcpy(header, data + sizeof(INDEX_MAGIC), sizeof(header));
+    UInt64 sizes[6] = {header[0], (header[1] + 1) * sizeof(UInt), header[2],
+                       header[3] * sizeof(UInt), 
+                       (header[1] + 1) * sizeof(UInt), header[4]};
+    const uchar* blocks[6];
+    for (Size i = 0; i < 6; ++i)
+    {
+      blocks[i] = data + offset;
+      offset = align8(offset + sizes[i]);
+    }
+    if ((offset > file_size) || (header[0] != signature.size()) ||
+        (signature.compare(0, string::npos, 
+                           reinterpret_cast<const char*>(blocks[0]),
+                           header[0]) != 0))
+    {
+      delete file;
+      return false; // incomplete file or different signature
+    }
+
+    unmap_();
+    text_data_.clear();
+    suffixes_data_.clear();
+    starts_data_.clear();
+    names_data_.clear();
+    name_starts_data_.clear();
+    file_ = file;
+    n_proteins_ = header[1];
+    starts_ = reinterpret_cast<const UInt*>(blocks[1]);
+    text_length_ = header[2];
+    text_ = reinterpret_cast<const char*>(blocks[2]);
+    suffixes_length_ = header[3];
+    suffixes_ = reinterpret_cast<const UInt*>(blocks[3]);
+    name_starts_ = reinterpret_cast<const UInt*>(blocks[4]);
+    names_ = reinterpret_cast<const char*>(blocks[5]);
+    return true;
+  }
+
+
+  Size ProteinSuffixArray::size() const
+  {
+    return n_proteins_;
+  }
+
+
+  const char* ProteinSuffixArray::getProtein(Size index) const
+  {
+    if (index >= n_proteins_)
+    {
+      throw Exception::IndexOverflow(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+                                     index, n_proteins_);
+    }
+    return text_ + starts_[index]; // terminated by the separator
+  }
+
+
+  Size ProteinSuffixArray::getProteinLength(Size index) const
+  {
+    if (index >= n_proteins_)
+    {
+      throw Exception::IndexOverflow(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+                                     index, n_proteins_);
+    }
+    // leave out the separator at the end:
+    return starts_[index + 1] - starts_[index] - 1;
+  }
+
+
+  const char* ProteinSuffixArray::getName(Size index) const
+  {
+    if (index >= n_proteins_)
+    {
+      throw Exception::IndexOverflow(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+                                     index, n_proteins_);
+    }
+    return names_ + name_starts_[index];
+  }
+
+
+  char ProteinSuffixArray::charAt_(Size pos) const
+  {
+    return (pos < text_length_) ? text_[pos] : '\0';
+  }
+
+
+  void ProteinSuffixArray::narrow_(Size& first, Size& last, Size depth,
+                                   char c) const
+  {
+    const unsigned char uc = c;
+    // lower bound:
+    Size lo = first, hi = last;
+    while (lo < hi)
+    {
+      Size mid = lo + (hi - lo) / 2;
+      if ((unsigned char)charAt_(suffixes_[mid] + depth) < uc) lo = mid + 1;
+      else hi = mid;
+    }
+    first = lo;
+    // upper bound:
+    hi = last;
+    while (lo < hi)
+    {
+      Size mid = lo + (hi - lo) / 2;
+      if ((unsigned char)charAt_(suffixes_[mid] + depth) <= uc) lo = mid + 1;
+      else hi = mid;
+    }
+    last = lo;
+  }
+
+
+  void ProteinSuffixArray::addOccurrences_(Size first, Size last,
+                                           vector<Occurrence>& hits) const
+  {
+    for (Size i = first; i < last; ++i)
+    {
+      UInt pos = suffixes_[i];
+      Size protein = upper_bound(starts_, starts_ + n_proteins_, pos) - 
+        starts_ - 1;
+      hits.push_back(Occurrence(protein, pos - starts_[protein]));
+    }
+  }
+
+
+  void ProteinSuffixArray::findExact(const String& peptide,
+                                     vector<Occurrence>& hits) const
+  {
+    if (peptide.empty()) return;
+    Size first = 0, last = suffixes_length_;
+    for (Size depth = 0; (depth < peptide.size()) && (first < last); ++depth)
+    {
+      narrow_(first, last, depth, peptide[depth]);
+    }
+    addOccurrences_(first, last, hits);
+  }
+
+
+  void ProteinSuffixArray::findTolerant_(const String& peptide, Size depth,
+                                         Size aaa_left, Size first, Size last,
+                                         vector<Size>& ranges) const
+  {
+    if (depth == peptide.size())
+    {
+      ranges.push_back(first);
+      ranges.push_back(last);
+      return;
+    }
+    const char aa = peptide[depth];
+    // possible matching characters in the proteins (the ambiguous ones cost):
+    char candidates[4];
+    Size n_candidates = 0;
+    if ((aa == 'B') || (aa == 'Z') || (aa == 'X'))
+    {
+      if (aaa_left > 0) candidates[n_candidates++] = aa;
+    }
+    else
+    {
+      candidates[n_candidates++] = aa;
+      if (aaa_left > 0)
+      {
+        if ((aa == 'D') || (aa == 'N')) candidates[n_candidates++] = 'B';
+        if ((aa == 'E') || (aa == 'Q')) candidates[n_candidates++] = 'Z';
+        candidates[n_candidates++] = 'X';
+      }
+    }
+    for (Size i = 0; i < n_candidates; ++i)
+    {
+      Size sub_first = first, sub_last = last;
+      narrow_(sub_first, sub_last, depth, candidates[i]);
+      if (sub_first == sub_last) continue;
+      bool ambiguous = ((candidates[i] == 'B') || (candidates[i] == 'Z') ||
+                        (candidates[i] == 'X'));
+      findTolerant_(peptide, depth + 1, aaa_left - ambiguous, sub_first,
+                    sub_last, ranges);
+    }
+  }
+
+
+  void ProteinSuffixArray::findTolerant(const String& peptide, Size max_aaa,
+                                        vector<Occurrence>& hits) const
+  {
+    if (peptide.empty()) return;
+    vector<Size> ranges;
+    findTolerant_(peptide, 0, max_aaa, 0, suffixes_length_, ranges);
+    for (Size i = 0; i < ranges.size(); i += 2)
+    {
+      addOccurrences_(ranges[i], ranges[i + 1], hits);
+    }
+  }
+
+} // namespace OpenMS
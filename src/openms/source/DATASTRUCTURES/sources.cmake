@@ -30,6 +30,7 @@ Map.cpp
 MassExplainer.cpp
 Matrix.cpp
 Param.cpp
+ProteinSuffixArray.cpp
 QTCluster.cpp
 SparseVector.cpp
 String.cpp
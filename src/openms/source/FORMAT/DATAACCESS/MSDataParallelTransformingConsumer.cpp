@@ -0,0 +1,186 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/DATAACCESS/MSDataParallelTransformingConsumer.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/CONCEPT/ParallelExceptionCollector.h>
+#include <OpenMS/CONCEPT/LogStream.h>
+
+#include <algorithm>
+
+namespace OpenMS
+{
+
+  MSDataParallelTransformingConsumer::Transformation::~Transformation()
+  {
+  }
+
+  void MSDataParallelTransformingConsumer::Transformation::transformChromatogram(ChromatogramType & /* c */) const
+  {
+  }
+
+  MSDataParallelTransformingConsumer::MSDataParallelTransformingConsumer(const Transformation & transformation,
+                                                                         Interfaces::IMSDataConsumer<> * next, Size window_size) :
+    transformation_(transformation),
+    next_(next),
+    window_size_(std::max(window_size, Size(1)))
+  {
+  }
+
+  MSDataParallelTransformingConsumer::~MSDataParallelTransformingConsumer()
+  {
+    try
+    {
+      flush();
+    }
+    catch (std::exception& e) // do not throw from the destructor
+    {
+      LOG_ERROR << "Error while transforming the remaining data: " << e.what() << std::endl;
+    }
+    catch (...)
+    {
+      LOG_ERROR << "Unknown error while transforming the remaining data." << std::endl;
+    }
+  }
+
+  void MSDataParallelTransformingConsumer::setExpectedSize(Size expectedSpectra, Size expectedChromatograms)
+  {
+    next_->setExpectedSize(expectedSpectra, expectedChromatograms);
+  }
+
+  void MSDataParallelTransformingConsumer::setExperimentalSettings(const ExperimentalSettings & exp)
+  {
+    next_->setExperimentalSettings(exp);
+  }
+
+  void MSDataParallelTransformingConsumer::consumeSpectrum(SpectrumType & s)
+  {
+    // keep the order of spectra and chromatograms
+    flushChromatograms_();
+
+    pending_spectra_.push_back(s);
+    if (pending_spectra_.size() >= window_size_)
+    {
+      flushSpectra_();
+    }
+  }
+
+  void MSDataParallelTransformingConsumer::consumeChromatogram(ChromatogramType & c)
+  {
+    flushSpectra_();
+
+    pending_chromatograms_.push_back(c);
+    if (pending_chromatograms_.size() >= window_size_)
+    {
+      flushChromatograms_();
+    }
+  }
+
+  void MSDataParallelTransformingConsumer::flush()
+  {
+    // at most one of them is pending
+    flushSpectra_();
+    flushChromatograms_();
+  }
+
+  Size MSDataParallelTransformingConsumer::getWindowSize() const
+  {
+    return window_size_;
+  }
+
+  template <typename DataType>
+  void MSDataParallelTransformingConsumer::transformPending_(std::vector<DataType> & pending,
+                                                              void (Transformation::* transform)(DataType &) const)
+  {
+    ParallelExceptionCollector errors;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)pending.size(); ++i)
+    {
+      if (errors.hasErrorBefore(i)) continue;
+      try
+      {
+        (transformation_.*transform)(pending[i]);
+      }
+      catch (...) // exceptions must not leave the parallel region
+      {
+        errors.capture(i);
+      }
+    }
+
+    // the error of the first failing element is passed on with its original type
+    errors.rethrow();
+  }
+
+  void MSDataParallelTransformingConsumer::flushSpectra_()
+  {
+    if (pending_spectra_.empty()) return;
+
+    // take the window out first: if transforming or passing it on fails, it is dropped (and never passed on twice)
+    std::vector<SpectrumType> spectra;
+    spectra.swap(pending_spectra_);
+    transformPending_(spectra, &Transformation::transformSpectrum);
+
+    // pass on in the original order
+    for (Size i = 0; i < spectra.size(); ++i)
+    {
+      next_->consumeSpectrum(spectra[i]);
+    }
+
+    // reuse the buffer
+    spectra.clear();
+    pending_spectra_.swap(spectra);
+  }
+
+  void MSDataParallelTransformingConsumer::flushChromatograms_()
+  {
+    if (pending_chromatograms_.empty()) return;
+
+    // see flushSpectra_()
+    std::vector<ChromatogramType> chromatograms;
+    chromatograms.swap(pending_chromatograms_);
+    transformPending_(chromatograms, &Transformation::transformChromatogram);
+
+    for (Size i = 0; i < chromatograms.size(); ++i)
+    {
+      next_->consumeChromatogram(chromatograms[i]);
+    }
+
+    chromatograms.clear();
+    pending_chromatograms_.swap(chromatograms);
+  }
+
+} // namespace OpenMS
@@ -7,6 +7,7 @@ set(sources_list
   MSDataTransformingConsumer.cpp
   MSDataCachedConsumer.cpp
   MSDataChainingConsumer.cpp
+  MSDataParallelTransformingConsumer.cpp
   NoopMSDataConsumer.cpp
   SwathFileConsumer.cpp
 )
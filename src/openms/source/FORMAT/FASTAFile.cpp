@@ -38,6 +38,7 @@
 
 #include <OpenMS/CONCEPT/LogStream.h>
 
+#include <algorithm>
 #include <fstream>
 
 #include <seqan/basic.h>
@@ -137,21 +138,23 @@ namespace OpenMS
 
     for (vector<FASTAEntry>::const_iterator it = data.begin(); it != data.end(); ++it)
     {
-      outfile << ">" << it->identifier << " " << it->description << "\n";
+      writeEntry(outfile, *it);
+    }
+    outfile.close();
+  }
 
-      String tmp(it->sequence);
-      while (tmp.size() > 80) // surprisingly fast, even though its using erase(). For-loop with substr() is much SLOWER!
-      {
-        outfile << tmp.prefix(80) << "\n";
-        tmp.erase(0, 80);
-      }
+  void FASTAFile::writeEntry(std::ostream& os, const FASTAEntry& entry)
+  {
+    os << ">" << entry.identifier << " " << entry.description << "\n";
 
-      if (tmp.size() > 0)
-      {
-        outfile << tmp << "\n";
-      }
+    // write the sequence in lines of 80 characters (without copying it):
+    const Size line_length = 80;
+    for (Size pos = 0; pos < entry.sequence.size(); pos += line_length)
+    {
+      os.write(entry.sequence.c_str() + pos,
+               std::min(line_length, entry.sequence.size() - pos));
+      os << "\n";
     }
-    outfile.close();
   }
 
 } // namespace OpenMS
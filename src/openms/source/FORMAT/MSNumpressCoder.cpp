@@ -60,15 +60,16 @@ namespace OpenMS
     {
       size_t byteCount = 0;
 
-      // 1. Resize the data
+      // 1. Resize the data (to the largest size the encoding can produce, i.e.
+      //    at most 9 half-bytes per value for LINEAR and PIC)
       switch (config.np_compression)
       {
       case LINEAR:
-        numpressed.resize(dataSize * sizeof(std::vector<double>::value_type) + 8);
+        numpressed.resize(dataSize * 5 + 8);
         break;
 
       case PIC:
-        numpressed.resize(dataSize * sizeof(std::vector<double>::value_type));
+        numpressed.resize(dataSize * 5);
         break;
 
       case SLOF:
@@ -0,0 +1,233 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/MappedFASTAFile.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <QtCore/QFile>
+
+#include <cstring>
+
+using namespace std;
+
+namespace OpenMS
+{
+  namespace
+  {
+    inline bool isLineBreak(char c)
+    {
+      return (c == '\n') || (c == '\r');
+    }
+
+    inline bool isWhitespace(char c)
+    {
+      return (c == ' ') || (c == '\t') || (c == '\v') || (c == '\f') ||
+             isLineBreak(c);
+    }
+  }
+
+
+  MappedFASTAFile::Entry::Entry() :
+    header(0), header_length(0), sequence(0), sequence_length(0)
+  {
+  }
+
+
+  String MappedFASTAFile::Entry::getIdentifier() const
+  {
+    const char* begin = header;
+    const char* end = header + header_length;
+    while ((begin != end) && isWhitespace(*begin)) ++begin;
+    const char* pos = begin;
+    while ((pos != end) && (*pos != ' ') && (*pos != '\t') && (*pos != '\v'))
+    {
+      ++pos;
+    }
+    return String(begin, pos);
+  }
+
+
+  String MappedFASTAFile::Entry::getDescription() const
+  {
+    // same as in FASTAFile::load(): trim, then split at first whitespace
+    String id(header, header + header_length);
+    id.trim();
+    String::size_type position = id.find_first_of(" \v\t");
+    if (position == String::npos) return "";
+    return id.suffix(id.size() - position - 1);
+  }
+
+
+  void MappedFASTAFile::Entry::getSequence(String& seq) const
+  {
+    seq.clear();
+    seq.reserve(sequence_length);
+    for (const char* pos = sequence; pos != sequence + sequence_length; ++pos)
+    {
+      if (!isWhitespace(*pos)) seq += *pos;
+    }
+  }
+
+
+  FASTAFile::FASTAEntry MappedFASTAFile::Entry::toFASTAEntry() const
+  {
+    FASTAFile::FASTAEntry entry(getIdentifier(), getDescription(), "");
+    getSequence(entry.sequence);
+    return entry;
+  }
+
+
+  MappedFASTAFile::MappedFASTAFile() :
+    file_(0), filename_(), data_(0), size_(0), position_(0)
+  {
+  }
+
+
+  MappedFASTAFile::~MappedFASTAFile()
+  {
+    close();
+  }
+
+
+  void MappedFASTAFile::open(const String& filename)
+  {
+    close();
+    if (!File::exists(filename))
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+                                    filename);
+    }
+    file_ = new QFile(filename.toQString());
+    if (!file_->open(QIODevice::ReadOnly))
+    {
+      close();
+      throw Exception::FileNotReadable(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+                                       filename);
+    }
+    filename_ = filename;
+    size_ = file_->size();
+    if (size_ > 0) // an empty file can't be mapped, but that's not an error
+    {
+      data_ = reinterpret_cast<const char*>(file_->map(0, size_));
+      if (data_ == 0)
+      {
+        close();
+        throw Exception::FileNotReadable(__FILE__, __LINE__,
+                                         __PRETTY_FUNCTION__, filename);
+      }
+    }
+  }
+
+
+  void MappedFASTAFile::close()
+  {
+    if (file_ != 0)
+    {
+      file_->close(); // also unmaps the memory
+      delete file_;
+      file_ = 0;
+    }
+    filename_.clear();
+    data_ = 0;
+    size_ = 0;
+    position_ = 0;
+  }
+
+
+  bool MappedFASTAFile::isOpen() const
+  {
+    return file_ != 0;
+  }
+
+
+  bool MappedFASTAFile::readNext(Entry& entry)
+  {
+    // skip whitespace before the first entry:
+    while ((position_ < size_) && (data_[position_] != '>'))
+    {
+      if (!isWhitespace(data_[position_]))
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
+                                    "", "Error while parsing FASTA file '" +
+                                    filename_ + "'! Expected '>' at position " +
+                                    String(position_) + ".");
+      }
+      ++position_;
+    }
+    if (position_ >= size_) return false;
+
+    // header line:
+    Size start = ++position_;
+    while ((position_ < size_) && !isLineBreak(data_[position_])) ++position_;
+    entry.header = data_ + start;
+    entry.header_length = position_ - start;
+
+    // sequence lines - up to the next '>' at the beginning of a line:
+    start = position_;
+    while (position_ < size_)
+    {
+      const void* next = memchr(data_ + position_, '>', size_ - position_);
+      if (next == 0)
+      {
+        position_ = size_;
+        break;
+      }
+      position_ = static_cast<const char*>(next) - data_;
+      if (isLineBreak(data_[position_ - 1])) break;
+      ++position_; // not a header - keep looking
+    }
+    entry.sequence = data_ + start;
+    entry.sequence_length = position_ - start;
+    return true;
+  }
+
+
+  void MappedFASTAFile::reset()
+  {
+    position_ = 0;
+  }
+
+
+  Size MappedFASTAFile::getPosition() const
+  {
+    return position_;
+  }
+
+
+  Size MappedFASTAFile::getFileSize() const
+  {
+    return size_;
+  }
+
+} // namespace OpenMS
@@ -53,6 +53,8 @@ namespace OpenMS
     mz_range_(),
     intensity_range_(),
     ms_levels_(),
+    has_spectrum_indices_(false),
+    spectrum_indices_(),
     zlib_compression_(false),
     size_only_(false),
     always_append_data_(false),
@@ -61,6 +63,7 @@ namespace OpenMS
     sort_chromatograms_by_rt_(true),
     fill_data_(true),
     write_index_(false),
+    write_spectrum_meta_index_(false),
     np_config_mz_(),
     np_config_int_(),
     maximal_data_pool_size_(100)
@@ -79,6 +82,8 @@ namespace OpenMS
     mz_range_(options.mz_range_),
     intensity_range_(options.intensity_range_),
     ms_levels_(options.ms_levels_),
+    has_spectrum_indices_(options.has_spectrum_indices_),
+    spectrum_indices_(options.spectrum_indices_),
     zlib_compression_(options.zlib_compression_),
     size_only_(options.size_only_),
     always_append_data_(options.always_append_data_),
@@ -87,6 +92,7 @@ namespace OpenMS
     sort_chromatograms_by_rt_(options.sort_chromatograms_by_rt_),
     fill_data_(options.fill_data_),
     write_index_(options.write_index_),
+    write_spectrum_meta_index_(options.write_spectrum_meta_index_),
     np_config_mz_(options.np_config_mz_),
     np_config_int_(options.np_config_int_),
     maximal_data_pool_size_(options.maximal_data_pool_size_)
@@ -195,6 +201,34 @@ namespace OpenMS
     return ms_levels_;
   }
 
+  void PeakFileOptions::setSpectrumIndices(const vector<Size>& indices)
+  {
+    spectrum_indices_ = indices;
+    sort(spectrum_indices_.begin(), spectrum_indices_.end());
+    has_spectrum_indices_ = true;
+  }
+
+  void PeakFileOptions::clearSpectrumIndices()
+  {
+    spectrum_indices_.clear();
+    has_spectrum_indices_ = false;
+  }
+
+  bool PeakFileOptions::hasSpectrumIndices() const
+  {
+    return has_spectrum_indices_;
+  }
+
+  bool PeakFileOptions::containsSpectrumIndex(Size index) const
+  {
+    return binary_search(spectrum_indices_.begin(), spectrum_indices_.end(), index);
+  }
+
+  const vector<Size>& PeakFileOptions::getSpectrumIndices() const
+  {
+    return spectrum_indices_;
+  }
+
   void PeakFileOptions::setCompression(bool compress)
   {
     zlib_compression_ = compress;
@@ -295,6 +329,16 @@ namespace OpenMS
     write_index_ = write_index;
   }
 
+  bool PeakFileOptions::getWriteSpectrumMetaIndex() const
+  {
+    return write_spectrum_meta_index_;
+  }
+
+  void PeakFileOptions::setWriteSpectrumMetaIndex(bool write_index)
+  {
+    write_spectrum_meta_index_ = write_index;
+  }
+
   MSNumpressCoder::NumpressConfig PeakFileOptions::getNumpressConfigurationMassTime() const
   {
     return np_config_mz_;
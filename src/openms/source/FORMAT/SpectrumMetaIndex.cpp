@@ -0,0 +1,316 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/SpectrumMetaIndex.h>
+#include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/FORMAT/HANDLERS/IndexedMzMLDecoder.h>
+#include <OpenMS/INTERFACES/IMSDataConsumer.h>
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <QtCore/QFileInfo>
+#include <QtCore/QDateTime>
+
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+namespace OpenMS
+{
+  namespace
+  {
+    /// Magic bytes at the beginning of index files (includes format version)
+    const char INDEX_MAGIC[8] = {'O', 'M', 'S', '_', 'S', 'M', 'I', '1'};
+
+    /// Rounds up to a multiple of 8 (for alignment of the data blocks)
+    UInt64 align8(UInt64 offset)
+    {
+      return (offset + 7) & ~UInt64(7);
+    }
+
+    /// Adds every consumed spectrum to an index (see SpectrumMetaIndex::build())
+    class IndexingConsumer :
+      public Interfaces::IMSDataConsumer<>
+    {
+public:
+      explicit IndexingConsumer(SpectrumMetaIndex& index) :
+        index_(index),
+        chromatograms_(0)
+      {
+      }
+
+      void consumeSpectrum(SpectrumType& s)
+      {
+        index_.addSpectrum(s);
+      }
+
+      void consumeChromatogram(ChromatogramType& /* c */)
+      {
+        ++chromatograms_;
+      }
+
+      void setExpectedSize(Size /* expectedSpectra */, Size /* expectedChromatograms */)
+      {
+      }
+
+      void setExperimentalSettings(const ExperimentalSettings& /* exp */)
+      {
+      }
+
+      Size getChromatogramCount() const
+      {
+        return chromatograms_;
+      }
+
+private:
+      SpectrumMetaIndex& index_;
+      Size chromatograms_;
+    };
+  }
+
+  SpectrumMetaIndex::Entry::Entry() :
+    rt(0.0),
+    precursor_mz(0.0),
+    tic(0.0),
+    base_peak_mz(0.0),
+    base_peak_intensity(0.0),
+    min_mz(0.0),
+    max_mz(0.0),
+    min_intensity(0.0),
+    max_intensity(0.0),
+    offset(-1),
+    peak_count(0),
+    precursor_count(0),
+    ms_level(1),
+    precursor_charge(0)
+  {
+  }
+
+
+  SpectrumMetaIndex::SpectrumMetaIndex() :
+    entries_(),
+    chromatogram_count_(0)
+  {
+  }
+
+
+  SpectrumMetaIndex::~SpectrumMetaIndex()
+  {
+  }
+
+
+  void SpectrumMetaIndex::clear()
+  {
+    entries_.clear();
+    chromatogram_count_ = 0;
+  }
+
+
+  Size SpectrumMetaIndex::size() const
+  {
+    return entries_.size();
+  }
+
+
+  const std::vector<SpectrumMetaIndex::Entry>& SpectrumMetaIndex::getEntries() const
+  {
+    return entries_;
+  }
+
+
+  Size SpectrumMetaIndex::getChromatogramCount() const
+  {
+    return chromatogram_count_;
+  }
+
+
+  void SpectrumMetaIndex::setChromatogramCount(Size count)
+  {
+    chromatogram_count_ = count;
+  }
+
+
+  void SpectrumMetaIndex::build(const String& mzml_file)
+  {
+    clear();
+
+    // single pass, without any filtering (all spectra are indexed)
+    MzMLFile f;
+    IndexingConsumer consumer(*this);
+    f.transform(mzml_file, &consumer, true, true);
+    chromatogram_count_ = consumer.getChromatogramCount();
+
+    // byte offsets are only known for indexedmzML files
+    IndexedMzMLDecoder decoder;
+    IndexedMzMLDecoder::OffsetVector spectra_offsets, chromatograms_offsets;
+    std::streampos index_offset = decoder.findIndexListOffset(mzml_file);
+    if ((index_offset != std::streampos(-1)) &&
+        (decoder.parseOffsets(mzml_file, index_offset, spectra_offsets, chromatograms_offsets) == 0) &&
+        (spectra_offsets.size() == entries_.size()))
+    {
+      for (Size i = 0; i < entries_.size(); ++i)
+      {
+        entries_[i].offset = spectra_offsets[i].second;
+      }
+    }
+  }
+
+
+  void SpectrumMetaIndex::setOffsets(const std::vector<std::pair<std::string, long> >& offsets)
+  {
+    if (offsets.size() != entries_.size()) return;
+
+    for (Size i = 0; i < entries_.size(); ++i)
+    {
+      entries_[i].offset = offsets[i].second;
+    }
+  }
+
+
+  bool SpectrumMetaIndex::isSortedByRT() const
+  {
+    for (Size i = 1; i < entries_.size(); ++i)
+    {
+      if (entries_[i].rt < entries_[i - 1].rt) return false;
+    }
+    return true;
+  }
+
+
+  void SpectrumMetaIndex::store(const String& filename, const String& signature) const
+  {
+    ofstream out(filename.c_str(), ios::out | ios::binary | ios::trunc);
+    if (!out)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__,
+                                          __PRETTY_FUNCTION__, filename);
+    }
+    const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    UInt64 header[4] = {signature.size(), entries_.size(), chromatogram_count_,
+                        sizeof(Entry)};
+    out.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    out.write(signature.c_str(), signature.size());
+    out.write(padding, align8(signature.size()) - signature.size());
+    if (!entries_.empty())
+    {
+      out.write(reinterpret_cast<const char*>(&entries_[0]),
+                entries_.size() * sizeof(Entry));
+    }
+    if (!out)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__,
+                                          __PRETTY_FUNCTION__, filename);
+    }
+  }
+
+
+  bool SpectrumMetaIndex::load(const String& filename, const String& signature)
+  {
+    if (!File::exists(filename)) return false;
+
+    ifstream in(filename.c_str(), ios::in | ios::binary);
+    if (!in)
+    {
+      throw Exception::FileNotReadable(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+                                       filename);
+    }
+    in.seekg(0, ios::end);
+    const UInt64 file_size = in.tellg();
+    in.seekg(0, ios::beg);
+
+    char magic[sizeof(INDEX_MAGIC)];
+    UInt64 header[4];
+    UInt64 offset = sizeof(INDEX_MAGIC) + sizeof(header);
+    if (file_size < offset) return false;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!in || memcmp(magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) ||
+        (header[3] != sizeof(Entry)) || (header[0] != signature.size()))
+    {
+      return false; // not an index file, different layout or signature
+    }
+    offset += align8(header[0]);
+    if ((offset > file_size) ||
+        (header[1] > (file_size - offset) / sizeof(Entry)))
+    {
+      return false; // incomplete file
+    }
+    std::string stored_signature(Size(header[0]), '\0');
+    if (header[0] > 0) in.read(&stored_signature[0], header[0]);
+    if (!in || (stored_signature != signature)) return false;
+
+    std::vector<Entry> entries(header[1]);
+    in.seekg(offset, ios::beg);
+    if (!entries.empty())
+    {
+      in.read(reinterpret_cast<char*>(&entries[0]), entries.size() * sizeof(Entry));
+    }
+    if (!in) return false;
+
+    entries_.swap(entries);
+    chromatogram_count_ = header[2];
+    return true;
+  }
+
+
+  void SpectrumMetaIndex::storeSidecar(const String& mzml_file) const
+  {
+    store(getIndexFilename(mzml_file), getSignature(mzml_file));
+  }
+
+
+  bool SpectrumMetaIndex::loadSidecar(const String& mzml_file)
+  {
+    if (!File::exists(mzml_file)) return false;
+
+    return load(getIndexFilename(mzml_file), getSignature(mzml_file));
+  }
+
+
+  String SpectrumMetaIndex::getIndexFilename(const String& mzml_file)
+  {
+    return mzml_file + ".smi";
+  }
+
+
+  String SpectrumMetaIndex::getSignature(const String& mzml_file)
+  {
+    QFileInfo info(mzml_file.toQString());
+    return String("SpectrumMetaIndex;size=") + String(info.size()) + ";modified=" +
+           String(info.lastModified().toString(Qt::ISODate));
+  }
+
+} // namespace OpenMS
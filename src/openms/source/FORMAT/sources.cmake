@@ -38,6 +38,7 @@ MascotInfile.cpp
 MascotGenericFile.cpp
 MascotRemoteQuery.cpp
 MascotXMLFile.cpp
+MappedFASTAFile.cpp
 MsInspectFile.cpp
 MzDataFile.cpp
 MzTab.cpp
@@ -57,6 +58,7 @@ ProtXMLFile.cpp
 SequestInfile.cpp
 SequestOutfile.cpp
 SpecArrayFile.cpp
+SpectrumMetaIndex.cpp
 SwathFile.cpp
 SVOutStream.cpp
 TextFile.cpp
@@ -37,6 +37,7 @@
 
 #include <vector>
 #include <map>
+#include <algorithm>
 
 using namespace std;
 
@@ -104,6 +105,34 @@ namespace OpenMS
     return ((d_[i] * xx + c_[i]) * xx + b_[i]) * xx + a_[i];
   }
 
+  void CubicSpline2d::eval(const double* x, double* y, size_t n) const
+  {
+    if (n == 0)
+    {
+      return;
+    }
+    if (x[0] < x_.front() || x[n - 1] > x_.back())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Argument out of range of spline interpolation.");
+    }
+
+    // same interval as in eval(double): closest node left of (or exactly at)
+    // x, but never the last node
+    const size_t last = x_.size() - 2;
+    size_t i = std::upper_bound(x_.begin(), x_.end(), x[0]) - x_.begin() - 1;
+    i = std::min(i, last);
+    for (size_t k = 0; k < n; ++k)
+    {
+      const double xk = x[k];
+      while (i < last && x_[i + 1] <= xk)
+      {
+        ++i;
+      }
+      const double xx = xk - x_[i];
+      y[k] = ((d_[i] * xx + c_[i]) * xx + b_[i]) * xx + a_[i];
+    }
+  }
+
   double CubicSpline2d::derivatives(double x, unsigned order) const
   {
     if (x < x_.front() || x > x_.back())
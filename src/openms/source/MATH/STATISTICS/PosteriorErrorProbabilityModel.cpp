@@ -47,14 +47,35 @@
 
 #include <algorithm>
 
-
-
 using namespace std;
 
 namespace OpenMS
 {
   namespace Math
   {
+    namespace
+    {
+      /// number of scores per chunk in the EM kernels (fixed, so that results don't depend on the number of threads)
+      const Size EM_CHUNK_SIZE = 1024;
+
+      /// number of chunks needed for @p n scores
+      SignedSize numberOfChunks(Size n)
+      {
+        return (n + EM_CHUNK_SIZE - 1) / EM_CHUNK_SIZE;
+      }
+
+      /// adds up per-chunk partial sums (@p n_sums interleaved sums per chunk) in chunk order
+      vector<double> sumInOrder(const vector<double>& partial_sums, Size n_sums)
+      {
+        vector<double> sums(n_sums, 0.0);
+        for (Size i = 0; i < partial_sums.size(); ++i)
+        {
+          sums[i % n_sums] += partial_sums[i];
+        }
+        return sums;
+      }
+    }
+
     PosteriorErrorProbabilityModel::PosteriorErrorProbabilityModel() :
       DefaultParamHandler("PosteriorErrorProbabilityModel"),
       incorrectly_assigned_fit_param_(GaussFitter::GaussFitResult(-1, -1, -1)),
@@ -65,6 +86,8 @@ namespace OpenMS
       defaults_.setValue("number_of_bins", 100, "Number of bins used for visualization. Only needed if each iteration step of the EM-Algorithm will be visualized", ListUtils::create<String>("advanced"));
       defaults_.setValue("incorrectly_assigned", "Gumbel", "for 'Gumbel', the Gumbel distribution is used to plot incorrectly assigned sequences. For 'Gauss', the Gauss distribution is used.", ListUtils::create<String>("advanced"));
       defaults_.setValidStrings("incorrectly_assigned", ListUtils::create<String>("Gumbel,Gauss"));
+      defaults_.setValue("fit_bins", 0, "If larger than 0 and more scores than this are given, the EM algorithm is run on a histogram of the scores with this number of bins (using the bin counts as weights) instead of on all individual scores. Recommended for very large inputs, e.g. 20000 bins for millions of scores. '0' always fits on all scores.", ListUtils::create<String>("advanced"));
+      defaults_.setMinInt("fit_bins", 0);
       defaultsToParam_();
       calc_incorrect_ = &PosteriorErrorProbabilityModel::getGumbel;
       calc_correct_ = &PosteriorErrorProbabilityModel::getGauss;
@@ -120,11 +143,21 @@ namespace OpenMS
       correctly_assigned_fit_param_.sigma = incorrectly_assigned_fit_param_.sigma;
       correctly_assigned_fit_param_.A = 1.0   / sqrt(2 * Constants::PI * pow(correctly_assigned_fit_param_.sigma, 2));
 
+      // for very large inputs, fit on a fine histogram of the scores (bin counts as weights)
+      Size fit_bins = (Int)param_.getValue("fit_bins");
+      vector<double> bin_scores, weights;
+      if (fit_bins > 0 && x_scores.size() > fit_bins)
+      {
+        binScores_(x_scores, fit_bins, bin_scores, weights);
+      }
+      const vector<double>& fit_scores = weights.empty() ? x_scores : bin_scores;
+      double score_count = x_scores.size();
+
       vector<double> incorrect_density;
       vector<double> correct_density;
-      fillDensities(x_scores, incorrect_density, correct_density);
+      fillDensitiesFast_(fit_scores, weights, incorrect_density, correct_density);
 
-      double maxlike = computeMaxLikelihood(incorrect_density, correct_density);
+      double maxlike = computeLogLikelihoodFast_(weights, incorrect_density, correct_density);
       //-------------------------------------------------------------
       // create files for output
       //-------------------------------------------------------------
@@ -154,19 +187,16 @@ namespace OpenMS
       do
       {
         //E-STEP
-        double one_minus_sum_posterior = one_minus_sum_post(incorrect_density, correct_density);
-        double sum_posterior = sum_post(incorrect_density, correct_density);
+        double one_minus_sum_posterior, sum_posterior, sum_positive_x0, sum_negative_x0;
+        sumPosteriorsFast_(fit_scores, weights, incorrect_density, correct_density, sum_posterior, one_minus_sum_posterior, sum_negative_x0, sum_positive_x0);
 
         //new mean
-        double sum_positive_x0 = sum_pos_x0(x_scores, incorrect_density, correct_density);
-        double sum_negative_x0 = sum_neg_x0(x_scores, incorrect_density, correct_density);
-
         double positive_mean = sum_positive_x0 / one_minus_sum_posterior;
         double negative_mean = sum_negative_x0 / sum_posterior;
 
         //new standard deviation
-        double sum_positive_sigma = sum_pos_sigma(x_scores, incorrect_density, correct_density, positive_mean);
-        double sum_negative_sigma = sum_neg_sigma(x_scores, incorrect_density, correct_density, negative_mean);
+        double sum_positive_sigma, sum_negative_sigma;
+        sumSigmasFast_(fit_scores, weights, incorrect_density, correct_density, positive_mean, negative_mean, sum_positive_sigma, sum_negative_sigma);
 
         //update parameters
         correctly_assigned_fit_param_.x0 = positive_mean;
@@ -185,11 +215,10 @@ namespace OpenMS
 
 
         //compute new prior probabilities negative peptides
-        fillDensities(x_scores, incorrect_density, correct_density);
-        sum_posterior = sum_post(incorrect_density, correct_density);
-        negative_prior_ = sum_posterior / x_scores.size();
+        sum_posterior = fillDensitiesFast_(fit_scores, weights, incorrect_density, correct_density);
+        negative_prior_ = sum_posterior / score_count;
 
-        double new_maxlike(computeMaxLikelihood(incorrect_density, correct_density));
+        double new_maxlike(computeLogLikelihoodFast_(weights, incorrect_density, correct_density));
         if (boost::math::isnan(new_maxlike - maxlike))
         {
           return false;
@@ -198,8 +227,8 @@ namespace OpenMS
         if (fabs(new_maxlike - maxlike) < 0.001)
         {
           stop_em_init = true;
-          sum_posterior = sum_post(incorrect_density, correct_density);
-          negative_prior_ = sum_posterior / x_scores.size();
+          sumPosteriorsFast_(fit_scores, weights, incorrect_density, correct_density, sum_posterior, one_minus_sum_posterior, sum_negative_x0, sum_positive_x0);
+          negative_prior_ = sum_posterior / score_count;
 
         }
         if (output_plots)
@@ -272,83 +301,212 @@ namespace OpenMS
 
     double PosteriorErrorProbabilityModel::computeMaxLikelihood(vector<double>& incorrect_density, vector<double>& correct_density)
     {
-      double maxlike(0);
-      vector<double>::iterator incorrect = incorrect_density.begin();
-      for (vector<double>::iterator correct = correct_density.begin(); correct < correct_density.end(); ++correct, ++incorrect)
-      {
-        maxlike += log10(negative_prior_ * (*incorrect) + (1 - negative_prior_) * (*correct));
-      }
-      return maxlike;
+      return computeLogLikelihoodFast_(vector<double>(), incorrect_density, correct_density);
     }
 
     double PosteriorErrorProbabilityModel::one_minus_sum_post(vector<double>& incorrect_density, vector<double>& correct_density)
     {
-      double one_min(0);
-      vector<double>::iterator incorrect = incorrect_density.begin();
-      for (vector<double>::iterator correct = correct_density.begin(); correct < correct_density.end(); ++correct, ++incorrect)
-      {
-        one_min +=  1  - ((negative_prior_ * (*incorrect)) / ((negative_prior_ * (*incorrect)) + (1 - negative_prior_) * (*correct)));
-      }
+      double post, one_min, neg_x0, pos_x0;
+      // the scores only matter for the x0 sums - pass the densities instead
+      sumPosteriorsFast_(incorrect_density, vector<double>(), incorrect_density, correct_density, post, one_min, neg_x0, pos_x0);
       return one_min;
     }
 
     double PosteriorErrorProbabilityModel::sum_post(vector<double>& incorrect_density, vector<double>& correct_density)
     {
-      double post(0);
-      vector<double>::iterator incorrect = incorrect_density.begin();
-      for (vector<double>::iterator correct = correct_density.begin(); correct < correct_density.end(); ++correct, ++incorrect)
-      {
-        post += ((negative_prior_ * (*incorrect)) / ((negative_prior_ * (*incorrect)) + (1 - negative_prior_) * (*correct)));
-      }
+      double post, one_min, neg_x0, pos_x0;
+      // the scores only matter for the x0 sums - pass the densities instead
+      sumPosteriorsFast_(incorrect_density, vector<double>(), incorrect_density, correct_density, post, one_min, neg_x0, pos_x0);
       return post;
     }
 
     double PosteriorErrorProbabilityModel::sum_pos_x0(vector<double>& x_scores, vector<double>& incorrect_density, vector<double>& correct_density)
     {
-      double pos_x0(0);
-      vector<double>::iterator the_x = x_scores.begin();
-      vector<double>::iterator incorrect = incorrect_density.begin();
-      for (vector<double>::iterator correct = correct_density.begin(); correct < correct_density.end(); ++correct, ++incorrect, ++the_x)
-      {
-        pos_x0 += ((1  - ((negative_prior_ * (*incorrect)) / ((negative_prior_ * (*incorrect)) + (1 - negative_prior_) * (*correct)))) * (*the_x));
-      }
+      double post, one_min, neg_x0, pos_x0;
+      sumPosteriorsFast_(x_scores, vector<double>(), incorrect_density, correct_density, post, one_min, neg_x0, pos_x0);
       return pos_x0;
     }
 
     double PosteriorErrorProbabilityModel::sum_neg_x0(vector<double>& x_scores, vector<double>& incorrect_density, vector<double>& correct_density)
     {
-      double neg_x0(0);
-      vector<double>::iterator the_x = x_scores.begin();
-      vector<double>::iterator correct = correct_density.begin();
-      for (vector<double>::iterator incorrect = incorrect_density.begin(); incorrect < incorrect_density.end(); ++correct, ++incorrect, ++the_x)
-      {
-        neg_x0 += ((((negative_prior_ * (*incorrect)) / ((negative_prior_ * (*incorrect)) + (1 - negative_prior_) * (*correct)))) * (*the_x));
-      }
+      double post, one_min, neg_x0, pos_x0;
+      sumPosteriorsFast_(x_scores, vector<double>(), incorrect_density, correct_density, post, one_min, neg_x0, pos_x0);
       return neg_x0;
     }
 
     double PosteriorErrorProbabilityModel::sum_pos_sigma(vector<double>& x_scores, vector<double>& incorrect_density, vector<double>& correct_density, double positive_mean)
     {
-      double pos_sigma(0);
-      vector<double>::iterator the_x = x_scores.begin();
-      vector<double>::iterator incorrect = incorrect_density.begin();
-      for (vector<double>::iterator correct = correct_density.begin(); correct < correct_density.end(); ++correct, ++incorrect, ++the_x)
-      {
-        pos_sigma += ((1  - ((negative_prior_ * (*incorrect)) / ((negative_prior_ * (*incorrect)) + (1 - negative_prior_) * (*correct)))) * pow((*the_x) - positive_mean, 2));
-      }
+      double pos_sigma, neg_sigma;
+      sumSigmasFast_(x_scores, vector<double>(), incorrect_density, correct_density, positive_mean, positive_mean, pos_sigma, neg_sigma);
       return pos_sigma;
     }
 
     double PosteriorErrorProbabilityModel::sum_neg_sigma(vector<double>& x_scores, vector<double>& incorrect_density, vector<double>& correct_density, double positive_mean)
     {
-      double neg_sigma(0);
-      vector<double>::iterator the_x = x_scores.begin();
-      vector<double>::iterator incorrect = incorrect_density.begin();
-      for (vector<double>::iterator correct = correct_density.begin(); correct < correct_density.end(); ++correct, ++incorrect, ++the_x)
+      double pos_sigma, neg_sigma;
+      sumSigmasFast_(x_scores, vector<double>(), incorrect_density, correct_density, positive_mean, positive_mean, pos_sigma, neg_sigma);
+      return neg_sigma;
+    }
+
+    double PosteriorErrorProbabilityModel::fillDensitiesFast_(const vector<double>& x_scores, const vector<double>& weights, vector<double>& incorrect_density, vector<double>& correct_density) const
+    {
+      // the EM algorithm uses Gauss densities for both distributions (see fit())
+      const double inc_A = incorrectly_assigned_fit_param_.A, inc_x0 = incorrectly_assigned_fit_param_.x0;
+      const double inc_factor = -1.0 / (2 * incorrectly_assigned_fit_param_.sigma * incorrectly_assigned_fit_param_.sigma);
+      const double cor_A = correctly_assigned_fit_param_.A, cor_x0 = correctly_assigned_fit_param_.x0;
+      const double cor_factor = -1.0 / (2 * correctly_assigned_fit_param_.sigma * correctly_assigned_fit_param_.sigma);
+      const double prior = negative_prior_;
+      const bool weighted = !weights.empty();
+
+      incorrect_density.resize(x_scores.size());
+      correct_density.resize(x_scores.size());
+      const SignedSize chunks = numberOfChunks(x_scores.size());
+      vector<double> partial_sums(chunks);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+      for (SignedSize c = 0; c < chunks; ++c)
       {
-        neg_sigma += ((((negative_prior_ * (*incorrect)) / ((negative_prior_ * (*incorrect)) + (1 - negative_prior_) * (*correct)))) * pow((*the_x) - positive_mean, 2));
+        double sum_posterior(0);
+        const Size end = std::min(x_scores.size(), Size(c + 1) * EM_CHUNK_SIZE);
+        for (Size i = Size(c) * EM_CHUNK_SIZE; i < end; ++i)
+        {
+          double inc_diff = x_scores[i] - inc_x0;
+          double cor_diff = x_scores[i] - cor_x0;
+          double incorrect = inc_A * exp(inc_factor * inc_diff * inc_diff);
+          double correct = cor_A * exp(cor_factor * cor_diff * cor_diff);
+          incorrect_density[i] = incorrect;
+          correct_density[i] = correct;
+          double posterior = (prior * incorrect) / (prior * incorrect + (1 - prior) * correct);
+          sum_posterior += (weighted ? weights[i] : 1.0) * posterior;
+        }
+        partial_sums[c] = sum_posterior;
       }
-      return neg_sigma;
+      return sumInOrder(partial_sums, 1)[0];
+    }
+
+    double PosteriorErrorProbabilityModel::computeLogLikelihoodFast_(const vector<double>& weights, const vector<double>& incorrect_density, const vector<double>& correct_density) const
+    {
+      const double prior = negative_prior_;
+      const bool weighted = !weights.empty();
+      const SignedSize chunks = numberOfChunks(incorrect_density.size());
+      vector<double> partial_sums(chunks);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+      for (SignedSize c = 0; c < chunks; ++c)
+      {
+        double maxlike(0);
+        const Size end = std::min(incorrect_density.size(), Size(c + 1) * EM_CHUNK_SIZE);
+        for (Size i = Size(c) * EM_CHUNK_SIZE; i < end; ++i)
+        {
+          maxlike += (weighted ? weights[i] : 1.0) * log10(prior * incorrect_density[i] + (1 - prior) * correct_density[i]);
+        }
+        partial_sums[c] = maxlike;
+      }
+      return sumInOrder(partial_sums, 1)[0];
+    }
+
+    void PosteriorErrorProbabilityModel::sumPosteriorsFast_(const vector<double>& x_scores, const vector<double>& weights, const vector<double>& incorrect_density, const vector<double>& correct_density, double& sum_posterior, double& one_minus_sum_posterior, double& sum_negative_x0, double& sum_positive_x0) const
+    {
+      const double prior = negative_prior_;
+      const bool weighted = !weights.empty();
+      const SignedSize chunks = numberOfChunks(x_scores.size());
+      vector<double> partial_sums(4 * chunks);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+      for (SignedSize c = 0; c < chunks; ++c)
+      {
+        double post(0), one_min(0), neg_x0(0), pos_x0(0);
+        const Size end = std::min(x_scores.size(), Size(c + 1) * EM_CHUNK_SIZE);
+        for (Size i = Size(c) * EM_CHUNK_SIZE; i < end; ++i)
+        {
+          double w = weighted ? weights[i] : 1.0;
+          double posterior = (prior * incorrect_density[i]) / (prior * incorrect_density[i] + (1 - prior) * correct_density[i]);
+          post += w * posterior;
+          one_min += w * (1 - posterior);
+          neg_x0 += w * posterior * x_scores[i];
+          pos_x0 += w * (1 - posterior) * x_scores[i];
+        }
+        partial_sums[4 * c] = post;
+        partial_sums[4 * c + 1] = one_min;
+        partial_sums[4 * c + 2] = neg_x0;
+        partial_sums[4 * c + 3] = pos_x0;
+      }
+      vector<double> sums = sumInOrder(partial_sums, 4);
+      sum_posterior = sums[0];
+      one_minus_sum_posterior = sums[1];
+      sum_negative_x0 = sums[2];
+      sum_positive_x0 = sums[3];
+    }
+
+    void PosteriorErrorProbabilityModel::sumSigmasFast_(const vector<double>& x_scores, const vector<double>& weights, const vector<double>& incorrect_density, const vector<double>& correct_density, double positive_mean, double negative_mean, double& sum_positive_sigma, double& sum_negative_sigma) const
+    {
+      const double prior = negative_prior_;
+      const bool weighted = !weights.empty();
+      const SignedSize chunks = numberOfChunks(x_scores.size());
+      vector<double> partial_sums(2 * chunks);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+      for (SignedSize c = 0; c < chunks; ++c)
+      {
+        double pos_sigma(0), neg_sigma(0);
+        const Size end = std::min(x_scores.size(), Size(c + 1) * EM_CHUNK_SIZE);
+        for (Size i = Size(c) * EM_CHUNK_SIZE; i < end; ++i)
+        {
+          double w = weighted ? weights[i] : 1.0;
+          double posterior = (prior * incorrect_density[i]) / (prior * incorrect_density[i] + (1 - prior) * correct_density[i]);
+          double pos_diff = x_scores[i] - positive_mean;
+          double neg_diff = x_scores[i] - negative_mean;
+          pos_sigma += w * (1 - posterior) * pos_diff * pos_diff;
+          neg_sigma += w * posterior * neg_diff * neg_diff;
+        }
+        partial_sums[2 * c] = pos_sigma;
+        partial_sums[2 * c + 1] = neg_sigma;
+      }
+      vector<double> sums = sumInOrder(partial_sums, 2);
+      sum_positive_sigma = sums[0];
+      sum_negative_sigma = sums[1];
+    }
+
+    void PosteriorErrorProbabilityModel::binScores_(const vector<double>& x_scores, Size number_of_bins, vector<double>& bin_scores, vector<double>& bin_counts) const
+    {
+      bin_scores.clear();
+      bin_counts.clear();
+      if (x_scores.empty())
+      {
+        return;
+      }
+      double min_score = x_scores.front();
+      double bin_width = (x_scores.back() - min_score) / number_of_bins;
+      if (bin_width <= 0) // all scores are equal
+      {
+        bin_scores.push_back(min_score);
+        bin_counts.push_back(x_scores.size());
+        return;
+      }
+
+      // scores are sorted, so each bin is a contiguous range
+      Size current_bin(0), count(0);
+      double sum(0);
+      for (vector<double>::const_iterator it = x_scores.begin(); it != x_scores.end(); ++it)
+      {
+        Size bin = std::min(number_of_bins - 1, (Size)((*it - min_score) / bin_width));
+        if (bin != current_bin && count > 0)
+        {
+          bin_scores.push_back(sum / count);
+          bin_counts.push_back(count);
+          sum = 0;
+          count = 0;
+        }
+        current_bin = bin;
+        sum += *it;
+        ++count;
+      }
+      bin_scores.push_back(sum / count);
+      bin_counts.push_back(count);
     }
 
     double PosteriorErrorProbabilityModel::computeProbability(double score)
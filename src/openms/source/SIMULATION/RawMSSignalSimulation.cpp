@@ -39,6 +39,7 @@
 #include <OpenMS/SYSTEM/File.h>
 #include <OpenMS/FORMAT/TextFile.h>
 #include <OpenMS/CONCEPT/Constants.h>
+#include <OpenMS/CONCEPT/ParallelExceptionCollector.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
 #include <OpenMS/FORMAT/SVOutStream.h>
 
@@ -63,6 +64,78 @@
 namespace OpenMS
 {
 
+  /**
+    @brief Shards of the experiment filled in parallel by RawMSSignalSimulation::generateRawSignals()
+
+    Each scan is a shard with its own lock. A scan is compressed onto the m/z grid as soon as it holds
+    more than twice the points it had after its last compression (plus some slack), which bounds the
+    memory of the raw map independently of the number of threads.
+  */
+  class RawMSSignalSimulation::ScanShards
+  {
+public:
+    explicit ScanShards(const Size scan_count) :
+      compressed_size_(scan_count, 0)
+    {
+#ifdef _OPENMP
+      locks_.resize(scan_count);
+      for (Size i = 0; i < locks_.size(); ++i)
+      {
+        omp_init_lock(&locks_[i]);
+      }
+#endif
+    }
+
+    ~ScanShards()
+    {
+#ifdef _OPENMP
+      for (Size i = 0; i < locks_.size(); ++i)
+      {
+        omp_destroy_lock(&locks_[i]);
+      }
+#endif
+    }
+
+    void lock(const Size scan)
+    {
+#ifdef _OPENMP
+      omp_set_lock(&locks_[scan]);
+#endif
+    }
+
+    void unlock(const Size scan)
+    {
+#ifdef _OPENMP
+      omp_unset_lock(&locks_[scan]);
+#endif
+    }
+
+    /// does the scan (holding @p size points) need to be compressed? (call with lock held)
+    bool needsCompression(const Size scan, const Size size) const
+    {
+      return size > 2 * compressed_size_[scan] + MIN_UNCOMPRESSED_POINTS;
+    }
+
+    /// remember the size of the scan after compression (call with lock held)
+    void setCompressed(const Size scan, const Size size)
+    {
+      compressed_size_[scan] = size;
+    }
+
+private:
+    /// number of uncompressed points we always allow per scan (compressing very small scans is a waste of time)
+    static const Size MIN_UNCOMPRESSED_POINTS = 10000;
+
+    std::vector<Size> compressed_size_;
+#ifdef _OPENMP
+    std::vector<omp_lock_t> locks_;
+#endif
+
+    // not copyable (the locks are not)
+    ScanShards(const ScanShards&);
+    ScanShards& operator=(const ScanShards&);
+  };
+
   /**
    * TODO: review baseline and noise code
    */
@@ -77,6 +150,7 @@ namespace OpenMS
     res_base_(0),
     rnd_gen_(rng),
     contaminants_(),
+    scan_shards_(0),
     contaminants_loaded_(false)
   {
     setDefaultParams_();
@@ -93,6 +167,7 @@ namespace OpenMS
     res_base_(0),
     rnd_gen_(),
     contaminants_(),
+    scan_shards_(0),
     contaminants_loaded_(false)
   {
     setDefaultParams_();
@@ -109,6 +184,7 @@ namespace OpenMS
     res_model_(source.res_model_),
     res_base_(source.res_base_),
     contaminants_(),
+    scan_shards_(0),
     contaminants_loaded_(false)
   {
     setParameters(source.getParameters());
@@ -391,13 +467,6 @@ namespace OpenMS
     }
     else // LC/MS
     {
-      std::vector<SimTypes::MSSimExperiment*> experiments; // pointer to experiment(s)
-      experiments.push_back(&experiment); // the master thread gets the original (just a reference, no copying here)
-
-      std::vector<SimTypes::MSSimExperiment*> experiments_ct; // pointer to experiment(s)
-      experiments_ct.push_back(&experiment_ct); // the master thread gets the original (just a reference, no copying here)
-
-
 #ifdef _OPENMP
       // prepare random numbers for the different threads
       // each possible thread gets his own set of random
@@ -406,95 +475,53 @@ namespace OpenMS
 
       threaded_random_numbers_.resize(thread_count);
       threaded_random_numbers_index_.resize(thread_count);
-      experiments.reserve(thread_count); // !reserve!
-      experiments_ct.reserve(thread_count); // !reserve!
-      std::vector<SimTypes::MSSimExperiment> experiments_tmp(thread_count - 1); // holds MSExperiments for slave threads
-      std::vector<SimTypes::MSSimExperiment> experiments_ct_tmp(thread_count - 1); // holds MSExperiments (centroided) for slave threads
 
       for (Size i = 0; i < thread_count; ++i)
       {
         threaded_random_numbers_[i].resize(THREADED_RANDOM_NUMBER_POOL_SIZE_);
         threaded_random_numbers_index_[i] = THREADED_RANDOM_NUMBER_POOL_SIZE_;
       }
-
-      if (thread_count > 1)
-      {
-        // prepare a temporary experiment to store the results
-        SimTypes::MSSimExperiment e_tmp = experiment;
-        SimTypes::MSSimExperiment e_ct_tmp = experiment_ct;
-        // remove actual data
-        for (Size i = 0; i < e_tmp.size(); ++i)
-        {
-          e_tmp[i].clear(false);
-          e_ct_tmp[i].clear(false);
-        }
-        // each slave thread gets a copy
-        for (Size i = 1; i < thread_count; ++i)
-        {
-          experiments_tmp[i - 1] = e_tmp;
-          experiments_ct_tmp[i - 1] = e_ct_tmp;
-          // assign it to the list of experiments (this is no real copy, but a reference!)
-          experiments.push_back(&(experiments_tmp[i - 1]));
-          experiments_ct.push_back(&(experiments_ct_tmp[i - 1]));
-        }
-      }
-#else
-      Size thread_count = 1;
 #endif
 
-      Size compress_size_intermediate = 20000 / thread_count; // compress map every X features, (10.000 feature are ~ 2 GB at 0.002 sampling rate)
-      Size compress_count = 0; // feature count (for each thread)
+      // all threads sample into the same experiment, each scan is locked separately (see addToScan_())
+      // and compressed whenever it grew too large, so we do not need a copy of the map per thread
+      ScanShards shards(experiment.size());
+      scan_shards_ = &shards;
 
+      ParallelExceptionCollector errors;
 #ifdef _OPENMP
-#pragma omp parallel for firstprivate(compress_count)
+#pragma omp parallel for schedule(dynamic)
 #endif
       for (SignedSize f = 0; f < (SignedSize)features.size(); ++f)
       {
-#ifdef _OPENMP // update experiment index if necessary
-        const int current_thread = omp_get_thread_num();
-#else
-        const int current_thread(0);
-#endif
-        add2DSignal_(features[f], *(experiments[current_thread]), *(experiments_ct[current_thread]));
+        if (!errors.hasErrorBefore(f))
+        {
+          try
+          {
+            add2DSignal_(features[f], experiment, experiment_ct);
+          }
+          catch (...) // exceptions must not leave the parallel region
+          {
+            errors.capture(f);
+          }
+        }
 
         // progresslogger, only master thread sets progress (no barrier here)
 #ifdef _OPENMP
 #pragma omp atomic
 #endif
         ++progress;
-        if (current_thread == 0)
+#ifdef _OPENMP
+        if (omp_get_thread_num() == 0)
+#endif
         {
           this->setProgress(progress);
         }
-
-        // intermediate compress to avoid memory problems
-        ++compress_count;
-        if (compress_count > compress_size_intermediate)
-        {
-          compress_count = 0;
-          compressSignals_(*(experiments[current_thread]));
-        }
       } // ! raw signal sim
 
-#ifdef _OPENMP // merge back other experiments
-      for (Size i = 1; i < experiments.size(); ++i)
-      {
-        // copy peak data from temporal experiment
-        for (Size scan = 0; scan < experiment.size(); ++scan)
-        {
-          if ((*experiments[i])[scan].empty())
-            continue; // we do not care if the spectrum wasn't touched at all
-          // append all points from temp to org
-          experiment[scan].insert(experiment[scan].end(), (*experiments[i])[scan].begin(), (*experiments[i])[scan].end());
-          // delete from child experiment to save memory (otherwise the merge would double it!)
-          (*experiments[i])[scan].clear(false);
-
-          // peak GT ( small, so no need to compress)
-          experiment_ct[scan].insert(experiment_ct[scan].end(), (*experiments_ct[i])[scan].begin(), (*experiments_ct[i])[scan].end());
-
-        }
-      }
-#endif
+      scan_shards_ = 0;
+      // the error of the first failing feature, with its original type
+      errors.rethrow();
 
     } // ! 1D or 2D
 
@@ -729,11 +756,14 @@ namespace OpenMS
     SimTypes::SimCoordinateType rt(0);
     SimTypes::MSSimExperiment::iterator exp_iter = exp_start;
     SimTypes::MSSimExperiment::iterator exp_ct_iter = exp_ct_start;
+    std::vector<SimTypes::SimPointType> points, points_ct; // signals of the current scan (added to the scan in one go)
     for (; rt < rt_end && exp_iter != experiment.end(); ++exp_iter, ++exp_ct_iter)
     {
       rt = exp_iter->getRT();
       double distortion = double(exp_iter->getMetaValue("distortion"));
       double rt_intensity = ((EGHModel*)pm.getModel(0))->getIntensity(rt);
+      points.clear();
+      points_ct.clear();
 
       // centroided GT
       Size iso_pos(0);
@@ -746,7 +776,7 @@ namespace OpenMS
         if (point.getIntensity() <= 0.0)
           continue;
 
-        exp_ct_iter->push_back(point);
+        points_ct.push_back(point);
       }
 
       // RAW signal (sample it on the grid)
@@ -795,10 +825,11 @@ namespace OpenMS
         const double mz_err = ndist(rnd_gen_->getTechnicalRng());
 #endif
         point.setMZ(std::fabs(point.getMZ() + mz_err));
-        exp_iter->push_back(point);
+        points.push_back(point);
 
         intensity_sum += point.getIntensity();
       }
+      addToScan_(exp_iter - experiment.begin(), points, points_ct, *exp_iter, *exp_ct_iter);
       //update last scan affected
 #ifdef OPENMS_ASSERTIONS
       end_scan = exp_iter - experiment.begin();
@@ -1197,7 +1228,6 @@ namespace OpenMS
       return;
     }
 
-    typedef std::vector<SimTypes::SimCoordinateType>::iterator GridTypeIt;
     std::vector<SimTypes::SimCoordinateType> grid;
     getSamplingGrid_(grid, min_mz, max_mz, 5); // every 5 Da we adjust the sampling width by local FWHM
 
@@ -1208,89 +1238,128 @@ namespace OpenMS
     }
 
     Size point_count_before(0), point_count_after(0);
-    SimTypes::SimPointType p;
     for (Size i = 0; i < experiment.size(); ++i)
     {
-      if (experiment[i].size() <= 1)
-        continue;
+      point_count_before += experiment[i].size(); // stats
+      compressSpectrum_(experiment[i], grid);
+      point_count_after += experiment[i].size();
+    }
 
-      if (experiment[i].isSorted() == false) // this should be true - however we check
-      {
-        experiment[i].sortByPosition();
-      }
+    if (point_count_before != 0)
+    {
+      LOG_INFO << "Compressed data to grid ... " <<  point_count_before << " --> " << point_count_after << " (" << (point_count_after * 100 / point_count_before) << "%)\n";
+    }
+    else
+    {
+      LOG_INFO << "Not enough points in map .. did not compress!\n";
+    }
 
-      // copy Spectrum and remove Peaks ..
-      SimTypes::MSSimExperiment::SpectrumType cont = experiment[i];
-      cont.clear(false);
+    return;
+  }
+
+  void RawMSSignalSimulation::compressSpectrum_(SimTypes::MSSimExperiment::SpectrumType& spectrum, const std::vector<SimTypes::SimCoordinateType>& grid) const
+  {
+    if (spectrum.size() <= 1)
+      return;
 
-      GridTypeIt grid_pos = grid.begin();
-      GridTypeIt grid_pos_next(grid_pos + 1);
+    if (spectrum.isSorted() == false) // this should be true - however we check
+    {
+      spectrum.sortByPosition();
+    }
 
-      double int_sum(0);
-      bool break_scan(false);
-      // match points to closest grid point
-      for (Size j = 0; j < experiment[i].size(); ++j)
+    typedef std::vector<SimTypes::SimCoordinateType>::const_iterator GridTypeIt;
+
+    // compressed peaks (replace the peaks of the spectrum, its meta data stays untouched)
+    std::vector<SimTypes::SimPointType> cont;
+
+    GridTypeIt grid_pos = grid.begin();
+    GridTypeIt grid_pos_next(grid_pos + 1);
+
+    SimTypes::SimPointType p;
+    double int_sum(0);
+    bool break_scan(false);
+    // match points to closest grid point
+    for (Size j = 0; j < spectrum.size(); ++j)
+    {
+      Size advance_by_binary_search = 3;
+      while (fabs((*grid_pos_next) - spectrum[j].getMZ()) < fabs((*grid_pos) - spectrum[j].getMZ()))
       {
-        Size advance_by_binary_search = 3;
-        while (fabs((*grid_pos_next) - experiment[i][j].getMZ()) < fabs((*grid_pos) - experiment[i][j].getMZ()))
+        if (int_sum > 0) // we collected some points before --> save them
         {
-          if (int_sum > 0) // we collected some points before --> save them
-          {
-            p.setIntensity(int_sum);
-            p.setMZ(*grid_pos);
-            cont.push_back(p);
-            int_sum = 0; // reset
-          }
+          p.setIntensity(int_sum);
+          p.setMZ(*grid_pos);
+          cont.push_back(p);
+          int_sum = 0; // reset
+        }
 
-          if (--advance_by_binary_search == 0)
-          {
-            // advance using binary search
-            grid_pos_next = std::lower_bound(grid_pos, grid.end(), experiment[i][j].getMZ());
-            grid_pos = grid_pos_next - 1; // this should always work, since we ran at least 3 steps forward before
-            advance_by_binary_search = 10; // just so we do not run into here again
-          }
-          else
-          {
-            // advance to next grid element
-            ++grid_pos;
-            ++grid_pos_next;
-          }
+        if (--advance_by_binary_search == 0)
+        {
+          // advance using binary search
+          grid_pos_next = std::lower_bound(grid_pos, grid.end(), spectrum[j].getMZ());
+          grid_pos = grid_pos_next - 1; // this should always work, since we ran at least 3 steps forward before
+          advance_by_binary_search = 10; // just so we do not run into here again
+        }
+        else
+        {
+          // advance to next grid element
+          ++grid_pos;
+          ++grid_pos_next;
+        }
 
-          if (grid_pos_next == grid.end())
-          {
-            break_scan = true;
-            break;
-          }
+        if (grid_pos_next == grid.end())
+        {
+          break_scan = true;
+          break;
         }
-        if (break_scan)
-          break; // skip remaining points of the scan (we reached the end of the grid)
+      }
+      if (break_scan)
+        break; // skip remaining points of the scan (we reached the end of the grid)
 
-        int_sum += experiment[i][j].getIntensity();
+      int_sum += spectrum[j].getIntensity();
 
-      } // end of scan
+    } // end of scan
 
-      if (int_sum > 0) // don't forget the last one
-      {
-        p.setIntensity(int_sum);
-        p.setMZ(*grid_pos);
-        cont.push_back(p);
-      }
+    if (int_sum > 0) // don't forget the last one
+    {
+      p.setIntensity(int_sum);
+      p.setMZ(*grid_pos);
+      cont.push_back(p);
+    }
 
-      point_count_before += experiment[i].size(); // stats
-      experiment[i] = cont;
-      point_count_after += experiment[i].size();
+    spectrum.swap(cont);
+  }
+
+  void RawMSSignalSimulation::addToScan_(const Size scan,
+                                         const std::vector<SimTypes::SimPointType>& points,
+                                         const std::vector<SimTypes::SimPointType>& points_ct,
+                                         SimTypes::MSSimExperiment::SpectrumType& spectrum,
+                                         SimTypes::MSSimExperiment::SpectrumType& spectrum_ct)
+  {
+    if (scan_shards_ == 0) // not sampling in parallel
+    {
+      spectrum.insert(spectrum.end(), points.begin(), points.end());
+      spectrum_ct.insert(spectrum_ct.end(), points_ct.begin(), points_ct.end());
+      return;
     }
 
-    if (point_count_before != 0)
+    scan_shards_->lock(scan);
+    try
     {
-      LOG_INFO << "Compressed data to grid ... " <<  point_count_before << " --> " << point_count_after << " (" << (point_count_after * 100 / point_count_before) << "%)\n";
+      spectrum.insert(spectrum.end(), points.begin(), points.end());
+      // peak GT (small, so no need to compress)
+      spectrum_ct.insert(spectrum_ct.end(), points_ct.begin(), points_ct.end());
+      if (grid_.size() >= 3 && scan_shards_->needsCompression(scan, spectrum.size()))
+      {
+        compressSpectrum_(spectrum, grid_);
+        scan_shards_->setCompressed(scan, spectrum.size());
+      }
     }
-    else
+    catch (...) // e.g. std::bad_alloc: do not leave the scan locked
     {
-      LOG_INFO << "Not enough points in map .. did not compress!\n";
+      scan_shards_->unlock(scan);
+      throw;
     }
-
-    return;
+    scan_shards_->unlock(scan);
   }
 
   SimTypes::SimIntensityType RawMSSignalSimulation::getFeatureScaledIntensity_(const SimTypes::SimIntensityType feature_intensity, const SimTypes::SimIntensityType natural_scaling_factor)
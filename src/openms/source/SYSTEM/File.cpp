@@ -137,6 +137,16 @@ namespace OpenMS
     return true;
   }
 
+  bool File::rename(const String& old_filename, const String& new_filename)
+  {
+#ifdef OPENMS_WINDOWSPLATFORM
+    // "std::rename" fails on Windows if the target exists
+    return MoveFileExA(old_filename.c_str(), new_filename.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(old_filename.c_str(), new_filename.c_str()) == 0;
+#endif
+  }
+
   bool File::removeDirRecursively(const String& dir_name)
   {
     bool fail = false;
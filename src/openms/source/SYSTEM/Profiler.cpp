@@ -0,0 +1,492 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/SYSTEM/Profiler.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/CONCEPT/LogStream.h>
+#include <OpenMS/CONCEPT/VersionInfo.h>
+#include <OpenMS/SYSTEM/StopWatch.h>
+#include <OpenMS/SYSTEM/SysInfo.h>
+
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QThreadStorage>
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <vector>
+
+using namespace std;
+
+namespace OpenMS
+{
+  namespace
+  {
+    /// An open stage
+    struct Frame
+    {
+      /// handle returned by Profiler::startScope()
+      Size id;
+      Profiler::Node* node;
+      StopWatch watch;
+      size_t peak_memory;
+    };
+
+    struct ThreadProfile;
+
+    /// The profiles of all threads
+    struct Registry
+    {
+      Registry() :
+        enabled(false)
+      {
+      }
+
+      volatile bool enabled;
+      QMutex mutex;
+      /// profiles of running threads
+      std::set<ThreadProfile*> threads;
+      /// merged profiles of finished threads
+      Profiler::Node finished;
+    };
+
+    Registry& registry()
+    {
+      // never deleted: thread profiles may be merged during static destruction
+      static Registry* registry = new Registry();
+      return *registry;
+    }
+
+    /// The call tree and open stages of one thread
+    struct ThreadProfile
+    {
+      ThreadProfile() :
+        next_id(0)
+      {
+        QMutexLocker lock(&registry().mutex);
+        registry().threads.insert(this);
+      }
+
+      ~ThreadProfile()
+      {
+        QMutexLocker lock(&registry().mutex);
+        registry().finished.merge(root);
+        registry().threads.erase(this);
+      }
+
+      /// guards root and stack: the owning thread records, other threads merge or clear them
+      QMutex mutex;
+      Profiler::Node root;
+      std::vector<Frame> stack;
+      Size next_id;
+    };
+
+    QThreadStorage<ThreadProfile*>& threadStorage()
+    {
+      static QThreadStorage<ThreadProfile*>* storage = new QThreadStorage<ThreadProfile*>();
+      return *storage;
+    }
+
+    ThreadProfile& threadProfile()
+    {
+      QThreadStorage<ThreadProfile*>& storage = threadStorage();
+      if (!storage.hasLocalData())
+      {
+        storage.setLocalData(new ThreadProfile());
+      }
+      return *storage.localData();
+    }
+
+    size_t currentMemory()
+    {
+      size_t memory = 0;
+      SysInfo::getProcessMemoryConsumption(memory);
+      return memory;
+    }
+
+    /// Closes the open stages of @p profile until @p depth stages remain open (the mutex of @p profile must be locked)
+    void closeFrames(ThreadProfile& profile, Size depth)
+    {
+      while (profile.stack.size() > depth)
+      {
+        Frame& frame = profile.stack.back();
+        frame.watch.stop();
+        frame.peak_memory = std::max(frame.peak_memory, currentMemory());
+
+        Profiler::Node* node = frame.node;
+        ++node->calls;
+        node->wall_time += frame.watch.getClockTime();
+        node->cpu_time += frame.watch.getCPUTime();
+        node->peak_memory = std::max(node->peak_memory, frame.peak_memory);
+
+        size_t peak_memory = frame.peak_memory;
+        profile.stack.pop_back();
+        if (!profile.stack.empty())
+        {
+          profile.stack.back().peak_memory = std::max(profile.stack.back().peak_memory, peak_memory);
+        }
+      }
+    }
+
+    String escapeJSON(const String& s)
+    {
+      String escaped;
+      for (Size i = 0; i < s.size(); ++i)
+      {
+        char c = s[i];
+        if (c == '"' || c == '\\')
+        {
+          escaped += '\\';
+          escaped += c;
+        }
+        else if ((unsigned char) c < 0x20)
+        {
+          escaped += ' ';
+        }
+        else
+        {
+          escaped += c;
+        }
+      }
+      return escaped;
+    }
+
+    void writeJSONNode(std::ostream& os, const String& name, const Profiler::Node& node, Size indent)
+    {
+      String pad(indent, ' ');
+      os << pad << "{\n"
+         << pad << "  \"name\": \"" << escapeJSON(name) << "\",\n"
+         << pad << "  \"calls\": " << node.calls << ",\n"
+         << pad << "  \"wall_time\": " << node.wall_time << ",\n"
+         << pad << "  \"cpu_time\": " << node.cpu_time << ",\n"
+         << pad << "  \"peak_memory\": " << node.peak_memory << ",\n"
+         << pad << "  \"counters\": {";
+      for (std::map<String, double>::const_iterator it = node.counters.begin(); it != node.counters.end(); ++it)
+      {
+        os << (it == node.counters.begin() ? "" : ", ") << "\"" << escapeJSON(it->first) << "\": " << it->second;
+      }
+      os << "},\n"
+         << pad << "  \"children\": [";
+      for (std::map<String, Profiler::Node*>::const_iterator it = node.children.begin(); it != node.children.end(); ++it)
+      {
+        os << (it == node.children.begin() ? "\n" : ",\n");
+        writeJSONNode(os, it->first, *it->second, indent + 4);
+      }
+      os << (node.children.empty() ? "" : "\n" + pad + "  ") << "]\n"
+         << pad << "}";
+    }
+
+    void writeFoldedNode(std::ostream& os, const String& path, const Profiler::Node& node)
+    {
+      // self time: the time not spent in nested stages
+      double self_time = node.wall_time;
+      for (std::map<String, Profiler::Node*>::const_iterator it = node.children.begin(); it != node.children.end(); ++it)
+      {
+        self_time -= it->second->wall_time;
+      }
+      os << path << " " << (UInt64)(std::max(0.0, self_time) * 1e6 + 0.5) << "\n";
+
+      for (std::map<String, Profiler::Node*>::const_iterator it = node.children.begin(); it != node.children.end(); ++it)
+      {
+        writeFoldedNode(os, path + ";" + String(it->first).substitute(';', ',').substitute(' ', '_'), *it->second);
+      }
+    }
+
+  }
+
+  Profiler::Node::Node() :
+    calls(0),
+    wall_time(0.0),
+    cpu_time(0.0),
+    peak_memory(0),
+    counters(),
+    children()
+  {
+  }
+
+  Profiler::Node::Node(const Node& rhs) :
+    calls(0),
+    wall_time(0.0),
+    cpu_time(0.0),
+    peak_memory(0),
+    counters(),
+    children()
+  {
+    merge(rhs);
+  }
+
+  Profiler::Node::~Node()
+  {
+    clear();
+  }
+
+  Profiler::Node& Profiler::Node::operator=(const Node& rhs)
+  {
+    if (&rhs == this) return *this;
+
+    clear();
+    merge(rhs);
+    return *this;
+  }
+
+  void Profiler::Node::merge(const Node& rhs)
+  {
+    calls += rhs.calls;
+    wall_time += rhs.wall_time;
+    cpu_time += rhs.cpu_time;
+    peak_memory = std::max(peak_memory, rhs.peak_memory);
+    for (std::map<String, double>::const_iterator it = rhs.counters.begin(); it != rhs.counters.end(); ++it)
+    {
+      counters[it->first] += it->second;
+    }
+    for (std::map<String, Node*>::const_iterator it = rhs.children.begin(); it != rhs.children.end(); ++it)
+    {
+      Node*& child = children[it->first];
+      if (child == 0)
+      {
+        child = new Node();
+      }
+      child->merge(*it->second);
+    }
+  }
+
+  void Profiler::Node::clear()
+  {
+    for (std::map<String, Node*>::iterator it = children.begin(); it != children.end(); ++it)
+    {
+      delete it->second;
+    }
+    children.clear();
+    counters.clear();
+    calls = 0;
+    wall_time = 0.0;
+    cpu_time = 0.0;
+    peak_memory = 0;
+  }
+
+  Profiler::Scope::Scope(const String& name) :
+    handle_(Profiler::startScope(name))
+  {
+  }
+
+  Profiler::Scope::~Scope()
+  {
+    Profiler::endScope(handle_);
+  }
+
+  Profiler::Session::Session(const String& name, const String& filename) :
+    filename_(filename),
+    scope_(0)
+  {
+    if (filename_ != "")
+    {
+      Profiler::clear();
+      Profiler::setEnabled(true);
+      scope_ = new Scope(name);
+    }
+  }
+
+  Profiler::Session::~Session()
+  {
+    if (scope_ == 0) return;
+
+    delete scope_;
+    Profiler::setEnabled(false);
+    try
+    {
+      Profiler::store(filename_);
+    }
+    catch (Exception::BaseException& e)
+    {
+      LOG_ERROR << "Error: Unable to write the profile (" << e.what() << ")" << std::endl;
+    }
+  }
+
+  void Profiler::setEnabled(bool enabled)
+  {
+    registry().enabled = enabled;
+  }
+
+  bool Profiler::isEnabled()
+  {
+    return registry().enabled;
+  }
+
+  Size Profiler::startScope(const String& name)
+  {
+    if (!registry().enabled) return 0;
+
+    ThreadProfile& profile = threadProfile();
+    QMutexLocker lock(&profile.mutex);
+    Node* parent = profile.stack.empty() ? &profile.root : profile.stack.back().node;
+    Node*& node = parent->children[name];
+    if (node == 0)
+    {
+      node = new Node();
+    }
+
+    Frame frame;
+    frame.id = ++profile.next_id;
+    frame.node = node;
+    frame.peak_memory = currentMemory();
+    profile.stack.push_back(frame);
+    profile.stack.back().watch.start();
+    return frame.id;
+  }
+
+  void Profiler::endScope(Size handle)
+  {
+    // stages opened while profiling was enabled are still closed after disabling it
+    if (handle == 0 || !threadStorage().hasLocalData()) return;
+
+    ThreadProfile& profile = threadProfile();
+    QMutexLocker lock(&profile.mutex);
+    for (Size i = profile.stack.size(); i > 0; --i)
+    {
+      if (profile.stack[i - 1].id == handle)
+      {
+        closeFrames(profile, i - 1);
+        return;
+      }
+    }
+  }
+
+  void Profiler::endScope()
+  {
+    if (!threadStorage().hasLocalData()) return;
+
+    ThreadProfile& profile = threadProfile();
+    QMutexLocker lock(&profile.mutex);
+    if (!profile.stack.empty())
+    {
+      closeFrames(profile, profile.stack.size() - 1);
+    }
+  }
+
+  void Profiler::addToCounter(const String& name, double value)
+  {
+    if (!registry().enabled) return;
+
+    ThreadProfile& profile = threadProfile();
+    QMutexLocker lock(&profile.mutex);
+    Node* node = profile.stack.empty() ? &profile.root : profile.stack.back().node;
+    node->counters[name] += value;
+  }
+
+  void Profiler::sampleMemory()
+  {
+    if (!registry().enabled) return;
+
+    ThreadProfile& profile = threadProfile();
+    QMutexLocker lock(&profile.mutex);
+    if (!profile.stack.empty())
+    {
+      // propagated to the enclosing stages when closing the stage
+      profile.stack.back().peak_memory = std::max(profile.stack.back().peak_memory, currentMemory());
+    }
+  }
+
+  void Profiler::clear()
+  {
+    QMutexLocker lock(&registry().mutex);
+    registry().finished.clear();
+    for (std::set<ThreadProfile*>::iterator it = registry().threads.begin(); it != registry().threads.end(); ++it)
+    {
+      // the open stages refer to nodes of the tree, so they are dropped as well
+      QMutexLocker thread_lock(&(*it)->mutex);
+      (*it)->root.clear();
+      (*it)->stack.clear();
+    }
+  }
+
+  void Profiler::getProfile(Node& root)
+  {
+    QMutexLocker lock(&registry().mutex);
+    root = registry().finished;
+    for (std::set<ThreadProfile*>::const_iterator it = registry().threads.begin(); it != registry().threads.end(); ++it)
+    {
+      QMutexLocker thread_lock(&(*it)->mutex);
+      root.merge((*it)->root);
+    }
+  }
+
+  void Profiler::writeJSON(std::ostream& os)
+  {
+    Node root;
+    getProfile(root);
+
+    os << "{\n"
+       << "  \"version\": \"" << VersionInfo::getVersion() << "\",\n"
+       << "  \"stages\": [";
+    for (std::map<String, Node*>::const_iterator it = root.children.begin(); it != root.children.end(); ++it)
+    {
+      os << (it == root.children.begin() ? "\n" : ",\n");
+      writeJSONNode(os, it->first, *it->second, 4);
+    }
+    os << (root.children.empty() ? "" : "\n  ") << "]\n"
+       << "}\n";
+  }
+
+  void Profiler::writeFoldedStacks(std::ostream& os)
+  {
+    Node root;
+    getProfile(root);
+
+    for (std::map<String, Node*>::const_iterator it = root.children.begin(); it != root.children.end(); ++it)
+    {
+      writeFoldedNode(os, String(it->first).substitute(';', ',').substitute(' ', '_'), *it->second);
+    }
+  }
+
+  void Profiler::store(const String& filename)
+  {
+    ofstream os(filename.c_str());
+    if (!os)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename);
+    }
+    if (filename.hasSuffix(".json"))
+    {
+      writeJSON(os);
+    }
+    else
+    {
+      writeFoldedStacks(os);
+    }
+    os.close();
+  }
+
+} // namespace OpenMS
@@ -6,6 +6,7 @@ set(sources_list
 File.cpp
 FileWatcher.cpp
 JavaInfo.cpp
+Profiler.cpp
 StopWatch.cpp
 SysInfo.cpp
 )
@@ -52,6 +52,7 @@
 #include <OpenMS/VISUAL/TOPPViewIdentificationViewBehavior.h>
 
 //STL
+#include <deque>
 #include <map>
 
 //QT
@@ -88,6 +89,7 @@ namespace OpenMS
   class ToolsDialog;
   class MultiGradientSelector;
   class FileWatcher;
+  class LayerDataLoader;
 
   /**
     @brief Main window of TOPPView tool
@@ -148,8 +150,9 @@ public:
       @param add_to_recent If the file should be added to the recent files after opening
       @param window_id in which window the file is opened if opened as a new layer (0 or default equals current window).
       @param spectrum_id determines the spectrum to show in 1D view.
+      @param in_background If the file should be parsed in a background thread. The data is added when loading finished, peak maps are shown as preview layer before (see 'preferences:preview_spectra').
     */
-    void addDataFile(const String& filename, bool show_options, bool add_to_recent, String caption = "", UInt window_id = 0, Size spectrum_id = 0);
+    void addDataFile(const String& filename, bool show_options, bool add_to_recent, String caption = "", UInt window_id = 0, Size spectrum_id = 0, bool in_background = false);
 
     /**
       @brief Adds a peak or feature map to the viewer
@@ -168,7 +171,11 @@ public:
     */
     void addData(FeatureMapSharedPtrType feature_map, ConsensusMapSharedPtrType consensus_map, std::vector<PeptideIdentification>& peptides, ExperimentSharedPtrType peak_map, LayerData::DataType data_type, bool show_as_1d, bool show_options, bool as_new_window = true, const String& filename = "", const String& caption = "", UInt window_id = 0, Size spectrum_id = 0);
 
-    /// Opens all the files in the string list
+    /**
+      @brief Opens all the files in the string list
+
+      The files are parsed concurrently in the background, the layers are added in the order of the list.
+    */
     void loadFiles(const StringList& list, QSplashScreen* splash_screen);
 
     /**
@@ -323,6 +330,9 @@ public slots:
     /// Loads a file given by the passed string
     void loadFile(QString);
 
+    /// Cancels loading of all files that are loaded in the background
+    void abortLoading();
+
 protected slots:
     /** @name Layer manager and filter manager slots
     */
@@ -374,6 +384,12 @@ protected slots:
 
     /// Called if a data file has been externally changed
     void fileChanged_(const String&);
+
+    /// Called when a file loaded in the background provides a preview of its peak data
+    void loadPreviewReady_(LayerDataLoader* loader);
+
+    /// Called when a file loaded in the background was loaded
+    void loadFinished_(LayerDataLoader* loader);
 protected:
     /// Initializes the default parameters on TOPPView construction.
     void initializeDefaultParameters_();
@@ -509,6 +525,59 @@ protected:
     } topp_;
     //@}
 
+    /// @name Loading of data files
+    //@{
+    /// Options of addDataFile() / loadFiles() for a file that is loaded in the background
+    struct PendingLoad_
+    {
+      PendingLoad_() :
+        show_options(false), add_to_recent(false), caption(), window_id(0), spectrum_id(0),
+        filename(), add_to_active_window(false), ordered(false), commands(), preview(), adding_preview(false), finished(false)
+      {
+      }
+
+      bool show_options;
+      bool add_to_recent;
+      String caption;
+      UInt window_id;
+      Size spectrum_id;
+      /// File name as passed to addDataFile()
+      String filename;
+      /// Open in the active window instead of the one given by window_id (loadFiles() '+')
+      bool add_to_active_window;
+      /// Part of loadFiles(), added in the order of load_queue_
+      bool ordered;
+      /// loadFiles() commands applied after the layer was added (e.g. '@bw')
+      StringList commands;
+      /// Peak data of the preview layer (null if no preview is shown)
+      ExperimentSharedPtrType preview;
+      /// Set while the preview layer is added (options dialog)
+      bool adding_preview;
+      /// Loading finished while the preview layer was added
+      bool finished;
+    };
+    /// Checks the file and creates a loader for it. Returns 0 (and logs the error) if the file cannot be opened.
+    LayerDataLoader* createLoader_(const String& filename, Size preview_size);
+    /// Starts loading a file in the background
+    void startLoader_(LayerDataLoader* loader, const PendingLoad_& pending);
+    /// Adds the data of a finished loader (or replaces its preview)
+    void finishLoading_(LayerDataLoader* loader, const PendingLoad_& pending);
+    /// Adds the data of the finished loads of loadFiles() in the order of the list
+    void processLoadQueue_();
+    /// Replaces the peak data of all layers showing @p preview by @p peak_map (if not null). Returns false if no such layer is left.
+    bool replacePreview_(ExperimentSharedPtrType preview, ExperimentSharedPtrType peak_map);
+    /// Stops the intensity pyramid computations of all layers showing @p peak_map (required before @p peak_map is modified)
+    void cancelPyramids_(ExperimentSharedPtrType peak_map);
+    /// Applies a loadFiles() command (e.g. '@bw') to the current layer
+    void applyLayerCommand_(const String& command);
+    /// Files that are loaded in the background
+    std::map<LayerDataLoader*, PendingLoad_> pending_loads_;
+    /// Loads of loadFiles() in the order of the list
+    std::deque<LayerDataLoader*> load_queue_;
+    /// Set while processLoadQueue_() adds data (it may be called recursively from dialogs)
+    bool processing_load_queue_;
+    //@}
+
     /// check if all available preferences get set by the .ini file. If there are some missing entries fill them with default values.
     void checkPreferences_();
     ///@name reimplemented Qt events
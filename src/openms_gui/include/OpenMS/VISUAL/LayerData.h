@@ -43,6 +43,7 @@
 #include <OpenMS/KERNEL/ConsensusMap.h>
 #include <OpenMS/DATASTRUCTURES/String.h>
 #include <OpenMS/VISUAL/MultiGradient.h>
+#include <OpenMS/VISUAL/PeakMapPyramid.h>
 #include <OpenMS/VISUAL/ANNOTATION/Annotations1DContainer.h>
 #include <OpenMS/FILTERING/DATAREDUCTION/DataFilters.h>
 
@@ -122,6 +123,9 @@ public:
     /// SharedPtr on MSExperiment
     typedef boost::shared_ptr<ExperimentType> ExperimentSharedPtrType;
 
+    /// SharedPtr on the intensity pyramid of the peak data
+    typedef boost::shared_ptr<PeakMapPyramid> PyramidSharedPtrType;
+
     //@}
 
     /// Default constructor
@@ -140,6 +144,7 @@ public:
       modifiable(false),
       modified(false),
       label(L_NONE),
+      pyramid(),
       features(new FeatureMapType()),
       consensus(new ConsensusMapType()),
       peaks(new ExperimentType()),
@@ -307,6 +312,9 @@ public:
     /// Label type
     LabelType label;
 
+    /// Maximum intensity pyramid of the peak data (2D view), computed in the background (cancel it before modifying the peak data)
+    PyramidSharedPtrType pyramid;
+
 private:
     /// feature data
     FeatureMapSharedPtrType features;
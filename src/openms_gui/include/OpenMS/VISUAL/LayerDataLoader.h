@@ -0,0 +1,239 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_VISUAL_LAYERDATALOADER_H
+#define OPENMS_VISUAL_LAYERDATALOADER_H
+
+// OpenMS_GUI config
+#include <OpenMS/VISUAL/OpenMS_GUIConfig.h>
+
+#include <OpenMS/CONCEPT/ProgressLogger.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/FORMAT/FileTypes.h>
+#include <OpenMS/METADATA/PeptideIdentification.h>
+#include <OpenMS/VISUAL/LayerData.h>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+
+#include <vector>
+
+class QTimer;
+
+namespace OpenMS
+{
+  /**
+    @brief Loads the data of a layer from a file, optionally in a background thread
+
+    run() loads the file in the calling thread, just like TOPPView always did.
+    start() parses the file in a worker thread and emits finished() when done.
+    The progress is reported through the ProgressLogger interface (from the
+    thread that called start()) and the loading can be stopped with cancel().
+
+    mzML files loaded in the background are parsed spectrum by spectrum, so
+    they report their actual progress and cancellation takes effect
+    immediately. If a preview size is given, previewReady() is emitted as soon
+    as a coarse version of the peak data is available: every n-th spectrum,
+    read through the index of an indexed mzML file that has an up-to-date
+    SpectrumMetaIndex (see PeakFileOptions::setWriteSpectrumMetaIndex()), or
+    else the first spectra of the file. All other formats are loaded as a
+    whole; canceling them discards the data once the parser returns.
+
+    @ingroup SpectrumWidgets
+  */
+  class OPENMS_GUI_DLLAPI LayerDataLoader :
+    public QObject,
+    public ProgressLogger
+  {
+    Q_OBJECT
+
+public:
+    ///@name Type definitions
+    //@{
+    /// Feature map managed type
+    typedef LayerData::FeatureMapSharedPtrType FeatureMapSharedPtrType;
+    /// Consensus map managed type
+    typedef LayerData::ConsensusMapSharedPtrType ConsensusMapSharedPtrType;
+    /// Peak map type
+    typedef LayerData::ExperimentType ExperimentType;
+    /// Peak map managed type
+    typedef LayerData::ExperimentSharedPtrType ExperimentSharedPtrType;
+    //@}
+
+    /**
+      @brief Constructor
+
+      @param filename The (absolute) name of the file to load
+      @param type The type of the file
+      @param preview_size Number of spectra of the preview (0 disables the preview)
+      @param parent The parent object
+    */
+    LayerDataLoader(const String & filename, FileTypes::Type type, Size preview_size = 0, QObject * parent = 0);
+
+    /// Destructor (cancels and waits for a running background thread)
+    ~LayerDataLoader();
+
+    /// Loads the file in the calling thread
+    void run();
+
+    /// Loads the file in a background thread
+    void start();
+
+    /// Requests to stop loading
+    void cancel();
+
+    /// Returns if cancel() was called
+    bool isCanceled() const;
+
+    /// Returns if the loading finished (successfully or not)
+    bool isFinished() const;
+
+    /// Returns the name of the file
+    const String & getFilename() const;
+
+    /// Returns the data type of the loaded data
+    LayerData::DataType getDataType() const;
+
+    /// Returns the error message if loading failed (empty otherwise)
+    const String & getErrorMessage() const;
+
+    /// Returns warnings that occurred while loading (empty if there were none)
+    const String & getWarningMessage() const;
+
+    /// Returns the loaded feature data
+    FeatureMapSharedPtrType getFeatureMap() const;
+
+    /// Returns the loaded consensus feature data
+    ConsensusMapSharedPtrType getConsensusMap() const;
+
+    /// Returns the loaded peak data
+    ExperimentSharedPtrType getPeakMap() const;
+
+    /// Returns the loaded peptide identifications
+    std::vector<PeptideIdentification> & getPeptides();
+
+    /// Returns the preview of the peak data (null before previewReady() was emitted)
+    ExperimentSharedPtrType getPreview() const;
+
+signals:
+    /// Emitted when a preview of the peak data is available (see getPreview())
+    void previewReady(LayerDataLoader * loader);
+
+    /// Emitted when the background thread finished
+    void finished(LayerDataLoader * loader);
+
+protected slots:
+    /// Emits previewReady() in the thread of this object
+    void emitPreviewReady_();
+
+    /// Emits finished() and ends the progress display
+    void emitFinished_();
+
+    /// Updates the progress display
+    void updateProgress_();
+
+protected:
+    /// Consumer used to parse mzML files in the background
+    class MzMLConsumer_;
+    friend class MzMLConsumer_;
+
+    /// Loads the data; @p background selects the cancelable mzML parser and disables the progress logging of the parsers
+    void load_(bool background);
+
+    /// Loads an mzML file spectrum by spectrum
+    void loadMzML_();
+
+    /**
+      @brief Reads every n-th spectrum of an indexed mzML file as preview
+
+      The spectra are read via the offsets of the index. Retention times and MS levels are taken from the SpectrumMetaIndex;
+      if there is none, the meta data of the file is parsed instead (without the peak data).
+
+      @return @em false if the file is not indexed or has not more spectra than the preview
+    */
+    bool loadOverview_();
+
+    /// Stores a preview and schedules previewReady()
+    void setPreview_(const ExperimentType & spectra);
+
+    /// Name of the file
+    String filename_;
+    /// Type of the file
+    FileTypes::Type file_type_;
+    /// Number of spectra of the preview
+    Size preview_size_;
+    /// Type of the loaded data
+    LayerData::DataType data_type_;
+    /// Error message
+    String error_;
+    /// Warning message
+    String warning_;
+    /// Loaded feature data
+    FeatureMapSharedPtrType feature_map_;
+    /// Loaded consensus feature data
+    ConsensusMapSharedPtrType consensus_map_;
+    /// Loaded peak data
+    ExperimentSharedPtrType peak_map_;
+    /// Loaded peptide identifications
+    std::vector<PeptideIdentification> peptides_;
+    /// Preview of the peak data
+    ExperimentSharedPtrType preview_;
+    /// Guards preview_
+    mutable QMutex preview_mutex_;
+    /// Set by cancel()
+    mutable QAtomicInt cancel_;
+    /// Number of spectra parsed so far
+    QAtomicInt progress_;
+    /// Number of spectra in the file (0 if unknown)
+    QAtomicInt expected_size_;
+    /// If finished() was emitted
+    bool finished_;
+    /// Watches the background thread
+    QFutureWatcher<void> watcher_;
+    /// Triggers progress updates
+    QTimer * timer_;
+
+private:
+    /// Not implemented
+    LayerDataLoader(const LayerDataLoader &);
+
+    /// Not implemented
+    LayerDataLoader & operator=(const LayerDataLoader &);
+  };
+
+} // namespace OpenMS
+
+#endif // OPENMS_VISUAL_LAYERDATALOADER_H
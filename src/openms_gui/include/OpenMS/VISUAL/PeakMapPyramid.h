@@ -0,0 +1,206 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_VISUAL_PEAKMAPPYRAMID_H
+#define OPENMS_VISUAL_PEAKMAPPYRAMID_H
+
+// OpenMS_GUI config
+#include <OpenMS/VISUAL/OpenMS_GUIConfig.h>
+
+#include <OpenMS/KERNEL/MSExperiment.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QFuture>
+
+#include <boost/shared_ptr.hpp>
+
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+    @brief Multi-resolution maximum intensity pyramid of the MS1 data of a peak map
+
+    The base level is a grid of at most @p max_rt_bins x @p max_mz_bins equally
+    sized RT / m/z bins that stores the maximum intensity of all MS1 peaks
+    falling into each bin. Each following level halves the resolution in both
+    dimensions by taking the maximum of 2x2 bins, until a single bin is left.
+
+    The 2D view uses the coarsest level whose bins are still smaller than one
+    pixel (see findLevel()) to draw zoomed-out heatmaps in time proportional to
+    the number of pixels instead of the number of peaks.
+
+    The pyramid can be computed in a background thread (buildAsync()). Until
+    isReady() returns @em true the level data must not be accessed. Optionally,
+    the pyramid is stored in a binary cache file and reused as long as the
+    data file has not changed (see store() and load()).
+
+    @ingroup SpectrumWidgets
+  */
+  class OPENMS_GUI_DLLAPI PeakMapPyramid
+  {
+public:
+    /// Peak map type
+    typedef MSExperiment<> ExperimentType;
+
+    /// Shared pointer to a peak map
+    typedef boost::shared_ptr<ExperimentType> ExperimentSharedPtrType;
+
+    /// One resolution level of the pyramid
+    struct Level
+    {
+      /// Number of bins in RT dimension
+      Size rt_bins;
+      /// Number of bins in m/z dimension
+      Size mz_bins;
+      /// Width of a bin in RT dimension
+      double rt_bin_size;
+      /// Width of a bin in m/z dimension
+      double mz_bin_size;
+      /// Maximum intensities, row-major in RT (negative for bins without peaks)
+      std::vector<float> data;
+    };
+
+    /// Constructor
+    PeakMapPyramid(Size max_rt_bins = 2048, Size max_mz_bins = 4096);
+
+    /// Destructor (cancels a running background computation)
+    ~PeakMapPyramid();
+
+    /// Computes the pyramid of the MS1 spectra of @p map in the calling thread
+    void build(const ExperimentType & map);
+
+    /**
+      @brief Computes the pyramid of the MS1 spectra of @p map in a background thread
+
+      If @p cache_file is given, the pyramid is read from it when it is
+      up-to-date with respect to @p data_file. Otherwise it is computed and
+      written to @p cache_file (failures to write are ignored).
+
+      The peak map must not be modified until isReady() returns @em true or
+      cancel() was called.
+    */
+    void buildAsync(ExperimentSharedPtrType map, const String & data_file = "", const String & cache_file = "");
+
+    /// Stops a running background computation and waits for it to finish
+    void cancel();
+
+    /// Returns if the pyramid was computed completely
+    bool isReady() const;
+
+    /// Returns the number of levels
+    Size getNumberOfLevels() const;
+
+    /// Returns the level with index @p index (0 is the finest level)
+    const Level & getLevel(Size index) const;
+
+    /// Returns the lower RT boundary of the first bin
+    double getMinRT() const;
+
+    /// Returns the lower m/z boundary of the first bin
+    double getMinMZ() const;
+
+    /**
+      @brief Returns the coarsest level whose bins are not larger than @p rt_step x @p mz_step
+
+      Returns -1 if the pyramid is not ready or even the finest level is too coarse.
+    */
+    SignedSize findLevel(double rt_step, double mz_step) const;
+
+    /**
+      @brief Returns the maximum intensity of all bins of level @p level whose centers lie in [@p rt_start, @p rt_end) x [@p mz_start, @p mz_end)
+
+      Returns a negative value if the area contains no peaks.
+    */
+    float getMaximum(Size level, double rt_start, double rt_end, double mz_start, double mz_end) const;
+
+    /**
+      @brief Writes the pyramid to the binary cache file @p filename
+
+      Size and modification time of @p data_file are stored along with the
+      pyramid so that outdated cache files can be detected by load().
+
+      @return @em false if the pyramid is not ready or the file could not be written
+    */
+    bool store(const String & filename, const String & data_file) const;
+
+    /**
+      @brief Reads the pyramid from the binary cache file @p filename
+
+      @return @em false if the file does not exist, is invalid or was written for another version of @p data_file
+    */
+    bool load(const String & filename, const String & data_file);
+
+    /// Returns the default name of the cache file for the data file @p data_file
+    static String getCacheFilename(const String & data_file);
+
+protected:
+    /// Computes the pyramid, stopping early if cancel_ is set (returns @em false in that case)
+    bool build_(const ExperimentType & map);
+
+    /// Background task started by buildAsync()
+    void buildAsync_(ExperimentSharedPtrType map, String data_file, String cache_file);
+
+    /// Computes levels 1 to n from the base level
+    void downsample_();
+
+    /// Maximum number of base level bins in RT dimension
+    Size max_rt_bins_;
+    /// Maximum number of base level bins in m/z dimension
+    Size max_mz_bins_;
+    /// Lower RT boundary of the first bin
+    double rt_min_;
+    /// Lower m/z boundary of the first bin
+    double mz_min_;
+    /// The levels, starting with the finest one
+    std::vector<Level> levels_;
+    /// Set when all levels were computed
+    mutable QAtomicInt ready_;
+    /// Set to stop the background computation
+    QAtomicInt cancel_;
+    /// Background computation
+    QFuture<void> future_;
+
+private:
+    /// Not implemented
+    PeakMapPyramid(const PeakMapPyramid &);
+
+    /// Not implemented
+    PeakMapPyramid & operator=(const PeakMapPyramid &);
+  };
+
+} // namespace OpenMS
+
+#endif // OPENMS_VISUAL_PEAKMAPPYRAMID_H
@@ -188,6 +188,16 @@ protected:
     */
     void paintMaximumIntensities_(Size layer_index, Size rt_pixel_count, Size mz_pixel_count, QPainter& p);
 
+    /**
+      @brief Starts the background computation of the intensity pyramid of a peak layer
+
+      The pyramid is used by paintMaximumIntensities_() once it is ready.
+
+      @param layer_index The index of the layer.
+      @param use_cache If the pyramid may be read from / written to a cache file next to the data file (see 'pyramid_cache' parameter).
+    */
+    void computePyramid_(Size layer_index, bool use_cache);
+
     /**
       @brief Paints the precursor peaks.
 
@@ -43,6 +43,8 @@
 #include <OpenMS/VISUAL/TOPPASToolVertex.h>
 
 #include <QtGui/QGraphicsScene>
+#include <QtCore/QHash>
+#include <QtCore/QPair>
 #include <QtCore/QProcess>
 
 namespace OpenMS
@@ -94,11 +96,12 @@ public:
     struct TOPPProcess
     {
       /// Constructor
-      TOPPProcess(QProcess * p, const QString & cmd, const QStringList & arg, TOPPASToolVertex * const tool) :
+      TOPPProcess(QProcess * p, const QString & cmd, const QStringList & arg, TOPPASToolVertex * const tool, int num_threads = 1) :
         proc(p),
         command(cmd),
         args(arg),
-        tv(tool)
+        tv(tool),
+        threads(num_threads)
       {
       }
 
@@ -110,6 +113,8 @@ public:
       QStringList args;
       /// The tool which is started (used to call its slots)
       TOPPASToolVertex * tv;
+      /// The number of threads the process uses (counted against the allowed threads)
+      int threads;
     };
 
     /// The current action mode (creation of a new edge, or panning of the widget)
@@ -207,7 +212,12 @@ public:
     bool askForOutputDir(bool always_ask = true);
     /// Enqueues the process, it will be run when the currently pending processes have finished
     void enqueueProcess(const TOPPProcess & process);
-    /// Runs the next process in the queue, if any
+    /**
+      @brief Runs the next processes in the queue, if any
+
+      Processes of tools on the longest remaining path through the pipeline are started first,
+      as long as their threads fit into the allowed threads (see setAllowedThreads()).
+    */
     void runNextProcess();
     /// Resets the processes queue
     void resetProcessesQueue();
@@ -239,6 +249,23 @@ public:
     void setDescription(const QString & desc);
     /// sets the maximum number of jobs
     void setAllowedThreads(int num_threads);
+    /// returns the maximum number of jobs
+    int getAllowedThreads() const;
+    /**
+      @brief Sets the directory of the result cache (empty to disable caching)
+
+      Tool results are stored under a key computed from the tool, its parameters and the content of its input files.
+      A tool whose key is found in the cache is not run again, its results are copied from the cache instead.
+    */
+    void setCacheDirectory(const QString & dir);
+    /// Returns the directory of the result cache (empty if caching is disabled)
+    const QString & getCacheDirectory() const;
+    /// Returns the SHA1 hash of the content of @p file (hashes are reused as long as the file is unchanged)
+    QByteArray getFileHash(const QString & file);
+    /// Copies the cached results for @p key to @p files, returns false if there are none (or they do not match)
+    bool fetchCachedResults(const QString & key, const QStringList & files);
+    /// Stores the result @p files under @p key in the cache
+    void storeCachedResults(const QString & key, const QStringList & files);
     /// returns the hovering edge
     TOPPASEdge* getHoveringEdge();
     /// Checks whether all output vertices are finished, and if yes, emits entirePipelineFinished() (called by finished output vertices)
@@ -272,8 +299,8 @@ public slots:
     void changedParameter(const bool invalidates_running_pipeline);
     /// Invoked by OutfilelistVertex of user changed the folder name
     void changedOutputFolder();
-    /// Called by a finished QProcess to indicate that we are free to start a new one
-    void processFinished();
+    /// Called by a finished QProcess to indicate that we are free to start a new one (@p threads are the threads it used)
+    void processFinished(int threads = 1);
     /// dirty solution: when using ExecutePipeline this slot is called when the pipeline crashes. This will quit the app
     void quitWithError();
 
@@ -360,6 +387,15 @@ protected:
     int allowed_threads_;
     /// last node where 'resume' was started
     TOPPASToolVertex* resume_source_;
+    /// number of tool vertices on the longest path starting at a vertex (determines the order of queued processes)
+    QHash<TOPPASVertex*, int> critical_path_;
+    /// directory of the result cache (empty if disabled)
+    QString cache_dir_;
+    /// file hashes, together with the size and modification time of the file they were computed for
+    QHash<QString, QPair<QString, QByteArray> > file_hashes_;
+
+    /// Returns the number of tool vertices on the longest path starting at @p tv (memoized in critical_path_)
+    int getCriticalPathLength_(TOPPASVertex * tv);
 
     /// Returns the vertex in the foreground at position @p pos , if existent, otherwise 0.
     TOPPASVertex * getVertexAt_(const QPointF & pos);
@@ -41,6 +41,8 @@
 #include <OpenMS/VISUAL/TOPPASVertex.h>
 #include <OpenMS/DATASTRUCTURES/Param.h>
 
+#include <QtCore/QHash>
+#include <QtCore/QPair>
 #include <QtCore/QVector>
 
 namespace OpenMS
@@ -238,6 +240,8 @@ protected:
     void getParameters_(QVector<IOInfo> & io_infos, bool input_params) const;
     /// Writes @p param to the @p ini_file
     void writeParam_(const Param & param, const QString & ini_file);
+    /// Returns the result cache key of a round with the parameters @p param, the @p inputs and the @p outputs (see TOPPASScene::setCacheDirectory())
+    QString computeCacheKey_(const Param & param, const RoundPackage & inputs, const RoundPackage & outputs);
     /// Helper method for finding good boundaries for wrapping the tool name. Returns a string with whitespaces at the preferred boundaries.
     QString toolnameWithWhitespacesForFancyWordWrapping_(QPainter * painter, const QString & str);
 
@@ -260,6 +264,11 @@ protected:
     /// Breakpoint set?
     bool breakpoint_set_;
 
+    /// number of threads each process of the current run uses
+    int threads_;
+    /// cache key and output files of the running processes whose results are stored in the result cache
+    QHash<QObject *, QPair<QString, QStringList> > cache_entries_;
+
     /// smart naming of round-based filenames
     /// when basename is not unique we take the preceding directory name
     void smartFileNames_(std::vector< QStringList >& filenames);
@@ -7,6 +7,7 @@ AxisWidget.h
 ColorSelector.h
 EnhancedTabBar.h
 HistogramWidget.h
+LayerDataLoader.h
 MetaDataBrowser.h
 MultiGradientSelector.h
 ParamEditor.h
@@ -65,10 +66,12 @@ EnhancedTabBar.h
 GUIProgressLoggerImpl.h
 HistogramWidget.h
 LayerData.h
+LayerDataLoader.h
 MetaDataBrowser.h
 MultiGradient.h
 MultiGradientSelector.h
 ParamEditor.h
+PeakMapPyramid.h
 SpectraViewWidget.h
 SpectraIdentificationViewWidget.h
 Spectrum1DCanvas.h
@@ -820,6 +820,8 @@ namespace OpenMS
       tw->show();
     }
     TOPPASScene* scene = tw->getScene();
+    // results are reused when the pipeline is run again in this session
+    scene->setCacheDirectory((tmp_path_ + "/cache").toQString());
     connect(scene, SIGNAL(saveMe()), this, SLOT(savePipeline()));
     connect(scene, SIGNAL(selectionCopied(TOPPASScene*)), this, SLOT(saveToClipboard(TOPPASScene*)));
     connect(scene, SIGNAL(requestClipboardContent()), this, SLOT(sendClipboardContent()));
@@ -77,6 +77,7 @@
 #include <OpenMS/VISUAL/MultiGradientSelector.h>
 #include <OpenMS/VISUAL/EnhancedTabBar.h>
 #include <OpenMS/VISUAL/EnhancedWorkspace.h>
+#include <OpenMS/VISUAL/LayerDataLoader.h>
 
 
 //Qt
@@ -127,7 +128,8 @@ namespace OpenMS
     QMainWindow(parent),
     DefaultParamHandler("TOPPViewBase"),
     watcher_(0),
-    watcher_msgbox_(false)
+    watcher_msgbox_(false),
+    processing_load_queue_(false)
   {
 #if defined(__APPLE__)
     // we do not want to load plugins as this leads to serious problems
@@ -199,6 +201,7 @@ namespace OpenMS
     file->addAction("&Open file", this, SLOT(openFileDialog()), Qt::CTRL + Qt::Key_O);
     file->addAction("Open &example file", this, SLOT(openExampleDialog()));
     file->addAction("&Close", this, SLOT(closeFile()), Qt::CTRL + Qt::Key_W);
+    file->addAction("Abort loading", this, SLOT(abortLoading()));
     file->addSeparator();
 
     //Meta data
@@ -596,6 +599,8 @@ namespace OpenMS
     defaults_.setValidStrings("preferences:on_file_change", ListUtils::create<String>("none,ask,update automatically"));
     defaults_.setValue("preferences:topp_cleanup", "true", "If the temporary files for calling of TOPP tools should be removed after the call.");
     defaults_.setValidStrings("preferences:topp_cleanup", ListUtils::create<String>("true,false"));
+    defaults_.setValue("preferences:preview_spectra", 500, "Number of spectra shown as preview while a peak map is loaded in the background (0 disables the preview).");
+    defaults_.setMinInt("preferences:preview_spectra", 0);
     // 1d view
     Spectrum1DCanvas* def1 = new Spectrum1DCanvas(Param(), 0);
     defaults_.insert("preferences:1d:", def1->getDefaults());
@@ -1057,18 +1062,50 @@ namespace OpenMS
     return filename_set;
   }
 
-  void TOPPViewBase::addDataFile(const String& filename, bool show_options, bool add_to_recent, String caption, UInt window_id, Size spectrum_id)
+  void TOPPViewBase::addDataFile(const String& filename, bool show_options, bool add_to_recent, String caption, UInt window_id, Size spectrum_id, bool in_background)
   {
     setCursor(Qt::WaitCursor);
 
+    Size preview_size = in_background ? (UInt)param_.getValue("preferences:preview_spectra") : 0;
+    LayerDataLoader* loader = createLoader_(filename, preview_size);
+    if (loader == 0)
+    {
+      setCursor(Qt::ArrowCursor);
+      return;
+    }
+
+    PendingLoad_ pending;
+    pending.filename = filename;
+    pending.show_options = show_options;
+    pending.add_to_recent = add_to_recent;
+    pending.caption = caption;
+    pending.window_id = window_id;
+    pending.spectrum_id = spectrum_id;
+
+    if (in_background)
+    {
+      startLoader_(loader, pending);
+    }
+    else
+    {
+      loader->run();
+      finishLoading_(loader, pending);
+      delete loader;
+    }
+
+    // reset cursor
+    setCursor(Qt::ArrowCursor);
+  }
+
+  LayerDataLoader* TOPPViewBase::createLoader_(const String& filename, Size preview_size)
+  {
     String abs_filename = File::absolutePath(filename);
 
     // check if the file exists
     if (!File::exists(abs_filename))
     {
       showLogMessage_(LS_ERROR, "Open file error", String("The file '") + abs_filename + "' does not exist!");
-      setCursor(Qt::ArrowCursor);
-      return;
+      return 0;
     }
 
     // determine file type
@@ -1077,103 +1114,160 @@ namespace OpenMS
     if (file_type == FileTypes::UNKNOWN)
     {
       showLogMessage_(LS_ERROR, "Open file error", String("Could not determine file type of '") + abs_filename + "'!");
-      setCursor(Qt::ArrowCursor);
-      return;
+      return 0;
     }
 
     // abort if file type unsupported
     if (file_type == FileTypes::INI)
     {
       showLogMessage_(LS_ERROR, "Open file error", String("The type '") + FileTypes::typeToName(file_type) + "' is not supported!");
-      setCursor(Qt::ArrowCursor);
-      return;
+      return 0;
     }
 
-    //try to load data and determine if it's 1D or 2D data
+    LayerDataLoader* loader = new LayerDataLoader(abs_filename, file_type, preview_size, this);
+    loader->setLogType(ProgressLogger::GUI);
+    return loader;
+  }
 
-    // create shared pointer to main data types
-    FeatureMapType* feature_map = new FeatureMapType();
-    FeatureMapSharedPtrType feature_map_sptr(feature_map);
+  void TOPPViewBase::startLoader_(LayerDataLoader* loader, const PendingLoad_& pending)
+  {
+    pending_loads_[loader] = pending;
+    connect(loader, SIGNAL(previewReady(LayerDataLoader*)), this, SLOT(loadPreviewReady_(LayerDataLoader*)));
+    connect(loader, SIGNAL(finished(LayerDataLoader*)), this, SLOT(loadFinished_(LayerDataLoader*)));
+    loader->start();
+    updateMenu();
+  }
 
-    ExperimentType* peak_map = new ExperimentType();
-    ExperimentSharedPtrType peak_map_sptr(peak_map);
+  void TOPPViewBase::abortLoading()
+  {
+    for (std::map<LayerDataLoader*, PendingLoad_>::iterator it = pending_loads_.begin(); it != pending_loads_.end(); ++it)
+    {
+      it->first->cancel();
+    }
+  }
 
-    ConsensusMapType* consensus_map = new ConsensusMapType();
-    ConsensusMapSharedPtrType consensus_map_sptr(consensus_map);
+  void TOPPViewBase::loadPreviewReady_(LayerDataLoader* loader)
+  {
+    std::map<LayerDataLoader*, PendingLoad_>::iterator it = pending_loads_.find(loader);
+    if (it == pending_loads_.end() || it->second.ordered || loader->isCanceled())
+    {
+      return;
+    }
+    PendingLoad_& pending = it->second;
+
+    ExperimentSharedPtrType preview = loader->getPreview();
+    if (!TOPPViewBase::containsMS1Scans(*preview))
+    {
+      return;
+    }
 
-    vector<PeptideIdentification> peptides;
+    String filename = loader->getFilename();
+    String caption = pending.caption;
+    if (caption == "")
+    {
+      caption = File::basename(filename);
+    }
+    else
+    {
+      filename = "";
+    }
 
-    LayerData::DataType data_type;
+    // the options dialog may run an event loop, in which loading can finish (see loadFinished_())
+    FeatureMapSharedPtrType f_dummy(new FeatureMapType());
+    ConsensusMapSharedPtrType c_dummy(new ConsensusMapType());
+    vector<PeptideIdentification> p_dummy;
+    pending.adding_preview = true;
+    addData(f_dummy, c_dummy, p_dummy, preview, LayerData::DT_PEAK, false, pending.show_options, true, filename, caption, pending.window_id, pending.spectrum_id);
+    pending.adding_preview = false;
 
-    try
+    // the full data replaces the preview with the options chosen for it
+    if (replacePreview_(preview, ExperimentSharedPtrType()))
     {
-      if (file_type == FileTypes::FEATUREXML)
-      {
-        FeatureXMLFile().load(abs_filename, *feature_map);
-        data_type = LayerData::DT_FEATURE;
-      }
-      else if (file_type == FileTypes::CONSENSUSXML)
-      {
-        ConsensusXMLFile().load(abs_filename, *consensus_map);
-        data_type = LayerData::DT_CONSENSUS;
-      }
-      else if (file_type == FileTypes::IDXML)
-      {
-        vector<ProteinIdentification> proteins; // not needed later
-        IdXMLFile().load(abs_filename, proteins, peptides);
-        if (peptides.empty())
-        {
-          throw Exception::MissingInformation(__FILE__, __LINE__, __PRETTY_FUNCTION__, "No peptide identifications found");
-        }
-        // check if RT (and sequence) information is present:
-        vector<PeptideIdentification> peptides_with_rt;
-        for (vector<PeptideIdentification>::const_iterator it =
-               peptides.begin(); it != peptides.end(); ++it)
-        {
-          if (!it->getHits().empty() && it->hasRT())
-          {
-            peptides_with_rt.push_back(*it);
-          }
-        }
-        Size diff = peptides.size() - peptides_with_rt.size();
-        if (diff)
-        {
-          String msg = String(diff) + " peptide identification(s) without"
-                                      " sequence and/or retention time information were removed.\n" +
-                       peptides_with_rt.size() + " peptide identification(s) remaining.";
-          showLogMessage_(LS_WARNING, "While loading file:", msg);
-        }
-        if (peptides_with_rt.empty())
-        {
-          throw Exception::MissingInformation(__FILE__, __LINE__, __PRETTY_FUNCTION__, "No peptide identifications with sufficient information remaining.");
-        }
-        peptides.swap(peptides_with_rt);
-        data_type = LayerData::DT_IDENT;
-      }
-      else
-      {
-        // a mzML file may contain both, chromatogram and peak data
-        // -> this is handled in SpectrumCanvas::addLayer
-        fh.loadExperiment(abs_filename, *peak_map, file_type, ProgressLogger::GUI);
-        data_type = LayerData::DT_CHROMATOGRAM;
-        if (TOPPViewBase::containsMS1Scans(*peak_map))
-        {
-          data_type = LayerData::DT_PEAK;
-        }
-      }
+      pending.preview = preview;
+      showStatusMessage(String("Showing a preview of '") + caption + "' while it is loaded.", 5000);
     }
-    catch (Exception::BaseException& e)
+    else
+    {
+      // options dialog was canceled
+      loader->cancel();
+    }
+
+    if (pending.finished)
+    {
+      PendingLoad_ finished_load = pending;
+      pending_loads_.erase(it);
+      finishLoading_(loader, finished_load);
+      loader->deleteLater();
+      updateMenu();
+    }
+  }
+
+  void TOPPViewBase::loadFinished_(LayerDataLoader* loader)
+  {
+    std::map<LayerDataLoader*, PendingLoad_>::iterator it = pending_loads_.find(loader);
+    if (it == pending_loads_.end())
+    {
+      return;
+    }
+    if (it->second.ordered)
+    {
+      processLoadQueue_();
+      return;
+    }
+    if (it->second.adding_preview)
+    {
+      // finished by loadPreviewReady_()
+      it->second.finished = true;
+      return;
+    }
+
+    PendingLoad_ pending = it->second;
+    pending_loads_.erase(it);
+    finishLoading_(loader, pending);
+    loader->deleteLater();
+    updateMenu();
+  }
+
+  void TOPPViewBase::processLoadQueue_()
+  {
+    if (processing_load_queue_)
     {
-      showLogMessage_(LS_ERROR, "Error while loading file:", e.what());
-      setCursor(Qt::ArrowCursor);
       return;
     }
+    processing_load_queue_ = true;
+    while (!load_queue_.empty() && load_queue_.front()->isFinished())
+    {
+      LayerDataLoader* loader = load_queue_.front();
+      load_queue_.pop_front();
+      PendingLoad_ pending = pending_loads_[loader];
+      pending_loads_.erase(loader);
+      finishLoading_(loader, pending);
+      loader->deleteLater();
+    }
+    processing_load_queue_ = false;
+    updateMenu();
+  }
 
-    // sort for mz and update ranges of newly loaded data
-    peak_map_sptr->sortSpectra(true);
-    peak_map_sptr->updateRanges(1);
+  void TOPPViewBase::finishLoading_(LayerDataLoader* loader, const PendingLoad_& pending)
+  {
+    if (loader->isCanceled())
+    {
+      showLogMessage_(LS_NOTICE, "Loading canceled", String("Loading of file '") + loader->getFilename() + "' was canceled.");
+      return;
+    }
+    if (loader->getErrorMessage() != "")
+    {
+      showLogMessage_(LS_ERROR, "Error while loading file:", loader->getErrorMessage());
+      return;
+    }
+    if (loader->getWarningMessage() != "")
+    {
+      showLogMessage_(LS_WARNING, "While loading file:", loader->getWarningMessage());
+    }
 
     // try to add the data
+    String abs_filename = loader->getFilename();
+    String caption = pending.caption;
     if (caption == "")
     {
       caption = File::basename(abs_filename);
@@ -1183,19 +1277,95 @@ namespace OpenMS
       abs_filename = "";
     }
 
-    addData(feature_map_sptr, consensus_map_sptr, peptides, peak_map_sptr, data_type, false, show_options, true, abs_filename, caption, window_id, spectrum_id);
+    if (pending.preview)
+    {
+      // the user closed the preview -> discard the data
+      if (!replacePreview_(pending.preview, loader->getPeakMap()))
+      {
+        return;
+      }
+    }
+    else
+    {
+      UInt window_id = pending.window_id;
+      if (pending.add_to_active_window && getActiveSpectrumWidget() != 0)
+      {
+        window_id = getActiveSpectrumWidget()->getWindowId();
+      }
+      addData(loader->getFeatureMap(), loader->getConsensusMap(), loader->getPeptides(), loader->getPeakMap(), loader->getDataType(), false, pending.show_options, true, abs_filename, caption, window_id, pending.spectrum_id);
+      for (StringList::const_iterator it = pending.commands.begin(); it != pending.commands.end(); ++it)
+      {
+        applyLayerCommand_(*it);
+      }
+    }
 
     // add to recent file
-    if (add_to_recent)
+    if (pending.add_to_recent)
     {
-      addRecentFile_(filename);
+      addRecentFile_(pending.filename);
     }
 
     // watch file contents for changes
     watcher_->addFile(abs_filename);
+  }
 
-    // reset cursor
-    setCursor(Qt::ArrowCursor);
+  bool TOPPViewBase::replacePreview_(ExperimentSharedPtrType preview, ExperimentSharedPtrType peak_map)
+  {
+    // determine all layers that show the preview (it may have been copied to other windows)
+    std::vector<std::pair<SpectrumWidget*, Size> > preview_layers;
+    QWidgetList windows = ws_->windowList();
+    for (int i = 0; i != windows.count(); ++i)
+    {
+      SpectrumWidget* sw = qobject_cast<SpectrumWidget*>(windows[i]);
+      if (sw == 0)
+      {
+        continue;
+      }
+      for (Size j = 0; j != sw->canvas()->getLayerCount(); ++j)
+      {
+        if (sw->canvas()->getLayer(j).getPeakData() == preview)
+        {
+          preview_layers.push_back(std::make_pair(sw, j));
+        }
+      }
+    }
+
+    if (preview_layers.empty() || !peak_map)
+    {
+      return !preview_layers.empty();
+    }
+
+    // stop reading the preview data before it is replaced
+    cancelPyramids_(preview);
+    preview->swap(*peak_map);
+    for (Size i = 0; i != preview_layers.size(); ++i)
+    {
+      preview_layers[i].first->canvas()->updateLayer(preview_layers[i].second);
+    }
+    updateLayerBar();
+    updateFilterBar();
+    return true;
+  }
+
+  void TOPPViewBase::cancelPyramids_(ExperimentSharedPtrType peak_map)
+  {
+    QWidgetList windows = ws_->windowList();
+    for (int i = 0; i != windows.count(); ++i)
+    {
+      SpectrumWidget* sw = qobject_cast<SpectrumWidget*>(windows[i]);
+      if (sw == 0)
+      {
+        continue;
+      }
+      for (Size j = 0; j != sw->canvas()->getLayerCount(); ++j)
+      {
+        const LayerData& layer = sw->canvas()->getLayer(j);
+        if (layer.getPeakData() == peak_map && layer.pyramid)
+        {
+          layer.pyramid->cancel();
+        }
+      }
+    }
   }
 
   void TOPPViewBase::addData(FeatureMapSharedPtrType feature_map, ConsensusMapSharedPtrType consensus_map, vector<PeptideIdentification>& peptides, ExperimentSharedPtrType peak_map, LayerData::DataType data_type, bool show_as_1d, bool show_options, bool as_new_window, const String& filename, const String& caption, UInt window_id, Size spectrum_id)
@@ -2699,7 +2869,7 @@ namespace OpenMS
     if (action)
     {
       QString filename = action->text();
-      addDataFile(filename, true, true);
+      addDataFile(filename, true, true, "", 0, 0, true);
     }
   }
 
@@ -2734,7 +2904,7 @@ namespace OpenMS
     for (QStringList::iterator it = files.begin(); it != files.end(); ++it)
     {
       QString filename = *it;
-      addDataFile(filename, true, true);
+      addDataFile(filename, true, true, "", 0, 0, true);
     }
   }
 
@@ -2745,7 +2915,7 @@ namespace OpenMS
     for (QStringList::iterator it = files.begin(); it != files.end(); ++it)
     {
       QString filename = *it;
-      addDataFile(filename, true, true);
+      addDataFile(filename, true, true, "", 0, 0, true);
     }
   }
 
@@ -3020,7 +3190,7 @@ namespace OpenMS
 
   void TOPPViewBase::loadFile(QString filename)
   {
-    addDataFile(String(filename), true, false);
+    addDataFile(String(filename), true, false, "", 0, 0, true);
   }
 
   bool TOPPViewBase::annotateMS1FromMassFingerprinting_(const FeatureMap& identifications)
@@ -3577,6 +3747,10 @@ namespace OpenMS
           actions[i]->setEnabled(true);
         }
       }
+      else if (text == "Abort loading")
+      {
+        actions[i]->setEnabled(!pending_loads_.empty());
+      }
       else if (text == "Abort running TOPP tool")
       {
         actions[i]->setEnabled(false);
@@ -3622,7 +3796,9 @@ namespace OpenMS
 
   void TOPPViewBase::loadFiles(const StringList& list, QSplashScreen* splash_screen)
   {
+    // all files are parsed concurrently, processLoadQueue_() adds them in the order of the list
     bool last_was_plus = false;
+    LayerDataLoader* last_loader = 0;
     for (StringList::const_iterator it = list.begin(); it != list.end(); ++it)
     {
       if (*it == "+")
@@ -3630,78 +3806,86 @@ namespace OpenMS
         last_was_plus = true;
         continue;
       }
-      else if (*it == "@bw")
+      else if (*it == "@bw" || *it == "@bg" || *it == "@b" || *it == "@r" || *it == "@g" || *it == "@m")
       {
-        if ((getActive2DWidget() != 0 || getActive3DWidget() != 0) && getActiveCanvas() != 0)
+        // applies to the layer of the last file (directly, if that was already added)
+        std::map<LayerDataLoader*, PendingLoad_>::iterator pending = pending_loads_.find(last_loader);
+        if (pending != pending_loads_.end())
         {
-          Param tmp = getActiveCanvas()->getCurrentLayer().param;
-          tmp.setValue("dot:gradient", "Linear|0,#ffffff;100,#000000");
-          getActiveCanvas()->setCurrentLayerParameters(tmp);
+          pending->second.commands.push_back(*it);
         }
-      }
-      else if (*it == "@bg")
-      {
-        if ((getActive2DWidget() != 0 || getActive3DWidget() != 0) && getActiveCanvas() != 0)
-        {
-          Param tmp = getActiveCanvas()->getCurrentLayer().param;
-          tmp.setValue("dot:gradient", "Linear|0,#dddddd;100,#000000");
-          getActiveCanvas()->setCurrentLayerParameters(tmp);
-        }
-      }
-      else if (*it == "@b")
-      {
-        if ((getActive2DWidget() != 0 || getActive3DWidget() != 0) && getActiveCanvas() != 0)
-        {
-          Param tmp = getActiveCanvas()->getCurrentLayer().param;
-          tmp.setValue("dot:gradient", "Linear|0,#000000;100,#000000");
-          getActiveCanvas()->setCurrentLayerParameters(tmp);
-        }
-      }
-      else if (*it == "@r")
-      {
-        if ((getActive2DWidget() != 0 || getActive3DWidget() != 0) && getActiveCanvas() != 0)
-        {
-          Param tmp = getActiveCanvas()->getCurrentLayer().param;
-          tmp.setValue("dot:gradient", "Linear|0,#ff0000;100,#ff0000");
-          getActiveCanvas()->setCurrentLayerParameters(tmp);
-        }
-      }
-      else if (*it == "@g")
-      {
-        if ((getActive2DWidget() != 0 || getActive3DWidget() != 0) && getActiveCanvas() != 0)
+        else
         {
-          Param tmp = getActiveCanvas()->getCurrentLayer().param;
-          tmp.setValue("dot:gradient", "Linear|0,#00ff00;100,#00ff00");
-          getActiveCanvas()->setCurrentLayerParameters(tmp);
+          applyLayerCommand_(*it);
         }
       }
-      else if (*it == "@m")
-      {
-        if ((getActive2DWidget() != 0 || getActive3DWidget() != 0) && getActiveCanvas() != 0)
-        {
-          Param tmp = getActiveCanvas()->getCurrentLayer().param;
-          tmp.setValue("dot:gradient", "Linear|0,#ff00ff;100,#ff00ff");
-          getActiveCanvas()->setCurrentLayerParameters(tmp);
-        }
-      }
-      else if (!last_was_plus || !getActiveSpectrumWidget())
-      {
-        splash_screen->showMessage((String("Loading file: ") + *it).toQString());
-        splash_screen->repaint();
-        QApplication::processEvents();
-        addDataFile(*it, false, true); // add data file but don't show options
-      }
       else
       {
         splash_screen->showMessage((String("Loading file: ") + *it).toQString());
         splash_screen->repaint();
         QApplication::processEvents();
+        LayerDataLoader* loader = createLoader_(*it, 0);
+        if (loader == 0)
+        {
+          last_was_plus = false;
+          last_loader = 0;
+          continue;
+        }
+        PendingLoad_ pending;
+        pending.filename = *it;
+        pending.add_to_recent = true;
+        pending.add_to_active_window = last_was_plus;
+        pending.ordered = true;
+        load_queue_.push_back(loader);
+        startLoader_(loader, pending);
+        last_loader = loader;
         last_was_plus = false;
-        addDataFile(*it, false, true, "", getActiveSpectrumWidget()->getWindowId());
       }
     }
   }
 
+  void TOPPViewBase::applyLayerCommand_(const String& command)
+  {
+    if ((getActive2DWidget() == 0 && getActive3DWidget() == 0) || getActiveCanvas() == 0)
+    {
+      return;
+    }
+
+    String gradient;
+    if (command == "@bw")
+    {
+      gradient = "Linear|0,#ffffff;100,#000000";
+    }
+    else if (command == "@bg")
+    {
+      gradient = "Linear|0,#dddddd;100,#000000";
+    }
+    else if (command == "@b")
+    {
+      gradient = "Linear|0,#000000;100,#000000";
+    }
+    else if (command == "@r")
+    {
+      gradient = "Linear|0,#ff0000;100,#ff0000";
+    }
+    else if (command == "@g")
+    {
+      gradient = "Linear|0,#00ff00;100,#00ff00";
+    }
+    else if (command == "@m")
+    {
+      gradient = "Linear|0,#ff00ff;100,#ff00ff";
+    }
+    else
+    {
+      return;
+    }
+
+    Param tmp = getActiveCanvas()->getCurrentLayer().param;
+    tmp.setValue("dot:gradient", gradient);
+    getActiveCanvas()->setCurrentLayerParameters(tmp);
+  }
+
   void TOPPViewBase::showLogMessage_(TOPPViewBase::LogState state, const String& heading, const String& body)
   {
     //Compose current time string
@@ -3843,7 +4027,7 @@ namespace OpenMS
           QList<QUrl> urls = data->urls();
           for (QList<QUrl>::const_iterator it = urls.begin(); it != urls.end(); ++it)
           {
-            addDataFile(it->toLocalFile(), false, true, "", new_id);
+            addDataFile(it->toLocalFile(), false, true, "", new_id, 0, true);
           }
         }
       }
@@ -3963,6 +4147,8 @@ namespace OpenMS
         // reload data
         if (layer.type == LayerData::DT_PEAK) //peak data
         {
+          // the intensity pyramids must not read the data while it is reloaded (they are recomputed by updateLayer())
+          cancelPyramids_(layer.getPeakData());
           try
           {
             FileHandler().loadExperiment(layer.filename, *layer.getPeakData());
@@ -4068,6 +4254,14 @@ namespace OpenMS
     savePreferences();
     abortTOPPTool();
 
+    // stop loading files in the background (take the loaders out first, so no slot sees a deleted loader)
+    std::map<LayerDataLoader*, PendingLoad_> pending_loads;
+    pending_loads.swap(pending_loads_);
+    for (std::map<LayerDataLoader*, PendingLoad_>::iterator it = pending_loads.begin(); it != pending_loads.end(); ++it)
+    {
+      delete it->first;
+    }
+
     // dispose behavior
     if (identificationview_behavior_ != 0)
     {
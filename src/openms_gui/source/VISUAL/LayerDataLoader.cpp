@@ -0,0 +1,431 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/VISUAL/LayerDataLoader.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/FORMAT/ConsensusXMLFile.h>
+#include <OpenMS/FORMAT/FeatureXMLFile.h>
+#include <OpenMS/FORMAT/FileHandler.h>
+#include <OpenMS/FORMAT/IdXMLFile.h>
+#include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/FORMAT/SpectrumMetaIndex.h>
+#include <OpenMS/INTERFACES/IMSDataConsumer.h>
+#include <OpenMS/KERNEL/ChromatogramTools.h>
+#include <OpenMS/KERNEL/OnDiscMSExperiment.h>
+#include <OpenMS/METADATA/ProteinIdentification.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <QtCore/QMetaObject>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QTimer>
+#include <QtCore/QtConcurrentRun>
+
+using namespace std;
+
+namespace OpenMS
+{
+  /**
+    @brief Collects progress and the preview while an mzML file is parsed
+
+    Throws an exception to abort the parser when the loading was canceled.
+  */
+  class LayerDataLoader::MzMLConsumer_ :
+    public Interfaces::IMSDataConsumer<>
+  {
+public:
+    MzMLConsumer_(LayerDataLoader & loader, bool with_preview) :
+      loader_(loader),
+      with_preview_(with_preview),
+      consumed_(0),
+      spectra_()
+    {
+    }
+
+    void consumeSpectrum(SpectrumType & s)
+    {
+      if (loader_.isCanceled())
+      {
+        throw Exception::BaseException(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Canceled", "Loading was canceled.");
+      }
+      loader_.progress_.fetchAndStoreRelaxed((int)++consumed_);
+
+      if (with_preview_)
+      {
+        spectra_.addSpectrum(s);
+        if (spectra_.size() == loader_.preview_size_)
+        {
+          loader_.setPreview_(spectra_);
+          spectra_.clear(true);
+          with_preview_ = false;
+        }
+      }
+    }
+
+    void consumeChromatogram(ChromatogramType &)
+    {
+    }
+
+    void setExpectedSize(Size expected_spectra, Size /* expected_chromatograms */)
+    {
+      loader_.expected_size_.fetchAndStoreRelaxed((int)expected_spectra);
+    }
+
+    void setExperimentalSettings(const ExperimentalSettings &)
+    {
+    }
+
+private:
+    LayerDataLoader & loader_;
+    bool with_preview_;
+    Size consumed_;
+    ExperimentType spectra_;
+  };
+
+  LayerDataLoader::LayerDataLoader(const String & filename, FileTypes::Type type, Size preview_size, QObject * parent) :
+    QObject(parent),
+    ProgressLogger(),
+    filename_(filename),
+    file_type_(type),
+    preview_size_(preview_size),
+    data_type_(LayerData::DT_UNKNOWN),
+    error_(),
+    warning_(),
+    feature_map_(new LayerData::FeatureMapType()),
+    consensus_map_(new LayerData::ConsensusMapType()),
+    peak_map_(new ExperimentType()),
+    peptides_(),
+    preview_(),
+    preview_mutex_(),
+    cancel_(0),
+    progress_(0),
+    expected_size_(0),
+    finished_(false),
+    watcher_(),
+    timer_(new QTimer(this))
+  {
+    connect(&watcher_, SIGNAL(finished()), this, SLOT(emitFinished_()));
+    connect(timer_, SIGNAL(timeout()), this, SLOT(updateProgress_()));
+  }
+
+  LayerDataLoader::~LayerDataLoader()
+  {
+    cancel();
+    watcher_.waitForFinished();
+  }
+
+  void LayerDataLoader::run()
+  {
+    load_(false);
+    finished_ = true;
+  }
+
+  void LayerDataLoader::start()
+  {
+    startProgress(0, 100, String("Loading ") + File::basename(filename_));
+    timer_->start(250);
+    watcher_.setFuture(QtConcurrent::run(this, &LayerDataLoader::load_, true));
+  }
+
+  void LayerDataLoader::cancel()
+  {
+    cancel_.fetchAndStoreOrdered(1);
+  }
+
+  bool LayerDataLoader::isCanceled() const
+  {
+    return cancel_.fetchAndAddOrdered(0) != 0;
+  }
+
+  bool LayerDataLoader::isFinished() const
+  {
+    return finished_;
+  }
+
+  const String & LayerDataLoader::getFilename() const
+  {
+    return filename_;
+  }
+
+  LayerData::DataType LayerDataLoader::getDataType() const
+  {
+    return data_type_;
+  }
+
+  const String & LayerDataLoader::getErrorMessage() const
+  {
+    return error_;
+  }
+
+  const String & LayerDataLoader::getWarningMessage() const
+  {
+    return warning_;
+  }
+
+  LayerDataLoader::FeatureMapSharedPtrType LayerDataLoader::getFeatureMap() const
+  {
+    return feature_map_;
+  }
+
+  LayerDataLoader::ConsensusMapSharedPtrType LayerDataLoader::getConsensusMap() const
+  {
+    return consensus_map_;
+  }
+
+  LayerDataLoader::ExperimentSharedPtrType LayerDataLoader::getPeakMap() const
+  {
+    return peak_map_;
+  }
+
+  std::vector<PeptideIdentification> & LayerDataLoader::getPeptides()
+  {
+    return peptides_;
+  }
+
+  LayerDataLoader::ExperimentSharedPtrType LayerDataLoader::getPreview() const
+  {
+    QMutexLocker lock(&preview_mutex_);
+    return preview_;
+  }
+
+  void LayerDataLoader::emitPreviewReady_()
+  {
+    emit previewReady(this);
+  }
+
+  void LayerDataLoader::emitFinished_()
+  {
+    timer_->stop();
+    endProgress();
+    finished_ = true;
+    emit finished(this);
+  }
+
+  void LayerDataLoader::updateProgress_()
+  {
+    int expected = expected_size_.fetchAndAddRelaxed(0);
+    if (expected > 0)
+    {
+      setProgress(std::min(100, (int)(100.0 * progress_.fetchAndAddRelaxed(0) / expected)));
+    }
+  }
+
+  void LayerDataLoader::setPreview_(const ExperimentType & spectra)
+  {
+    ExperimentSharedPtrType preview(new ExperimentType(spectra));
+    preview->sortSpectra(true);
+    preview->updateRanges(1);
+    {
+      QMutexLocker lock(&preview_mutex_);
+      preview_ = preview;
+    }
+    QMetaObject::invokeMethod(this, "emitPreviewReady_", Qt::QueuedConnection);
+  }
+
+  void LayerDataLoader::load_(bool background)
+  {
+    try
+    {
+      if (file_type_ == FileTypes::FEATUREXML)
+      {
+        FeatureXMLFile().load(filename_, *feature_map_);
+        data_type_ = LayerData::DT_FEATURE;
+      }
+      else if (file_type_ == FileTypes::CONSENSUSXML)
+      {
+        ConsensusXMLFile().load(filename_, *consensus_map_);
+        data_type_ = LayerData::DT_CONSENSUS;
+      }
+      else if (file_type_ == FileTypes::IDXML)
+      {
+        vector<ProteinIdentification> proteins; // not needed later
+        IdXMLFile().load(filename_, proteins, peptides_);
+        if (peptides_.empty())
+        {
+          throw Exception::MissingInformation(__FILE__, __LINE__, __PRETTY_FUNCTION__, "No peptide identifications found");
+        }
+        // check if RT (and sequence) information is present:
+        vector<PeptideIdentification> peptides_with_rt;
+        for (vector<PeptideIdentification>::const_iterator it = peptides_.begin(); it != peptides_.end(); ++it)
+        {
+          if (!it->getHits().empty() && it->hasRT())
+          {
+            peptides_with_rt.push_back(*it);
+          }
+        }
+        Size diff = peptides_.size() - peptides_with_rt.size();
+        if (diff)
+        {
+          warning_ = String(diff) + " peptide identification(s) without"
+                                    " sequence and/or retention time information were removed.\n" +
+                     peptides_with_rt.size() + " peptide identification(s) remaining.";
+        }
+        if (peptides_with_rt.empty())
+        {
+          throw Exception::MissingInformation(__FILE__, __LINE__, __PRETTY_FUNCTION__, "No peptide identifications with sufficient information remaining.");
+        }
+        peptides_.swap(peptides_with_rt);
+        data_type_ = LayerData::DT_IDENT;
+      }
+      else
+      {
+        // a mzML file may contain both, chromatogram and peak data
+        // -> this is handled in SpectrumCanvas::addLayer
+        if (background && file_type_ == FileTypes::MZML)
+        {
+          loadMzML_();
+        }
+        else
+        {
+          FileHandler().loadExperiment(filename_, *peak_map_, file_type_, background ? ProgressLogger::NONE : getLogType());
+        }
+        data_type_ = LayerData::DT_CHROMATOGRAM;
+        for (Size i = 0; i < peak_map_->size(); ++i)
+        {
+          if ((*peak_map_)[i].getMSLevel() == 1)
+          {
+            data_type_ = LayerData::DT_PEAK;
+            break;
+          }
+        }
+      }
+    }
+    catch (Exception::BaseException & e)
+    {
+      if (!isCanceled())
+      {
+        error_ = e.what();
+      }
+      return;
+    }
+
+    // sort for mz and update ranges of newly loaded data
+    peak_map_->sortSpectra(true);
+    peak_map_->updateRanges(1);
+  }
+
+  void LayerDataLoader::loadMzML_()
+  {
+    // fall back to the first spectra as preview if the file has no (valid) index
+    bool with_preview = false;
+    if (preview_size_ > 0)
+    {
+      try
+      {
+        with_preview = !loadOverview_();
+      }
+      catch (Exception::BaseException &)
+      {
+        with_preview = true;
+      }
+    }
+    if (isCanceled())
+    {
+      return;
+    }
+
+    MzMLConsumer_ consumer(*this, with_preview);
+    MzMLFile().transform(filename_, &consumer, *peak_map_, true);
+
+    // same post-processing as FileHandler::loadExperiment (without the checksum of the file)
+    ChromatogramTools().convertSpectraToChromatograms(*peak_map_, true);
+    SourceFile src_file;
+    src_file.setNameOfFile(File::basename(filename_));
+    src_file.setPathToFile(String("file:///") + File::path(filename_));
+    src_file.setFileType(FileTypes::typeToMZML(FileTypes::MZML));
+    peak_map_->getSourceFiles().clear();
+    peak_map_->getSourceFiles().push_back(src_file);
+  }
+
+  bool LayerDataLoader::loadOverview_()
+  {
+    // only the index of the file (and its sidecar) is read here, the spectra are parsed afterwards anyway
+    OnDiscMSExperiment<> on_disc;
+    if (!on_disc.openFile(filename_, true) || on_disc.getNrSpectra() <= preview_size_)
+    {
+      return false;
+    }
+    // without a (valid) sidecar, the meta data of all spectra is parsed instead (without decoding any peak data)
+    const bool has_meta_index = on_disc.hasSpectrumMetaIndex();
+    if (!has_meta_index && (isCanceled() || !on_disc.openFile(filename_, false)))
+    {
+      return isCanceled();
+    }
+
+    // every k-th spectrum, i.e. evenly spaced spectra over the whole run
+    ExperimentType overview;
+    Size nr_spectra = on_disc.getNrSpectra();
+    for (Size i = 0; i < preview_size_; ++i)
+    {
+      if (isCanceled())
+      {
+        return true;
+      }
+      Size index = i * nr_spectra / preview_size_;
+      if (!has_meta_index)
+      {
+        overview.addSpectrum(on_disc.getSpectrum(index));
+        continue;
+      }
+
+      const SpectrumMetaIndex::Entry & entry = on_disc.getSpectrumMetaIndex().getEntries()[index];
+      ExperimentType::SpectrumType spectrum;
+      spectrum.setRT(entry.rt);
+      spectrum.setMSLevel(entry.ms_level);
+      if (entry.precursor_count > 0)
+      {
+        Precursor precursor;
+        precursor.setMZ(entry.precursor_mz);
+        precursor.setCharge(entry.precursor_charge);
+        spectrum.getPrecursors().push_back(precursor);
+      }
+
+      Interfaces::SpectrumPtr sptr = on_disc.getSpectrumById(index);
+      Interfaces::BinaryDataArrayPtr mz_arr = sptr->getMZArray();
+      Interfaces::BinaryDataArrayPtr int_arr = sptr->getIntensityArray();
+      spectrum.reserve(mz_arr->data.size());
+      for (Size k = 0; k < mz_arr->data.size(); ++k)
+      {
+        ExperimentType::PeakType p;
+        p.setMZ(mz_arr->data[k]);
+        p.setIntensity(int_arr->data[k]);
+        spectrum.push_back(p);
+      }
+      overview.addSpectrum(spectrum);
+    }
+    setPreview_(overview);
+    return true;
+  }
+
+} // namespace OpenMS
@@ -0,0 +1,420 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/VISUAL/PeakMapPyramid.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+
+#include <QtCore/QDateTime>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QtConcurrentRun>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+using namespace std;
+
+namespace OpenMS
+{
+  namespace
+  {
+    const char PYRAMID_MAGIC[] = "OMS_PYR1";
+
+    // size and modification time identify the version of the data file a cache belongs to
+    bool getFileStamp(const String & data_file, UInt64 & size, UInt64 & time)
+    {
+      QFileInfo fi(data_file.toQString());
+      if (!fi.exists())
+      {
+        return false;
+      }
+      size = (UInt64)fi.size();
+      time = (UInt64)fi.lastModified().toTime_t();
+      return true;
+    }
+
+    // index of the first bin whose center is not below @p pos
+    Size binIndex(double pos, double min, double bin_size, Size bins)
+    {
+      double index = ceil((pos - min) / bin_size - 0.5);
+      if (index <= 0.0)
+      {
+        return 0;
+      }
+      return std::min((Size)index, bins);
+    }
+  }
+
+  PeakMapPyramid::PeakMapPyramid(Size max_rt_bins, Size max_mz_bins) :
+    max_rt_bins_(std::max(max_rt_bins, (Size)1)),
+    max_mz_bins_(std::max(max_mz_bins, (Size)1)),
+    rt_min_(0.0),
+    mz_min_(0.0),
+    levels_(),
+    ready_(0),
+    cancel_(0),
+    future_()
+  {
+  }
+
+  PeakMapPyramid::~PeakMapPyramid()
+  {
+    cancel();
+  }
+
+  void PeakMapPyramid::build(const ExperimentType & map)
+  {
+    cancel();
+    ready_.fetchAndStoreOrdered(0);
+    cancel_.fetchAndStoreOrdered(0);
+    build_(map);
+    ready_.fetchAndStoreRelease(1);
+  }
+
+  void PeakMapPyramid::buildAsync(ExperimentSharedPtrType map, const String & data_file, const String & cache_file)
+  {
+    cancel();
+    ready_.fetchAndStoreOrdered(0);
+    cancel_.fetchAndStoreOrdered(0);
+    future_ = QtConcurrent::run(this, &PeakMapPyramid::buildAsync_, map, data_file, cache_file);
+  }
+
+  void PeakMapPyramid::buildAsync_(ExperimentSharedPtrType map, String data_file, String cache_file)
+  {
+    if (!cache_file.empty() && load(cache_file, data_file))
+    {
+      return;
+    }
+    if (!build_(*map))
+    {
+      return;
+    }
+    ready_.fetchAndStoreRelease(1);
+    if (!cache_file.empty())
+    {
+      store(cache_file, data_file);
+    }
+  }
+
+  void PeakMapPyramid::cancel()
+  {
+    cancel_.fetchAndStoreOrdered(1);
+    future_.waitForFinished();
+  }
+
+  bool PeakMapPyramid::isReady() const
+  {
+    return ready_.fetchAndAddAcquire(0) != 0;
+  }
+
+  Size PeakMapPyramid::getNumberOfLevels() const
+  {
+    return levels_.size();
+  }
+
+  const PeakMapPyramid::Level & PeakMapPyramid::getLevel(Size index) const
+  {
+    if (index >= levels_.size())
+    {
+      throw Exception::IndexOverflow(__FILE__, __LINE__, __PRETTY_FUNCTION__, index, levels_.size());
+    }
+    return levels_[index];
+  }
+
+  double PeakMapPyramid::getMinRT() const
+  {
+    return rt_min_;
+  }
+
+  double PeakMapPyramid::getMinMZ() const
+  {
+    return mz_min_;
+  }
+
+  bool PeakMapPyramid::build_(const ExperimentType & map)
+  {
+    levels_.clear();
+
+    // determine the data range of the MS1 spectra
+    Size ms1_count = 0;
+    double rt_min = 0.0, rt_max = 0.0, mz_min = 0.0, mz_max = 0.0;
+    for (Size i = 0; i < map.size(); ++i)
+    {
+      const ExperimentType::SpectrumType & spec = map[i];
+      if (spec.getMSLevel() != 1 || spec.empty())
+      {
+        continue;
+      }
+      if (ms1_count == 0)
+      {
+        rt_min = spec.getRT();
+        mz_min = spec.front().getMZ();
+        mz_max = spec.back().getMZ();
+      }
+      rt_max = spec.getRT();
+      mz_min = std::min(mz_min, spec.front().getMZ());
+      mz_max = std::max(mz_max, spec.back().getMZ());
+      ++ms1_count;
+    }
+    rt_min_ = rt_min;
+    mz_min_ = mz_min;
+    if (ms1_count == 0)
+    {
+      return true;
+    }
+
+    // base level
+    Level base;
+    base.rt_bins = std::min(ms1_count, max_rt_bins_);
+    base.mz_bins = max_mz_bins_;
+    base.rt_bin_size = rt_max > rt_min ? (rt_max - rt_min) / base.rt_bins : 1.0;
+    base.mz_bin_size = mz_max > mz_min ? (mz_max - mz_min) / base.mz_bins : 1.0;
+    base.data.assign(base.rt_bins * base.mz_bins, -1.0f);
+
+    for (Size i = 0; i < map.size(); ++i)
+    {
+      if (cancel_.fetchAndAddRelaxed(0) != 0)
+      {
+        levels_.clear();
+        return false;
+      }
+
+      const ExperimentType::SpectrumType & spec = map[i];
+      if (spec.getMSLevel() != 1 || spec.empty())
+      {
+        continue;
+      }
+      Size rt_bin = std::min((Size)((spec.getRT() - rt_min) / base.rt_bin_size), base.rt_bins - 1);
+      float * row = &base.data[rt_bin * base.mz_bins];
+      for (Size p = 0; p < spec.size(); ++p)
+      {
+        Size mz_bin = std::min((Size)((spec[p].getMZ() - mz_min) / base.mz_bin_size), base.mz_bins - 1);
+        if (spec[p].getIntensity() > row[mz_bin])
+        {
+          row[mz_bin] = spec[p].getIntensity();
+        }
+      }
+    }
+    levels_.push_back(base);
+
+    downsample_();
+    return true;
+  }
+
+  void PeakMapPyramid::downsample_()
+  {
+    while (levels_.back().rt_bins > 1 || levels_.back().mz_bins > 1)
+    {
+      // copy, as push_back may invalidate a reference to the previous level
+      const Level fine = levels_.back();
+      Level coarse;
+      coarse.rt_bins = (fine.rt_bins + 1) / 2;
+      coarse.mz_bins = (fine.mz_bins + 1) / 2;
+      coarse.rt_bin_size = fine.rt_bins > 1 ? fine.rt_bin_size * 2.0 : fine.rt_bin_size;
+      coarse.mz_bin_size = fine.mz_bins > 1 ? fine.mz_bin_size * 2.0 : fine.mz_bin_size;
+      coarse.data.assign(coarse.rt_bins * coarse.mz_bins, -1.0f);
+
+      for (Size rt = 0; rt < fine.rt_bins; ++rt)
+      {
+        const float * fine_row = &fine.data[rt * fine.mz_bins];
+        float * coarse_row = &coarse.data[(rt / 2) * coarse.mz_bins];
+        for (Size mz = 0; mz < fine.mz_bins; ++mz)
+        {
+          coarse_row[mz / 2] = std::max(coarse_row[mz / 2], fine_row[mz]);
+        }
+      }
+      levels_.push_back(coarse);
+    }
+  }
+
+  SignedSize PeakMapPyramid::findLevel(double rt_step, double mz_step) const
+  {
+    if (!isReady())
+    {
+      return -1;
+    }
+    for (SignedSize i = (SignedSize)levels_.size() - 1; i >= 0; --i)
+    {
+      if (levels_[i].rt_bin_size <= rt_step && levels_[i].mz_bin_size <= mz_step)
+      {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  float PeakMapPyramid::getMaximum(Size level, double rt_start, double rt_end, double mz_start, double mz_end) const
+  {
+    const Level & l = getLevel(level);
+    Size rt_begin = binIndex(rt_start, rt_min_, l.rt_bin_size, l.rt_bins);
+    Size rt_stop = binIndex(rt_end, rt_min_, l.rt_bin_size, l.rt_bins);
+    Size mz_begin = binIndex(mz_start, mz_min_, l.mz_bin_size, l.mz_bins);
+    Size mz_stop = binIndex(mz_end, mz_min_, l.mz_bin_size, l.mz_bins);
+
+    float max = -1.0f;
+    for (Size rt = rt_begin; rt < rt_stop; ++rt)
+    {
+      const float * row = &l.data[rt * l.mz_bins];
+      for (Size mz = mz_begin; mz < mz_stop; ++mz)
+      {
+        max = std::max(max, row[mz]);
+      }
+    }
+    return max;
+  }
+
+  String PeakMapPyramid::getCacheFilename(const String & data_file)
+  {
+    return data_file + ".pyramid";
+  }
+
+  bool PeakMapPyramid::store(const String & filename, const String & data_file) const
+  {
+    UInt64 data_size, data_time;
+    if (!isReady() || !getFileStamp(data_file, data_size, data_time))
+    {
+      return false;
+    }
+
+    // write to a temporary file first, so readers never see a partial cache
+    String tmp_filename = filename + ".tmp";
+    {
+      std::ofstream ofs(tmp_filename.c_str(), std::ios::binary);
+      if (!ofs)
+      {
+        return false;
+      }
+      UInt64 nr_levels = levels_.size();
+      ofs.write(PYRAMID_MAGIC, 8);
+      ofs.write((const char *)&data_size, sizeof(data_size));
+      ofs.write((const char *)&data_time, sizeof(data_time));
+      ofs.write((const char *)&rt_min_, sizeof(rt_min_));
+      ofs.write((const char *)&mz_min_, sizeof(mz_min_));
+      ofs.write((const char *)&nr_levels, sizeof(nr_levels));
+      for (Size i = 0; i < levels_.size(); ++i)
+      {
+        const Level & l = levels_[i];
+        UInt64 rt_bins = l.rt_bins, mz_bins = l.mz_bins;
+        ofs.write((const char *)&rt_bins, sizeof(rt_bins));
+        ofs.write((const char *)&mz_bins, sizeof(mz_bins));
+        ofs.write((const char *)&l.rt_bin_size, sizeof(l.rt_bin_size));
+        ofs.write((const char *)&l.mz_bin_size, sizeof(l.mz_bin_size));
+        ofs.write((const char *)&l.data[0], l.data.size() * sizeof(float));
+        // keep the following blocks 8-byte aligned
+        if (l.data.size() % 2 != 0)
+        {
+          float padding = 0.0f;
+          ofs.write((const char *)&padding, sizeof(padding));
+        }
+      }
+      if (!ofs)
+      {
+        ofs.close();
+        QFile::remove(tmp_filename.toQString());
+        return false;
+      }
+    }
+
+    QFile::remove(filename.toQString());
+    return QFile::rename(tmp_filename.toQString(), filename.toQString());
+  }
+
+  bool PeakMapPyramid::load(const String & filename, const String & data_file)
+  {
+    UInt64 data_size, data_time;
+    if (!getFileStamp(data_file, data_size, data_time))
+    {
+      return false;
+    }
+    std::ifstream ifs(filename.c_str(), std::ios::binary);
+    if (!ifs)
+    {
+      return false;
+    }
+
+    char magic[8];
+    UInt64 cached_size, cached_time, nr_levels;
+    double rt_min, mz_min;
+    ifs.read(magic, 8);
+    ifs.read((char *)&cached_size, sizeof(cached_size));
+    ifs.read((char *)&cached_time, sizeof(cached_time));
+    ifs.read((char *)&rt_min, sizeof(rt_min));
+    ifs.read((char *)&mz_min, sizeof(mz_min));
+    ifs.read((char *)&nr_levels, sizeof(nr_levels));
+    if (!ifs || !std::equal(magic, magic + 8, PYRAMID_MAGIC) ||
+        cached_size != data_size || cached_time != data_time ||
+        nr_levels == 0 || nr_levels > 128)
+    {
+      return false;
+    }
+
+    std::vector<Level> levels(nr_levels);
+    for (Size i = 0; i < levels.size(); ++i)
+    {
+      Level & l = levels[i];
+      UInt64 rt_bins, mz_bins;
+      ifs.read((char *)&rt_bins, sizeof(rt_bins));
+      ifs.read((char *)&mz_bins, sizeof(mz_bins));
+      ifs.read((char *)&l.rt_bin_size, sizeof(l.rt_bin_size));
+      ifs.read((char *)&l.mz_bin_size, sizeof(l.mz_bin_size));
+      if (!ifs || rt_bins == 0 || mz_bins == 0 || rt_bins > max_rt_bins_ || mz_bins > max_mz_bins_ ||
+          !(l.rt_bin_size > 0.0) || !(l.mz_bin_size > 0.0))
+      {
+        return false;
+      }
+      l.rt_bins = rt_bins;
+      l.mz_bins = mz_bins;
+      l.data.resize(l.rt_bins * l.mz_bins);
+      ifs.read((char *)&l.data[0], l.data.size() * sizeof(float));
+      if (l.data.size() % 2 != 0)
+      {
+        float padding;
+        ifs.read((char *)&padding, sizeof(padding));
+      }
+      if (!ifs || cancel_.fetchAndAddRelaxed(0) != 0)
+      {
+        return false;
+      }
+    }
+
+    rt_min_ = rt_min;
+    mz_min_ = mz_min;
+    levels_.swap(levels);
+    ready_.fetchAndStoreRelease(1);
+    return true;
+  }
+
+} // namespace OpenMS
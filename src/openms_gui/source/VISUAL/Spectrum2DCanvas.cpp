@@ -102,6 +102,8 @@ namespace OpenMS
     defaults_.setMaxInt("dot:feature_icon_size", 999);
     defaults_.setValue("mapping_of_mz_to", "y_axis", "Determines which axis is the m/z axis.");
     defaults_.setValidStrings("mapping_of_mz_to", ListUtils::create<String>("x_axis,y_axis"));
+    defaults_.setValue("pyramid_cache", "false", "Store the intensity pyramid used for painting zoomed-out peak maps next to the data file and reuse it when the file is opened again.");
+    defaults_.setValidStrings("pyramid_cache", ListUtils::create<String>("true,false"));
     defaultsToParam_();
     setName("Spectrum2DCanvas");
     setParameters(preferences);
@@ -652,6 +654,35 @@ namespace OpenMS
     double rt_step_size = (rt_max - rt_min) / rt_pixel_count;
     double mz_step_size = (mz_max - mz_min) / mz_pixel_count;
 
+    // use the precomputed intensity pyramid if a level with bins smaller than a pixel
+    // exists (the pyramid is built from unfiltered data, so it cannot be used with filters)
+    if (layer.pyramid && !layer.filters.isActive())
+    {
+      SignedSize level = layer.pyramid->findLevel(rt_step_size, mz_step_size);
+      if (level != -1)
+      {
+        for (Size rt = 0; rt < rt_pixel_count; ++rt)
+        {
+          double rt_start = rt_min + rt_step_size * rt;
+          for (Size mz = 0; mz < mz_pixel_count; ++mz)
+          {
+            double mz_start = mz_min + mz_step_size * mz;
+            float max = layer.pyramid->getMaximum(level, rt_start, rt_start + rt_step_size, mz_start, mz_start + mz_step_size);
+            if (max >= 0.0)
+            {
+              QPoint pos;
+              dataToWidget_(mz_start + 0.5 * mz_step_size, rt_start + 0.5 * rt_step_size, pos);
+              if (pos.y() < image_height && pos.x() < image_width)
+              {
+                buffer_.setPixel(pos.x(), pos.y(), heightColor_(max, layer.gradient, snap_factor).rgb());
+              }
+            }
+          }
+        }
+        return;
+      }
+    }
+
     // start at first visible RT scan
     Size scan_index = std::distance(map.begin(), map.RTBegin(rt_min));
     //iterate over all pixels (RT dimension)
@@ -1233,6 +1264,7 @@ namespace OpenMS
       {
         setLayerFlag(LayerData::P_PRECURSORS, true); // show precursors if no MS1 data is contained
       }
+      computePyramid_(current_layer_, true);
     }
     else if (layers_.back().type == LayerData::DT_FEATURE)  //feature data
     {
@@ -1321,6 +1353,19 @@ namespace OpenMS
     return true;
   }
 
+  void Spectrum2DCanvas::computePyramid_(Size layer_index, bool use_cache)
+  {
+    LayerData & layer = getLayer_(layer_index);
+    String cache_file;
+    if (use_cache && String(param_.getValue("pyramid_cache")) == "true" && !layer.filename.empty())
+    {
+      cache_file = PeakMapPyramid::getCacheFilename(layer.filename);
+    }
+    // replacing the pyramid cancels a computation that is still running
+    layer.pyramid = LayerData::PyramidSharedPtrType(new PeakMapPyramid());
+    layer.pyramid->buildAsync(layer.getPeakData(), layer.filename, cache_file);
+  }
+
   void Spectrum2DCanvas::removeLayer(Size layer_index)
   {
     if (layer_index >= getLayerCount())
@@ -2808,6 +2853,11 @@ namespace OpenMS
   {
     //update nearest peak
     selected_peak_.clear();
+    if (getLayer(i).type == LayerData::DT_PEAK)
+    {
+      // data was modified in memory, so a cached pyramid is outdated
+      computePyramid_(i, false);
+    }
     recalculateRanges_(0, 1, 2);
     resetZoom(false);     //no repaint as this is done in intensityModeChange_() anyway
     intensityModeChange_();
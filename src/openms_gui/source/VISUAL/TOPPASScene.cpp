@@ -50,6 +50,8 @@
 #include <OpenMS/SYSTEM/File.h>
 #include <OpenMS/FORMAT/ParamXMLFile.h>
 
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDateTime>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
 #include <QtCore/QDir>
@@ -86,7 +88,10 @@ namespace OpenMS
     dry_run_(true),
     threads_active_(0),
     allowed_threads_(1),
-    resume_source_(0)
+    resume_source_(0),
+    critical_path_(),
+    cache_dir_(),
+    file_hashes_()
   {
     /*	ATTENTION!
 
@@ -591,6 +596,7 @@ namespace OpenMS
 
     error_occured_ = false;
     resume_source_ = 0; // we are not resuming, so reset the resume node
+    critical_path_.clear(); // the pipeline might have changed since the last run
 
     // reset all nodes
     for (VertexIterator it = verticesBegin(); it != verticesEnd(); ++it)
@@ -1625,9 +1631,9 @@ namespace OpenMS
     }
   }
 
-  void TOPPASScene::processFinished()
+  void TOPPASScene::processFinished(int threads)
   {
-    --threads_active_;
+    threads_active_ -= threads;
     // try to run next in line
     runNextProcess();
   }
@@ -1961,9 +1967,31 @@ namespace OpenMS
 
     while (!topp_processes_queue_.empty() && threads_active_ < allowed_threads_)
     {
-      ++threads_active_; // will be decreased, once the tool finishes
-      TOPPProcess tp = topp_processes_queue_.first();
-      topp_processes_queue_.pop_front();
+      // start the process on the longest path through the remaining pipeline which fits into the free threads
+      // (the queue is searched again after each start, as finished fake processes enqueue their successors right away)
+      int next = -1;
+      int next_path = -1;
+      for (int i = 0; i < topp_processes_queue_.size(); ++i)
+      {
+        const TOPPProcess& candidate = topp_processes_queue_[i];
+        if (threads_active_ + candidate.threads > allowed_threads_ && threads_active_ > 0)
+        {
+          continue;
+        }
+        int path = getCriticalPathLength_(candidate.tv);
+        if (path > next_path)
+        {
+          next = i;
+          next_path = path;
+        }
+      }
+      if (next == -1)
+      {
+        break;
+      }
+
+      TOPPProcess tp = topp_processes_queue_.takeAt(next);
+      threads_active_ += tp.threads; // will be decreased, once the tool finishes
       FakeProcess* p = qobject_cast<FakeProcess*>(tp.proc);
       if (p)
       {
@@ -2311,6 +2339,131 @@ namespace OpenMS
     allowed_threads_ = num_jobs;
   }
 
+  int TOPPASScene::getAllowedThreads() const
+  {
+    return allowed_threads_;
+  }
+
+  int TOPPASScene::getCriticalPathLength_(TOPPASVertex* tv)
+  {
+    QHash<TOPPASVertex*, int>::const_iterator it = critical_path_.find(tv);
+    if (it != critical_path_.end())
+    {
+      return it.value();
+    }
+
+    // the pipeline is acyclic (see isEdgeAllowed_()), so the recursion terminates
+    int longest = 0;
+    for (TOPPASVertex::ConstEdgeIterator e_it = tv->outEdgesBegin(); e_it != tv->outEdgesEnd(); ++e_it)
+    {
+      longest = qMax(longest, getCriticalPathLength_((*e_it)->getTargetVertex()));
+    }
+    if (qobject_cast<TOPPASToolVertex*>(tv))
+    {
+      ++longest;
+    }
+    critical_path_[tv] = longest;
+    return longest;
+  }
+
+  void TOPPASScene::setCacheDirectory(const QString& dir)
+  {
+    cache_dir_ = dir;
+  }
+
+  const QString& TOPPASScene::getCacheDirectory() const
+  {
+    return cache_dir_;
+  }
+
+  QByteArray TOPPASScene::getFileHash(const QString& file)
+  {
+    QFileInfo fi(file);
+    QString stamp = QString::number(fi.size()) + "_" + fi.lastModified().toString(Qt::ISODate);
+    QHash<QString, QPair<QString, QByteArray> >::const_iterator it = file_hashes_.find(fi.absoluteFilePath());
+    if (it != file_hashes_.end() && it.value().first == stamp)
+    {
+      return it.value().second;
+    }
+
+    QCryptographicHash crypto(QCryptographicHash::Sha1);
+    QFile f(file);
+    if (!f.open(QFile::ReadOnly))
+    {
+      return QByteArray();
+    }
+    while (!f.atEnd())
+    {
+      crypto.addData(f.read(1 << 20));
+    }
+    QByteArray hash = crypto.result().toHex();
+    file_hashes_[fi.absoluteFilePath()] = qMakePair(stamp, hash);
+    return hash;
+  }
+
+  bool TOPPASScene::fetchCachedResults(const QString& key, const QStringList& files)
+  {
+    if (cache_dir_.isEmpty())
+    {
+      return false;
+    }
+
+    // the entry only exists once it is complete (see storeCachedResults())
+    QDir entry(cache_dir_ + QDir::separator() + key);
+    if (!entry.exists() || (int) entry.entryList(QDir::Files).size() != files.size())
+    {
+      return false;
+    }
+    for (int i = 0; i < files.size(); ++i)
+    {
+      if (QFile::exists(files[i]) && !QFile::remove(files[i]))
+      {
+        return false;
+      }
+      if (!QFile::copy(entry.filePath(QString::number(i)), files[i]))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void TOPPASScene::storeCachedResults(const QString& key, const QStringList& files)
+  {
+    if (cache_dir_.isEmpty())
+    {
+      return;
+    }
+
+    QDir cache(cache_dir_);
+    if (!cache.exists() && !cache.mkpath("."))
+    {
+      LOG_WARN << "Could not create the cache directory '" << String(cache_dir_) << "'." << std::endl;
+      return;
+    }
+    if (cache.exists(key))
+    {
+      return;
+    }
+
+    // copy to a temporary directory first, so that concurrent pipelines never see incomplete entries
+    QString tmp_name = key + "." + File::getUniqueName().toQString();
+    if (!cache.mkdir(tmp_name))
+    {
+      return;
+    }
+    QDir tmp(cache.filePath(tmp_name));
+    bool success = true;
+    for (int i = 0; i < files.size() && success; ++i)
+    {
+      success = QFile::copy(files[i], tmp.filePath(QString::number(i)));
+    }
+    if (!success || !cache.rename(tmp_name, key))
+    {
+      File::removeDirRecursively(cache.filePath(tmp_name));
+    }
+  }
+
   bool TOPPASScene::isDryRun() const
   {
     return dry_run_;
@@ -38,12 +38,15 @@
 #include <OpenMS/VISUAL/DIALOGS/TOPPASToolConfigDialog.h>
 #include <OpenMS/VISUAL/TOPPASScene.h>
 #include <OpenMS/VISUAL/TOPPASOutputFileListVertex.h>
+#include <OpenMS/CONCEPT/VersionInfo.h>
 #include <OpenMS/SYSTEM/File.h>
 #include <OpenMS/FORMAT/FileHandler.h>
 #include <OpenMS/FORMAT/ParamXMLFile.h>
 
 #include <QtGui/QGraphicsScene>
 #include <QtGui/QMessageBox>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDateTime>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
 #include <QtCore/QDir>
@@ -67,7 +70,9 @@ namespace OpenMS
     param_(),
     status_(TOOL_READY),
     tool_ready_(true),
-    breakpoint_set_(false)
+    breakpoint_set_(false),
+    threads_(1),
+    cache_entries_()
   {
     pen_color_ = Qt::black;
     brush_color_ = QColor(245, 245, 245);
@@ -84,7 +89,9 @@ namespace OpenMS
     type_(type),
     param_(),
     tool_ready_(true),
-    breakpoint_set_(false)
+    breakpoint_set_(false),
+    threads_(1),
+    cache_entries_()
   {
     pen_color_ = Qt::black;
     brush_color_ = QColor(245, 245, 245);
@@ -102,7 +109,9 @@ namespace OpenMS
     param_(rhs.param_),
     status_(rhs.status_),
     tool_ready_(rhs.tool_ready_),
-    breakpoint_set_(false)
+    breakpoint_set_(false),
+    threads_(1),
+    cache_entries_()
   {
     pen_color_ = Qt::black;
     brush_color_ = QColor(245, 245, 245);
@@ -557,6 +566,15 @@ namespace OpenMS
 
     bool ini_round_dependent = false; // indicates if we need a new INI file for each round (usually GenericWrapper issue)
 
+    // the threads of the tool are counted against the threads allowed for the whole pipeline
+    threads_ = 1;
+    if (param_.exists("threads"))
+    {
+      threads_ = qMax(1, qMin((int) param_.getValue("threads"), ts->getAllowedThreads()));
+      shared_args << "-threads" << QString::number(threads_);
+    }
+    bool use_cache = !ts->isDryRun() && !ts->getCacheDirectory().isEmpty();
+
     for (int round = 0; round < round_total_; ++round)
     {
       debugOut_(String("Enqueueing process nr ") + round + "/" + round_total_);
@@ -668,9 +686,23 @@ namespace OpenMS
       writeParam_(param_tmp, ini_file_iteration);
       args << "-ini" << ini_file_iteration;
 
+      // reuse the results of an earlier run with the same tool, parameters and input files
+      QString cache_key;
+      QStringList cache_files;
+      bool cached = false;
+      if (use_cache)
+      {
+        cache_key = computeCacheKey_(param_tmp, pkg[round], output_files_[round]);
+        for (EdgeIndexIt it_edge = output_files_[round].begin(); it_edge != output_files_[round].end(); ++it_edge)
+        {
+          cache_files << it_edge->second.filenames;
+        }
+        cached = ts->fetchCachedResults(cache_key, cache_files);
+      }
+
       // create process
       QProcess* p;
-      if (!ts->isDryRun())
+      if (!ts->isDryRun() && !cached)
       {
         p = new QProcess();
       }
@@ -679,6 +711,15 @@ namespace OpenMS
         p = new FakeProcess();
       }
 
+      if (cached)
+      {
+        ts->logTOPPOutput((String("\nReusing cached results of ") + name_ + " (round " + (round + 1) + "/" + round_total_ + ")\n").toQString());
+      }
+      else if (use_cache)
+      {
+        cache_entries_[p] = qMakePair(cache_key, cache_files);
+      }
+
       p->setProcessChannelMode(QProcess::MergedChannels);
       connect(p, SIGNAL(readyReadStandardOutput()), this, SLOT(forwardTOPPOutput()));
       connect(ts, SIGNAL(terminateCurrentPipeline()), p, SLOT(kill()));
@@ -698,7 +739,7 @@ namespace OpenMS
         }
       }
       toolScheduledSlot();
-      ts->enqueueProcess(TOPPASScene::TOPPProcess(p, File::findExecutable(name_).toQString(), args, this));
+      ts->enqueueProcess(TOPPASScene::TOPPProcess(p, File::findExecutable(name_).toQString(), args, this, threads_));
     }
 
     // run pending processes
@@ -707,6 +748,104 @@ namespace OpenMS
     __DEBUG_END_METHOD__
   }
 
+  QString TOPPASToolVertex::computeCacheKey_(const Param& param, const RoundPackage& inputs, const RoundPackage& outputs)
+  {
+    TOPPASScene* ts = qobject_cast<TOPPASScene*>(scene());
+    QCryptographicHash crypto(QCryptographicHash::Sha1);
+
+    // the tool (a rebuilt executable invalidates earlier results)
+    String executable_time;
+    try
+    {
+      executable_time = QFileInfo(File::findExecutable(name_).toQString()).lastModified().toString(Qt::ISODate);
+    }
+    catch (Exception::FileNotFound&)
+    {
+      // the tool cannot be started anyway
+    }
+    crypto.addData((name_ + "\n" + type_ + "\n" + VersionInfo::getVersion() + "\n" + executable_time + "\n").c_str());
+
+    // the parameters, except file names (the content of input files is hashed below) and those not affecting the results
+    QVector<IOInfo> in_params, out_params;
+    getInputParameters(in_params);
+    getOutputParameters(out_params);
+    std::set<String> ignored;
+    for (int i = 0; i < in_params.size(); ++i)
+    {
+      ignored.insert(in_params[i].param_name);
+    }
+    for (int i = 0; i < out_params.size(); ++i)
+    {
+      ignored.insert(out_params[i].param_name);
+    }
+    ignored.insert("log");
+    ignored.insert("debug");
+    ignored.insert("threads");
+    ignored.insert("no_progress");
+    // input files which are not fed by an edge (e.g. a database) are given as parameter value
+    std::set<String> unfed_inputs;
+    for (int i = 0; i < in_params.size(); ++i)
+    {
+      unfed_inputs.insert(in_params[i].param_name);
+    }
+    for (RoundPackageConstIt it = inputs.begin(); it != inputs.end(); ++it)
+    {
+      unfed_inputs.erase(in_params[it->second.edge->getTargetInParam()].param_name);
+    }
+    for (Param::ParamIterator it = param.begin(); it != param.end(); ++it)
+    {
+      String name = it.getName();
+      if (unfed_inputs.count(name) != 0)
+      {
+        // path and content of the files
+        StringList files;
+        if (it->value.valueType() == DataValue::STRING_LIST)
+        {
+          files = it->value;
+        }
+        else if (!it->value.toString().empty())
+        {
+          files.push_back(it->value.toString());
+        }
+        crypto.addData((String("file:") + name + "\n").c_str());
+        for (Size i = 0; i < files.size(); ++i)
+        {
+          crypto.addData((files[i] + "\n").c_str());
+          crypto.addData(ts->getFileHash(files[i].toQString()));
+          crypto.addData("\n");
+        }
+      }
+      else if (ignored.count(name) == 0)
+      {
+        crypto.addData((name + "=" + it->value.toString() + "\n").c_str());
+      }
+    }
+
+    // the input files
+    for (RoundPackageConstIt it = inputs.begin(); it != inputs.end(); ++it)
+    {
+      int param_index = it->second.edge->getTargetInParam();
+      crypto.addData((String("in:") + in_params[param_index].param_name + "\n").c_str());
+      foreach(QString file, it->second.filenames)
+      {
+        crypto.addData(ts->getFileHash(file));
+        crypto.addData("\n");
+      }
+    }
+
+    // the output parameters and formats
+    for (RoundPackageConstIt it = outputs.begin(); it != outputs.end(); ++it)
+    {
+      crypto.addData((String("out:") + out_params[it->first].param_name + "\n").c_str());
+      foreach(QString file, it->second.filenames)
+      {
+        crypto.addData((String(QFileInfo(file).suffix()) + "\n").c_str());
+      }
+    }
+
+    return QString(crypto.result().toHex());
+  }
+
   void TOPPASToolVertex::emitToolStarted()
   {
     emit toolStarted();
@@ -730,6 +869,12 @@ namespace OpenMS
     else
     {
       //** no error ... proceed
+      QHash<QObject*, QPair<QString, QStringList> >::const_iterator entry = cache_entries_.find(QObject::sender());
+      if (entry != cache_entries_.end())
+      {
+        ts->storeCachedResults(entry.value().first, entry.value().second);
+      }
+
       ++round_counter_;
       //std::cout << (String("Increased iteration_nr_ to ") + round_counter_ + " / " + round_total_ ) << " for " << this->name_ << std::endl;
 
@@ -764,13 +909,14 @@ namespace OpenMS
     }
 
     //clean up
+    cache_entries_.remove(QObject::sender());
     QProcess* p = qobject_cast<QProcess*>(QObject::sender());
     if (p)
     {
       delete p;
     }
 
-    ts->processFinished();
+    ts->processFinished(threads_);
 
     __DEBUG_END_METHOD__
   }
@@ -1181,6 +1327,7 @@ namespace OpenMS
       finished_ = false;
     status_ = TOOL_READY;
     output_files_.clear();
+    cache_entries_.clear();
 
     if (reset_all_files)
     {
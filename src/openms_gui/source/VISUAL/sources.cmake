@@ -11,10 +11,12 @@ EnhancedTabBar.cpp
 GUIProgressLoggerImpl.cpp
 HistogramWidget.cpp
 LayerData.cpp
+LayerDataLoader.cpp
 MetaDataBrowser.cpp
 MultiGradient.cpp
 MultiGradientSelector.cpp
 ParamEditor.cpp
+PeakMapPyramid.cpp
 SpectraViewWidget.cpp
 SpectraIdentificationViewWidget.cpp
 Spectrum1DCanvas.cpp
@@ -71,6 +71,11 @@ namespace OpenSwath
       - rt_score: deviation from the expected retention time
       - elution_fit_score: how well the elution profile fits a theoretical elution profile
 
+      The cross-correlations are stored densely: the traces are standardized
+      once and the cross-correlation arrays of all pairs of traces are kept
+      in one contiguous array (see Scoring::calculateCrossCorrelationDense).
+      The map-based matrix (getXCorrMatrix) is only built on request.
+
   */
   class OPENSWATHALGO_DLLAPI MRMScoring
   {
@@ -94,9 +99,12 @@ public:
     typedef boost::shared_ptr<OpenSwath::IFeature> FeatureType;
     //@}
 
+    /// Constructor
+    MRMScoring();
+
     /** @name Accessors */
     //@{
-    /// non-mutable access to the Cross-correlation matrix
+    /// non-mutable access to the Cross-correlation matrix (built from the dense representation on first access)
     const XCorrMatrixType& getXCorrMatrix() const;
     //@}
 
@@ -145,13 +153,38 @@ public:
 
 private:
 
+    /// Standardize the intensities of the given features and store them contiguously in @p traces, returns the trace length
+    static int getStandardizedTraces_(OpenSwath::IMRMFeature* mrmfeature,
+      const std::vector<String>& native_ids, std::vector<double>& traces);
+
+    /// Offset of the cross-correlation array of traces @p i <= @p j in xcorr_dense_
+    std::size_t xcorrOffset_(std::size_t i, std::size_t j) const;
+
     /** @name Members */
     //@{
-    /// the precomputed cross correlation matrix
-    XCorrMatrixType xcorr_matrix_;
+    /// number of traces in the cross correlation matrix
+    std::size_t xcorr_size_;
+
+    /// maximal lag of the cross correlations (each array holds 2 * xcorr_maxdelay_ + 1 lags)
+    int xcorr_maxdelay_;
+
+    /// the precomputed cross correlations of all pairs i <= j (upper triangle, row by row)
+    std::vector<double> xcorr_dense_;
+
+    /// number of traces cross correlated with the MS1 trace
+    std::size_t ms1_xcorr_size_;
+
+    /// maximal lag of the cross correlations with the MS1 trace
+    int ms1_xcorr_maxdelay_;
+
+    /// the precomputed cross correlation with the MS1 trace (one array per trace)
+    std::vector<double> ms1_xcorr_dense_;
+
+    /// the cross correlation matrix as maps (only built when requested)
+    mutable XCorrMatrixType xcorr_matrix_;
 
-    /// the precomputed cross correlation with the MS1 trace
-    std::vector<XCorrArrayType> ms1_xcorr_vector_;
+    /// is xcorr_matrix_ up to date?
+    mutable bool xcorr_matrix_valid_;
     //@}
 
   };
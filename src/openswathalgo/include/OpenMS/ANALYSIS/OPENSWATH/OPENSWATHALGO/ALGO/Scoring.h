@@ -106,9 +106,25 @@ namespace OpenSwath
     OPENSWATHALGO_DLLAPI XCorrArrayType calculateCrossCorrelation(std::vector<double>& data1,
                                                       std::vector<double>& data2, int maxdelay, int lag);
 
+    /** @brief Calculate crosscorrelation on plain arrays without normalization (dense version of calculateCrossCorrelation)
+
+      Computes the crosscorrelation for all lags from -maxdelay to maxdelay
+      (in steps of one) and stores the result for lag d contiguously in
+      result[d + maxdelay], i.e. @p result needs to hold 2 * maxdelay + 1
+      values. The inner products run over contiguous memory and are written
+      such that the compiler can vectorize them. Since their terms are summed
+      in a different order, the values agree with calculateCrossCorrelation
+      only up to rounding.
+    */
+    OPENSWATHALGO_DLLAPI void calculateCrossCorrelationDense(const double* data1,
+                                                             const double* data2, int n, int maxdelay, double* result);
+
     /// Find best peak in an cross-correlation (highest apex)
     OPENSWATHALGO_DLLAPI XCorrArrayType::iterator xcorrArrayGetMaxPeak(XCorrArrayType & array);
 
+    /// Find best peak in a dense cross-correlation array (see calculateCrossCorrelationDense), returns lag and value of the highest apex
+    OPENSWATHALGO_DLLAPI std::pair<int, double> xcorrArrayGetMaxPeak(const double* array, int maxdelay);
+
     /// Standardize a vector (subtract mean, divide by standard deviation)
     OPENSWATHALGO_DLLAPI void standardize_data(std::vector<double>& data);
 
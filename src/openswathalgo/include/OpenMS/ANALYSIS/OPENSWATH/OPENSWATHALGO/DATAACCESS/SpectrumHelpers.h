@@ -67,6 +67,24 @@ namespace OpenSwath
                                              std::vector<double>& integratedWindowsIntensity,
                                              std::vector<double>& integratedWindowsMZ, bool remZero = false);
 
+  /**
+    @brief Integrate intensities in a spectrum for a batch of windows in a single sweep
+
+    Computes the same total intensity and intensity-weighted m/z for each
+    window [mz_start[i], mz_end[i]) as integrateWindow does for non-centroided
+    data. The windows are visited in order of their lower bound so that the
+    m/z array is only traversed once (using a galloping search between
+    windows) instead of being bisected twice per window. Windows may be
+    given in any order and may overlap.
+
+    @note Windows without signal get an m/z of -1 and an intensity of 0
+  */
+  OPENSWATHALGO_DLLAPI void integrateWindowBatch(const OpenSwath::SpectrumPtr spectrum, //!< [in] Spectrum
+                                                 const std::vector<double>& mz_start, //!< [in] lower window bounds
+                                                 const std::vector<double>& mz_end, //!< [in] upper window bounds
+                                                 std::vector<double>& mz, //!< [out] intensity-weighted m/z per window
+                                                 std::vector<double>& intensity); //!< [out] total intensity per window
+
 }
 
 #endif // OPENMS_ANALYSIS_OPENSWATH_OPENSWATHALGO_DATAACCESS_SPECTRUMHELPERS_H
@@ -44,47 +44,116 @@
 namespace OpenSwath
 {
 
+  MRMScoring::MRMScoring() :
+    xcorr_size_(0),
+    xcorr_maxdelay_(0),
+    ms1_xcorr_size_(0),
+    ms1_xcorr_maxdelay_(0),
+    xcorr_matrix_valid_(true)
+  {
+  }
+
   const MRMScoring::XCorrMatrixType& MRMScoring::getXCorrMatrix() const
   {
+    if (!xcorr_matrix_valid_)
+    {
+      // convert the dense arrays (only the upper triangle is filled, as before)
+      xcorr_matrix_.clear();
+      xcorr_matrix_.resize(xcorr_size_);
+      for (std::size_t i = 0; i < xcorr_size_; i++)
+      {
+        xcorr_matrix_[i].resize(xcorr_size_);
+        for (std::size_t j = i; j < xcorr_size_; j++)
+        {
+          const double* array = &xcorr_dense_[xcorrOffset_(i, j)];
+          for (int k = 0; k <= 2 * xcorr_maxdelay_; k++)
+          {
+            xcorr_matrix_[i][j][k - xcorr_maxdelay_] = array[k];
+          }
+        }
+      }
+      xcorr_matrix_valid_ = true;
+    }
     return xcorr_matrix_;
   }
 
-  void MRMScoring::initializeXCorrMatrix(OpenSwath::IMRMFeature* mrmfeature, std::vector<String> native_ids)
+  std::size_t MRMScoring::xcorrOffset_(std::size_t i, std::size_t j) const
+  {
+    // index of pair (i, j) in the upper triangle (including the diagonal), row by row
+    std::size_t pair_index = i * xcorr_size_ - (i * (i - 1)) / 2 + (j - i);
+    return pair_index * (2 * xcorr_maxdelay_ + 1);
+  }
+
+  int MRMScoring::getStandardizedTraces_(OpenSwath::IMRMFeature* mrmfeature,
+                                         const std::vector<String>& native_ids, std::vector<double>& traces)
   {
-    std::vector<double> intensityi, intensityj;
-    xcorr_matrix_.resize(native_ids.size());
+    std::vector<double> intensity;
+    traces.clear();
+    std::size_t trace_length = 0;
     for (std::size_t i = 0; i < native_ids.size(); i++)
     {
-      String native_id = native_ids[i];
-      FeatureType fi = mrmfeature->getFeature(native_id);
-      xcorr_matrix_[i].resize(native_ids.size());
-      intensityi.clear();
-      fi->getIntensity(intensityi);
-      for (std::size_t j = i; j < native_ids.size(); j++)
+      intensity.clear();
+      mrmfeature->getFeature(native_ids[i])->getIntensity(intensity);
+      if (i == 0)
+      {
+        trace_length = intensity.size();
+        traces.reserve(native_ids.size() * trace_length);
+      }
+      OPENSWATH_PRECONDITION(intensity.size() == trace_length, "All traces need to have the same length");
+      Scoring::standardize_data(intensity);
+      traces.insert(traces.end(), intensity.begin(), intensity.end());
+    }
+    return boost::numeric_cast<int>(trace_length);
+  }
+
+  void MRMScoring::initializeXCorrMatrix(OpenSwath::IMRMFeature* mrmfeature, std::vector<String> native_ids)
+  {
+    // standardize each trace only once
+    std::vector<double> traces;
+    int n = getStandardizedTraces_(mrmfeature, native_ids, traces);
+
+    xcorr_size_ = native_ids.size();
+    xcorr_maxdelay_ = n;
+    xcorr_dense_.resize(xcorr_size_ * (xcorr_size_ + 1) / 2 * (2 * n + 1));
+    xcorr_matrix_valid_ = false;
+    for (std::size_t i = 0; i < xcorr_size_; i++)
+    {
+      for (std::size_t j = i; j < xcorr_size_; j++)
       {
-        String native_id2 = native_ids[j];
-        FeatureType fj = mrmfeature->getFeature(native_id2);
-        intensityj.clear();
-        fj->getIntensity(intensityj);
         // compute normalized cross correlation
-        xcorr_matrix_[i][j] = Scoring::normalizedCrossCorrelation(intensityi, intensityj, boost::numeric_cast<int>(intensityi.size()), 1);
+        double* array = &xcorr_dense_[xcorrOffset_(i, j)];
+        Scoring::calculateCrossCorrelationDense(&traces[i * n], &traces[j * n], n, n, array);
+        for (int k = 0; k <= 2 * n; k++)
+        {
+          array[k] /= n;
+        }
       }
     }
   }
 
   void MRMScoring::initializeMS1XCorr(OpenSwath::IMRMFeature* mrmfeature, std::vector<String> native_ids, std::string precursor_id)
   {
-    std::vector<double> intensityi, intensity_ms1;
+    std::vector<double> intensity_ms1;
     mrmfeature->getPrecursorFeature(precursor_id)->getIntensity(intensity_ms1);
-    ms1_xcorr_vector_.resize(native_ids.size());
-    for (std::size_t i = 0; i < native_ids.size(); i++)
+    std::vector<double> traces;
+    int n = getStandardizedTraces_(mrmfeature, native_ids, traces);
+    if (!native_ids.empty())
+    {
+      OPENSWATH_PRECONDITION(intensity_ms1.size() == (std::size_t)n, "Both data vectors need to have the same length");
+      Scoring::standardize_data(intensity_ms1);
+    }
+
+    ms1_xcorr_size_ = native_ids.size();
+    ms1_xcorr_maxdelay_ = n;
+    ms1_xcorr_dense_.resize(ms1_xcorr_size_ * (2 * n + 1));
+    for (std::size_t i = 0; i < ms1_xcorr_size_; i++)
     {
-      String native_id = native_ids[i];
-      FeatureType fi = mrmfeature->getFeature(native_id);
-      intensityi.clear();
-      fi->getIntensity(intensityi);
-      ms1_xcorr_vector_[i] = Scoring::normalizedCrossCorrelation(
-        intensityi, intensity_ms1, boost::numeric_cast<int>(intensityi.size()), 1);
+      double* array = &ms1_xcorr_dense_[i * (2 * n + 1)];
+      Scoring::calculateCrossCorrelationDense(&traces[i * n], &intensity_ms1[0], n, n, array);
+      for (int k = 0; k <= 2 * n; k++)
+      {
+        array[k] /= n;
+      }
     }
   }
 
@@ -96,17 +165,17 @@ namespace OpenSwath
   // return $deltascore_mean + $deltascore_stdev
   double MRMScoring::calcXcorrCoelutionScore()
   {
-    OPENSWATH_PRECONDITION(xcorr_matrix_.size() > 1, "Expect cross-correlation matrix of at least 2x2");
+    OPENSWATH_PRECONDITION(xcorr_size_ > 1, "Expect cross-correlation matrix of at least 2x2");
 
     std::vector<int> deltas;
-    for (std::size_t i = 0; i < xcorr_matrix_.size(); i++)
+    for (std::size_t i = 0; i < xcorr_size_; i++)
     {
-      for (std::size_t  j = i; j < xcorr_matrix_.size(); j++)
+      for (std::size_t j = i; j < xcorr_size_; j++)
       {
         // first is the X value (RT), should be an int
-        deltas.push_back(std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->first));
+        deltas.push_back(std::abs(Scoring::xcorrArrayGetMaxPeak(&xcorr_dense_[xcorrOffset_(i, j)], xcorr_maxdelay_).first));
 #ifdef MRMSCORING_TESTING
-        std::cout << "&&_xcoel append " << std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->first) << std::endl;
+        std::cout << "&&_xcoel append " << std::abs(Scoring::xcorrArrayGetMaxPeak(&xcorr_dense_[xcorrOffset_(i, j)], xcorr_maxdelay_).first) << std::endl;
 #endif
       }
     }
@@ -123,32 +192,32 @@ namespace OpenSwath
   double MRMScoring::calcXcorrCoelutionScore_weighted(
     const std::vector<double>& normalized_library_intensity)
   {
-    OPENSWATH_PRECONDITION(xcorr_matrix_.size() > 1, "Expect cross-correlation matrix of at least 2x2");
+    OPENSWATH_PRECONDITION(xcorr_size_ > 1, "Expect cross-correlation matrix of at least 2x2");
 
 #ifdef MRMSCORING_TESTING
     double weights = 0;
 #endif
     std::vector<double> deltas;
-    for (std::size_t i = 0; i < xcorr_matrix_.size(); i++)
+    for (std::size_t i = 0; i < xcorr_size_; i++)
     {
       deltas.push_back(
-        std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][i])->first)
+        std::abs(Scoring::xcorrArrayGetMaxPeak(&xcorr_dense_[xcorrOffset_(i, i)], xcorr_maxdelay_).first)
         * normalized_library_intensity[i]
         * normalized_library_intensity[i]);
 #ifdef MRMSCORING_TESTING
-      std::cout << "_xcoel_weighted " << i << " " << i << " " << Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][i])->first << " weight " <<
+      std::cout << "_xcoel_weighted " << i << " " << i << " " << Scoring::xcorrArrayGetMaxPeak(&xcorr_dense_[xcorrOffset_(i, i)], xcorr_maxdelay_).first << " weight " <<
         normalized_library_intensity[i] * normalized_library_intensity[i] << std::endl;
       weights += normalized_library_intensity[i] * normalized_library_intensity[i];
 #endif
-      for (std::size_t j = i + 1; j < xcorr_matrix_.size(); j++)
+      for (std::size_t j = i + 1; j < xcorr_size_; j++)
       {
         // first is the X value (RT), should be an int
         deltas.push_back(
-          std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->first)
+          std::abs(Scoring::xcorrArrayGetMaxPeak(&xcorr_dense_[xcorrOffset_(i, j)], xcorr_maxdelay_).first)
           * normalized_library_intensity[i]
           * normalized_library_intensity[j] * 2);
 #ifdef MRMSCORING_TESTING
-        std::cout << "_xcoel_weighted " << i << " " << j << " " << Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->first << " weight " <<
+        std::cout << "_xcoel_weighted " << i << " " << j << " " << Scoring::xcorrArrayGetMaxPeak(&xcorr_dense_[xcorrOffset_(i, j)], xcorr_maxdelay_).first << " weight " <<
           normalized_library_intensity[i] * normalized_library_intensity[j] * 2 << std::endl;
         weights += normalized_library_intensity[i] * normalized_library_intensity[j];
 #endif
@@ -171,15 +240,15 @@ namespace OpenSwath
   ///
   double MRMScoring::calcXcorrShape_score()
   {
-    OPENSWATH_PRECONDITION(xcorr_matrix_.size() > 1, "Expect cross-correlation matrix of at least 2x2");
+    OPENSWATH_PRECONDITION(xcorr_size_ > 1, "Expect cross-correlation matrix of at least 2x2");
 
     std::vector<double> intensities;
-    for (std::size_t i = 0; i < xcorr_matrix_.size(); i++)
+    for (std::size_t i = 0; i < xcorr_size_; i++)
     {
-      for (std::size_t j = i; j < xcorr_matrix_.size(); j++)
+      for (std::size_t j = i; j < xcorr_size_; j++)
       {
         // second is the Y value (intensity)
-        intensities.push_back(Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->second);
+        intensities.push_back(Scoring::xcorrArrayGetMaxPeak(&xcorr_dense_[xcorrOffset_(i, j)], xcorr_maxdelay_).second);
       }
     }
     OpenSwath::mean_and_stddev msc;
@@ -190,30 +259,30 @@ namespace OpenSwath
   double MRMScoring::calcXcorrShape_score_weighted(
     const std::vector<double>& normalized_library_intensity)
   {
-    OPENSWATH_PRECONDITION(xcorr_matrix_.size() > 1, "Expect cross-correlation matrix of at least 2x2");
+    OPENSWATH_PRECONDITION(xcorr_size_ > 1, "Expect cross-correlation matrix of at least 2x2");
 
     // TODO (hroest) : check implementation
     //         see _calc_weighted_xcorr_shape_score in MRM_pgroup.pm
     //         -- they only multiply up the intensity once
     std::vector<double> intensities;
-    for (std::size_t i = 0; i < xcorr_matrix_.size(); i++)
+    for (std::size_t i = 0; i < xcorr_size_; i++)
     {
       intensities.push_back(
-        Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][i])->second
+        Scoring::xcorrArrayGetMaxPeak(&xcorr_dense_[xcorrOffset_(i, i)], xcorr_maxdelay_).second
         * normalized_library_intensity[i]
         * normalized_library_intensity[i]);
 #ifdef MRMSCORING_TESTING
-      std::cout << "_xcorr_weighted " << i << " " << i << " " << Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][i])->second << " weight " <<
+      std::cout << "_xcorr_weighted " << i << " " << i << " " << Scoring::xcorrArrayGetMaxPeak(&xcorr_dense_[xcorrOffset_(i, i)], xcorr_maxdelay_).second << " weight " <<
         normalized_library_intensity[i] * normalized_library_intensity[i] << std::endl;
 #endif
-      for (std::size_t j = i + 1; j < xcorr_matrix_.size(); j++)
+      for (std::size_t j = i + 1; j < xcorr_size_; j++)
       {
         intensities.push_back(
-          Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->second
+          Scoring::xcorrArrayGetMaxPeak(&xcorr_dense_[xcorrOffset_(i, j)], xcorr_maxdelay_).second
           * normalized_library_intensity[i]
           * normalized_library_intensity[j] * 2);
 #ifdef MRMSCORING_TESTING
-        std::cout << "_xcorr_weighted " << i << " " << j << " " << Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->second << " weight " <<
+        std::cout << "_xcorr_weighted " << i << " " << j << " " << Scoring::xcorrArrayGetMaxPeak(&xcorr_dense_[xcorrOffset_(i, j)], xcorr_maxdelay_).second << " weight " <<
           normalized_library_intensity[i] * normalized_library_intensity[j] * 2 << std::endl;
 #endif
       }
@@ -223,13 +292,13 @@ namespace OpenSwath
 
   double MRMScoring::calcMS1XcorrCoelutionScore()
   {
-    OPENSWATH_PRECONDITION(ms1_xcorr_vector_.size() > 1, "Expect cross-correlation vector of a size of least 2");
+    OPENSWATH_PRECONDITION(ms1_xcorr_size_ > 1, "Expect cross-correlation vector of a size of least 2");
 
     std::vector<int> deltas;
-    for (std::size_t i = 0; i < ms1_xcorr_vector_.size(); i++)
+    for (std::size_t i = 0; i < ms1_xcorr_size_; i++)
     {
       // first is the X value (RT), should be an int
-      deltas.push_back(std::abs(Scoring::xcorrArrayGetMaxPeak(ms1_xcorr_vector_[i])->first));
+      deltas.push_back(std::abs(Scoring::xcorrArrayGetMaxPeak(&ms1_xcorr_dense_[i * (2 * ms1_xcorr_maxdelay_ + 1)], ms1_xcorr_maxdelay_).first));
     }
 
     OpenSwath::mean_and_stddev msc;
@@ -245,13 +314,13 @@ namespace OpenSwath
 
   double MRMScoring::calcMS1XcorrShape_score()
   {
-    OPENSWATH_PRECONDITION(ms1_xcorr_vector_.size() > 1, "Expect cross-correlation vector of a size of least 2");
+    OPENSWATH_PRECONDITION(ms1_xcorr_size_ > 1, "Expect cross-correlation vector of a size of least 2");
 
     std::vector<double> intensities;
-    for (std::size_t i = 0; i < ms1_xcorr_vector_.size(); i++)
+    for (std::size_t i = 0; i < ms1_xcorr_size_; i++)
     {
       // second is the Y value (intensity)
-      intensities.push_back(Scoring::xcorrArrayGetMaxPeak(ms1_xcorr_vector_[i])->second);
+      intensities.push_back(Scoring::xcorrArrayGetMaxPeak(&ms1_xcorr_dense_[i * (2 * ms1_xcorr_maxdelay_ + 1)], ms1_xcorr_maxdelay_).second);
     }
     OpenSwath::mean_and_stddev msc;
     msc = std::for_each(intensities.begin(), intensities.end(), msc);
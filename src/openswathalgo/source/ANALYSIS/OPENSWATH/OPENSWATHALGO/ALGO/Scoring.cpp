@@ -34,6 +34,7 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/ALGO/Scoring.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/Macros.h>
+#include <algorithm>
 #include <cmath>
 
 #include <boost/numeric/conversion/cast.hpp>
@@ -43,6 +44,33 @@ namespace OpenSwath
   namespace Scoring
   {
 
+    namespace
+    {
+      /**
+        @brief Inner product with four independent partial sums (allows the compiler to use SIMD instructions)
+
+        The summation order differs from a sequential loop, so the result may
+        differ from it (e.g. from calculateCrossCorrelation) in the last bits.
+      */
+      inline double dotProduct(const double* x, const double* y, int n)
+      {
+        double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        int i = 0;
+        for (; i + 3 < n; i += 4)
+        {
+          s0 += x[i] * y[i];
+          s1 += x[i + 1] * y[i + 1];
+          s2 += x[i + 2] * y[i + 2];
+          s3 += x[i + 3] * y[i + 3];
+        }
+        for (; i < n; ++i)
+        {
+          s0 += x[i] * y[i];
+        }
+        return (s0 + s1) + (s2 + s3);
+      }
+    }
+
     void normalize_sum(double x[], unsigned int n)
     {
       double sumx = std::accumulate(&x[0], &x[0] + n, 0.0);
@@ -119,6 +147,21 @@ namespace OpenSwath
       return max_it;
     }
 
+    std::pair<int, double> xcorrArrayGetMaxPeak(const double* array, int maxdelay)
+    {
+      OPENSWATH_PRECONDITION(maxdelay >= 0, "Cannot get highest apex from empty array.");
+
+      int max_index = 0;
+      for (int k = 1; k <= 2 * maxdelay; ++k)
+      {
+        if (array[k] > array[max_index])
+        {
+          max_index = k;
+        }
+      }
+      return std::make_pair(max_index - maxdelay, array[max_index]);
+    }
+
     void standardize_data(std::vector<double>& data)
     {
       OPENSWATH_PRECONDITION(data.size() > 0, "Need non-empty array.");
@@ -180,6 +223,20 @@ namespace OpenSwath
       return result;
     }
 
+    void calculateCrossCorrelationDense(const double* data1, const double* data2,
+                                        int n, int maxdelay, double* result)
+    {
+      OPENSWATH_PRECONDITION(n > 0 && maxdelay >= 0, "Need at least one element");
+
+      for (int delay = -maxdelay; delay <= maxdelay; ++delay)
+      {
+        // overlap of data1[i] and data2[i + delay]
+        int start = std::max(0, -delay);
+        int end = std::min(n, n - delay);
+        result[delay + maxdelay] = (end > start) ? dotProduct(data1 + start, data2 + start + delay, end - start) : 0.0;
+      }
+    }
+
     XCorrArrayType calcxcorr_legacy_mquest_(std::vector<double>& data1,
                                             std::vector<double>& data2, bool normalize)
     {
@@ -42,6 +42,40 @@
 namespace OpenSwath
 {
 
+  namespace
+  {
+    /// orders window indices by their lower bound
+    struct WindowStartLess
+    {
+      explicit WindowStartLess(const std::vector<double>& mz_start) :
+        mz_start_(mz_start)
+      {
+      }
+
+      bool operator()(std::size_t a, std::size_t b) const
+      {
+        return mz_start_[a] < mz_start_[b];
+      }
+
+      const std::vector<double>& mz_start_;
+    };
+
+    /// lower_bound for a value expected close to @p first (exponential search followed by bisection)
+    std::vector<double>::const_iterator gallopLowerBound(std::vector<double>::const_iterator first,
+                                                         std::vector<double>::const_iterator last, double value)
+    {
+      std::ptrdiff_t step = 1;
+      std::vector<double>::const_iterator probe = first;
+      while (last - probe > step && *(probe + step) < value)
+      {
+        probe += step;
+        step *= 2;
+      }
+      std::vector<double>::const_iterator bound = (last - probe > step) ? probe + step + 1 : last;
+      return std::lower_bound(probe, bound, value);
+    }
+  }
+
   void integrateWindows(const OpenSwath::SpectrumPtr spectrum,
                         const std::vector<double> & windowsCenter, double width,
                         std::vector<double> & integratedWindowsIntensity,
@@ -126,4 +160,52 @@ namespace OpenSwath
     }
   }
 
+  void integrateWindowBatch(const OpenSwath::SpectrumPtr spectrum,
+                            const std::vector<double>& mz_start, const std::vector<double>& mz_end,
+                            std::vector<double>& mz, std::vector<double>& intensity)
+  {
+    OPENSWATH_PRECONDITION(mz_start.size() == mz_end.size(), "Need the same number of lower and upper window bounds")
+    OPENSWATH_PRECONDITION( std::adjacent_find(spectrum->getMZArray()->data.begin(),
+            spectrum->getMZArray()->data.end(), std::greater<double>()) == spectrum->getMZArray()->data.end(),
+          "Precondition violated: m/z vector needs to be sorted!" )
+
+    mz.assign(mz_start.size(), -1);
+    intensity.assign(mz_start.size(), 0);
+
+    std::vector<std::size_t> order(mz_start.size());
+    for (std::size_t i = 0; i < order.size(); ++i)
+    {
+      order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), WindowStartLess(mz_start));
+
+    const std::vector<double>& mz_arr = spectrum->getMZArray()->data;
+    const std::vector<double>& int_arr = spectrum->getIntensityArray()->data;
+
+    // the lower bounds are visited in increasing order, thus the start of the
+    // current window can only move forward in the m/z array
+    std::vector<double>::const_iterator mz_it_start = mz_arr.begin();
+    for (std::size_t k = 0; k < order.size(); ++k)
+    {
+      const std::size_t w = order[k];
+      mz_it_start = gallopLowerBound(mz_it_start, mz_arr.end(), mz_start[w]);
+      std::vector<double>::const_iterator mz_it_end = gallopLowerBound(mz_it_start, mz_arr.end(), mz_end[w]);
+
+      // same summation order as integrateWindow
+      double sum_int = 0, sum_mz = 0;
+      std::vector<double>::const_iterator int_it = int_arr.begin() + (mz_it_start - mz_arr.begin());
+      for (std::vector<double>::const_iterator mz_it = mz_it_start; mz_it != mz_it_end; ++mz_it, ++int_it)
+      {
+        sum_int += (*int_it);
+        sum_mz += (*int_it) * (*mz_it);
+      }
+
+      if (sum_int > 0.)
+      {
+        mz[w] = sum_mz / sum_int;
+        intensity[w] = sum_int;
+      }
+    }
+  }
+
 }
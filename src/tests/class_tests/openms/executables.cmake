@@ -11,6 +11,7 @@ set(concept_executables_list
   VersionInfo_test
   LogConfigHandler_test
   LogStream_test
+  ParallelExceptionCollector_test
   UnaryComposeFunctionAdapter_test
   UniqueIdGenerator_test
   UniqueIdIndexer_test
@@ -49,6 +50,7 @@ set(datastructures_executables_list
   Matrix_test
   #MatrixUtils_test
   Param_test
+  ProteinSuffixArray_test
   QTCluster_test
   RangeManager_test
   SparseVector_test
@@ -111,6 +113,7 @@ set(system_executables_list
   File_test
   FileWatcher_test
   JavaInfo_test
+  Profiler_test
   StopWatch_test
   SysInfo_test
 )
@@ -180,7 +183,8 @@ set(format_executables_list
   MascotInfile_test
   MascotRemoteQuery_test
   MascotXMLFile_test
-  #MSDataWritingConsumer_test
+  MappedFASTAFile_test
+  MSDataWritingConsumer_test
   MsInspectFile_test
   MzDataFile_test
   MzIdentMLFile_test
@@ -212,6 +216,7 @@ set(format_executables_list
   SequestInfile_test
   SequestOutfile_test
   SpecArrayFile_test
+  SpectrumMetaIndex_test
   SwathFile_test
   SwathFileConsumer_test
   SwathWindowLoader_test
@@ -229,6 +234,7 @@ set(format_executables_list
   MSDataCachedConsumer_test
   MSDataTransformingConsumer_test
   MSDataChainingConsumer_test
+  MSDataParallelTransformingConsumer_test
 )
 
 set(math_executables_list
@@ -336,6 +342,7 @@ set(comparison_executables_list
 set(chemistry_executables_list
   AAIndex_test
   AASequence_test
+  DigestedPeptideTable_test
   EdwardsLippertIteratorTryptic_test
   EdwardsLippertIterator_test
   ElementDB_test
@@ -562,6 +569,7 @@ if(NOT DISABLE_OPENSWATH)
     ChromatogramExtractor_test
     ChromatogramExtractorAlgorithm_test
     OpenSwathHelper_test
+    LightTransitionTable_test
     OpenSwathScoring_test
     PeakPickerMRM_test
     MRMTransitionGroupPicker_test
@@ -571,6 +579,7 @@ if(NOT DISABLE_OPENSWATH)
     OpenSwathMRMFeatureAccessOpenMS_test
     SpectrumAddition_test
     OpenSwathSpectrumAccessOpenMS_test
+    OpenSwathSpectrumAccessSharedMemory_test
     OpenSwathDataAccessHelper_test
     MRMFeatureScoring_test
     MRMFeatureFinderScoring_test
@@ -590,6 +599,7 @@ set(Boost_dependent_tests
   OpenSwathHelper_test
   OpenSwathMRMFeatureAccessOpenMS_test
   OpenSwathSpectrumAccessOpenMS_test
+  OpenSwathSpectrumAccessSharedMemory_test
   PeakPickerMRM_test
   StatisticFunctions_test
   String_test
@@ -64,9 +64,79 @@ START_SECTION(~ConsensusIDAlgorithmPEPMatrix())
 END_SECTION
 
 
+// create 2 ID runs:
+PeptideIdentification temp;
+temp.setScoreType("Posterior Error Probability");
+temp.setHigherScoreBetter(false);
+vector<PeptideIdentification> ids(2, temp);
+vector<PeptideHit> hits(1);
+hits[0].setSequence(AASequence::fromString("PEPTIDE"));
+hits[0].setScore(0.1);
+ids[0].setHits(hits);
+hits.resize(2);
+hits[0].setSequence(AASequence::fromString("PEPTLDE"));
+hits[0].setScore(0.2);
+hits[1].setSequence(AASequence::fromString("PEPTIDA"));
+hits[1].setScore(0.3);
+ids[1].setHits(hits);
+
 START_SECTION(void apply(std::vector<PeptideIdentification>& ids))
 {
-  NOT_TESTABLE // tested by ConsensusID TOPP tool tests
+  // (more extensive tests by ConsensusID TOPP tool tests)
+  TOLERANCE_ABSOLUTE(0.0001)
+
+  ConsensusIDAlgorithmPEPMatrix consensus;
+  // define parameters (identity matrix treats I/L as equal):
+  Param param;
+  param.setValue("matrix", "identity");
+  param.setValue("penalty", 5);
+  consensus.setParameters(param);
+  // apply (twice, to check that cached similarities give the same result):
+  for (Size i = 0; i < 2; ++i)
+  {
+    vector<PeptideIdentification> f = ids;
+    consensus.apply(f);
+
+    TEST_EQUAL(f.size(), 1);
+    hits = f[0].getHits();
+    TEST_EQUAL(hits.size(), 3);
+
+    // "PEPTIDE" and "PEPTLDE" are identical according to the matrix:
+    TEST_REAL_SIMILAR(hits[0].getScore(), 0.075);
+    TEST_REAL_SIMILAR(hits[0].getMetaValue("consensus_support"), 1.0);
+    TEST_REAL_SIMILAR(hits[1].getScore(), 0.075);
+    TEST_REAL_SIMILAR(hits[1].getMetaValue("consensus_support"), 1.0);
+
+    // similarity of "PEPTIDA" to "PEPTIDE" is 6/7:
+    TEST_EQUAL(hits[2].getSequence(), AASequence::fromString("PEPTIDA"));
+    TEST_REAL_SIMILAR(hits[2].getScore(), (0.3 + 0.1 * 6 / 7) / 
+                      ((13.0 / 7) * (13.0 / 7)));
+    TEST_REAL_SIMILAR(hits[2].getMetaValue("consensus_support"), 6.0 / 7);
+  }
+
+  // residues without a row in the matrix are scored as the closest amino
+  // acid (selenocysteine as cysteine, pyrrolysine as lysine):
+  const char* others[] = {"PEPTIDE", "PEPCIDK"};
+  for (Size i = 0; i < 2; ++i)
+  {
+    vector<PeptideIdentification> f(2, temp);
+    hits.resize(1);
+    hits[0].setSequence(AASequence::fromString("PEPUIDO"));
+    hits[0].setScore(0.1);
+    f[0].setHits(hits);
+    hits[0].setSequence(AASequence::fromString(others[i]));
+    hits[0].setScore(0.2);
+    f[1].setHits(hits);
+    consensus.apply(f);
+
+    TEST_EQUAL(f.size(), 1);
+    hits = f[0].getHits();
+    TEST_EQUAL(hits.size(), 2);
+    // "PEPUIDO" matches "PEPTIDE" at 5 of 7 positions, "PEPCIDK" at all:
+    double similarity = (i == 0) ? 5.0 / 7 : 1.0;
+    TEST_REAL_SIMILAR(hits[0].getMetaValue("consensus_support"), similarity);
+    TEST_REAL_SIMILAR(hits[1].getMetaValue("consensus_support"), similarity);
+  }
 }
 END_SECTION
 
@@ -135,6 +135,37 @@ START_SECTION(double eval(double x))
   }
 END_SECTION
 
+START_SECTION(void eval(const double* x, double* y, size_t n))
+  // sorted positions, including the knots at the borders
+  std::vector<double> positions;
+  positions.push_back(486.784);
+  positions.push_back(486.785);
+  positions.push_back(486.790);
+  positions.push_back(486.794);
+  positions.push_back(486.794);
+  positions.push_back(486.808);
+  positions.push_back(486.811);
+  std::vector<double> values(positions.size());
+  sp1.eval(&positions[0], &values[0], positions.size());
+  for (Size i = 0; i < positions.size(); ++i)
+  {
+    TEST_REAL_SIMILAR(values[i], sp1.eval(positions[i]));
+  }
+
+  // in place, starting in the middle
+  sp5.eval(&x[3], &values[0], 1);
+  TEST_REAL_SIMILAR(values[0], y[3]);
+  std::vector<double> xx(x.begin() + 3, x.end());
+  sp5.eval(&xx[0], &xx[0], xx.size());
+  for (Size i = 0; i < xx.size(); ++i)
+  {
+    TEST_REAL_SIMILAR(xx[i], y[i + 3]);
+  }
+
+  positions.push_back(487.0);
+  TEST_EXCEPTION(Exception::IllegalArgument, sp1.eval(&positions[0], &values[0], positions.size()));
+END_SECTION
+
 START_SECTION(double derivatives(double x, unsigned order))
   // near border of spline range
   TEST_REAL_SIMILAR(sp1.derivatives(486.785,1), 39270152.2996247)
@@ -429,6 +429,73 @@ START_SECTION ( void dia_by_ion_score(SpectrumType spectrum, AASequence &sequenc
 }
 END_SECTION
 
+START_SECTION((void dia_ms2_scores(const std::vector<TransitionType>& transitions, SpectrumPtrType spectrum, OpenSwath::IMRMFeature* mrmfeature, const std::vector<double>& normalized_library_intensity, AASequence& sequence, int by_charge, double& isotope_corr, double& isotope_overlap, double& ppm_score, double& ppm_score_weighted, double& bseries_score, double& yseries_score)))
+{
+  MockMRMFeature * imrmfeature_test = new MockMRMFeature();
+  getMRMFeatureTest(imrmfeature_test);
+
+  std::vector<OpenSwath::LightTransition> transitions;
+  transitions.push_back(mock_tr1);
+  transitions.push_back(mock_tr2);
+  std::vector<double> normalized_library_intensity;
+  normalized_library_intensity.push_back(0.7);
+  normalized_library_intensity.push_back(0.3);
+
+  // b/y ions of SYVAWDR, see dia_by_ion_score
+  OpenSwath::SpectrumPtr sptr = prepareSpectrum();
+  static const double by_mz[] = {350.17164, 421.20875, 547.26291, 646.33133};
+  for (Size i = 0; i < 4; ++i)
+  {
+    std::vector<double>::iterator pos = std::lower_bound(sptr->getMZArray()->data.begin(), sptr->getMZArray()->data.end(), by_mz[i]);
+    Size idx = pos - sptr->getMZArray()->data.begin();
+    sptr->getMZArray()->data.insert(pos, by_mz[i]);
+    sptr->getIntensityArray()->data.insert(sptr->getIntensityArray()->data.begin() + idx, 100);
+  }
+
+  AASequence a = AASequence::fromString("SYVAWDR");
+  AASequence a_mod = AASequence::fromString("SYVAWDR");
+  a_mod.setModification(1, "Phospho");
+
+  DIAScoring diascoring;
+  diascoring.set_dia_parameters(0.05, false, 30, 50, 4, 4);
+
+  // repeated calls (reusing the cached b/y series and isotope patterns) and
+  // a change of the sequence need to give the same result as the single scores
+  AASequence sequences[3] = {a, a, a_mod};
+  for (Size i = 0; i < 3; ++i)
+  {
+    double isotope_corr, isotope_overlap, ppm_score, ppm_score_weighted, bseries_score, yseries_score;
+    diascoring.dia_ms2_scores(transitions, sptr, imrmfeature_test, normalized_library_intensity, sequences[i], 1,
+                              isotope_corr, isotope_overlap, ppm_score, ppm_score_weighted, bseries_score, yseries_score);
+
+    DIAScoring reference;
+    reference.set_dia_parameters(0.05, false, 30, 50, 4, 4);
+    double ref_isotope_corr, ref_isotope_overlap, ref_ppm_score, ref_ppm_score_weighted, ref_bseries_score, ref_yseries_score;
+    reference.dia_isotope_scores(transitions, sptr, imrmfeature_test, ref_isotope_corr, ref_isotope_overlap);
+    reference.dia_massdiff_score(transitions, sptr, normalized_library_intensity, ref_ppm_score, ref_ppm_score_weighted);
+    reference.dia_by_ion_score(sptr, sequences[i], 1, ref_bseries_score, ref_yseries_score);
+
+    TEST_REAL_SIMILAR(isotope_corr, ref_isotope_corr)
+    TEST_REAL_SIMILAR(isotope_overlap, ref_isotope_overlap)
+    TEST_REAL_SIMILAR(ppm_score, ref_ppm_score)
+    TEST_REAL_SIMILAR(ppm_score_weighted, ref_ppm_score_weighted)
+    TEST_REAL_SIMILAR(bseries_score, ref_bseries_score)
+    TEST_REAL_SIMILAR(yseries_score, ref_yseries_score)
+  }
+
+  // see dia_isotope_scores and dia_by_ion_score
+  double isotope_corr, isotope_overlap, ppm_score, ppm_score_weighted, bseries_score, yseries_score;
+  diascoring.dia_ms2_scores(transitions, sptr, imrmfeature_test, normalized_library_intensity, a, 1,
+                            isotope_corr, isotope_overlap, ppm_score, ppm_score_weighted, bseries_score, yseries_score);
+  TEST_REAL_SIMILAR(isotope_corr, 0.995361286111832 * 0.7 + 0.959570883150479 * 0.3)
+  TEST_REAL_SIMILAR(isotope_overlap, 0.0 * 0.7 + 1.0 * 0.3)
+  TEST_REAL_SIMILAR(bseries_score, 2)
+  TEST_REAL_SIMILAR(yseries_score, 2)
+
+  delete imrmfeature_test;
+}
+END_SECTION
+
 START_SECTION((void set_dia_parameters(double dia_extract_window, double dia_centroided, double dia_byseries_intensity_min, double dia_byseries_ppm_diff, double dia_nr_isotopes, double dia_nr_charges)))
 {
   NOT_TESTABLE
@@ -0,0 +1,168 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+
+#include <OpenMS/CHEMISTRY/DigestedPeptideTable.h>
+#include <OpenMS/CHEMISTRY/AASequence.h>
+#include <OpenMS/FORMAT/FASTAFile.h>
+
+#include <set>
+
+using namespace OpenMS;
+using namespace std;
+
+///////////////////////////
+
+START_TEST(DigestedPeptideTable, "$Id$")
+
+/////////////////////////////////////////////////////////////
+
+EnzymaticDigestion digestion;
+
+DigestedPeptideTable* ptr = 0;
+DigestedPeptideTable* null_ptr = 0;
+START_SECTION((DigestedPeptideTable(const EnzymaticDigestion& digestion, Size min_length = 1, Size max_length = 0)))
+  ptr = new DigestedPeptideTable(digestion);
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->size(), 0)
+  TEST_EQUAL(ptr->getProteinCount(), 0)
+END_SECTION
+
+START_SECTION((~DigestedPeptideTable()))
+  delete ptr;
+END_SECTION
+
+START_SECTION((Size addProteins(const std::vector<String>& proteins)))
+  DigestedPeptideTable table(digestion);
+  vector<String> proteins;
+  proteins.push_back("ARCDRE");
+  proteins.push_back("CDRKPE");
+  proteins.push_back("AR#K"); // unknown residue
+  TEST_EQUAL(table.addProteins(proteins), 4) // AR, CDR, E, KPE
+  TEST_EQUAL(table.getProteinCount(), 3)
+  TEST_EQUAL(table.addProteins(vector<String>(1, "ARCDRE")), 0)
+  TEST_EQUAL(table.getProteinCount(), 4)
+  TEST_EQUAL(table.size(), 4)
+
+  // length filter:
+  DigestedPeptideTable filtered(digestion, 3, 3);
+  TEST_EQUAL(filtered.addProteins(proteins), 2) // CDR, KPE
+END_SECTION
+
+START_SECTION((Size size() const))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION((Size getProteinCount() const))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION((const PeptideRecord& getRecord(Size index) const))
+  DigestedPeptideTable table(digestion);
+  vector<String> proteins;
+  proteins.push_back("ARCDRE");
+  proteins.push_back("CDRKPE");
+  table.addProteins(proteins);
+  TEST_EQUAL(table.size(), 4)
+  const DigestedPeptideTable::PeptideRecord& record = table.getRecord(3);
+  TEST_EQUAL(record.offset, 6)
+  TEST_EQUAL(record.length, 3)
+  TEST_EQUAL(record.protein, 1)
+  TEST_EQUAL(record.position, 3)
+  TEST_EQUAL(table.getRecord(0).offset, 0)
+  TEST_EQUAL(table.getRecord(0).length, 2)
+  TEST_REAL_SIMILAR(record.mass, AASequence::fromString("KPE").getMonoWeight())
+  TEST_REAL_SIMILAR(table.getRecord(0).mass, AASequence::fromString("AR").getMonoWeight())
+  TEST_EXCEPTION(Exception::IndexOverflow, table.getRecord(4))
+END_SECTION
+
+START_SECTION((String getSequence(Size index) const))
+  DigestedPeptideTable table(digestion);
+  vector<String> proteins;
+  proteins.push_back("ARCDRE");
+  proteins.push_back("CDRKPE");
+  table.addProteins(proteins);
+  TEST_STRING_EQUAL(table.getSequence(0), "AR")
+  TEST_STRING_EQUAL(table.getSequence(1), "CDR")
+  TEST_STRING_EQUAL(table.getSequence(2), "E")
+  TEST_STRING_EQUAL(table.getSequence(3), "KPE")
+  TEST_EXCEPTION(Exception::IndexOverflow, table.getSequence(4))
+END_SECTION
+
+START_SECTION((Size addFASTAFile(const String& filename, Size batch_size = 10000)))
+  EnzymaticDigestion mc_digestion;
+  mc_digestion.setMissedCleavages(1);
+  DigestedPeptideTable table(mc_digestion, 5);
+  TEST_EXCEPTION(Exception::FileNotFound, table.addFASTAFile("DigestedPeptideTable_test_this_file_does_not_exist"))
+  TEST_EQUAL(table.addFASTAFile(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"), 2), 5)
+  TEST_EQUAL(table.getProteinCount(), 5)
+  TEST_STRING_EQUAL(table.getSequence(0), "EQLLQR") // "GDR" is too short
+
+  // compare to digestion of the fully loaded file:
+  vector<FASTAFile::FASTAEntry> entries;
+  FASTAFile().load(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"), entries);
+  set<String> peptides;
+  for (Size i = 0; i < entries.size(); ++i)
+  {
+    vector<pair<Size, Size> > digest;
+    mc_digestion.digestUnmodifiedString(entries[i].sequence, digest, 5);
+    for (Size p = 0; p < digest.size(); ++p)
+    {
+      String peptide = entries[i].sequence.substr(digest[p].first, digest[p].second);
+      if (peptide.find_first_of("()") == String::npos) peptides.insert(peptide); // skip modifications
+    }
+  }
+  TEST_EQUAL(table.size(), peptides.size())
+  for (Size i = 0; i < table.size(); ++i)
+  {
+    TEST_EQUAL(peptides.count(table.getSequence(i)), 1)
+  }
+END_SECTION
+
+START_SECTION((void clear()))
+  DigestedPeptideTable table(digestion);
+  table.addProteins(vector<String>(1, "ARCDRE"));
+  table.clear();
+  TEST_EQUAL(table.size(), 0)
+  TEST_EQUAL(table.getProteinCount(), 0)
+  TEST_EQUAL(table.addProteins(vector<String>(1, "ARCDRE")), 3)
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
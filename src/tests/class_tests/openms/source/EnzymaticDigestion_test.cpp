@@ -341,6 +341,69 @@ START_SECTION((void digest(const AASequence& protein, std::vector< AASequence >&
 END_SECTION
 
 
+START_SECTION((Size digestUnmodifiedString(const String& sequence, std::vector<std::pair<Size, Size> >& output, Size min_length = 1, Size max_length = 0) const))
+  EnzymaticDigestion ed;
+  vector<pair<Size, Size> > out;
+
+  TEST_EQUAL(ed.digestUnmodifiedString("ACDE", out), 0)
+  TEST_EQUAL(out.size(), 1)
+  TEST_EQUAL(out[0].first, 0)
+  TEST_EQUAL(out[0].second, 4)
+
+  ed.digestUnmodifiedString("ACKPDE", out);
+  TEST_EQUAL(out.size(), 1)
+
+  ed.digestUnmodifiedString("ARCRDRE", out);
+  TEST_EQUAL(out.size(), 4)
+  TEST_EQUAL(out[1].first, 2)
+  TEST_EQUAL(out[1].second, 2)
+  TEST_EQUAL(out[3].first, 6)
+  TEST_EQUAL(out[3].second, 1)
+
+  // same peptides (and order) as digest():
+  ed.setMissedCleavages(1);
+  String protein = "ARCDRE";
+  vector<AASequence> peptides;
+  ed.digest(AASequence::fromString(protein), peptides);
+  ed.digestUnmodifiedString(protein, out);
+  TEST_EQUAL(out.size(), peptides.size())
+  ABORT_IF(out.size() != peptides.size())
+  for (Size i = 0; i < out.size(); ++i)
+  {
+    TEST_STRING_EQUAL(protein.substr(out[i].first, out[i].second), peptides[i].toString())
+  }
+
+  // length filter: "AR", "CDR", "E", "ARCDR", "CDRE"
+  TEST_EQUAL(ed.digestUnmodifiedString(protein, out, 2, 4), 2)
+  TEST_EQUAL(out.size(), 3)
+  TEST_EQUAL(out[0].first, 0)
+  TEST_EQUAL(out[1].first, 2)
+  TEST_EQUAL(out[2].first, 2)
+  TEST_EQUAL(out[2].second, 4)
+
+  // log model:
+  ed.setLogModelEnabled(true);
+  protein = "MKWVTFISLLLLFSSAYSRGVFRRDTHKSEIAHRFKDLGEEHFKGLVLIAFSQYLQQCPFDEHVKLVNELTEFAKTCVADESHAGCEKSLHTLFGDELCKVASLRETYGDMADCCEKQEPERNECFLSHKDDSPDLPKLKPDPNTLCDEFKADEKKFWGKYLYEIARRHPYFYAPELLYYANKYNGVFQECQAEDKGACLLPKIETMREKVLASSARQRLRCASIQKFGERALKAWSVARLSQKFPKAEFVEVTKLVTDLTKVHKECCHGDLLECADDRADLAKYICDNQDTISSKLKECCDKPLLEKSHCIAEVEKDAIPENLPPLTADFAEDKDVCKNYQEAKDAFLGSFLYEYSRRHPEYAVSVLLRLAKEYEATLEECCKDDPHACYSTVFDKLKHLVDEPQNLIKQNCDQFEKLGEYGFQNALIVRYTRKVPQVSTPTLVEVSRSLGKVGTRCCTKPESERMPCTEDYLSLILNRLCVLHEKTPVSEKVTKCCTESLVNRRPCFSALTPDETYVPKAFDEKLFTFHADICTLPDTEKQIKKQTALVELLKHKPKATEEQLKTVMENFVAFDKCCAADDKEACFAVEGPKLVVSTQTALA";
+  ed.digest(AASequence::fromString(protein), peptides);
+  ed.digestUnmodifiedString(protein, out);
+  TEST_EQUAL(out.size(), 11)
+  ABORT_IF(out.size() != peptides.size())
+  for (Size i = 0; i < out.size(); ++i)
+  {
+    TEST_STRING_EQUAL(protein.substr(out[i].first, out[i].second), peptides[i].toString())
+  }
+
+  // Trypsin/P:
+  ed.setMissedCleavages(0);
+  ed.setEnzyme(EnzymaticDigestion::ENZYME_TRYPSIN_P);
+  TEST_EXCEPTION(Exception::InvalidParameter, ed.digestUnmodifiedString("ANGER", out));
+  ed.setLogModelEnabled(false);
+  ed.digestUnmodifiedString("ACKPDE", out);
+  TEST_EQUAL(out.size(), 2)
+  TEST_EQUAL(out[1].first, 3)
+  TEST_EQUAL(out[1].second, 3)
+END_SECTION
+
 START_SECTION(( bool isValidProduct(const AASequence& protein, Size pep_pos, Size pep_length) ))
   EnzymaticDigestion ed;
   ed.setEnzyme(EnzymaticDigestion::ENZYME_TRYPSIN);
@@ -227,6 +227,151 @@ START_SECTION((void apply(std::vector<ProteinIdentification>& ids)))
 }
 END_SECTION
 
+START_SECTION((static void calculateFDRs(const std::vector<ScoreEntry> &entries, std::vector<double> &fdrs, bool q_value, bool higher_score_better)))
+{
+  typedef FalseDiscoveryRate::ScoreEntry Entry;
+  vector<Entry> entries;
+  // group 0: targets 10, 8, 6, 4 and decoys 9, 5
+  entries.push_back(Entry(6.0, 0, false));
+  entries.push_back(Entry(9.0, 0, true));
+  entries.push_back(Entry(10.0, 0, false));
+  entries.push_back(Entry(4.0, 0, false));
+  entries.push_back(Entry(5.0, 0, true));
+  entries.push_back(Entry(8.0, 0, false));
+  // group 1: decoys only
+  entries.push_back(Entry(7.0, 1, true));
+
+  vector<double> fdrs;
+  FalseDiscoveryRate::calculateFDRs(entries, fdrs, false, true);
+  TEST_EQUAL(fdrs.size(), entries.size())
+  TEST_REAL_SIMILAR(fdrs[0], 1.0 / 3.0)
+  TEST_REAL_SIMILAR(fdrs[1], 0.0) // closest targets 10 and 8, the better one is used for FDRs
+  TEST_REAL_SIMILAR(fdrs[2], 0.0)
+  TEST_REAL_SIMILAR(fdrs[3], 0.5)
+  TEST_REAL_SIMILAR(fdrs[4], 1.0 / 3.0) // closest targets 6 and 4
+  TEST_REAL_SIMILAR(fdrs[5], 0.5)
+  TEST_REAL_SIMILAR(fdrs[6], 1.0)
+
+  FalseDiscoveryRate::calculateFDRs(entries, fdrs, true, true);
+  TEST_REAL_SIMILAR(fdrs[0], 1.0 / 3.0)
+  TEST_REAL_SIMILAR(fdrs[1], 1.0 / 3.0) // the worse one for q-values
+  TEST_REAL_SIMILAR(fdrs[2], 0.0)
+  TEST_REAL_SIMILAR(fdrs[3], 0.5)
+  TEST_REAL_SIMILAR(fdrs[4], 0.5)
+  TEST_REAL_SIMILAR(fdrs[5], 1.0 / 3.0)
+  TEST_REAL_SIMILAR(fdrs[6], 1.0)
+
+  // lower score better: mirrored scores give the same result
+  for (vector<Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
+  {
+    it->score = -it->score;
+  }
+  FalseDiscoveryRate::calculateFDRs(entries, fdrs, true, false);
+  TEST_REAL_SIMILAR(fdrs[0], 1.0 / 3.0)
+  TEST_REAL_SIMILAR(fdrs[1], 1.0 / 3.0)
+  TEST_REAL_SIMILAR(fdrs[2], 0.0)
+  TEST_REAL_SIMILAR(fdrs[3], 0.5)
+  TEST_REAL_SIMILAR(fdrs[4], 0.5)
+  TEST_REAL_SIMILAR(fdrs[5], 1.0 / 3.0)
+  TEST_REAL_SIMILAR(fdrs[6], 1.0)
+  FalseDiscoveryRate::calculateFDRs(entries, fdrs, false, false);
+  TEST_REAL_SIMILAR(fdrs[0], 1.0 / 3.0)
+  TEST_REAL_SIMILAR(fdrs[1], 0.0)
+  TEST_REAL_SIMILAR(fdrs[4], 1.0 / 3.0)
+  TEST_REAL_SIMILAR(fdrs[5], 0.5)
+
+  entries.clear();
+  FalseDiscoveryRate::calculateFDRs(entries, fdrs, true, true);
+  TEST_EQUAL(fdrs.empty(), true)
+}
+END_SECTION
+
+START_SECTION([EXTRA] apply(std::vector<PeptideIdentification>& ids) with unknown target/decoy values)
+{
+  // targets 10, 8, 6, 4 and decoys 9, 5; hits with unknown 'target_decoy' values get the value of a hit with the same score (or 0)
+  double scores[] = {10.0, 9.0, 8.0, 6.0, 5.0, 4.0, 8.0, 7.0};
+  String target_decoy[] = {"target", "decoy", "target", "target+decoy", "decoy", "target", "unknown", ""};
+  vector<PeptideIdentification> pep_ids;
+  for (Size i = 0; i < 8; ++i)
+  {
+    PeptideIdentification pep_id;
+    pep_id.setIdentifier("run");
+    pep_id.setScoreType("score");
+    pep_id.setHigherScoreBetter(true);
+    PeptideHit hit;
+    hit.setScore(scores[i]);
+    hit.setMetaValue("target_decoy", target_decoy[i]);
+    pep_id.insertHit(hit);
+    pep_ids.push_back(pep_id);
+  }
+
+  FalseDiscoveryRate fdr;
+  Param param = fdr.getParameters();
+  param.setValue("q_value", "false");
+  fdr.setParameters(param);
+  vector<PeptideIdentification> fdr_ids = pep_ids;
+  fdr.apply(fdr_ids);
+  TEST_EQUAL(fdr_ids.size(), 8)
+  TEST_EQUAL(fdr_ids[0].getScoreType(), "FDR")
+  TEST_REAL_SIMILAR(fdr_ids[0].getHits()[0].getScore(), 0.0)
+  TEST_EQUAL(fdr_ids[1].getHits().size(), 0) // decoys are removed
+  TEST_REAL_SIMILAR(fdr_ids[2].getHits()[0].getScore(), 0.5)
+  TEST_REAL_SIMILAR(fdr_ids[3].getHits()[0].getScore(), 1.0 / 3.0)
+  TEST_EQUAL(fdr_ids[4].getHits().size(), 0)
+  TEST_REAL_SIMILAR(fdr_ids[5].getHits()[0].getScore(), 0.5)
+  TEST_REAL_SIMILAR(fdr_ids[6].getHits()[0].getScore(), 0.5)
+  TEST_REAL_SIMILAR(fdr_ids[7].getHits()[0].getScore(), 0.0)
+
+  param.setValue("q_value", "true");
+  fdr.setParameters(param);
+  fdr_ids = pep_ids;
+  fdr.apply(fdr_ids);
+  TEST_EQUAL(fdr_ids[0].getScoreType(), "q-value")
+  TEST_REAL_SIMILAR(fdr_ids[2].getHits()[0].getScore(), 1.0 / 3.0)
+  TEST_REAL_SIMILAR(fdr_ids[6].getHits()[0].getScore(), 1.0 / 3.0)
+  TEST_REAL_SIMILAR(fdr_ids[7].getHits()[0].getScore(), 0.0)
+}
+END_SECTION
+
+START_SECTION([EXTRA] apply(std::vector<ProteinIdentification>& ids) with many hits)
+{
+  // q-values of a large protein list must agree with the flat engine and be monotonous in the score
+  ProteinIdentification prot_id;
+  prot_id.setScoreType("score");
+  prot_id.setHigherScoreBetter(true);
+  vector<FalseDiscoveryRate::ScoreEntry> entries;
+  for (Size i = 0; i < 5000; ++i)
+  {
+    ProteinHit hit;
+    bool decoy = (i % 7 == 0) || (i % 5 == 0 && i < 2500);
+    hit.setAccession(String("P") + i + (decoy ? "_rev" : ""));
+    hit.setScore((double)((i * 7919) % 1000));
+    prot_id.insertHit(hit);
+    entries.push_back(FalseDiscoveryRate::ScoreEntry(hit.getScore(), 0, decoy));
+  }
+  vector<ProteinIdentification> prot_ids(1, prot_id);
+
+  ptr->apply(prot_ids);
+  vector<double> fdrs;
+  FalseDiscoveryRate::calculateFDRs(entries, fdrs, true, true);
+
+  TEST_EQUAL(prot_ids[0].getScoreType(), "q-value")
+  TEST_EQUAL(prot_ids[0].getHits().size(), entries.size())
+  bool all_equal(true), monotonous(true);
+  const vector<ProteinHit>& hits = prot_ids[0].getHits();
+  for (Size i = 0; i < hits.size(); ++i)
+  {
+    if (hits[i].getScore() != fdrs[i]) all_equal = false;
+    for (Size j = 0; j < hits.size(); j += 97)
+    {
+      if (!entries[i].is_decoy && !entries[j].is_decoy && entries[i].score > entries[j].score && hits[i].getScore() > hits[j].getScore()) monotonous = false;
+    }
+  }
+  TEST_EQUAL(all_equal, true)
+  TEST_EQUAL(monotonous, true)
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
@@ -37,6 +37,11 @@
 
 ///////////////////////////
 #include <OpenMS/ANALYSIS/MAPMATCHING/FeatureGroupingAlgorithmUnlabeled.h>
+#include <OpenMS/KERNEL/FeatureMap.h>
+#include <OpenMS/SYSTEM/StopWatch.h>
+#include <OpenMS/DATASTRUCTURES/ListUtils.h>
+
+#include <map>
 
 ///////////////////////////
 
@@ -76,6 +81,76 @@ START_SECTION((virtual void group(const std::vector< FeatureMap > &maps, Consens
 	NOT_TESTABLE;
 END_SECTION
 
+// maps with the same well separated features, slightly shifted from map to map
+std::vector<FeatureMap> test_maps(16);
+Size features_per_map = 300;
+for (Size m = 0; m < test_maps.size(); ++m)
+{
+  for (Size i = 0; i < features_per_map; ++i)
+  {
+    Feature feature;
+    feature.setRT(100.0 + 30.0 * (i % 50) + 0.1 * ((m * 7 + i) % 5));
+    feature.setMZ(400.0 + 1.0 * (i / 50) + 0.001 * ((m * 3 + i) % 4));
+    feature.setIntensity(1000.0 + i);
+    feature.setCharge(2);
+    feature.setUniqueId();
+    test_maps[m].push_back(feature);
+  }
+  test_maps[m].setUniqueId();
+}
+
+START_SECTION(([EXTRA] merge_order "tree"))
+{
+  FeatureGroupingAlgorithmUnlabeled fga;
+  Param p = fga.getParameters();
+  TEST_EQUAL(String(p.getValue("merge_order")), "sequential")
+  p.setValue("merge_order", "tree");
+  fga.setParameters(p);
+
+  // odd number of maps (one map moves up a level unmerged)
+  std::vector<FeatureMap> maps(test_maps.begin(), test_maps.begin() + 5);
+  ConsensusMap out;
+  fga.group(maps, out);
+  TEST_EQUAL(out.size(), features_per_map)
+  Size complete = 0;
+  for (Size i = 0; i < out.size(); ++i)
+  {
+    if (out[i].size() == maps.size()) ++complete;
+  }
+  TEST_EQUAL(complete, features_per_map)
+  TEST_EXCEPTION(Exception::IllegalArgument, fga.group(std::vector<FeatureMap>(1), out))
+}
+END_SECTION
+
+START_SECTION(([EXTRA] benchmark: merge_order "tree" vs. "sequential"))
+{
+  std::map<String, std::map<Size, Size> > sizes; // merge order -> consensus size -> count
+  StringList orders = ListUtils::create<String>("sequential,tree");
+  for (Size o = 0; o < orders.size(); ++o)
+  {
+    FeatureGroupingAlgorithmUnlabeled fga;
+    Param p = fga.getParameters();
+    p.setValue("merge_order", orders[o]);
+    fga.setParameters(p);
+
+    ConsensusMap out;
+    StopWatch watch;
+    watch.start();
+    fga.group(test_maps, out);
+    watch.stop();
+
+    for (Size i = 0; i < out.size(); ++i)
+    {
+      ++sizes[orders[o]][out[i].size()];
+    }
+    STATUS(orders[o] << ": " << test_maps.size() << " maps in " << watch.getClockTime() << " s (wall), "
+           << out.size() << " consensus features, " << sizes[orders[o]][test_maps.size()] << " of them complete");
+  }
+  TEST_EQUAL(sizes["tree"] == sizes["sequential"], true)
+  TEST_EQUAL(sizes["tree"][test_maps.size()], features_per_map)
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
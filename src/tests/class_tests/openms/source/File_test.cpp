@@ -82,6 +82,26 @@ START_SECTION((static bool remove(const String &file)))
 	TEST_EQUAL(File::remove(filename), true)
 END_SECTION
 
+START_SECTION((static bool rename(const String &old_filename, const String &new_filename)))
+	String old_name, new_name;
+	NEW_TMP_FILE(old_name);
+	NEW_TMP_FILE(new_name);
+	TEST_EQUAL(File::rename(old_name, new_name), false) // doesn't exist
+
+	ofstream os(old_name.c_str());
+	os << "new" << endl;
+	os.close();
+	os.open(new_name.c_str());
+	os << "old" << endl;
+	os.close();
+	TEST_EQUAL(File::rename(old_name, new_name), true) // replaces the target
+	TEST_EQUAL(File::exists(old_name), false)
+	ifstream is(new_name.c_str());
+	String content;
+	is >> content;
+	TEST_STRING_EQUAL(content, "new")
+END_SECTION
+
 START_SECTION((static bool readable(const String &file)))
 	TEST_EQUAL(File::readable("does_not_exists.txt"), false)
 	TEST_EQUAL(File::readable(OPENMS_GET_TEST_DATA_PATH("File_test_empty.txt")), true)
@@ -43,6 +43,8 @@
 #include <OpenMS/KERNEL/FeatureMap.h>
 #include <OpenMS/CHEMISTRY/EmpiricalFormula.h>
 
+#include <cmath>
+
 using namespace OpenMS;
 using namespace std;
 
@@ -67,7 +69,7 @@ START_SECTION(virtual ~ILPDCWrapper())
 END_SECTION
 
 
-START_SECTION((double compute(const FeatureMap fm, PairsType &pairs, Size verbose_level) const))
+START_SECTION((double compute(const FeatureMap& fm, PairsType &pairs, Size verbose_level) const))
 {
   EmpiricalFormula ef("H1");
   Adduct a(+1, 1, ef.getMonoWeight(), "H1", 0.1, 0, "");
@@ -89,6 +91,32 @@ START_SECTION((double compute(const FeatureMap fm, PairsType &pairs, Size verbos
 }
 END_SECTION
 
+START_SECTION(([EXTRA] compute with several slices))
+{
+  // 1200 independent edges -> more than one slice (at most ~1000 edges per slice)
+  FeatureMap fm;
+  ILPDCWrapper::PairsType pairs;
+  for (Size i = 0; i < 1200; ++i)
+  {
+    fm.push_back(Feature());
+    fm.push_back(Feature());
+    pairs.push_back(ChargePair(2 * i, 2 * i + 1, 1, 1, Compomer(0, 0.0, log(0.5)), 0.0, false));
+  }
+
+  ILPDCWrapper iw;
+  double score = iw.compute(fm, pairs, 1);
+
+  // the objective values of all slices are summed up
+  TEST_REAL_SIMILAR(score, 600.0)
+  Size active = 0;
+  for (Size i = 0; i < pairs.size(); ++i)
+  {
+    if (pairs[i].isActive()) ++active;
+  }
+  TEST_EQUAL(active, 1200)
+}
+END_SECTION
+
 
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
@@ -0,0 +1,437 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+
+#include <OpenMS/ANALYSIS/OPENSWATH/LightTransitionTable.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/DataAccessHelper.h>
+#include <OpenMS/FORMAT/TraMLFile.h>
+
+#include <algorithm>
+#include <cmath>
+
+///////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+/// Three peptides on two proteins; pep_2 has the lowest precursor m/z
+OpenSwath::LightTargetedExperiment createTestExperiment()
+{
+  OpenSwath::LightTargetedExperiment exp;
+  const char* protein_ids[] = {"prot_1", "prot_2"};
+  for (Size i = 0; i < 2; ++i)
+  {
+    OpenSwath::LightProtein protein;
+    protein.id = protein_ids[i];
+    protein.sequence = "PEPTIDEKPEPTIDER";
+    exp.proteins.push_back(protein);
+  }
+
+  const char* peptide_ids[] = {"pep_0", "pep_1", "pep_2"};
+  double precursor_mz[] = {500.0, 510.0, 450.0};
+  for (Size i = 0; i < 3; ++i)
+  {
+    OpenSwath::LightPeptide peptide;
+    peptide.id = peptide_ids[i];
+    peptide.rt = 10.0 * i;
+    peptide.charge = 2;
+    peptide.sequence = "PEPTIDEK";
+    peptide.peptide_group_label = peptide_ids[i];
+    peptide.protein_refs.push_back(protein_ids[i / 2]);
+    exp.peptides.push_back(peptide);
+
+    for (Size k = 0; k < 2; ++k)
+    {
+      OpenSwath::LightTransition transition;
+      transition.transition_name = String(peptide_ids[i]) + "_" + String(k);
+      transition.peptide_ref = peptide_ids[i];
+      transition.library_intensity = 100.0 * (k + 1);
+      transition.product_mz = 300.0 + k;
+      transition.precursor_mz = precursor_mz[i];
+      transition.charge = 1;
+      transition.decoy = (i == 1);
+      transition.detecting_transition = true;
+      transition.quantifying_transition = (k == 0);
+      transition.identifying_transition = false;
+      exp.transitions.push_back(transition);
+    }
+  }
+  OpenSwath::LightModification modification;
+  modification.location = 3;
+  modification.unimod_id = "UniMod:35";
+  exp.peptides[1].modifications.push_back(modification);
+  exp.transitions[3].site_identifying_transition.push_back(1);
+  exp.transitions[3].site_identifying_class.push_back("pep_1");
+  return exp;
+}
+
+/// Exposes the columns, to store damaged tables
+class LightTransitionTableTest :
+  public LightTransitionTable
+{
+public:
+  explicit LightTransitionTableTest(const OpenSwath::LightTargetedExperiment& targeted_exp) :
+    LightTransitionTable(targeted_exp)
+  {
+  }
+
+  using LightTransitionTable::string_offsets_;
+  using LightTransitionTable::precursor_mz_;
+  using LightTransitionTable::product_mz_;
+  using LightTransitionTable::flags_;
+  using LightTransitionTable::transition_name_;
+  using LightTransitionTable::peptide_;
+  using LightTransitionTable::site_transition_offsets_;
+  using LightTransitionTable::protein_refs_;
+};
+
+START_TEST(LightTransitionTable, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+LightTransitionTable* ptr = 0;
+LightTransitionTable* null_ptr = 0;
+START_SECTION(LightTransitionTable())
+{
+  ptr = new LightTransitionTable();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->size(), 0)
+}
+END_SECTION
+
+START_SECTION(virtual ~LightTransitionTable())
+{
+  delete ptr;
+}
+END_SECTION
+
+OpenSwath::LightTargetedExperiment exp = createTestExperiment();
+LightTransitionTable table(exp);
+
+START_SECTION(void build(const OpenSwath::LightTargetedExperiment& targeted_exp))
+{
+  TEST_EQUAL(table.size(), 6)
+  TEST_EQUAL(table.getNrPeptides(), 3)
+  TEST_EQUAL(table.getNrProteins(), 2)
+
+  // sorted by precursor m/z
+  TEST_EQUAL(table.getTransitionName(0), "pep_2_0")
+  TEST_EQUAL(table.getTransitionName(1), "pep_2_1")
+  TEST_EQUAL(table.getTransitionName(2), "pep_0_0")
+  TEST_EQUAL(table.getTransitionName(5), "pep_1_1")
+  TEST_REAL_SIMILAR(table.getPrecursorMZ(0), 450.0)
+  TEST_REAL_SIMILAR(table.getProductMZ(1), 301.0)
+  TEST_REAL_SIMILAR(table.getLibraryIntensity(1), 200.0)
+  TEST_EQUAL(table.getCharge(1), 1)
+  TEST_EQUAL(table.getPeptideRef(4), "pep_1")
+  TEST_EQUAL(table.getPeptideIndex(4), 1)
+  TEST_EQUAL(table.isDecoy(3), false)
+  TEST_EQUAL(table.isDecoy(4), true)
+
+  OpenSwath::LightTargetedExperiment bad_exp = createTestExperiment();
+  bad_exp.transitions[2].peptide_ref = "unknown";
+  LightTransitionTable bad_table;
+  TEST_EXCEPTION(Exception::IllegalArgument, bad_table.build(bad_exp))
+  TEST_EQUAL(bad_table.size(), 0)
+}
+END_SECTION
+
+START_SECTION(void getTransition(Size row, OpenSwath::LightTransition& transition) const)
+{
+  OpenSwath::LightTransition transition;
+  table.getTransition(5, transition);
+  const OpenSwath::LightTransition& expected = exp.transitions[3];
+  TEST_EQUAL(transition.transition_name, expected.transition_name)
+  TEST_EQUAL(transition.peptide_ref, expected.peptide_ref)
+  TEST_REAL_SIMILAR(transition.library_intensity, expected.library_intensity)
+  TEST_REAL_SIMILAR(transition.product_mz, expected.product_mz)
+  TEST_REAL_SIMILAR(transition.precursor_mz, expected.precursor_mz)
+  TEST_EQUAL(transition.charge, expected.charge)
+  TEST_EQUAL(transition.decoy, true)
+  TEST_EQUAL(transition.detecting_transition, true)
+  TEST_EQUAL(transition.quantifying_transition, false)
+  TEST_EQUAL(transition.identifying_transition, false)
+  TEST_EQUAL(transition.site_identifying_transition.size(), 1)
+  TEST_EQUAL(transition.site_identifying_transition[0], 1)
+  TEST_EQUAL(transition.site_identifying_class.size(), 1)
+  TEST_EQUAL(transition.site_identifying_class[0], "pep_1")
+}
+END_SECTION
+
+START_SECTION(void getPeptide(Size index, OpenSwath::LightPeptide& peptide) const)
+{
+  OpenSwath::LightPeptide peptide;
+  table.getPeptide(1, peptide);
+  TEST_EQUAL(peptide.id, "pep_1")
+  TEST_REAL_SIMILAR(peptide.rt, 10.0)
+  TEST_EQUAL(peptide.charge, 2)
+  TEST_EQUAL(peptide.sequence, "PEPTIDEK")
+  TEST_EQUAL(peptide.peptide_group_label, "pep_1")
+  TEST_EQUAL(peptide.protein_refs.size(), 1)
+  TEST_EQUAL(peptide.protein_refs[0], "prot_1")
+  TEST_EQUAL(peptide.modifications.size(), 1)
+  TEST_EQUAL(peptide.modifications[0].location, 3)
+  TEST_EQUAL(peptide.modifications[0].unimod_id, "UniMod:35")
+}
+END_SECTION
+
+START_SECTION(void getProtein(Size index, OpenSwath::LightProtein& protein) const)
+{
+  OpenSwath::LightProtein protein;
+  table.getProtein(1, protein);
+  TEST_EQUAL(protein.id, "prot_2")
+  TEST_EQUAL(protein.sequence, "PEPTIDEKPEPTIDER")
+}
+END_SECTION
+
+START_SECTION(View selectSwath(double lower, double upper, double min_upper_edge_dist) const)
+{
+  LightTransitionTable::View view = table.selectSwath(400.0, 505.0, 1.0);
+  TEST_EQUAL(view.begin, 0)
+  TEST_EQUAL(view.end, 4)
+  TEST_EQUAL(table.getNrPeptides(view), 2)
+
+  // too close to the upper edge
+  view = table.selectSwath(400.0, 500.5, 1.0);
+  TEST_EQUAL(view.size(), 2)
+  TEST_EQUAL(table.getTransitionName(view.begin), "pep_2_0")
+
+  // the lower edge is exclusive
+  view = table.selectSwath(500.0, 600.0, 1.0);
+  TEST_EQUAL(view.size(), 2)
+  TEST_EQUAL(table.getTransitionName(view.begin), "pep_1_0")
+
+  view = table.selectSwath(600.0, 700.0, 1.0);
+  TEST_EQUAL(view.empty(), true)
+
+  // same selection as OpenSwathHelper::selectSwathTransitions
+  for (double lower = 440.0; lower < 520.0; lower += 5.0)
+  {
+    Size expected = 0;
+    for (Size i = 0; i < exp.transitions.size(); ++i)
+    {
+      double mz = exp.transitions[i].precursor_mz;
+      if (lower < mz && mz < lower + 20.0 && std::fabs(lower + 20.0 - mz) >= 1.0) ++expected;
+    }
+    TEST_EQUAL(table.selectSwath(lower, lower + 20.0, 1.0).size(), expected)
+  }
+}
+END_SECTION
+
+START_SECTION(void splitIntoBatches(const View& view, Size batch_size, std::vector<View>& batches) const)
+{
+  std::vector<LightTransitionTable::View> batches;
+  table.splitIntoBatches(table.getAllRows(), 2, batches);
+  TEST_EQUAL(batches.size(), 2)
+  TEST_EQUAL(batches[0].begin, 0)
+  TEST_EQUAL(batches[0].end, 4)
+  TEST_EQUAL(batches[1].begin, 4)
+  TEST_EQUAL(batches[1].end, 6)
+
+  table.splitIntoBatches(table.getAllRows(), 1, batches);
+  TEST_EQUAL(batches.size(), 3)
+
+  table.splitIntoBatches(table.getAllRows(), 0, batches);
+  TEST_EQUAL(batches.size(), 1)
+  TEST_EQUAL(batches[0].size(), 6)
+
+  table.splitIntoBatches(LightTransitionTable::View(), 2, batches);
+  TEST_EQUAL(batches.size(), 0)
+}
+END_SECTION
+
+START_SECTION(void toLightTargetedExperiment(const View& view, OpenSwath::LightTargetedExperiment& targeted_exp) const)
+{
+  OpenSwath::LightTargetedExperiment batch_exp;
+  table.toLightTargetedExperiment(LightTransitionTable::View(2, 6), batch_exp);
+  TEST_EQUAL(batch_exp.transitions.size(), 4)
+  TEST_EQUAL(batch_exp.transitions[0].transition_name, "pep_0_0")
+  TEST_EQUAL(batch_exp.peptides.size(), 2)
+  TEST_EQUAL(batch_exp.peptides[0].id, "pep_0")
+  TEST_EQUAL(batch_exp.peptides[1].id, "pep_1")
+  TEST_EQUAL(batch_exp.proteins.size(), 1)
+  TEST_EQUAL(batch_exp.proteins[0].id, "prot_1")
+  TEST_EQUAL(batch_exp.getPeptideByRef("pep_1").modifications.size(), 1)
+
+  table.toLightTargetedExperiment(table.getAllRows(), batch_exp);
+  TEST_EQUAL(batch_exp.transitions.size(), 6)
+  TEST_EQUAL(batch_exp.peptides.size(), 3)
+  TEST_EQUAL(batch_exp.proteins.size(), 2)
+}
+END_SECTION
+
+START_SECTION(void store(const String& filename, const String& signature) const)
+{
+  NOT_TESTABLE // tested with "load"
+}
+END_SECTION
+
+START_SECTION(bool load(const String& filename, const String& signature))
+{
+  String filename;
+  NEW_TMP_FILE(filename);
+  LightTransitionTable loaded;
+  TEST_EQUAL(loaded.load(filename, "test"), false) // file doesn't exist
+
+  table.store(filename, "test");
+  TEST_EQUAL(loaded.load(filename, "other"), false)
+  TEST_EQUAL(loaded.size(), 0)
+  TEST_EQUAL(loaded.load(filename, "test"), true)
+  TEST_EQUAL(loaded.size(), 6)
+  TEST_EQUAL(loaded.getNrPeptides(), 3)
+  TEST_EQUAL(loaded.getNrProteins(), 2)
+  for (Size i = 0; i < table.size(); ++i)
+  {
+    TEST_EQUAL(loaded.getTransitionName(i), table.getTransitionName(i))
+    TEST_REAL_SIMILAR(loaded.getPrecursorMZ(i), table.getPrecursorMZ(i))
+  }
+
+  OpenSwath::LightTargetedExperiment batch_exp;
+  loaded.toLightTargetedExperiment(loaded.selectSwath(400.0, 505.0, 1.0), batch_exp);
+  TEST_EQUAL(batch_exp.transitions.size(), 4)
+  TEST_EQUAL(batch_exp.proteins.size(), 2)
+  TEST_EQUAL(batch_exp.transitions[3].site_identifying_class.size(), 0)
+}
+END_SECTION
+
+START_SECTION([EXTRA] bool load(const String& filename, const String& signature) with damaged cache files)
+{
+  const OpenSwath::LightTargetedExperiment test_exp = createTestExperiment();
+  std::vector<LightTransitionTableTest> damaged(8, LightTransitionTableTest(test_exp));
+  damaged[0].product_mz_.pop_back();
+  damaged[1].flags_.push_back(0);
+  damaged[2].peptide_[1] = 3;
+  damaged[3].transition_name_[0] = static_cast<UInt>(damaged[3].string_offsets_.size());
+  damaged[4].protein_refs_[0] = 1000;
+  damaged[5].site_transition_offsets_[1] = 2; // decreasing afterwards
+  damaged[6].string_offsets_[1] = damaged[6].string_offsets_[2] + 1;
+  std::swap(damaged[7].precursor_mz_[0], damaged[7].precursor_mz_[5]);
+
+  for (Size i = 0; i < damaged.size(); ++i)
+  {
+    String filename;
+    NEW_TMP_FILE(filename);
+    damaged[i].store(filename, "test");
+    LightTransitionTable loaded(test_exp);
+    TEST_EQUAL(loaded.load(filename, "test"), false)
+    TEST_EQUAL(loaded.size(), 0)
+    TEST_EQUAL(loaded.getNrPeptides(), 0)
+  }
+}
+END_SECTION
+
+START_SECTION([EXTRA] cached and uncached transition tables are identical)
+{
+  // same steps as OpenSwathWorkflow without a cache
+  TargetedExperiment traml;
+  TraMLFile().load(OPENMS_GET_TEST_DATA_PATH("OpenSwath_generic_input.TraML"), traml);
+  OpenSwath::LightTargetedExperiment light_exp;
+  OpenSwathDataAccessHelper::convertTargetedExp(traml, light_exp);
+  LightTransitionTable uncached(light_exp);
+  TEST_EQUAL(uncached.size(), light_exp.transitions.size())
+
+  String filename;
+  NEW_TMP_FILE(filename);
+  uncached.store(filename, "traml");
+  LightTransitionTable cached;
+  TEST_EQUAL(cached.load(filename, "traml"), true)
+  TEST_EQUAL(cached.size(), uncached.size())
+  TEST_EQUAL(cached.getNrPeptides(), uncached.getNrPeptides())
+  TEST_EQUAL(cached.getNrProteins(), uncached.getNrProteins())
+
+  OpenSwath::LightTargetedExperiment expected, result;
+  uncached.toLightTargetedExperiment(uncached.getAllRows(), expected);
+  cached.toLightTargetedExperiment(cached.getAllRows(), result);
+  TEST_EQUAL(result.transitions.size(), expected.transitions.size())
+  for (Size i = 0; i < std::min(result.transitions.size(), expected.transitions.size()); ++i)
+  {
+    const OpenSwath::LightTransition& tr = result.transitions[i];
+    const OpenSwath::LightTransition& ex = expected.transitions[i];
+    TEST_EQUAL(tr.transition_name, ex.transition_name)
+    TEST_EQUAL(tr.peptide_ref, ex.peptide_ref)
+    TEST_REAL_SIMILAR(tr.library_intensity, ex.library_intensity)
+    TEST_REAL_SIMILAR(tr.product_mz, ex.product_mz)
+    TEST_REAL_SIMILAR(tr.precursor_mz, ex.precursor_mz)
+    TEST_EQUAL(tr.charge, ex.charge)
+    TEST_EQUAL(tr.decoy, ex.decoy)
+    TEST_EQUAL(tr.detecting_transition, ex.detecting_transition)
+    TEST_EQUAL(tr.quantifying_transition, ex.quantifying_transition)
+    TEST_EQUAL(tr.identifying_transition, ex.identifying_transition)
+    TEST_EQUAL(tr.site_identifying_transition == ex.site_identifying_transition, true)
+    TEST_EQUAL(tr.site_identifying_class == ex.site_identifying_class, true)
+  }
+  TEST_EQUAL(result.peptides.size(), expected.peptides.size())
+  for (Size i = 0; i < std::min(result.peptides.size(), expected.peptides.size()); ++i)
+  {
+    const OpenSwath::LightPeptide& pep = result.peptides[i];
+    const OpenSwath::LightPeptide& ex = expected.peptides[i];
+    TEST_EQUAL(pep.id, ex.id)
+    TEST_REAL_SIMILAR(pep.rt, ex.rt)
+    TEST_EQUAL(pep.charge, ex.charge)
+    TEST_EQUAL(pep.sequence, ex.sequence)
+    TEST_EQUAL(pep.peptide_group_label, ex.peptide_group_label)
+    TEST_EQUAL(pep.protein_refs == ex.protein_refs, true)
+    TEST_EQUAL(pep.modifications.size(), ex.modifications.size())
+    for (Size k = 0; k < std::min(pep.modifications.size(), ex.modifications.size()); ++k)
+    {
+      TEST_EQUAL(pep.modifications[k].location, ex.modifications[k].location)
+      TEST_EQUAL(pep.modifications[k].unimod_id, ex.modifications[k].unimod_id)
+    }
+  }
+  TEST_EQUAL(result.proteins.size(), expected.proteins.size())
+  for (Size i = 0; i < std::min(result.proteins.size(), expected.proteins.size()); ++i)
+  {
+    TEST_EQUAL(result.proteins[i].id, expected.proteins[i].id)
+    TEST_EQUAL(result.proteins[i].sequence, expected.proteins[i].sequence)
+  }
+}
+END_SECTION
+
+START_SECTION([LightTransitionTable::View] Size size() const)
+{
+  TEST_EQUAL(LightTransitionTable::View(2, 5).size(), 3)
+  TEST_EQUAL(LightTransitionTable::View(2, 5).empty(), false)
+  TEST_EQUAL(LightTransitionTable::View().empty(), true)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
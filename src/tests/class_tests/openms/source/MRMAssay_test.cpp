@@ -53,7 +53,7 @@ MRMAssay* nullPointer = 0;
 class MRMAssay_test : public MRMAssay
 {
   public:
-    bool isUIS_test(const double fragment_ion, std::vector<double> ions, const double mz_threshold)
+    bool isUIS_test(const double fragment_ion, const std::vector<double>& ions, const double mz_threshold)
     {
       return isUIS_(fragment_ion, ions, mz_threshold);
     }
@@ -96,7 +96,7 @@ START_SECTION(~MRMAssay())
 }
 END_SECTION
 
-START_SECTION(bool MRMAssay::isUIS_(const double fragment_ion, std::vector<double> ions, const double mz_threshold); )
+START_SECTION(bool MRMAssay::isUIS_(const double fragment_ion, const std::vector<double>& ions, const double mz_threshold); )
 {
   MRMAssay_test mrma;
 
@@ -529,6 +529,91 @@ START_SECTION((extra))
   }
 }
 END_SECTION
+
+START_SECTION((void getFragmentIndex(const IonSeries& ionseries, bool enable_losses, FragmentIndex& index)))
+{
+  MRMDecoy gen;
+  AASequence peptide = AASequence::fromString("KVGLDPSQLPVGENGIV");
+  MRMDecoy::IonSeries ionseries = gen.getIonSeries(peptide, 2);
+
+  MRMDecoy::FragmentIndex index;
+  gen.getFragmentIndex(ionseries, false, index);
+  TEST_EQUAL(index.size(), ionseries["b"].size() + ionseries["y"].size())
+  gen.getFragmentIndex(ionseries, true, index);
+  TEST_EQUAL(index.size(), ionseries["b"].size() + ionseries["y"].size() + ionseries["b_loss"].size() + ionseries["y_loss"].size())
+
+  bool sorted = true;
+  for (Size i = 1; i < index.size(); ++i)
+  {
+    if (index[i].mz < index[i - 1].mz) sorted = false;
+  }
+  TEST_EQUAL(sorted, true)
+}
+END_SECTION
+
+START_SECTION((std::pair<String, double> getTargetIon(double ProductMZ, double mz_threshold, const FragmentIndex& target_index)))
+{
+  MRMDecoy gen;
+  AASequence peptide = AASequence::fromString("AAAAAAAAAPAAAATAPTTAATTAATAAQ");
+  MRMDecoy::IonSeries ionseries = gen.getIonSeries(peptide, 3);
+  MRMDecoy::FragmentIndex index;
+  gen.getFragmentIndex(ionseries, true, index);
+
+  TEST_EQUAL(gen.getTargetIon(510.2660, 0.05, index).first, "b20-35^3")
+  TEST_EQUAL(gen.getTargetIon(678.3557, 0.05, index).first, "b18-36^2")
+  TEST_EQUAL(gen.getTargetIon(10.0, 0.05, index).first, "unannotated")
+  TEST_REAL_SIMILAR(gen.getTargetIon(10.0, 0.05, index).second, -1)
+
+  // same result as the search on the ion series
+  for (MRMDecoy::FragmentIndex::const_iterator it = index.begin(); it != index.end(); ++it)
+  {
+    TEST_REAL_SIMILAR(gen.getTargetIon(it->mz + 0.01, 0.05, index).second, gen.getTargetIon(it->mz + 0.01, 0.05, ionseries, true).second)
+  }
+}
+END_SECTION
+
+START_SECTION(void correctMasses(OpenMS::TargetedExperiment& exp, double mz_threshold, bool enable_losses))
+{
+  MRMDecoy gen;
+  AASequence sequence = AASequence::fromString("PEPTIDEK");
+  MRMDecoy::FragmentIndex index;
+  gen.getFragmentIndex(gen.getIonSeries(sequence, 2), false, index);
+
+  std::vector<TargetedExperiment::Peptide> peptides;
+  std::vector<ReactionMonitoringTransition> transitions;
+  for (Size i = 0; i < 3; ++i)
+  {
+    TargetedExperiment::Peptide peptide;
+    peptide.id = String("pep") + i;
+    peptide.sequence = "PEPTIDEK";
+    peptide.setChargeState(2);
+    peptides.push_back(peptide);
+
+    ReactionMonitoringTransition tr;
+    tr.setNativeID(String("tr") + i);
+    tr.setPeptideRef(peptide.id);
+    tr.setProductMZ(index[i].mz + 0.01);
+    transitions.push_back(tr);
+  }
+
+  TargetedExperiment exp;
+  exp.setPeptides(peptides);
+  exp.setTransitions(transitions);
+  gen.correctMasses(exp, 0.05, false);
+  TEST_EQUAL(exp.getTransitions().size(), 3)
+  for (Size i = 0; i < exp.getTransitions().size(); ++i)
+  {
+    TEST_REAL_SIMILAR(exp.getTransitions()[i].getProductMZ(), index[i].mz)
+  }
+
+  // an unmappable fragment ion is reported as before, the input stays unchanged
+  transitions[1].setProductMZ(10.0);
+  transitions[2].setProductMZ(10.0);
+  exp.setTransitions(transitions);
+  TEST_EXCEPTION(Exception::IllegalArgument, gen.correctMasses(exp, 0.05, false))
+  TEST_REAL_SIMILAR(exp.getTransitions()[0].getProductMZ(), index[0].mz + 0.01)
+}
+END_SECTION
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
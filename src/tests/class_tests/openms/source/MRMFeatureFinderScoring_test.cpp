@@ -43,6 +43,10 @@
 ///////////////////////////
 #include <OpenMS/ANALYSIS/OPENSWATH/MRMFeatureFinderScoring.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 ///////////////////////////
 
 using namespace OpenMS;
@@ -164,6 +168,84 @@ START_SECTION(void pickExperiment(OpenSwath::SpectrumAccessPtr input, FeatureMap
 
 }
 END_SECTION
+
+START_SECTION([EXTRA] pickExperiment with one and several threads)
+{
+  // replicate the two transition groups of the test data, so the groups are
+  // picked by several threads
+  PeakMap input_exp;
+  OpenSwath::LightTargetedExperiment input_transitions;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("OpenSwath_generic_input.mzML"), input_exp);
+  {
+    TargetedExperiment transition_exp_;
+    TraMLFile().load(OPENMS_GET_TEST_DATA_PATH("OpenSwath_generic_input.TraML"), transition_exp_);
+    OpenSwathDataAccessHelper::convertTargetedExp(transition_exp_, input_transitions);
+  }
+
+  boost::shared_ptr<PeakMap> exp (new PeakMap);
+  OpenSwath::LightTargetedExperiment transitions;
+  transitions.proteins = input_transitions.proteins;
+  std::vector<MSChromatogram<> > chromatograms;
+  for (Size copy = 0; copy < 20; ++copy)
+  {
+    String suffix = String("_") + copy;
+    for (Size i = 0; i < input_exp.getChromatograms().size(); ++i)
+    {
+      chromatograms.push_back(input_exp.getChromatograms()[i]);
+      chromatograms.back().setNativeID(chromatograms.back().getNativeID() + suffix);
+    }
+    for (Size i = 0; i < input_transitions.transitions.size(); ++i)
+    {
+      transitions.transitions.push_back(input_transitions.transitions[i]);
+      transitions.transitions.back().transition_name += suffix;
+      transitions.transitions.back().peptide_ref += suffix;
+    }
+    for (Size i = 0; i < input_transitions.peptides.size(); ++i)
+    {
+      transitions.peptides.push_back(input_transitions.peptides[i]);
+      transitions.peptides.back().id += suffix;
+    }
+  }
+  exp->setChromatograms(chromatograms);
+
+  TransformationDescription trafo;
+  boost::shared_ptr<PeakMap> swath_map (new PeakMap);
+  OpenSwath::SpectrumAccessPtr swath_ptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(swath_map);
+  OpenSwath::SpectrumAccessPtr chromatogram_ptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(exp);
+
+  FeatureMap features;
+  TransitionGroupMapType transition_group_map;
+  MRMFeatureFinderScoring ff;
+  ff.pickExperiment(chromatogram_ptr, features, transitions, trafo, swath_ptr, transition_group_map);
+  TEST_EQUAL(transition_group_map.size(), 40)
+  TEST_EQUAL(features.size(), 60)
+
+#ifdef _OPENMP
+  int threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+  FeatureMap features_serial;
+  TransitionGroupMapType transition_group_map_serial;
+  MRMFeatureFinderScoring ff_serial;
+  ff_serial.pickExperiment(chromatogram_ptr, features_serial, transitions, trafo, swath_ptr, transition_group_map_serial);
+#ifdef _OPENMP
+  omp_set_num_threads(threads);
+#endif
+
+  // same features in the same order
+  ABORT_IF(features_serial.size() != features.size())
+  for (Size i = 0; i < features.size(); ++i)
+  {
+    TEST_EQUAL(features_serial[i].getMetaValue("PeptideRef"), features[i].getMetaValue("PeptideRef"))
+    TEST_REAL_SIMILAR(features_serial[i].getRT(), features[i].getRT())
+    TEST_REAL_SIMILAR(features_serial[i].getIntensity(), features[i].getIntensity())
+    TEST_REAL_SIMILAR(features_serial[i].getMetaValue("leftWidth"), features[i].getMetaValue("leftWidth"))
+    TEST_REAL_SIMILAR(features_serial[i].getMetaValue("rightWidth"), features[i].getMetaValue("rightWidth"))
+    TEST_REAL_SIMILAR(features_serial[i].getMetaValue("var_xcorr_shape"), features[i].getMetaValue("var_xcorr_shape"))
+    TEST_REAL_SIMILAR(features_serial[i].getMetaValue("var_xcorr_coelution"), features[i].getMetaValue("var_xcorr_coelution"))
+  }
+}
+END_SECTION
     
 START_SECTION(void mapExperimentToTransitionList(OpenSwath::SpectrumAccessPtr input, OpenSwath::LightTargetedExperiment &transition_exp, TransitionGroupMapType &transition_group_map, TransformationDescription trafo, double rt_extraction_window))
 {
@@ -248,6 +248,82 @@ START_SECTION((static std::vector<std::pair<double, double> > removeOutliersIter
 }
 END_SECTION
 
+START_SECTION((static void removeOutliersIterative(const std::vector<std::pair<double, double> >& pairs, double rsq_limit, double coverage_limit, bool use_chauvenet, const std::string& method, OutlierRemovalResult& result)))
+{
+  static const double arrx3[] = { 1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,1,21,22,23,24,25,26,27,28,29,30 };
+  static const double arry3[] = { 1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,1,22,23,24,25,26,27,28,29,30 };
+
+  std::vector<std::pair<double, double> > input3;
+  for (Size i = 0; i < sizeof(arrx3) / sizeof(arrx3[0]); i++)
+  {
+    input3.push_back(std::make_pair(arrx3[i], arry3[i]));
+  }
+
+  // same result as the version above, plus the fit and the removal trace
+  MRMRTNormalizer::OutlierRemovalResult result;
+  MRMRTNormalizer::removeOutliersIterative(input3, 0.9, 0.2, true, "iter_jackknife", result);
+  TEST_EQUAL(result.pairs == MRMRTNormalizer::removeOutliersIterative(input3, 0.9, 0.2, true, "iter_jackknife"), true)
+  TEST_EQUAL(result.pairs.size(), 28)
+  TEST_EQUAL(result.rsq_limit_reached, true)
+  TEST_EQUAL(result.rsq >= 0.9, true)
+  TEST_REAL_SIMILAR(result.intercept, 0.0)
+  TEST_REAL_SIMILAR(result.slope, 1.0)
+  TEST_REAL_SIMILAR(result.rsq, 1.0)
+  ABORT_IF(result.removed.size() != 2)
+  TEST_EQUAL(result.removed_rsq.size(), 2)
+  TEST_EQUAL(result.removed[0] == 19 || result.removed[0] == 20, true)
+  TEST_EQUAL(result.removed[1] == 19 || result.removed[1] == 20, true)
+  TEST_NOT_EQUAL(result.removed[0], result.removed[1])
+  TEST_EQUAL(result.removed_rsq[0] < result.removed_rsq[1], true)
+  TEST_EQUAL(result.removed_rsq[1] < 0.9, true)
+
+  // R^2 limit not reachable: reported instead of thrown
+  MRMRTNormalizer::removeOutliersIterative(input3, 1.1, 0.9, false, "iter_residual", result);
+  TEST_EQUAL(result.rsq_limit_reached, false)
+  TEST_EQUAL(result.rsq < 1.1, true)
+  TEST_EQUAL(result.removed.size(), result.removed_rsq.size())
+  TEST_EXCEPTION(Exception::UnableToFit, MRMRTNormalizer::removeOutliersIterative(input3, 1.1, 0.9, false, "iter_residual"))
+
+  TEST_EXCEPTION(Exception::IllegalArgument, MRMRTNormalizer::removeOutliersIterative(input3, 0.9, 0.2, true, "iter_unknown", result))
+  std::vector<std::pair<double, double> > single(1, std::make_pair(1.0, 1.0));
+  TEST_EXCEPTION(Exception::IllegalArgument, MRMRTNormalizer::removeOutliersIterative(single, 0.9, 0.2, true, "iter_residual", result))
+}
+END_SECTION
+
+START_SECTION([EXTRA] static std::vector<std::pair<double, double> > ransac(std::vector<std::pair<double, double> >& pairs, size_t n, size_t k, double t, size_t d, bool test))
+{
+  // a line with small deviations and every tenth point far off
+  std::vector<std::pair<double, double> > input;
+  for (Size i = 0; i < 200; i++)
+  {
+    double x = 10.0 * i;
+    double y = 2.0 * x + 5.0 + ((i * 7) % 10) / 10.0;
+    if (i % 10 == 0) y += 300.0;
+    input.push_back(std::make_pair(x, y));
+  }
+
+  std::vector<std::pair<double, double> > output = MRMRTNormalizer::ransac(input, 10, 200, 4.0, 100);
+  TEST_EQUAL(output.size(), 180)
+  for (Size i = 0; i < output.size(); i++)
+  {
+    TEST_EQUAL(output[i].second - 2.0 * output[i].first < 100.0, true)
+  }
+
+  // each iteration is seeded deterministically: same result in every run
+  TEST_EQUAL(output == MRMRTNormalizer::ransac(input, 10, 200, 4.0, 100), true)
+
+  TEST_EXCEPTION(Exception::IllegalArgument, MRMRTNormalizer::ransac(input, 201, 200, 4.0, 100))
+
+  // no line can be fitted through points with identical x: the error keeps its type
+  std::vector<std::pair<double, double> > vertical;
+  for (Size i = 0; i < 50; i++)
+  {
+    vertical.push_back(std::make_pair(10.0, double(i)));
+  }
+  TEST_EXCEPTION(Exception::UnableToFit, MRMRTNormalizer::ransac(vertical, 10, 20, 4.0, 5))
+}
+END_SECTION
+
 START_SECTION(( static double chauvenet_probability(std::vector< double > &residuals, int pos) ))
 {
 
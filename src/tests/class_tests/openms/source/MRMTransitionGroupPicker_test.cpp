@@ -128,6 +128,96 @@ sum(datapoints[3:10])
   }
 }
 
+// exposes the protected quality computation
+class MRMTransitionGroupPickerTest :
+  public MRMTransitionGroupPicker
+{
+public:
+  template <typename SpectrumT, typename TransitionT>
+  double computeQuality(MRMTransitionGroup<SpectrumT, TransitionT>& transition_group,
+                        std::vector<SpectrumT>& picked_chroms, const int chr_idx,
+                        const double best_left, const double best_right, String& outlier)
+  {
+    return computeQuality_(transition_group, picked_chroms, chr_idx, best_left, best_right, outlier);
+  }
+
+  // the shape and co-elution scores of computeQuality_, computed with the
+  // (map based) normalizedCrossCorrelation for both directions of every pair
+  void referenceScores(MRMTransitionGroupType& transition_group, const int chr_idx,
+                       const double best_left, const double best_right,
+                       double& shape_score, double& coel_score)
+  {
+    RichPeakChromatogram master_peak_container;
+    prepareMasterContainer_(transition_group.getChromatograms()[chr_idx], master_peak_container, best_left - 15.0, best_right + 15.0);
+    std::vector<std::vector<double> > all_ints;
+    for (Size k = 0; k < transition_group.getChromatograms().size(); k++)
+    {
+      RichPeakChromatogram resampled = resampleChromatogram_(transition_group.getChromatograms()[k],
+          master_peak_container, best_left - 15.0, best_right + 15.0);
+      all_ints.push_back(std::vector<double>());
+      for (Size i = 0; i < resampled.size(); i++)
+      {
+        all_ints.back().push_back(resampled[i].getIntensity());
+      }
+    }
+
+    shape_score = 0.0;
+    coel_score = 0.0;
+    for (Size k = 0; k < all_ints.size(); k++)
+    {
+      double shapes = 0.0, coel = 0.0;
+      for (Size i = 0; i < all_ints.size(); i++)
+      {
+        if (i == k) continue;
+        std::vector<double> data1 = all_ints[k], data2 = all_ints[i];
+        OpenSwath::Scoring::XCorrArrayType res = OpenSwath::Scoring::normalizedCrossCorrelation(data1, data2, (int)data2.size(), 1);
+        shapes += std::abs(OpenSwath::Scoring::xcorrArrayGetMaxPeak(res)->second);
+        coel += std::abs(OpenSwath::Scoring::xcorrArrayGetMaxPeak(res)->first);
+      }
+      shape_score += shapes / (all_ints.size() - 1);
+      coel_score += coel / (all_ints.size() - 1);
+    }
+    shape_score /= all_ints.size();
+    coel_score /= all_ints.size();
+    coel_score = (coel_score - 1.0) / 2.0;
+  }
+};
+
+// three transitions with a Gaussian peak at RT 50 on the same RT grid, the
+// last one shifted by `shift` seconds; one picked peak per chromatogram
+void setup_quality_group(MRMTransitionGroupType& transition_group, std::vector<RichPeakChromatogram>& picked_chroms, double shift)
+{
+  for (Size k = 0; k < 3; k++)
+  {
+    double center = (k == 2 ? 50.0 + shift : 50.0);
+    RichPeakChromatogram chromatogram;
+    for (Size i = 0; i <= 100; i++)
+    {
+      ChromatogramPeak peak;
+      peak.setMZ(i);
+      peak.setIntensity(1000.0 * std::exp(-0.5 * (i - center) * (i - center) / 25.0) + 1.0);
+      chromatogram.push_back(peak);
+    }
+    chromatogram.setNativeID(String(k));
+    transition_group.addChromatogram(chromatogram, chromatogram.getNativeID());
+
+    ReactionMonitoringTransition transition;
+    transition.setNativeID(String(k));
+    transition_group.addTransition(transition, transition.getNativeID());
+
+    RichPeakChromatogram picked_chrom;
+    ChromatogramPeak peak;
+    peak.setMZ(center);
+    peak.setIntensity(1000.0);
+    picked_chrom.push_back(peak);
+    picked_chrom.getFloatDataArrays().resize(3);
+    picked_chrom.getFloatDataArrays()[0].push_back(10000.0);
+    picked_chrom.getFloatDataArrays()[1].push_back(center - 5.0);
+    picked_chrom.getFloatDataArrays()[2].push_back(center + 5.0);
+    picked_chroms.push_back(picked_chrom);
+  }
+}
+
 START_TEST(MRMTransitionGroupPicker, "$Id$")
 
 /////////////////////////////////////////////////////////////
@@ -207,6 +297,7 @@ START_SECTION((template < typename SpectrumT, typename TransitionT > void pickTr
   TEST_REAL_SIMILAR(mrmfeature.getPrecursorFeature("Precursor_i0").getIntensity(),
   // mrmfeature.getMS1Feature().getIntensity(), 53900 - resampling_loss);
   53900 - resampling_loss);
+
 }
 END_SECTION
 
@@ -431,6 +522,39 @@ START_SECTION((template < typename SpectrumT > void remove_overlapping_features(
 }
 END_SECTION
 
+START_SECTION([EXTRA] computeQuality_)
+{
+  MRMTransitionGroupPickerTest picker;
+  String outlier;
+
+  // identical traces: perfect shape (1) and co-elution (0), no missing peaks
+  {
+    MRMTransitionGroupType transition_group;
+    std::vector<RichPeakChromatogram> picked_chroms;
+    setup_quality_group(transition_group, picked_chroms, 0.0);
+    TEST_REAL_SIMILAR(picker.computeQuality(transition_group, picked_chroms, 0, 45.0, 55.0, outlier), 1.5)
+    TEST_EQUAL(outlier, "0")
+
+    // a chromatogram without a peak between the borders is penalized
+    picked_chroms[1][0].setMZ(80.0);
+    TEST_REAL_SIMILAR(picker.computeQuality(transition_group, picked_chroms, 0, 45.0, 55.0, outlier), 1.5 - 1.0 / 3)
+  }
+
+  // the shifted trace is the outlier, scores as with the pairwise cross-correlation
+  {
+    MRMTransitionGroupType transition_group;
+    std::vector<RichPeakChromatogram> picked_chroms;
+    setup_quality_group(transition_group, picked_chroms, 3.0);
+    double shape_score, coel_score;
+    picker.referenceScores(transition_group, 0, 45.0, 55.0, shape_score, coel_score);
+    TEST_EQUAL(shape_score < 1.0, true)
+    TEST_EQUAL(coel_score > -0.5, true) // co-eluting traces give -0.5
+    TEST_REAL_SIMILAR(picker.computeQuality(transition_group, picked_chroms, 0, 45.0, 55.0, outlier), shape_score - coel_score)
+    TEST_EQUAL(outlier, "2")
+  }
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
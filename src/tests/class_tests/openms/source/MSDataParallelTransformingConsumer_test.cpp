@@ -0,0 +1,243 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+
+#include <OpenMS/FORMAT/DATAACCESS/MSDataParallelTransformingConsumer.h>
+#include <OpenMS/FORMAT/DATAACCESS/MSDataChainingConsumer.h>
+#include <OpenMS/FORMAT/DATAACCESS/NoopMSDataConsumer.h>
+
+///////////////////////////
+
+#include <OpenMS/FORMAT/MzMLFile.h>
+
+using namespace OpenMS;
+
+class SortTransformation :
+  public MSDataParallelTransformingConsumer::Transformation
+{
+public:
+  void transformSpectrum(MSSpectrum<Peak1D> & s) const
+  {
+    if (s.getNativeID() == "fail") throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__, "cannot transform");
+    if (s.getNativeID() == "fail later") throw Exception::InvalidValue(__FILE__, __LINE__, __PRETTY_FUNCTION__, "cannot transform", s.getNativeID());
+    s.sortByIntensity();
+  }
+
+  void transformChromatogram(MSChromatogram<ChromatogramPeak> & c) const
+  {
+    c.sortByIntensity();
+  }
+};
+
+// stores everything it consumes
+class CollectingConsumer :
+  public Interfaces::IMSDataConsumer<>
+{
+public:
+  void consumeSpectrum(SpectrumType & s) { spectra.push_back(s); order.push_back('s'); }
+  void consumeChromatogram(ChromatogramType & c) { chromatograms.push_back(c); order.push_back('c'); }
+  void setExpectedSize(Size s, Size c) { expected_spectra = s; expected_chromatograms = c; }
+  void setExperimentalSettings(const ExperimentalSettings &) {}
+
+  std::vector<SpectrumType> spectra;
+  std::vector<ChromatogramType> chromatograms;
+  String order;
+  Size expected_spectra, expected_chromatograms;
+};
+
+// fails to consume spectra until 'fail' is reset
+class ThrowingConsumer :
+  public CollectingConsumer
+{
+public:
+  ThrowingConsumer() : fail(true) {}
+  void consumeSpectrum(SpectrumType & s)
+  {
+    if (fail) throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__, "cannot consume");
+    CollectingConsumer::consumeSpectrum(s);
+  }
+
+  bool fail;
+};
+
+START_TEST(MSDataParallelTransformingConsumer, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+SortTransformation transformation;
+NoopMSDataConsumer noop;
+
+MSDataParallelTransformingConsumer* ptr = 0;
+MSDataParallelTransformingConsumer* null_ptr = 0;
+
+START_SECTION((MSDataParallelTransformingConsumer(const Transformation & transformation, Interfaces::IMSDataConsumer<> * next, Size window_size = 100)))
+  ptr = new MSDataParallelTransformingConsumer(transformation, &noop);
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->getWindowSize(), 100)
+END_SECTION
+
+START_SECTION((virtual ~MSDataParallelTransformingConsumer()))
+  delete ptr;
+END_SECTION
+
+START_SECTION((Size getWindowSize() const))
+  MSDataParallelTransformingConsumer consumer(transformation, &noop, 7);
+  TEST_EQUAL(consumer.getWindowSize(), 7)
+  MSDataParallelTransformingConsumer consumer2(transformation, &noop, 0);
+  TEST_EQUAL(consumer2.getWindowSize(), 1)
+END_SECTION
+
+START_SECTION((virtual void setExpectedSize(Size expectedSpectra, Size expectedChromatograms)))
+  CollectingConsumer collector;
+  MSDataParallelTransformingConsumer consumer(transformation, &collector);
+  consumer.setExpectedSize(3, 4);
+  TEST_EQUAL(collector.expected_spectra, 3)
+  TEST_EQUAL(collector.expected_chromatograms, 4)
+END_SECTION
+
+START_SECTION((virtual void setExperimentalSettings(const ExperimentalSettings & exp)))
+  NOT_TESTABLE // only passed on
+END_SECTION
+
+START_SECTION((virtual void consumeSpectrum(SpectrumType & s)))
+{
+  MSExperiment<> exp;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+  TEST_EQUAL(exp.size() > 2, true)
+
+  CollectingConsumer collector;
+  MSDataParallelTransformingConsumer consumer(transformation, &collector, 2);
+  for (Size i = 0; i < exp.size(); ++i)
+  {
+    consumer.consumeSpectrum(exp[i]);
+    TEST_EQUAL(exp[i].isSorted(), true) // input is not modified
+  }
+  // only full windows are passed on
+  TEST_EQUAL(collector.spectra.size(), exp.size() - exp.size() % 2)
+  consumer.flush();
+  ABORT_IF(collector.spectra.size() != exp.size())
+  // transformed and in the original order
+  for (Size i = 0; i < exp.size(); ++i)
+  {
+    MSSpectrum<> sorted = exp[i];
+    sorted.sortByIntensity();
+    TEST_EQUAL(collector.spectra[i].getNativeID(), exp[i].getNativeID())
+    TEST_EQUAL(collector.spectra[i] == sorted, true)
+  }
+
+  // errors are passed on with their type
+  MSSpectrum<> failing;
+  failing.setNativeID("fail");
+  TEST_EXCEPTION(Exception::IllegalArgument, consumer.consumeSpectrum(failing); consumer.flush())
+
+  // the error of the first failing spectrum of a window (size 2) is reported, independent of the scheduling
+  MSSpectrum<> failing_later;
+  failing_later.setNativeID("fail later");
+  TEST_EXCEPTION(Exception::IllegalArgument, consumer.consumeSpectrum(failing); consumer.consumeSpectrum(failing_later))
+  TEST_EXCEPTION(Exception::InvalidValue, consumer.consumeSpectrum(failing_later); consumer.consumeSpectrum(failing))
+
+  // a window which the next consumer fails on is dropped, not passed on again
+  ThrowingConsumer thrower;
+  MSDataParallelTransformingConsumer throwing_consumer(transformation, &thrower, 2);
+  throwing_consumer.consumeSpectrum(exp[0]);
+  TEST_EXCEPTION(Exception::IllegalArgument, throwing_consumer.consumeSpectrum(exp[1]))
+  thrower.fail = false;
+  throwing_consumer.flush();
+  TEST_EQUAL(thrower.spectra.size(), 0)
+  throwing_consumer.consumeSpectrum(exp[2]);
+  throwing_consumer.flush();
+  TEST_EQUAL(thrower.spectra.size(), 1)
+}
+END_SECTION
+
+START_SECTION((virtual void consumeChromatogram(ChromatogramType & c)))
+{
+  MSExperiment<> exp;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+  TEST_EQUAL(exp.getChromatograms().size() > 0, true)
+
+  CollectingConsumer collector;
+  {
+    MSDataParallelTransformingConsumer consumer(transformation, &collector, 10);
+    consumer.consumeSpectrum(exp[0]);
+    consumer.consumeChromatogram(exp.getChromatograms()[0]);
+    consumer.consumeSpectrum(exp[1]);
+    // the consumed order is kept
+    TEST_EQUAL(collector.order, "sc")
+  } // flushed by the destructor
+  TEST_EQUAL(collector.order, "scs")
+  MSChromatogram<> sorted = exp.getChromatograms()[0];
+  sorted.sortByIntensity();
+  TEST_EQUAL(collector.chromatograms[0] == sorted, true)
+}
+END_SECTION
+
+START_SECTION((void flush()))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(([EXTRA] usage in a MSDataChainingConsumer))
+{
+  MSExperiment<> exp;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+
+  CollectingConsumer collector;
+  MSDataParallelTransformingConsumer parallel_consumer(transformation, &collector, 3);
+  std::vector<Interfaces::IMSDataConsumer<> *> consumer_list;
+  consumer_list.push_back(new NoopMSDataConsumer());
+  consumer_list.push_back(&parallel_consumer);
+  MSDataChainingConsumer chaining_consumer(consumer_list);
+
+  for (Size i = 0; i < exp.size(); ++i)
+  {
+    chaining_consumer.consumeSpectrum(exp[i]);
+  }
+  parallel_consumer.flush();
+  TEST_EQUAL(collector.spectra.size(), exp.size())
+  TEST_EQUAL(collector.spectra.back().getNativeID(), exp.back().getNativeID())
+
+  delete consumer_list[0];
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -50,7 +50,9 @@ MSDataWritingConsumer* ptr = 0;
 MSDataWritingConsumer* null_ptr = 0;
 START_SECTION(MSDataWritingConsumer())
 {
-	ptr = new MSDataWritingConsumer();
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+	ptr = new PlainMSDataWritingConsumer(tmp_filename);
 	TEST_NOT_EQUAL(ptr, null_ptr)
 }
 END_SECTION
@@ -115,6 +117,96 @@ START_SECTION((virtual Size getNrChromatogramsWritten()))
 }
 END_SECTION
 
+START_SECTION((void setWritingWindow(Size window_size)))
+{
+  // write sequentially ...
+  std::string sequential_filename;
+  NEW_TMP_FILE(sequential_filename);
+  {
+    PlainMSDataWritingConsumer consumer(sequential_filename);
+    MzMLFile().transform(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), &consumer);
+  }
+
+  // ... and with windows smaller and larger than the number of spectra
+  std::string parallel_filename;
+  NEW_TMP_FILE(parallel_filename);
+  {
+    PlainMSDataWritingConsumer consumer(parallel_filename);
+    consumer.setWritingWindow(2);
+    MzMLFile().transform(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), &consumer);
+    TEST_EQUAL(consumer.getNrSpectraWritten(), 4)
+    TEST_EQUAL(consumer.getNrChromatogramsWritten(), 2)
+  }
+  TEST_FILE_EQUAL(parallel_filename.c_str(), sequential_filename.c_str())
+
+  NEW_TMP_FILE(parallel_filename);
+  {
+    PlainMSDataWritingConsumer consumer(parallel_filename);
+    consumer.setWritingWindow(100);
+    MzMLFile().transform(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), &consumer);
+  }
+  TEST_FILE_EQUAL(parallel_filename.c_str(), sequential_filename.c_str())
+}
+END_SECTION
+
+START_SECTION((void flush()))
+{
+  MSExperiment<> exp;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+
+  std::string sequential_filename;
+  NEW_TMP_FILE(sequential_filename);
+  {
+    PlainMSDataWritingConsumer consumer(sequential_filename);
+    consumer.setExpectedSize(exp.size(), exp.getChromatograms().size());
+    consumer.setExperimentalSettings(exp);
+    for (Size i = 0; i < exp.size(); ++i)
+    {
+      consumer.consumeSpectrum(exp[i]);
+    }
+    consumer.flush(); // nothing pending
+    for (Size i = 0; i < exp.getChromatograms().size(); ++i)
+    {
+      consumer.consumeChromatogram(exp.getChromatogram(i));
+    }
+  }
+
+  std::string parallel_filename;
+  NEW_TMP_FILE(parallel_filename);
+  {
+    PlainMSDataWritingConsumer consumer(parallel_filename);
+    consumer.setExpectedSize(exp.size(), exp.getChromatograms().size());
+    consumer.setExperimentalSettings(exp);
+    consumer.setWritingWindow(100);
+    for (Size i = 0; i < exp.size(); ++i)
+    {
+      consumer.consumeSpectrum(exp[i]);
+    }
+    consumer.flush();
+    TEST_EQUAL(consumer.getNrSpectraWritten(), 4)
+    consumer.flush(); // nothing pending anymore
+    for (Size i = 0; i < exp.getChromatograms().size(); ++i)
+    {
+      consumer.consumeChromatogram(exp.getChromatogram(i));
+    }
+  }
+  TEST_FILE_EQUAL(parallel_filename.c_str(), sequential_filename.c_str())
+}
+END_SECTION
+
+START_SECTION((Size getWritingWindow() const))
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  PlainMSDataWritingConsumer consumer(tmp_filename);
+  TEST_EQUAL(consumer.getWritingWindow(), 1)
+  consumer.setWritingWindow(8);
+  TEST_EQUAL(consumer.getWritingWindow(), 8)
+  consumer.setWritingWindow(0);
+  TEST_EQUAL(consumer.getWritingWindow(), 1)
+}
+END_SECTION
+
 
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
@@ -0,0 +1,175 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+
+#include <OpenMS/FORMAT/MappedFASTAFile.h>
+
+using namespace OpenMS;
+using namespace std;
+
+///////////////////////////
+
+START_TEST(MappedFASTAFile, "$Id$")
+
+/////////////////////////////////////////////////////////////
+
+MappedFASTAFile* ptr = 0;
+MappedFASTAFile* null_ptr = 0;
+START_SECTION((MappedFASTAFile()))
+  ptr = new MappedFASTAFile();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->isOpen(), false)
+END_SECTION
+
+START_SECTION((~MappedFASTAFile()))
+  delete ptr;
+END_SECTION
+
+START_SECTION((void open(const String& filename)))
+  MappedFASTAFile file;
+  TEST_EXCEPTION(Exception::FileNotFound, file.open("MappedFASTAFile_test_this_file_does_not_exist"))
+  TEST_EQUAL(file.isOpen(), false)
+  file.open(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  TEST_EQUAL(file.isOpen(), true)
+  TEST_EQUAL(file.getPosition(), 0)
+END_SECTION
+
+START_SECTION((void close()))
+  MappedFASTAFile file;
+  file.open(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  file.close();
+  TEST_EQUAL(file.isOpen(), false)
+  TEST_EQUAL(file.getFileSize(), 0)
+  MappedFASTAFile::Entry entry;
+  TEST_EQUAL(file.readNext(entry), false)
+END_SECTION
+
+START_SECTION((bool isOpen() const))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION((bool readNext(Entry& entry)))
+  // must give the same result as FASTAFile::load()
+  vector<FASTAFile::FASTAEntry> data;
+  FASTAFile().load(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"), data);
+
+  MappedFASTAFile file;
+  file.open(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  MappedFASTAFile::Entry entry;
+  Size count = 0;
+  while (file.readNext(entry))
+  {
+    ABORT_IF(count >= data.size())
+    TEST_EQUAL(entry.toFASTAEntry() == data[count], true)
+    ++count;
+  }
+  TEST_EQUAL(count, data.size())
+  TEST_EQUAL(count, 5)
+  TEST_EQUAL(file.getPosition(), file.getFileSize())
+  TEST_EQUAL(file.readNext(entry), false)
+
+  // content before the first entry:
+  MappedFASTAFile invalid;
+  invalid.open(OPENMS_GET_TEST_DATA_PATH("TextFile_test_infile.txt"));
+  TEST_EXCEPTION(Exception::ParseError, invalid.readNext(entry))
+END_SECTION
+
+START_SECTION((void reset()))
+  MappedFASTAFile file;
+  file.open(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  MappedFASTAFile::Entry entry;
+  file.readNext(entry);
+  TEST_NOT_EQUAL(file.getPosition(), 0)
+  file.reset();
+  TEST_EQUAL(file.getPosition(), 0)
+  file.readNext(entry);
+  TEST_STRING_EQUAL(entry.getIdentifier(), "P68509|1433F_BOVIN")
+END_SECTION
+
+START_SECTION((Size getPosition() const))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION((Size getFileSize() const))
+  MappedFASTAFile file;
+  file.open(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  TEST_NOT_EQUAL(file.getFileSize(), 0)
+  MappedFASTAFile::Entry entry;
+  while (file.readNext(entry)) {}
+  TEST_EQUAL(file.getPosition(), file.getFileSize())
+END_SECTION
+
+START_SECTION(([MappedFASTAFile::Entry] String getIdentifier() const))
+  MappedFASTAFile file;
+  file.open(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  MappedFASTAFile::Entry entry;
+  file.readNext(entry);
+  TEST_STRING_EQUAL(entry.getIdentifier(), "P68509|1433F_BOVIN")
+  file.readNext(entry);
+  TEST_STRING_EQUAL(entry.getIdentifier(), "Q9CQV8|1433B_MOUSE")
+END_SECTION
+
+START_SECTION(([MappedFASTAFile::Entry] String getDescription() const))
+  MappedFASTAFile file;
+  file.open(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  MappedFASTAFile::Entry entry;
+  file.readNext(entry);
+  TEST_STRING_EQUAL(entry.getDescription(), "This is the description of the first protein")
+END_SECTION
+
+START_SECTION(([MappedFASTAFile::Entry] void getSequence(String& seq) const))
+  MappedFASTAFile file;
+  file.open(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  MappedFASTAFile::Entry entry;
+  file.readNext(entry);
+  String seq;
+  entry.getSequence(seq);
+  TEST_STRING_EQUAL(seq, String("GDREQLLQRARLAEQAERYDDMASAMKAVTEL") +
+    String("NEPLSNEDRNLLSVAYKNVVGARRSSWRVISSIEQKTMADGNEKKLEKVKAYREKIEKELETVC") +
+    String("NDVLALLDKFLIKNCNDFQYESKVFYLKMKGDYYRYLAEVASGEKKNSVVEASEAAYKEAFEIS") +
+    String("KEHMQPTHPIRLGLALNFSVFYYEIQNAPEQACLLAKQAFDDAIAELDTLNEDSYKDSTLIMQL") +
+    String("LRDNLTLWTSDQQDEEAGEGN"))
+END_SECTION
+
+START_SECTION(([MappedFASTAFile::Entry] FASTAFile::FASTAEntry toFASTAEntry() const))
+  NOT_TESTABLE // tested in readNext()
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
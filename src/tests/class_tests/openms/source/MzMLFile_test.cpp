@@ -893,6 +893,55 @@ START_SECTION([EXTRA] load intensity range)
   TEST_EQUAL(exp[3].size(),0)
 END_SECTION
 
+START_SECTION([EXTRA] load with spectrum selection)
+  MzMLFile file;
+  MSExperiment<> exp_all;
+  file.load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"),exp_all);
+
+  // spectrum 1 is skipped, the following spectrum 2 is kept
+  std::vector<Size> indices;
+  indices.push_back(0);
+  indices.push_back(2);
+  indices.push_back(3);
+  file.getOptions().setSpectrumIndices(indices);
+  MSExperiment<> exp;
+  file.load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"),exp);
+  TEST_EQUAL(exp.size(),3)
+  for (Size i = 0; i < exp.size(); ++i)
+  {
+    const MSSpectrum<>& expected = exp_all[indices[i]];
+    TEST_EQUAL(exp[i].getNativeID(),expected.getNativeID())
+    TEST_REAL_SIMILAR(exp[i].getRT(),expected.getRT())
+    TEST_EQUAL(exp[i].getMSLevel(),expected.getMSLevel())
+    TEST_EQUAL(exp[i].getPrecursors().size(),expected.getPrecursors().size())
+    TEST_EQUAL(exp[i].getFloatDataArrays().size(),expected.getFloatDataArrays().size())
+    TEST_EQUAL(exp[i].size(),expected.size())
+    for (Size p = 0; p < std::min(exp[i].size(), expected.size()); ++p)
+    {
+      TEST_REAL_SIMILAR(exp[i][p].getMZ(),expected[p].getMZ())
+      TEST_REAL_SIMILAR(exp[i][p].getIntensity(),expected[p].getIntensity())
+    }
+  }
+
+  // the first spectrum is skipped
+  indices.clear();
+  indices.push_back(1);
+  indices.push_back(3);
+  file.getOptions().setSpectrumIndices(indices);
+  file.load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"),exp);
+  TEST_EQUAL(exp.size(),2)
+  TEST_EQUAL(exp[0].getNativeID(),exp_all[1].getNativeID())
+  TEST_EQUAL(exp[0].size(),exp_all[1].size())
+  TEST_EQUAL(exp[0].getFloatDataArrays().size(),exp_all[1].getFloatDataArrays().size())
+  TEST_EQUAL(exp[1].getNativeID(),exp_all[3].getNativeID())
+  TEST_EQUAL(exp[1].size(),0)
+
+  // no selection
+  file.getOptions().clearSpectrumIndices();
+  file.load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"),exp);
+  TEST_EQUAL(exp.size(),4)
+END_SECTION
+
 START_SECTION((Size loadSize(const String & filename, Size& scount, Size& ccount)))
 {
   MzMLFile file;
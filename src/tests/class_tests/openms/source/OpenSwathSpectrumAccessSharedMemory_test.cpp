@@ -0,0 +1,183 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessSharedMemory.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMS.h>
+#include <boost/shared_ptr.hpp>
+///////////////////////////
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QSharedMemory>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(SpectrumAccessSharedMemory, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+// segment names are system-wide, do not collide with concurrent test runs
+String key = "OpenMS_SpectrumAccessSharedMemory_test_" + String(QCoreApplication::applicationPid());
+
+// two SWATH maps with three spectra each
+std::vector<OpenSwath::SwathMap> swath_maps;
+for (Size m = 0; m < 2; ++m)
+{
+  boost::shared_ptr<MSExperiment<Peak1D> > exp(new MSExperiment<Peak1D>);
+  for (Size k = 0; k < 3; ++k)
+  {
+    MSSpectrum<Peak1D> spectrum;
+    spectrum.setRT(10.0 * k);
+    spectrum.setMSLevel(2);
+    for (Size p = 0; p < k + m; ++p)
+    {
+      Peak1D peak;
+      peak.setMZ(400.0 + p);
+      peak.setIntensity(100.0 * (m + 1) + p);
+      spectrum.push_back(peak);
+    }
+    exp->addSpectrum(spectrum);
+  }
+  OpenSwath::SwathMap map;
+  map.sptr = OpenSwath::SpectrumAccessPtr(new SpectrumAccessOpenMS(exp));
+  map.lower = 400.0 + 25 * m;
+  map.upper = 425.0 + 25 * m;
+  map.center = 412.5 + 25 * m;
+  map.ms1 = false;
+  swath_maps.push_back(map);
+}
+
+std::vector<OpenSwath::SwathMap> shared_maps;
+
+START_SECTION((static bool publishSwathMaps(const std::vector<OpenSwath::SwathMap> & swath_maps, const String & key, std::vector<OpenSwath::SwathMap> & shared_maps)))
+{
+  TEST_EQUAL(SpectrumAccessSharedMemory::publishSwathMaps(swath_maps, key, shared_maps), true)
+  TEST_EQUAL(shared_maps.size(), 2)
+  TEST_REAL_SIMILAR(shared_maps[1].lower, 425.0)
+  TEST_REAL_SIMILAR(shared_maps[1].upper, 450.0)
+  TEST_EQUAL(shared_maps[1].sptr->getNrSpectra(), 3)
+
+  // the name is taken
+  std::vector<OpenSwath::SwathMap> other_maps;
+  TEST_EQUAL(SpectrumAccessSharedMemory::publishSwathMaps(swath_maps, key, other_maps), false)
+  TEST_EQUAL(other_maps.size(), 0)
+}
+END_SECTION
+
+START_SECTION((static bool attachSwathMaps(const String & key, std::vector<OpenSwath::SwathMap> & swath_maps)))
+{
+  std::vector<OpenSwath::SwathMap> attached_maps;
+  TEST_EQUAL(SpectrumAccessSharedMemory::attachSwathMaps(key + "_unknown", attached_maps), false)
+  TEST_EQUAL(SpectrumAccessSharedMemory::attachSwathMaps(key, attached_maps), true)
+  TEST_EQUAL(attached_maps.size(), 2)
+  TEST_REAL_SIMILAR(attached_maps[0].lower, 400.0)
+  TEST_REAL_SIMILAR(attached_maps[0].center, 412.5)
+  TEST_EQUAL(attached_maps[0].ms1, false)
+  TEST_EQUAL(attached_maps[0].sptr->getNrSpectra(), 3)
+
+  OpenSwath::SpectrumPtr spectrum = attached_maps[1].sptr->getSpectrumById(2);
+  TEST_EQUAL(spectrum->getMZArray()->data.size(), 3)
+  TEST_REAL_SIMILAR(spectrum->getMZArray()->data[2], 402.0)
+  TEST_REAL_SIMILAR(spectrum->getIntensityArray()->data[2], 202.0)
+
+  // table segment which is still being written (no identifier yet)
+  QSharedMemory incomplete((key + "_incomplete").toQString());
+  TEST_EQUAL(incomplete.create(64), true)
+  TEST_EQUAL(SpectrumAccessSharedMemory::attachSwathMaps(key + "_incomplete", attached_maps), false)
+  TEST_EQUAL(attached_maps.size(), 2)
+}
+END_SECTION
+
+START_SECTION(OpenSwath::SpectrumPtr getSpectrumById(int id))
+{
+  // the first spectrum of the first map is empty
+  TEST_EQUAL(shared_maps[0].sptr->getSpectrumById(0)->getMZArray()->data.size(), 0)
+  OpenSwath::SpectrumPtr spectrum = shared_maps[0].sptr->getSpectrumById(1);
+  TEST_EQUAL(spectrum->getMZArray()->data.size(), 1)
+  TEST_REAL_SIMILAR(spectrum->getMZArray()->data[0], 400.0)
+  TEST_REAL_SIMILAR(spectrum->getIntensityArray()->data[0], 100.0)
+}
+END_SECTION
+
+START_SECTION(OpenSwath::SpectrumMeta getSpectrumMetaById(int id) const)
+{
+  TEST_REAL_SIMILAR(shared_maps[0].sptr->getSpectrumMetaById(2).RT, 20.0)
+  TEST_EQUAL(shared_maps[0].sptr->getSpectrumMetaById(2).ms_level, 2)
+}
+END_SECTION
+
+START_SECTION(std::vector<std::size_t> getSpectraByRT(double RT, double deltaRT) const)
+{
+  std::vector<std::size_t> result = shared_maps[0].sptr->getSpectraByRT(15.0, 5.0);
+  TEST_EQUAL(result.size(), 2)
+  TEST_EQUAL(result[0], 1)
+  TEST_EQUAL(result[1], 2)
+  result = shared_maps[0].sptr->getSpectraByRT(0.0, 0.0);
+  TEST_EQUAL(result.size(), 1)
+  TEST_EQUAL(result[0], 0)
+}
+END_SECTION
+
+START_SECTION(boost::shared_ptr<OpenSwath::ISpectrumAccess> lightClone() const)
+{
+  OpenSwath::SpectrumAccessPtr clone = shared_maps[1].sptr->lightClone();
+  TEST_EQUAL(clone->getNrSpectra(), 3)
+  TEST_REAL_SIMILAR(clone->getSpectrumById(1)->getIntensityArray()->data[1], 201.0)
+}
+END_SECTION
+
+START_SECTION(size_t getNrChromatograms() const)
+{
+  TEST_EQUAL(shared_maps[0].sptr->getNrChromatograms(), 0)
+  TEST_EXCEPTION(Exception::IndexOverflow, shared_maps[0].sptr->getChromatogramById(0))
+}
+END_SECTION
+
+START_SECTION([EXTRA] segments are freed after the last detach)
+{
+  shared_maps.clear();
+  std::vector<OpenSwath::SwathMap> attached_maps;
+  TEST_EQUAL(SpectrumAccessSharedMemory::attachSwathMaps(key, attached_maps), false)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -0,0 +1,247 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+
+///////////////////////////
+#include <OpenMS/CONCEPT/ParallelExceptionCollector.h>
+///////////////////////////
+
+#include <OpenMS/CONCEPT/Exception.h>
+
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(ParallelExceptionCollector, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+ParallelExceptionCollector* ptr = 0;
+ParallelExceptionCollector* null_ptr = 0;
+START_SECTION((ParallelExceptionCollector()))
+{
+  ptr = new ParallelExceptionCollector();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->hasError(), false)
+}
+END_SECTION
+
+START_SECTION((~ParallelExceptionCollector()))
+{
+  try
+  {
+    throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__, "deleted with a pending error");
+  }
+  catch (...)
+  {
+    ptr->capture(0);
+  }
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION((void capture(Size index)))
+{
+  ParallelExceptionCollector errors;
+  try
+  {
+    throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__, "second");
+  }
+  catch (...)
+  {
+    errors.capture(7);
+  }
+  TEST_EQUAL(errors.getErrorIndex(), 7)
+  // a lower index replaces the error
+  try
+  {
+    throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "first");
+  }
+  catch (...)
+  {
+    errors.capture(3);
+  }
+  TEST_EQUAL(errors.getErrorIndex(), 3)
+  // a higher index is ignored
+  try
+  {
+    throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "third", "");
+  }
+  catch (...)
+  {
+    errors.capture(5);
+  }
+  TEST_EQUAL(errors.getErrorIndex(), 3)
+  TEST_EXCEPTION_WITH_MESSAGE(Exception::ConversionError, errors.rethrow(), "first")
+
+  // the first error by index is reported, independent of the scheduling
+  std::vector<int> done(100, 0);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+  for (SignedSize i = 0; i < 100; ++i)
+  {
+    if (errors.hasErrorBefore(i)) continue;
+    try
+    {
+      if (i == 80) throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__, "80");
+      if (i == 40) throw Exception::UnableToFit(__FILE__, __LINE__, __PRETTY_FUNCTION__, "fit", "40");
+      if (i == 60) throw std::bad_alloc();
+      done[i] = 1;
+    }
+    catch (...)
+    {
+      errors.capture(i);
+    }
+  }
+  TEST_EQUAL(errors.getErrorIndex(), 40)
+  TEST_EQUAL(done[39], 1)
+  TEST_EXCEPTION(Exception::UnableToFit, errors.rethrow())
+}
+END_SECTION
+
+START_SECTION((bool hasError() const))
+{
+  ParallelExceptionCollector errors;
+  TEST_EQUAL(errors.hasError(), false)
+  try
+  {
+    throw std::runtime_error("error");
+  }
+  catch (...)
+  {
+    errors.capture(0);
+  }
+  TEST_EQUAL(errors.hasError(), true)
+}
+END_SECTION
+
+START_SECTION((bool hasErrorBefore(Size index) const))
+{
+  ParallelExceptionCollector errors;
+  TEST_EQUAL(errors.hasErrorBefore(10), false)
+  try
+  {
+    throw std::runtime_error("error");
+  }
+  catch (...)
+  {
+    errors.capture(4);
+  }
+  TEST_EQUAL(errors.hasErrorBefore(4), false)
+  TEST_EQUAL(errors.hasErrorBefore(5), true)
+}
+END_SECTION
+
+START_SECTION((Size getErrorIndex() const))
+{
+  // tested above
+  NOT_TESTABLE
+}
+END_SECTION
+
+START_SECTION((void rethrow()))
+{
+  ParallelExceptionCollector errors;
+  errors.rethrow(); // no error, no exception
+
+  try
+  {
+    throw Exception::OutOfMemory(__FILE__, __LINE__, __PRETTY_FUNCTION__, 10);
+  }
+  catch (...)
+  {
+    errors.capture(0);
+  }
+  TEST_EXCEPTION(Exception::OutOfMemory, errors.rethrow())
+  TEST_EQUAL(errors.hasError(), false)
+
+  try
+  {
+    throw std::bad_alloc();
+  }
+  catch (...)
+  {
+    errors.capture(0);
+  }
+  TEST_EXCEPTION(std::bad_alloc, errors.rethrow())
+
+  try
+  {
+    throw std::out_of_range("range");
+  }
+  catch (...)
+  {
+    errors.capture(0);
+  }
+  TEST_EXCEPTION(std::out_of_range, errors.rethrow())
+
+  // unknown exceptions are reported as std::runtime_error
+  try
+  {
+    throw 42;
+  }
+  catch (...)
+  {
+    errors.capture(0);
+  }
+  TEST_EXCEPTION(std::runtime_error, errors.rethrow())
+}
+END_SECTION
+
+START_SECTION((void clear()))
+{
+  ParallelExceptionCollector errors;
+  try
+  {
+    throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__, "error");
+  }
+  catch (...)
+  {
+    errors.capture(0);
+  }
+  errors.clear();
+  TEST_EQUAL(errors.hasError(), false)
+  errors.rethrow();
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -231,6 +231,66 @@ START_SECTION((const vector<Int>& getMSLevels() const))
 	TEST_EQUAL(tmp.getMSLevels()==vector<Int>(),true);
 END_SECTION
 
+START_SECTION((void setSpectrumIndices(const std::vector<Size>& indices)))
+	PeakFileOptions tmp;
+	vector<Size> indices;
+	indices.push_back(7);
+	indices.push_back(2);
+	tmp.setSpectrumIndices(indices);
+	TEST_EQUAL(tmp.hasSpectrumIndices(), true);
+	TEST_EQUAL(tmp.getSpectrumIndices().size(), 2);
+	TEST_EQUAL(tmp.getSpectrumIndices()[0], 2);
+	TEST_EQUAL(tmp.getSpectrumIndices()[1], 7);
+	// an empty selection selects nothing
+	tmp.setSpectrumIndices(vector<Size>());
+	TEST_EQUAL(tmp.hasSpectrumIndices(), true);
+	TEST_EQUAL(tmp.containsSpectrumIndex(2), false);
+END_SECTION
+
+START_SECTION((void clearSpectrumIndices()))
+	PeakFileOptions tmp;
+	tmp.setSpectrumIndices(vector<Size>(1, 3));
+	tmp.clearSpectrumIndices();
+	TEST_EQUAL(tmp.hasSpectrumIndices(), false);
+	TEST_EQUAL(tmp.getSpectrumIndices().empty(), true);
+END_SECTION
+
+START_SECTION((bool hasSpectrumIndices() const))
+	PeakFileOptions tmp;
+	TEST_EQUAL(tmp.hasSpectrumIndices(), false);
+END_SECTION
+
+START_SECTION((bool containsSpectrumIndex(Size index) const))
+	PeakFileOptions tmp;
+	vector<Size> indices;
+	indices.push_back(5);
+	indices.push_back(1);
+	indices.push_back(3);
+	tmp.setSpectrumIndices(indices);
+	TEST_EQUAL(tmp.containsSpectrumIndex(1), true);
+	TEST_EQUAL(tmp.containsSpectrumIndex(5), true);
+	TEST_EQUAL(tmp.containsSpectrumIndex(2), false);
+	TEST_EQUAL(tmp.containsSpectrumIndex(6), false);
+END_SECTION
+
+START_SECTION((const std::vector<Size>& getSpectrumIndices() const))
+	PeakFileOptions tmp;
+	TEST_EQUAL(tmp.getSpectrumIndices().empty(), true);
+END_SECTION
+
+START_SECTION((bool getWriteSpectrumMetaIndex() const))
+	PeakFileOptions tmp;
+	TEST_EQUAL(tmp.getWriteSpectrumMetaIndex(), false);
+END_SECTION
+
+START_SECTION((void setWriteSpectrumMetaIndex(bool write_index)))
+	PeakFileOptions tmp;
+	tmp.setWriteSpectrumMetaIndex(true);
+	TEST_EQUAL(tmp.getWriteSpectrumMetaIndex(), true);
+	PeakFileOptions copy(tmp);
+	TEST_EQUAL(copy.getWriteSpectrumMetaIndex(), true);
+END_SECTION
+
 START_SECTION(Size getMaxDataPoolSize() const)
 {
 	PeakFileOptions tmp;
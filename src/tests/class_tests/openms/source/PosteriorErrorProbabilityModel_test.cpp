@@ -38,10 +38,15 @@
 ///////////////////////////
 #include <OpenMS/MATH/STATISTICS/PosteriorErrorProbabilityModel.h>
 #include <OpenMS/FORMAT/IdXMLFile.h>
+#include <OpenMS/CONCEPT/Constants.h>
 #include <vector>
 #include <iostream>
 ///////////////////////////
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace OpenMS;
 using namespace Math;
 using namespace std;
@@ -292,6 +297,158 @@ NOT_TESTABLE
 //not yet tested
 END_SECTION
 
+// deterministic mixture of two normal distributions (Box-Muller on low-discrepancy sequences)
+vector<double> scores;
+for (Size i = 0; i < 30000; ++i)
+{
+  double u1 = fmod((i + 0.5) * 0.6180339887498949, 1.0);
+  double u2 = fmod((i + 0.5) * 0.7548776662466927, 1.0);
+  double z = sqrt(-2.0 * log(u1)) * cos(2.0 * Constants::PI * u2);
+  scores.push_back(i % 3 == 0 ? 4.0 + 0.8 * z : 1.0 + 0.7 * z);
+}
+
+START_SECTION([EXTRA] binned fit ('fit_bins') of a large score distribution)
+{
+  PosteriorErrorProbabilityModel exact, binned;
+  Param param;
+  param.setValue("incorrectly_assigned", "Gauss");
+  exact.setParameters(param);
+  param.setValue("fit_bins", 1000);
+  binned.setParameters(param);
+
+  vector<double> exact_scores(scores), binned_scores(scores), exact_probabilities, binned_probabilities;
+  TEST_EQUAL(exact.fit(exact_scores, exact_probabilities), true)
+  TEST_EQUAL(binned.fit(binned_scores, binned_probabilities), true)
+
+  // the exact fit recovers the mixture ...
+  TOLERANCE_ABSOLUTE(0.05)
+  TEST_REAL_SIMILAR(exact.getNegativePrior(), 2.0 / 3.0)
+  TEST_REAL_SIMILAR(exact.getCorrectlyAssignedFitResult().sigma, 0.8)
+  TEST_REAL_SIMILAR(exact.getIncorrectlyAssignedFitResult().sigma, 0.7)
+
+  // ... and the binned fit agrees with it
+  TOLERANCE_ABSOLUTE(0.001)
+  TEST_REAL_SIMILAR(binned.getNegativePrior(), exact.getNegativePrior())
+  TEST_REAL_SIMILAR(binned.getCorrectlyAssignedFitResult().x0, exact.getCorrectlyAssignedFitResult().x0)
+  TEST_REAL_SIMILAR(binned.getCorrectlyAssignedFitResult().sigma, exact.getCorrectlyAssignedFitResult().sigma)
+  TEST_REAL_SIMILAR(binned.getIncorrectlyAssignedFitResult().x0, exact.getIncorrectlyAssignedFitResult().x0)
+  TEST_REAL_SIMILAR(binned.getIncorrectlyAssignedFitResult().sigma, exact.getIncorrectlyAssignedFitResult().sigma)
+  TEST_REAL_SIMILAR(binned.getSmallestScore(), exact.getSmallestScore())
+
+  TOLERANCE_ABSOLUTE(0.005)
+  TEST_EQUAL(binned_probabilities.size(), exact_probabilities.size())
+  for (Size i = 0; i < exact_probabilities.size(); i += 1000)
+  {
+    TEST_REAL_SIMILAR(binned_probabilities[i], exact_probabilities[i])
+  }
+}
+END_SECTION
+
+START_SECTION([EXTRA] binned fit ('fit_bins') with a Gumbel distribution for incorrectly assigned sequences)
+{
+  PosteriorErrorProbabilityModel exact, binned;
+  Param param;
+  param.setValue("incorrectly_assigned", "Gumbel");
+  exact.setParameters(param);
+  param.setValue("fit_bins", 1000);
+  binned.setParameters(param);
+
+  vector<double> exact_scores(scores), binned_scores(scores), exact_probabilities, binned_probabilities;
+  TEST_EQUAL(exact.fit(exact_scores, exact_probabilities), true)
+  TEST_EQUAL(binned.fit(binned_scores, binned_probabilities), true)
+
+  TOLERANCE_ABSOLUTE(0.001)
+  TEST_REAL_SIMILAR(binned.getNegativePrior(), exact.getNegativePrior())
+  TEST_REAL_SIMILAR(binned.getIncorrectlyAssignedFitResult().x0, exact.getIncorrectlyAssignedFitResult().x0)
+  TEST_REAL_SIMILAR(binned.getIncorrectlyAssignedFitResult().sigma, exact.getIncorrectlyAssignedFitResult().sigma)
+
+  TOLERANCE_ABSOLUTE(0.005)
+  TEST_EQUAL(binned_probabilities.size(), exact_probabilities.size())
+  for (Size i = 0; i < exact_probabilities.size(); i += 1000)
+  {
+    TEST_REAL_SIMILAR(binned_probabilities[i], exact_probabilities[i])
+  }
+  TEST_EQUAL(exact_probabilities.front() > 0.99, true)
+  TEST_EQUAL(exact_probabilities.back() < 0.05, true)
+
+  // fewer scores than bins - fit on all scores:
+  PosteriorErrorProbabilityModel small_exact, small_binned;
+  param.setValue("fit_bins", 100000);
+  small_binned.setParameters(param);
+  vector<double> small_exact_scores(scores.begin(), scores.begin() + 3000), small_binned_scores(small_exact_scores);
+  TEST_EQUAL(small_exact.fit(small_exact_scores), true)
+  TEST_EQUAL(small_binned.fit(small_binned_scores), true)
+  TEST_EQUAL(small_binned.getNegativePrior(), small_exact.getNegativePrior())
+  TEST_EQUAL(small_binned.getCorrectlyAssignedFitResult().x0, small_exact.getCorrectlyAssignedFitResult().x0)
+}
+END_SECTION
+
+START_SECTION([EXTRA] EM helper sums)
+{
+  PosteriorErrorProbabilityModel model;
+  vector<double> x_scores(scores.begin(), scores.begin() + 3000);
+  TEST_EQUAL(model.fit(x_scores), true)
+  vector<double> incorrect, correct;
+  model.fillDensities(x_scores, incorrect, correct);
+  TEST_EQUAL(incorrect.size(), x_scores.size())
+  TEST_EQUAL(correct.size(), x_scores.size())
+
+  double prior = model.getNegativePrior(), mean = 2.5;
+  double maxlike(0), post(0), one_min(0), neg_x0(0), pos_x0(0), neg_sigma(0), pos_sigma(0);
+  for (Size i = 0; i < x_scores.size(); ++i)
+  {
+    double posterior = prior * incorrect[i] / (prior * incorrect[i] + (1 - prior) * correct[i]);
+    maxlike += log10(prior * incorrect[i] + (1 - prior) * correct[i]);
+    post += posterior;
+    one_min += 1 - posterior;
+    neg_x0 += posterior * x_scores[i];
+    pos_x0 += (1 - posterior) * x_scores[i];
+    neg_sigma += posterior * (x_scores[i] - mean) * (x_scores[i] - mean);
+    pos_sigma += (1 - posterior) * (x_scores[i] - mean) * (x_scores[i] - mean);
+  }
+  TOLERANCE_RELATIVE(1.000001)
+  TEST_REAL_SIMILAR(model.computeMaxLikelihood(incorrect, correct), maxlike)
+  TEST_REAL_SIMILAR(model.sum_post(incorrect, correct), post)
+  TEST_REAL_SIMILAR(model.one_minus_sum_post(incorrect, correct), one_min)
+  TEST_REAL_SIMILAR(model.sum_neg_x0(x_scores, incorrect, correct), neg_x0)
+  TEST_REAL_SIMILAR(model.sum_pos_x0(x_scores, incorrect, correct), pos_x0)
+  TEST_REAL_SIMILAR(model.sum_neg_sigma(x_scores, incorrect, correct, mean), neg_sigma)
+  TEST_REAL_SIMILAR(model.sum_pos_sigma(x_scores, incorrect, correct, mean), pos_sigma)
+}
+END_SECTION
+
+START_SECTION([EXTRA] fit results don't depend on the number of threads)
+{
+  Param param;
+  param.setValue("fit_bins", 1000);
+  for (Size bins = 0; bins < 2; ++bins) // without and with binning
+  {
+    PosteriorErrorProbabilityModel parallel, serial;
+    if (bins) 
+    {
+      parallel.setParameters(param);
+      serial.setParameters(param);
+    }
+    vector<double> parallel_scores(scores), serial_scores(scores);
+    TEST_EQUAL(parallel.fit(parallel_scores), true)
+#ifdef _OPENMP
+    int threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+#endif
+    TEST_EQUAL(serial.fit(serial_scores), true)
+#ifdef _OPENMP
+    omp_set_num_threads(threads);
+#endif
+    // identical, not just similar:
+    TEST_EQUAL(parallel.getNegativePrior() == serial.getNegativePrior(), true)
+    TEST_EQUAL(parallel.getCorrectlyAssignedFitResult().x0 == serial.getCorrectlyAssignedFitResult().x0, true)
+    TEST_EQUAL(parallel.getCorrectlyAssignedFitResult().sigma == serial.getCorrectlyAssignedFitResult().sigma, true)
+    TEST_EQUAL(parallel.getIncorrectlyAssignedFitResult().x0 == serial.getIncorrectlyAssignedFitResult().x0, true)
+    TEST_EQUAL(parallel.getIncorrectlyAssignedFitResult().sigma == serial.getIncorrectlyAssignedFitResult().sigma, true)
+  }
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
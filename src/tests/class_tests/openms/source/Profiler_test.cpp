@@ -0,0 +1,360 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+
+///////////////////////////
+#include <OpenMS/SYSTEM/Profiler.h>
+///////////////////////////
+
+#include <OpenMS/CONCEPT/ProgressLogger.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <fstream>
+#include <sstream>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(Profiler, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+START_SECTION(([Profiler::Node] Node()))
+{
+  Profiler::Node node;
+  TEST_EQUAL(node.calls, 0)
+  TEST_REAL_SIMILAR(node.wall_time, 0.0)
+  TEST_REAL_SIMILAR(node.cpu_time, 0.0)
+  TEST_EQUAL(node.peak_memory, 0)
+  TEST_EQUAL(node.counters.size(), 0)
+  TEST_EQUAL(node.children.size(), 0)
+}
+END_SECTION
+
+START_SECTION(([Profiler::Node] void merge(const Node& rhs)))
+{
+  Profiler::Node a, b;
+  a.calls = 1;
+  a.wall_time = 1.0;
+  a.peak_memory = 100;
+  a.counters["x"] = 1.0;
+  a.children["child"] = new Profiler::Node();
+  a.children["child"]->calls = 2;
+  b.calls = 2;
+  b.wall_time = 2.0;
+  b.peak_memory = 50;
+  b.counters["x"] = 2.0;
+  b.children["child"] = new Profiler::Node();
+  b.children["child"]->calls = 3;
+  b.children["other"] = new Profiler::Node();
+  a.merge(b);
+  TEST_EQUAL(a.calls, 3)
+  TEST_REAL_SIMILAR(a.wall_time, 3.0)
+  TEST_EQUAL(a.peak_memory, 100)
+  TEST_REAL_SIMILAR(a.counters["x"], 3.0)
+  TEST_EQUAL(a.children.size(), 2)
+  TEST_EQUAL(a.children["child"]->calls, 5)
+
+  // copies are deep
+  Profiler::Node c(a);
+  a.clear();
+  TEST_EQUAL(a.children.size(), 0)
+  TEST_EQUAL(c.children.size(), 2)
+  TEST_EQUAL(c.children["child"]->calls, 5)
+}
+END_SECTION
+
+START_SECTION((static void setEnabled(bool enabled)))
+{
+  TEST_EQUAL(Profiler::isEnabled(), false)
+  Profiler::setEnabled(true);
+  TEST_EQUAL(Profiler::isEnabled(), true)
+  Profiler::setEnabled(false);
+  TEST_EQUAL(Profiler::isEnabled(), false)
+}
+END_SECTION
+
+START_SECTION((static bool isEnabled()))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((static Size startScope(const String& name)))
+{
+  // disabled: nothing is recorded
+  Profiler::clear();
+  TEST_EQUAL(Profiler::startScope("a"), 0)
+  Profiler::endScope();
+  Profiler::Node root;
+  Profiler::getProfile(root);
+  TEST_EQUAL(root.children.size(), 0)
+
+  Profiler::setEnabled(true);
+  for (Size i = 0; i < 2; ++i)
+  {
+    Profiler::startScope("a");
+    Profiler::startScope("b");
+    Profiler::addToCounter("spectra", 5);
+    Profiler::endScope();
+    Profiler::startScope("c");
+    Profiler::endScope();
+    Profiler::endScope();
+  }
+  Profiler::setEnabled(false);
+
+  Profiler::getProfile(root);
+  TEST_EQUAL(root.children.size(), 1)
+  const Profiler::Node& a = *root.children["a"];
+  TEST_EQUAL(a.calls, 2)
+  TEST_EQUAL(a.children.size(), 2)
+  TEST_EQUAL(a.children.find("b")->second->calls, 2)
+  TEST_REAL_SIMILAR(a.children.find("b")->second->counters.find("spectra")->second, 10.0)
+  TEST_EQUAL(a.children.find("c")->second->calls, 2)
+  TEST_EQUAL(a.wall_time >= a.children.find("b")->second->wall_time, true)
+  TEST_EQUAL(a.peak_memory > 0, true)
+}
+END_SECTION
+
+START_SECTION((static void endScope()))
+{
+  // closing without an open stage is ignored
+  Profiler::clear();
+  Profiler::setEnabled(true);
+  Profiler::endScope();
+  Profiler::startScope("a");
+  Profiler::endScope();
+  Profiler::endScope();
+  Profiler::setEnabled(false);
+
+  Profiler::Node root;
+  Profiler::getProfile(root);
+  TEST_EQUAL(root.children.size(), 1)
+  TEST_EQUAL(root.children["a"]->calls, 1)
+}
+END_SECTION
+
+START_SECTION((static void endScope(Size handle)))
+{
+  Profiler::clear();
+  Profiler::setEnabled(true);
+  Size a = Profiler::startScope("a");
+  Size b = Profiler::startScope("b");
+  TEST_NOT_EQUAL(a, 0)
+  TEST_NOT_EQUAL(a, b)
+  // closed out of order: "a" closes "b" as well, closing "b" afterwards is ignored
+  Profiler::endScope(a);
+  Profiler::endScope(b);
+  Profiler::endScope(0);
+  Size c = Profiler::startScope("c");
+  Profiler::endScope(c);
+  Profiler::endScope(c);
+
+  Profiler::Node root;
+  Profiler::getProfile(root);
+  TEST_EQUAL(root.children.size(), 2)
+  TEST_EQUAL(root.children["a"]->calls, 1)
+  TEST_EQUAL(root.children["a"]->children["b"]->calls, 1)
+  TEST_EQUAL(root.children["c"]->calls, 1)
+
+  // stages removed by clear() are not closed anymore
+  Size d = Profiler::startScope("d");
+  Profiler::clear();
+  Profiler::endScope(d);
+  Profiler::setEnabled(false);
+  Profiler::getProfile(root);
+  TEST_EQUAL(root.children.size(), 0)
+
+  // progress loggers that end in a different order than they started
+  Profiler::setEnabled(true);
+  ProgressLogger outer, inner;
+  outer.startProgress(0, 1, "outer");
+  inner.startProgress(0, 1, "inner");
+  outer.endProgress();
+  Profiler::startScope("next"); // not nested in "outer" anymore
+  Profiler::endScope();
+  inner.endProgress();
+  Profiler::setEnabled(false);
+
+  Profiler::getProfile(root);
+  TEST_EQUAL(root.children.size(), 2)
+  TEST_EQUAL(root.children["outer"]->calls, 1)
+  TEST_EQUAL(root.children["outer"]->children["inner"]->calls, 1)
+  TEST_EQUAL(root.children["next"]->calls, 1)
+}
+END_SECTION
+
+START_SECTION((static void addToCounter(const String& name, double value = 1.0)))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((static void sampleMemory()))
+{
+  Profiler::clear();
+  Profiler::setEnabled(true);
+  Profiler::startScope("a");
+  Profiler::sampleMemory();
+  Profiler::endScope();
+  Profiler::setEnabled(false);
+
+  Profiler::Node root;
+  Profiler::getProfile(root);
+  TEST_EQUAL(root.children["a"]->peak_memory > 0, true)
+}
+END_SECTION
+
+START_SECTION(([Profiler::Scope] Scope(const String& name)))
+{
+  Profiler::clear();
+  Profiler::setEnabled(true);
+  {
+    Profiler::Scope scope("a");
+    Profiler::startScope("not closed");
+  }
+  Profiler::startScope("b");
+  Profiler::endScope();
+  Profiler::setEnabled(false);
+
+  // the stage opened inside the scope was closed with it
+  Profiler::Node root;
+  Profiler::getProfile(root);
+  TEST_EQUAL(root.children.size(), 2)
+  TEST_EQUAL(root.children["a"]->children["not closed"]->calls, 1)
+  TEST_EQUAL(root.children["b"]->calls, 1)
+}
+END_SECTION
+
+START_SECTION((static void clear()))
+{
+  Profiler::clear();
+  Profiler::Node root;
+  Profiler::getProfile(root);
+  TEST_EQUAL(root.children.size(), 0)
+}
+END_SECTION
+
+START_SECTION((static void getProfile(Node& root)))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+Profiler::setEnabled(true);
+Profiler::startScope("a \"stage\"");
+Profiler::startScope("b;c");
+Profiler::addToCounter("n");
+Profiler::endScope();
+Profiler::endScope();
+Profiler::setEnabled(false);
+
+START_SECTION((static void writeJSON(std::ostream& os)))
+{
+  stringstream ss;
+  Profiler::writeJSON(ss);
+  String json = ss.str();
+  TEST_EQUAL(json.hasSubstring("\"name\": \"a \\\"stage\\\"\""), true)
+  TEST_EQUAL(json.hasSubstring("\"name\": \"b;c\""), true)
+  TEST_EQUAL(json.hasSubstring("\"counters\": {\"n\": 1}"), true)
+  TEST_EQUAL(json.hasSubstring("\"calls\": 1"), true)
+}
+END_SECTION
+
+START_SECTION((static void writeFoldedStacks(std::ostream& os)))
+{
+  stringstream ss;
+  Profiler::writeFoldedStacks(ss);
+  String line1, line2, rest;
+  getline(ss, line1);
+  getline(ss, line2);
+  getline(ss, rest);
+  TEST_EQUAL(line1.prefix(' '), "a_\"stage\"")
+  TEST_EQUAL(line2.prefix(' '), "a_\"stage\";b,c")
+  TEST_EQUAL(rest, "")
+}
+END_SECTION
+
+START_SECTION((static void store(const String& filename)))
+{
+  String json_file;
+  NEW_TMP_FILE(json_file)
+  json_file += ".json";
+  Profiler::store(json_file);
+  ifstream json(json_file.c_str());
+  String first;
+  getline(json, first);
+  TEST_EQUAL(first, "{")
+
+  String folded_file;
+  NEW_TMP_FILE(folded_file)
+  Profiler::store(folded_file);
+  ifstream folded(folded_file.c_str());
+  getline(folded, first);
+  TEST_EQUAL(first.hasPrefix("a_\"stage\" "), true)
+
+  TEST_EXCEPTION(Exception::UnableToCreateFile, Profiler::store("/does/not/exist/profile.json"))
+}
+END_SECTION
+
+START_SECTION(([Profiler::Session] Session(const String& name, const String& filename)))
+{
+  // no file: profiling stays disabled
+  {
+    Profiler::Session session("Tool", "");
+    TEST_EQUAL(Profiler::isEnabled(), false)
+  }
+
+  String filename;
+  NEW_TMP_FILE(filename)
+  {
+    Profiler::Session session("Tool", filename);
+    TEST_EQUAL(Profiler::isEnabled(), true)
+    Profiler::Scope scope("stage");
+  }
+  TEST_EQUAL(Profiler::isEnabled(), false)
+  TEST_EQUAL(File::exists(filename), true)
+
+  Profiler::Node root;
+  Profiler::getProfile(root);
+  TEST_EQUAL(root.children.size(), 1)
+  TEST_EQUAL(root.children["Tool"]->children["stage"]->calls, 1)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
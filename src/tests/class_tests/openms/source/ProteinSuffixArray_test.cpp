@@ -0,0 +1,238 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/DATASTRUCTURES/ProteinSuffixArray.h>
+///////////////////////////
+
+#include <algorithm>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(ProteinSuffixArray, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+ProteinSuffixArray* ptr = 0;
+ProteinSuffixArray* null_ptr = 0;
+START_SECTION(ProteinSuffixArray())
+{
+  ptr = new ProteinSuffixArray();
+  TEST_NOT_EQUAL(ptr, null_ptr);
+  TEST_EQUAL(ptr->size(), 0);
+}
+END_SECTION
+
+START_SECTION(~ProteinSuffixArray())
+{
+  delete ptr;
+}
+END_SECTION
+
+vector<String> proteins;
+proteins.push_back("MPEPTIDERPEPTIDEK");
+proteins.push_back("AAPEPTXDERAAA");
+proteins.push_back("");
+proteins.push_back("pepbideK");
+
+ProteinSuffixArray psa;
+
+vector<String> names;
+names.push_back("P1");
+names.push_back("sp|P2|TEST");
+names.push_back("P3");
+names.push_back("P4_rev");
+
+ProteinSuffixArray named;
+
+START_SECTION(void build(const std::vector<String>& proteins, const std::vector<String>& names = std::vector<String>()))
+{
+  psa.build(proteins);
+  TEST_EQUAL(psa.size(), 4);
+  named.build(proteins, names);
+  TEST_EQUAL(named.size(), 4);
+  TEST_EXCEPTION(Exception::InvalidParameter, named.build(proteins, vector<String>(2, "P")));
+  TEST_EQUAL(named.size(), 4); // unchanged
+}
+END_SECTION
+
+START_SECTION(const char* getProtein(Size index) const)
+{
+  TEST_STRING_EQUAL(psa.getProtein(0), "MPEPTIDERPEPTIDEK");
+  TEST_STRING_EQUAL(psa.getProtein(1), "AAPEPTXDERAAA");
+  TEST_STRING_EQUAL(psa.getProtein(2), "");
+  TEST_STRING_EQUAL(psa.getProtein(3), "PEPBIDEK");
+  TEST_EQUAL(psa.getProtein(1) == psa.getProtein(1), true); // not copied
+  TEST_EXCEPTION(Exception::IndexOverflow, psa.getProtein(4));
+}
+END_SECTION
+
+START_SECTION(Size getProteinLength(Size index) const)
+{
+  TEST_EQUAL(psa.getProteinLength(0), 17);
+  TEST_EQUAL(psa.getProteinLength(1), 13);
+  TEST_EQUAL(psa.getProteinLength(2), 0);
+  TEST_EQUAL(psa.getProteinLength(3), 8);
+  TEST_EXCEPTION(Exception::IndexOverflow, psa.getProteinLength(4));
+}
+END_SECTION
+
+START_SECTION(const char* getName(Size index) const)
+{
+  TEST_STRING_EQUAL(named.getName(0), "P1");
+  TEST_STRING_EQUAL(named.getName(1), "sp|P2|TEST");
+  TEST_STRING_EQUAL(named.getName(3), "P4_rev");
+  TEST_STRING_EQUAL(named.getProtein(3), "PEPBIDEK");
+  TEST_STRING_EQUAL(psa.getName(1), ""); // no names given
+  TEST_EXCEPTION(Exception::IndexOverflow, named.getName(4));
+}
+END_SECTION
+
+START_SECTION(static void normalizeSequence(String& seq))
+{
+  String seq = "acdEFGhiJ*UO1";
+  ProteinSuffixArray::normalizeSequence(seq);
+  TEST_EQUAL(seq, "ACDEFGHIXXXXX");
+}
+END_SECTION
+
+START_SECTION(void findExact(const String& peptide, std::vector<Occurrence>& hits) const)
+{
+  vector<ProteinSuffixArray::Occurrence> hits;
+  psa.findExact("PEPTIDE", hits);
+  sort(hits.begin(), hits.end());
+  TEST_EQUAL(hits.size(), 2);
+  TEST_EQUAL(hits[0].first, 0);
+  TEST_EQUAL(hits[0].second, 1);
+  TEST_EQUAL(hits[1].first, 0);
+  TEST_EQUAL(hits[1].second, 9);
+
+  hits.clear();
+  psa.findExact("PEPTXDER", hits);
+  TEST_EQUAL(hits.size(), 1);
+  TEST_EQUAL(hits[0].first, 1);
+  TEST_EQUAL(hits[0].second, 2);
+
+  // no matches across protein boundaries:
+  hits.clear();
+  psa.findExact("AAAPEP", hits);
+  TEST_EQUAL(hits.size(), 0);
+  psa.findExact("AAAA", hits);
+  TEST_EQUAL(hits.size(), 0);
+}
+END_SECTION
+
+START_SECTION(void findTolerant(const String& peptide, Size max_aaa, std::vector<Occurrence>& hits) const)
+{
+  vector<ProteinSuffixArray::Occurrence> hits;
+  psa.findTolerant("PEPTIDE", 0, hits);
+  TEST_EQUAL(hits.size(), 2); // exact matches only
+
+  hits.clear();
+  psa.findTolerant("PEPTIDE", 1, hits);
+  sort(hits.begin(), hits.end());
+  TEST_EQUAL(hits.size(), 3);
+  TEST_EQUAL(hits[2].first, 1);
+  TEST_EQUAL(hits[2].second, 2);
+
+  // 'B' matches 'N' and 'D', but not 'T':
+  hits.clear();
+  psa.findTolerant("PEPDIDEK", 1, hits);
+  TEST_EQUAL(hits.size(), 1);
+  TEST_EQUAL(hits[0].first, 3);
+  hits.clear();
+  psa.findTolerant("PEPTIDEK", 1, hits);
+  TEST_EQUAL(hits.size(), 1);
+  TEST_EQUAL(hits[0].first, 0);
+
+  // ambiguous AA's in the peptide only match themselves (and count):
+  hits.clear();
+  psa.findTolerant("PEPTXDER", 0, hits);
+  TEST_EQUAL(hits.size(), 0);
+  psa.findTolerant("PEPTXDER", 1, hits);
+  TEST_EQUAL(hits.size(), 1);
+}
+END_SECTION
+
+START_SECTION(void store(const String& filename, const String& signature) const)
+{
+  NOT_TESTABLE // tested with "load"
+}
+END_SECTION
+
+START_SECTION(bool load(const String& filename, const String& signature))
+{
+  String filename;
+  NEW_TMP_FILE(filename);
+  ProteinSuffixArray loaded;
+  TEST_EQUAL(loaded.load(filename, "test"), false); // file doesn't exist
+
+  psa.store(filename, "test");
+  TEST_EQUAL(loaded.load(filename, "other"), false);
+  TEST_EQUAL(loaded.size(), 0);
+  TEST_EQUAL(loaded.load(filename, "test"), true);
+  TEST_EQUAL(loaded.size(), 4);
+  TEST_STRING_EQUAL(loaded.getProtein(1), "AAPEPTXDERAAA");
+  TEST_EQUAL(loaded.getProteinLength(1), 13);
+
+  vector<ProteinSuffixArray::Occurrence> hits1, hits2;
+  loaded.findTolerant("PEPTIDE", 1, hits1);
+  psa.findTolerant("PEPTIDE", 1, hits2);
+  TEST_EQUAL(hits1 == hits2, true);
+
+  // with names:
+  named.store(filename, "test");
+  TEST_EQUAL(loaded.load(filename, "test"), true);
+  TEST_EQUAL(loaded.size(), 4);
+  TEST_STRING_EQUAL(loaded.getName(1), "sp|P2|TEST");
+  TEST_STRING_EQUAL(loaded.getName(2), "P3");
+  TEST_STRING_EQUAL(loaded.getProtein(3), "PEPBIDEK");
+  TEST_EQUAL(loaded.getProteinLength(2), 0);
+}
+END_SECTION
+
+START_SECTION(Size size() const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -39,9 +39,46 @@
 #include <OpenMS/SIMULATION/RawMSSignalSimulation.h>
 ///////////////////////////
 
+#include <OpenMS/CHEMISTRY/EmpiricalFormula.h>
+#include <OpenMS/CONCEPT/Constants.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace OpenMS;
 using namespace std;
 
+// exposes the protected helpers
+class RawMSSignalSimulationTest :
+  public RawMSSignalSimulation
+{
+public:
+  explicit RawMSSignalSimulationTest(SimTypes::MutableSimRandomNumberGeneratorPtr rng) :
+    RawMSSignalSimulation(rng)
+  {
+  }
+
+  void compressSpectrum(SimTypes::MSSimExperiment::SpectrumType& spectrum, const std::vector<SimTypes::SimCoordinateType>& grid) const
+  {
+    compressSpectrum_(spectrum, grid);
+  }
+};
+
+// sums up all signal intensities
+double totalIntensity(const SimTypes::MSSimExperiment& experiment)
+{
+  double sum(0);
+  for (Size i = 0; i < experiment.size(); ++i)
+  {
+    for (Size j = 0; j < experiment[i].size(); ++j)
+    {
+      sum += experiment[i][j].getIntensity();
+    }
+  }
+  return sum;
+}
+
 START_TEST(RawMSSignalSimulation, "$Id$")
 
 /////////////////////////////////////////////////////////////
@@ -93,9 +130,156 @@ START_SECTION((RawMSSignalSimulation& operator=(const RawMSSignalSimulation &sou
 }
 END_SECTION
 
+// a small LC-MS map (30 scans, m/z 400-1500) with overlapping features, simulated without noise and contaminants
+SimTypes::MSSimExperiment sim_experiment;
+sim_experiment.resize(30);
+for (Size i = 0; i < sim_experiment.size(); ++i)
+{
+  sim_experiment[i].setRT(100.0 + i);
+  sim_experiment[i].setMSLevel(1);
+  ScanWindow window;
+  window.begin = 400.0;
+  window.end = 1500.0;
+  sim_experiment[i].getInstrumentSettings().getScanWindows().push_back(window);
+  sim_experiment[i].setMetaValue("distortion", 1.0);
+}
+sim_experiment.updateRanges();
+
+SimTypes::FeatureMapSim sim_features;
+const char* formulas[] = { "C43H66N12O12S2", "C50H73N13O12", "C37H59N9O11", "C62H93N15O18S" };
+for (Size i = 0; i < 8; ++i)
+{
+  Feature feature;
+  EmpiricalFormula ef(formulas[i % 4]);
+  feature.setMetaValue("sum_formula", ef.toString());
+  feature.setMetaValue("charge_adducts", "H2");
+  feature.setCharge(2);
+  feature.setMZ(ef.getMonoWeight() / 2.0 + Constants::PROTON_MASS_U);
+  feature.setRT(110.0 + i);
+  feature.setIntensity(1000.0);
+  feature.setMetaValue("RT_width_gaussian", 8.0);
+  sim_features.push_back(feature);
+}
+
+SimTypes::MutableSimRandomNumberGeneratorPtr sim_rnd_gen(new SimTypes::SimRandomNumberGenerator);
+sim_rnd_gen->initialize(false, false);
+
 START_SECTION((void generateRawSignals(SimTypes::FeatureMapSim &features, SimTypes::MSSimExperiment &experiment, SimTypes::MSSimExperiment &experiment_ct, SimTypes::FeatureMapSim &contaminants)))
 {
-  // TODO
+  RawMSSignalSimulation raw_sim(sim_rnd_gen);
+  Param p = raw_sim.getParameters();
+  p.setValue("contaminants:file", "");
+  raw_sim.setParameters(p);
+
+  SimTypes::FeatureMapSim features = sim_features, contaminants;
+  SimTypes::MSSimExperiment experiment = sim_experiment, experiment_ct = sim_experiment;
+  raw_sim.generateRawSignals(features, experiment, experiment_ct, contaminants);
+
+  TEST_EQUAL(contaminants.size(), 0)
+  ABORT_IF(experiment.size() != sim_experiment.size())
+
+  // the intensity of a feature is the sum of its sampled signals, overlapping signals are summed up
+  double feature_sum(0);
+  for (Size i = 0; i < features.size(); ++i)
+  {
+    TEST_EQUAL(features[i].getIntensity() > 0.0, true)
+    TEST_EQUAL(features[i].getConvexHulls().empty(), false)
+    feature_sum += features[i].getIntensity();
+  }
+  TEST_REAL_SIMILAR(totalIntensity(experiment), feature_sum)
+  TEST_EQUAL(experiment[13].empty(), false)
+  TEST_EQUAL(experiment_ct[13].empty(), false)
+
+  // compressed onto the m/z grid: at most one point per grid position
+  for (Size i = 0; i < experiment.size(); ++i)
+  {
+    for (Size j = 1; j < experiment[i].size(); ++j)
+    {
+      TEST_EQUAL(experiment[i][j - 1].getMZ() < experiment[i][j].getMZ(), true)
+    }
+  }
+
+  // same signal when sampling with a single thread
+#ifdef _OPENMP
+  int threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+  SimTypes::FeatureMapSim features_serial = sim_features;
+  SimTypes::MSSimExperiment experiment_serial = sim_experiment, experiment_ct_serial = sim_experiment;
+  raw_sim.generateRawSignals(features_serial, experiment_serial, experiment_ct_serial, contaminants);
+#ifdef _OPENMP
+  omp_set_num_threads(threads);
+#endif
+  ABORT_IF(experiment_serial.size() != experiment.size())
+  for (Size i = 0; i < experiment.size(); ++i)
+  {
+    ABORT_IF(experiment_serial[i].size() != experiment[i].size())
+    for (Size j = 0; j < experiment[i].size(); ++j)
+    {
+      TEST_REAL_SIMILAR(experiment_serial[i][j].getMZ(), experiment[i][j].getMZ())
+      TEST_REAL_SIMILAR(experiment_serial[i][j].getIntensity(), experiment[i][j].getIntensity())
+    }
+  }
+  for (Size i = 0; i < features.size(); ++i)
+  {
+    TEST_REAL_SIMILAR(features_serial[i].getIntensity(), features[i].getIntensity())
+  }
+
+  // errors keep their type: no elution profile for a feature without RT width
+  features = sim_features;
+  features[3].removeMetaValue("RT_width_gaussian");
+  experiment = sim_experiment;
+  experiment_ct = sim_experiment;
+  TEST_EXCEPTION(Exception::InvalidValue, raw_sim.generateRawSignals(features, experiment, experiment_ct, contaminants))
+
+  experiment_ct.resize(2);
+  TEST_EXCEPTION(Exception::InvalidSize, raw_sim.generateRawSignals(features, experiment, experiment_ct, contaminants))
+}
+END_SECTION
+
+START_SECTION(([EXTRA] void compressSpectrum_(SimTypes::MSSimExperiment::SpectrumType& spectrum, const std::vector<SimTypes::SimCoordinateType>& grid) const))
+{
+  RawMSSignalSimulationTest raw_sim(sim_rnd_gen);
+  std::vector<SimTypes::SimCoordinateType> grid;
+  for (Size i = 0; i < 6; ++i)
+  {
+    grid.push_back(100.0 + i);
+  }
+
+  // unsorted input, points are summed up at their closest grid point
+  SimTypes::MSSimExperiment::SpectrumType spectrum;
+  spectrum.setRT(12.5);
+  SimTypes::SimPointType point;
+  point.setMZ(101.1); point.setIntensity(1.0); spectrum.push_back(point);
+  point.setMZ(100.2); point.setIntensity(2.0); spectrum.push_back(point);
+  point.setMZ(100.9); point.setIntensity(3.0); spectrum.push_back(point);
+  point.setMZ(103.8); point.setIntensity(4.0); spectrum.push_back(point);
+  point.setMZ(102.4); point.setIntensity(5.0); spectrum.push_back(point);
+
+  raw_sim.compressSpectrum(spectrum, grid);
+  ABORT_IF(spectrum.size() != 4)
+  TEST_REAL_SIMILAR(spectrum[0].getMZ(), 100.0)
+  TEST_REAL_SIMILAR(spectrum[0].getIntensity(), 2.0)
+  TEST_REAL_SIMILAR(spectrum[1].getMZ(), 101.0)
+  TEST_REAL_SIMILAR(spectrum[1].getIntensity(), 4.0)
+  TEST_REAL_SIMILAR(spectrum[2].getMZ(), 102.0)
+  TEST_REAL_SIMILAR(spectrum[2].getIntensity(), 5.0)
+  TEST_REAL_SIMILAR(spectrum[3].getMZ(), 104.0)
+  TEST_REAL_SIMILAR(spectrum[3].getIntensity(), 4.0)
+  TEST_REAL_SIMILAR(spectrum.getRT(), 12.5) // meta data is kept
+
+  // compressing again does not change anything
+  SimTypes::MSSimExperiment::SpectrumType compressed = spectrum;
+  raw_sim.compressSpectrum(spectrum, grid);
+  TEST_EQUAL(spectrum == compressed, true)
+
+  // a single point is kept as it is
+  SimTypes::MSSimExperiment::SpectrumType single;
+  point.setMZ(100.4);
+  single.push_back(point);
+  raw_sim.compressSpectrum(single, grid);
+  ABORT_IF(single.size() != 1)
+  TEST_REAL_SIMILAR(single[0].getMZ(), 100.4)
 }
 END_SECTION
 
@@ -117,6 +117,28 @@ START_SECTION ( [EXTRA] testscorefunction)
   TEST_REAL_SIMILAR(intresv[0],0 );
   TEST_REAL_SIMILAR(mzresv[1],200 );
   TEST_REAL_SIMILAR(intresv[1],0 );
+
+  // batch integration gives the same results as the single windows, in any window order
+  std::vector<double> mz_start, mz_end, mzbatch, intbatch;
+  mz_start.push_back(499.6); mz_end.push_back(501.4);
+  mz_start.push_back(200.0); mz_end.push_back(200.5);
+  mz_start.push_back(499.);  mz_end.push_back(501.);
+  mz_start.push_back(599.5); mz_end.push_back(700.);
+  mz_start.push_back(501.);  mz_end.push_back(500.);
+  OpenSwath::integrateWindowBatch(sptr, mz_start, mz_end, mzbatch, intbatch);
+  TEST_EQUAL(mzbatch.size(), 5)
+  TEST_EQUAL(intbatch.size(), 5)
+  for (Size i = 0; i < mz_start.size(); ++i)
+  {
+    bool found = OpenSwath::integrateWindow(sptr, mz_start[i], mz_end[i], mzres, intensityres);
+    TEST_EQUAL(found, intbatch[i] > 0)
+    TEST_REAL_SIMILAR(mzbatch[i], mzres)
+    TEST_REAL_SIMILAR(intbatch[i], intensityres)
+  }
+  TEST_REAL_SIMILAR(mzbatch[0], 500.338842975207);
+  TEST_REAL_SIMILAR(intbatch[0], 121);
+  TEST_REAL_SIMILAR(mzbatch[1], -1);
+  TEST_REAL_SIMILAR(intbatch[1], 0);
 }
 END_SECTION
 
@@ -0,0 +1,325 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/FORMAT/SpectrumMetaIndex.h>
+///////////////////////////
+
+#include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/FORMAT/HANDLERS/IndexedMzMLDecoder.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+#include <OpenMS/SYSTEM/File.h>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(SpectrumMetaIndex, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+SpectrumMetaIndex* ptr = 0;
+SpectrumMetaIndex* null_ptr = 0;
+START_SECTION(SpectrumMetaIndex())
+{
+  ptr = new SpectrumMetaIndex();
+  TEST_NOT_EQUAL(ptr, null_ptr);
+  TEST_EQUAL(ptr->size(), 0);
+  TEST_EQUAL(ptr->getChromatogramCount(), 0);
+}
+END_SECTION
+
+START_SECTION(~SpectrumMetaIndex())
+{
+  delete ptr;
+}
+END_SECTION
+
+// a small map: one MS1 spectrum, one (empty) MS2 spectrum with precursor, one chromatogram
+MSExperiment<> exp;
+exp.resize(2);
+exp[0].setRT(10.0);
+exp[0].setMSLevel(1);
+Peak1D p;
+p.setMZ(500.0);
+p.setIntensity(20.0f);
+exp[0].push_back(p);
+p.setMZ(400.0);
+p.setIntensity(50.0f);
+exp[0].push_back(p);
+p.setMZ(600.0);
+p.setIntensity(30.0f);
+exp[0].push_back(p);
+exp[1].setRT(12.5);
+exp[1].setMSLevel(2);
+exp[1].getPrecursors().resize(1);
+exp[1].getPrecursors()[0].setMZ(445.3);
+exp[1].getPrecursors()[0].setCharge(2);
+exp.setChromatograms(vector<MSChromatogram<> >(1));
+
+START_SECTION((template <typename SpectrumType> void addSpectrum(const SpectrumType& spectrum, Int64 offset = -1)))
+{
+  SpectrumMetaIndex index;
+  index.addSpectrum(exp[0], 123);
+  index.addSpectrum(exp[1]);
+  TEST_EQUAL(index.size(), 2);
+  const SpectrumMetaIndex::Entry& e0 = index.getEntries()[0];
+  TEST_REAL_SIMILAR(e0.rt, 10.0);
+  TEST_EQUAL(e0.ms_level, 1);
+  TEST_EQUAL(e0.peak_count, 3);
+  TEST_EQUAL(e0.precursor_count, 0);
+  TEST_EQUAL(e0.precursor_charge, 0);
+  TEST_REAL_SIMILAR(e0.tic, 100.0);
+  TEST_REAL_SIMILAR(e0.base_peak_mz, 400.0);
+  TEST_REAL_SIMILAR(e0.base_peak_intensity, 50.0);
+  TEST_REAL_SIMILAR(e0.min_mz, 400.0);
+  TEST_REAL_SIMILAR(e0.max_mz, 600.0);
+  TEST_REAL_SIMILAR(e0.min_intensity, 20.0);
+  TEST_REAL_SIMILAR(e0.max_intensity, 50.0);
+  TEST_EQUAL(e0.offset, 123);
+  const SpectrumMetaIndex::Entry& e1 = index.getEntries()[1];
+  TEST_EQUAL(e1.ms_level, 2);
+  TEST_EQUAL(e1.peak_count, 0);
+  TEST_EQUAL(e1.precursor_count, 1);
+  TEST_REAL_SIMILAR(e1.precursor_mz, 445.3);
+  TEST_EQUAL(e1.precursor_charge, 2);
+  TEST_REAL_SIMILAR(e1.tic, 0.0);
+  TEST_EQUAL(e1.offset, -1);
+}
+END_SECTION
+
+START_SECTION((template <typename MapType> void build(const MapType& map)))
+{
+  SpectrumMetaIndex index;
+  index.addSpectrum(exp[1]);
+  index.build(exp);
+  TEST_EQUAL(index.size(), 2);
+  TEST_EQUAL(index.getChromatogramCount(), 1);
+  TEST_EQUAL(index.getEntries()[1].ms_level, 2);
+}
+END_SECTION
+
+START_SECTION((void clear()))
+{
+  SpectrumMetaIndex index;
+  index.build(exp);
+  index.clear();
+  TEST_EQUAL(index.size(), 0);
+  TEST_EQUAL(index.getChromatogramCount(), 0);
+}
+END_SECTION
+
+START_SECTION((Size size() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((const std::vector<Entry>& getEntries() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((Size getChromatogramCount() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((void setChromatogramCount(Size count)))
+{
+  SpectrumMetaIndex index;
+  index.setChromatogramCount(5);
+  TEST_EQUAL(index.getChromatogramCount(), 5);
+}
+END_SECTION
+
+START_SECTION((void setOffsets(const std::vector<std::pair<std::string, long> >& offsets)))
+{
+  SpectrumMetaIndex index;
+  index.build(exp);
+  vector<pair<string, long> > offsets;
+  offsets.push_back(make_pair(string("a"), 100));
+  index.setOffsets(offsets); // wrong size, ignored
+  TEST_EQUAL(index.getEntries()[0].offset, -1);
+  offsets.push_back(make_pair(string("b"), 200));
+  index.setOffsets(offsets);
+  TEST_EQUAL(index.getEntries()[0].offset, 100);
+  TEST_EQUAL(index.getEntries()[1].offset, 200);
+}
+END_SECTION
+
+START_SECTION((bool isSortedByRT() const))
+{
+  SpectrumMetaIndex index;
+  TEST_EQUAL(index.isSortedByRT(), true);
+  index.build(exp);
+  TEST_EQUAL(index.isSortedByRT(), true);
+  index.addSpectrum(exp[0]);
+  TEST_EQUAL(index.isSortedByRT(), false);
+}
+END_SECTION
+
+START_SECTION((void build(const String& mzml_file)))
+{
+  String mzml = OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML");
+  MSExperiment<> loaded;
+  MzMLFile().load(mzml, loaded);
+
+  SpectrumMetaIndex index;
+  index.build(mzml);
+  TEST_EQUAL(index.size(), loaded.size());
+  TEST_EQUAL(index.getChromatogramCount(), loaded.getChromatograms().size());
+  ABORT_IF(index.size() != 2);
+
+  // offsets are taken from the index of the file
+  IndexedMzMLDecoder decoder;
+  IndexedMzMLDecoder::OffsetVector spectra_offsets, chromatograms_offsets;
+  decoder.parseOffsets(mzml, decoder.findIndexListOffset(mzml), spectra_offsets, chromatograms_offsets);
+  ABORT_IF(spectra_offsets.size() != 2);
+  for (Size i = 0; i < index.size(); ++i)
+  {
+    const SpectrumMetaIndex::Entry& e = index.getEntries()[i];
+    TEST_REAL_SIMILAR(e.rt, loaded[i].getRT());
+    TEST_EQUAL(e.ms_level, Int(loaded[i].getMSLevel()));
+    TEST_EQUAL(e.peak_count, loaded[i].size());
+    TEST_EQUAL(e.offset, Int64(spectra_offsets[i].second));
+  }
+
+  // no offsets for non-indexed files
+  index.build(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"));
+  TEST_NOT_EQUAL(index.size(), 0);
+  TEST_EQUAL(index.getEntries()[0].offset, -1);
+}
+END_SECTION
+
+START_SECTION((void store(const String& filename, const String& signature) const))
+{
+  String filename;
+  NEW_TMP_FILE(filename);
+  SpectrumMetaIndex index;
+  index.build(exp);
+  index.store(filename, "signature");
+
+  SpectrumMetaIndex loaded;
+  TEST_EQUAL(loaded.load(filename, "other signature"), false);
+  TEST_EQUAL(loaded.size(), 0);
+  TEST_EQUAL(loaded.load(filename, "signature"), true);
+  TEST_EQUAL(loaded.size(), 2);
+  TEST_EQUAL(loaded.getChromatogramCount(), 1);
+  TEST_REAL_SIMILAR(loaded.getEntries()[0].tic, 100.0);
+  TEST_REAL_SIMILAR(loaded.getEntries()[1].precursor_mz, 445.3);
+  TEST_EQUAL(loaded.getEntries()[1].precursor_charge, 2);
+
+  // empty index
+  SpectrumMetaIndex empty;
+  empty.store(filename, "");
+  TEST_EQUAL(loaded.load(filename, ""), true);
+  TEST_EQUAL(loaded.size(), 0);
+}
+END_SECTION
+
+START_SECTION((bool load(const String& filename, const String& signature)))
+{
+  SpectrumMetaIndex index;
+  TEST_EQUAL(index.load(OPENMS_GET_TEST_DATA_PATH("fileDoesNotExist"), "signature"), false);
+  // not an index file
+  TEST_EQUAL(index.load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), "signature"), false);
+}
+END_SECTION
+
+START_SECTION((void storeSidecar(const String& mzml_file) const))
+{
+  String mzml;
+  NEW_TMP_FILE(mzml);
+  MzMLFile f;
+  f.getOptions().setWriteSpectrumMetaIndex(true);
+  f.getOptions().setWriteIndex(true);
+  f.store(mzml, exp); // stores the sidecar index
+  TEST_EQUAL(File::exists(SpectrumMetaIndex::getIndexFilename(mzml)), true);
+
+  SpectrumMetaIndex index;
+  TEST_EQUAL(index.loadSidecar(mzml), true);
+  TEST_EQUAL(index.size(), 2);
+  TEST_EQUAL(index.getChromatogramCount(), 1);
+  // offsets recorded while writing are the same as in the file index
+  IndexedMzMLDecoder decoder;
+  IndexedMzMLDecoder::OffsetVector spectra_offsets, chromatograms_offsets;
+  decoder.parseOffsets(mzml, decoder.findIndexListOffset(mzml), spectra_offsets, chromatograms_offsets);
+  ABORT_IF(spectra_offsets.size() != 2);
+  TEST_EQUAL(index.getEntries()[0].offset, Int64(spectra_offsets[0].second));
+  TEST_EQUAL(index.getEntries()[1].offset, Int64(spectra_offsets[1].second));
+
+  // the sidecar of a different file is outdated
+  String other;
+  NEW_TMP_FILE(other);
+  MzMLFile().store(other, MSExperiment<>());
+  index.storeSidecar(other);
+  MzMLFile().store(other, exp); // changes the file, but not the sidecar
+  TEST_EQUAL(index.loadSidecar(other), false);
+
+  File::remove(SpectrumMetaIndex::getIndexFilename(mzml));
+  File::remove(SpectrumMetaIndex::getIndexFilename(other));
+}
+END_SECTION
+
+START_SECTION((bool loadSidecar(const String& mzml_file)))
+{
+  SpectrumMetaIndex index;
+  TEST_EQUAL(index.loadSidecar(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML")), false);
+}
+END_SECTION
+
+START_SECTION((static String getIndexFilename(const String& mzml_file)))
+{
+  TEST_EQUAL(SpectrumMetaIndex::getIndexFilename("run.mzML"), "run.mzML.smi");
+}
+END_SECTION
+
+START_SECTION((static String getSignature(const String& mzml_file)))
+{
+  String signature = SpectrumMetaIndex::getSignature(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
+  TEST_EQUAL(signature.hasPrefix("SpectrumMetaIndex;size="), true);
+  TEST_EQUAL(signature, SpectrumMetaIndex::getSignature(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML")));
+  TEST_NOT_EQUAL(signature, SpectrumMetaIndex::getSignature(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML")));
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -472,6 +472,7 @@ START_SECTION(([EXTRA]String getStringOption_(const String& name) const))
   p2.setValue("TOPPBaseTest:1:log","","Name of log file (created only when specified)");
 	p2.setValue("TOPPBaseTest:1:debug",0,"Sets the debug level");
 	p2.setValue("TOPPBaseTest:1:threads",1, "Sets the number of threads allowed to be used by the TOPP tool");
+	p2.setValue("TOPPBaseTest:1:profile","","Writes the wall time, CPU time and peak memory of the processing stages to the given file (JSON for '.json', otherwise folded stacks for flame graphs)");
 	p2.setValue("TOPPBaseTest:1:no_progress","false","Disables progress logging to command line");
 	p2.setValue("TOPPBaseTest:1:force","false","Overwrite tool specific checks.");
 	p2.setValue("TOPPBaseTest:1:test","false","Enables the test mode (needed for software testing only)");
@@ -114,6 +114,29 @@ START_SECTION((double apply(double value) const))
 }
 END_SECTION
 
+START_SECTION((void apply(std::vector<double>& values) const))
+{
+	TransformationDescription td;
+	std::vector<double> values;
+	td.apply(values);
+	TEST_EQUAL(values.empty(), true);
+	values.push_back(-0.5);
+	values.push_back(1000);
+	td.apply(values);
+	TEST_EQUAL(values[0], -0.5);
+	TEST_EQUAL(values[1], 1000);
+
+	TransformationDescription::DataPoints data;
+	data.push_back(make_pair(0.0, 1.0));
+	data.push_back(make_pair(1.0, 3.0));
+	td.setDataPoints(data);
+	td.fitModel("linear");
+	td.apply(values);
+	TEST_REAL_SIMILAR(values[0], 0.0);
+	TEST_REAL_SIMILAR(values[1], 2001.0);
+}
+END_SECTION
+
 START_SECTION((const String& getModelType() const))
 {
 	TransformationDescription td;
@@ -122,6 +122,22 @@ START_SECTION((virtual double evaluate(double value) const))
   TransformationModelBSpline tm_global(data, params);
   TEST_REAL_SIMILAR(tm_global.evaluate(-4.0), -0.959617);
   TEST_REAL_SIMILAR(tm_global.evaluate(4.0), 1.10039);
+
+  // all at once:
+  vector<double> values;
+  for (double v = -4; v < 4.1; v += 0.2)
+  {
+    values.push_back(v);
+  }
+  vector<double> batch(values.size());
+  tm.evaluate(&values[0], &batch[0], values.size());
+  tm_lin.evaluate(&values[0], &values[0], values.size());
+  for (Size i = 0; i < batch.size(); ++i)
+  {
+    TEST_REAL_SIMILAR(batch[i], pred[i]);
+  }
+  TEST_REAL_SIMILAR(values.front(), 0.947997);
+  TEST_REAL_SIMILAR(values.back(), tm_lin.evaluate(4.0));
 }
 END_SECTION
 
@@ -42,6 +42,8 @@
 
 #include <OpenMS/FORMAT/CsvFile.h>
 
+#include <algorithm>
+
 ///////////////////////////
 
 START_TEST(TransformationModelInterpolated, "$Id$")
@@ -136,6 +138,42 @@ START_SECTION((double evaluate(double value) const))
     TEST_REAL_SIMILAR(cspline_interpolation.evaluate(x), gsl_cspline[i])
     TEST_REAL_SIMILAR(akima_interpolation.evaluate(x), gsl_akima[i])
   }
+
+  // all at once (the target points are sorted, add some beyond the borders)
+  std::vector<double> values(gsl_target_points);
+  for (Size i = 0; i < base_data.size(); ++i)
+  {
+    values.push_back(base_data[i].first);
+  }
+  std::sort(values.begin(), values.end());
+  values.insert(values.begin(), values.front() - 10.0);
+  values.push_back(values.back() + 10.0);
+
+  std::vector<double> results(values.size());
+  linear_interpolation.evaluate(&values[0], &results[0], values.size());
+  for (Size i = 0; i < values.size(); ++i)
+  {
+    TEST_REAL_SIMILAR(results[i], linear_interpolation.evaluate(values[i]))
+  }
+  cspline_interpolation.evaluate(&values[0], &results[0], values.size());
+  for (Size i = 0; i < values.size(); ++i)
+  {
+    TEST_REAL_SIMILAR(results[i], cspline_interpolation.evaluate(values[i]))
+  }
+  akima_interpolation.evaluate(&values[0], &results[0], values.size());
+  for (Size i = 0; i < values.size(); ++i)
+  {
+    TEST_REAL_SIMILAR(results[i], akima_interpolation.evaluate(values[i]))
+  }
+
+  // unsorted, in place
+  std::reverse(values.begin(), values.end());
+  results = values;
+  cspline_interpolation.evaluate(&results[0], &results[0], results.size());
+  for (Size i = 0; i < values.size(); ++i)
+  {
+    TEST_REAL_SIMILAR(results[i], cspline_interpolation.evaluate(values[i]))
+  }
 }
 END_SECTION
 
@@ -87,6 +87,24 @@ START_SECTION((virtual double evaluate(double value) const))
 }
 END_SECTION
 
+START_SECTION((virtual void evaluate(const double* in, double* out, size_t n) const))
+{
+  Param params;
+  params.setValue("slope", 2.0);
+  params.setValue("intercept", 1.0);
+  TransformationModelLinear tm(empty, params);
+
+  // unsorted, in place
+  double values[] = {1.0, -0.5, 1.5, 0.0, 0.5};
+  tm.evaluate(values, values, 5);
+  TEST_REAL_SIMILAR(values[0], 3.0);
+  TEST_REAL_SIMILAR(values[1], 0.0);
+  TEST_REAL_SIMILAR(values[2], 4.0);
+  TEST_REAL_SIMILAR(values[3], 1.0);
+  TEST_REAL_SIMILAR(values[4], 2.0);
+}
+END_SECTION
+
 START_SECTION((void getParameters(Param & params) const))
 {
   Param p_in;
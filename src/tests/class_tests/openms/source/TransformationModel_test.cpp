@@ -81,6 +81,22 @@ START_SECTION((virtual double evaluate(double value) const))
 }
 END_SECTION
 
+START_SECTION((virtual void evaluate(const double* in, double* out, size_t n) const))
+{
+  TransformationModel tm;
+  double values[] = {-3.14159, 0.0, 12345678.9};
+  double results[3];
+  tm.evaluate(values, results, 3);
+  TEST_REAL_SIMILAR(results[0], -3.14159);
+  TEST_REAL_SIMILAR(results[1], 0.0);
+  TEST_REAL_SIMILAR(results[2], 12345678.9);
+  // in place
+  tm.evaluate(values, values, 3);
+  TEST_REAL_SIMILAR(values[2], 12345678.9);
+  tm.evaluate(values, results, 0);
+}
+END_SECTION
+
 START_SECTION((void getParameters(Param & params) const))
 {
   TransformationModel tm;
@@ -0,0 +1,229 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+
+///////////////////////////
+#include <OpenMS/VISUAL/LayerDataLoader.h>
+///////////////////////////
+
+#include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/FORMAT/SpectrumMetaIndex.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <QtGui/QApplication>
+
+using namespace OpenMS;
+using namespace std;
+
+class LayerDataLoaderTest :
+  public LayerDataLoader
+{
+public:
+  LayerDataLoaderTest(const String& filename, Size preview_size) :
+    LayerDataLoader(filename, FileTypes::MZML, preview_size)
+  {
+  }
+
+  /// Loads the file like start(), but in the calling thread
+  void loadInBackgroundMode()
+  {
+    load_(true);
+  }
+
+  bool loadOverview()
+  {
+    return loadOverview_();
+  }
+};
+
+START_TEST(LayerDataLoader, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+// the preview is announced through the event loop
+QApplication app(argc, argv, false);
+
+// MS1 spectra at RT 10, 30, 40 and an MS2 spectrum at RT 20, stored as indexed mzML with and without SpectrumMetaIndex
+MSExperiment<> exp;
+for (Size s = 0; s < 4; ++s)
+{
+  MSSpectrum<> spec;
+  spec.setRT(10.0 + 10.0 * s);
+  spec.setMSLevel(s == 1 ? 2 : 1);
+  spec.setNativeID(String("spectrum=") + s);
+  if (s == 1)
+  {
+    Precursor precursor;
+    precursor.setMZ(500.0);
+    precursor.setCharge(2);
+    spec.getPrecursors().push_back(precursor);
+  }
+  for (Size p = 0; p < 3; ++p)
+  {
+    Peak1D peak;
+    peak.setMZ(100.0 + 50.0 * p);
+    peak.setIntensity(10.0 * s + p);
+    spec.push_back(peak);
+  }
+  exp.addSpectrum(spec);
+}
+
+String indexed_file, plain_file;
+NEW_TMP_FILE(indexed_file)
+NEW_TMP_FILE(plain_file)
+{
+  MzMLFile f;
+  f.getOptions().setWriteIndex(true);
+  f.store(plain_file, exp);
+  f.getOptions().setWriteSpectrumMetaIndex(true);
+  f.store(indexed_file, exp);
+}
+
+LayerDataLoader* ptr = 0;
+LayerDataLoader* null_ptr = 0;
+START_SECTION((LayerDataLoader(const String& filename, FileTypes::Type type, Size preview_size=0, QObject* parent=0)))
+{
+  ptr = new LayerDataLoader(indexed_file, FileTypes::MZML);
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->getFilename(), indexed_file)
+  TEST_EQUAL(ptr->isFinished(), false)
+  TEST_EQUAL(ptr->isCanceled(), false)
+  TEST_EQUAL(ptr->getDataType(), LayerData::DT_UNKNOWN)
+}
+END_SECTION
+
+START_SECTION((~LayerDataLoader()))
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION((void run()))
+{
+  LayerDataLoader loader(indexed_file, FileTypes::MZML, 2);
+  loader.run();
+  TEST_EQUAL(loader.isFinished(), true)
+  TEST_EQUAL(loader.getErrorMessage(), "")
+  TEST_EQUAL(loader.getDataType(), LayerData::DT_PEAK)
+  TEST_EQUAL(loader.getPeakMap()->size(), 4)
+  TEST_EQUAL(loader.getPreview().get() == 0, true) // no preview when loading in the calling thread
+
+  LayerDataLoader missing(indexed_file + ".missing", FileTypes::MZML);
+  missing.run();
+  TEST_NOT_EQUAL(missing.getErrorMessage(), "")
+}
+END_SECTION
+
+START_SECTION((void cancel()))
+{
+  LayerDataLoaderTest loader(indexed_file, 2);
+  loader.cancel();
+  TEST_EQUAL(loader.isCanceled(), true)
+  loader.loadInBackgroundMode();
+  TEST_EQUAL(loader.getErrorMessage(), "")
+  TEST_EQUAL(loader.getPeakMap()->size(), 0)
+  TEST_EQUAL(loader.getPreview().get() == 0, true)
+}
+END_SECTION
+
+START_SECTION((ExperimentSharedPtrType getPreview() const))
+{
+  // the preview is taken through the index
+  LayerDataLoaderTest loader(indexed_file, 3);
+  loader.loadInBackgroundMode();
+  TEST_EQUAL(loader.getErrorMessage(), "")
+  TEST_EQUAL(loader.getDataType(), LayerData::DT_PEAK)
+  TEST_EQUAL(loader.getPeakMap()->size(), 4)
+  ABORT_IF(loader.getPreview().get() == 0)
+  TEST_EQUAL(loader.getPreview()->size(), 3)
+
+  // the first spectra of the file without SpectrumMetaIndex
+  LayerDataLoaderTest plain_loader(plain_file, 2);
+  plain_loader.loadInBackgroundMode();
+  TEST_EQUAL(plain_loader.getPeakMap()->size(), 4)
+  ABORT_IF(plain_loader.getPreview().get() == 0)
+  TEST_EQUAL(plain_loader.getPreview()->size(), 2)
+  TEST_REAL_SIMILAR((*plain_loader.getPreview())[1].getRT(), 20.0)
+}
+END_SECTION
+
+START_SECTION([EXTRA] bool loadOverview_())
+{
+  LayerDataLoaderTest loader(indexed_file, 3);
+  TEST_EQUAL(loader.loadOverview(), true)
+  ABORT_IF(loader.getPreview().get() == 0)
+  const LayerDataLoader::ExperimentType& preview = *loader.getPreview();
+  TEST_EQUAL(preview.size(), 3)
+  for (Size i = 0; i < preview.size(); ++i)
+  {
+    TEST_REAL_SIMILAR(preview[i].getRT(), exp[i].getRT())
+    TEST_EQUAL(preview[i].getMSLevel(), exp[i].getMSLevel())
+    TEST_EQUAL(preview[i].size(), exp[i].size())
+    TEST_REAL_SIMILAR(preview[i][2].getMZ(), 200.0)
+    TEST_REAL_SIMILAR(preview[i][2].getIntensity(), exp[i][2].getIntensity())
+  }
+  TEST_EQUAL(preview[1].getPrecursors().size(), 1)
+  TEST_REAL_SIMILAR(preview[1].getPrecursors()[0].getMZ(), 500.0)
+  TEST_EQUAL(preview[1].getPrecursors()[0].getCharge(), 2)
+
+  // every other spectrum
+  LayerDataLoaderTest loader2(indexed_file, 2);
+  TEST_EQUAL(loader2.loadOverview(), true)
+  ABORT_IF(loader2.getPreview().get() == 0)
+  TEST_EQUAL(loader2.getPreview()->size(), 2)
+  TEST_REAL_SIMILAR((*loader2.getPreview())[1].getRT(), 30.0)
+
+  // not more spectra than the preview
+  LayerDataLoaderTest too_small(indexed_file, 4);
+  TEST_EQUAL(too_small.loadOverview(), false)
+  TEST_EQUAL(too_small.getPreview().get() == 0, true)
+
+  // no SpectrumMetaIndex
+  LayerDataLoaderTest no_index(plain_file, 2);
+  TEST_EQUAL(no_index.loadOverview(), false)
+  TEST_EQUAL(no_index.getPreview().get() == 0, true)
+
+  // canceled before the first spectrum
+  LayerDataLoaderTest canceled(indexed_file, 2);
+  canceled.cancel();
+  TEST_EQUAL(canceled.loadOverview(), true)
+  TEST_EQUAL(canceled.getPreview().get() == 0, true)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
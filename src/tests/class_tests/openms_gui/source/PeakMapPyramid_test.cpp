@@ -0,0 +1,272 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+
+///////////////////////////
+#include <OpenMS/VISUAL/PeakMapPyramid.h>
+///////////////////////////
+
+#include <fstream>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(PeakMapPyramid, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+// MS1 spectra at RT 10, 20, 40, 50 with peaks at m/z 100-200 and an MS2 spectrum at RT 30
+PeakMapPyramid::ExperimentSharedPtrType exp(new PeakMapPyramid::ExperimentType());
+for (Size s = 0; s < 5; ++s)
+{
+  MSSpectrum<> spec;
+  spec.setRT(10.0 + 10.0 * s);
+  spec.setMSLevel(s == 2 ? 2 : 1);
+  for (Size p = 0; p < 5; ++p)
+  {
+    Peak1D peak;
+    peak.setMZ(100.0 + 25.0 * p);
+    peak.setIntensity(s == 2 ? 1000.0 : 10.0 * s + p);
+    spec.push_back(peak);
+  }
+  exp->addSpectrum(spec);
+}
+
+PeakMapPyramid* ptr = 0;
+PeakMapPyramid* null_ptr = 0;
+START_SECTION((PeakMapPyramid(Size max_rt_bins=2048, Size max_mz_bins=4096)))
+{
+  ptr = new PeakMapPyramid();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->isReady(), false)
+  TEST_EQUAL(ptr->getNumberOfLevels(), 0)
+}
+END_SECTION
+
+START_SECTION((~PeakMapPyramid()))
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION((void build(const ExperimentType &map)))
+{
+  PeakMapPyramid pyramid(4, 4);
+  pyramid.build(*exp);
+  TEST_EQUAL(pyramid.isReady(), true)
+  TEST_EQUAL(pyramid.getNumberOfLevels(), 3)
+  TEST_REAL_SIMILAR(pyramid.getMinRT(), 10.0)
+  TEST_REAL_SIMILAR(pyramid.getMinMZ(), 100.0)
+
+  const PeakMapPyramid::Level& base = pyramid.getLevel(0);
+  TEST_EQUAL(base.rt_bins, 4)
+  TEST_EQUAL(base.mz_bins, 4)
+  TEST_REAL_SIMILAR(base.rt_bin_size, 10.0)
+  TEST_REAL_SIMILAR(base.mz_bin_size, 25.0)
+  // RT 10, 20, 40 -> bins 0, 1, 3 (RT 50 is clamped to the last bin)
+  TEST_REAL_SIMILAR(base.data[0], 0.0)
+  TEST_REAL_SIMILAR(base.data[3], 4.0) // m/z 175 and 200 share the last bin
+  TEST_REAL_SIMILAR(base.data[4], 10.0)
+  TEST_EQUAL(base.data[8] < 0.0, true) // no MS1 spectrum in this bin
+  TEST_REAL_SIMILAR(base.data[15], 44.0)
+
+  const PeakMapPyramid::Level& level1 = pyramid.getLevel(1);
+  TEST_EQUAL(level1.rt_bins, 2)
+  TEST_EQUAL(level1.mz_bins, 2)
+  TEST_REAL_SIMILAR(level1.rt_bin_size, 20.0)
+  TEST_REAL_SIMILAR(level1.data[0], 11.0)
+  TEST_REAL_SIMILAR(level1.data[3], 44.0)
+
+  const PeakMapPyramid::Level& level2 = pyramid.getLevel(2);
+  TEST_EQUAL(level2.rt_bins, 1)
+  TEST_EQUAL(level2.mz_bins, 1)
+  TEST_REAL_SIMILAR(level2.data[0], 44.0) // MS2 peaks are ignored
+
+  PeakMapPyramid empty;
+  empty.build(PeakMapPyramid::ExperimentType());
+  TEST_EQUAL(empty.isReady(), true)
+  TEST_EQUAL(empty.getNumberOfLevels(), 0)
+}
+END_SECTION
+
+START_SECTION((void buildAsync(ExperimentSharedPtrType map, const String &data_file="", const String &cache_file="")))
+{
+  PeakMapPyramid pyramid(4, 4);
+  pyramid.buildAsync(exp);
+  pyramid.cancel();
+  pyramid.buildAsync(exp);
+  while (!pyramid.isReady()) {}
+  TEST_EQUAL(pyramid.getNumberOfLevels(), 3)
+  TEST_REAL_SIMILAR(pyramid.getLevel(2).data[0], 44.0)
+}
+END_SECTION
+
+START_SECTION((void cancel()))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((bool isReady() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((Size getNumberOfLevels() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((const Level& getLevel(Size index) const))
+{
+  PeakMapPyramid pyramid(4, 4);
+  pyramid.build(*exp);
+  TEST_EQUAL(pyramid.getLevel(0).data.size(), 16)
+  TEST_EXCEPTION(Exception::IndexOverflow, pyramid.getLevel(3))
+}
+END_SECTION
+
+START_SECTION((double getMinRT() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((double getMinMZ() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((SignedSize findLevel(double rt_step, double mz_step) const))
+{
+  PeakMapPyramid pyramid(4, 4);
+  TEST_EQUAL(pyramid.findLevel(100.0, 100.0), -1) // not ready
+  pyramid.build(*exp);
+  TEST_EQUAL(pyramid.findLevel(5.0, 100.0), -1)
+  TEST_EQUAL(pyramid.findLevel(10.0, 25.0), 0)
+  TEST_EQUAL(pyramid.findLevel(30.0, 60.0), 1)
+  TEST_EQUAL(pyramid.findLevel(30.0, 20.0), -1)
+  TEST_EQUAL(pyramid.findLevel(100.0, 100.0), 2)
+}
+END_SECTION
+
+START_SECTION((float getMaximum(Size level, double rt_start, double rt_end, double mz_start, double mz_end) const))
+{
+  PeakMapPyramid pyramid(4, 4);
+  pyramid.build(*exp);
+  TEST_REAL_SIMILAR(pyramid.getMaximum(0, 0.0, 1000.0, 0.0, 1000.0), 44.0)
+  TEST_REAL_SIMILAR(pyramid.getMaximum(0, 10.0, 20.0, 100.0, 150.0), 1.0)
+  TEST_REAL_SIMILAR(pyramid.getMaximum(0, 10.0, 30.0, 100.0, 125.0), 10.0)
+  TEST_EQUAL(pyramid.getMaximum(0, 30.0, 40.0, 100.0, 200.0) < 0.0, true)
+  TEST_REAL_SIMILAR(pyramid.getMaximum(1, 0.0, 30.0, 0.0, 1000.0), 14.0)
+  TEST_EQUAL(pyramid.getMaximum(0, 1000.0, 2000.0, 100.0, 200.0) < 0.0, true)
+}
+END_SECTION
+
+START_SECTION((static String getCacheFilename(const String &data_file)))
+{
+  TEST_EQUAL(PeakMapPyramid::getCacheFilename("test.mzML"), "test.mzML.pyramid")
+}
+END_SECTION
+
+START_SECTION((bool store(const String &filename, const String &data_file) const))
+{
+  String data_file, cache_file;
+  NEW_TMP_FILE(data_file)
+  NEW_TMP_FILE(cache_file)
+  {
+    std::ofstream ofs(data_file.c_str());
+    ofs << "data";
+  }
+
+  PeakMapPyramid pyramid(4, 4);
+  TEST_EQUAL(pyramid.store(cache_file, data_file), false) // not ready
+  pyramid.build(*exp);
+  TEST_EQUAL(pyramid.store(cache_file, data_file), true)
+  TEST_EQUAL(pyramid.store(cache_file, "does_not_exist.mzML"), false)
+}
+END_SECTION
+
+START_SECTION((bool load(const String &filename, const String &data_file)))
+{
+  String data_file, cache_file;
+  NEW_TMP_FILE(data_file)
+  NEW_TMP_FILE(cache_file)
+  {
+    std::ofstream ofs(data_file.c_str());
+    ofs << "data";
+  }
+
+  PeakMapPyramid pyramid(4, 4);
+  pyramid.build(*exp);
+  pyramid.store(cache_file, data_file);
+
+  PeakMapPyramid loaded(4, 4);
+  TEST_EQUAL(loaded.load(cache_file, data_file), true)
+  TEST_EQUAL(loaded.isReady(), true)
+  TEST_EQUAL(loaded.getNumberOfLevels(), 3)
+  TEST_REAL_SIMILAR(loaded.getMinRT(), 10.0)
+  TEST_REAL_SIMILAR(loaded.getMinMZ(), 100.0)
+  for (Size i = 0; i < loaded.getNumberOfLevels(); ++i)
+  {
+    TEST_EQUAL(loaded.getLevel(i).rt_bins, pyramid.getLevel(i).rt_bins)
+    TEST_EQUAL(loaded.getLevel(i).mz_bins, pyramid.getLevel(i).mz_bins)
+    TEST_EQUAL(loaded.getLevel(i).data == pyramid.getLevel(i).data, true)
+  }
+
+  // outdated cache (the data file changed)
+  {
+    std::ofstream ofs(data_file.c_str());
+    ofs << "modified data";
+  }
+  PeakMapPyramid outdated(4, 4);
+  TEST_EQUAL(outdated.load(cache_file, data_file), false)
+  TEST_EQUAL(outdated.isReady(), false)
+
+  // no cache file
+  TEST_EQUAL(outdated.load(cache_file + "_missing", data_file), false)
+  // not a cache file
+  TEST_EQUAL(outdated.load(data_file, data_file), false)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -0,0 +1,125 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+
+///////////////////////////
+#include <OpenMS/VISUAL/TOPPASToolVertex.h>
+///////////////////////////
+
+#include <OpenMS/VISUAL/TOPPASScene.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <QtGui/QApplication>
+
+#include <fstream>
+
+using namespace OpenMS;
+using namespace std;
+
+class TOPPASToolVertexTest :
+  public TOPPASToolVertex
+{
+public:
+  TOPPASToolVertexTest(const String& name) :
+    TOPPASToolVertex(name)
+  {
+  }
+
+  QString computeCacheKey(const Param& param)
+  {
+    return computeCacheKey_(param, RoundPackage(), RoundPackage());
+  }
+};
+
+void writeFile(const String& filename, const String& content)
+{
+  ofstream out(filename.c_str());
+  out << content;
+}
+
+START_TEST(TOPPASToolVertex, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+// the tool (PeptideIndexer) is queried for its parameters, so it has to be built next to this test
+QApplication app(argc, argv, false);
+TOPPASScene scene(0, File::getTempDirectory().toQString(), false);
+
+START_SECTION([EXTRA] QString computeCacheKey_(const Param& param, const RoundPackage& inputs, const RoundPackage& outputs))
+{
+  TOPPASToolVertexTest* tv = new TOPPASToolVertexTest("PeptideIndexer");
+  scene.addVertex(tv);
+
+  String fasta, other_fasta;
+  NEW_TMP_FILE(fasta)
+  NEW_TMP_FILE(other_fasta)
+  writeFile(fasta, ">P1\nPEPTIDEK\n");
+  writeFile(other_fasta, ">P1\nPEPTIDEK\n");
+
+  Param param = tv->getParam();
+  param.setValue("fasta", fasta);
+  QString key = tv->computeCacheKey(param);
+  TEST_EQUAL(key.isEmpty(), false)
+  TEST_EQUAL(tv->computeCacheKey(param) == key, true)
+
+  // parameters which do not affect the results
+  Param param_debug = param;
+  param_debug.setValue("debug", 5);
+  param_debug.setValue("threads", 4);
+  TEST_EQUAL(tv->computeCacheKey(param_debug) == key, true)
+
+  // other parameters
+  Param param_decoy = param;
+  param_decoy.setValue("decoy_string", "DECOY_");
+  TEST_EQUAL(tv->computeCacheKey(param_decoy) == key, false)
+
+  // the database is not fed by an edge: its path ...
+  Param param_other = param;
+  param_other.setValue("fasta", other_fasta);
+  TEST_EQUAL(tv->computeCacheKey(param_other) == key, false)
+
+  // ... and its content are part of the key
+  writeFile(fasta, ">P1\nPEPTIDEKR\n>P2\nAAAAK\n");
+  QString changed_key = tv->computeCacheKey(param);
+  TEST_EQUAL(changed_key == key, false)
+  writeFile(fasta, ">P1\nPEPTIDEK\n");
+  TEST_EQUAL(tv->computeCacheKey(param) == key, true)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -36,6 +36,9 @@
 
 #include "OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/ALGO/Scoring.h"
 
+#include <algorithm>
+#include <cmath>
+
 #ifdef USE_BOOST_UNIT_TEST
 
 // include boost unit test framework
@@ -242,6 +245,90 @@ BOOST_AUTO_TEST_CASE(test_MRMFeatureScoring_normalizedCrossCorrelation)
 }
 END_SECTION
 
+BOOST_AUTO_TEST_CASE(test_calculateCrossCorrelationDense)
+//START_SECTION((void calculateCrossCorrelationDense(const double* data1, const double* data2, int n, int maxdelay, double* result)))
+{
+  static const double arr1[] = {0,1,3,5,2,0};
+  static const double arr2[] = {1,3,5,2,0,0};
+  std::vector<double> data1 (arr1, arr1 + sizeof(arr1) / sizeof(arr1[0]) );
+  std::vector<double> data2 (arr2, arr2 + sizeof(arr2) / sizeof(arr2[0]) );
+
+  Scoring::standardize_data(data1);
+  Scoring::standardize_data(data2);
+
+  // same values as test_calculateCrossCorrelation, lag d is stored at d + maxdelay
+  std::vector<double> result(5);
+  Scoring::calculateCrossCorrelationDense(&data1[0], &data2[0], 6, 2, &result[0]);
+  TEST_REAL_SIMILAR (result[4] / 6.0, -0.7374631);
+  TEST_REAL_SIMILAR (result[3] / 6.0, -0.567846);
+  TEST_REAL_SIMILAR (result[2] / 6.0,  0.4159292);
+  TEST_REAL_SIMILAR (result[1] / 6.0,  0.8215339);
+  TEST_REAL_SIMILAR (result[0] / 6.0,  0.15634218);
+
+  // all lags (no overlap at the outermost ones)
+  result.resize(13);
+  Scoring::calculateCrossCorrelationDense(&data1[0], &data2[0], 6, 6, &result[0]);
+  std::map<int, double> expected = Scoring::calculateCrossCorrelation(data1, data2, 6, 1);
+  for (int k = 0; k < 13; k++)
+  {
+    TEST_REAL_SIMILAR (result[k] + 1.0, expected[k - 6] + 1.0);
+  }
+  TEST_EQUAL (result[0], 0.0)
+  TEST_EQUAL (result[12], 0.0)
+}
+END_SECTION
+
+BOOST_AUTO_TEST_CASE(test_xcorrArrayGetMaxPeakDense)
+//START_SECTION((std::pair<int, double> xcorrArrayGetMaxPeak(const double* array, int maxdelay)))
+{
+  static const double arr[] = {0.1, 0.8, 0.3, 0.8, -0.2};
+  std::pair<int, double> peak = Scoring::xcorrArrayGetMaxPeak(arr, 2);
+  TEST_EQUAL (peak.first, -1) // first maximum, as in the map-based version
+  TEST_REAL_SIMILAR (peak.second, 0.8)
+}
+END_SECTION
+
+BOOST_AUTO_TEST_CASE(test_crossCorrelationDense_consistency)
+{
+  // the dense engine finds the same maxima as the map-based one (all pairs i <= j of
+  // a group of 6 traces, as in MRMScoring); the values agree up to rounding, since
+  // the inner products are summed in a different order
+  const int nr_traces = 6, n = 30;
+  std::vector<std::vector<double> > traces(nr_traces, std::vector<double>(n));
+  unsigned int seed = 42;
+  for (int t = 0; t < nr_traces; t++)
+  {
+    for (int k = 0; k < n; k++)
+    {
+      seed = seed * 1103515245 + 12345; // deterministic pseudo-random numbers
+      traces[t][k] = (seed >> 16) % 1000 + 1000.0 * std::exp(-(k - 15.0) * (k - 15.0) / 20.0);
+    }
+  }
+
+  std::vector<double> standardized(nr_traces * n), array(2 * n + 1);
+  for (int i = 0; i < nr_traces; i++)
+  {
+    std::vector<double> data = traces[i];
+    Scoring::standardize_data(data);
+    std::copy(data.begin(), data.end(), standardized.begin() + i * n);
+  }
+  for (int i = 0; i < nr_traces; i++)
+  {
+    for (int j = i; j < nr_traces; j++)
+    {
+      std::vector<double> data1 = traces[i], data2 = traces[j];
+      Scoring::XCorrArrayType res = Scoring::normalizedCrossCorrelation(data1, data2, n, 1);
+      Scoring::XCorrArrayType::iterator expected = Scoring::xcorrArrayGetMaxPeak(res);
+
+      Scoring::calculateCrossCorrelationDense(&standardized[i * n], &standardized[j * n], n, n, &array[0]);
+      std::pair<int, double> max_peak = Scoring::xcorrArrayGetMaxPeak(&array[0], n);
+      TEST_EQUAL (max_peak.first, expected->first)
+      TEST_REAL_SIMILAR (max_peak.second / n, expected->second)
+    }
+  }
+}
+END_SECTION
+
 BOOST_AUTO_TEST_CASE(test_MRMFeatureScoring_calcxcorr_legacy_mquest_)
 //START_SECTION((MRMFeatureScoring::XCorrArrayType MRMFeatureScoring::calcxcorr(std::vector<double>& data1, std::vector<double>& data2, bool normalize)))
 {
@@ -41,6 +41,7 @@
 #include <OpenMS/ANALYSIS/ID/ConsensusIDAlgorithmAverage.h>
 #include <OpenMS/ANALYSIS/ID/ConsensusIDAlgorithmRanks.h>
 #include <OpenMS/ANALYSIS/MAPMATCHING/FeatureGroupingAlgorithmQT.h>
+#include <OpenMS/CONCEPT/ParallelExceptionCollector.h>
 #include <OpenMS/CONCEPT/VersionInfo.h>
 #include <OpenMS/FORMAT/IdXMLFile.h>
 #include <OpenMS/FORMAT/FeatureXMLFile.h>
@@ -138,6 +139,7 @@ public:
 protected:
 
   String algorithm_; // algorithm for consensus calculation (input parameter)
+  Param algo_params_; // parameters for the consensus algorithm
 
   void registerOptionsAndFlags_()
   {
@@ -202,9 +204,70 @@ protected:
   }
 
   
+  ConsensusIDAlgorithm* createAlgorithm_() const
+  {
+    ConsensusIDAlgorithm* consensus;
+    if (algorithm_ == "PEPMatrix")
+    {
+      consensus = new ConsensusIDAlgorithmPEPMatrix();
+    }
+    else if (algorithm_ == "PEPIons")
+    {
+      consensus = new ConsensusIDAlgorithmPEPIons();
+    }
+    else if (algorithm_ == "best")
+    {
+      consensus = new ConsensusIDAlgorithmBest();
+    }
+    else if (algorithm_ == "average")
+    {
+      consensus = new ConsensusIDAlgorithmAverage();
+    }
+    else // algorithm_ == "ranks"
+    {
+      consensus = new ConsensusIDAlgorithmRanks();
+    }
+    consensus->setParameters(algo_params_);
+    return consensus;
+  }
+
+
+  /// Compute consensus for groups of peptide IDs (in parallel, if possible)
+  void applyConsensus_(vector<vector<PeptideIdentification>*>& id_groups,
+                       const vector<Size>& number_of_runs)
+  {
+    // the groups are independent, but the similarity-based algorithms cache
+    // results internally - so every thread gets its own algorithm instance:
+    ParallelExceptionCollector errors;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+      ConsensusIDAlgorithm* consensus = 0;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 100)
+#endif
+      for (SignedSize i = 0; i < (SignedSize)id_groups.size(); ++i)
+      {
+        if (errors.hasErrorBefore(i)) continue;
+        try
+        {
+          if (!consensus) consensus = createAlgorithm_();
+          consensus->apply(*id_groups[i], number_of_runs[i]);
+        }
+        catch (...) // exceptions must not leave the parallel region
+        {
+          errors.capture(i);
+        }
+      }
+      delete consensus;
+    }
+    errors.rethrow();
+  }
+
+
   template <typename MapType>
-  void processFeatureOrConsensusMap_(MapType& input_map,
-                                     ConsensusIDAlgorithm* consensus)
+  void processFeatureOrConsensusMap_(MapType& input_map)
   {
     // Problem with feature data: IDs from multiple spectra may be attached to
     // a (consensus) feature, so we may have multiple IDs from the same search
@@ -222,6 +285,10 @@ protected:
     }
 
     // compute consensus:
+    vector<vector<PeptideIdentification>*> id_groups;
+    vector<Size> n_runs;
+    id_groups.reserve(input_map.size());
+    n_runs.reserve(input_map.size());
     for (typename MapType::Iterator map_it = input_map.begin();
          map_it != input_map.end(); ++map_it)
     {
@@ -234,8 +301,10 @@ protected:
       }
       Size n_repeats = *max_element(times_seen.begin(), times_seen.end());
 
-      consensus->apply(ids, number_of_runs * n_repeats);
+      id_groups.push_back(&ids);
+      n_runs.push_back(number_of_runs * n_repeats);
     }
+    applyConsensus_(id_groups, n_runs);
 
     // create new identification run:
     setProteinIdentifications_(input_map.getProteinIdentifications());
@@ -255,36 +324,17 @@ protected:
     //----------------------------------------------------------------
     // set up ConsensusID
     //----------------------------------------------------------------
-    ConsensusIDAlgorithm* consensus;
     // general algorithm parameters:
-    Param algo_params = ConsensusIDAlgorithmBest().getDefaults();
+    algo_params_ = ConsensusIDAlgorithmBest().getDefaults();
     algorithm_ = getStringOption_("algorithm");
-    if (algorithm_ == "PEPMatrix")
-    {
-      consensus = new ConsensusIDAlgorithmPEPMatrix();
-      // add algorithm-specific parameters:
-      algo_params.merge(getParam_().copy("PEPMatrix:", true));
-    }
-    else if (algorithm_ == "PEPIons")
+    if ((algorithm_ == "PEPMatrix") || (algorithm_ == "PEPIons"))
     {
-      consensus = new ConsensusIDAlgorithmPEPIons();
       // add algorithm-specific parameters:
-      algo_params.merge(getParam_().copy("PEPIons:", true));
+      algo_params_.merge(getParam_().copy(algorithm_ + ":", true));
     }
-    else if (algorithm_ == "best")
-    {
-      consensus = new ConsensusIDAlgorithmBest();
-    }
-    else if (algorithm_ == "average")
-    {
-      consensus = new ConsensusIDAlgorithmAverage();
-    }
-    else // algorithm_ == "ranks"
-    {
-      consensus = new ConsensusIDAlgorithmRanks();
-    }
-    algo_params.update(getParam_(), false, Log_debug); // update general params.
-    consensus->setParameters(algo_params);
+    algo_params_.update(getParam_(), false, Log_debug); // update general params.
+    // check parameters before doing any work:
+    delete createAlgorithm_();
 
     //----------------------------------------------------------------
     // idXML
@@ -343,11 +393,20 @@ protected:
       linker.group(maps, grouping);
 
       // compute consensus
+      vector<vector<PeptideIdentification>*> id_groups;
+      id_groups.reserve(grouping.size());
+      for (ConsensusMap::Iterator it = grouping.begin(); it != grouping.end();
+           ++it)
+      {
+        id_groups.push_back(&(it->getPeptideIdentifications()));
+      }
+      applyConsensus_(id_groups, vector<Size>(id_groups.size(), 
+                                              prot_ids.size()));
+
       pep_ids.clear();
       for (ConsensusMap::Iterator it = grouping.begin(); it != grouping.end();
            ++it)
       {
-        consensus->apply(it->getPeptideIdentifications(), prot_ids.size());
         if (!it->getPeptideIdentifications().empty())
         {
           PeptideIdentification& pep_id = it->getPeptideIdentifications()[0];
@@ -373,7 +432,7 @@ protected:
       FeatureMap map;
       FeatureXMLFile().load(in, map);
 
-      processFeatureOrConsensusMap_(map, consensus);
+      processFeatureOrConsensusMap_(map);
 
       FeatureXMLFile().store(out, map);
     }
@@ -386,13 +445,11 @@ protected:
       ConsensusMap map;
       ConsensusXMLFile().load(in, map);
 
-      processFeatureOrConsensusMap_(map, consensus);
+      processFeatureOrConsensusMap_(map);
 
       ConsensusXMLFile().store(out, map);
     }
 
-    delete consensus;
-
     return EXECUTION_OK;
   }
 
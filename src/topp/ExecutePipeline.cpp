@@ -58,6 +58,11 @@ using namespace std;
   In order to really use this tool in batch-mode, you can provide a TOPPAS resource file (.trf) which specifies the
   input files for the input nodes in your pipeline.
 
+  Tools are run in parallel as far as @p num_jobs permits. Tools with many pending successors are started first, and a tool
+  set to use several threads (parameter @p threads) occupies that many jobs. When re-running a pipeline with only a few
+  changed parameters, use @p cache_dir: the results of a tool are then reused as long as the tool, its parameters and the
+  content of its input files are the same.
+
   <B> *.trf files </B>
 
  A TOPPAS resource file (<TT>*.trf</TT>) specifies the locations of input files for a pipeline.
@@ -108,8 +113,9 @@ protected:
     setValidFormats_("in", ListUtils::create<String>("toppas"));
     registerStringOption_("out_dir", "<directory>", "", "Directory for output files (default: user's home directory)", false);
     registerStringOption_("resource_file", "<file>", "", "A TOPPAS resource file (*.trf) specifying the files this workflow is to be applied to", false);
-    registerIntOption_("num_jobs", "<integer>", 1, "Maximum number of jobs running in parallel", false, false);
+    registerIntOption_("num_jobs", "<integer>", 1, "Maximum number of jobs running in parallel (a tool using several threads counts as several jobs)", false, false);
     setMinInt_("num_jobs", 1);
+    registerStringOption_("cache_dir", "<directory>", "", "Directory for cached tool results. Tools whose parameters and input files did not change since an earlier run are not run again, their results are taken from the cache.", false);
   }
 
   ExitCodes main_(int argc, const char ** argv)
@@ -118,6 +124,7 @@ protected:
     QString out_dir_name = getStringOption_("out_dir").toQString();
     QString resource_file = getStringOption_("resource_file").toQString();
     int num_jobs = getIntOption_("num_jobs");
+    QString cache_dir = getStringOption_("cache_dir").toQString();
 
     QApplication a(argc, const_cast<char **>(argv), false);
 
@@ -137,6 +144,10 @@ protected:
 
     ts.load(toppas_file);
     ts.setAllowedThreads(num_jobs);
+    if (cache_dir != "")
+    {
+      ts.setCacheDirectory(QDir(cache_dir).absolutePath());
+    }
 
     if (resource_file != "")
     {
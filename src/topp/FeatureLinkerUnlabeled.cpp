@@ -151,7 +151,28 @@ protected:
     //-------------------------------------------------------------
     // load input
     ConsensusMap out_map;
-    if (file_type == FileTypes::FEATUREXML)
+    if (file_type == FileTypes::FEATUREXML && algorithm->getParameters().getValue("merge_order") == "tree")
+    {
+      // merging in a tree needs all maps in memory
+      vector<FeatureMap> maps(ins.size());
+      FeatureXMLFile f;
+      f.getOptions().setLoadConvexHull(false);
+      f.getOptions().setLoadSubordinates(false);
+      for (Size i = 0; i < ins.size(); ++i)
+      {
+        f.load(ins[i], maps[i]);
+      }
+      algorithm->group(maps, out_map);
+
+      for (Size i = 0; i < ins.size(); ++i)
+      {
+        out_map.getFileDescriptions()[i].filename = ins[i];
+        out_map.getFileDescriptions()[i].size = maps[i].size();
+        out_map.getFileDescriptions()[i].unique_id = maps[i].getUniqueId();
+      }
+      out_map.updateRanges();
+    }
+    else if (file_type == FileTypes::FEATUREXML)
     {
       // use map with highest number of features as reference:
       Size max_count(0);
@@ -270,9 +270,12 @@ protected:
         PlainMSDataWritingConsumer consumer(out);
         consumer.getOptions().setWriteIndex(write_mzML_index);
         consumer.addDataProcessing(getProcessingInfo_(DataProcessing::CONVERSION_MZML));
+        // encode a few spectra per thread in parallel
+        consumer.setWritingWindow(4 * getIntOption_("threads"));
         MzMLFile mzmlfile; 
         mzmlfile.setLogType(log_type_);
         mzmlfile.transform(in, &consumer);
+        consumer.flush(); // report errors of the last spectra (the destructor cannot)
         return EXECUTION_OK;
       }
       else if (in_type == FileTypes::MZXML && out_type == FileTypes::MZML)
@@ -280,9 +283,12 @@ protected:
         PlainMSDataWritingConsumer consumer(out);
         consumer.getOptions().setWriteIndex(write_mzML_index);
         consumer.addDataProcessing(getProcessingInfo_(DataProcessing::CONVERSION_MZML));
+        // encode a few spectra per thread in parallel
+        consumer.setWritingWindow(4 * getIntOption_("threads"));
         MzXMLFile mzxmlfile; 
         mzxmlfile.setLogType(log_type_);
         mzxmlfile.transform(in, &consumer);
+        consumer.flush(); // report errors of the last spectra (the destructor cannot)
         return EXECUTION_OK;
       }
       else
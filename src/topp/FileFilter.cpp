@@ -41,6 +41,7 @@
 #include <OpenMS/FORMAT/FileHandler.h>
 #include <OpenMS/FORMAT/FileTypes.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/FORMAT/SpectrumMetaIndex.h>
 #include <OpenMS/FORMAT/FeatureXMLFile.h>
 #include <OpenMS/FORMAT/ConsensusXMLFile.h>
 #include <OpenMS/FILTERING/NOISEESTIMATION/SignalToNoiseEstimatorMedian.h>
@@ -106,6 +107,8 @@ using namespace std;
     MS2 and higher spectra can be filtered according to precursor m/z (see 'pc_mz'). This flag can be combined with 'rt' range to filter precursors by RT and m/z.
     If you want to extract an MS1 region with untouched MS2 spectra included, you will need to split the dataset by MS level, then use the 'mz' option for MS1 data and 'pc_mz' for MS2 data. Afterwards merge the two files again. RT can be filtered at any step.
 
+    If an up-to-date spectrum index (file extension ".smi", see 'peak_options:spectrum_index' and @ref TOPP_FileInfo) is stored next to an mzML input file, it is used to skip the spectra removed by the MS level filter, and (together with 'peak_options:no_chromatograms' or 'peak_options:remove_chromatograms') by the precursor filters ('pc_mz', 'peak_options:rm_pc_charge') and the removal of empty spectra, while loading. The data of these spectra is then never decoded. The result is the same as without the index.
+
     @note For filtering peptide/protein identification data, see the @ref TOPP_IDFilter tool.
 
     @note Currently mzIdentML (mzid) is not directly supported as an input/output format of this tool. Convert mzid files to/from idXML using @ref TOPP_IDFileConverter if necessary.
@@ -280,6 +283,7 @@ protected:
     setValidStrings_("peak_options:int_precision", ListUtils::create<String>("32,64"));
     registerStringOption_("peak_options:indexed_file", "true or false", "false", "Whether to add an index to the file when writing", false);
     setValidStrings_("peak_options:indexed_file", ListUtils::create<String>("true,false"));
+    registerFlag_("peak_options:spectrum_index", "Store a spectrum index next to the mzML output file. It speeds up later runs of FileInfo and FileFilter on that file.");
 
     registerTOPPSubsection_("peak_options:numpress", "Numpress compression for peak data");
     registerStringOption_("peak_options:numpress:masstime", "<compression_scheme>", "none", "Apply MS Numpress compression algorithms in m/z or rt dimension (recommended: linear)", false);
@@ -398,6 +402,36 @@ protected:
     return tmp;
   }
 
+  /**
+    @brief Determines the spectra of an mzML file that pass the MS level filter, using its spectrum index
+
+    If @p filter_precursors is set, spectra that are removed by the precursor charge or precursor m/z filters, and empty spectra, are excluded as well.
+    Spectra with several precursors are always included (the filters are applied again after loading anyway).
+  */
+  vector<Size> selectSpectraFromIndex_(const SpectrumMetaIndex& index, const IntList& levels, const IntList& rm_pc_charge, double pc_left, double pc_right, bool filter_precursors) const
+  {
+    vector<Size> selected;
+    for (Size i = 0; i < index.size(); ++i)
+    {
+      const SpectrumMetaIndex::Entry& entry = index.getEntries()[i];
+      if (!levels.empty() && (find(levels.begin(), levels.end(), entry.ms_level) == levels.end())) continue;
+
+      if (filter_precursors)
+      {
+        if (entry.peak_count == 0) continue;
+
+        if (entry.precursor_count == 1)
+        {
+          if (find(rm_pc_charge.begin(), rm_pc_charge.end(), entry.precursor_charge) != rm_pc_charge.end()) continue;
+
+          if (!(pc_left <= entry.precursor_mz && entry.precursor_mz <= pc_right)) continue;
+        }
+      }
+      selected.push_back(i);
+    }
+    return selected;
+  }
+
   bool checkMetaOk(const MetaInfoInterface& mi, const StringList& meta_info)
   {
     if (!mi.metaValueExists(meta_info[0])) return true; // not having the meta value means passing the test
@@ -612,9 +646,32 @@ protected:
       // numpress compression
       f.getOptions().setNumpressConfigurationMassTime(npconfig_mz);
       f.getOptions().setNumpressConfigurationIntensity(npconfig_int);
+      // spectrum index next to the output file
+      f.getOptions().setWriteSpectrumMetaIndex(getFlag_("peak_options:spectrum_index"));
+
+      // use the spectrum index of the input (if any) to skip spectra that are filtered out anyway
+      SpectrumMetaIndex index;
+      bool has_index = false;
+      try
+      {
+        has_index = index.loadSidecar(in);
+      }
+      catch (Exception::FileNotReadable& /* e */)
+      {
+        writeLog_("Warning: Could not read the spectrum index '" + SpectrumMetaIndex::getIndexFilename(in) + "'.");
+      }
+      if (has_index)
+      {
+        // precursor filters and the removal of empty spectra are only anticipated if no spectra are converted to chromatograms before
+        bool filter_precursors = no_chromatograms || getFlag_("peak_options:remove_chromatograms");
+        vector<Size> selected = selectSpectraFromIndex_(index, levels, getIntList_("peak_options:rm_pc_charge"), pc_left, pc_right, filter_precursors);
+        writeLog_(String("Using spectrum index '") + SpectrumMetaIndex::getIndexFilename(in) + "': loading " + selected.size() + " of " + index.size() + " spectra.");
+        f.getOptions().setSpectrumIndices(selected);
+      }
 
       MapType exp;
       f.load(in, exp);
+      f.getOptions().clearSpectrumIndices();
 
       // remove spectra with meta values:
       if (remove_meta_enabled)
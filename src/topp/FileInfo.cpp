@@ -46,6 +46,7 @@
 #include <OpenMS/FORMAT/MzMLFile.h>
 #include <OpenMS/FORMAT/IndexedMzMLFile.h>
 #include <OpenMS/FORMAT/PeakTypeEstimator.h>
+#include <OpenMS/FORMAT/SpectrumMetaIndex.h>
 #include <OpenMS/APPLICATIONS/TOPPBase.h>
 #include <OpenMS/DATASTRUCTURES/StringListUtils.h>
 #include <OpenMS/DATASTRUCTURES/Map.h>
@@ -94,6 +95,11 @@ using namespace std;
   @htmlinclude TOPP_FileInfo.html
 
   In order to enrich the resulting data of your analysis pipeline or to quickly compare different outcomes of your pipeline you can invoke the aforementioned information of your input data and (intermediary) results.
+
+  For large mzML files, the basic summary (number of spectra and peaks, data ranges, MS levels) can be taken from a spectrum index stored next to the file (file extension ".smi"), without parsing the file at all.
+  Such an index is written by FileFilter (flag @p peak_options:spectrum_index) or, in a single pass over the file, by FileInfo itself (flag @p spectrum_index).
+  It is used whenever it is up to date and none of the flags @p m, @p p, @p s, @p d and @p c or the option @p out_tsv are given.
+  The data ranges then include the spectra only, and the peak type can only be estimated for indexedmzML files; meta data arrays and details of chromatograms are not shown.
 */
 
 // We do not want this class to show up in the docu:
@@ -184,8 +190,29 @@ protected:
     registerFlag_("c", "Check for corrupt data in the file (peak files only)");
     registerFlag_("v", "Validate the file only (for mzML, mzData, mzXML, featureXML, idXML, consensusXML, pepXML)");
     registerFlag_("i", "Check whether a given mzML file contains valid indices (conforming to the indexedmzML standard)");
+    registerFlag_("spectrum_index", "For mzML files: Build a spectrum index (stored next to the file) if there is none yet. The summary of the spectra is then taken from the index, also in later runs.");
   }
 
+  /// Data ranges of the spectra in a SpectrumMetaIndex, with the interface used by writeRangesHumanReadable_/writeRangesMachineReadable_
+  struct IndexRanges
+  {
+    IndexRanges() :
+      min(DPosition<2>::maxPositive()),
+      max(DPosition<2>::minNegative()),
+      min_int(numeric_limits<double>::max()),
+      max_int(-numeric_limits<double>::max())
+    {
+    }
+
+    const DPosition<2>& getMin() const { return min; }
+    const DPosition<2>& getMax() const { return max; }
+    double getMinInt() const { return min_int; }
+    double getMaxInt() const { return max_int; }
+
+    DPosition<2> min, max;
+    double min_int, max_int;
+  };
+
   template <class Map>
   void writeRangesHumanReadable_(Map map, ostream& os)
   {
@@ -207,6 +234,159 @@ protected:
        << "intensity (max)" << "\t" << String::number(map.getMaxInt(), 2) << "\n";
   }
 
+  /// Writes the estimated spacing of raw data points in @p spec
+  void writeRawDataSpacing_(const MSSpectrum<Peak1D>& spec, ostream& os, ostream& os_tsv)
+  {
+    vector<float> spacing;
+    for (Size j = 1; j < spec.size(); ++j)
+    {
+      spacing.push_back(spec[j].getMZ() - spec[j - 1].getMZ());
+    }
+    sort(spacing.begin(), spacing.end());
+    os << "Estimated raw data spacing: " << spacing[spacing.size() / 2] << " (min: " << spacing[0] << ", max: " << spacing.back() << ")" << "\n";
+    os_tsv << "estimated raw data spacing" << "\t" << spacing[spacing.size() / 2] << "\n"
+           << "estimated raw data spacing (min)" << "\t" << spacing[0] << "\n"
+           << "estimated raw data spacing (max)" << "\t" << spacing.back() << "\n";
+  }
+
+  /**
+    @brief Writes the summary of the spectra of an mzML file from its spectrum index, without parsing the file
+
+    If there is no up-to-date index, it is built (and stored) if the flag 'spectrum_index' is set; otherwise nothing is written.
+
+    @return Whether the summary was written
+  */
+  bool writeSpectrumIndexSummary_(const String& in, ostream& os, ostream& os_tsv)
+  {
+    SpectrumMetaIndex index;
+    String index_file = SpectrumMetaIndex::getIndexFilename(in);
+    bool loaded = false;
+    try
+    {
+      loaded = index.loadSidecar(in);
+    }
+    catch (Exception::FileNotReadable& /* e */)
+    {
+      writeLog_("Warning: Could not read the spectrum index '" + index_file + "'.");
+    }
+    if (loaded)
+    {
+      writeLog_("Using spectrum index '" + index_file + "'.");
+    }
+    else if (getFlag_("spectrum_index"))
+    {
+      writeLog_("Building spectrum index...");
+      index.build(in);
+      try
+      {
+        index.storeSidecar(in);
+        writeLog_("Stored spectrum index in '" + index_file + "'.");
+      }
+      catch (Exception::UnableToCreateFile& /* e */)
+      {
+        writeLog_("Warning: Could not store the spectrum index in '" + index_file + "'.");
+      }
+    }
+    else
+    {
+      return false;
+    }
+    const vector<SpectrumMetaIndex::Entry>& entries = index.getEntries();
+
+    os << "\n"
+       << "Summary taken from the spectrum index (data ranges include spectra only)." << "\n";
+
+    //determine type (from the first scan with at least 5 peaks, only accessible in indexedmzML)
+    UInt type = SpectrumSettings::UNKNOWN;
+    Size i = 0;
+    while (i < entries.size() && entries[i].peak_count < 5)
+    {
+      ++i;
+    }
+    MSSpectrum<Peak1D> spec;
+    if (i != entries.size())
+    {
+      IndexedMzMLFile ifile;
+      ifile.openFile(in);
+      if (ifile.getParsingSuccess() && i < ifile.getNrSpectra())
+      {
+        OpenMS::Interfaces::SpectrumPtr sptr = ifile.getSpectrumById(i);
+        const vector<double>& mz = sptr->getMZArray()->data;
+        const vector<double>& intensity = sptr->getIntensityArray()->data;
+        for (Size j = 0; j < mz.size() && j < intensity.size(); ++j)
+        {
+          Peak1D p;
+          p.setMZ(mz[j]);
+          p.setIntensity(intensity[j]);
+          spec.push_back(p);
+        }
+        spec.sortByPosition();
+        type = PeakTypeEstimator().estimateType(spec.begin(), spec.end());
+      }
+    }
+    os << "Peak type (estimated): " << SpectrumSettings::NamesOfSpectrumType[type] << "\n";
+    //if raw data, determine the spacing
+    if (type == SpectrumSettings::RAWDATA)
+    {
+      writeRawDataSpacing_(spec, os, os_tsv);
+    }
+    os << "\n";
+
+    //basic info
+    IndexRanges ranges;
+    UInt64 peaks = 0;
+    map<Size, UInt> counts;
+    for (vector<SpectrumMetaIndex::Entry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+    {
+      ++counts[it->ms_level];
+      peaks += it->peak_count;
+      ranges.min[Peak2D::RT] = std::min(ranges.min[Peak2D::RT], it->rt);
+      ranges.max[Peak2D::RT] = std::max(ranges.max[Peak2D::RT], it->rt);
+      //do not update mz and int when the spectrum is empty
+      if (it->peak_count == 0) continue;
+      ranges.min[Peak2D::MZ] = std::min(ranges.min[Peak2D::MZ], it->min_mz);
+      ranges.max[Peak2D::MZ] = std::max(ranges.max[Peak2D::MZ], it->max_mz);
+      ranges.min_int = std::min(ranges.min_int, it->min_intensity);
+      ranges.max_int = std::max(ranges.max_int, it->max_intensity);
+    }
+
+    os << "Number of spectra: " << entries.size() << "\n";
+    os << "Number of peaks: " << peaks << "\n"
+       << "\n";
+    os_tsv << "number of spectra" << "\t" << entries.size() << "\n"
+           << "number of peaks" << "\t" << peaks << "\n";
+
+    writeRangesHumanReadable_(ranges, os);
+    writeRangesMachineReadable_(ranges, os_tsv);
+
+    os << "MS levels: ";
+    for (map<Size, UInt>::iterator it = counts.begin(); it != counts.end(); ++it)
+    {
+      if (it != counts.begin()) os << ", ";
+      os << it->first;
+    }
+    os << "\n";
+
+    //output how many spectra per MS level there are
+    if (!counts.empty())
+    {
+      os << "Number of spectra per MS level:" << "\n";
+      for (map<Size, UInt>::iterator it = counts.begin(); it != counts.end(); ++it)
+      {
+        os << "  level " << it->first << ": " << it->second << "\n";
+        os_tsv << "number of MS" << it->first << " spectra" << "\t" << it->second << "\n";
+      }
+      os << "\n";
+    }
+
+    if (index.getChromatogramCount() > 0)
+    {
+      os << "Number of chromatograms: " << index.getChromatogramCount() << "\n";
+      os_tsv << "number of chromatograms" << "\t" << index.getChromatogramCount() << "\n";
+    }
+    return true;
+  }
+
   ExitCodes outputTo_(ostream& os, ostream& os_tsv)
   {
     //-------------------------------------------------------------
@@ -570,6 +750,11 @@ protected:
     {
       os << "\nFor pepXML files, only validation against the XML schema is implemented at this point." << "\n";
     }
+    else if (in_type == FileTypes::MZML && !getFlag_("m") && !getFlag_("p") && !getFlag_("s") && !getFlag_("d") && !getFlag_("c") &&
+             getStringOption_("out_tsv") == "" && writeSpectrumIndexSummary_(in, os, os_tsv))
+    {
+      // summary written from the spectrum index, the file was not loaded
+    }
     else //peaks
     {
 
@@ -616,16 +801,7 @@ protected:
       //if raw data, determine the spacing
       if (type == SpectrumSettings::RAWDATA)
       {
-        vector<float> spacing;
-        for (Size j = 1; j < exp[i].size(); ++j)
-        {
-          spacing.push_back(exp[i][j].getMZ() - exp[i][j - 1].getMZ());
-        }
-        sort(spacing.begin(), spacing.end());
-        os << "Estimated raw data spacing: " << spacing[spacing.size() / 2] << " (min: " << spacing[0] << ", max: " << spacing.back() << ")" << "\n";
-        os_tsv << "estimated raw data spacing" << "\t" << spacing[spacing.size() / 2] << "\n"
-               << "estimated raw data spacing (min)" << "\t" << spacing[0] << "\n"
-               << "estimated raw data spacing (max)" << "\t" << spacing.back() << "\n";
+        writeRawDataSpacing_(exp[i], os, os_tsv);
       }
       os << "\n";
 
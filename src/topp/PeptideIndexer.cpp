@@ -34,6 +34,7 @@
 
 #include <OpenMS/APPLICATIONS/TOPPBase.h>
 #include <OpenMS/CHEMISTRY/EnzymaticDigestion.h>
+#include <OpenMS/DATASTRUCTURES/ProteinSuffixArray.h>
 #include <OpenMS/DATASTRUCTURES/SeqanIncludeWrapper.h>
 #include <OpenMS/FORMAT/IdXMLFile.h>
 #include <OpenMS/FORMAT/FASTAFile.h>
@@ -43,6 +44,9 @@
 #include <OpenMS/SYSTEM/StopWatch.h>
 #include <OpenMS/METADATA/PeptideEvidence.h>
 
+#include <QtCore/QDateTime>
+#include <QtCore/QFileInfo>
+
 #include <algorithm>
 
 using namespace OpenMS;
@@ -104,6 +108,8 @@ using namespace std;
   The exact mode is much faster (about 10 times) and consumes less memory (about 2.5 times), but might fail to report a few protein hits with ambiguous amino acids for some peptides. Usually these proteins are putative, however.
   The exact mode also supports usage of multiple threads (@p threads option) to speed up computation even further, at the cost of some memory. This is only for the exact search (Aho-Corasick algorithm), however. If tolerant searching needs to be done for unassigned peptides, the latter will consume the major share of the runtime.
 
+  When many identification files are indexed against the same database, the flag @p persistent_index avoids repeating most of the work: The protein database is then indexed by a suffix array, which is stored next to the FASTA file (file extension ".pidx") and simply memory-mapped by later runs. The index file is rebuilt automatically if the FASTA file changes or a different @p IL_equivalent setting is used. (If the index file cannot be written, the index is only kept in memory.) The index also contains the protein accessions, so the FASTA file itself is not read again while the index is valid - unless protein sequences or descriptions are written to the output (@p write_protein_sequence, @p write_protein_description). In this mode, both exact and tolerant searches use the suffix array and are parallelized over the peptides (@p threads option).
+
   Further complications can arise due to the presence of the isobaric amino acids isoleucine ('I') and leucine ('L') in protein sequences. Since the two have the exact same chemical composition and mass, they generally cannot be distinguished by mass spectrometry. If a peptide containing 'I' was reported as a match for a spectrum, a peptide containing 'L' instead would be an equally good match (and vice versa). To account for this inherent ambiguity, setting the flag @p IL_equivalent causes 'I' and 'L' to be considered as indistinguishable.@n
   For example, if the sequence "PEPTIDE" (matching "Protein1") was identified as a search hit, but the database additionally contained "PEPTLDE" (matching "Protein2"), running PeptideIndexer with the @p IL_equivalent option would report both "Protein1" and "Protein2" as accessions for "PEPTIDE". (This is independent of the error-tolerant search controlled by @p full_tolerant_search and @p aaa_max.)
 
@@ -225,6 +231,15 @@ public:
     void addHit(OpenMS::Size idx_pep, OpenMS::Size idx_prot,
                 const OpenMS::String& seq_pep, const OpenMS::String& protein,
                 OpenMS::Size position)
+    {
+      addHit(idx_pep, idx_prot, seq_pep, protein.c_str(), protein.size(),
+             position);
+    }
+
+    /// Version for null-terminated protein sequences (avoids copying them)
+    void addHit(OpenMS::Size idx_pep, OpenMS::Size idx_prot,
+                const OpenMS::String& seq_pep, const char* protein,
+                OpenMS::Size protein_length, OpenMS::Size position)
     {
       if (enzyme_.isValidProduct(AASequence::fromString(protein), position,
                                  seq_pep.length()))
@@ -233,7 +248,7 @@ public:
         match.protein_index = idx_prot;
         match.position = position;
         match.AABefore = (position == 0) ? PeptideEvidence::N_TERMINAL_AA : protein[position - 1];
-        match.AAAfter = (position + seq_pep.length() >= protein.size()) ? PeptideEvidence::C_TERMINAL_AA : protein[position + seq_pep.length()];
+        match.AAAfter = (position + seq_pep.length() >= protein_length) ? PeptideEvidence::C_TERMINAL_AA : protein[position + seq_pep.length()];
         pep_to_prot[idx_pep].insert(match);
         ++filter_passed;
       }
@@ -490,6 +505,69 @@ protected:
     registerIntOption_("aaa_max", "<number>", 4, "Maximal number of ambiguous amino acids (AAA) allowed when matching to a protein database with AAA's. AAA's are 'B', 'Z' and 'X'", false);
     setMinInt_("aaa_max", 0);
     registerFlag_("IL_equivalent", "Treat the isobaric amino acids isoleucine ('I') and leucine ('L') as equivalent (indistinguishable)");
+    registerFlag_("persistent_index", "Store a suffix array index of the protein database next to the FASTA file (or reuse it, if already present) and use it for both exact and tolerant search. Speeds up repeated indexing against the same database.");
+  }
+
+  /// Identifies the data a stored protein index was built from
+  String getIndexSignature_(const String& db_name, bool il_equivalent) const
+  {
+    QFileInfo info(db_name.toQString());
+    return String("PeptideIndexer;size=") + String(info.size()) + ";modified=" +
+           String(info.lastModified().toString(Qt::ISODate)) + 
+           ";IL_equivalent=" + String(int(il_equivalent));
+  }
+
+  /// Match peptides using the suffix array (exact first, then tolerant for unmatched peptides)
+  void searchProteinIndex_(const ProteinSuffixArray& index, const vector<String>& peptides, const EnzymaticDigestion& enzyme, bool tolerant_only, Size max_aaa, seqan::FoundProteinFunctor& func)
+  {
+    Size n_tolerant(0);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+      seqan::FoundProteinFunctor func_threads(enzyme);
+      vector<ProteinSuffixArray::Occurrence> hits;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 100) reduction(+: n_tolerant)
+#endif
+      for (SignedSize p = 0; p < (SignedSize)peptides.size(); ++p)
+      {
+        if (!tolerant_only)
+        {
+          hits.clear();
+          index.findExact(peptides[p], hits);
+          for (vector<ProteinSuffixArray::Occurrence>::const_iterator it = hits.begin(); it != hits.end(); ++it)
+          {
+            func_threads.addHit(p, it->first, peptides[p], index.getProtein(it->first), index.getProteinLength(it->first), it->second);
+          }
+          if (func_threads.pep_to_prot.has(p)) continue;
+        }
+        // search with ambiguous AA's (includes the exact matches)
+        ++n_tolerant;
+        hits.clear();
+        index.findTolerant(peptides[p], max_aaa, hits);
+        for (vector<ProteinSuffixArray::Occurrence>::const_iterator it = hits.begin(); it != hits.end(); ++it)
+        {
+          func_threads.addHit(p, it->first, peptides[p], index.getProtein(it->first), index.getProteinLength(it->first), it->second);
+        }
+      }
+
+      // join results again
+#ifdef _OPENMP
+#pragma omp critical(PeptideIndexer_joinIndex)
+#endif
+      {
+        func.filter_passed += func_threads.filter_passed;
+        func.filter_rejected += func_threads.filter_rejected;
+        for (seqan::FoundProteinFunctor::MapType::const_iterator it = func_threads.pep_to_prot.begin(); it != func_threads.pep_to_prot.end(); ++it)
+        {
+          func.pep_to_prot[it->first].insert(it->second.begin(), it->second.end());
+        }
+      }
+    } // end parallel
+
+    writeLog_(String("Tolerant search was used for ") + n_tolerant + " peptide(s).");
   }
 
   ExitCodes main_(int, const char**)
@@ -504,6 +582,7 @@ protected:
     bool keep_unreferenced_proteins = getFlag_("keep_unreferenced_proteins");
     bool allow_unmatched = getFlag_("allow_unmatched");
     bool il_equivalent = getFlag_("IL_equivalent");
+    bool persistent_index = getFlag_("persistent_index");
 
     String decoy_string = getStringOption_("decoy_string");
     bool prefix = getFlag_("prefix");
@@ -533,9 +612,19 @@ protected:
     // reading input
     //-------------------------------------------------------------
 
+    // a valid protein index provides sequences and accessions, so the FASTA
+    // file is then only needed for writing sequences or descriptions:
+    ProteinSuffixArray index;
+    String index_file = db_name + ".pidx";
+    String signature = getIndexSignature_(db_name, il_equivalent);
+    bool index_loaded = persistent_index && index.load(index_file, signature);
+
     // we stream the Fasta file
     vector<FASTAFile::FASTAEntry> proteins;
-    FASTAFile().load(db_name, proteins);
+    if (!index_loaded || write_protein_sequence || write_protein_description)
+    {
+      FASTAFile().load(db_name, proteins);
+    }
 
     vector<ProteinIdentification> prot_ids;
     vector<PeptideIdentification> pep_ids;
@@ -546,7 +635,7 @@ protected:
     // calculations
     //-------------------------------------------------------------
 
-    if (proteins.size() == 0) // we do not allow an empty database
+    if ((index_loaded ? index.size() : proteins.size()) == 0) // we do not allow an empty database
     {
       LOG_ERROR << "Error: An empty FASTA file was provided. Mapping makes no sense. Aborting..." << std::endl;
       return INPUT_FILE_EMPTY;
@@ -567,6 +656,7 @@ protected:
 
     seqan::FoundProteinFunctor func(enzyme); // stores the matches (need to survive local scope which follows)
     Map<String, Size> acc_to_prot; // build map: accessions to FASTA protein index
+    vector<String> accessions; // FASTA protein index to accession
 
     { // new scope - forget data after search
 
@@ -574,6 +664,7 @@ protected:
        BUILD Protein DB
       */
       seqan::StringSet<seqan::Peptide> prot_DB;
+      vector<String> prot_seqs; // used instead of 'prot_DB' for the suffix array
 
       bool has_DB_duplicates(false);
 
@@ -593,8 +684,8 @@ protected:
           LOG_WARN << "PeptideIndexer: Warning, protein identifiers should be unique to a database. Identifier '" << acc << "' found multiple times.\n";
           has_DB_duplicates = true;
           // check if sequence is identical
-          const seqan::Peptide& tmp_prot = prot_DB[acc_to_prot[acc]];
-          if (String(begin(tmp_prot), end(tmp_prot)) != seq)
+          const String tmp_prot = persistent_index ? prot_seqs[acc_to_prot[acc]] : String(begin(prot_DB[acc_to_prot[acc]]), end(prot_DB[acc_to_prot[acc]]));
+          if (tmp_prot != seq)
           {
             LOG_ERROR << "PeptideIndexer: protein identifier '" << acc << "' found multiple times with different sequences" << (il_equivalent ? " (I/L substituted)" : "") 
                       << ":\n" << tmp_prot << "\nvs.\n" << seq << "\n! Please fix the database and run PeptideIndexer again!" << std::endl;
@@ -610,11 +701,22 @@ protected:
         else
         {
           // extend protein DB
-          seqan::appendValue(prot_DB, seq.c_str());
+          if (persistent_index) prot_seqs.push_back(seq);
+          else seqan::appendValue(prot_DB, seq.c_str());
           acc_to_prot[acc] = i;
+          accessions.push_back(acc);
         }
         
       }
+      if (index_loaded && proteins.empty()) // FASTA file wasn't read
+      {
+        accessions.reserve(index.size());
+        for (Size i = 0; i < index.size(); ++i)
+        {
+          accessions.push_back(index.getName(i));
+          acc_to_prot[accessions.back()] = i;
+        }
+      }
       // make sure the warnings above are printed to screen
       if (has_DB_duplicates) LOG_WARN << std::endl;
 
@@ -637,11 +739,48 @@ protected:
         }
       }
 
-      writeLog_(String("Mapping ") + length(pep_DB) + " peptides to " + length(prot_DB) + " proteins.");
+      writeLog_(String("Mapping ") + length(pep_DB) + " peptides to " + accessions.size() + " proteins.");
 
-      /** first, try Aho Corasick (fast) -- using exact matching only */
       bool SA_only = getFlag_("full_tolerant_search");
-      if (!SA_only)
+      if (persistent_index)
+      {
+        StopWatch sw;
+        sw.start();
+        if (index_loaded)
+        {
+          writeLog_("Using protein index '" + index_file + "'.");
+        }
+        else
+        {
+          writeLog_("Building protein index...");
+          index.build(prot_seqs, accessions);
+          try
+          {
+            index.store(index_file, signature);
+            writeLog_("Stored protein index in '" + index_file + "'.");
+          }
+          catch (Exception::UnableToCreateFile&)
+          {
+            LOG_WARN << "Warning: Unable to store protein index in '" << index_file << "'. The index will be rebuilt in the next run." << std::endl;
+          }
+        }
+        prot_seqs.clear(); // the index has its own copy of the sequences
+
+        vector<String> peptides;
+        peptides.reserve(length(pep_DB));
+        for (Size p = 0; p < length(pep_DB); ++p)
+        {
+          peptides.push_back(String(begin(pep_DB[p]), end(pep_DB[p])));
+          ProteinSuffixArray::normalizeSequence(peptides.back());
+        }
+        searchProteinIndex_(index, peptides, enzyme, SA_only, getIntOption_("aaa_max"), func);
+
+        sw.stop();
+        writeLog_(String("Suffix array search done. Found ") + func.filter_passed + " hits in " + func.pep_to_prot.size() + " of " + length(pep_DB) + " peptides (time: " + sw.getClockTime() + " s (wall), " + sw.getCPUTime() + " s (CPU)).");
+      }
+
+      /** first, try Aho Corasick (fast) -- using exact matching only */
+      else if (!SA_only)
       {
         StopWatch sw;
         sw.start();
@@ -693,7 +832,7 @@ protected:
       }
 
       /// check if every peptide was found:
-      if (func.pep_to_prot.size() != length(pep_DB))
+      if (!persistent_index && (func.pep_to_prot.size() != length(pep_DB)))
       {
         // search using SA, which supports mismatches (introduced by resolving ambiguous AA's by e.g. Mascot) -- expensive!
         writeLog_(String("Using suffix array to find ambiguous matches..."));
@@ -797,7 +936,7 @@ protected:
              it_i != func.pep_to_prot[pep_idx].end();
              ++it_i)
         {
-          const String& accession = proteins[it_i->protein_index].identifier;
+          const String& accession = accessions[it_i->protein_index];
           PeptideEvidence pe;
           pe.setProteinAccession(accession);
           pe.setStart(it_i->position);
@@ -953,7 +1092,7 @@ protected:
            ++it)
       {
         ProteinHit hit;
-        hit.setAccession(proteins[*it].identifier);
+        hit.setAccession(accessions[*it]);
         if (write_protein_sequence)
         {
           hit.setSequence(proteins[*it].sequence);
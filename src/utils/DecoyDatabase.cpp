@@ -34,8 +34,13 @@
 
 #include <OpenMS/FORMAT/IdXMLFile.h>
 #include <OpenMS/FORMAT/FASTAFile.h>
+#include <OpenMS/FORMAT/MappedFASTAFile.h>
 #include <OpenMS/METADATA/ProteinIdentification.h>
 #include <OpenMS/APPLICATIONS/TOPPBase.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <fstream>
+#include <cstdio>
 
 using namespace OpenMS;
 using namespace std;
@@ -113,98 +118,106 @@ protected:
     // reading input
     //-------------------------------------------------------------
 
-    vector<FASTAFile::FASTAEntry> proteins;
-    for (Size i=0; i<in.size(); ++i)
-    {
-      vector<FASTAFile::FASTAEntry> single_proteins;
-      // this is a little inefficient since it requires copying; appending during load() would be better...
-      FASTAFile().load(in[i], single_proteins);  
-      // append
-      proteins.insert(proteins.end(), single_proteins.begin(), single_proteins.end());
-    }
-
+    // the input files are streamed (twice, if targets are appended), so they do not need to fit into memory
     if (in.size() == 1)
     {
       LOG_WARN << "Warning: Only one FASTA input file was provided, which might not contain contaminants. You probably want to have them! Just add the contaminant file to the input file list 'in'." << endl;
     }
 
-    //-------------------------------------------------------------
-    // calculations
-    //-------------------------------------------------------------
+    // the inputs are read while writing, so write to a temporary file next to 'out'
+    // and only replace 'out' at the end (it may be one of the inputs)
+    String tmp_out = out + "." + File::getUniqueName() + ".tmp";
+    ofstream outfile(tmp_out.c_str());
+    if (!outfile.good())
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, __PRETTY_FUNCTION__, tmp_out);
+    }
 
-    String decoy_string(getStringOption_("decoy_string"));
-    bool decoy_string_position_prefix =   (String(getStringOption_("decoy_string_position")) == "prefix" ? true : false);
-    Size num_proteins = proteins.size();
-    set<String> identifiers;
-    if (shuffle)
+    try
     {
-      for (Size i = 0; i < num_proteins; ++i)
-      {
-        if (identifiers.find(proteins[i].identifier) != identifiers.end())
-        {
-          LOG_WARN << "DecoyDatabase: Warning, identifier is not unique to sequence file: '" << proteins[i].identifier << "'!" << endl;
-        }
-        identifiers.insert(proteins[i].identifier);
+      writeDatabase_(in, outfile, append, shuffle);
+    }
+    catch (...)
+    {
+      outfile.close();
+      File::remove(tmp_out);
+      throw;
+    }
+    outfile.close();
 
-        FASTAFile::FASTAEntry entry = proteins[i];
+    if (File::exists(out) && !File::remove(out))
+    {
+      File::remove(tmp_out);
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, __PRETTY_FUNCTION__, out);
+    }
+    if (std::rename(tmp_out.c_str(), out.c_str()) != 0)
+    {
+      File::remove(tmp_out);
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, __PRETTY_FUNCTION__, out);
+    }
 
-        String pro_seq, temp;
-        pro_seq = entry.sequence;
-        Size x = pro_seq.size();
-        srand(time(0));
-        while (x != 0)
-        {
-          Size y = rand() % x;
-          temp += pro_seq[y];
-          pro_seq[y] = pro_seq[x - 1];
-          --x;
-        }
-        entry.sequence = temp;
+    return EXECUTION_OK;
+  }
 
-        if (append)
-        {
-          entry.identifier = getIdentifier_(entry.identifier, decoy_string, decoy_string_position_prefix);
-          proteins.push_back(entry);
-        }
-        else
+  void writeDatabase_(const StringList & in, ofstream & outfile, bool append, bool shuffle)
+  {
+    MappedFASTAFile::Entry entry;
+    if (append) // targets first
+    {
+      for (Size i = 0; i < in.size(); ++i)
+      {
+        MappedFASTAFile input;
+        input.open(in[i]);
+        while (input.readNext(entry))
         {
-          proteins[i].sequence = entry.sequence;
-          proteins[i].identifier = getIdentifier_(proteins[i].identifier, decoy_string, decoy_string_position_prefix);
+          FASTAFile::writeEntry(outfile, entry.toFASTAEntry());
         }
       }
     }
-    else         // !shuffle
+
+    //-------------------------------------------------------------
+    // calculations
+    //-------------------------------------------------------------
+
+    String decoy_string(getStringOption_("decoy_string"));
+    bool decoy_string_position_prefix =   (String(getStringOption_("decoy_string_position")) == "prefix" ? true : false);
+    set<String> identifiers;
+    for (Size i = 0; i < in.size(); ++i)
     {
-      for (Size i = 0; i < num_proteins; ++i)
+      MappedFASTAFile input;
+      input.open(in[i]);
+      while (input.readNext(entry))
       {
-        if (identifiers.find(proteins[i].identifier) != identifiers.end())
+        FASTAFile::FASTAEntry protein = entry.toFASTAEntry();
+        if (identifiers.find(protein.identifier) != identifiers.end())
         {
-          LOG_WARN << "DecoyDatabase: Warning, identifier is not unique to sequence file: '" << proteins[i].identifier << "'!" << endl;
+          LOG_WARN << "DecoyDatabase: Warning, identifier is not unique to sequence file: '" << protein.identifier << "'!" << endl;
         }
-        identifiers.insert(proteins[i].identifier);
+        identifiers.insert(protein.identifier);
 
-        if (append)
+        if (shuffle)
         {
-          FASTAFile::FASTAEntry entry = proteins[i];
-          entry.sequence.reverse();
-          entry.identifier = getIdentifier_(entry.identifier, decoy_string, decoy_string_position_prefix);
-          proteins.push_back(entry);
+          String pro_seq, temp;
+          pro_seq = protein.sequence;
+          Size x = pro_seq.size();
+          srand(time(0));
+          while (x != 0)
+          {
+            Size y = rand() % x;
+            temp += pro_seq[y];
+            pro_seq[y] = pro_seq[x - 1];
+            --x;
+          }
+          protein.sequence = temp;
         }
         else
         {
-          proteins[i].sequence.reverse();
-          proteins[i].identifier = getIdentifier_(proteins[i].identifier, decoy_string, decoy_string_position_prefix);
+          protein.sequence.reverse();
         }
+        protein.identifier = getIdentifier_(protein.identifier, decoy_string, decoy_string_position_prefix);
+        FASTAFile::writeEntry(outfile, protein);
       }
     }
-
-    //-------------------------------------------------------------
-    // writing output
-    //-------------------------------------------------------------
-
-    FASTAFile().store(out, proteins);
-
-    return EXECUTION_OK;
   }
 
 };
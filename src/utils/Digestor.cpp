@@ -35,10 +35,13 @@
 #include <OpenMS/FORMAT/FileHandler.h>
 #include <OpenMS/FORMAT/IdXMLFile.h>
 #include <OpenMS/FORMAT/FASTAFile.h>
+#include <OpenMS/FORMAT/MappedFASTAFile.h>
 #include <OpenMS/METADATA/ProteinIdentification.h>
 #include <OpenMS/APPLICATIONS/TOPPBase.h>
 #include <OpenMS/CHEMISTRY/EnzymaticDigestion.h>
+#include <OpenMS/CHEMISTRY/ResidueDB.h>
 
+#include <fstream>
 #include <map>
 
 using namespace OpenMS;
@@ -109,6 +112,30 @@ protected:
     setValidStrings_("enzyme", ListUtils::create<String>("Trypsin,none"));
   }
 
+  /// characters which AASequence::fromString() maps to an unmodified residue with the same one-letter code
+  std::vector<bool> plainResidueCharacters_() const
+  {
+    std::vector<bool> plain(256, false);
+    const ResidueDB* rdb = ResidueDB::getInstance();
+    for (Size c = 0; c < plain.size(); ++c)
+    {
+      const Residue* r = rdb->getResidue((unsigned char)c);
+      plain[c] = (r != 0) && !r->isModified() && (r->getOneLetterCode() == String(char(c)));
+    }
+    return plain;
+  }
+
+  /// true if @p sequence can be cut as a plain string, i.e. AASequence::fromString(sequence).toString() == sequence
+  bool isPlainSequence_(const String& sequence, const std::vector<bool>& plain) const
+  {
+    if (sequence.empty()) return false;
+    for (String::const_iterator it = sequence.begin(); it != sequence.end(); ++it)
+    {
+      if (!plain[(unsigned char)*it]) return false;
+    }
+    return true;
+  }
+
   ExitCodes main_(int, const char**)
   {
     vector<ProteinIdentification> protein_identifications;
@@ -154,8 +181,9 @@ protected:
     //-------------------------------------------------------------
     // reading input
     //-------------------------------------------------------------
-    std::vector<FASTAFile::FASTAEntry> protein_data;
-    FASTAFile().load(inputfile_name, protein_data);
+    // the database is streamed, i.e. it does not need to fit into memory
+    MappedFASTAFile fasta_input;
+    fasta_input.open(inputfile_name);
     //-------------------------------------------------------------
     // calculations
     //-------------------------------------------------------------
@@ -188,30 +216,76 @@ protected:
     protein_identifications[0].setSearchEngine("In-silico digestion");
     protein_identifications[0].setIdentifier("In-silico_digestion" + date_time_string);
 
-    std::vector<FASTAFile::FASTAEntry> all_peptides;
+    // FASTA output is written on the fly
+    ofstream fasta_output;
+    if (has_FASTA_output)
+    {
+      fasta_output.open(outputfile_name.c_str());
+      if (!fasta_output.good())
+      {
+        throw Exception::UnableToCreateFile(__FILE__, __LINE__, __PRETTY_FUNCTION__, outputfile_name);
+      }
+    }
 
+    Size fasta_peptides(0);
     Size dropped_bylength(0); // stats for removing candidates
 
-    for (Size i = 0; i < protein_data.size(); ++i)
+    const std::vector<bool> plain_residues = plainResidueCharacters_();
+    MappedFASTAFile::Entry entry;
+    while (fasta_input.readNext(entry))
     {
+      FASTAFile::FASTAEntry protein = entry.toFASTAEntry();
+
+      // fast path for unmodified proteins: cut the sequence string directly, without creating AASequence objects;
+      // anything else (modifications, unknown characters, stop codons, ...) is parsed (and validated) by AASequence
+      if (has_FASTA_output && isPlainSequence_(protein.sequence, plain_residues))
+      {
+        vector<pair<Size, Size> > ranges;
+        if (enzyme == "none")
+        {
+          ranges.push_back(make_pair(Size(0), protein.sequence.size()));
+          if ((protein.sequence.size() < min_size) || (protein.sequence.size() > max_size))
+          {
+            ranges.clear();
+            ++dropped_bylength;
+          }
+        }
+        else
+        {
+          dropped_bylength += digestor.digestUnmodifiedString(protein.sequence, ranges, min_size, max_size);
+          if (max_size == 0) // for digestUnmodifiedString() 0 means "no limit", here (as below) it does not
+          {
+            dropped_bylength += ranges.size();
+            ranges.clear();
+          }
+        }
+        for (Size j = 0; j < ranges.size(); ++j)
+        {
+          FASTAFile::FASTAEntry pep(protein.identifier, protein.description, protein.sequence.substr(ranges[j].first, ranges[j].second));
+          FASTAFile::writeEntry(fasta_output, pep);
+        }
+        fasta_peptides += ranges.size();
+        continue;
+      }
+
       if (!has_FASTA_output)
       {
         ProteinHit temp_protein_hit;
-        temp_protein_hit.setSequence(protein_data[i].sequence);
-        temp_protein_hit.setAccession(protein_data[i].identifier);
+        temp_protein_hit.setSequence(protein.sequence);
+        temp_protein_hit.setAccession(protein.identifier);
         protein_identifications[0].insertHit(temp_protein_hit);
-        temp_pe.setProteinAccession(protein_data[i].identifier);
+        temp_pe.setProteinAccession(protein.identifier);
         temp_peptide_hit.setPeptideEvidences(vector<PeptideEvidence>(1, temp_pe));
       }
 
       vector<AASequence> temp_peptides;
       if (enzyme == "none")
       {
-        temp_peptides.push_back(AASequence::fromString(protein_data[i].sequence));
+        temp_peptides.push_back(AASequence::fromString(protein.sequence));
       }
       else
       {
-        digestor.digest(AASequence::fromString(protein_data[i].sequence), temp_peptides);
+        digestor.digest(AASequence::fromString(protein.sequence), temp_peptides);
       }
 
       for (Size j = 0; j < temp_peptides.size(); ++j)
@@ -228,8 +302,9 @@ protected:
           }
           else // for FASTA file output
           {
-            FASTAFile::FASTAEntry pep(protein_data[i].identifier, protein_data[i].description, temp_peptides[j].toString());
-            all_peptides.push_back(pep);
+            FASTAFile::FASTAEntry pep(protein.identifier, protein.description, temp_peptides[j].toString());
+            FASTAFile::writeEntry(fasta_output, pep);
+            ++fasta_peptides;
           }
         }
         else
@@ -245,7 +320,7 @@ protected:
 
     if (has_FASTA_output)
     {
-      FASTAFile().store(outputfile_name, all_peptides);
+      fasta_output.close();
     }
     else
     {
@@ -254,7 +329,7 @@ protected:
                         identifications);
     }
 
-    Size pep_remaining_count = (has_FASTA_output ? all_peptides.size() : identifications.size());
+    Size pep_remaining_count = (has_FASTA_output ? fasta_peptides : identifications.size());
     LOG_INFO << "Statistics:\n"
              << "  total #peptides after digestion:         " << pep_remaining_count + dropped_bylength << "\n"
              << "  removed #peptides (length restrictions): " << dropped_bylength << "\n"
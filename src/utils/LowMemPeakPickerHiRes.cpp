@@ -41,6 +41,7 @@ using namespace OpenMS;
 using namespace std;
 
 #include <OpenMS/FORMAT/DATAACCESS/MSDataWritingConsumer.h>
+#include <OpenMS/FORMAT/DATAACCESS/MSDataParallelTransformingConsumer.h>
 
 //-------------------------------------------------------------
 //Doxygen docu
@@ -121,29 +122,29 @@ public:
 
 protected:
 
-  class PPHiResMzMLConsumer :
-    public MSDataWritingConsumer
+  // picks the spectra (called concurrently, PeakPickerHiRes::pick is const)
+  class PPHiResTransformation :
+    public MSDataParallelTransformingConsumer::Transformation
   {
 
   public:
 
-    PPHiResMzMLConsumer(String filename, PeakPickerHiRes pp) :
-      MSDataWritingConsumer(filename),
+    PPHiResTransformation(PeakPickerHiRes pp) :
       ms1_levels_(pp.getParameters().getValue("ms_levels").toIntList())
     {
       pp_ = pp;
     }
 
-    void processSpectrum_(MapType::SpectrumType & s)
+    void transformSpectrum(MSDataParallelTransformingConsumer::SpectrumType & s) const
     {
       if (!ListUtils::contains(ms1_levels_, s.getMSLevel())) {return;}
 
-      MapType::SpectrumType sout;
+      MSDataParallelTransformingConsumer::SpectrumType sout;
       pp_.pick(s, sout);
       s = sout;
     }
 
-    void processChromatogram_(MapType::ChromatogramType & /* c */)
+    void transformChromatogram(MSDataParallelTransformingConsumer::ChromatogramType & /* c */) const
     {
       throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__,
         "Cannot handle chromatograms yet.");
@@ -228,7 +229,7 @@ protected:
     //-------------------------------------------------------------
 
     ///////////////////////////////////
-    // Create PeakPickerHiRes and hand it to the PPHiResMzMLConsumer
+    // Create PeakPickerHiRes and hand it to the PPHiResTransformation
     ///////////////////////////////////
     Param pepi_param = getParam_().copy("algorithm:", true);
     writeDebug_("Parameters passed to LowMemPeakPickerHiRes", pepi_param, 3);
@@ -236,16 +237,22 @@ protected:
     PeakPickerHiRes pp;
     pp.setLogType(log_type_);
     pp.setParameters(pepi_param);
-    PPHiResMzMLConsumer * ppConsumer = new PPHiResMzMLConsumer(out, pp);
-    ppConsumer->addDataProcessing(getProcessingInfo_(DataProcessing::PEAK_PICKING));
+    PPHiResTransformation transformation(pp);
+
+    PlainMSDataWritingConsumer writer(out);
+    writer.addDataProcessing(getProcessingInfo_(DataProcessing::PEAK_PICKING));
+    // encode a few spectra per thread in parallel
+    Size window_size = 4 * getIntOption_("threads");
+    writer.setWritingWindow(window_size);
 
     ///////////////////////////////////
-    // Create new MSDataReader and set our consumer
+    // Pick spectra on all threads, then write them in their original order
     ///////////////////////////////////
+    MSDataParallelTransformingConsumer pp_consumer(transformation, &writer, window_size);
     MzMLFile mz_data_file;
-    mz_data_file.transform(in, ppConsumer);
-
-    delete ppConsumer;
+    mz_data_file.transform(in, &pp_consumer);
+    pp_consumer.flush();
+    writer.flush();
 
     return EXECUTION_OK;
   }
@@ -61,8 +61,10 @@
 
 // Helpers
 #include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathHelper.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/LightTransitionTable.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/DataAccessHelper.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SimpleOpenMSSpectraAccessFactory.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessSharedMemory.h>
 
 // Algorithms
 #include <OpenMS/ANALYSIS/OPENSWATH/MRMRTNormalizer.h>
@@ -70,6 +72,8 @@
 #include <OpenMS/ANALYSIS/OPENSWATH/MRMFeatureFinderScoring.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/MRMTransitionGroupPicker.h>
 
+#include <QtCore/QFileInfo>
+
 #include <assert.h>
 
 using namespace OpenMS;
@@ -369,7 +373,7 @@ namespace OpenMS
      *
      * Executes the following operations on the given input:
      *
-     * 1. OpenSwathHelper::selectSwathTransitions
+     * 1. LightTransitionTable::selectSwath (and split into batches)
      * 2. ChromatogramExtractor prepare, extract
      * 3. scoreAllChromatograms
      * 4. Write out chromatograms and found features
@@ -378,7 +382,7 @@ namespace OpenMS
      * @param trafo Transformation description (translating this runs' RT to normalized RT space)
      * @param cp Parameter set for the chromatogram extraction
      * @param feature_finder_param Parameter set for the feature finding in chromatographic dimension 
-     * @param transition_exp The set of assays to be extracted and scored
+     * @param transition_table The set of assays to be extracted and scored
      * @param out_featureFile Output feature map to store identified features
      * @param store_features Whether features should be appended to the output feature map
      * @param tsv_writer TSV Writer object to store identified features in csv format
@@ -389,7 +393,7 @@ namespace OpenMS
     void performExtraction(const std::vector< OpenSwath::SwathMap > & swath_maps,
       const TransformationDescription trafo,
       const ChromExtractParams & cp, const Param & feature_finder_param,
-      const OpenSwath::LightTargetedExperiment& transition_exp,
+      const LightTransitionTable& transition_table,
       FeatureMap& out_featureFile, bool store_features,
       OpenSwathTSVWriter & tsv_writer, Interfaces::IMSDataConsumer<> * chromConsumer,
       int batchSize)
@@ -400,7 +404,7 @@ namespace OpenMS
       TransformationDescription trafo_inverse = trafo;
       trafo_inverse.invert();
 
-      std::cout << "Will analyze " << transition_exp.transitions.size() << " transitions in total." << std::endl;
+      std::cout << "Will analyze " << transition_table.size() << " transitions in total." << std::endl;
       int progress = 0;
       this->startProgress(0, swath_maps.size(), "Extracting and scoring transitions");
 
@@ -415,7 +419,8 @@ namespace OpenMS
 
           std::vector< OpenSwath::ChromatogramPtr > chrom_list;
           std::vector< ChromatogramExtractor::ExtractionCoordinates > coordinates;
-          OpenSwath::LightTargetedExperiment transition_exp_used = transition_exp; // copy for const correctness
+          OpenSwath::LightTargetedExperiment transition_exp_used;
+          transition_table.toLightTargetedExperiment(transition_table.getAllRows(), transition_exp_used);
           ChromatogramExtractor extractor;
 
           // prepare the extraction coordinates & extract chromatogram
@@ -448,21 +453,19 @@ namespace OpenMS
         {
 
           // Step 1: select which transitions to extract (proceed in batches)
-          OpenSwath::LightTargetedExperiment transition_exp_used_all;
-          OpenSwathHelper::selectSwathTransitions(transition_exp, transition_exp_used_all,
-              cp.min_upper_edge_dist, swath_maps[i].lower, swath_maps[i].upper);
-          if (transition_exp_used_all.getTransitions().size() > 0) // skip if no transitions found
+          LightTransitionTable::View swath_rows = transition_table.selectSwath(
+              swath_maps[i].lower, swath_maps[i].upper, cp.min_upper_edge_dist);
+          if (!swath_rows.empty()) // skip if no transitions found
           {
 
-            int batch_size;
-            if (batchSize <= 0 || batchSize >= (int)transition_exp_used_all.getPeptides().size())
-            {
-              batch_size = transition_exp_used_all.getPeptides().size();
-            }
-            else
+            Size nr_peptides = transition_table.getNrPeptides(swath_rows);
+            Size batch_size = nr_peptides;
+            if (batchSize > 0 && batchSize < (int)nr_peptides)
             {
               batch_size = batchSize;
             }
+            std::vector<LightTransitionTable::View> batches;
+            transition_table.splitIntoBatches(swath_rows, batch_size, batches);
 
 #ifdef _OPENMP
 #pragma omp critical (featureFinder)
@@ -472,16 +475,16 @@ namespace OpenMS
 #ifdef _OPENMP
               omp_get_thread_num() << " " <<
 #endif
-              "will analyze " << transition_exp_used_all.getPeptides().size() <<  " peptides and "
-              << transition_exp_used_all.getTransitions().size() <<  " transitions "
+              "will analyze " << nr_peptides <<  " peptides and "
+              << swath_rows.size() <<  " transitions "
               "from SWATH " << i << " in batches of " << batch_size << std::endl;
             }
 
-            for (size_t j = 0; j <= (transition_exp_used_all.getPeptides().size() / batch_size); j++)
+            for (Size j = 0; j < batches.size(); j++)
             {
               // Create the new, batch-size transition experiment
               OpenSwath::LightTargetedExperiment transition_exp_used;
-              selectPeptidesForBatch_(transition_exp_used_all, transition_exp_used, batch_size, j);
+              transition_table.toLightTargetedExperiment(batches[j], transition_exp_used);
 
               // Step 2.1: extract these transitions
               ChromatogramExtractor extractor;
@@ -547,51 +550,6 @@ namespace OpenMS
 
   private:
 
-    /** @brief Select which peptides to analyze in the next batch and copy the corresponding peptides and transitions to transition_exp_used
-     *
-     * @param transition_exp_used input (all transitions for this swath)
-     * @param transition_exp_used output (contains only transitions for the next batch)
-     * @param batch_size how many peptides per batch
-     * @param j batch number (peptides from j*batch_size to j*batch_size+batch_size will be copied)
-     *
-    */
-    void selectPeptidesForBatch_(const OpenSwath::LightTargetedExperiment& transition_exp_used_all,
-      OpenSwath::LightTargetedExperiment& transition_exp_used, int batch_size, size_t j)
-    {
-      // compute batch start/end
-      size_t start = j * batch_size;
-      size_t end = j * batch_size + batch_size;
-      if (end > transition_exp_used_all.peptides.size())
-      {
-        end = transition_exp_used_all.peptides.size();
-      }
-
-      // Create the new, batch-size transition experiment
-      transition_exp_used.proteins = transition_exp_used_all.proteins;
-      transition_exp_used.peptides.insert(transition_exp_used.peptides.end(),
-          transition_exp_used_all.peptides.begin() + start, transition_exp_used_all.peptides.begin() + end);
-      copyBatchTransitions_(transition_exp_used.peptides, transition_exp_used_all.transitions, transition_exp_used.transitions);
-    }
-
-    /// Copy the required transitions from all_transitions to output (e.g. those that match a peptide in the used_peptides vector)
-    void copyBatchTransitions_(const std::vector<OpenSwath::LightPeptide>& used_peptides,
-        const std::vector<OpenSwath::LightTransition>& all_transitions, std::vector<OpenSwath::LightTransition>& output)
-    {
-      std::set<std::string> selected_peptides;
-      for (Size i = 0; i < used_peptides.size(); i++)
-      {
-        selected_peptides.insert(used_peptides[i].id);
-      }
-
-      for (Size i = 0; i < all_transitions.size(); i++)
-      {
-        if (selected_peptides.find(all_transitions[i].peptide_ref) != selected_peptides.end())
-        {
-          output.push_back(all_transitions[i]);
-        }
-      }
-    }
-
     /// Simple method to extract chromatograms (for the RT-normalization peptides)
     void simpleExtractChromatograms(const std::vector< OpenSwath::SwathMap > & swath_maps,
       const OpenMS::TargetedExperiment & irt_transitions,
@@ -1177,6 +1135,15 @@ public:
 
 protected:
 
+  /// Identifies the transition file a transition cache was created from
+  String getTransitionCacheSignature_(const String& tr_file, FileTypes::Type tr_type) const
+  {
+    QFileInfo info(tr_file.toQString());
+    return String("OpenSwathWorkflow;file=") + String(info.absoluteFilePath()) + ";size=" +
+           String(info.size()) + ";modified=" + String(info.lastModified().toString(Qt::ISODate)) +
+           ";type=" + FileTypes::typeToName(tr_type);
+  }
+
   void registerOptionsAndFlags_()
   {
     registerInputFileList_("in", "<files>", StringList(), "Input files separated by blank");
@@ -1186,6 +1153,7 @@ protected:
     setValidFormats_("tr", ListUtils::create<String>("traML,tsv,csv"));
     registerStringOption_("tr_type", "<type>", "", "input file type -- default: determined from file extension or content\n", false);
     setValidStrings_("tr_type", ListUtils::create<String>("traML,tsv,csv"));
+    registerStringOption_("tr_cache", "<file>", "", "Binary cache of the transition file. If the file exists and was created from the same transition file, the transitions are loaded from it (much faster than parsing), otherwise the cache is created.", false, true);
 
     // one of the following two needs to be set
     registerInputFile_("tr_irt", "<file>", "", "transition file ('TraML')", false);
@@ -1228,6 +1196,8 @@ protected:
     // TODO terminal slash !
     registerStringOption_("tempDirectory", "<tmp>", "/tmp/", "Temporary directory to store cached files for example", false, true);
 
+    registerStringOption_("swath_shm", "<name>", "", "Share the SWATH maps between concurrent runs on the same SWATH data (e.g. with different libraries) in named shared memory: if SWATH maps with this name are published, they are used instead of loading the input files, otherwise the input files are loaded and published under this name. The maps are freed once all runs using them have finished. Note that the experimental settings of the input file are not written to out_chrom when using published maps.", false, true);
+
     registerStringOption_("extraction_function", "<name>", "tophat", "Function used to extract the signal", false, true);
     setValidStrings_("extraction_function", ListUtils::create<String>("tophat,bartlett"));
 
@@ -1317,8 +1287,15 @@ protected:
 
   void loadSwathFiles(StringList& file_list, bool split_file, String tmp, String readoptions,
     boost::shared_ptr<ExperimentalSettings > & exp_meta,
-    std::vector< OpenSwath::SwathMap > & swath_maps)
+    std::vector< OpenSwath::SwathMap > & swath_maps, String shm_key)
   {
+    // Use the SWATH maps published by a concurrent run if present
+    if (!shm_key.empty() && SpectrumAccessSharedMemory::attachSwathMaps(shm_key, swath_maps))
+    {
+      std::cout << "Using the SWATH maps published in shared memory as " << shm_key << std::endl;
+      return;
+    }
+
     SwathFile swath_file;
     swath_file.setLogType(log_type_);
 
@@ -1346,6 +1323,19 @@ protected:
             "Input file needs to have ending mzML or mzXML");
       }
     }
+
+    // Publish the SWATH maps for concurrent runs and continue on the shared copy
+    if (!shm_key.empty())
+    {
+      if (SpectrumAccessSharedMemory::publishSwathMaps(swath_maps, shm_key, swath_maps))
+      {
+        std::cout << "Published the SWATH maps in shared memory as " << shm_key << std::endl;
+      }
+      else
+      {
+        std::cout << "WARNING: SWATH maps are already being published as " << shm_key << ", will use the maps loaded by this process." << std::endl;
+      }
+    }
   }
 
   /**
@@ -1438,6 +1428,7 @@ protected:
 
     String readoptions = getStringOption_("readOptions");
     String tmp = getStringOption_("tempDirectory");
+    String shm_key = getStringOption_("swath_shm");
 
     ///////////////////////////////////
     // Parameter validation
@@ -1500,7 +1491,7 @@ protected:
     ///////////////////////////////////
     boost::shared_ptr<ExperimentalSettings> exp_meta(new ExperimentalSettings);
     std::vector< OpenSwath::SwathMap > swath_maps;
-    loadSwathFiles(file_list, split_file, tmp, readoptions, exp_meta, swath_maps);
+    loadSwathFiles(file_list, split_file, tmp, readoptions, exp_meta, swath_maps, shm_key);
 
     // Allow the user to specify the SWATH windows
     if (!swath_windows_file.empty())
@@ -1524,22 +1515,46 @@ protected:
     ///////////////////////////////////
     // Load the transitions
     ///////////////////////////////////
-    OpenSwath::LightTargetedExperiment transition_exp;
-    ProgressLogger progresslogger;
-    progresslogger.setLogType(log_type_);
-    progresslogger.startProgress(0, swath_maps.size(), "Load TraML file");
-    FileTypes::Type tr_file_type = FileTypes::nameToType(tr_file);
-    if (tr_file_type == FileTypes::TRAML || tr_file.suffix(5).toLower() == "traml"  )
+    String tr_cache = getStringOption_("tr_cache");
+    String tr_signature = getTransitionCacheSignature_(tr_file, tr_type);
+    LightTransitionTable transition_table;
+    if (!tr_cache.empty() && transition_table.load(tr_cache, tr_signature))
     {
-      TargetedExperiment targeted_exp;
-      TraMLFile().load(tr_file, targeted_exp);
-      OpenSwathDataAccessHelper::convertTargetedExp(targeted_exp, transition_exp);
+      writeLog_(String("Loaded ") + transition_table.size() + " transitions from cache file " + tr_cache);
     }
     else
     {
-      TransitionTSVReader().convertTSVToTargetedExperiment(tr_file.c_str(), tr_type, transition_exp);
+      OpenSwath::LightTargetedExperiment transition_exp;
+      ProgressLogger progresslogger;
+      progresslogger.setLogType(log_type_);
+      progresslogger.startProgress(0, swath_maps.size(), "Load TraML file");
+      FileTypes::Type tr_file_type = FileTypes::nameToType(tr_file);
+      if (tr_file_type == FileTypes::TRAML || tr_file.suffix(5).toLower() == "traml"  )
+      {
+        TargetedExperiment targeted_exp;
+        TraMLFile().load(tr_file, targeted_exp);
+        OpenSwathDataAccessHelper::convertTargetedExp(targeted_exp, transition_exp);
+      }
+      else
+      {
+        TransitionTSVReader().convertTSVToTargetedExperiment(tr_file.c_str(), tr_type, transition_exp);
+      }
+      progresslogger.endProgress();
+
+      transition_table.build(transition_exp);
+      if (!tr_cache.empty())
+      {
+        // the cache is only an optimization - don't fail if it can't be written
+        try
+        {
+          transition_table.store(tr_cache, tr_signature);
+        }
+        catch (OpenMS::Exception::UnableToCreateFile& /*e*/)
+        {
+          LOG_WARN << "Warning: Could not write the transition cache file '" << tr_cache << "', continuing without it" << std::endl;
+        }
+      }
     }
-    progresslogger.endProgress();
 
     ///////////////////////////////////
     // Set up chrom.mzML output
@@ -1548,7 +1563,7 @@ protected:
     if (!out_chrom.empty())
     {
       chromConsumer = new PlainMSDataWritingConsumer(out_chrom);
-      int expected_chromatograms = transition_exp.transitions.size();
+      int expected_chromatograms = transition_table.size();
       chromConsumer->setExpectedSize(0, expected_chromatograms);
       chromConsumer->setExperimentalSettings(*exp_meta);
       chromConsumer->getOptions().setWriteIndex(true);  // ensure that we write the index
@@ -1568,7 +1583,7 @@ protected:
     OpenSwathWorkflow wf(use_ms1_traces);
     wf.setLogType(log_type_);
 
-    wf.performExtraction(swath_maps, trafo_rtnorm, cp, feature_finder_param, transition_exp,
+    wf.performExtraction(swath_maps, trafo_rtnorm, cp, feature_finder_param, transition_table,
         out_featureFile, !out.empty(), tsvwriter, chromConsumer, batchSize);
     if (!out.empty())
     {
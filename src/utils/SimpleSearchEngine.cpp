@@ -41,8 +41,8 @@
 #include <OpenMS/METADATA/SpectrumSettings.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
-#include <OpenMS/FORMAT/FASTAFile.h>
 #include <OpenMS/CHEMISTRY/EnzymaticDigestion.h>
+#include <OpenMS/CHEMISTRY/DigestedPeptideTable.h>
 
 #include <OpenMS/CHEMISTRY/ModificationsDB.h>
 #include <OpenMS/ANALYSIS/RNPXL/ModifiedPeptideGenerator.h>
@@ -172,23 +172,6 @@ class SimpleSearchEngine :
       return modifications;
     }
 
-    // check if for minimum size
-    class HasInvalidPeptideLengthPredicate
-    {
-        public:
-          explicit HasInvalidPeptideLengthPredicate(Size min_size)
-            :min_size_(min_size)
-          {
-          }
-
-          bool operator()(const AASequence& aas)
-          {
-            return (aas.size() < min_size_);
-          }
-      private:
-          Size min_size_;
-    };
-
     // spectrum must not contain 0 intensity peaks and must be sorted by m/z
     template <typename SpectrumType>
     static void deisotopeAndSingleChargeMSSpectrum(SpectrumType& in, Int min_charge, Int max_charge, double fragment_tolerance, bool fragment_unit_ppm, bool keep_only_deisotoped = false, Size min_isopeaks = 3, Size max_isopeaks = 10, bool make_single_charged = true)
@@ -546,139 +529,99 @@ class SimpleSearchEngine :
 
       vector<vector<PeptideHit> > peptide_hits(spectra.size(), vector<PeptideHit>());
 
-      progresslogger.startProgress(0, 1, "Load database from FASTA file...");
-      FASTAFile fastaFile;
-      vector<FASTAFile::FASTAEntry> fasta_db;
-      fastaFile.load(in_db, fasta_db);
-      progresslogger.endProgress();
-
       const Size missed_cleavages = getIntOption_("peptide:missed_cleavages");
       EnzymaticDigestion digestor;
       digestor.setEnzyme(EnzymaticDigestion::ENZYME_TRYPSIN);
       digestor.setMissedCleavages(missed_cleavages);
 
-      progresslogger.startProgress(0, (Size)(fasta_db.end() - fasta_db.begin()), "Scoring peptide models against spectra...");
-
-      // lookup for processed peptides. must be defined outside of omp section and synchronized
-      set<std::string> processed_petides;
+      // digest the database (streamed from disk) into a table of unique peptides
+      progresslogger.startProgress(0, 1, "Digesting database...");
+      DigestedPeptideTable peptide_table(digestor, peptide_min_size);
+      peptide_table.addFASTAFile(in_db);
+      progresslogger.endProgress();
 
-      // set minimum size of peptide after digestion
-      HasInvalidPeptideLengthPredicate has_invalid_length(getIntOption_("peptide:min_size"));
+      progresslogger.startProgress(0, peptide_table.size(), "Scoring peptide models against spectra...");
 
 #ifdef _OPENMP
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic, 100)
 #endif
-      for (SignedSize fasta_index = 0; fasta_index < (SignedSize)fasta_db.size(); ++fasta_index)
+      for (SignedSize peptide_index = 0; peptide_index < (SignedSize)peptide_table.size(); ++peptide_index)
       {
         IF_MASTERTHREAD
         {
-          progresslogger.setProgress((SignedSize)fasta_index * NUMBER_OF_THREADS);
+          progresslogger.setProgress((SignedSize)peptide_index * NUMBER_OF_THREADS);
         }
 
-        const AASequence& seq = AASequence::fromString(fasta_db[fasta_index].sequence);
+        // each peptide (and all modified variants) is processed only once
+        AASequence peptide = AASequence::fromString(peptide_table.getSequence(peptide_index));
 
-        vector<AASequence> current_digest;
-        digestor.digest(seq, current_digest);
+        vector<AASequence> all_modified_peptides;
 
-        // c++ STL pattern for deleting entries from vector based on predicate evaluation
-        current_digest.erase(std::remove_if(current_digest.begin(), current_digest.end(), has_invalid_length), current_digest.end());
+        // this critial section is because ResidueDB is not thread safe and new residues are created based on the PTMs
+#ifdef _OPENMP
+#pragma omp critical (residuedb_access)
+#endif
+        {
+          ModifiedPeptideGenerator::applyFixedModifications(fixedMods.begin(), fixedMods.end(), peptide);
+          ModifiedPeptideGenerator::applyVariableModifications(varMods.begin(), varMods.end(), peptide, max_variable_mods_per_peptide, all_modified_peptides);
+        }
 
-        for (vector<AASequence>::iterator cit = current_digest.begin(); cit != current_digest.end(); ++cit)
+        for (SignedSize mod_pep_idx = 0; mod_pep_idx < (SignedSize)all_modified_peptides.size(); ++mod_pep_idx)
         {
-          const std::string& s = cit->toUnmodifiedString();
+          const AASequence& candidate = all_modified_peptides[mod_pep_idx];
+          double current_peptide_mass = candidate.getMonoWeight();
 
-          bool already_processed = false;
-#ifdef _OPENMP
-#pragma omp critical (processed_peptides_access)
-#endif
-          {
-            if (processed_petides.find(s) != processed_petides.end())
-            {
-              // peptide (and all modified variants) already processed so skip it
-              already_processed = true;
-            }
-          }
+          // determine MS2 precursors that match to the current peptide mass
+          multimap<double, Size>::const_iterator low_it;
+          multimap<double, Size>::const_iterator up_it;
 
-          if (already_processed)
+          if (precursor_mass_tolerance_unit_ppm) // ppm
           {
-            continue;
+            low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - 0.5 * current_peptide_mass * precursor_mass_tolerance * 1e-6);
+            up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + 0.5 * current_peptide_mass * precursor_mass_tolerance * 1e-6);
           }
-
-#ifdef _OPENMP
-#pragma omp critical (processed_peptides_access)
-#endif
+          else // Dalton
           {
-            processed_petides.insert(s);
+            low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - 0.5 * precursor_mass_tolerance);
+            up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + 0.5 * precursor_mass_tolerance);
           }
 
-          vector<AASequence> all_modified_peptides;
-
-          // this critial section is because ResidueDB is not thread safe and new residues are created based on the PTMs
-#ifdef _OPENMP
-#pragma omp critical (residuedb_access)
-#endif
+          if (low_it == up_it)
           {
-            ModifiedPeptideGenerator::applyFixedModifications(fixedMods.begin(), fixedMods.end(), *cit);
-            ModifiedPeptideGenerator::applyVariableModifications(varMods.begin(), varMods.end(), *cit, max_variable_mods_per_peptide, all_modified_peptides);
+            continue;     // no matching precursor in data
           }
 
-          for (SignedSize mod_pep_idx = 0; mod_pep_idx < (SignedSize)all_modified_peptides.size(); ++mod_pep_idx)
-          {
-            const AASequence& candidate = all_modified_peptides[mod_pep_idx];
-            double current_peptide_mass = candidate.getMonoWeight();
-
-            // determine MS2 precursors that match to the current peptide mass
-            multimap<double, Size>::const_iterator low_it;
-            multimap<double, Size>::const_iterator up_it;
-
-            if (precursor_mass_tolerance_unit_ppm) // ppm
-            {
-              low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - 0.5 * current_peptide_mass * precursor_mass_tolerance * 1e-6);
-              up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + 0.5 * current_peptide_mass * precursor_mass_tolerance * 1e-6);
-            }
-            else // Dalton
-            {
-              low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - 0.5 * precursor_mass_tolerance);
-              up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + 0.5 * precursor_mass_tolerance);
-            }
+          //create theoretical spectrum
+          MSSpectrum<RichPeak1D> theo_spectrum = MSSpectrum<RichPeak1D>();
 
-            if (low_it == up_it)
-            {
-              continue;     // no matching precursor in data
-            }
+          //add peaks for b and y ions with charge 1
+          spectrum_generator.getSpectrum(theo_spectrum, candidate, 1);
 
-            //create theoretical spectrum
-            MSSpectrum<RichPeak1D> theo_spectrum = MSSpectrum<RichPeak1D>();
+          //sort by mz
+          theo_spectrum.sortByPosition();
 
-            //add peaks for b and y ions with charge 1
-            spectrum_generator.getSpectrum(theo_spectrum, candidate, 1);
+          for (; low_it != up_it; ++low_it)
+          {
+            const Size& scan_index = low_it->second;
+            const MSSpectrum<Peak1D>& exp_spectrum = spectra[scan_index];
 
-            //sort by mz
-            theo_spectrum.sortByPosition();
+            double score = computeHyperScore(fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm, exp_spectrum, theo_spectrum);
 
-            for (; low_it != up_it; ++low_it)
+            // no hit
+            if (score < 1e-16)
             {
-              const Size& scan_index = low_it->second;
-              const MSSpectrum<Peak1D>& exp_spectrum = spectra[scan_index];
-
-              double score = computeHyperScore(fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm, exp_spectrum, theo_spectrum);
-
-              // no hit
-              if (score < 1e-16)
-              {
-                continue;
-              }
+              continue;
+            }
 
-              PeptideHit hit;
-              hit.setSequence(candidate);
-              hit.setCharge(exp_spectrum.getPrecursors()[0].getCharge());
-              hit.setScore(score);
+            PeptideHit hit;
+            hit.setSequence(candidate);
+            hit.setCharge(exp_spectrum.getPrecursors()[0].getCharge());
+            hit.setScore(score);
 #ifdef _OPENMP
 #pragma omp critical (peptide_hits_access)
 #endif
-              {
-                peptide_hits[scan_index].push_back(hit);
-              }
+            {
+              peptide_hits[scan_index].push_back(hit);
             }
           }
         }